@@ -7,6 +7,7 @@
 #include <sstream>
 
 #include "logging.h"
+#include "overlay_raster.h"
 
 // 在img上画出检测结果
 void DrawDetections(cv::Mat &img, const std::vector<Detection> &objects)
@@ -28,223 +29,6 @@ void DrawDetections(cv::Mat &img, const std::vector<Detection> &objects)
     }
 }
 
-// Helper function to set pixel color in RGBA buffer
-inline void setPixelRGBA(uint8_t* rgba_data, int x, int y, int width, int stride,
-                        uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
-    if (x >= 0 && x < width && y >= 0) {
-        int offset = y * stride + x * 4;
-        rgba_data[offset] = r;     // R
-        rgba_data[offset + 1] = g; // G
-        rgba_data[offset + 2] = b; // B
-        rgba_data[offset + 3] = a; // A
-    }
-}
-
-// Draw a thick line in RGBA buffer
-void drawThickLine(uint8_t* rgba_data, int width, int height, int stride,
-                   int x1, int y1, int x2, int y2, int thickness,
-                   uint8_t r, uint8_t g, uint8_t b) {
-    // Simple thick line drawing using multiple thin lines
-    int half_thick = thickness / 2;
-
-    for (int offset = -half_thick; offset <= half_thick; offset++) {
-        // Draw horizontal offset lines
-        if (abs(x2 - x1) > abs(y2 - y1)) {
-            // More horizontal than vertical
-            int start_x = std::min(x1, x2);
-            int end_x = std::max(x1, x2);
-            int start_y = (x1 < x2) ? y1 : y2;
-            int end_y = (x1 < x2) ? y2 : y1;
-
-            for (int x = start_x; x <= end_x; x++) {
-                int y = start_y + (end_y - start_y) * (x - start_x) / (end_x - start_x);
-                setPixelRGBA(rgba_data, x, y + offset, width, stride, r, g, b);
-            }
-        } else {
-            // More vertical than horizontal
-            int start_y = std::min(y1, y2);
-            int end_y = std::max(y1, y2);
-            int start_x = (y1 < y2) ? x1 : x2;
-            int end_x = (y1 < y2) ? x2 : x1;
-
-            for (int y = start_y; y <= end_y; y++) {
-                int x = start_x + (end_x - start_x) * (y - start_y) / (end_y - start_y);
-                setPixelRGBA(rgba_data, x + offset, y, width, stride, r, g, b);
-            }
-        }
-    }
-}
-
-// Draw rectangle outline in RGBA buffer
-void drawRectangle(uint8_t* rgba_data, int width, int height, int stride,
-                   int x, int y, int w, int h, int thickness,
-                   uint8_t r, uint8_t g, uint8_t b) {
-    // Ensure rectangle is within bounds
-    x = std::max(0, std::min(x, width - 1));
-    y = std::max(0, std::min(y, height - 1));
-    w = std::max(1, std::min(w, width - x));
-    h = std::max(1, std::min(h, height - y));
-
-    // Draw four sides of rectangle
-    drawThickLine(rgba_data, width, height, stride, x, y, x + w, y, thickness, r, g, b);         // Top
-    drawThickLine(rgba_data, width, height, stride, x, y + h, x + w, y + h, thickness, r, g, b); // Bottom
-    drawThickLine(rgba_data, width, height, stride, x, y, x, y + h, thickness, r, g, b);         // Left
-    drawThickLine(rgba_data, width, height, stride, x + w, y, x + w, y + h, thickness, r, g, b); // Right
-}
-
-// Simple bitmap font for drawing text (8x8 pixels per character)
-// This is a minimal implementation for basic ASCII characters
-const uint8_t font_8x8[95][8] = {
-    // Space (32)
-    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
-    // ! (33)
-    {0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00},
-    // " (34)
-    {0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
-    // # (35)
-    {0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00},
-    // $ (36)
-    {0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00},
-    // % (37)
-    {0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00},
-    // & (38)
-    {0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00},
-    // ' (39)
-    {0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00},
-    // ( (40)
-    {0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00},
-    // ) (41)
-    {0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00},
-    // * (42)
-    {0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00},
-    // + (43)
-    {0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00},
-    // , (44)
-    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x06, 0x00},
-    // - (45)
-    {0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00},
-    // . (46)
-    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00},
-    // / (47)
-    {0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00},
-    // 0 (48)
-    {0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00},
-    // 1 (49)
-    {0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00},
-    // 2 (50)
-    {0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00},
-    // 3 (51)
-    {0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00},
-    // 4 (52)
-    {0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00},
-    // 5 (53)
-    {0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00},
-    // 6 (54)
-    {0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00},
-    // 7 (55)
-    {0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00},
-    // 8 (56)
-    {0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00},
-    // 9 (57)
-    {0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00},
-    // : (58)
-    {0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00},
-    // ; (59)
-    {0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x06, 0x00},
-    // < (60)
-    {0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00},
-    // = (61)
-    {0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00},
-    // > (62)
-    {0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00},
-    // ? (63)
-    {0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00},
-    // @ (64)
-    {0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00},
-    // A (65)
-    {0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00},
-    // B (66)
-    {0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00},
-    // C (67)
-    {0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00},
-    // D (68)
-    {0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00},
-    // E (69)
-    {0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00},
-    // F (70)
-    {0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00},
-    // G (71)
-    {0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00},
-    // H (72)
-    {0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00},
-    // I (73)
-    {0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00},
-    // J (74)
-    {0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00},
-    // K (75)
-    {0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00},
-    // L (76)
-    {0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00},
-    // M (77)
-    {0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00},
-    // N (78)
-    {0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00},
-    // O (79)
-    {0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00},
-    // P (80)
-    {0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00},
-    // Q (81)
-    {0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00},
-    // R (82)
-    {0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00},
-    // S (83)
-    {0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00},
-    // T (84)
-    {0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00},
-    // U (85)
-    {0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00},
-    // V (86)
-    {0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00},
-    // W (87)
-    {0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00},
-    // X (88)
-    {0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00},
-    // Y (89)
-    {0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00},
-    // Z (90)
-    {0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00},
-    // Additional characters can be added here...
-    // For now, we'll use space for unsupported characters
-};
-
-// Draw a single character at position (x, y)
-void drawChar(uint8_t* rgba_data, int width, int height, int stride,
-              int x, int y, char c, uint8_t r, uint8_t g, uint8_t b) {
-    if (c < 32 || c > 126) c = 32; // Use space for unsupported characters
-
-    const uint8_t* char_data = font_8x8[c - 32];
-
-    for (int row = 0; row < 8; row++) {
-        uint8_t byte = char_data[row];
-        for (int col = 0; col < 8; col++) {
-            if (byte & (0x80 >> col)) {
-                setPixelRGBA(rgba_data, x + col, y + row, width, stride, r, g, b);
-            }
-        }
-    }
-}
-
-// Draw text string
-void drawText(uint8_t* rgba_data, int width, int height, int stride,
-              int x, int y, const std::string& text, uint8_t r, uint8_t g, uint8_t b) {
-    int char_x = x;
-    for (char c : text) {
-        if (char_x + 8 > width) break; // Stop if we exceed width
-        drawChar(rgba_data, width, height, stride, char_x, y, c, r, g, b);
-        char_x += 8; // Move to next character position
-    }
-}
-
 // Get color for different object classes
 void getClassColor(int class_id, uint8_t& r, uint8_t& g, uint8_t& b) {
     // Define colors for different classes
@@ -267,6 +51,43 @@ void getClassColor(int class_id, uint8_t& r, uint8_t& g, uint8_t& b) {
     b = colors[color_index][2];
 }
 
+static const uint32_t kLabelColor = 0xFFFFFFFF;
+
+// Class color packed for the overlay rasteriser (RGBA bytes, opaque)
+static uint32_t classColor(int class_id) {
+    uint8_t r, g, b;
+    getClassColor(class_id, r, g, b);
+    return r | (g << 8) | (b << 16) | 0xFF000000u;
+}
+
+// One display list per drawing thread; its capacity is reused from frame to frame
+static OverlayDisplayList& frameDisplayList(int width, int height) {
+    thread_local OverlayDisplayList list;
+    list.reset(width, height);
+    return list;
+}
+
+// Label above the box (inside it when the box is too close to the top), kept within the frame width;
+// evenAlign keeps the label on the NV12 chroma grid
+static void addLabel(OverlayDisplayList& list, int x, int y, const std::string& label, int glyphScale,
+                     bool background, bool evenAlign) {
+    int text_width = overlay_text_width(label.length(), glyphScale);
+    int text_height = 8 * glyphScale;
+    int text_x = std::max(0, std::min(x, list.width() - text_width));
+    int text_y = (y > text_height + 4) ? (y - text_height - 4) : (y + 4);
+    text_y = std::max(0, std::min(text_y, list.height() - text_height));
+    if (evenAlign) {
+        text_x &= ~1;
+        text_y &= ~1;
+    }
+
+    // Background rectangle (half brightness) for better text visibility
+    if (background) {
+        list.addDim(text_x - 2, text_y - 2, text_x + text_width + 2, text_y + text_height + 2);
+    }
+    list.addText(text_x, text_y, label, glyphScale, kLabelColor);
+}
+
 // Main function to draw detections on RGBA buffer
 void DrawDetectionsOnRGBA(uint8_t* rgba_data, int width, int height, int stride,
                          const std::vector<Detection>& objects) {
@@ -276,6 +97,8 @@ void DrawDetectionsOnRGBA(uint8_t* rgba_data, int width, int height, int stride,
 
     LOGD("Drawing %zu detections on RGBA buffer (%dx%d)", objects.size(), width, height);
 
+    OverlayDisplayList& list = frameDisplayList(width, height);
+    int thickness = std::max(2, std::min(6, width / 200));
     for (const auto& detection : objects) {
         // Get bounding box coordinates
         int x = detection.box.x;
@@ -288,53 +111,41 @@ void DrawDetectionsOnRGBA(uint8_t* rgba_data, int width, int height, int stride,
             continue;
         }
 
-        // Get color for this class
-        uint8_t r, g, b;
-        getClassColor(detection.class_id, r, g, b);
-
-        // Draw bounding box with appropriate thickness (scale with image size)
-        int thickness = std::max(2, std::min(6, width / 200));
-        drawRectangle(rgba_data, width, height, stride, x, y, w, h, thickness, r, g, b);
+        // Bounding box with thickness scaled with image size
+        list.addRectangle(x, y, w, h, thickness, classColor(detection.class_id));
 
         // Prepare label text with confidence (2 decimal places)
         std::ostringstream label_stream;
-        label_stream << detection.className << " " << std::fixed << std::setprecision(2) << detection.confidence;
-        std::string label = label_stream.str();
-
-        // Calculate text position (above the box, or inside if too close to top)
-        int text_x = x;
-        int text_y = (y > 12) ? (y - 4) : (y + 12);
-
-        // Ensure text doesn't go outside image bounds
-        text_x = std::max(0, std::min(text_x, width - static_cast<int>(label.length()) * 8));
-        text_y = std::max(8, std::min(text_y, height - 8));
-
-        // Draw text background (semi-transparent black rectangle)
-        int text_width = label.length() * 8;
-        int text_height = 8;
-
-        // Draw background rectangle for better text visibility
-        for (int bg_y = text_y - 1; bg_y < text_y + text_height + 1; bg_y++) {
-            for (int bg_x = text_x - 1; bg_x < text_x + text_width + 1; bg_x++) {
-                if (bg_x >= 0 && bg_x < width && bg_y >= 0 && bg_y < height) {
-                    int offset = bg_y * stride + bg_x * 4;
-                    // Semi-transparent black background
-                    rgba_data[offset] = rgba_data[offset] / 2;     // R
-                    rgba_data[offset + 1] = rgba_data[offset + 1] / 2; // G
-                    rgba_data[offset + 2] = rgba_data[offset + 2] / 2; // B
-                    // Keep alpha unchanged
-                }
-            }
+        if (detection.track_id >= 0) {
+            label_stream << "#" << detection.track_id << " ";
         }
-
-        // Draw the label text in white for good contrast
-        drawText(rgba_data, width, height, stride, text_x, text_y, label, 255, 255, 255);
+        label_stream << detection.className << " " << std::fixed << std::setprecision(2) << detection.confidence;
+        addLabel(list, x, y, label_stream.str(), 1, true, false);
     }
 
+    overlay_render_rgba(list, rgba_data, stride);
     LOGD("Finished drawing detections on RGBA buffer");
 }
 
 // Enhanced viewport-aware detection rendering
+// Label text for a detection according to the viewport configuration
+static std::string buildDetectionLabel(const Detection& detection, const ViewportRenderConfig& config) {
+    std::ostringstream label_stream;
+    if (config.showClassNamesInSmallViewport) {
+        if (detection.track_id >= 0) {
+            label_stream << "#" << detection.track_id << " ";
+        }
+        label_stream << detection.className;
+    }
+    if (config.showConfidenceInSmallViewport) {
+        if (config.showClassNamesInSmallViewport) {
+            label_stream << " ";
+        }
+        label_stream << std::fixed << std::setprecision(2) << detection.confidence;
+    }
+    return label_stream.str();
+}
+
 void DrawDetectionsOnRGBAViewportOptimized(uint8_t* rgba_data, int width, int height, int stride,
                                           const std::vector<Detection>& objects,
                                           const ViewportRenderConfig& config) {
@@ -348,7 +159,9 @@ void DrawDetectionsOnRGBAViewportOptimized(uint8_t* rgba_data, int width, int he
     // Calculate adaptive parameters based on viewport
     int adaptiveThickness = calculateAdaptiveThickness(width, height, config);
     float adaptiveTextScale = calculateAdaptiveTextScale(width, height, config);
+    int glyphScale = overlay_glyph_scale(adaptiveTextScale);
 
+    OverlayDisplayList& list = frameDisplayList(width, height);
     for (const auto& detection : objects) {
         // Skip low-confidence detections in small viewports
         if (config.isSmallViewport && detection.confidence < 0.7f) {
@@ -371,12 +184,8 @@ void DrawDetectionsOnRGBAViewportOptimized(uint8_t* rgba_data, int width, int he
             continue;
         }
 
-        // Get color for this class
-        uint8_t r, g, b;
-        getClassColor(detection.class_id, r, g, b);
-
-        // Draw bounding box with adaptive thickness
-        drawRectangle(rgba_data, width, height, stride, x, y, w, h, adaptiveThickness, r, g, b);
+        // Bounding box with adaptive thickness
+        list.addRectangle(x, y, w, h, adaptiveThickness, classColor(detection.class_id));
 
         // Determine what text to show based on viewport size and configuration
         bool showDetails = shouldShowDetectionDetails(detection, config);
@@ -385,57 +194,18 @@ void DrawDetectionsOnRGBAViewportOptimized(uint8_t* rgba_data, int width, int he
         }
 
         // Prepare label text
-        std::ostringstream label_stream;
-        if (config.showClassNamesInSmallViewport) {
-            label_stream << detection.className;
-        }
-        if (config.showConfidenceInSmallViewport) {
-            if (config.showClassNamesInSmallViewport) {
-                label_stream << " ";
-            }
-            label_stream << std::fixed << std::setprecision(2) << detection.confidence;
-        }
-        std::string label = label_stream.str();
+        std::string label = buildDetectionLabel(detection, config);
 
         if (label.empty()) {
             continue;
         }
 
-        // Calculate text position with adaptive scaling
-        int text_x = x;
-        int text_y = (y > 12) ? (y - 4) : (y + 12);
-
-        // Adaptive text size calculation
-        int text_width = static_cast<int>(label.length() * 6 * adaptiveTextScale);
-        int text_height = static_cast<int>(8 * adaptiveTextScale);
-
-        // Ensure text fits within viewport
-        if (text_x + text_width >= width) {
-            text_x = width - text_width - 2;
-        }
-        if (text_y + text_height >= height) {
-            text_y = height - text_height - 2;
-        }
-
-        // Draw background rectangle for better text visibility (only if text is large enough)
-        if (adaptiveTextScale > 0.5f) {
-            for (int bg_y = text_y - 1; bg_y < text_y + text_height + 1; bg_y++) {
-                for (int bg_x = text_x - 1; bg_x < text_x + text_width + 1; bg_x++) {
-                    if (bg_x >= 0 && bg_x < width && bg_y >= 0 && bg_y < height) {
-                        int offset = bg_y * stride + bg_x * 4;
-                        // Semi-transparent black background
-                        rgba_data[offset] = rgba_data[offset] / 2;     // R
-                        rgba_data[offset + 1] = rgba_data[offset + 1] / 2; // G
-                        rgba_data[offset + 2] = rgba_data[offset + 2] / 2; // B
-                    }
-                }
-            }
-        }
-
-        // Draw the label text with adaptive scaling
-        drawText(rgba_data, width, height, stride, text_x, text_y, label, 255, 255, 255);
+        // Label glyphs scaled with the viewport; background only if text is large enough
+        addLabel(list, x, y, label, glyphScale, adaptiveTextScale > 0.5f, false);
     }
 
+    overlay_render_rgba(list, rgba_data, stride);
+
     LOGD("Finished viewport-optimized detection rendering");
 }
 
@@ -447,6 +217,74 @@ void DrawDetectionsAdaptive(uint8_t* rgba_data, int width, int height, int strid
         return;
     }
 
+    ViewportRenderConfig config = calculateAdaptiveConfig(width, height, isActiveChannel, systemLoad);
+
+    LOGD("Adaptive rendering for channel %d (active: %s, load: %.2f, viewport: %dx%d)",
+         channelIndex, isActiveChannel ? "yes" : "no", systemLoad, width, height);
+
+    // Use viewport-optimized rendering
+    DrawDetectionsOnRGBAViewportOptimized(rgba_data, width, height, stride, objects, config);
+}
+
+// 直接在NV12帧上画检测结果：框的几何与rkmedia/utils/drawing.cpp的draw_rectangle_yuv420sp一致，
+// 坐标和线宽按2对齐（UV平面为2x2采样），框向内收半个线宽，线条不会画进stride/height_stride填充区
+void DrawDetectionsOnNV12(uint8_t* nv12_data, int width, int height, int stride, int height_stride,
+                          const std::vector<Detection>& objects, const ViewportRenderConfig& config) {
+    if (!nv12_data || objects.empty()) {
+        return;
+    }
+
+    int thickness = calculateAdaptiveThickness(width, height, config);
+    thickness = std::max(2, (thickness + 1) & ~1);
+    int inset = (thickness / 2 + 1) & ~1;
+    int glyphScale = overlay_glyph_scale(calculateAdaptiveTextScale(width, height, config));
+
+    OverlayDisplayList& list = frameDisplayList(width, height);
+    for (const auto& detection : objects) {
+        if (config.isSmallViewport && detection.confidence < 0.7f) {
+            continue;
+        }
+
+        int x0 = std::max(inset, detection.box.x) & ~1;
+        int y0 = std::max(inset, detection.box.y) & ~1;
+        int x1 = std::min(width - inset, detection.box.x + detection.box.width) & ~1;
+        int y1 = std::min(height - inset, detection.box.y + detection.box.height) & ~1;
+        if (x1 - x0 < 2 || y1 - y0 < 2) {
+            continue;
+        }
+        if (config.isSmallViewport && (x1 - x0 < 10 || y1 - y0 < 10)) {
+            continue;
+        }
+
+        list.addRectangle(x0, y0, x1 - x0, y1 - y0, thickness, classColor(detection.class_id));
+
+        if (!shouldShowDetectionDetails(detection, config)) {
+            continue;
+        }
+        std::string label = buildDetectionLabel(detection, config);
+        if (!label.empty()) {
+            addLabel(list, x0, y0, label, glyphScale, true, true);
+        }
+    }
+
+    overlay_render_nv12(list, nv12_data, stride, height_stride);
+}
+
+void DrawDetectionsAdaptiveNV12(uint8_t* nv12_data, int width, int height, int stride, int height_stride,
+                                const std::vector<Detection>& objects, int channelIndex,
+                                bool isActiveChannel, float systemLoad) {
+    if (!nv12_data || objects.empty()) {
+        return;
+    }
+
+    ViewportRenderConfig config = calculateAdaptiveConfig(width, height, isActiveChannel, systemLoad);
+    LOGD("Adaptive NV12 rendering for channel %d (active: %s, load: %.2f, viewport: %dx%d)",
+         channelIndex, isActiveChannel ? "yes" : "no", systemLoad, width, height);
+    DrawDetectionsOnNV12(nv12_data, width, height, stride, height_stride, objects, config);
+}
+
+// Viewport configuration adjusted for channel state and system load
+ViewportRenderConfig calculateAdaptiveConfig(int width, int height, bool isActiveChannel, float systemLoad) {
     // Calculate viewport configuration based on channel state and system load
     ViewportRenderConfig config = calculateViewportConfig(width, height, isActiveChannel);
 
@@ -463,12 +301,7 @@ void DrawDetectionsAdaptive(uint8_t* rgba_data, int width, int height, int strid
         config.showClassNamesInSmallViewport = true;
     }
     // Low system load - full rendering (default config)
-
-    LOGD("Adaptive rendering for channel %d (active: %s, load: %.2f, viewport: %dx%d)",
-         channelIndex, isActiveChannel ? "yes" : "no", systemLoad, width, height);
-
-    // Use viewport-optimized rendering
-    DrawDetectionsOnRGBAViewportOptimized(rgba_data, width, height, stride, objects, config);
+    return config;
 }
 
 // Calculate viewport configuration based on dimensions and channel state
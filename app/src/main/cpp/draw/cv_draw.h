@@ -45,8 +45,18 @@ void DrawDetectionsAdaptive(uint8_t* rgba_data, int width, int height, int strid
                            const std::vector<Detection>& objects, int channelIndex,
                            bool isActiveChannel, float systemLoad);
 
+// Detection rendering on NV12 frames (Y plane followed by interleaved UV at stride * height_stride),
+// used while frames stay in decoder format until display
+void DrawDetectionsOnNV12(uint8_t* nv12_data, int width, int height, int stride, int height_stride,
+                          const std::vector<Detection>& objects, const ViewportRenderConfig& config);
+
+void DrawDetectionsAdaptiveNV12(uint8_t* nv12_data, int width, int height, int stride, int height_stride,
+                                const std::vector<Detection>& objects, int channelIndex,
+                                bool isActiveChannel, float systemLoad);
+
 // Utility functions for viewport optimization
 ViewportRenderConfig calculateViewportConfig(int width, int height, bool isActiveChannel);
+ViewportRenderConfig calculateAdaptiveConfig(int width, int height, bool isActiveChannel, float systemLoad);
 bool shouldShowDetectionDetails(const Detection& detection, const ViewportRenderConfig& config);
 int calculateAdaptiveThickness(int width, int height, const ViewportRenderConfig& config);
 float calculateAdaptiveTextScale(int width, int height, const ViewportRenderConfig& config);
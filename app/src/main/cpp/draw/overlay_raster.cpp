@@ -0,0 +1,402 @@
+// 检测结果叠加层的批量光栅化
+//
+// 显示列表里的命令都已裁剪到画面内，光栅化时不再做逐像素边界判断：
+//  - 框的四条边是四个填充矩形，逐行用image_fill_rect按16字节整块写入
+//  - 字形图集：每个放大倍数一份，把8x8点阵的横向连续点合并成矩形（上下相同的段再纵向合并），
+//    画一个字符只需填几个小矩形；图集首次使用时生成，之后只读，多线程共用
+//  - NV12：Y平面逐字节填充，UV平面按2x2采样换算坐标后以2字节像素填充
+
+#include "overlay_raster.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "image_kernels.h"
+
+// 8x8点阵字体，ASCII 32~90（空格到Z），每行一个字节，最低位为最左列；其余字符为空白
+static const uint8_t font_8x8[95][8] = {
+    // Space (32)
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // ! (33)
+    {0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00},
+    // " (34)
+    {0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // # (35)
+    {0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00},
+    // $ (36)
+    {0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00},
+    // % (37)
+    {0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00},
+    // & (38)
+    {0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00},
+    // ' (39)
+    {0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // ( (40)
+    {0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00},
+    // ) (41)
+    {0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00},
+    // * (42)
+    {0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00},
+    // + (43)
+    {0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00},
+    // , (44)
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x06, 0x00},
+    // - (45)
+    {0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00},
+    // . (46)
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00},
+    // / (47)
+    {0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00},
+    // 0 (48)
+    {0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00},
+    // 1 (49)
+    {0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00},
+    // 2 (50)
+    {0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00},
+    // 3 (51)
+    {0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00},
+    // 4 (52)
+    {0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00},
+    // 5 (53)
+    {0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00},
+    // 6 (54)
+    {0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00},
+    // 7 (55)
+    {0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00},
+    // 8 (56)
+    {0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00},
+    // 9 (57)
+    {0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00},
+    // : (58)
+    {0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00},
+    // ; (59)
+    {0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x06, 0x00},
+    // < (60)
+    {0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00},
+    // = (61)
+    {0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00},
+    // > (62)
+    {0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00},
+    // ? (63)
+    {0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00},
+    // @ (64)
+    {0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00},
+    // A (65)
+    {0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00},
+    // B (66)
+    {0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00},
+    // C (67)
+    {0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00},
+    // D (68)
+    {0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00},
+    // E (69)
+    {0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00},
+    // F (70)
+    {0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00},
+    // G (71)
+    {0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00},
+    // H (72)
+    {0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00},
+    // I (73)
+    {0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00},
+    // J (74)
+    {0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00},
+    // K (75)
+    {0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00},
+    // L (76)
+    {0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00},
+    // M (77)
+    {0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00},
+    // N (78)
+    {0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00},
+    // O (79)
+    {0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00},
+    // P (80)
+    {0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00},
+    // Q (81)
+    {0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00},
+    // R (82)
+    {0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00},
+    // S (83)
+    {0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00},
+    // T (84)
+    {0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00},
+    // U (85)
+    {0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00},
+    // V (86)
+    {0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00},
+    // W (87)
+    {0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00},
+    // X (88)
+    {0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00},
+    // Y (89)
+    {0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00},
+    // Z (90)
+    {0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00},
+    // Additional characters can be added here...
+    // For now, we'll use space for unsupported characters
+};
+
+typedef struct {
+    uint8_t x, y, w, h;
+} glyph_rect_s;
+
+// 一个放大倍数的字形图集：字形g的矩形为rects[first[g], first[g + 1])
+typedef struct {
+    int scale;
+    std::vector<glyph_rect_s> rects;
+    uint16_t first[96];
+} glyph_atlas_s;
+
+static glyph_atlas_s build_glyph_atlas(int scale) {
+    glyph_atlas_s atlas;
+    atlas.scale = scale;
+    for (int g = 0; g < 95; g++) {
+        atlas.first[g] = (uint16_t) atlas.rects.size();
+        // 以点阵坐标收集横向段，与上一行完全相同的段向下延伸
+        std::vector<glyph_rect_s> runs;
+        for (int row = 0; row < 8; row++) {
+            uint8_t bits = font_8x8[g][row];
+            for (int col = 0; col < 8;) {
+                if (!(bits & (1 << col))) {
+                    col++;
+                    continue;
+                }
+                int start = col;
+                while (col < 8 && (bits & (1 << col))) {
+                    col++;
+                }
+                bool extended = false;
+                for (auto &run : runs) {
+                    if (run.x == start && run.w == col - start && run.y + run.h == row) {
+                        run.h++;
+                        extended = true;
+                        break;
+                    }
+                }
+                if (!extended) {
+                    runs.push_back({(uint8_t) start, (uint8_t) row, (uint8_t) (col - start), 1});
+                }
+            }
+        }
+        for (const auto &run : runs) {
+            atlas.rects.push_back({(uint8_t) (run.x * scale), (uint8_t) (run.y * scale), (uint8_t) (run.w * scale),
+                                   (uint8_t) (run.h * scale)});
+        }
+    }
+    atlas.first[95] = (uint16_t) atlas.rects.size();
+    return atlas;
+}
+
+static const glyph_atlas_s &glyph_atlas(int scale) {
+    static const std::vector<glyph_atlas_s> atlases = [] {
+        std::vector<glyph_atlas_s> built;
+        for (int scale = 1; scale <= OVERLAY_MAX_GLYPH_SCALE; scale++) {
+            built.push_back(build_glyph_atlas(scale));
+        }
+        return built;
+    }();
+    return atlases[scale - 1];
+}
+
+static int glyph_index(char c) {
+    if (c >= 'a' && c <= 'z') {
+        c = (char) (c - 'a' + 'A');
+    }
+    if (c < 32 || c > 126) {
+        c = 32;
+    }
+    return c - 32;
+}
+
+// 对文字命令的每个可见字形矩形（已裁剪到op的可见区域）调用fill(x0, y0, x1, y1)
+template <typename Fill>
+static void for_each_glyph_rect(const OverlayDisplayList &list, const overlay_op_s &op, Fill fill) {
+    const glyph_atlas_s &atlas = glyph_atlas(op.glyph_scale);
+    const char *text = list.text(op);
+    const int cell = 8 * op.glyph_scale;
+    const int first = std::max(0, (op.x0 - op.text_x) / cell);
+    const int last = std::min(op.text_length, (op.x1 - op.text_x + cell - 1) / cell);
+    for (int i = first; i < last; i++) {
+        const int g = glyph_index(text[i]);
+        const int gx = op.text_x + i * cell;
+        for (int r = atlas.first[g]; r < atlas.first[g + 1]; r++) {
+            const glyph_rect_s &rect = atlas.rects[r];
+            int x0 = std::max(gx + rect.x, op.x0);
+            int y0 = std::max(op.text_y + rect.y, op.y0);
+            int x1 = std::min(gx + rect.x + rect.w, op.x1);
+            int y1 = std::min(op.text_y + rect.y + rect.h, op.y1);
+            if (x0 < x1 && y0 < y1) {
+                fill(x0, y0, x1, y1);
+            }
+        }
+    }
+}
+
+OverlayDisplayList::OverlayDisplayList() : m_width(0), m_height(0) {}
+
+void OverlayDisplayList::reset(int width, int height) {
+    m_width = std::max(0, width);
+    m_height = std::max(0, height);
+    m_ops.clear();
+    m_text.clear();
+}
+
+bool OverlayDisplayList::clip(int &x0, int &y0, int &x1, int &y1) const {
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, m_width);
+    y1 = std::min(y1, m_height);
+    return x0 < x1 && y0 < y1;
+}
+
+void OverlayDisplayList::addFill(int x0, int y0, int x1, int y1, uint32_t color) {
+    if (!clip(x0, y0, x1, y1)) {
+        return;
+    }
+    overlay_op_s op = {};
+    op.type = OVERLAY_OP_FILL;
+    op.x0 = x0;
+    op.y0 = y0;
+    op.x1 = x1;
+    op.y1 = y1;
+    op.color = color;
+    m_ops.push_back(op);
+}
+
+void OverlayDisplayList::addRectangle(int x, int y, int w, int h, int thickness, uint32_t color) {
+    if (thickness == -1) {
+        addFill(x, y, x + w, y + h, color);
+        return;
+    }
+    const int t0 = thickness / 2;
+    const int t1 = thickness - t0;
+    addFill(x - t0, y - t0, x + w + t1, y + t1, color);         // 上
+    addFill(x - t0, y + h - t0, x + w + t1, y + h + t1, color); // 下
+    addFill(x - t0, y + t1, x + t1, y + h - t0, color);         // 左
+    addFill(x + w - t0, y + t1, x + w + t1, y + h - t0, color); // 右
+}
+
+void OverlayDisplayList::addDim(int x0, int y0, int x1, int y1) {
+    if (!clip(x0, y0, x1, y1)) {
+        return;
+    }
+    overlay_op_s op = {};
+    op.type = OVERLAY_OP_DIM;
+    op.x0 = x0;
+    op.y0 = y0;
+    op.x1 = x1;
+    op.y1 = y1;
+    m_ops.push_back(op);
+}
+
+void OverlayDisplayList::addText(int x, int y, const std::string &text, int glyph_scale, uint32_t color) {
+    glyph_scale = std::max(1, std::min(OVERLAY_MAX_GLYPH_SCALE, glyph_scale));
+    int x0 = x;
+    int y0 = y;
+    int x1 = x + overlay_text_width(text.length(), glyph_scale);
+    int y1 = y + 8 * glyph_scale;
+    if (text.empty() || !clip(x0, y0, x1, y1)) {
+        return;
+    }
+    overlay_op_s op = {};
+    op.type = OVERLAY_OP_TEXT;
+    op.x0 = x0;
+    op.y0 = y0;
+    op.x1 = x1;
+    op.y1 = y1;
+    op.color = color;
+    op.text_x = x;
+    op.text_y = y;
+    op.text_offset = (int) m_text.size();
+    op.text_length = (int) text.length();
+    op.glyph_scale = glyph_scale;
+    m_text.append(text);
+    m_ops.push_back(op);
+}
+
+int overlay_glyph_scale(float text_scale) {
+    return std::max(1, std::min(OVERLAY_MAX_GLYPH_SCALE, (int) (text_scale * 2.0f + 0.5f)));
+}
+
+int overlay_text_width(size_t length, int glyph_scale) {
+    return (int) length * 8 * glyph_scale;
+}
+
+void overlay_render_rgba(const OverlayDisplayList &list, uint8_t *rgba, int stride) {
+    if (rgba == nullptr) {
+        return;
+    }
+    for (const overlay_op_s &op : list.ops()) {
+        uint8_t *origin = rgba + (size_t) op.y0 * stride + op.x0 * 4;
+        switch (op.type) {
+            case OVERLAY_OP_FILL:
+                rgba_fill_rect(origin, stride, op.x1 - op.x0, op.y1 - op.y0, op.color);
+                break;
+            case OVERLAY_OP_DIM:
+                rgba_blend_rect(origin, stride, op.x1 - op.x0, op.y1 - op.y0, 0x80000000);
+                break;
+            case OVERLAY_OP_TEXT:
+                for_each_glyph_rect(list, op, [&](int x0, int y0, int x1, int y1) {
+                    rgba_fill_rect(rgba + (size_t) y0 * stride + x0 * 4, stride, x1 - x0, y1 - y0, op.color);
+                });
+                break;
+        }
+    }
+}
+
+// BT.601 limited range：返回Y，uv为交错的[U, V]
+static uint8_t rgba_to_nv12(uint32_t color, uint8_t uv[2]) {
+    const int r = color & 0xFF;
+    const int g = (color >> 8) & 0xFF;
+    const int b = (color >> 16) & 0xFF;
+    uv[0] = (uint8_t) (((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+    uv[1] = (uint8_t) (((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    return (uint8_t) (((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+void overlay_render_nv12(const OverlayDisplayList &list, uint8_t *nv12, int stride, int height_stride) {
+    if (nv12 == nullptr) {
+        return;
+    }
+    uint8_t *uv_plane = nv12 + (size_t) stride * height_stride;
+    for (const overlay_op_s &op : list.ops()) {
+        switch (op.type) {
+            case OVERLAY_OP_FILL: {
+                uint8_t uv[2];
+                const uint8_t y = rgba_to_nv12(op.color, uv);
+                image_fill_rect(nv12 + (size_t) op.y0 * stride + op.x0, stride, op.x1 - op.x0, op.y1 - op.y0, &y, 1);
+                // 起止坐标向上取整到色度坐标，偶数对齐的框与draw_rectangle_yuv420sp的UV线宽（thickness / 2）一致
+                const int cx0 = (op.x0 + 1) >> 1;
+                const int cy0 = (op.y0 + 1) >> 1;
+                image_fill_rect(uv_plane + (size_t) cy0 * stride + cx0 * 2, stride, ((op.x1 + 1) >> 1) - cx0,
+                                ((op.y1 + 1) >> 1) - cy0, uv, 2);
+                break;
+            }
+            case OVERLAY_OP_DIM: {
+                for (int row = op.y0; row < op.y1; row++) {
+                    uint8_t *luma = nv12 + (size_t) row * stride;
+                    for (int col = op.x0; col < op.x1; col++) {
+                        luma[col] = (uint8_t) (16 + (luma[col] - 16) / 2);
+                    }
+                }
+                // 覆盖到的色度像素全部置灰
+                const uint8_t gray[2] = {128, 128};
+                const int cx0 = op.x0 >> 1;
+                const int cy0 = op.y0 >> 1;
+                image_fill_rect(uv_plane + (size_t) cy0 * stride + cx0 * 2, stride, ((op.x1 + 1) >> 1) - cx0,
+                                ((op.y1 + 1) >> 1) - cy0, gray, 2);
+                break;
+            }
+            case OVERLAY_OP_TEXT: {
+                uint8_t uv[2];
+                const uint8_t y = rgba_to_nv12(op.color, uv);
+                for_each_glyph_rect(list, op, [&](int x0, int y0, int x1, int y1) {
+                    image_fill_rect(nv12 + (size_t) y0 * stride + x0, stride, x1 - x0, y1 - y0, &y, 1);
+                });
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+// 检测结果叠加层的批量光栅化：每帧先把框、标签底色、文字收集成显示列表（加入时一次性裁剪到画面内），
+// 再整表画到RGBA或NV12缓冲区。框拆成横向span矩形用SIMD整块填充，文字按预生成的字形图集
+// （8x8点阵按整数倍放大、合并成矩形）填充，不再逐像素判断边界
+
+#ifndef RK3588_DEMO_OVERLAY_RASTER_H
+#define RK3588_DEMO_OVERLAY_RASTER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// 字形最大放大倍数（8x8 -> 32x32）
+#define OVERLAY_MAX_GLYPH_SCALE 4
+
+typedef enum _overlay_op {
+    OVERLAY_OP_FILL = 0, // 纯色矩形（框的一条边）
+    OVERLAY_OP_DIM = 1,  // 调暗一半（标签底色）
+    OVERLAY_OP_TEXT = 2, // 一行文字
+} overlay_op_e;
+
+typedef struct {
+    overlay_op_e type;
+    int x0, y0, x1, y1;  // 裁剪后的区域[x0, x1) x [y0, y1)，文字为可见部分
+    uint32_t color;      // RGBA字节序（小端下0xAABBGGRR），NV12时换算成BT.601 YUV
+    int text_x, text_y;  // 文字：裁剪前第一个字形的左上角
+    int text_offset;     // 文字：在显示列表文字缓冲中的位置和长度
+    int text_length;
+    int glyph_scale;     // 文字：字形放大倍数1~OVERLAY_MAX_GLYPH_SCALE
+} overlay_op_s;
+
+// 一帧的显示列表，reset后可反复使用（每个绘制线程一份，容器容量保留）
+class OverlayDisplayList {
+public:
+    OverlayDisplayList();
+
+    // 清空命令并设置目标尺寸（裁剪范围）
+    void reset(int width, int height);
+
+    // 纯色填充[x0, x1) x [y0, y1)
+    void addFill(int x0, int y0, int x1, int y1, uint32_t color);
+
+    // 矩形框，几何与draw_rectangle_yuv420sp一致：线宽的thickness / 2在边外、其余在边内，
+    // 上下边含四角，左右边只画两者之间的部分
+    void addRectangle(int x, int y, int w, int h, int thickness, uint32_t color);
+
+    // 把[x0, x1) x [y0, y1)调暗一半
+    void addDim(int x0, int y0, int x1, int y1);
+
+    // 从(x, y)开始画一行文字，每个字符8 * glyph_scale像素见方；小写字母按大写字形绘制
+    void addText(int x, int y, const std::string &text, int glyph_scale, uint32_t color);
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    const std::vector<overlay_op_s> &ops() const { return m_ops; }
+    const char *text(const overlay_op_s &op) const { return m_text.data() + op.text_offset; }
+
+private:
+    // 裁剪到目标范围，完全在外时返回false
+    bool clip(int &x0, int &y0, int &x1, int &y1) const;
+
+    int m_width;
+    int m_height;
+    std::vector<overlay_op_s> m_ops;
+    std::string m_text;
+};
+
+// ViewportRenderConfig的文字缩放（0.3~1.0）换算成整数字形倍数：0.75以下1倍，1.0为2倍
+int overlay_glyph_scale(float text_scale);
+
+// 一行length个字符的像素宽度
+int overlay_text_width(size_t length, int glyph_scale);
+
+// 按列表顺序画到RGBA缓冲区，stride为每行字节数
+void overlay_render_rgba(const OverlayDisplayList &list, uint8_t *rgba, int stride);
+
+// 画到NV12缓冲区（Y平面后接stride * height_stride处的交错UV平面）：
+// 填充矩形的UV范围按draw_rectangle_yuv420sp的取法（偶数坐标时与其逐字节一致），
+// 调暗区域的Y减半、覆盖到的UV置灰，文字只写Y
+void overlay_render_nv12(const OverlayDisplayList &list, uint8_t *nv12, int stride, int height_stride);
+
+#endif // RK3588_DEMO_OVERLAY_RASTER_H
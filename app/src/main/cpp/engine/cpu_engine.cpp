@@ -0,0 +1,309 @@
+// CPU参考引擎：按配置输出合成的YOLOv5输出张量
+
+#include "cpu_engine.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "logging.h"
+
+namespace {
+
+const int kAnchors[3][6] = {{10, 13, 16, 30, 33, 23}, {30, 61, 62, 45, 59, 119}, {116, 90, 156, 198, 373, 326}};
+const float kOutputScale = 0.05f; // 输出量化：zp 0，logit范围约 ±6.4
+
+void sleep_us(int us) {
+    if (us > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+}
+
+const float kBackgroundLogit = -20.f; // float输出的背景值
+
+float logit(float p) {
+    p = std::min(std::max(p, 1e-4f), 1.f - 1e-4f);
+    return logf(p / (1.f - p));
+}
+
+int8_t quantize_logit(float p) {
+    float q = roundf(logit(p) / kOutputScale);
+    return (int8_t) std::min(std::max(q, -128.f), 127.f);
+}
+
+// 按输出类型写入：fill填充背景，put写入sigmoid后为prob的logit
+template <typename T>
+struct LogitWriter;
+
+template <>
+struct LogitWriter<int8_t> {
+    static void fill(void *data, int size) { memset(data, 0x80, size); }
+    static void put(void *p, int offset, float prob) { ((int8_t *) p)[offset] = quantize_logit(prob); }
+    static float max_prob() { return 1.f / (1.f + expf(-127 * kOutputScale)); }
+};
+
+template <>
+struct LogitWriter<float> {
+    static void fill(void *data, int size) { std::fill((float *) data, (float *) data + size / 4, kBackgroundLogit); }
+    static void put(void *p, int offset, float prob) { ((float *) p)[offset] = logit(prob); }
+    static float max_prob() { return 1.f - 1e-4f; }
+};
+
+float wrap(float v, int size) {
+    v = fmodf(v, (float) size);
+    return v < 0 ? v + size : v;
+}
+
+// 选择宽高比最接近的anchor：框宽 = (2 * sigmoid(t))^2 * anchor，比例须小于4
+void pick_anchor(float w, float h, int &branch, int &anchor) {
+    float best = -1.f;
+    branch = 2;
+    anchor = 2;
+    for (int b = 0; b < 3; b++) {
+        for (int a = 0; a < 3; a++) {
+            float rw = w / kAnchors[b][a * 2], rh = h / kAnchors[b][a * 2 + 1];
+            if (rw > 3.9f || rh > 3.9f) {
+                continue;
+            }
+            float cost = fabsf(logf(rw)) + fabsf(logf(rh));
+            if (best < 0 || cost < best) {
+                best = cost;
+                branch = b;
+                anchor = a;
+            }
+        }
+    }
+}
+
+} // namespace
+
+cpu_engine_config_s cpu_engine_default_config() {
+    cpu_engine_config_s config;
+    config.input_size = 640;
+    config.max_batch = 1;
+    config.num_classes = 80;
+    config.latency_us = 0;
+    config.per_item_us = 0;
+    config.output_type = NN_TENSOR_INT8;
+    return config;
+}
+
+bool parse_cpu_engine_config(const char *text, int size, cpu_engine_config_s &config) {
+    if (text == nullptr || size <= 0) {
+        return false;
+    }
+    std::string content(text, size);
+    size_t pos = 0;
+    bool header = false;
+    cpu_engine_config_s parsed = cpu_engine_default_config();
+    while (pos < content.size()) {
+        size_t end = content.find('\n', pos);
+        if (end == std::string::npos) {
+            end = content.size();
+        }
+        std::string line = content.substr(pos, end - pos);
+        pos = end + 1;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        if (!header) {
+            if (line != "cpu-engine") {
+                return false;
+            }
+            header = true;
+            continue;
+        }
+        int value = 0;
+        char name[16];
+        cpu_engine_object_s obj;
+        memset(&obj, 0, sizeof(obj));
+        if (sscanf(line.c_str(), "input_size=%d", &value) == 1) {
+            parsed.input_size = value;
+        } else if (sscanf(line.c_str(), "batch=%d", &value) == 1) {
+            parsed.max_batch = value;
+        } else if (sscanf(line.c_str(), "classes=%d", &value) == 1) {
+            parsed.num_classes = value;
+        } else if (sscanf(line.c_str(), "latency_us=%d", &value) == 1) {
+            parsed.latency_us = value;
+        } else if (sscanf(line.c_str(), "per_item_us=%d", &value) == 1) {
+            parsed.per_item_us = value;
+        } else if (sscanf(line.c_str(), "output=%15s", name) == 1 &&
+                   (strcmp(name, "int8") == 0 || strcmp(name, "float") == 0)) {
+            parsed.output_type = strcmp(name, "float") == 0 ? NN_TENSOR_FLOAT : NN_TENSOR_INT8;
+        } else if (sscanf(line.c_str(), "object=%d,%f,%f,%f,%f,%f,%f,%f", &obj.class_id, &obj.cx, &obj.cy, &obj.w,
+                          &obj.h, &obj.score, &obj.vx, &obj.vy) >= 6) {
+            parsed.objects.push_back(obj);
+        } else {
+            NN_LOG_WARNING("cpu engine: ignoring config line \"%s\"", line.c_str());
+        }
+    }
+    if (!header || parsed.input_size < 32 || parsed.max_batch < 1 || parsed.num_classes < 1) {
+        return false;
+    }
+    config = parsed;
+    return true;
+}
+
+CPUEngine::CPUEngine(const cpu_engine_config_s &config)
+        : config_(config), run_count_(0), item_count_(0), largest_batch_(0) {
+    config_.max_batch = std::max(1, config_.max_batch);
+    if (config_.output_type != NN_TENSOR_FLOAT) {
+        config_.output_type = NN_TENSOR_INT8;
+    }
+}
+
+nn_error_e CPUEngine::LoadModelData(char *modelData, int dataSize) {
+    cpu_engine_config_s config;
+    if (parse_cpu_engine_config(modelData, dataSize, config)) {
+        config_ = config;
+    } else if (modelData != nullptr && dataSize > 0) {
+        NN_LOG_INFO("cpu engine: model data is not a cpu-engine config, using the current config");
+    }
+    SetupShapes();
+    return NN_SUCCESS;
+}
+
+nn_error_e CPUEngine::LoadModelFile(const char *model_file) {
+    FILE *fp = fopen(model_file, "rb");
+    if (fp == nullptr) {
+        NN_LOG_ERROR("open model file %s fail", model_file);
+        return NN_LOAD_MODEL_FAIL;
+    }
+    std::vector<char> data;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        data.insert(data.end(), buf, buf + n);
+    }
+    fclose(fp);
+    return LoadModelData(data.empty() ? nullptr : data.data(), (int) data.size());
+}
+
+void CPUEngine::SetupShapes() {
+    const int batch = config_.max_batch, size = config_.input_size;
+    in_shapes_.clear();
+    out_shapes_.clear();
+
+    tensor_attr_s in;
+    memset(&in, 0, sizeof(in));
+    in.index = 0;
+    in.n_dims = 4;
+    in.dims[0] = batch;
+    in.dims[1] = size;
+    in.dims[2] = size;
+    in.dims[3] = 3;
+    in.n_elems = batch * size * size * 3;
+    in.size = in.n_elems;
+    in.type = NN_TENSOR_UINT8;
+    in.layout = NN_TENSOR_NHWC;
+    in_shapes_.push_back(in);
+
+    for (int b = 0; b < 3; b++) {
+        tensor_attr_s out;
+        memset(&out, 0, sizeof(out));
+        int grid = size / (8 << b);
+        out.index = b;
+        out.n_dims = 4;
+        out.dims[0] = batch;
+        out.dims[1] = 3 * (5 + config_.num_classes);
+        out.dims[2] = grid;
+        out.dims[3] = grid;
+        out.n_elems = batch * out.dims[1] * grid * grid;
+        out.size = out.n_elems * (config_.output_type == NN_TENSOR_FLOAT ? sizeof(float) : 1);
+        out.type = config_.output_type;
+        out.layout = NN_TENSOR_NCHW;
+        out.zp = 0;
+        out.scale = kOutputScale;
+        out_shapes_.push_back(out);
+    }
+}
+
+namespace {
+
+// 按YOLOv5解码公式反推：x = (2 * sigmoid(tx) - 0.5 + j) * stride，w = (2 * sigmoid(tw))^2 * anchor_w
+template <typename T>
+void fill_yolov5_outputs(const cpu_engine_config_s &config, std::vector<tensor_data_s> &outputs, int frame_index) {
+    for (auto &output : outputs) {
+        LogitWriter<T>::fill(output.data, output.attr.size);
+    }
+    const int size = config.input_size, prop_box_size = 5 + config.num_classes;
+    for (const cpu_engine_object_s &obj : config.objects) {
+        if (obj.class_id < 0 || obj.class_id >= config.num_classes) {
+            continue;
+        }
+        int b, a;
+        pick_anchor(obj.w, obj.h, b, a);
+        const int stride = 8 << b, grid = size / stride, grid_len = grid * grid;
+        float cx = wrap(obj.cx + obj.vx * frame_index, size) / stride;
+        float cy = wrap(obj.cy + obj.vy * frame_index, size) / stride;
+        int j = std::min((int) cx, grid - 1), i = std::min((int) cy, grid - 1);
+        void *p = outputs[b].data;
+        int base = (prop_box_size * a) * grid_len + i * grid + j;
+        LogitWriter<T>::put(p, base, (cx - j + 0.5f) / 2);
+        LogitWriter<T>::put(p, base + grid_len, (cy - i + 0.5f) / 2);
+        LogitWriter<T>::put(p, base + 2 * grid_len, sqrtf(obj.w / kAnchors[b][a * 2]) / 2);
+        LogitWriter<T>::put(p, base + 3 * grid_len, sqrtf(obj.h / kAnchors[b][a * 2 + 1]) / 2);
+        LogitWriter<T>::put(p, base + 4 * grid_len, LogitWriter<T>::max_prob());
+        LogitWriter<T>::put(p, base + (5 + obj.class_id) * grid_len, obj.score / LogitWriter<T>::max_prob());
+    }
+}
+
+} // namespace
+
+void CPUEngine::FillOutputs(std::vector<tensor_data_s> &outputs, int frame_index) {
+    if (config_.output_type == NN_TENSOR_FLOAT) {
+        fill_yolov5_outputs<float>(config_, outputs, frame_index);
+    } else {
+        fill_yolov5_outputs<int8_t>(config_, outputs, frame_index);
+    }
+}
+
+void CPUEngine::RecordCall(int items) {
+    run_count_++;
+    item_count_ += items;
+    int largest = largest_batch_.load();
+    while (items > largest && !largest_batch_.compare_exchange_weak(largest, items)) {
+    }
+}
+
+nn_error_e CPUEngine::Run(std::vector<tensor_data_s> &inputs, std::vector<tensor_data_s> &outputs, bool /*want_float*/) {
+    if (inputs.size() != in_shapes_.size() || outputs.size() != out_shapes_.size()) {
+        return NN_IO_NUM_NOT_MATCH;
+    }
+    sleep_us(config_.latency_us + config_.per_item_us);
+    FillOutputs(outputs, item_count_);
+    RecordCall(1);
+    return NN_SUCCESS;
+}
+
+nn_error_e CPUEngine::RunBatch(std::vector<std::vector<tensor_data_s>> &batch_inputs,
+                               std::vector<std::vector<tensor_data_s>> &batch_outputs, bool want_float) {
+    if (config_.max_batch == 1) {
+        return NNEngine::RunBatch(batch_inputs, batch_outputs, want_float);
+    }
+    if (batch_inputs.size() != batch_outputs.size() || batch_inputs.size() > (size_t) config_.max_batch) {
+        return NN_IO_NUM_NOT_MATCH;
+    }
+    sleep_us(config_.latency_us + (int) batch_inputs.size() * config_.per_item_us);
+    int frame_index = item_count_;
+    for (auto &outputs : batch_outputs) {
+        FillOutputs(outputs, frame_index++);
+    }
+    RecordCall((int) batch_inputs.size());
+    return NN_SUCCESS;
+}
+
+std::shared_ptr<NNEngine> CreateCPUEngine() {
+    return std::make_shared<CPUEngine>(cpu_engine_default_config());
+}
+
+std::shared_ptr<NNEngine> CreateCPUEngine(const cpu_engine_config_s &config) {
+    return std::make_shared<CPUEngine>(config);
+}
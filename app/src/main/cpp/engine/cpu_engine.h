@@ -0,0 +1,84 @@
+// CPU参考引擎：不做真实推理，按配置输出合成的YOLOv5输出张量
+//
+// 报告 input_size x input_size NHWC uint8 输入与三个YOLOv5分支（stride 8/16/32，3*(5+C)通道），
+// 输出默认为int8（与量化后的rknn模型相同，zp 0 / scale 0.05，框的量化误差约为框宽高的2.5%），也可为float32。
+// Run() 阻塞 latency_us（+ 每帧 per_item_us），与NPU调用阻塞调用线程的行为一致，然后输出：
+// 背景处objectness极低（后处理找不到框），配置的每个目标编码在最匹配的anchor上，
+// 经Yolov5后处理可得到配置的类别、分数与框（模型输入坐标）。目标可带每帧位移，模拟运动
+// 输出只取决于配置与已处理的帧数，与输入内容无关，结果可复现
+
+#ifndef RK3588_DEMO_CPU_ENGINE_H
+#define RK3588_DEMO_CPU_ENGINE_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "engine.h"
+
+typedef struct _cpu_engine_object_s {
+    int class_id;
+    float cx, cy, w, h; // 模型输入坐标
+    float score;        // 期望的检测分数 (0, 1)
+    float vx, vy;       // 每帧位移（像素），超出模型输入范围时从另一侧回绕
+} cpu_engine_object_s;
+
+typedef struct _cpu_engine_config_s {
+    int input_size;  // 模型输入边长
+    int max_batch;   // 输入batch维
+    int num_classes;
+    int latency_us;  // 每次调用的固定耗时
+    int per_item_us; // 每帧附加耗时
+    tensor_datatype_e output_type; // NN_TENSOR_INT8 或 NN_TENSOR_FLOAT
+    std::vector<cpu_engine_object_s> objects;
+} cpu_engine_config_s;
+
+// 默认配置：640输入，batch 1，80类，int8输出，无耗时，无目标
+cpu_engine_config_s cpu_engine_default_config();
+
+// 解析文本配置，每行一项（'#'开头为注释）：
+//   input_size=640 / batch=4 / classes=80 / latency_us=8000 / per_item_us=1000 / output=int8|float
+//   object=class_id,cx,cy,w,h,score[,vx,vy]
+// 第一行须为 "cpu-engine"，否则返回false（例如传入的是.rknn模型）
+bool parse_cpu_engine_config(const char *text, int size, cpu_engine_config_s &config);
+
+class CPUEngine : public NNEngine
+{
+public:
+    explicit CPUEngine(const cpu_engine_config_s &config);
+    ~CPUEngine() override {}
+
+    // 模型数据为文本配置时使用该配置，否则（空数据或真实模型）保留构造时的配置
+    nn_error_e LoadModelData(char *modelData, int dataSize) override;
+    nn_error_e LoadModelFile(const char *model_file) override;
+    const std::vector<tensor_attr_s> &GetInputShapes() override { return in_shapes_; }
+    const std::vector<tensor_attr_s> &GetOutputShapes() override { return out_shapes_; }
+    nn_error_e Run(std::vector<tensor_data_s> &inputs, std::vector<tensor_data_s> &outputs, bool want_float) override;
+    int GetMaxBatchSize() override { return config_.max_batch; }
+    nn_error_e RunBatch(std::vector<std::vector<tensor_data_s>> &batch_inputs,
+                        std::vector<std::vector<tensor_data_s>> &batch_outputs, bool want_float) override;
+
+    const cpu_engine_config_s &GetConfig() const { return config_; }
+
+    // 引擎调用次数 / 处理的总帧数 / 观察到的最大batch
+    int getRunCount() const { return run_count_; }
+    int getItemCount() const { return item_count_; }
+    int getLargestBatch() const { return largest_batch_; }
+
+private:
+    void SetupShapes();
+    void FillOutputs(std::vector<tensor_data_s> &outputs, int frame_index);
+    void RecordCall(int items);
+
+    cpu_engine_config_s config_;
+    std::vector<tensor_attr_s> in_shapes_;
+    std::vector<tensor_attr_s> out_shapes_;
+    std::atomic<int> run_count_;
+    std::atomic<int> item_count_;
+    std::atomic<int> largest_batch_;
+};
+
+std::shared_ptr<NNEngine> CreateCPUEngine();                                   // 默认配置
+std::shared_ptr<NNEngine> CreateCPUEngine(const cpu_engine_config_s &config); // 指定配置
+
+#endif // RK3588_DEMO_CPU_ENGINE_H
@@ -7,6 +7,7 @@
 #include "datatype.h"
 #include <vector>
 #include <memory>
+#include <string>
 
 class NNEngine
 {
@@ -21,6 +22,41 @@ public:
     virtual nn_error_e Run(std::vector<tensor_data_s> &inputs, std::vector<tensor_data_s> &outpus, bool want_float) = 0; // 运行模型
     virtual nn_error_e LoadModelData(char *modelData, int dataSize) = 0;
 
+    // 模型一次推理可处理的帧数（输入张量的batch维），默认为1
+    virtual int GetMaxBatchSize() { return 1; }
+
+    // 模型转换时写入的自定义字符串（如类别标签），没有时返回空串
+    virtual std::string GetCustomString() { return std::string(); }
+
+    // 与已加载同一模型的引擎共享权重（如rknn_dup_context），不支持时返回NN_LOAD_MODEL_FAIL，调用方应退回完整加载
+    virtual nn_error_e LoadModelShared(const std::shared_ptr<NNEngine> &/*base*/) { return NN_LOAD_MODEL_FAIL; }
+
+    // 指定运行的NPU核心（位掩码，取值同rknn_core_mask，0为自动），不支持的引擎忽略
+    virtual nn_error_e SetCoreMask(uint32_t /*core_mask*/) { return NN_SUCCESS; }
+
+    // 模型权重占用的内存（字节），未知时返回0
+    virtual size_t GetWeightMemorySize() { return 0; }
+
+    // 批量推理：batch_inputs[k]/batch_outputs[k]为第k帧的输入/输出张量（单帧形状）
+    // 默认实现逐帧调用Run；支持batch>1的引擎应覆盖为一次调用以摊薄每次推理的固定开销
+    virtual nn_error_e RunBatch(std::vector<std::vector<tensor_data_s>> &batch_inputs,
+                                std::vector<std::vector<tensor_data_s>> &batch_outputs, bool want_float)
+    {
+        if (batch_inputs.size() != batch_outputs.size())
+        {
+            return NN_IO_NUM_NOT_MATCH;
+        }
+        for (size_t k = 0; k < batch_inputs.size(); k++)
+        {
+            nn_error_e ret = Run(batch_inputs[k], batch_outputs[k], want_float);
+            if (ret != NN_SUCCESS)
+            {
+                return ret;
+            }
+        }
+        return NN_SUCCESS;
+    }
+
 };
 
 std::shared_ptr<NNEngine> CreateRKNNEngine(); // 创建RKNN引擎
@@ -0,0 +1,88 @@
+// 推理引擎注册表
+
+#include "engine_registry.h"
+
+#include <stdlib.h>
+
+#include <map>
+#include <mutex>
+
+#include "cpu_engine.h"
+#include "logging.h"
+
+namespace {
+
+struct Registry {
+    std::mutex mutex;
+    std::map<std::string, nn_engine_factory_t> factories;
+    std::string default_name;
+
+    Registry() : default_name("rknn") {
+        factories["rknn"] = CreateRKNNEngine;
+        factories["cpu"] = [] { return CreateCPUEngine(); };
+        const char *env = getenv("NN_ENGINE");
+        if (env != nullptr && factories.count(env) > 0) {
+            default_name = env;
+        }
+    }
+};
+
+// 首次使用时构造，不依赖静态初始化顺序
+Registry &registry() {
+    static Registry instance;
+    return instance;
+}
+
+} // namespace
+
+void RegisterNNEngine(const std::string &name, const nn_engine_factory_t &factory) {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.factories[name] = factory;
+}
+
+std::shared_ptr<NNEngine> CreateNNEngine(const std::string &name) {
+    nn_engine_factory_t factory;
+    {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        auto it = r.factories.find(name);
+        if (it == r.factories.end()) {
+            NN_LOG_ERROR("unknown nn engine: %s", name.c_str());
+            return nullptr;
+        }
+        factory = it->second;
+    }
+    return factory();
+}
+
+std::shared_ptr<NNEngine> CreateDefaultNNEngine() {
+    return CreateNNEngine(GetDefaultNNEngine());
+}
+
+bool SetDefaultNNEngine(const std::string &name) {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    if (r.factories.count(name) == 0) {
+        NN_LOG_ERROR("unknown nn engine: %s", name.c_str());
+        return false;
+    }
+    r.default_name = name;
+    return true;
+}
+
+std::string GetDefaultNNEngine() {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.default_name;
+}
+
+std::vector<std::string> ListNNEngines() {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::vector<std::string> names;
+    for (const auto &entry : r.factories) {
+        names.push_back(entry.first);
+    }
+    return names;
+}
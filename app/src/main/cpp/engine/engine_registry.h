@@ -0,0 +1,36 @@
+// 推理引擎注册表：按名称创建NNEngine
+//
+// 内置 "rknn"（RKEngine，NPU）与 "cpu"（CPUEngine，合成输出，用于无NPU环境下的测试与基准）；
+// Yolov5 / Yolov5ThreadPool / InferenceScheduler 未指定引擎时使用默认引擎。
+// 默认引擎为 "rknn"，可由环境变量 NN_ENGINE 或 SetDefaultNNEngine 修改
+
+#ifndef RK3588_DEMO_ENGINE_REGISTRY_H
+#define RK3588_DEMO_ENGINE_REGISTRY_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "engine.h"
+
+typedef std::function<std::shared_ptr<NNEngine>()> nn_engine_factory_t;
+
+// 注册引擎工厂，同名时覆盖
+void RegisterNNEngine(const std::string &name, const nn_engine_factory_t &factory);
+
+// 按名称创建引擎，未注册时返回nullptr
+std::shared_ptr<NNEngine> CreateNNEngine(const std::string &name);
+
+// 创建默认引擎
+std::shared_ptr<NNEngine> CreateDefaultNNEngine();
+
+// 设置默认引擎，名称未注册时返回false且不修改
+bool SetDefaultNNEngine(const std::string &name);
+
+std::string GetDefaultNNEngine();
+
+// 已注册的引擎名称（按名称排序）
+std::vector<std::string> ListNNEngines();
+
+#endif // RK3588_DEMO_ENGINE_REGISTRY_H
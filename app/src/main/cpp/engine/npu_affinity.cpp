@@ -0,0 +1,79 @@
+// NPU多核亲和与权重共享策略
+
+#include "npu_affinity.h"
+
+#include <algorithm>
+
+npu_affinity_config_s npu_affinity_default_config() {
+    npu_affinity_config_s config;
+    config.policy = NPU_POLICY_AUTO;
+    config.num_cores = 3;
+    config.first_core = 0;
+    config.pinned_mask = NPU_CORE_AUTO;
+    config.share_weights = true;
+    return config;
+}
+
+uint32_t npu_core_mask_for_worker(const npu_affinity_config_s &config, int worker) {
+    switch (config.policy) {
+        case NPU_POLICY_ROUND_ROBIN: {
+            int num_cores = std::max(1, config.num_cores);
+            int core = ((config.first_core + worker) % num_cores + num_cores) % num_cores;
+            return 1u << core;
+        }
+        case NPU_POLICY_PINNED:
+            return config.pinned_mask;
+        case NPU_POLICY_AUTO:
+        default:
+            return NPU_CORE_AUTO;
+    }
+}
+
+NpuUsageTracker::NpuUsageTracker(int num_cores)
+        : num_cores_(std::max(1, num_cores)), busy_us_(new std::atomic<int64_t>[std::max(1, num_cores)]),
+          has_sample_(false), last_sample_us_(0), last_busy_us_(std::max(1, num_cores), 0) {
+    for (int i = 0; i < num_cores_; i++) {
+        busy_us_[i] = 0;
+    }
+}
+
+void NpuUsageTracker::AddBusy(uint32_t core_mask, int64_t busy_us) {
+    if (busy_us <= 0) {
+        return;
+    }
+    core_mask &= (1u << num_cores_) - 1;
+    if (core_mask == 0) {
+        for (int i = 0; i < num_cores_; i++) {
+            busy_us_[i] += busy_us / num_cores_;
+        }
+        return;
+    }
+    for (int i = 0; i < num_cores_; i++) {
+        if (core_mask & (1u << i)) {
+            busy_us_[i] += busy_us;
+        }
+    }
+}
+
+int64_t NpuUsageTracker::GetBusyUs(int core) const {
+    if (core < 0 || core >= num_cores_) {
+        return 0;
+    }
+    return busy_us_[core];
+}
+
+std::vector<float> NpuUsageTracker::Sample(int64_t now_us) {
+    std::lock_guard<std::mutex> lock(sample_mutex_);
+    std::vector<float> usage(num_cores_, 0.f);
+    int64_t elapsed = now_us - last_sample_us_;
+    for (int i = 0; i < num_cores_; i++) {
+        int64_t busy = busy_us_[i];
+        if (has_sample_ && elapsed > 0) {
+            usage[i] = std::min(1.f, std::max(0.f, (float) (busy - last_busy_us_[i]) / elapsed));
+        }
+        last_busy_us_[i] = busy;
+    }
+    has_sample_ = true;
+    last_sample_us_ = now_us;
+    return usage;
+}
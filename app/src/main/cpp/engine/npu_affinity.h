@@ -0,0 +1,80 @@
+// NPU多核亲和与权重共享策略
+//
+// RK3588的NPU有3个核心。每个工作实例拥有独立的rknn context时，未设置core mask的context由驱动自动调度，
+// 多个实例可能挤在同一核心上；且每个context各自持有一份模型权重。这里定义：
+//   - 每个工作实例的核心分配策略：自动 / 轮询（实例i使用核心 (first_core+i)%num_cores）/ 固定掩码；
+//   - 是否让同一模型的后续实例复制首个实例的context（NNEngine::LoadModelShared）以共享权重；
+//   - NpuUsageTracker：按核心累计推理耗时，换算为各核心利用率供SystemPerformanceMonitor上报。
+// 策略本身不依赖rknn运行时，可在桩引擎上测试
+
+#ifndef RK3588_DEMO_NPU_AFFINITY_H
+#define RK3588_DEMO_NPU_AFFINITY_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// 与rknn_core_mask取值一致
+typedef enum {
+    NPU_CORE_AUTO = 0,
+    NPU_CORE_0 = 1,
+    NPU_CORE_1 = 2,
+    NPU_CORE_2 = 4,
+    NPU_CORE_0_1 = 3,
+    NPU_CORE_0_1_2 = 7,
+} npu_core_mask_e;
+
+typedef enum {
+    NPU_POLICY_AUTO = 0,    // 不设置core mask，由驱动调度
+    NPU_POLICY_ROUND_ROBIN, // 实例i固定在核心 (first_core + i) % num_cores
+    NPU_POLICY_PINNED,      // 所有实例使用pinned_mask
+} npu_core_policy_e;
+
+class NpuUsageTracker;
+
+typedef struct _npu_affinity_config_s {
+    npu_core_policy_e policy;
+    int num_cores;        // NPU核心数，RK3588为3
+    int first_core;       // 轮询的起始核心，多个线程池错开起点可避免都从核心0开始
+    uint32_t pinned_mask; // NPU_POLICY_PINNED时使用
+    bool share_weights;   // 后续实例复制首个实例的context，共享权重内存
+    std::shared_ptr<NpuUsageTracker> usage_tracker; // 非空时各实例的推理耗时计入该统计（可跨线程池共享）
+} npu_affinity_config_s;
+
+// 默认配置：自动调度，共享权重，3核，不统计
+npu_affinity_config_s npu_affinity_default_config();
+
+// 第worker个实例应使用的core mask
+uint32_t npu_core_mask_for_worker(const npu_affinity_config_s &config, int worker);
+
+// 按核心累计推理耗时，线程安全
+class NpuUsageTracker {
+public:
+    explicit NpuUsageTracker(int num_cores = 3);
+
+    int GetNumCores() const { return num_cores_; }
+
+    // 记录一次在core_mask上的推理耗时：单核掩码计入该核；多核掩码计入每个涉及的核；
+    // 自动调度（0）时无法得知实际核心，按核心数均摊
+    void AddBusy(uint32_t core_mask, int64_t busy_us);
+
+    // 累计的忙碌时间（微秒）
+    int64_t GetBusyUs(int core) const;
+
+    // 各核心自上次采样以来的利用率 [0, 1]，now_us为单调时钟；首次调用建立基准并返回0
+    std::vector<float> Sample(int64_t now_us);
+
+private:
+    int num_cores_;
+    std::unique_ptr<std::atomic<int64_t>[]> busy_us_;
+
+    std::mutex sample_mutex_;
+    bool has_sample_;
+    int64_t last_sample_us_;
+    std::vector<int64_t> last_busy_us_;
+};
+
+#endif // RK3588_DEMO_NPU_AFFINITY_H
@@ -4,6 +4,8 @@
 
 #include <string.h>
 
+#include <algorithm>
+
 #include "engine_helper.h"
 #include "logging.h"
 
@@ -30,63 +32,7 @@ nn_error_e RKEngine::LoadModelFile(const char *model_file) {
     NN_LOG_INFO("rknn_init success!");
     ctx_created_ = true;
 
-    // 获取rknn版本信息
-    rknn_sdk_version version;
-    ret = rknn_query(rknn_ctx_, RKNN_QUERY_SDK_VERSION, &version, sizeof(rknn_sdk_version));
-    if (ret < 0) {
-        NN_LOG_ERROR("rknn_query fail! ret=%d", ret);
-        return NN_RKNN_QUERY_FAIL;
-    }
-    // 打印rknn版本信息
-    NN_LOG_INFO("RKNN API version: %s", version.api_version);
-    NN_LOG_INFO("RKNN Driver version: %s", version.drv_version);
-
-    // 获取输入输出个数
-    rknn_input_output_num io_num;
-    ret = rknn_query(rknn_ctx_, RKNN_QUERY_IN_OUT_NUM, &io_num, sizeof(io_num));
-    if (ret != RKNN_SUCC) {
-        NN_LOG_ERROR("rknn_query fail! ret=%d", ret);
-        return NN_RKNN_QUERY_FAIL;
-    }
-    NN_LOG_INFO("model input num: %d, output num: %d", io_num.n_input, io_num.n_output);
-
-    // 保存输入输出个数
-    input_num_ = io_num.n_input;
-    output_num_ = io_num.n_output;
-
-    // 输入属性
-    NN_LOG_INFO("input tensors:");
-    rknn_tensor_attr input_attrs[io_num.n_input];
-    memset(input_attrs, 0, sizeof(input_attrs));
-    for (int i = 0; i < io_num.n_input; i++) {
-        input_attrs[i].index = i;
-        ret = rknn_query(rknn_ctx_, RKNN_QUERY_INPUT_ATTR, &(input_attrs[i]), sizeof(rknn_tensor_attr));
-        if (ret != RKNN_SUCC) {
-            NN_LOG_ERROR("rknn_query fail! ret=%d", ret);
-            return NN_RKNN_QUERY_FAIL;
-        }
-        print_tensor_attr(&(input_attrs[i]));
-        // set input_shapes_
-        in_shapes_.push_back(rknn_tensor_attr_convert(input_attrs[i]));
-    }
-
-    // 输出属性
-    NN_LOG_INFO("output tensors:");
-    rknn_tensor_attr output_attrs[io_num.n_output];
-    memset(output_attrs, 0, sizeof(output_attrs));
-    for (int i = 0; i < io_num.n_output; i++) {
-        output_attrs[i].index = i;
-        ret = rknn_query(rknn_ctx_, RKNN_QUERY_OUTPUT_ATTR, &(output_attrs[i]), sizeof(rknn_tensor_attr));
-        if (ret != RKNN_SUCC) {
-            NN_LOG_ERROR("rknn_query fail! ret=%d", ret);
-            return NN_RKNN_QUERY_FAIL;
-        }
-        print_tensor_attr(&(output_attrs[i]));
-        // set output_shapes_
-        out_shapes_.push_back(rknn_tensor_attr_convert(output_attrs[i]));
-    }
-
-    return NN_SUCCESS;
+    return QueryModelInfo();
 }
 
 
@@ -105,6 +51,34 @@ nn_error_e RKEngine::LoadModelData(char *modelData, int dataSize) {
     NN_LOG_INFO("rknn_init success!");
     ctx_created_ = true;
 
+    return QueryModelInfo();
+}
+
+
+/**
+ * @brief 复制已加载模型的rknn context（rknn_dup_context），与其共享权重内存
+ * @param base 已加载同一模型的RKEngine，本引擎持有其引用直至销毁
+ * @return nn_error_e 错误码
+ */
+nn_error_e RKEngine::LoadModelShared(const std::shared_ptr<NNEngine> &base) {
+    auto src = std::dynamic_pointer_cast<RKEngine>(base);
+    if (src == nullptr || !src->ctx_created_ || ctx_created_) {
+        return NN_LOAD_MODEL_FAIL;
+    }
+    int ret = rknn_dup_context(&src->rknn_ctx_, &rknn_ctx_);
+    if (ret < 0) {
+        NN_LOG_WARNING("rknn_dup_context fail! ret=%d", ret);
+        return NN_RKNN_INIT_FAIL;
+    }
+    NN_LOG_INFO("rknn_dup_context success!");
+    ctx_created_ = true;
+    shared_base_ = src;
+    return QueryModelInfo();
+}
+
+// 查询版本信息与输入输出张量属性
+nn_error_e RKEngine::QueryModelInfo() {
+    int ret;
     // 获取rknn版本信息
     rknn_sdk_version version;
     ret = rknn_query(rknn_ctx_, RKNN_QUERY_SDK_VERSION, &version, sizeof(rknn_sdk_version));
@@ -164,6 +138,33 @@ nn_error_e RKEngine::LoadModelData(char *modelData, int dataSize) {
     return NN_SUCCESS;
 }
 
+// 设置运行的NPU核心（rknn_core_mask取值）
+nn_error_e RKEngine::SetCoreMask(uint32_t core_mask) {
+    if (!ctx_created_) {
+        return NN_RKNN_MODEL_NOT_LOAD;
+    }
+    int ret = rknn_set_core_mask(rknn_ctx_, (rknn_core_mask) core_mask);
+    if (ret < 0) {
+        NN_LOG_ERROR("rknn_set_core_mask(%u) fail! ret=%d", core_mask, ret);
+        return NN_RKNN_RUNTIME_ERROR;
+    }
+    return NN_SUCCESS;
+}
+
+// 模型权重占用的内存（RKNN_QUERY_MEM_SIZE）
+size_t RKEngine::GetWeightMemorySize() {
+    if (!ctx_created_) {
+        return 0;
+    }
+    rknn_mem_size mem_size;
+    memset(&mem_size, 0, sizeof(mem_size));
+    int ret = rknn_query(rknn_ctx_, RKNN_QUERY_MEM_SIZE, &mem_size, sizeof(mem_size));
+    if (ret != RKNN_SUCC) {
+        NN_LOG_WARNING("rknn_query mem size fail! ret=%d", ret);
+        return 0;
+    }
+    return mem_size.total_weight_size;
+}
 
 // 获取输入张量的形状
 const std::vector<tensor_attr_s> &RKEngine::GetInputShapes() {
@@ -175,6 +176,22 @@ const std::vector<tensor_attr_s> &RKEngine::GetOutputShapes() {
     return out_shapes_;
 }
 
+// 获取模型转换时写入的自定义字符串
+std::string RKEngine::GetCustomString() {
+    if (!ctx_created_) {
+        return std::string();
+    }
+    rknn_custom_string custom_string;
+    memset(&custom_string, 0, sizeof(custom_string));
+    int ret = rknn_query(rknn_ctx_, RKNN_QUERY_CUSTOM_STRING, &custom_string, sizeof(custom_string));
+    if (ret != RKNN_SUCC) {
+        NN_LOG_WARNING("rknn_query custom string fail! ret=%d", ret);
+        return std::string();
+    }
+    custom_string.string[sizeof(custom_string.string) - 1] = '\0';
+    return std::string(custom_string.string);
+}
+
 /**
  * @brief 运行模型，获得推理结果
  * @param inputs 输入张量
@@ -236,6 +253,105 @@ nn_error_e RKEngine::Run(std::vector<tensor_data_s> &inputs, std::vector<tensor_
     return NN_SUCCESS;
 }
 
+// 输入张量的batch维（NCHW/NHWC的dims[0]），未加载模型时为1
+int RKEngine::GetMaxBatchSize() {
+    if (in_shapes_.empty() || in_shapes_[0].dims[0] < 1) {
+        return 1;
+    }
+    return (int) in_shapes_[0].dims[0];
+}
+
+/**
+ * @brief 批量推理：把最多batch帧的输入拼接成模型的完整输入，一次rknn_run，再把输出按帧拆分
+ * @param batch_inputs 每帧的输入张量（单帧形状）
+ * @param batch_outputs 每帧的输出张量（单帧形状）
+ * @param want_float 是否需要float类型的输出
+ * @return nn_error_e 错误码
+ */
+nn_error_e RKEngine::RunBatch(std::vector<std::vector<tensor_data_s>> &batch_inputs,
+                              std::vector<std::vector<tensor_data_s>> &batch_outputs, bool want_float) {
+    int batch = GetMaxBatchSize();
+    size_t count = batch_inputs.size();
+    if (batch == 1) {
+        return NNEngine::RunBatch(batch_inputs, batch_outputs, want_float);
+    }
+    if (count != batch_outputs.size()) {
+        return NN_IO_NUM_NOT_MATCH;
+    }
+    // 帧数超过模型batch时分块推理
+    if (count > (size_t) batch) {
+        for (size_t begin = 0; begin < count; begin += batch) {
+            size_t end = std::min(count, begin + batch);
+            std::vector<std::vector<tensor_data_s>> in(batch_inputs.begin() + begin, batch_inputs.begin() + end);
+            std::vector<std::vector<tensor_data_s>> out(batch_outputs.begin() + begin, batch_outputs.begin() + end);
+            nn_error_e ret = RunBatch(in, out, want_float);
+            if (ret != NN_SUCCESS) {
+                return ret;
+            }
+        }
+        return NN_SUCCESS;
+    }
+    for (size_t k = 0; k < count; k++) {
+        if (batch_inputs[k].size() != input_num_ || batch_outputs[k].size() != output_num_) {
+            NN_LOG_ERROR("batch item %zu io num not match", k);
+            return NN_IO_NUM_NOT_MATCH;
+        }
+    }
+
+    // 拼接输入：模型输入为batch帧连续存放，不足batch的尾部沿用缓冲区旧数据，其输出直接丢弃
+    batch_inputs_buf_.resize(input_num_);
+    rknn_input rknn_inputs[g_max_io_num];
+    for (uint32_t i = 0; i < input_num_; i++) {
+        size_t item_size = batch_inputs[0][i].attr.size;
+        std::vector<uint8_t> &buf = batch_inputs_buf_[i];
+        if (buf.size() != item_size * batch) {
+            buf.assign(item_size * batch, 0);
+        }
+        for (size_t k = 0; k < count; k++) {
+            memcpy(buf.data() + k * item_size, batch_inputs[k][i].data, item_size);
+        }
+        tensor_data_s packed = batch_inputs[0][i];
+        packed.attr.size = (uint32_t) buf.size();
+        packed.data = buf.data();
+        rknn_inputs[i] = tensor_data_to_rknn_input(packed);
+    }
+    int ret = rknn_inputs_set(rknn_ctx_, input_num_, rknn_inputs);
+    if (ret < 0) {
+        NN_LOG_ERROR("rknn_inputs_set fail! ret=%d", ret);
+        return NN_RKNN_INPUT_SET_FAIL;
+    }
+
+    ret = rknn_run(rknn_ctx_, nullptr);
+    if (ret < 0) {
+        NN_LOG_ERROR("rknn_run fail! ret=%d", ret);
+        return NN_RKNN_RUNTIME_ERROR;
+    }
+
+    rknn_output rknn_outputs[g_max_io_num];
+    memset(rknn_outputs, 0, sizeof(rknn_outputs));
+    for (int i = 0; i < output_num_; ++i) {
+        rknn_outputs[i].want_float = want_float ? 1 : 0;
+    }
+    ret = rknn_outputs_get(rknn_ctx_, output_num_, rknn_outputs, NULL);
+    if (ret < 0) {
+        NN_LOG_ERROR("rknn_outputs_get fail! ret=%d", ret);
+        return NN_RKNN_OUTPUT_GET_FAIL;
+    }
+
+    // 拆分输出：每个输出张量的dims[0]同为batch，按帧等分
+    for (int i = 0; i < output_num_; ++i) {
+        uint32_t item_size = rknn_outputs[i].size / batch;
+        for (size_t k = 0; k < count; k++) {
+            tensor_data_s &data = batch_outputs[k][i];
+            data.attr.index = rknn_outputs[i].index;
+            data.attr.size = item_size;
+            memcpy(data.data, (uint8_t *) rknn_outputs[i].buf + k * item_size, item_size);
+        }
+    }
+    rknn_outputs_release(rknn_ctx_, output_num_, rknn_outputs);
+    return NN_SUCCESS;
+}
+
 // 析构函数
 RKEngine::~RKEngine() {
     if (ctx_created_) {
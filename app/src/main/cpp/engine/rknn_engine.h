@@ -18,11 +18,20 @@ public:
 
     nn_error_e LoadModelData(char *modelData, int dataSize) override;
     nn_error_e LoadModelFile(const char *model_file) override;                                                         // 加载模型文件
+    nn_error_e LoadModelShared(const std::shared_ptr<NNEngine> &base) override;                                        // rknn_dup_context，共享权重
+    nn_error_e SetCoreMask(uint32_t core_mask) override;                                                               // rknn_set_core_mask
+    size_t GetWeightMemorySize() override;                                                                             // RKNN_QUERY_MEM_SIZE
     const std::vector<tensor_attr_s> &GetInputShapes() override;                                                       // 获取输入张量的形状
     const std::vector<tensor_attr_s> &GetOutputShapes() override;                                                      // 获取输出张量的形状
     nn_error_e Run(std::vector<tensor_data_s> &inputs, std::vector<tensor_data_s> &outputs, bool want_float) override; // 运行模型
+    int GetMaxBatchSize() override;                                                                                    // 输入张量的batch维
+    std::string GetCustomString() override;                                                                            // RKNN_QUERY_CUSTOM_STRING
+    nn_error_e RunBatch(std::vector<std::vector<tensor_data_s>> &batch_inputs,
+                        std::vector<std::vector<tensor_data_s>> &batch_outputs, bool want_float) override;           // 多帧拼成一个batch推理
 
 private:
+    nn_error_e QueryModelInfo(); // 查询输入输出张量属性
+
     // rknn context
     rknn_context rknn_ctx_; // rknn context
     bool ctx_created_;      // rknn context是否创建
@@ -32,6 +41,10 @@ private:
 
     std::vector<tensor_attr_s> in_shapes_;  // 输入张量的形状
     std::vector<tensor_attr_s> out_shapes_; // 输出张量的形状
+
+    std::shared_ptr<RKEngine> shared_base_; // 共享权重的源引擎，须在本context销毁后释放
+
+    std::vector<std::vector<uint8_t>> batch_inputs_buf_; // 批量推理时拼接各帧输入的缓冲区，按输入张量复用
 };
 
 #endif // RK3588_DEMO_RKNN_ENGINE_H
@@ -10,11 +10,15 @@
 #include <condition_variable>
 #include <android/native_window.h>
 #include "ZLPlayer.h"
+#include "PerChannelDetection.h"
 #include "user_comm.h"
 #include "log4c.h"
 
 #define MAX_CHANNELS 16
-#define SHARED_THREAD_POOL_SIZE 20
+// Engine workers of the process-wide inference scheduler (one RKNN context each)
+#define SHARED_INFERENCE_WORKERS 3
+// Render threads presenting all channels at their frames' deadlines
+#define SHARED_RENDER_THREADS 2
 #define PERFORMANCE_UPDATE_INTERVAL_MS 1000
 
 // Forward declarations
@@ -66,11 +70,6 @@ public:
                 context->yolov5ThreadPool = nullptr;
             }
 
-            if (context->renderFrameQueue) {
-                delete context->renderFrameQueue;
-                context->renderFrameQueue = nullptr;
-            }
-
             if (context->decoder) {
                 delete context->decoder;
                 context->decoder = nullptr;
@@ -121,6 +120,8 @@ public:
         float renderFps;
         std::string errorMessage;
         int retryCount;
+        int priority;                   // Inference scheduling weight (>= 1)
+        DetectionCadence::Config cadence; // Which frames go to the NPU, applied to the player on start
 
         // Frame rate control
         std::chrono::microseconds frameInterval;
@@ -138,6 +139,7 @@ public:
             fps(0.0f),
             renderFps(0.0f),
             retryCount(0),
+            priority(1),
             frameInterval(std::chrono::microseconds(33333)), // ~30 FPS
             frameSkipCounter(0) {}
     };
@@ -145,7 +147,8 @@ public:
     struct SharedResources {
         char* modelData;
         int modelSize;
-        std::shared_ptr<Yolov5ThreadPool> sharedThreadPool;
+        std::shared_ptr<InferenceScheduler> inferenceScheduler;
+        std::shared_ptr<MultiSurfaceRenderer> surfaceRenderer;
         std::mutex resourceMutex;
         
         SharedResources() : modelData(nullptr), modelSize(0) {}
@@ -225,6 +228,13 @@ public:
     bool setChannelSurface(int channelIndex, ANativeWindow* surface);
     bool setChannelRTSPUrl(int channelIndex, const char* rtspUrl);
     bool setChannelDetectionEnabled(int channelIndex, bool enabled);
+    // Detection cadence fields of config (detectInterval, adaptiveCadence, maxDetectInterval)
+    bool setChannelDetectionCadence(int channelIndex, const PerChannelDetection::DetectionConfig& config);
+    bool setChannelPriority(int channelIndex, int priority);
+    bool setActiveChannel(int channelIndex, bool active);
+    // NMS fields of config (enableNMS, nmsMode, nmsThreshold, nmsTopK); the scheduler's workers
+    // are shared, so they apply to every channel
+    bool setDetectionNmsConfig(const PerChannelDetection::DetectionConfig& config);
     
     // Channel state
     ChannelState getChannelState(int channelIndex);
@@ -232,6 +242,8 @@ public:
     int getChannelFrameCount(int channelIndex);
     int getChannelDetectionCount(int channelIndex);
     std::string getChannelError(int channelIndex);
+    bool getChannelInferenceStats(int channelIndex, InferenceScheduler::ChannelStats& stats);
+    bool getChannelPresentStats(int channelIndex, MultiSurfaceRenderer::PresentStats& stats);
     
     // System status
     int getActiveChannelCount();
@@ -279,22 +291,16 @@ protected:
     int channelIndex;
     NativeChannelManager* channelManager;
     ChannelContextRAII channelContext;   // RAII-managed context for this channel
-    ANativeWindow* channelSurface;       // Independent surface for this channel
     mutable std::mutex channelMutex;    // Mutex for thread safety (use std::mutex for consistency)
     std::atomic<bool> detectionEnabled; // Use atomic for thread-safe access
     std::string channelRtspUrl;
     std::unique_ptr<char[]> modelData;   // Use smart pointer for automatic memory management
     int modelDataSize;                   // Model data size
 
-    // Frame rate control
-    std::chrono::steady_clock::time_point lastFrameTime;
-    std::chrono::steady_clock::time_point lastRenderTime;
-    std::atomic<int> frameSkipCounter;
-    std::atomic<float> currentFps;
-    
 public:
-    MultiChannelZLPlayer(int channelIndex, char* modelFileData, int modelDataLen, 
-                        NativeChannelManager* manager);
+    MultiChannelZLPlayer(int channelIndex, char* modelFileData, int modelDataLen,
+                        NativeChannelManager* manager, InferenceScheduler* scheduler = nullptr,
+                        MultiSurfaceRenderer* renderer = nullptr);
     ~MultiChannelZLPlayer();
     
     // Channel-specific callback methods
@@ -304,11 +310,11 @@ public:
     
     // Channel-specific configuration
     void setChannelRTSPUrl(const char* url);
+    // Forwards to ZLPlayer::setChannelSurface, the surface the render pool presents into
     void setChannelSurface(ANativeWindow* surface);
     void setDetectionEnabled(bool enabled);
 
     // Override parent methods for channel-specific behavior
-    void display();
     void get_detect_result();
 
     // Channel-specific frame callback
@@ -325,15 +331,6 @@ public:
     bool isChannelActive() const;
     int getChannelIndex() const { return channelIndex; }
     const std::string& getRTSPUrl() const { return channelRtspUrl; }
-
-    // Channel-specific rendering
-    void renderToChannelSurface(frame_data_t* frameData);
-
-    // Frame rate control methods
-    bool shouldProcessFrame();
-    bool shouldRenderFrame();
-    void updateFrameRateStats();
-    void adaptiveFrameSkipping();
 };
 
 // Thread-safe frame callback wrapper
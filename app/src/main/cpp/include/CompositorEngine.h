@@ -0,0 +1,149 @@
+#ifndef AIBOX_COMPOSITOR_ENGINE_H
+#define AIBOX_COMPOSITOR_ENGINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "image_kernels.h"
+#include "user_comm.h"
+
+/**
+ * Compositor Engine
+ * Builds the unified RGBA frame of MultiChannelFrameCompositor from the
+ * latest frame of every visible channel.
+ *
+ * - Canvases come from a small ring and are handed out as shared_ptr; a canvas
+ *   returns to the ring when the last consumer drops it. Each canvas remembers
+ *   the layout and the frame sequence of every layer it holds, so a compose
+ *   only redraws the layers whose frame changed since that canvas was last
+ *   drawn. The background is filled only when the layout changes.
+ * - Each layer scales through a row/column map built once per viewport and
+ *   source size (process/image_kernels, bilinear or nearest, NEON/SSE2).
+ * - Dirty layers are split into bands of tileRows rows that run on a worker
+ *   pool; the composing thread works on tiles too. Layers that overlap are
+ *   drawn one after the other so the later layer stays on top.
+ *
+ * Layers that do not fit inside the canvas are skipped. compose() is meant
+ * to be called from one thread (the composition loop); concurrent calls are
+ * serialised.
+ */
+class CompositorEngine {
+public:
+    struct Config {
+        int width;                // Canvas size in pixels (stride = width * 4)
+        int height;
+        uint32_t backgroundColor; // Written as is into RGBA memory
+        scale_filter_e filter;
+        int workerThreads;        // Threads besides the composing one; 0 composes on the caller only
+        int tileRows;             // Destination rows per tile
+        int maxCanvases;          // Canvases in the ring; compose() fails while all are held
+
+        Config() : width(1920), height(1080), backgroundColor(0xFF000000), filter(SCALE_FILTER_BILINEAR),
+                   workerThreads(3), tileRows(32), maxCanvases(8) {}
+    };
+
+    struct Layer {
+        int id;                              // Channel index
+        int x, y, width, height;             // Viewport on the canvas
+        std::shared_ptr<frame_data_t> frame; // nullptr: the viewport shows the background
+        uint64_t sequence;                   // Changes whenever frame changes
+
+        Layer() : id(-1), x(0), y(0), width(0), height(0), sequence(0) {}
+    };
+
+    struct Stats {
+        uint64_t frames;        // Successful compose() calls
+        uint64_t fullRedraws;   // Composes that filled the background (layout change or new canvas)
+        uint64_t layersDrawn;   // Layers scaled (or cleared) into a canvas
+        uint64_t layersReused;  // Layers already up to date in the canvas
+        uint64_t tiles;
+        uint64_t noCanvas;      // compose() calls that found every canvas held by consumers
+    };
+
+    explicit CompositorEngine(const Config& config = Config());
+    ~CompositorEngine();
+
+    // Drops the canvas ring and restarts the workers. Canvases still held by consumers stay valid.
+    void configure(const Config& config);
+    Config getConfig() const;
+    int stride() const;
+
+    // Brings a free canvas up to date with layers and returns it; nullptr if every canvas is held
+    std::shared_ptr<uint8_t> compose(const std::vector<Layer>& layers);
+
+    Stats getStats() const;
+
+private:
+    // What a canvas holds for one layer
+    struct DrawnLayer {
+        int id;
+        int x, y, width, height;
+        uint64_t sequence;
+    };
+
+    struct Canvas {
+        std::unique_ptr<uint8_t[]> pixels;
+        std::vector<DrawnLayer> drawn;
+        bool valid;      // Background filled and drawn describes the content
+        bool inUse;
+        uint64_t composedAt;
+    };
+
+    // Shared with the deleters of the canvases handed out, so they can outlive the engine
+    struct CanvasRing {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Canvas>> canvases;
+    };
+
+    struct Tile {
+        int layer;
+        int rowBegin;
+        int rowEnd;
+    };
+
+    Canvas* acquireCanvas(std::shared_ptr<uint8_t>& handle);
+    bool fitsCanvas(const Layer& layer) const;
+    void drawTile(const Tile& tile, uint8_t* canvas);
+
+    void startWorkers(int count);
+    void stopWorkers();
+    void workerLoop();
+    void runTasks(const std::function<void(int)>* task, int count);
+    // Runs task(0..count-1) across the workers and the calling thread, returns when all are done
+    void parallelFor(int count, const std::function<void(int)>& task);
+
+    mutable std::mutex m_composeMutex;
+    Config m_config;
+    std::shared_ptr<CanvasRing> m_ring;
+    uint64_t m_composeCount;
+    Stats m_stats;
+
+    // Per-compose state read by the tiles
+    std::vector<Layer> m_layers;
+    std::vector<DrawnLayer> m_placed;
+    std::vector<int> m_dirty;
+    std::vector<std::shared_ptr<frame_data_t>> m_converted; // RGBA views of NV12 frames
+    std::vector<const frame_data_t*> m_sources;             // nullptr: fill with the background
+    std::vector<image_scale_map_s> m_maps;                  // By layer position, kept across composes
+    std::vector<Tile> m_tiles;
+
+    // Worker pool
+    std::vector<std::thread> m_workers;
+    std::mutex m_poolMutex;
+    std::condition_variable m_poolCv;
+    std::condition_variable m_doneCv;
+    const std::function<void(int)>* m_task;
+    int m_taskCount;
+    std::atomic<int> m_nextTask;
+    int m_activeWorkers;
+    uint64_t m_batch;
+    bool m_stopping;
+};
+
+#endif // AIBOX_COMPOSITOR_ENGINE_H
@@ -0,0 +1,63 @@
+#ifndef AIBOX_DETECTION_CADENCE_H
+#define AIBOX_DETECTION_CADENCE_H
+
+#include <cstdint>
+#include <mutex>
+
+/**
+ * Detection Cadence
+ * Per-channel decision of which decoded frames are sent to the NPU. Frames
+ * in between skip inference and get their boxes from SortTracker.
+ *
+ * - Fixed: every interval-th frame is detected.
+ * - Adaptive: the interval is the number of frames the fastest tracked box
+ *   needs to drift maxDriftRatio of its own size, clamped to
+ *   [1, maxInterval]; it is doubled (up to maxInterval) while the inference
+ *   queue is at least highLoad full. Fast motion detects every frame, a static
+ *   scene detects every maxInterval-th frame.
+ *
+ * shouldDetect() is called from the decode thread and reportMotion() from the
+ * result thread.
+ */
+class DetectionCadence {
+public:
+    struct Config {
+        int interval;         // Fixed mode: detect every interval-th frame (1 = every frame)
+        bool adaptive;        // Choose the interval from tracked motion and inference load
+        int maxInterval;      // Adaptive mode: longest run of frames between detections
+        float maxDriftRatio;  // Adaptive mode: tolerated box drift between detections, in box sizes
+        float highLoad;       // Adaptive mode: inference queue fill (0-1) that doubles the interval
+
+        Config() : interval(1), adaptive(false), maxInterval(4), maxDriftRatio(0.25f), highLoad(0.5f) {}
+    };
+
+    struct Stats {
+        uint64_t frames;
+        uint64_t detected;
+        uint64_t skipped;
+        int interval;  // Interval used for the latest frame
+    };
+
+    explicit DetectionCadence(const Config& config = Config());
+
+    void setConfig(const Config& config);
+
+    // load: fill of the channel's inference queue, 0-1. Returns false if the frame skips inference.
+    bool shouldDetect(float load);
+
+    // Fastest tracked motion in box sizes per frame (SortTracker::motion())
+    void reportMotion(float motion);
+
+    Stats getStats() const;
+
+private:
+    int adaptiveIntervalLocked(float load) const;
+
+    mutable std::mutex m_mutex;
+    Config m_config;
+    float m_motion;
+    int m_sinceDetect;  // Frames since the last detected frame
+    Stats m_stats;
+};
+
+#endif // AIBOX_DETECTION_CADENCE_H
@@ -83,6 +83,9 @@ public:
     // Main rendering function
     bool renderDetections(int channelIndex, uint8_t* frameData, int width, int height, int stride,
                          const std::vector<Detection>& detections);
+    // Same for an NV12 frame (stride = Y row bytes, UV plane at stride * heightStride)
+    bool renderDetectionsNV12(int channelIndex, uint8_t* frameData, int width, int height, int stride,
+                              int heightStride, const std::vector<Detection>& detections);
 
     // System optimization
     void updateSystemLoad(float load);
@@ -105,6 +108,8 @@ public:
 private:
     // Internal helper methods
     ChannelRenderState* getChannelStateInternal(int channelIndex) const;
+    bool renderDetectionsInternal(int channelIndex, uint8_t* frameData, int width, int height, int stride,
+                                  int heightStride, bool nv12, const std::vector<Detection>& detections);
     void updateChannelMetrics(int channelIndex, float renderTime, int detectionCount);
     void updateSystemMetrics();
     bool shouldOptimizeChannel(int channelIndex) const;
@@ -0,0 +1,141 @@
+#ifndef AIBOX_FRAME_BUFFER_POOL_H
+#define AIBOX_FRAME_BUFFER_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ThreadSafeResourceManager.h"
+
+struct g_frame_data_t;
+class FrameBufferPool;
+
+/**
+ * Identifies interchangeable frame buffers: same geometry, format and stride.
+ */
+struct FrameBufferKey {
+    int width;
+    int height;
+    int format;
+    int stride;
+
+    FrameBufferKey() : width(0), height(0), format(0), stride(0) {}
+    FrameBufferKey(int w, int h, int fmt, int strideBytes) : width(w), height(h), format(fmt), stride(strideBytes) {}
+
+    bool operator<(const FrameBufferKey& other) const {
+        if (width != other.width) return width < other.width;
+        if (height != other.height) return height < other.height;
+        if (format != other.format) return format < other.format;
+        return stride < other.stride;
+    }
+};
+
+/**
+ * Deleter for frame buffers: hands pooled buffers back to their pool and
+ * delete[]s the rest. Converts from std::default_delete so plain new[]
+ * buffers can still be assigned to frame_data_t::data.
+ *
+ * Borrowed buffers (e.g. a leased MPP decoder buffer) carry their owner
+ * instead; releasing the FrameBuffer only drops that reference.
+ */
+struct FrameBufferDeleter {
+    std::shared_ptr<FrameBufferPool> pool; // null for buffers not owned by a pool
+    FrameBufferKey key;
+    size_t capacity;
+    std::shared_ptr<void> owner;           // set for borrowed memory, which is never freed here
+
+    FrameBufferDeleter() : capacity(0) {}
+    FrameBufferDeleter(const std::default_delete<char[]>&) : capacity(0) {}
+    explicit FrameBufferDeleter(std::shared_ptr<void> borrowedFrom) : capacity(0), owner(std::move(borrowedFrom)) {}
+
+    // Borrowed buffers may still be referenced by their producer and must not be written
+    bool borrowed() const { return owner != nullptr; }
+
+    void operator()(char* ptr) const;
+};
+
+typedef std::unique_ptr<char[], FrameBufferDeleter> FrameBuffer;
+
+/**
+ * Frame Buffer Pool
+ * Recycles decoded-frame pixel buffers and frame_data_t objects so the
+ * per-frame path does not allocate (and zero) a full frame each time.
+ * Buffers are handed out uninitialised; callers overwrite them completely.
+ */
+class FrameBufferPool : public std::enable_shared_from_this<FrameBufferPool> {
+public:
+    struct Stats {
+        uint64_t hits;           // Requests served from cached buffers
+        uint64_t misses;         // Requests that allocated a new buffer
+        float hitRate;
+        size_t buffersInUse;
+        size_t buffersCached;
+        size_t highWaterBuffers; // Peak buffers in use
+        size_t bytesInUse;
+        size_t bytesResident;    // In use + cached
+        size_t highWaterBytes;   // Peak bytes resident
+        size_t framesCached;     // Idle frame_data_t objects
+
+        Stats() : hits(0), misses(0), hitRate(0.0f), buffersInUse(0), buffersCached(0), highWaterBuffers(0),
+                  bytesInUse(0), bytesResident(0), highWaterBytes(0), framesCached(0) {}
+    };
+
+    // maxCachedBytes bounds the idle buffers kept; maxCachedPerKey bounds them per key
+    static std::shared_ptr<FrameBufferPool> create(size_t maxCachedBytes = 256 * 1024 * 1024,
+                                                   size_t maxCachedPerKey = 8, size_t maxCachedFrames = 64);
+
+    // Process-wide pool used by the decoder callbacks
+    static std::shared_ptr<FrameBufferPool> shared();
+
+    ~FrameBufferPool();
+
+    // Buffer of at least size bytes, contents unspecified
+    FrameBuffer acquire(const FrameBufferKey& key, size_t size);
+
+    // Reset frame_data_t from the object pool; its buffer (if any) is released when the frame is recycled
+    std::shared_ptr<g_frame_data_t> acquireFrame();
+
+    // Free all idle buffers and frames
+    void trim();
+
+    Stats getStats() const;
+
+    // Report this pool through ThreadSafeResourceManager::getMemoryPoolStats(type)
+    bool attachTo(ThreadSafeResourceManager& manager,
+                  ThreadSafeResourceManager::ResourceType type = ThreadSafeResourceManager::MEMORY_BUFFER);
+
+private:
+    friend struct FrameBufferDeleter;
+
+    struct CachedBuffer {
+        char* data;
+        size_t capacity;
+    };
+
+    FrameBufferPool(size_t maxCachedBytes, size_t maxCachedPerKey, size_t maxCachedFrames);
+
+    void release(const FrameBufferKey& key, char* data, size_t capacity);
+    void recycleFrame(g_frame_data_t* frame);
+
+    mutable std::mutex poolMutex;
+    std::map<FrameBufferKey, std::vector<CachedBuffer>> freeBuffers;
+    std::vector<g_frame_data_t*> freeFrames;
+
+    size_t maxCachedBytes;
+    size_t maxCachedPerKey;
+    size_t maxCachedFrames;
+
+    uint64_t hits;
+    uint64_t misses;
+    size_t buffersInUse;
+    size_t buffersCached;
+    size_t highWaterBuffers;
+    size_t bytesInUse;
+    size_t bytesCached;
+    size_t highWaterBytes;
+};
+
+#endif // AIBOX_FRAME_BUFFER_POOL_H
@@ -0,0 +1,39 @@
+#ifndef AIBOX_FRAME_CONVERTER_H
+#define AIBOX_FRAME_CONVERTER_H
+
+#include <cstdint>
+#include <memory>
+
+#include "user_comm.h"
+
+/**
+ * Frame Converter
+ * Decoded frames stay NV12 through inference and the render queues; RGBA is
+ * produced only where it is consumed: the ANativeWindow buffer being posted,
+ * or the consumers (compositor) that still read RGBA pixels.
+ */
+class FrameConverter {
+public:
+    static bool isNV12(const frame_data_t& frame);
+
+    // False for borrowed buffers (leased decoder output), which overlays must not be drawn into
+    static bool isWritable(const frame_data_t& frame);
+
+    // Bytes per Y row for NV12 frames, bytes per pixel row otherwise
+    static int rowStride(const frame_data_t& frame);
+
+    // Write the visible screenW x screenH region as RGBA_8888 into dst (dstStride bytes per row).
+    // NV12 goes through RGA when useRga is set and falls back to the CPU path if RGA fails.
+    static bool toRGBA(const frame_data_t& frame, uint8_t* dst, int dstStride, bool useRga = true);
+
+    // CPU NV12 -> RGBA (alpha 255), BT.601 limited range as in RGA's YCbCr_420_SP conversion
+    static void nv12ToRGBA(const uint8_t* y, const uint8_t* uv, int srcStride, int width, int height,
+                           uint8_t* dst, int dstStride);
+
+    // RGBA frames are returned as is. NV12 frames are converted into a pooled RGBA frame held
+    // by converted (screenStride = screenW * 4, same id and detections); nullptr on failure.
+    static const frame_data_t* rgbaView(const frame_data_t* frame, std::shared_ptr<frame_data_t>& converted,
+                                        bool useRga = true);
+};
+
+#endif // AIBOX_FRAME_CONVERTER_H
@@ -174,6 +174,12 @@ private:
     bool blendFramesOpenGL(const uint8_t* src1Data, const uint8_t* src2Data,
                           int width, int height, uint8_t* dstData, float alpha);
     
+    // CPU fallback (process/image_kernels: fixed-point bilinear and blend, NEON/SSE2)
+    bool scaleFrameCPU(const uint8_t* srcData, int srcWidth, int srcHeight, int srcStride,
+                      uint8_t* dstData, int dstWidth, int dstHeight, int dstStride);
+    bool blendFramesCPU(const uint8_t* src1Data, const uint8_t* src2Data,
+                       int width, int height, int stride, uint8_t* dstData, float alpha);
+    
     // Resource management
     cv::cuda::GpuMat getGpuMat(int width, int height, int type);
     void returnGpuMat(cv::cuda::GpuMat& mat);
@@ -14,6 +14,7 @@
 #include "log4c.h"
 #include "user_comm.h"
 #include "display_queue.h"
+#include "CompositorEngine.h"
 
 /**
  * Multi-Channel Frame Compositor
@@ -122,6 +123,7 @@ private:
     // Channel management
     std::map<int, ChannelViewport> channelViewports;
     std::map<int, std::shared_ptr<frame_data_t>> latestChannelFrames;
+    std::map<int, uint64_t> channelFrameSequence;  // Bumped per submitted frame; drives dirty tracking
     mutable std::mutex channelsMutex;
 
     // Composition thread
@@ -136,10 +138,8 @@ private:
     mutable std::mutex inputQueueMutex;
     mutable std::mutex outputQueueMutex;
 
-    // Output buffer management
-    std::vector<std::shared_ptr<uint8_t>> bufferPool;
-    mutable std::mutex bufferPoolMutex;
-    static constexpr int BUFFER_POOL_SIZE = 8;
+    // Unified frames: canvas ring, dirty tracking and tile-parallel scaling
+    CompositorEngine engine;
     
     // Performance monitoring
     CompositionMetrics metrics;
@@ -210,12 +210,6 @@ private:
     bool blendFrame(const frame_data_t* src, uint8_t* dst, const ChannelViewport& viewport, float alpha);
     bool cropFrame(const frame_data_t* src, uint8_t* dst, int cropX, int cropY, int cropW, int cropH);
     
-    // Buffer management
-    std::shared_ptr<uint8_t> acquireBuffer();
-    void releaseBuffer(std::shared_ptr<uint8_t> buffer);
-    void initializeBufferPool();
-    void cleanupBufferPool();
-    
     // Layout calculation
     void calculateViewportsForLayout(LayoutMode layout);
     ChannelViewport calculateChannelViewport(int channelIndex, LayoutMode layout);
@@ -235,7 +229,7 @@ private:
     
     // Utility methods
     int calculateBufferSize(int width, int height, int format) const;
-    void clearBuffer(uint8_t* buffer, int size, uint32_t color);
+    static CompositorEngine::Config engineConfig(const CompositionConfig& config);
     bool copyFrameData(const frame_data_t* src, uint8_t* dst, int dstStride);
     
     // Error handling
@@ -254,14 +248,19 @@ public:
     static bool convertYUVtoRGBA(const uint8_t* yuv, uint8_t* rgba, int width, int height);
     static bool convertRGBAtoYUV(const uint8_t* rgba, uint8_t* yuv, int width, int height);
     
-    // Scaling algorithms
+    // Scaling algorithms (fixed-point, see process/image_kernels); the overloads without strides take packed rows
     static bool bilinearScale(const uint8_t* src, uint8_t* dst, 
                              int srcW, int srcH, int dstW, int dstH, int channels);
+    static bool bilinearScale(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride,
+                             int srcW, int srcH, int dstW, int dstH, int channels);
     static bool bicubicScale(const uint8_t* src, uint8_t* dst,
                             int srcW, int srcH, int dstW, int dstH, int channels);
     
     // Blending operations
+    // src is premultiplied RGBA drawn over dst with opacity alpha
     static bool alphaBlend(const uint8_t* src, uint8_t* dst, int width, int height, float alpha);
+    static bool alphaBlend(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride,
+                          int width, int height, float alpha);
     static bool additiveBlend(const uint8_t* src, uint8_t* dst, int width, int height);
     static bool multiplyBlend(const uint8_t* src, uint8_t* dst, int width, int height);
     
@@ -29,14 +29,17 @@ public:
         std::vector<int> enabledClasses;
         bool enableNMS;
         float nmsThreshold;
+        nms_mode_e nmsMode;
         
         DetectionChannelConfig() : channelIndex(-1), detectionEnabled(true),
                                   visualizationEnabled(true), confidenceThreshold(0.5f),
-                                  maxDetections(100), enableNMS(true), nmsThreshold(0.4f) {}
+                                  maxDetections(100), enableNMS(true), nmsThreshold(0.4f),
+                                  nmsMode(NMS_MODE_HARD) {}
 
         DetectionChannelConfig(int index) : channelIndex(index), detectionEnabled(true),
                                           visualizationEnabled(true), confidenceThreshold(0.5f),
-                                          maxDetections(100), enableNMS(true), nmsThreshold(0.4f) {}
+                                          maxDetections(100), enableNMS(true), nmsThreshold(0.4f),
+                                          nmsMode(NMS_MODE_HARD) {}
     };
 
     struct DetectionSystemStats {
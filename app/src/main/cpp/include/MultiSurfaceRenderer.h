@@ -1,8 +1,12 @@
 #ifndef AIBOX_MULTI_SURFACE_RENDERER_H
 #define AIBOX_MULTI_SURFACE_RENDERER_H
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <map>
+#include <string>
+#include <vector>
 #include <mutex>
 #include <atomic>
 #include <thread>
@@ -15,10 +19,67 @@
 #include "user_comm.h"
 #include "log4c.h"
 #include "display_queue.h"
+#include "WindowPresenter.h"
+#include "PresentationClock.h"
+
+// A presentation more than this past its deadline is late, for surfaces without a targetFps grid
+// (half a frame at 25 fps; paced surfaces use half their frame interval)
+#define RENDER_LATE_TOLERANCE_US 20000
+// A render thread takes a due surface from another thread's heap once it is this far overdue
+#define RENDER_STEAL_SLACK_US 2000
+// How often an idle window surface looks for a queued frame
+#define RENDER_IDLE_POLL_US 5000
+// Shortest wait before asking a source again after it had nothing to show
+#define RENDER_MIN_POLL_US 1000
+
+/**
+ * Present Source
+ * A surface whose frames and window are owned elsewhere, such as a ZLPlayer
+ * channel with its PTS jitter buffer. The render pool asks the source for its
+ * next frame and the time it is due, waits for that deadline, then presents
+ * or drops the frame.
+ *
+ * Calls for one source never overlap, but successive calls may come from
+ * different render threads. Times are PresentationClock::nowUs().
+ */
+class PresentSource {
+public:
+    virtual ~PresentSource() {}
+
+    // Take the next frame to show; true with its presentation time in timeUs. false when nothing
+    // is ready, with timeUs set to when to look again. droppedFrames: frames the source discarded
+    // on the way (stale or invalid). Only called when no frame is pending.
+    virtual bool nextFrame(int64_t nowUs, int64_t& timeUs, int& droppedFrames) = 0;
+
+    // Present the pending frame; false if it did not reach the window
+    virtual bool presentFrame() = 0;
+
+    // Discard the pending frame (its deadline was missed)
+    virtual void dropFrame() = 0;
+};
 
 /**
- * Multi-Surface Renderer for handling independent surface rendering
- * Provides isolated rendering for each channel with performance optimization
+ * Multi-Surface Renderer
+ * The presentation engine for all surfaces: a small pool of render threads
+ * presents every surface at its own deadline instead of one display thread
+ * per channel.
+ *
+ * Each render thread owns a min-heap of surfaces keyed by the next present
+ * time: the pending frame's time, no earlier than the surface's next
+ * targetFps slot (0 = paced by the source alone). A thread sleeps until the
+ * earliest deadline, presents that surface and pushes it back with its next
+ * deadline. When a surface in another thread's heap is overdue by
+ * RENDER_STEAL_SLACK_US (its owner is busy), an idle thread steals it and the
+ * surface stays with the thief from then on. A surface is out of every heap
+ * while it is being serviced, so its queue keeps a single consumer.
+ *
+ * A frame presented past its deadline by more than the late tolerance is
+ * dropped when skip-if-late is set for the surface (the default) and
+ * presented late otherwise. On-time, late, dropped and failed presentations
+ * are counted per surface.
+ *
+ * Window surfaces (addSurface) show the newest frame from queueFrame() at
+ * each slot; sources (addSource) supply their own frames.
  */
 class MultiSurfaceRenderer {
 public:
@@ -30,36 +91,64 @@ public:
         ERROR = 4
     };
 
+    // Presentation outcomes of one surface
+    struct PresentStats {
+        uint64_t onTime;   // Presented within the late tolerance of the deadline
+        uint64_t late;     // Presented after it (skip-if-late off)
+        uint64_t dropped;  // Skipped as late, replaced in the queue or discarded by the source
+        uint64_t failed;   // Presentation failed (no window, lock failure)
+    };
+
     struct SurfaceInfo {
         int channelIndex;
         ANativeWindow* surface;
-        RenderState state;
+        std::atomic<RenderState> state;
         std::atomic<int> frameCount;
         std::atomic<int> renderCount;
         std::atomic<int> droppedFrames;
         std::chrono::steady_clock::time_point lastRenderTime;
         std::chrono::steady_clock::time_point creationTime;
-        float targetFps;
+        std::atomic<float> targetFps;   // Present slots per second, 0 = follow the source's times
+        std::atomic<bool> skipIfLate;
         float currentFps;
         int width;
         int height;
         int format;
         std::string lastError;
         
-        // Render queue for this surface
+        // Render queue for this surface (window surfaces; the newest frame wins)
         std::unique_ptr<RenderFrameQueue> renderQueue;
-        std::mutex surfaceMutex;
+        std::mutex surfaceMutex;    // Held while the surface is serviced
+        WindowPresenter presenter;  // Presents into surface (guarded by surfaceMutex)
+
+        // Frames come from here: the queue above for window surfaces, or an external source
+        PresentSource* source;
+        std::unique_ptr<PresentSource> ownSource;
+
+        // Schedule (guarded by surfaceMutex)
+        bool hasPending;        // source holds a frame due at pendingDueUs
+        int64_t pendingDueUs;
+        int64_t nextSlotUs;     // Earliest time of the next presentation on the targetFps grid
+        std::atomic<bool> removed;
+
+        std::atomic<uint64_t> onTimeCount;
+        std::atomic<uint64_t> lateCount;
+        std::atomic<uint64_t> skippedCount;
+        std::atomic<uint64_t> failedCount;
         
         SurfaceInfo(int index, ANativeWindow* surf) 
             : channelIndex(index), surface(surf), state(INACTIVE),
               frameCount(0), renderCount(0), droppedFrames(0),
-              targetFps(30.0f), currentFps(0.0f), width(0), height(0), format(0) {
+              targetFps(30.0f), skipIfLate(true), currentFps(0.0f), width(0), height(0), format(0),
+              source(nullptr), hasPending(false), pendingDueUs(0), nextSlotUs(0), removed(false),
+              onTimeCount(0), lateCount(0), skippedCount(0), failedCount(0) {
             lastRenderTime = std::chrono::steady_clock::now();
             creationTime = std::chrono::steady_clock::now();
-            renderQueue = std::make_unique<RenderFrameQueue>();
+            renderQueue = std::make_unique<RenderFrameQueue>(RENDER_QUEUE_LIVE_DEPTH, index);
             
             if (surface) {
                 ANativeWindow_acquire(surface);
+                presenter.setWindow(NativePresentWindow::wrap(surface));
             }
         }
         
@@ -82,14 +171,23 @@ public:
     };
 
 private:
-    std::map<int, std::unique_ptr<SurfaceInfo>> surfaces;
-    std::mutex surfacesMutex;
+    // A surface in a render thread's heap
+    struct ScheduledSurface {
+        int64_t dueUs;
+        std::shared_ptr<SurfaceInfo> surface;
+    };
+    // std::push_heap / pop_heap order: earliest deadline on top
+    static bool laterDeadline(const ScheduledSurface& a, const ScheduledSurface& b);
+
+    std::map<int, std::shared_ptr<SurfaceInfo>> surfaces;
+    mutable std::mutex surfacesMutex;
     
-    // Rendering threads
+    // Rendering threads, one deadline heap each (heaps guarded by scheduleMutex)
     std::vector<std::thread> renderThreads;
-    std::queue<int> renderQueue;
-    std::mutex renderQueueMutex;
-    std::condition_variable renderQueueCv;
+    std::vector<std::vector<ScheduledSurface>> renderHeaps;
+    std::mutex scheduleMutex;
+    std::condition_variable scheduleCv;
+    std::atomic<uint64_t> stolenCount;
     std::atomic<bool> shouldStop;
     
     // Performance monitoring
@@ -111,17 +209,22 @@ public:
     
     // Surface management
     bool addSurface(int channelIndex, ANativeWindow* surface);
+    // Present frames from source (not owned) under channelIndex, paced by its own times when targetFps is 0
+    bool addSource(int channelIndex, PresentSource* source, float targetFps = 0.0f);
+    // Once this returns the surface's source is no longer called
     bool removeSurface(int channelIndex);
     bool updateSurface(int channelIndex, ANativeWindow* surface);
     
     // Rendering operations
     bool queueFrame(int channelIndex, std::shared_ptr<frame_data_t> frameData);
+    // Present the next frame now, outside the schedule
     bool renderFrame(int channelIndex);
     bool isSurfaceReady(int channelIndex) const;
     
     // Surface configuration
     void setSurfaceFormat(int channelIndex, int width, int height, int format);
     void setTargetFps(int channelIndex, float fps);
+    void setSkipIfLate(int channelIndex, bool skip);
     void pauseSurface(int channelIndex);
     void resumeSurface(int channelIndex);
     
@@ -131,6 +234,9 @@ public:
     int getFrameCount(int channelIndex) const;
     int getRenderCount(int channelIndex) const;
     int getDroppedFrames(int channelIndex) const;
+    bool getPresentStats(int channelIndex, PresentStats& stats) const;
+    // Surfaces serviced by a thread other than the one whose heap they were in
+    uint64_t getStolenCount() const { return stolenCount.load(); }
     std::vector<int> getActiveSurfaces() const;
     
     // Performance management
@@ -147,8 +253,13 @@ public:
 private:
     // Internal rendering
     void renderThreadLoop(int threadId);
-    void processSurfaceRender(int channelIndex);
-    bool renderFrameToSurface(SurfaceInfo* surfaceInfo, frame_data_t* frameData);
+    // Heap holding the surface threadId should service now (its own first, else one to steal), or -1
+    // with wakeUs lowered to the next time one may be due
+    int pickDueHeap(int threadId, int64_t nowUs, int64_t& wakeUs) const;
+    // Take, present or skip the surface's next frame; returns its next deadline
+    int64_t serviceSurface(SurfaceInfo* surfaceInfo);
+    // Present the pending frame and count the outcome (surfaceMutex held)
+    bool presentPendingFrame(SurfaceInfo* surfaceInfo, bool late);
     
     // Performance monitoring
     void performanceMonitorLoop();
@@ -156,20 +267,27 @@ private:
     void updateSystemLoad();
     
     // Surface management
+    bool insertSurface(std::shared_ptr<SurfaceInfo> surfaceInfo);
+    // Remove from the map (surfacesMutex held); the caller retires the returned surface
+    std::shared_ptr<SurfaceInfo> detachSurface(int channelIndex);
+    // Take it out of the heaps and wait for a render in progress (no lock held)
+    void retireSurface(const std::shared_ptr<SurfaceInfo>& surfaceInfo);
+    void scheduleSurface(const std::shared_ptr<SurfaceInfo>& surfaceInfo, int64_t dueUs);
+    std::shared_ptr<SurfaceInfo> findSurface(int channelIndex) const;
     SurfaceInfo* getSurfaceInfo(int channelIndex);
     const SurfaceInfo* getSurfaceInfo(int channelIndex) const;
     void updateSurfaceState(int channelIndex, RenderState newState);
     
-    // Error handling
-    void handleRenderError(int channelIndex, const std::string& error);
+    // Error handling (surfaceMutex held)
+    void handleRenderError(SurfaceInfo* surfaceInfo, const std::string& error);
     
     // Frame rate control
-    bool shouldRenderFrame(SurfaceInfo* surfaceInfo) const;
+    static int64_t frameIntervalUs(const SurfaceInfo* surfaceInfo);
+    static int64_t lateToleranceUs(const SurfaceInfo* surfaceInfo);
     void adaptiveFrameSkipping(SurfaceInfo* surfaceInfo);
     
     // Thread safety helpers
-    std::unique_lock<std::mutex> lockSurfaces() { return std::unique_lock<std::mutex>(surfacesMutex); }
-    std::unique_lock<std::mutex> lockRenderQueue() { return std::unique_lock<std::mutex>(renderQueueMutex); }
+    std::unique_lock<std::mutex> lockSurfaces() const { return std::unique_lock<std::mutex>(surfacesMutex); }
 };
 
 /**
@@ -13,9 +13,13 @@
 #include <queue>
 
 #include "yolov5_thread_pool.h"
+#include "DetectionCadence.h"
+#include "SortTracker.h"
 #include "user_comm.h"
 #include "log4c.h"
 
+class SystemPerformanceMonitor;
+
 /**
  * Per-Channel Detection Manager for independent YOLOv5 processing per channel
  * Ensures each channel has its own detection pipeline and result queue
@@ -40,12 +44,22 @@ public:
         int maxQueueSize;
         bool enableNMS;
         float nmsThreshold;
+        nms_mode_e nmsMode;     // HARD / SOFT / FAST / MATRIX
+        int nmsTopK;            // NMS前保留的最高分候选数
+        int npuCore;            // -1: 线程池实例轮询各NPU核心（起点错开为channelIndex % 3）；0-2: 整个通道固定在该核心
+        bool shareModelWeights; // 线程池实例共享首个实例的模型权重
+        int detectInterval;     // 每N帧送一帧推理，其余帧由跟踪器外推检测框（1: 每帧推理）
+        bool adaptiveCadence;   // 按目标运动速度和推理队列负载自动选择间隔（1..maxDetectInterval）
+        int maxDetectInterval;  // 自适应时的最大间隔
         std::vector<int> enabledClasses;
         
         DetectionConfig(int index) : channelIndex(index), enabled(true),
                                    confidenceThreshold(0.5f), maxDetections(100),
                                    threadPoolSize(4), maxQueueSize(50),
-                                   enableNMS(true), nmsThreshold(0.4f) {}
+                                   enableNMS(true), nmsThreshold(0.4f),
+                                   nmsMode(NMS_MODE_HARD), nmsTopK(1000),
+                                   npuCore(-1), shareModelWeights(true),
+                                   detectInterval(1), adaptiveCadence(false), maxDetectInterval(4) {}
     };
 
     struct DetectionStats {
@@ -57,19 +71,20 @@ public:
         float peakProcessingTime;
         int queueSize;
         int droppedFrames;
+        int trackedFrames;      // 跳过推理、检测框由跟踪器外推的帧
         std::chrono::steady_clock::time_point lastUpdate;
         
         DetectionStats() : channelIndex(-1), totalFramesProcessed(0),
                          totalDetections(0), averageDetectionsPerFrame(0.0f),
                          averageProcessingTime(0.0f), peakProcessingTime(0.0f),
-                         queueSize(0), droppedFrames(0) {
+                         queueSize(0), droppedFrames(0), trackedFrames(0) {
             lastUpdate = std::chrono::steady_clock::now();
         }
 
         DetectionStats(int index) : channelIndex(index), totalFramesProcessed(0),
                                   totalDetections(0), averageDetectionsPerFrame(0.0f),
                                   averageProcessingTime(0.0f), peakProcessingTime(0.0f),
-                                  queueSize(0), droppedFrames(0) {
+                                  queueSize(0), droppedFrames(0), trackedFrames(0) {
             lastUpdate = std::chrono::steady_clock::now();
         }
     };
@@ -108,6 +123,8 @@ private:
         DetectionConfig config;
         DetectionStats stats;
         std::unique_ptr<Yolov5ThreadPool> threadPool;
+        DetectionCadence cadence;
+        SortTracker tracker;    // 仅处理线程使用
         std::queue<std::shared_ptr<frame_data_t>> inputQueue;
         std::queue<DetectionResult> resultQueue;
         std::thread processingThread;
@@ -139,6 +156,7 @@ private:
     int modelDataSize;
     std::atomic<int> activeChannelCount;
     std::atomic<bool> globalEnabled;
+    std::shared_ptr<NpuUsageTracker> npuUsage; // Shared by all channel thread pools
 
     // Statistics thread
     std::thread statsThread;
@@ -173,6 +191,10 @@ public:
     // Configuration
     void setChannelConfig(int channelIndex, const DetectionConfig& config);
     DetectionConfig getChannelConfig(int channelIndex) const;
+    // NMS fields of a DetectionConfig, also applied to the shared InferenceScheduler by NativeChannelManager
+    static nms_config_s nmsConfig(const DetectionConfig& config);
+    // Detection cadence fields of a DetectionConfig, also used by ZLPlayer::setDetectionCadence()
+    static DetectionCadence::Config cadenceConfig(const DetectionConfig& config);
     void setEventListener(DetectionEventListener* listener);
     
     // Statistics and monitoring
@@ -180,6 +202,8 @@ public:
     std::vector<DetectionStats> getAllChannelStats() const;
     std::vector<int> getActiveChannels() const;
     int getActiveChannelCount() const { return activeChannelCount.load(); }
+    // Push NPU core utilisation since the previous call and shared-weight savings to the monitor
+    void reportNpuMetrics(SystemPerformanceMonitor& monitor);
     
     // Global control
     void enableGlobalDetection(bool enabled);
@@ -196,6 +220,7 @@ private:
     void channelProcessingLoop(int channelIndex);
     void processFrame(ChannelDetectionInfo* channelInfo, std::shared_ptr<frame_data_t> frameData);
     void updateChannelStats(ChannelDetectionInfo* channelInfo, const DetectionResult& result);
+    void publishResult(ChannelDetectionInfo* channelInfo, const DetectionResult& result);
     
     // State management
     void changeChannelState(int channelIndex, DetectionState newState);
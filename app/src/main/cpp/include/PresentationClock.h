@@ -0,0 +1,85 @@
+#ifndef AIBOX_PRESENTATION_CLOCK_H
+#define AIBOX_PRESENTATION_CLOCK_H
+
+#include <cstdint>
+
+/**
+ * Presentation Clock
+ * Per-channel mapping from stream PTS (ms) to steady_clock presentation
+ * times (us), used by the display thread to show each frame on its own
+ * timestamp instead of on a fixed frame interval.
+ *
+ * - Offset: the lower envelope of (ready time - PTS). An earlier-than-expected
+ *   frame lowers it at once; later frames raise it slowly, which follows drift
+ *   between the camera clock and the local clock.
+ * - Jitter buffer: frames are held for an adaptive delay above the envelope
+ *   (a multiple of the mean lateness, clamped to [minDelayMs, maxDelayMs]) so
+ *   decode and inference jitter does not show up as uneven motion.
+ * - A frame whose presentation time has already passed by more than half a
+ *   frame interval is dropped rather than shown late.
+ * - A PTS jump (backwards, or forwards by more than discontinuityMs) or a run
+ *   of late frames re-anchors the clock.
+ *
+ * Frame rate is not configured: the interval is estimated from PTS deltas,
+ * so 25 fps, 30 fps and variable-rate streams are handled the same way.
+ * Not thread-safe; owned by the display thread.
+ */
+class PresentationClock {
+public:
+    struct Config {
+        int minDelayMs;          // Jitter buffer floor
+        int maxDelayMs;          // Jitter buffer ceiling
+        int discontinuityMs;     // PTS gap treated as a stream restart
+        int maxConsecutiveLate;  // Late frames in a row before re-anchoring
+
+        Config() : minDelayMs(10), maxDelayMs(150), discontinuityMs(1000), maxConsecutiveLate(8) {}
+    };
+
+    enum Action {
+        PRESENT,    // Show at Decision::presentTimeUs (now or in the future)
+        DROP_LATE   // Presentation time already passed; skip the frame
+    };
+
+    struct Decision {
+        Action action;
+        int64_t presentTimeUs;
+    };
+
+    struct Stats {
+        uint64_t scheduled;
+        uint64_t droppedLate;
+        uint64_t resets;
+        int64_t frameIntervalUs;  // Estimated from PTS deltas
+        int64_t delayUs;          // Current jitter buffer delay
+    };
+
+    explicit PresentationClock(const Config& config = Config());
+
+    // pts: stream timestamp in ms (-1 = unknown, presented immediately).
+    // readyTimeUs: when the frame became available to the display. nowUs: current time.
+    Decision schedule(int64_t pts, int64_t readyTimeUs, int64_t nowUs);
+
+    void reset();
+    Stats getStats() const;
+
+    // steady_clock::now() in microseconds
+    static int64_t nowUs();
+
+private:
+    void anchor(int64_t pts, int64_t readyTimeUs);
+    int64_t currentDelayUs() const;
+
+    Config m_config;
+    bool m_anchored;
+    int64_t m_lastPts;
+    int64_t m_offsetUs;       // Lower envelope of readyTimeUs - pts * 1000
+    int64_t m_latenessUs;     // Mean of how far frames arrive above the envelope
+    int64_t m_frameIntervalUs;
+    int m_consecutiveLate;
+
+    uint64_t m_scheduled;
+    uint64_t m_droppedLate;
+    uint64_t m_resets;
+};
+
+#endif // AIBOX_PRESENTATION_CLOCK_H
@@ -0,0 +1,96 @@
+#ifndef AIBOX_SORT_TRACKER_H
+#define AIBOX_SORT_TRACKER_H
+
+#include <cstdint>
+#include <vector>
+#include "yolo_datatype.h"
+
+/**
+ * Sort Tracker
+ * Per-channel multi-object tracker between post-processing and rendering.
+ * Gives each object a stable track_id and a velocity, and carries boxes
+ * across frames that were not sent to the NPU (see DetectionCadence).
+ *
+ * - Each track runs SORT's constant-velocity Kalman filter on
+ *   (centre x, centre y, area, aspect ratio). The filter's covariance stays
+ *   block diagonal, so it is kept as three 2-state filters (x/vx, y/vy,
+ *   area/v_area) and a 1-state filter for the aspect ratio.
+ * - update() predicts one frame and associates in two ByteTrack stages:
+ *   detections scoring at least highThreshold against every track (IoU >=
+ *   iouThreshold), then the remaining low-score detections against the tracks
+ *   still unmatched (IoU >= lowIouThreshold). Matching is greedy in descending
+ *   IoU, only within a class. Unmatched high-score detections start new tracks;
+ *   unmatched low-score ones are left untracked (track_id -1).
+ * - predict() advances one frame without detections and returns the predicted
+ *   boxes of tracks matched by the latest update; tracks that missed it are
+ *   kept for re-association (up to maxAge missed updates) but not reported.
+ *
+ * Tracks are stored as a structure of arrays so prediction and the IoU pass
+ * over 100+ objects walk contiguous floats; labels live in a separate cold
+ * array. One call per frame, in frame order. Not thread-safe and lock-free by
+ * design: each channel owns its tracker and drives it from its result thread.
+ */
+class SortTracker {
+public:
+    struct Config {
+        float iouThreshold;     // Minimum IoU to associate a high-score detection
+        float lowIouThreshold;  // Minimum IoU to associate a low-score detection to a leftover track
+        float highThreshold;    // Detections below this score never start a track
+        int maxAge;             // Detection updates a track may miss before it is deleted
+
+        Config() : iouThreshold(0.3f), lowIouThreshold(0.5f), highThreshold(0.5f), maxAge(2) {}
+    };
+
+    explicit SortTracker(const Config& config = Config());
+
+    // Frame with detections: predict, associate, correct matched tracks and start new ones.
+    // Sets track_id and velocity on every associated or new detection.
+    void update(std::vector<Detection>& detections);
+
+    // Frame without detections: predicted boxes of the tracks matched by the latest update
+    std::vector<Detection> predict();
+
+    // Drops all tracks; ids keep counting so they are never reused within a channel
+    void reset();
+
+    // Fastest predicted motion among reported tracks, in box sizes (sqrt of area) per frame
+    float motion() const;
+
+    int trackCount() const { return (int) m_id.size(); }
+
+private:
+    struct Candidate {
+        float iou;
+        int track;
+        int detection;
+    };
+
+    void predictAll();
+    void associate(std::vector<Detection>& detections, bool highScore, float iouThreshold);
+    void correct(int track, Detection& detection);
+    void addTrack(Detection& detection);
+    void removeTrack(int track, int last);
+    void boxOf(int track, float& left, float& top, float& right, float& bottom) const;
+    cv::Rect rectOf(int track) const;
+
+    Config m_config;
+    int m_nextId;
+
+    // Track table (structure of arrays, one entry per track)
+    std::vector<float> m_cx, m_vx, m_cxP00, m_cxP01, m_cxP11;
+    std::vector<float> m_cy, m_vy, m_cyP00, m_cyP01, m_cyP11;
+    std::vector<float> m_area, m_va, m_areaP00, m_areaP01, m_areaP11;
+    std::vector<float> m_aspect, m_aspectVar;
+    std::vector<int> m_classId;
+    std::vector<int> m_missed;
+    std::vector<int> m_id;
+    std::vector<uint8_t> m_matched;     // Matched in the current update
+    std::vector<Detection> m_label;     // Class name, score and colour of the last associated detection
+
+    // Per-update scratch, kept to avoid reallocating every frame
+    std::vector<Candidate> m_candidates;
+    std::vector<uint8_t> m_detectionMatched;
+    std::vector<float> m_left, m_top, m_right, m_bottom;
+};
+
+#endif // AIBOX_SORT_TRACKER_H
@@ -51,12 +51,15 @@ public:
         float renderFps;
         int activeChannels;
         int totalChannels;
+        std::vector<float> npuCoreUsage;  // Per NPU core utilisation, percent
+        long npuWeightMemorySaved;        // Weight bytes saved by shared model contexts
+        int npuSharedContexts;
         std::chrono::steady_clock::time_point timestamp;
         
         SystemMetrics() : cpuUsage(0.0f), memoryUsage(0), gpuUsage(0.0f),
                          networkBandwidth(0.0f), diskIO(0.0f), systemFps(0.0f),
                          detectionFps(0.0f), renderFps(0.0f), activeChannels(0),
-                         totalChannels(0) {
+                         totalChannels(0), npuWeightMemorySaved(0), npuSharedContexts(0) {
             timestamp = std::chrono::steady_clock::now();
         }
     };
@@ -170,6 +173,9 @@ private:
     std::atomic<float> systemCpuUsage;
     std::atomic<long> systemMemoryUsage;
     std::atomic<float> systemGpuUsage;
+    std::vector<float> npuCoreUsage;  // Guarded by metricsMutex
+    long npuWeightMemorySaved;
+    int npuSharedContexts;
     
     // Performance logging
     std::ofstream performanceLogFile;
@@ -204,6 +210,8 @@ public:
     // System metrics updates
     void updateSystemMetrics(const SystemMetrics& metrics);
     void updateSystemResourceUsage(float cpuUsage, long memoryUsage, float gpuUsage);
+    // NPU core utilisation (0-1 per core) and memory saved by shared model contexts
+    void updateNpuMetrics(const std::vector<float>& coreUsage, long weightMemorySaved, int sharedContexts);
     
     // Performance assessment
     PerformanceLevel assessChannelPerformance(int channelIndex) const;
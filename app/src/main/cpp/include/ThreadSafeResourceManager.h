@@ -10,6 +10,7 @@
 #include <condition_variable>
 #include <chrono>
 #include <functional>
+#include <cstdint>
 
 /**
  * Thread-Safe Resource Manager for Multi-Channel Processing
@@ -61,15 +62,35 @@ public:
         std::vector<std::unique_ptr<ResourceInfo>> usedBlocks;
         std::atomic<size_t> totalAllocated{0};
         std::atomic<size_t> totalUsed{0};
+        std::atomic<size_t> peakUsed{0};
+        std::atomic<uint64_t> hits{0};      // Served from availableBlocks
+        std::atomic<uint64_t> misses{0};    // Needed a new block (or the pool was exhausted)
         mutable std::mutex poolMutex;
         
         MemoryPool(ResourceType type, size_t size, size_t max) 
             : poolType(type), blockSize(size), maxBlocks(max) {}
     };
 
+    struct MemoryPoolStats {
+        size_t totalBlocks;     // Blocks allocated (in use + cached)
+        size_t usedBlocks;
+        size_t highWaterMark;   // Peak blocks in use
+        size_t bytesResident;   // Bytes held by the pool (in use + cached)
+        uint64_t hits;
+        uint64_t misses;
+        float hitRate;
+
+        MemoryPoolStats() : totalBlocks(0), usedBlocks(0), highWaterMark(0), bytesResident(0),
+                            hits(0), misses(0), hitRate(0.0f) {}
+    };
+
+    // Stats source for pools that manage their own memory (e.g. FrameBufferPool)
+    typedef std::function<MemoryPoolStats()> MemoryPoolStatsProvider;
+
 private:
     std::unordered_map<int, std::unique_ptr<ResourceInfo>> resources;
     std::unordered_map<ResourceType, std::unique_ptr<MemoryPool>> memoryPools;
+    std::unordered_map<int, MemoryPoolStatsProvider> externalPools; // Keyed by ResourceType
     mutable std::mutex resourcesMutex;
     mutable std::mutex poolsMutex;
     
@@ -110,6 +131,11 @@ public:
     bool destroyMemoryPool(ResourceType type);
     void* allocateFromPool(ResourceType type, int channelIndex = -1);
     bool returnToPool(ResourceType type, void* ptr);
+    // Register an externally managed pool so its stats are reported with this type
+    bool attachMemoryPool(ResourceType type, const MemoryPoolStatsProvider& provider);
+    bool detachMemoryPool(ResourceType type);
+    // Combined stats of the internal pool and any attached pool of this type
+    MemoryPoolStats getMemoryPoolStats(ResourceType type) const;
     
     // Thread safety utilities
     class ResourceLock {
@@ -153,6 +179,7 @@ private:
     bool validateResourceAccess(int resourceId, int channelIndex);
     void updateResourceUsage(ResourceInfo* resource);
     void cleanupResourceInternal(ResourceInfo* resource);
+    void updatePoolPeak(MemoryPool* pool);
     void cleanupLoop();
     bool isResourceExpired(const ResourceInfo* resource) const;
     void enforceMemoryLimits();
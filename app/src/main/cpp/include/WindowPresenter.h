@@ -0,0 +1,95 @@
+#ifndef AIBOX_WINDOW_PRESENTER_H
+#define AIBOX_WINDOW_PRESENTER_H
+
+#include <android/native_window.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "user_comm.h"
+
+/**
+ * Present Window
+ * The three ANativeWindow calls a presentation needs. NativePresentWindow
+ * forwards them to a real window; tests substitute a fake window with a
+ * padded stride. Return values follow the NDK: 0 on success.
+ */
+class PresentWindow {
+public:
+    virtual ~PresentWindow() {}
+
+    // Buffer size and RGBA_8888 format of the buffers returned by lock()
+    virtual int32_t setBuffersGeometry(int32_t width, int32_t height) = 0;
+    virtual int32_t lock(ANativeWindow_Buffer& buffer) = 0;
+    virtual int32_t unlockAndPost() = 0;
+};
+
+class NativePresentWindow : public PresentWindow {
+public:
+    // Does not take a reference: the owner of window keeps it alive while this wrapper is in use
+    explicit NativePresentWindow(ANativeWindow* window) : m_window(window) {}
+
+    // nullptr for a null window
+    static std::unique_ptr<PresentWindow> wrap(ANativeWindow* window);
+
+    int32_t setBuffersGeometry(int32_t width, int32_t height) override;
+    int32_t lock(ANativeWindow_Buffer& buffer) override;
+    int32_t unlockAndPost() override;
+
+private:
+    ANativeWindow* m_window;
+};
+
+/**
+ * Window Presenter
+ * Writes frames straight into the locked window buffer: RGBA rows are copied
+ * with the source and window strides, NV12 is converted by FrameConverter
+ * (RGA, or the CPU path) into buffer.bits. There is no staging frame.
+ *
+ * The buffer geometry is set only when the frame size differs from the last
+ * size set on the current window, not on every frame.
+ *
+ * lock() and post() bracket the write so callers can draw overlays into the
+ * buffer before it is posted. Not thread-safe: the caller serialises access,
+ * as it has to for the window itself.
+ */
+class WindowPresenter {
+public:
+    struct Stats {
+        uint64_t presented;        // Buffers posted
+        uint64_t geometryChanges;  // setBuffersGeometry calls
+        uint64_t lockFailures;     // Geometry or lock failed, nothing posted
+        uint64_t writeFailures;    // Buffer posted without the frame (size mismatch or conversion error)
+    };
+
+    WindowPresenter();
+
+    // Replaces the window; the next lock() sets the geometry again. nullptr detaches.
+    void setWindow(std::unique_ptr<PresentWindow> window);
+    bool hasWindow() const;
+
+    // Set the geometry if width x height changed, then lock; 0 on success, the failing call's result otherwise
+    int32_t lock(int width, int height, ANativeWindow_Buffer& buffer);
+    int32_t post();
+
+    // Copy or convert into a locked buffer; false (buffer untouched) if it is smaller than the frame
+    static bool writeFrame(const frame_data_t& frame, const ANativeWindow_Buffer& buffer, bool useRga = true);
+    static bool writeRGBA(const uint8_t* src, int width, int height, int srcStride, const ANativeWindow_Buffer& buffer);
+
+    // lock + write + post
+    bool present(const frame_data_t& frame, bool useRga = true);
+    bool presentRGBA(const uint8_t* src, int width, int height, int srcStride);
+
+    Stats getStats() const;
+
+private:
+    // Records a failed write; the buffer is still posted so the lock is released
+    bool finish(bool written);
+
+    std::unique_ptr<PresentWindow> m_window;
+    int m_width;   // Geometry last set on m_window, 0 when none
+    int m_height;
+    Stats m_stats;
+};
+
+#endif // AIBOX_WINDOW_PRESENTER_H
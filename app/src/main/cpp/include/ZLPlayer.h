@@ -1,6 +1,7 @@
 #ifndef AIBOX_ZLPLAYER_H
 #define AIBOX_ZLPLAYER_H
 
+#include <atomic>
 #include "safe_queue.h"
 #include "util.h"
 #include "rknn_api.h"
@@ -13,15 +14,29 @@
 #include "rga_utils.h"
 #include "mpp_decoder.h"
 #include "yolov5_thread_pool.h"
+#include "inference_scheduler.h"
+#include "result_reorder_buffer.h"
 #include "display_queue.h"
+#include "PresentationClock.h"
+#include "DetectionCadence.h"
+#include "SortTracker.h"
 #include "EnhancedDetectionRenderer.h"
+#include "WindowPresenter.h"
+#include "MultiSurfaceRenderer.h"
 #include <android/native_window.h>
 
 typedef struct g_rknn_app_context_t {
     FILE *out_fp;
     MppDecoder *decoder;
     Yolov5ThreadPool *yolov5ThreadPool;
+    // 多通道模式下使用进程共享的推理调度器（不归本上下文所有），此时不创建yolov5ThreadPool
+    InferenceScheduler *inferenceScheduler;
+    int channelIndex;
     RenderFrameQueue *renderFrameQueue;
+    // 解码回调据此决定哪些帧送推理（归ZLPlayer所有）
+    DetectionCadence *detectionCadence;
+    // 共享调度器中本通道的排队负载（0-1），解码线程每隔若干帧采样一次
+    float inferenceLoad;
     // MppEncoder *encoder;
     // mk_media media;
     // mk_pusher pusher;
@@ -35,16 +50,35 @@ typedef struct g_rknn_app_context_t {
 
 } rknn_app_context_t;
 
-class ZLPlayer {
+class ZLPlayer : public PresentSource {
 
 private:
     char *data_source = 0; // 指针 请赋初始值
     pthread_t pid_rtsp = 0;
-    pthread_t pid_render = 0;
+    pthread_t pid_render = 0;  // Own display thread, only without a shared renderer
     char *modelFileContent = 0;
     int modelFileSize = 0;
 
-    std::chrono::steady_clock::time_point nextRendTime;
+    // Nominal stream frame rate for the decoder; display() follows the frames' PTS
+    static const int DISPLAY_FPS = 25;
+    PresentationClock presentationClock;
+
+    // Shared render pool presenting this channel (not owned), registered under presentChannel
+    MultiSurfaceRenderer *presentRenderer = nullptr;
+    int presentChannel = 0;
+    // Frame taken by nextFrame(), shown at pendingPresentUs (presenting thread only)
+    std::shared_ptr<frame_data_t> pendingFrame;
+    int64_t pendingPresentUs = 0;
+
+    // Longest result-thread wait without a completion; only bounds how often isStreaming is rechecked
+    static const int RESULT_IDLE_WAIT_MS = 500;
+
+    // Puts out-of-order inference completions back in frameId order for the render queue
+    ResultReorderBuffer resultReorder;
+
+    // Which frames go to the NPU; boxTracker gives detections track ids and fills in the skipped frames (result thread only)
+    DetectionCadence detectionCadence;
+    SortTracker boxTracker;
 
     // Enhanced detection rendering
     std::shared_ptr<EnhancedDetectionRenderer> enhancedDetectionRenderer;
@@ -55,6 +89,8 @@ private:
     // Channel-specific surface management
     ANativeWindow* channelSurface = nullptr;
     pthread_mutex_t surfaceMutex = PTHREAD_MUTEX_INITIALIZER;
+    // Geometry, lock and post of channelSurface (guarded by surfaceMutex)
+    WindowPresenter surfacePresenter;
 
     // Surface health monitoring
     int surfaceInvalidCount = 0;
@@ -67,19 +103,35 @@ private:
     static const long SURFACE_RECOVERY_TIMEOUT_MS = 10000; // 10 seconds
     static const int MAX_SURFACE_RECOVERY_ATTEMPTS = 3;
 
+    // Surface recovery in progress: true with how long to wait before trying again
+    bool surfaceRecoveryPending(int &retryMs);
+    // Lock channelSurface for a width x height RGBA frame; on success surfaceMutex stays held
+    // until postChannelSurface()
+    bool lockChannelSurface(int width, int height, ANativeWindow_Buffer &window_buffer);
+    void postChannelSurface(int width, int height);
+    // Non-blocking take of frameId's detections and image from the thread pool or scheduler
+    bool fetchInferenceResult(int frameId, ResultReorderBuffer::Result &out);
+    // Block until the thread pool or scheduler completes another frame of this channel
+    nn_error_e waitForInferenceResult(uint64_t &seen, int timeout_ms);
+    void drawDetectionsRGBA(uint8_t *rgba, int width, int height, int stride, const std::vector<Detection> &detections);
+
 public:
     // static RenderCallback renderCallback;
     rknn_app_context_t app_ctx;
     char rtsp_url[512]; // RTSP URL storage
-    bool isStreaming = 0; // 是否播放
+    std::atomic<bool> isStreaming{false}; // 是否播放：结果线程与显示线程的运行标志，析构时清除
     int channelIndex = 0;
 
     // ZLPlayer(const char *data_source, JNICallbackHelper *helper);
-    ZLPlayer(char *modelFileData, int modelDataLen);
+    // scheduler非空时帧提交到共享调度器的channelIndex通道，否则创建本播放器私有的线程池
+    // renderer非空时由共享渲染线程池按PTS送显，否则启动本播放器自己的显示线程
+    ZLPlayer(char *modelFileData, int modelDataLen, InferenceScheduler *scheduler = nullptr, int channelIndex = 0,
+             MultiSurfaceRenderer *renderer = nullptr);
 
     ~ZLPlayer();
 
     static void mpp_decoder_frame_callback(void *userdata, int width_stride, int height_stride, int width, int height, int format, int fd, void *data);
+    static void mpp_decoder_frame_lease_callback(void *userdata, const std::shared_ptr<MppFrameLease> &lease);
 
     int process_video_rtsp();
 
@@ -88,14 +140,24 @@ public:
 
     // void setRenderCallback(RenderCallback renderCallback_);
 
+    // One step of the own display thread: sleep until the next frame is due, then present it
     void display();
 
+    // PresentSource: frames from the render queue at their PTS presentation times
+    bool nextFrame(int64_t nowUs, int64_t &timeUs, int &droppedFrames) override;
+    bool presentFrame() override;
+    void dropFrame() override;
+    // Leave the shared renderer; no frame is presented once this returns (called before teardown)
+    void stopPresenting();
+
     void get_detect_result();
 
     // Enhanced detection rendering methods
     void setEnhancedDetectionRenderer(std::shared_ptr<EnhancedDetectionRenderer> renderer);
     void setRenderingMonitor(std::shared_ptr<DetectionRenderingMonitor> monitor);
     void setChannelIndex(int index);
+    // Detect every Nth frame (or adaptively), see PerChannelDetection::cadenceConfig()
+    void setDetectionCadence(const DetectionCadence::Config &config);
     void setActiveChannel(bool active);
     void updateSystemLoad(float load);
     float getCurrentSystemLoad() const;
@@ -104,6 +166,9 @@ public:
     void setChannelSurface(ANativeWindow* surface);
     ANativeWindow* getChannelSurface() const;
     void renderFrame(uint8_t *src_data, int width, int height, int src_line_size);
+    // drawDetections: draw frame.detections on the window buffer after conversion (for read-only frames).
+    // false if the frame did not reach the window
+    bool renderFrame(const frame_data_t &frame, bool drawDetections = false);
 
     // Surface recovery and health monitoring
     bool isSurfaceRecoveryRequested() const;
@@ -1,33 +1,90 @@
 #ifndef AIBOX_DISPLAY_QUEUE_H
 #define AIBOX_DISPLAY_QUEUE_H
 
-#include <iostream>
-#include <queue>
-#include <thread>
-#include <mutex>
-#include <condition_variable>
-#include <chrono>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include "log4c.h"
 #include "user_comm.h"
 
-#define DISPLAY_QUEUE_MAX_SIZE 60
-using namespace std;
+// Live view shows the newest frame only
+#define RENDER_QUEUE_LIVE_DEPTH 1
+// PTS-scheduled display: frames wait in order for their presentation time (jitter buffer)
+#define RENDER_QUEUE_PTS_DEPTH 8
 
+/**
+ * Render Frame Queue
+ * Wait-free single-producer/single-consumer mailbox between the result
+ * thread (push) and the display thread (pop, clear). Neither side blocks or
+ * takes a lock; the display loop is paced by presentation times and polls
+ * the queue when it is ready for the next frame.
+ *
+ * depth == 1: latest-frame-wins. A push replaces a frame the display has not
+ *             taken yet, so queueing delay is at most one display interval.
+ * depth  > 1: FIFO of up to depth frames; a push into a full queue drops the
+ *             incoming frame.
+ * Every dropped frame is counted in Stats.
+ */
 class RenderFrameQueue {
 public:
-    void push(std::shared_ptr <frame_data_t> &frameDataPtr);
+    struct Stats {
+        uint64_t pushed;   // Frames offered by the producer
+        uint64_t popped;   // Frames handed to the display
+        uint64_t dropped;  // Replaced (depth 1) or rejected (full FIFO)
+        uint64_t invalid;  // Null frames or frames without data
+    };
 
-    std::shared_ptr <frame_data_t> pop();
+    explicit RenderFrameQueue(size_t depth = RENDER_QUEUE_LIVE_DEPTH, int channelIndex = -1);
 
-    int size();
+    RenderFrameQueue(const RenderFrameQueue&) = delete;
+    RenderFrameQueue& operator=(const RenderFrameQueue&) = delete;
 
-    void clear();  // Clear all frames from queue
+    // Producer side. Returns false if this frame was not queued.
+    bool push(std::shared_ptr<frame_data_t>& frameDataPtr);
+
+    // Consumer side, non-blocking: nullptr when nothing new is queued
+    std::shared_ptr<frame_data_t> pop();
+
+    // Consumer side: drop everything queued (counted as dropped)
+    void clear();
+
+    // Approximate when called concurrently
+    int size() const;
+    size_t depth() const { return m_depth; }
+    Stats getStats() const;
 
 private:
-    queue <std::shared_ptr<frame_data_t>> m_queue;
-    mutex m_mutex;
-    condition_variable m_cond;
+    static const uint8_t kFresh = 0x4;  // Mailbox middle slot holds an unread frame
+
+    bool pushMailbox(std::shared_ptr<frame_data_t>& frameDataPtr);
+    std::shared_ptr<frame_data_t> popMailbox();
+    bool pushFifo(std::shared_ptr<frame_data_t>& frameDataPtr);
+    std::shared_ptr<frame_data_t> popFifo();
+    void countDrop(int frameId);
+
+    const size_t m_depth;
+    const int m_channelIndex;
+
+    // depth 1: triple buffer. The producer owns m_back, the consumer m_front, and the
+    // middle index (plus kFresh) is exchanged atomically between them.
+    std::shared_ptr<frame_data_t> m_mailbox[3];
+    uint8_t m_back;
+    uint8_t m_front;
+    std::atomic<uint8_t> m_middle;
+
+    // depth > 1: Lamport ring, m_tail written only by the producer, m_head only by the consumer
+    std::unique_ptr<std::shared_ptr<frame_data_t>[]> m_slots;
+    char m_pad0[64];
+    std::atomic<size_t> m_tail;
+    char m_pad1[64];
+    std::atomic<size_t> m_head;
+    char m_pad2[64];
+
+    std::atomic<uint64_t> m_pushed;
+    std::atomic<uint64_t> m_popped;
+    std::atomic<uint64_t> m_dropped;
+    std::atomic<uint64_t> m_invalid;
 };
 
 #endif //AIBOX_DISPLAY_QUEUE_H
@@ -7,9 +7,13 @@
 
 // Include Detection structure
 #include "yolo_datatype.h"
+#include "datatype.h"
+#include "FrameBufferPool.h"
 
 typedef struct g_frame_data_t {
-    std::unique_ptr<char[]> data;  // Use smart pointer for automatic memory management
+    // Pixel buffer. Pooled buffers (FrameBufferPool) go back to their pool when released;
+    // assign a new buffer rather than data.reset(p) so the deleter is replaced as well
+    FrameBuffer data;
     long dataSize;
     int screenStride;
     int screenW;
@@ -19,21 +23,35 @@ typedef struct g_frame_data_t {
     int frameId;
     int frameFormat;
 
+    // Stream presentation timestamp in ms (ZLMediaKit PTS, carried through the decoder), -1 if unknown
+    int64_t pts;
+    // steady_clock time in us when the frame was handed to the display (0 until then)
+    int64_t readyTimeUs;
+
+    // Letterbox geometry used when this frame was fed to the model
+    // (maps model-space boxes back to screenW x screenH)
+    letterbox_geometry_s letterbox;
+
     // Detection results for this frame
     std::vector<Detection> detections;
     bool hasDetections;
+    // Inference skipped by the channel's DetectionCadence; detections are propagated by the tracker
+    bool detectionSkipped;
 
     // Constructor
     g_frame_data_t() : dataSize(0), screenStride(0), screenW(0), screenH(0),
-                       widthStride(0), heightStride(0), frameId(0), frameFormat(0), hasDetections(false) {}
+                       widthStride(0), heightStride(0), frameId(0), frameFormat(0), pts(-1), readyTimeUs(0),
+                       letterbox(), hasDetections(false), detectionSkipped(false) {}
 
     // Move constructor
     g_frame_data_t(g_frame_data_t&& other) noexcept
         : data(std::move(other.data)), dataSize(other.dataSize),
           screenStride(other.screenStride), screenW(other.screenW), screenH(other.screenH),
           widthStride(other.widthStride), heightStride(other.heightStride),
-          frameId(other.frameId), frameFormat(other.frameFormat),
-          detections(std::move(other.detections)), hasDetections(other.hasDetections) {}
+          frameId(other.frameId), frameFormat(other.frameFormat), pts(other.pts),
+          readyTimeUs(other.readyTimeUs), letterbox(other.letterbox),
+          detections(std::move(other.detections)), hasDetections(other.hasDetections),
+          detectionSkipped(other.detectionSkipped) {}
 
     // Move assignment operator
     g_frame_data_t& operator=(g_frame_data_t&& other) noexcept {
@@ -47,8 +65,12 @@ typedef struct g_frame_data_t {
             heightStride = other.heightStride;
             frameId = other.frameId;
             frameFormat = other.frameFormat;
+            pts = other.pts;
+            readyTimeUs = other.readyTimeUs;
+            letterbox = other.letterbox;
             detections = std::move(other.detections);
             hasDetections = other.hasDetections;
+            detectionSkipped = other.detectionSkipped;
         }
         return *this;
     }
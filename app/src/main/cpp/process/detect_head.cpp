@@ -0,0 +1,540 @@
+// 检测头解码：按模型输出张量的形状与类型选择解码器
+
+#include "detect_head.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "logging.h"
+
+namespace {
+
+// IEEE 754 half -> float
+inline float half_to_float(uint16_t h) {
+    uint32_t sign = (uint32_t) (h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1F;
+    uint32_t mant = h & 0x3FF;
+    uint32_t bits;
+    if (exp == 0) {
+        if (mant == 0) {
+            bits = sign;
+        } else {
+            // 非规格化数：规格化后再组装
+            exp = 127 - 15 + 1;
+            while ((mant & 0x400) == 0) {
+                mant <<= 1;
+                exp--;
+            }
+            bits = sign | (exp << 23) | ((mant & 0x3FF) << 13);
+        }
+    } else if (exp == 0x1F) {
+        bits = sign | 0x7F800000 | (mant << 13);
+    } else {
+        bits = sign | ((exp + 127 - 15) << 23) | (mant << 13);
+    }
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+inline float sigmoid(float x) { return 1.0 / (1.0 + expf(-x)); }
+
+inline float unsigmoid(float y) { return -1.0 * logf((1.0 / y) - 1.0); }
+
+// 输出元素的读取方式，按元素类型特化：
+//  load(v)           反量化/转换为float
+//  key(v)            用于比较大小的值（int8直接用原始值，避免反量化）
+//  threshold_key(f)  满足 key(v) > threshold_key(f) 当且仅当 load(v) > f
+template <typename T>
+struct Elem;
+
+template <>
+struct Elem<int8_t> {
+    typedef int key_t;
+    int32_t zp;
+    float scale;
+
+    explicit Elem(const tensor_attr_s &attr) : zp(attr.zp), scale(attr.scale) {}
+
+    float load(int8_t v) const { return ((float) v - (float) zp) * scale; }
+
+    int key(int8_t v) const { return v; }
+
+    int threshold_key(float f) const {
+        float q = floorf(f / scale + zp);
+        return q < -129.f ? -129 : (q > 127.f ? 127 : (int) q);
+    }
+};
+
+// float16以uint16_t存储
+template <>
+struct Elem<uint16_t> {
+    typedef float key_t;
+
+    explicit Elem(const tensor_attr_s &) {}
+
+    float load(uint16_t v) const { return half_to_float(v); }
+
+    float key(uint16_t v) const { return half_to_float(v); }
+
+    float threshold_key(float f) const { return f; }
+};
+
+template <>
+struct Elem<float> {
+    typedef float key_t;
+
+    explicit Elem(const tensor_attr_s &) {}
+
+    float load(float v) const { return v; }
+
+    float key(float v) const { return v; }
+
+    float threshold_key(float f) const { return f; }
+};
+
+inline void push_candidate(yolov5::decode_workspace_t *ws, float x, float y, float w, float h, float prob,
+                           int class_id) {
+    int n = ws->count++;
+    ws->boxes[n * 4 + 0] = x;
+    ws->boxes[n * 4 + 1] = y;
+    ws->boxes[n * 4 + 2] = w;
+    ws->boxes[n * 4 + 3] = h;
+    ws->obj_probs[n] = prob;
+    ws->class_ids[n] = class_id;
+}
+
+// 沿类别维（步长step）取最大key，取值相等时保留较小的类别号
+template <typename T>
+inline int class_argmax(const Elem<T> &elem, const T *cls, int step, int num_classes,
+                        typename Elem<T>::key_t &best) {
+    int best_id = 0;
+    best = elem.key(cls[0]);
+    for (int k = 1; k < num_classes; k++) {
+        typename Elem<T>::key_t v = elem.key(cls[k * step]);
+        if (v > best) {
+            best = v;
+            best_id = k;
+        }
+    }
+    return best_id;
+}
+
+const int g_anchors[3][6] = {{10, 13, 16, 30, 33, 23}, {30, 61, 62, 45, 59, 119}, {116, 90, 156, 198, 373, 326}};
+
+int total_cells(int model_in_h, int model_in_w) {
+    int cells = 0;
+    for (int stride = 8; stride <= 32; stride *= 2) {
+        cells += (model_in_h / stride) * (model_in_w / stride);
+    }
+    return cells;
+}
+
+// YOLOv5 float16 / float32：与int8路径相同的公式，objectness按logit阈值比较
+template <typename T>
+class Yolov5Head : public DetectHead {
+public:
+    Yolov5Head(const detect_head_info_s &info, const std::vector<tensor_attr_s> &outputs, int model_in_h,
+               int model_in_w) : model_in_h_(model_in_h), model_in_w_(model_in_w) {
+        info_ = info;
+        (void) outputs;
+    }
+
+    int Decode(const std::vector<tensor_data_s> &outputs, float conf_threshold,
+               yolov5::decode_workspace_t *ws) override {
+        yolov5::reserve_decode_workspace(ws, info_.max_candidates);
+        ws->count = 0;
+        const int num_classes = info_.num_classes;
+        const int prop_box_size = 5 + num_classes;
+        const float thres = unsigmoid(conf_threshold);
+        for (int b = 0; b < 3; b++) {
+            const int stride = 8 << b;
+            const int grid_h = model_in_h_ / stride, grid_w = model_in_w_ / stride, grid_len = grid_h * grid_w;
+            const T *input = (const T *) outputs[b].data;
+            Elem<T> elem(outputs[b].attr);
+            const int *anchor = g_anchors[b];
+            for (int a = 0; a < 3; a++) {
+                const T *box = input + (prop_box_size * a) * grid_len;
+                const T *conf = box + 4 * grid_len;
+                const T *cls = box + 5 * grid_len;
+                for (int cell = 0; cell < grid_len; cell++) {
+                    float box_confidence = elem.load(conf[cell]);
+                    if (box_confidence < thres) {
+                        continue;
+                    }
+                    typename Elem<T>::key_t best;
+                    int best_id = class_argmax(elem, cls + cell, grid_len, num_classes, best);
+                    if (!(best > thres)) {
+                        continue;
+                    }
+                    const int i = cell / grid_w, j = cell % grid_w;
+                    const T *in_ptr = box + cell;
+                    float box_x = sigmoid(elem.load(in_ptr[0])) * 2.0 - 0.5;
+                    float box_y = sigmoid(elem.load(in_ptr[grid_len])) * 2.0 - 0.5;
+                    float box_w = sigmoid(elem.load(in_ptr[2 * grid_len])) * 2.0;
+                    float box_h = sigmoid(elem.load(in_ptr[3 * grid_len])) * 2.0;
+                    box_x = (box_x + j) * (float) stride;
+                    box_y = (box_y + i) * (float) stride;
+                    box_w = box_w * box_w * (float) anchor[a * 2];
+                    box_h = box_h * box_h * (float) anchor[a * 2 + 1];
+                    box_x -= (box_w / 2.0);
+                    box_y -= (box_h / 2.0);
+                    push_candidate(ws, box_x, box_y, box_w, box_h,
+                                   sigmoid(elem.load(cls[cell + best_id * grid_len])) * sigmoid(box_confidence),
+                                   best_id);
+                }
+            }
+        }
+        return ws->count;
+    }
+
+private:
+    int model_in_h_;
+    int model_in_w_;
+};
+
+// YOLOv5 int8：使用SIMD阈值扫描 + sigmoid查找表的专用实现
+template <>
+class Yolov5Head<int8_t> : public DetectHead {
+public:
+    Yolov5Head(const detect_head_info_s &info, const std::vector<tensor_attr_s> &outputs, int model_in_h,
+               int model_in_w) : model_in_h_(model_in_h), model_in_w_(model_in_w) {
+        info_ = info;
+        for (int b = 0; b < 3; b++) {
+            zps_.push_back(outputs[b].zp);
+            scales_.push_back(outputs[b].scale);
+        }
+    }
+
+    int Decode(const std::vector<tensor_data_s> &outputs, float conf_threshold,
+               yolov5::decode_workspace_t *ws) override {
+        return yolov5::decode_outputs((int8_t *) outputs[0].data, (int8_t *) outputs[1].data,
+                                      (int8_t *) outputs[2].data, model_in_h_, model_in_w_, conf_threshold, zps_,
+                                      scales_, ws, yolov5::DECODE_IMPL_AUTO, info_.num_classes);
+    }
+
+private:
+    int model_in_h_;
+    int model_in_w_;
+    std::vector<int32_t> zps_;
+    std::vector<float> scales_;
+};
+
+// YOLOv8 DFL：每个分支 box(4*reg_max) / cls(C) / 可选score_sum(1)
+template <typename T>
+class Yolov8DflHead : public DetectHead {
+public:
+    Yolov8DflHead(const detect_head_info_s &info, const std::vector<tensor_attr_s> &outputs, int model_in_h,
+                  int model_in_w) : dfl_(info.reg_max) {
+        info_ = info;
+        int group = info.has_score_sum ? 3 : 2;
+        for (int b = 0; b < 3; b++) {
+            Branch branch;
+            branch.box = b * group;
+            branch.cls = b * group + 1;
+            branch.sum = info.has_score_sum ? b * group + 2 : -1;
+            branch.grid_h = (int) outputs[branch.cls].dims[2];
+            branch.grid_w = (int) outputs[branch.cls].dims[3];
+            branch.stride = model_in_h / branch.grid_h;
+            branches_.push_back(branch);
+        }
+        (void) model_in_w;
+    }
+
+    int Decode(const std::vector<tensor_data_s> &outputs, float conf_threshold,
+               yolov5::decode_workspace_t *ws) override {
+        yolov5::reserve_decode_workspace(ws, info_.max_candidates);
+        ws->count = 0;
+        const int num_classes = info_.num_classes;
+        const int reg_max = info_.reg_max;
+        for (const Branch &branch : branches_) {
+            const int grid_w = branch.grid_w, grid_len = branch.grid_h * branch.grid_w;
+            const T *box = (const T *) outputs[branch.box].data;
+            const T *cls = (const T *) outputs[branch.cls].data;
+            const T *sum = branch.sum >= 0 ? (const T *) outputs[branch.sum].data : nullptr;
+            Elem<T> box_elem(outputs[branch.box].attr);
+            Elem<T> cls_elem(outputs[branch.cls].attr);
+            Elem<T> sum_elem(outputs[branch.sum >= 0 ? branch.sum : branch.cls].attr);
+            const typename Elem<T>::key_t cls_thres = cls_elem.threshold_key(conf_threshold);
+            const typename Elem<T>::key_t sum_thres = sum_elem.threshold_key(conf_threshold);
+            for (int cell = 0; cell < grid_len; cell++) {
+                // score_sum不超过阈值时各类别分数也不会超过，直接跳过
+                if (sum != nullptr && !(sum_elem.key(sum[cell]) > sum_thres)) {
+                    continue;
+                }
+                typename Elem<T>::key_t best;
+                int best_id = class_argmax(cls_elem, cls + cell, grid_len, num_classes, best);
+                if (!(best > cls_thres)) {
+                    continue;
+                }
+                float dist[4];
+                for (int side = 0; side < 4; side++) {
+                    const T *bins = box + (side * reg_max) * grid_len + cell;
+                    float max_v = box_elem.load(bins[0]);
+                    for (int k = 0; k < reg_max; k++) {
+                        dfl_[k] = box_elem.load(bins[k * grid_len]);
+                        max_v = std::max(max_v, dfl_[k]);
+                    }
+                    float denom = 0.f, acc = 0.f;
+                    for (int k = 0; k < reg_max; k++) {
+                        float e = expf(dfl_[k] - max_v);
+                        denom += e;
+                        acc += e * k;
+                    }
+                    dist[side] = acc / denom;
+                }
+                const float cx = cell % grid_w + 0.5f, cy = cell / grid_w + 0.5f, s = (float) branch.stride;
+                const float x1 = (cx - dist[0]) * s, y1 = (cy - dist[1]) * s;
+                const float x2 = (cx + dist[2]) * s, y2 = (cy + dist[3]) * s;
+                push_candidate(ws, x1, y1, x2 - x1, y2 - y1, cls_elem.load(cls[cell + best_id * grid_len]),
+                               best_id);
+            }
+        }
+        return ws->count;
+    }
+
+private:
+    struct Branch {
+        int box, cls, sum;
+        int grid_h, grid_w, stride;
+    };
+    std::vector<Branch> branches_;
+    std::vector<float> dfl_;
+};
+
+// YOLOv8 单输出：kTransposed为false时为 [1, 4+C, N]，true时为 [1, N, 4+C]
+template <typename T, bool kTransposed>
+class Yolov8FusedHead : public DetectHead {
+public:
+    Yolov8FusedHead(const detect_head_info_s &info, const std::vector<tensor_attr_s> &outputs, int, int) {
+        info_ = info;
+        (void) outputs;
+    }
+
+    int Decode(const std::vector<tensor_data_s> &outputs, float conf_threshold,
+               yolov5::decode_workspace_t *ws) override {
+        yolov5::reserve_decode_workspace(ws, info_.max_candidates);
+        ws->count = 0;
+        const int num_classes = info_.num_classes;
+        const int n = info_.max_candidates;
+        // 元素(k, i)：第i个候选的第k个值
+        const int step_k = kTransposed ? 1 : n;
+        const int step_i = kTransposed ? 4 + num_classes : 1;
+        const T *data = (const T *) outputs[0].data;
+        Elem<T> elem(outputs[0].attr);
+        const typename Elem<T>::key_t thres = elem.threshold_key(conf_threshold);
+        for (int i = 0; i < n; i++) {
+            const T *p = data + i * step_i;
+            typename Elem<T>::key_t best;
+            int best_id = class_argmax(elem, p + 4 * step_k, step_k, num_classes, best);
+            if (!(best > thres)) {
+                continue;
+            }
+            float cx = elem.load(p[0]), cy = elem.load(p[step_k]);
+            float w = elem.load(p[2 * step_k]), h = elem.load(p[3 * step_k]);
+            push_candidate(ws, cx - w / 2, cy - h / 2, w, h, elem.load(p[(4 + best_id) * step_k]), best_id);
+        }
+        return ws->count;
+    }
+};
+
+template <typename T>
+DetectHead *make_head(const detect_head_info_s &info, bool transposed, const std::vector<tensor_attr_s> &outputs,
+                      int model_in_h, int model_in_w) {
+    switch (info.type) {
+        case DETECT_HEAD_YOLOV5:
+            return new Yolov5Head<T>(info, outputs, model_in_h, model_in_w);
+        case DETECT_HEAD_YOLOV8_DFL:
+            return new Yolov8DflHead<T>(info, outputs, model_in_h, model_in_w);
+        case DETECT_HEAD_YOLOV8_FUSED:
+            if (transposed) {
+                return new Yolov8FusedHead<T, true>(info, outputs, model_in_h, model_in_w);
+            }
+            return new Yolov8FusedHead<T, false>(info, outputs, model_in_h, model_in_w);
+    }
+    return nullptr;
+}
+
+// 4维NCHW输出 [1, channels, model/stride, model/stride]
+bool is_grid_output(const tensor_attr_s &attr, int model_in_h, int model_in_w, int stride) {
+    return attr.n_dims == 4 && attr.dims[0] == 1 && attr.layout != NN_TENSOR_NHWC &&
+           (int) attr.dims[2] == model_in_h / stride && (int) attr.dims[3] == model_in_w / stride;
+}
+
+bool identify_head(const std::vector<tensor_attr_s> &outputs, int model_in_h, int model_in_w,
+                   detect_head_info_s &info, bool &transposed) {
+    memset(&info, 0, sizeof(info));
+    transposed = false;
+    const int n = (int) outputs.size();
+    if (n == 3) {
+        info.type = DETECT_HEAD_YOLOV5;
+        for (int b = 0; b < 3; b++) {
+            const tensor_attr_s &attr = outputs[b];
+            if (!is_grid_output(attr, model_in_h, model_in_w, 8 << b) || attr.dims[1] % 3 != 0 ||
+                (int) attr.dims[1] / 3 <= 5) {
+                return false;
+            }
+            int num_classes = (int) attr.dims[1] / 3 - 5;
+            if (b > 0 && num_classes != info.num_classes) {
+                return false;
+            }
+            info.num_classes = num_classes;
+        }
+        info.max_candidates = 3 * total_cells(model_in_h, model_in_w);
+        return true;
+    }
+    if (n == 6 || n == 9) {
+        info.type = DETECT_HEAD_YOLOV8_DFL;
+        info.has_score_sum = n == 9;
+        const int group = n / 3;
+        for (int b = 0; b < 3; b++) {
+            const tensor_attr_s &box = outputs[b * group];
+            const tensor_attr_s &cls = outputs[b * group + 1];
+            if (!is_grid_output(box, model_in_h, model_in_w, 8 << b) ||
+                !is_grid_output(cls, model_in_h, model_in_w, 8 << b) || box.dims[1] % 4 != 0) {
+                return false;
+            }
+            if (info.has_score_sum &&
+                (!is_grid_output(outputs[b * group + 2], model_in_h, model_in_w, 8 << b) ||
+                 outputs[b * group + 2].dims[1] != 1)) {
+                return false;
+            }
+            if (b > 0 && ((int) cls.dims[1] != info.num_classes || (int) box.dims[1] / 4 != info.reg_max)) {
+                return false;
+            }
+            info.num_classes = (int) cls.dims[1];
+            info.reg_max = (int) box.dims[1] / 4;
+        }
+        info.max_candidates = total_cells(model_in_h, model_in_w);
+        return info.num_classes > 0 && info.reg_max > 0;
+    }
+    if (n == 1) {
+        // [1, a, b] 或 [1, a, b, 1]，较短的一维为 4+C
+        const tensor_attr_s &attr = outputs[0];
+        if (attr.n_dims < 3 || attr.dims[0] != 1 || (attr.n_dims == 4 && attr.dims[3] != 1)) {
+            return false;
+        }
+        int a = (int) attr.dims[1], b = (int) attr.dims[2];
+        transposed = a > b;
+        int props = transposed ? b : a;
+        info.type = DETECT_HEAD_YOLOV8_FUSED;
+        info.num_classes = props - 4;
+        info.max_candidates = transposed ? a : b;
+        return info.num_classes > 0;
+    }
+    return false;
+}
+
+} // namespace
+
+const char *detect_head_name(detect_head_type_e type) {
+    switch (type) {
+        case DETECT_HEAD_YOLOV5:
+            return "yolov5";
+        case DETECT_HEAD_YOLOV8_DFL:
+            return "yolov8-dfl";
+        case DETECT_HEAD_YOLOV8_FUSED:
+            return "yolov8-fused";
+    }
+    return "unknown";
+}
+
+nn_error_e create_detect_head(const std::vector<tensor_attr_s> &outputs, int model_in_h, int model_in_w,
+                              std::unique_ptr<DetectHead> &head) {
+    head.reset();
+    detect_head_info_s info;
+    bool transposed = false;
+    if (!identify_head(outputs, model_in_h, model_in_w, info, transposed)) {
+        NN_LOG_ERROR("unsupported detection head: %d outputs", (int) outputs.size());
+        return NN_RKNN_OUTPUT_ATTR_ERROR;
+    }
+    info.dtype = outputs[0].type;
+    for (const tensor_attr_s &attr : outputs) {
+        if (attr.type != info.dtype) {
+            NN_LOG_ERROR("detection head outputs have mixed types");
+            return NN_RKNN_OUTPUT_ATTR_ERROR;
+        }
+    }
+    switch (info.dtype) {
+        case NN_TENSOR_INT8:
+            head.reset(make_head<int8_t>(info, transposed, outputs, model_in_h, model_in_w));
+            break;
+        case NN_TENSOR_FLOAT16:
+            head.reset(make_head<uint16_t>(info, transposed, outputs, model_in_h, model_in_w));
+            break;
+        case NN_TENSOR_FLOAT:
+            head.reset(make_head<float>(info, transposed, outputs, model_in_h, model_in_w));
+            break;
+        default:
+            NN_LOG_ERROR("unsupported detection head output type: %d", info.dtype);
+            return NN_RKNN_OUTPUT_ATTR_ERROR;
+    }
+    NN_LOG_INFO("detection head: %s, %d classes, type %d", detect_head_name(info.type), info.num_classes,
+                info.dtype);
+    return NN_SUCCESS;
+}
+
+bool parse_labels_from_custom_string(const std::string &custom, std::vector<std::string> &labels) {
+    const std::string key = "labels=";
+    size_t pos = 0;
+    while (pos < custom.size()) {
+        size_t end = custom.find(';', pos);
+        if (end == std::string::npos) {
+            end = custom.size();
+        }
+        size_t start = custom.find_first_not_of(' ', pos);
+        if (start != std::string::npos && start < end && custom.compare(start, key.size(), key) == 0) {
+            labels.clear();
+            size_t item = start + key.size();
+            while (item <= end) {
+                size_t comma = custom.find(',', item);
+                if (comma == std::string::npos || comma > end) {
+                    comma = end;
+                }
+                labels.push_back(custom.substr(item, comma - item));
+                item = comma + 1;
+            }
+            return !labels.empty() && !(labels.size() == 1 && labels[0].empty());
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
+bool load_labels_file(const char *path, std::vector<std::string> &labels) {
+    FILE *fp = fopen(path, "r");
+    if (fp == nullptr) {
+        NN_LOG_ERROR("open labels file %s fail", path);
+        return false;
+    }
+    labels.clear();
+    char line[256];
+    while (fgets(line, sizeof(line), fp) != nullptr) {
+        size_t len = strlen(line);
+        while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+            line[--len] = '\0';
+        }
+        labels.push_back(line);
+    }
+    fclose(fp);
+    // 文件末尾的空行不计
+    while (!labels.empty() && labels.back().empty()) {
+        labels.pop_back();
+    }
+    return !labels.empty();
+}
+
+std::vector<std::string> default_labels(int num_classes) {
+    std::vector<std::string> labels;
+    for (int i = 0; i < num_classes; i++) {
+        if (num_classes == OBJ_CLASS_NUM) {
+            labels.push_back(yolov5::coco_label(i));
+        } else {
+            labels.push_back("class_" + std::to_string(i));
+        }
+    }
+    return labels;
+}
@@ -0,0 +1,65 @@
+// 检测头解码：按模型输出张量的形状与类型选择解码器
+//
+// 支持的输出布局（NCHW）：
+//  - YOLOv5：3个分支 [1, 3*(5+C), H, W]，stride 8/16/32，anchor框，logits需sigmoid
+//  - YOLOv8 DFL：每个分支 box [1, 4*reg_max, H, W] + cls [1, C, H, W]（+ 可选 score_sum [1, 1, H, W]），
+//    共6或9个输出，无anchor，cls为sigmoid后的概率（rknn_model_zoo导出方式）
+//  - YOLOv8 单输出：[1, 4+C, N]（或 [1, N, 4+C]），框已解码为 cx, cy, w, h，cls为概率
+// 元素类型为 int8（按zp/scale反量化）、float16 或 float32。解码器是按(布局, 元素类型)特化的模板，
+// 加载模型时选定一次，逐框循环中没有类型或布局判断
+
+#ifndef RK3588_DEMO_DETECT_HEAD_H
+#define RK3588_DEMO_DETECT_HEAD_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "datatype.h"
+#include "yolov5_postprocess.h"
+
+typedef enum _detect_head_type {
+    DETECT_HEAD_YOLOV5 = 0,
+    DETECT_HEAD_YOLOV8_DFL = 1,
+    DETECT_HEAD_YOLOV8_FUSED = 2,
+} detect_head_type_e;
+
+typedef struct _detect_head_info_s {
+    detect_head_type_e type;
+    tensor_datatype_e dtype;
+    int num_classes;
+    int reg_max;        // YOLOv8 DFL的分布长度
+    bool has_score_sum; // YOLOv8 DFL是否带score_sum快速过滤输出
+    int max_candidates; // 解码缓冲区需要的候选框容量
+} detect_head_info_s;
+
+class DetectHead {
+public:
+    virtual ~DetectHead() {}
+
+    const detect_head_info_s &Info() const { return info_; }
+
+    // 解码全部输出张量，候选框写入ws（x, y, w, h为模型输入坐标），返回候选框数（未做NMS）
+    virtual int Decode(const std::vector<tensor_data_s> &outputs, float conf_threshold,
+                       yolov5::decode_workspace_t *ws) = 0;
+
+protected:
+    detect_head_info_s info_;
+};
+
+// 按输出张量属性识别检测头并创建对应的解码器；不支持的布局返回NN_RKNN_OUTPUT_ATTR_ERROR
+nn_error_e create_detect_head(const std::vector<tensor_attr_s> &outputs, int model_in_h, int model_in_w,
+                              std::unique_ptr<DetectHead> &head);
+
+const char *detect_head_name(detect_head_type_e type);
+
+// 从模型自定义字符串解析标签："labels=person,bicycle,car"，可与其他 key=value 以';'分隔
+bool parse_labels_from_custom_string(const std::string &custom, std::vector<std::string> &labels);
+
+// 读取标签文件，每行一个类别名
+bool load_labels_file(const char *path, std::vector<std::string> &labels);
+
+// 没有模型标签与标签文件时的默认值：80类为COCO标签，其余为 "class_<id>"
+std::vector<std::string> default_labels(int num_classes);
+
+#endif // RK3588_DEMO_DETECT_HEAD_H
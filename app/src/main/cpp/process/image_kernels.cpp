@@ -0,0 +1,572 @@
+// 图像缩放与混合内核
+//
+// 映射表按视口尺寸预先计算一次，每帧只做查表：
+//  - 双线性：两条源行按7位权重混合成16位行（SIMD，连续内存，相同源行对的目标行复用），
+//    再按列表取两点、以11位权重混合（4通道时SIMD每次处理两个像素）
+//  - 最近邻：列间距恒定（整数倍缩小）时用交错加载抽取像素，否则逐像素查表；
+//    映射到同一源行的目标行直接复制上一行
+// 混合全部为8位定点，除以255用 (x + 128) * 257 >> 16（NEON为等价的 (t + (t >> 8)) >> 8，SSE2为mulhi）
+// 舍入方式与标量实现相同，SIMD与标量结果逐位一致
+
+#include "image_kernels.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define IMAGE_KERNELS_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define IMAGE_KERNELS_SSE2 1
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define IMAGE_KERNELS_AVX2 1
+#endif
+#endif
+
+static const int g_vcoef_one = 1 << IMAGE_VCOEF_BITS;
+static const int g_hcoef_one = 1 << IMAGE_HCOEF_BITS;
+// 两次插值后的舍入与移位
+static const int g_round_shift = IMAGE_VCOEF_BITS + IMAGE_HCOEF_BITS;
+static const int g_round_bias = 1 << (g_round_shift - 1);
+
+const char *image_kernels_simd_name() {
+#if defined(IMAGE_KERNELS_NEON)
+    return "neon";
+#elif defined(IMAGE_KERNELS_AVX2)
+    return "avx2";
+#elif defined(IMAGE_KERNELS_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+void scale_map_coord(int d, int src, int dst, int coef_bits, int &i0, int &i1, int &w) {
+    const int one = 1 << coef_bits;
+    double f = (d + 0.5) * src / dst - 0.5;
+    if (f < 0.0) {
+        f = 0.0;
+    }
+    i0 = (int) f;
+    w = (int) ((f - i0) * one + 0.5);
+    if (w == one) {
+        i0++;
+        w = 0;
+    }
+    if (i0 >= src - 1) {
+        i0 = src - 1;
+        w = 0;
+    }
+    i1 = w > 0 ? i0 + 1 : i0;
+}
+
+// ---------------------------------------------------------------------------
+// 垂直插值：最大 255 * 128，用uint16保存；水平插值再乘以11位权重，最大 255 * 128 * 2048，32位不会溢出
+
+static void blend_rows_scalar(const uint8_t *s0, const uint8_t *s1, int w, uint16_t *out, int n, int i) {
+    const int w0 = g_vcoef_one - w;
+    for (; i < n; i++) {
+        out[i] = (uint16_t) (s0[i] * w0 + s1[i] * w);
+    }
+}
+
+void blend_rows_u16(const uint8_t *s0, const uint8_t *s1, int w, uint16_t *out, int n, image_kernel_impl_e impl) {
+    int i = 0;
+    if (impl != IMAGE_KERNEL_IMPL_SCALAR) {
+#if defined(IMAGE_KERNELS_NEON)
+        const uint8x8_t w0 = vdup_n_u8((uint8_t) (g_vcoef_one - w));
+        const uint8x8_t w1 = vdup_n_u8((uint8_t) w);
+        for (; i + 16 <= n; i += 16) {
+            uint8x16_t a = vld1q_u8(s0 + i);
+            uint8x16_t b = vld1q_u8(s1 + i);
+            uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(a), w0), vget_low_u8(b), w1);
+            uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(a), w0), vget_high_u8(b), w1);
+            vst1q_u16(out + i, lo);
+            vst1q_u16(out + i + 8, hi);
+        }
+#elif defined(IMAGE_KERNELS_AVX2)
+        const __m256i w0 = _mm256_set1_epi16((short) (g_vcoef_one - w));
+        const __m256i w1 = _mm256_set1_epi16((short) w);
+        for (; i + 16 <= n; i += 16) {
+            __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (s0 + i)));
+            __m256i b = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (s1 + i)));
+            __m256i v = _mm256_add_epi16(_mm256_mullo_epi16(a, w0), _mm256_mullo_epi16(b, w1));
+            _mm256_storeu_si256((__m256i *) (out + i), v);
+        }
+#elif defined(IMAGE_KERNELS_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i w0 = _mm_set1_epi16((short) (g_vcoef_one - w));
+        const __m128i w1 = _mm_set1_epi16((short) w);
+        for (; i + 16 <= n; i += 16) {
+            __m128i a = _mm_loadu_si128((const __m128i *) (s0 + i));
+            __m128i b = _mm_loadu_si128((const __m128i *) (s1 + i));
+            __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), w0),
+                                       _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), w1));
+            __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), w0),
+                                       _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), w1));
+            _mm_storeu_si128((__m128i *) (out + i), lo);
+            _mm_storeu_si128((__m128i *) (out + i + 8), hi);
+        }
+#endif
+    }
+    blend_rows_scalar(s0, s1, w, out, n, i);
+}
+
+// ---------------------------------------------------------------------------
+// 水平插值：v为垂直混合后的16位行，从源行第origin个字节开始；col0/col1减去origin即行内元素偏移
+
+static inline void blend_pixel_scalar(const uint16_t *a, const uint16_t *b, int w1, int channels, uint8_t *dst) {
+    const uint32_t w0 = (uint32_t) (g_hcoef_one - w1);
+    for (int c = 0; c < channels; c++) {
+        dst[c] = (uint8_t) ((a[c] * w0 + b[c] * (uint32_t) w1 + g_round_bias) >> g_round_shift);
+    }
+}
+
+static void horizontal_row(const image_scale_map_s &map, const uint16_t *v, int origin, uint8_t *dst, bool simd) {
+    const int32_t *col0 = map.col0.data();
+    const int32_t *col1 = map.col1.data();
+    const int16_t *col_w = map.col_w.data();
+    const int n = map.dst_w;
+    const int ch = map.channels;
+    int x = 0;
+    if (simd && ch == 4) {
+#if defined(IMAGE_KERNELS_NEON)
+        const uint32x4_t bias = vdupq_n_u32(g_round_bias);
+        for (; x + 2 <= n; x += 2) {
+            const uint16_t *a0 = v + (col0[x] - origin), *b0 = v + (col1[x] - origin);
+            const uint16_t *a1 = v + (col0[x + 1] - origin), *b1 = v + (col1[x + 1] - origin);
+            uint32x4_t p0 = vmlal_n_u16(vmull_n_u16(vld1_u16(a0), (uint16_t) (g_hcoef_one - col_w[x])),
+                                        vld1_u16(b0), (uint16_t) col_w[x]);
+            uint32x4_t p1 = vmlal_n_u16(vmull_n_u16(vld1_u16(a1), (uint16_t) (g_hcoef_one - col_w[x + 1])),
+                                        vld1_u16(b1), (uint16_t) col_w[x + 1]);
+            uint16x4_t q0 = vmovn_u32(vshrq_n_u32(vaddq_u32(p0, bias), g_round_shift));
+            uint16x4_t q1 = vmovn_u32(vshrq_n_u32(vaddq_u32(p1, bias), g_round_shift));
+            vst1_u8(dst + x * 4, vmovn_u16(vcombine_u16(q0, q1)));
+        }
+#elif defined(IMAGE_KERNELS_SSE2)
+        // madd按(a,b)对计算 a*w0 + b*w1，16位行的值不超过32640，按有符号16位处理不会溢出
+        const __m128i bias = _mm_set1_epi32(g_round_bias);
+        for (; x + 2 <= n; x += 2) {
+            const uint16_t *a0 = v + (col0[x] - origin), *b0 = v + (col1[x] - origin);
+            const uint16_t *a1 = v + (col0[x + 1] - origin), *b1 = v + (col1[x + 1] - origin);
+            __m128i ab0 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *) a0),
+                                             _mm_loadl_epi64((const __m128i *) b0));
+            __m128i ab1 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *) a1),
+                                             _mm_loadl_epi64((const __m128i *) b1));
+            __m128i w0 = _mm_set1_epi32((g_hcoef_one - col_w[x]) | (col_w[x] << 16));
+            __m128i w1 = _mm_set1_epi32((g_hcoef_one - col_w[x + 1]) | (col_w[x + 1] << 16));
+            __m128i p0 = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(ab0, w0), bias), g_round_shift);
+            __m128i p1 = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(ab1, w1), bias), g_round_shift);
+            __m128i packed = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_setzero_si128());
+            _mm_storel_epi64((__m128i *) (dst + x * 4), packed);
+        }
+#endif
+    }
+    for (; x < n; x++) {
+        blend_pixel_scalar(v + (col0[x] - origin), v + (col1[x] - origin), col_w[x], ch, dst + x * ch);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 最近邻取样：列间距恒定时src指向第一个取样像素，依次间隔step个像素
+
+static void nearest_row(const image_scale_map_s &map, const uint8_t *src, uint8_t *dst, bool simd) {
+    const int n = map.dst_w;
+    const int ch = map.channels;
+    const int step = map.col_step;
+    if (step == 1) {
+        memcpy(dst, src + map.col0[0], (size_t) n * ch);
+        return;
+    }
+    int x = 0;
+    if (ch != 4) {
+        const int32_t *col0 = map.col0.data();
+        for (; x < n; x++) {
+            for (int c = 0; c < ch; c++) {
+                dst[x * ch + c] = src[col0[x] + c];
+            }
+        }
+        return;
+    }
+    if (simd && step > 1) {
+        const uint8_t *s = src + map.col0[0];
+#if defined(IMAGE_KERNELS_NEON)
+        // 交错加载一次取出step个像素中的第一个
+        const uint32_t *s32 = (const uint32_t *) s;
+        uint32_t *d32 = (uint32_t *) dst;
+        // 最后一组加载会读到step * 4个像素，需留在源行有效范围内
+        const int limit = (map.src_w - map.col0[0] / 4) / step;
+        switch (step) {
+            case 2:
+                for (; x + 4 <= n && x + 4 <= limit; x += 4) {
+                    vst1q_u32(d32 + x, vld2q_u32(s32 + x * 2).val[0]);
+                }
+                break;
+            case 3:
+                for (; x + 4 <= n && x + 4 <= limit; x += 4) {
+                    vst1q_u32(d32 + x, vld3q_u32(s32 + x * 3).val[0]);
+                }
+                break;
+            case 4:
+                for (; x + 4 <= n && x + 4 <= limit; x += 4) {
+                    vst1q_u32(d32 + x, vld4q_u32(s32 + x * 4).val[0]);
+                }
+                break;
+            default:
+                break;
+        }
+#elif defined(IMAGE_KERNELS_SSE2)
+        if (step == 2) {
+            const int limit = (map.src_w - map.col0[0] / 4) / 2;
+            for (; x + 4 <= n && x + 4 <= limit; x += 4) {
+                __m128 a = _mm_loadu_ps((const float *) (s + x * 8));
+                __m128 b = _mm_loadu_ps((const float *) (s + x * 8 + 16));
+                _mm_storeu_ps((float *) (dst + x * 4), _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            }
+        }
+#else
+        (void) s;
+#endif
+    }
+    for (; x < n; x++) {
+        memcpy(dst + x * 4, src + map.col0[x], 4);
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+void image_scale_map_init(image_scale_map_s &map, int src_w, int src_h, int dst_w, int dst_h, int channels,
+                          scale_filter_e filter) {
+    if (map.src_w == src_w && map.src_h == src_h && map.dst_w == dst_w && map.dst_h == dst_h &&
+        map.channels == channels && map.filter == filter && (int) map.col0.size() == dst_w &&
+        (int) map.row0.size() == dst_h) {
+        return;
+    }
+    map.src_w = src_w;
+    map.src_h = src_h;
+    map.dst_w = dst_w;
+    map.dst_h = dst_h;
+    map.channels = channels;
+    map.filter = filter;
+    map.col0.assign(std::max(dst_w, 0), 0);
+    map.col1.assign(std::max(dst_w, 0), 0);
+    map.col_w.assign(std::max(dst_w, 0), 0);
+    map.row0.assign(std::max(dst_h, 0), 0);
+    map.row1.assign(std::max(dst_h, 0), 0);
+    map.row_w.assign(std::max(dst_h, 0), 0);
+    map.col_step = 0;
+    if (src_w <= 0 || src_h <= 0 || dst_w <= 0 || dst_h <= 0 || channels < 1 || channels > 4) {
+        map.dst_w = 0;
+        return;
+    }
+
+    if (filter == SCALE_FILTER_NEAREST) {
+        // 取目标像素中心所在的源像素
+        for (int dx = 0; dx < dst_w; dx++) {
+            int sx = std::min((int) (((int64_t) dx * 2 + 1) * src_w / (2 * (int64_t) dst_w)), src_w - 1);
+            map.col0[dx] = map.col1[dx] = sx * channels;
+        }
+        for (int dy = 0; dy < dst_h; dy++) {
+            map.row0[dy] = map.row1[dy] =
+                    std::min((int) (((int64_t) dy * 2 + 1) * src_h / (2 * (int64_t) dst_h)), src_h - 1);
+        }
+        int step = dst_w > 1 ? (map.col0[1] - map.col0[0]) / channels : 1;
+        for (int dx = 1; dx < dst_w && step > 0; dx++) {
+            if (map.col0[dx] - map.col0[dx - 1] != step * channels) {
+                step = 0;
+            }
+        }
+        map.col_step = step;
+        return;
+    }
+
+    for (int dx = 0; dx < dst_w; dx++) {
+        int i0, i1, w;
+        scale_map_coord(dx, src_w, dst_w, IMAGE_HCOEF_BITS, i0, i1, w);
+        map.col0[dx] = i0 * channels;
+        map.col1[dx] = i1 * channels;
+        map.col_w[dx] = (int16_t) w;
+    }
+    for (int dy = 0; dy < dst_h; dy++) {
+        int i0, i1, w;
+        scale_map_coord(dy, src_h, dst_h, IMAGE_VCOEF_BITS, i0, i1, w);
+        map.row0[dy] = i0;
+        map.row1[dy] = i1;
+        map.row_w[dy] = (uint8_t) w;
+    }
+}
+
+void image_scale_rows(const image_scale_map_s &map, const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride,
+                      int row_begin, int row_end, image_kernel_impl_e impl) {
+    if (src == nullptr || dst == nullptr || map.dst_w <= 0 || (int) map.row0.size() != map.dst_h) {
+        return;
+    }
+    row_begin = std::max(row_begin, 0);
+    row_end = std::min(row_end, map.dst_h);
+    const bool simd = impl != IMAGE_KERNEL_IMPL_SCALAR;
+    const size_t row_bytes = (size_t) map.dst_w * map.channels;
+
+    if (map.filter == SCALE_FILTER_NEAREST) {
+        for (int dy = row_begin; dy < row_end; dy++) {
+            uint8_t *out = dst + (size_t) dy * dst_stride;
+            if (dy > row_begin && map.row0[dy] == map.row0[dy - 1]) {
+                memcpy(out, out - dst_stride, row_bytes);
+            } else {
+                nearest_row(map, src + (size_t) map.row0[dy] * src_stride, out, simd);
+            }
+        }
+        return;
+    }
+
+    // 只混合被列表引用到的源像素范围；行缓冲每个线程一份
+    static thread_local std::vector<uint16_t> vrow;
+    const int first = map.col0[0];
+    const int span = map.col1[map.dst_w - 1] + map.channels - first;
+    if ((int) vrow.size() < span) {
+        vrow.resize(span);
+    }
+    int last_y0 = -1, last_y1 = -1, last_w = -1;
+    for (int dy = row_begin; dy < row_end; dy++) {
+        const int y0 = map.row0[dy];
+        const int y1 = map.row1[dy];
+        const int wy = map.row_w[dy];
+        if (y0 != last_y0 || y1 != last_y1 || wy != last_w) {
+            blend_rows_u16(src + (size_t) y0 * src_stride + first, src + (size_t) y1 * src_stride + first, wy,
+                           vrow.data(), span, impl);
+            last_y0 = y0;
+            last_y1 = y1;
+            last_w = wy;
+        }
+        horizontal_row(map, vrow.data(), first, dst + (size_t) dy * dst_stride, simd);
+    }
+}
+
+// 一行写入bytes字节：按16字节的pattern（1/2/4字节像素重复而成）整块存储；
+// 每块都从16字节边界开始，尾部直接复制pattern的前几个字节
+static void fill_row(uint8_t *dst, int bytes, const uint8_t *pattern, bool simd) {
+    int i = 0;
+    if (simd) {
+#if defined(IMAGE_KERNELS_NEON)
+        const uint8x16_t v = vld1q_u8(pattern);
+        for (; i + 16 <= bytes; i += 16) {
+            vst1q_u8(dst + i, v);
+        }
+#elif defined(IMAGE_KERNELS_SSE2)
+        const __m128i v = _mm_loadu_si128((const __m128i *) pattern);
+        for (; i + 16 <= bytes; i += 16) {
+            _mm_storeu_si128((__m128i *) (dst + i), v);
+        }
+#endif
+    }
+    for (; i < bytes; i += 16) {
+        memcpy(dst + i, pattern, std::min(16, bytes - i));
+    }
+}
+
+void image_fill_rect(uint8_t *dst, int dst_stride, int width, int height, const uint8_t *pixel, int channels,
+                     image_kernel_impl_e impl) {
+    if (dst == nullptr || pixel == nullptr || width <= 0 || height <= 0 ||
+        (channels != 1 && channels != 2 && channels != 4)) {
+        return;
+    }
+    if (channels == 1) {
+        for (int y = 0; y < height; y++) {
+            memset(dst + (size_t) y * dst_stride, pixel[0], width);
+        }
+        return;
+    }
+    uint8_t pattern[16];
+    for (int i = 0; i < 16; i += channels) {
+        memcpy(pattern + i, pixel, channels);
+    }
+    const bool simd = impl != IMAGE_KERNEL_IMPL_SCALAR;
+    for (int y = 0; y < height; y++) {
+        fill_row(dst + (size_t) y * dst_stride, width * channels, pattern, simd);
+    }
+}
+
+void rgba_fill_rect(uint8_t *dst, int dst_stride, int width, int height, uint32_t color, image_kernel_impl_e impl) {
+    uint8_t c[4];
+    memcpy(c, &color, 4);
+    image_fill_rect(dst, dst_stride, width, height, c, 4, impl);
+}
+
+void image_scale(const uint8_t *src, int src_w, int src_h, int src_stride, uint8_t *dst, int dst_w, int dst_h,
+                 int dst_stride, int channels, scale_filter_e filter, image_kernel_impl_e impl) {
+    static thread_local image_scale_map_s map = image_scale_map_s();
+    image_scale_map_init(map, src_w, src_h, dst_w, dst_h, channels, filter);
+    image_scale_rows(map, src, src_stride, dst, dst_stride, 0, dst_h, impl);
+}
+
+// ---------------------------------------------------------------------------
+// 混合：16位中间值不超过 255 * 255，加128后仍在uint16范围内
+
+#if defined(IMAGE_KERNELS_NEON)
+// (x + 128) * 257 >> 16 == (t + (t >> 8)) >> 8，t = x + 128；vaddhn取和的高8位
+static inline uint8x8_t div255_u16(uint16x8_t x) {
+    uint16x8_t t = vaddq_u16(x, vdupq_n_u16(128));
+    return vaddhn_u16(t, vshrq_n_u16(t, 8));
+}
+#elif defined(IMAGE_KERNELS_SSE2)
+static inline __m128i div255_epu16(__m128i x) {
+    return _mm_mulhi_epu16(_mm_add_epi16(x, _mm_set1_epi16(128)), _mm_set1_epi16(257));
+}
+#endif
+
+static void mix_row(const uint8_t *a, const uint8_t *b, uint8_t *dst, int n, uint8_t alpha, bool simd) {
+    const uint32_t wa = alpha;
+    const uint32_t wb = 255 - alpha;
+    int i = 0;
+    if (simd) {
+#if defined(IMAGE_KERNELS_NEON)
+        const uint8x8_t va = vdup_n_u8((uint8_t) wa);
+        const uint8x8_t vb = vdup_n_u8((uint8_t) wb);
+        for (; i + 16 <= n; i += 16) {
+            uint8x16_t x = vld1q_u8(a + i);
+            uint8x16_t y = vld1q_u8(b + i);
+            uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(x), va), vget_low_u8(y), vb);
+            uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(x), va), vget_high_u8(y), vb);
+            vst1q_u8(dst + i, vcombine_u8(div255_u16(lo), div255_u16(hi)));
+        }
+#elif defined(IMAGE_KERNELS_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i va = _mm_set1_epi16((short) wa);
+        const __m128i vb = _mm_set1_epi16((short) wb);
+        for (; i + 16 <= n; i += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i *) (a + i));
+            __m128i y = _mm_loadu_si128((const __m128i *) (b + i));
+            __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(x, zero), va),
+                                       _mm_mullo_epi16(_mm_unpacklo_epi8(y, zero), vb));
+            __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(x, zero), va),
+                                       _mm_mullo_epi16(_mm_unpackhi_epi8(y, zero), vb));
+            _mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(div255_epu16(lo), div255_epu16(hi)));
+        }
+#endif
+    }
+    for (; i < n; i++) {
+        dst[i] = mul_div255(a[i] * wa + b[i] * wb);
+    }
+}
+
+static void over_row(const uint8_t *src, uint8_t *dst, int width, uint8_t opacity, bool simd) {
+    int x = 0;
+    if (simd) {
+#if defined(IMAGE_KERNELS_NEON)
+        // 按通道解交错，每次8个像素
+        const uint8x8_t o = vdup_n_u8(opacity);
+        for (; x + 8 <= width; x += 8) {
+            uint8x8x4_t s = vld4_u8(src + x * 4);
+            uint8x8x4_t d = vld4_u8(dst + x * 4);
+            for (int c = 0; c < 4; c++) {
+                s.val[c] = div255_u16(vmull_u8(s.val[c], o));
+            }
+            const uint8x8_t inv = vmvn_u8(s.val[3]);
+            for (int c = 0; c < 4; c++) {
+                d.val[c] = vqadd_u8(s.val[c], div255_u16(vmull_u8(d.val[c], inv)));
+            }
+            vst4_u8(dst + x * 4, d);
+        }
+#elif defined(IMAGE_KERNELS_SSE2)
+        // 每次4个像素，展开成两组16位；alpha在每个像素的第4个16位元素，用shuffle广播
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i o = _mm_set1_epi16(opacity);
+        const __m128i full = _mm_set1_epi16(255);
+        for (; x + 4 <= width; x += 4) {
+            __m128i s = _mm_loadu_si128((const __m128i *) (src + x * 4));
+            __m128i d = _mm_loadu_si128((const __m128i *) (dst + x * 4));
+            __m128i s_lo = div255_epu16(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), o));
+            __m128i s_hi = div255_epu16(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), o));
+            __m128i inv_lo = _mm_sub_epi16(full, _mm_shufflehi_epi16(_mm_shufflelo_epi16(s_lo, 0xFF), 0xFF));
+            __m128i inv_hi = _mm_sub_epi16(full, _mm_shufflehi_epi16(_mm_shufflelo_epi16(s_hi, 0xFF), 0xFF));
+            __m128i d_lo = div255_epu16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inv_lo));
+            __m128i d_hi = div255_epu16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inv_hi));
+            __m128i out = _mm_packus_epi16(_mm_add_epi16(s_lo, d_lo), _mm_add_epi16(s_hi, d_hi));
+            _mm_storeu_si128((__m128i *) (dst + x * 4), out);
+        }
+#endif
+    }
+    for (; x < width; x++) {
+        const uint8_t *s = src + x * 4;
+        uint8_t *d = dst + x * 4;
+        uint8_t p[4];
+        for (int c = 0; c < 4; c++) {
+            p[c] = mul_div255(s[c] * (uint32_t) opacity);
+        }
+        const uint32_t inv = 255 - p[3];
+        for (int c = 0; c < 4; c++) {
+            d[c] = (uint8_t) std::min<uint32_t>(p[c] + mul_div255(d[c] * inv), 255);
+        }
+    }
+}
+
+// 颜色固定时每个字节只需 color[c] + dst * inv / 255
+static void blend_rect_row(uint8_t *dst, int n, const uint8_t color[4], uint8_t inv, bool simd) {
+    int i = 0;
+    if (simd) {
+#if defined(IMAGE_KERNELS_NEON)
+        uint32_t pattern;
+        memcpy(&pattern, color, 4);
+        const uint8x16_t c = vreinterpretq_u8_u32(vdupq_n_u32(pattern));
+        const uint8x8_t w = vdup_n_u8(inv);
+        for (; i + 16 <= n; i += 16) {
+            uint8x16_t d = vld1q_u8(dst + i);
+            uint8x16_t scaled = vcombine_u8(div255_u16(vmull_u8(vget_low_u8(d), w)),
+                                            div255_u16(vmull_u8(vget_high_u8(d), w)));
+            vst1q_u8(dst + i, vqaddq_u8(c, scaled));
+        }
+#elif defined(IMAGE_KERNELS_SSE2)
+        uint32_t pattern;
+        memcpy(&pattern, color, 4);
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i c = _mm_set1_epi32((int) pattern);
+        const __m128i w = _mm_set1_epi16(inv);
+        for (; i + 16 <= n; i += 16) {
+            __m128i d = _mm_loadu_si128((const __m128i *) (dst + i));
+            __m128i lo = div255_epu16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), w));
+            __m128i hi = div255_epu16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), w));
+            _mm_storeu_si128((__m128i *) (dst + i), _mm_adds_epu8(c, _mm_packus_epi16(lo, hi)));
+        }
+#endif
+    }
+    for (; i < n; i++) {
+        dst[i] = (uint8_t) std::min<uint32_t>(color[i & 3] + mul_div255(dst[i] * (uint32_t) inv), 255);
+    }
+}
+
+void rgba_mix(const uint8_t *a, int a_stride, const uint8_t *b, int b_stride, uint8_t *dst, int dst_stride, int width,
+              int height, uint8_t alpha, image_kernel_impl_e impl) {
+    if (a == nullptr || b == nullptr || dst == nullptr || width <= 0 || height <= 0) {
+        return;
+    }
+    const bool simd = impl != IMAGE_KERNEL_IMPL_SCALAR;
+    for (int y = 0; y < height; y++) {
+        mix_row(a + (size_t) y * a_stride, b + (size_t) y * b_stride, dst + (size_t) y * dst_stride, width * 4, alpha,
+                simd);
+    }
+}
+
+void rgba_blend_over(const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int width, int height,
+                     uint8_t opacity, image_kernel_impl_e impl) {
+    if (src == nullptr || dst == nullptr || width <= 0 || height <= 0) {
+        return;
+    }
+    const bool simd = impl != IMAGE_KERNEL_IMPL_SCALAR;
+    for (int y = 0; y < height; y++) {
+        over_row(src + (size_t) y * src_stride, dst + (size_t) y * dst_stride, width, opacity, simd);
+    }
+}
+
+void rgba_blend_rect(uint8_t *dst, int dst_stride, int width, int height, uint32_t color, image_kernel_impl_e impl) {
+    if (dst == nullptr || width <= 0 || height <= 0) {
+        return;
+    }
+    uint8_t c[4];
+    memcpy(c, &color, 4);
+    const bool simd = impl != IMAGE_KERNEL_IMPL_SCALAR;
+    for (int y = 0; y < height; y++) {
+        blend_rect_row(dst + (size_t) y * dst_stride, width * 4, c, (uint8_t) (255 - c[3]), simd);
+    }
+}
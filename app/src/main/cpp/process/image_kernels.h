@@ -0,0 +1,94 @@
+// 图像内核：按预计算映射表缩放（定点可分离双线性 / 最近邻，1~4通道）、预乘alpha混合、矩形填充（1/2/4通道），
+// 均按stride寻址，供合成器按行段并行调用，也是FrameCompositionUtils、GPUAcceleratedRenderer的CPU路径
+// 和检测框绘制共用的实现；定点插值的公共部分（坐标映射、垂直混合）同时供letterbox内核使用
+
+#ifndef RK3588_DEMO_IMAGE_KERNELS_H
+#define RK3588_DEMO_IMAGE_KERNELS_H
+
+#include <stdint.h>
+#include <vector>
+
+// 双线性插值的定点权重：垂直7位（8位乘法即可完成SIMD混合）、水平11位
+#define IMAGE_VCOEF_BITS 7
+#define IMAGE_HCOEF_BITS 11
+
+typedef enum _scale_filter {
+    SCALE_FILTER_NEAREST = 0,
+    SCALE_FILTER_BILINEAR = 1,
+} scale_filter_e;
+
+typedef enum _image_kernel_impl {
+    IMAGE_KERNEL_IMPL_AUTO = 0,   // 编译目标支持时使用SIMD（NEON / AVX2 / SSE2）
+    IMAGE_KERNEL_IMPL_SCALAR = 1, // 标量参考实现，与SIMD结果逐位一致
+} image_kernel_impl_e;
+
+// src_w x src_h -> dst_w x dst_h 的行、列映射表，尺寸不变时可反复使用（每路视口一份）
+typedef struct {
+    int src_w;
+    int src_h;
+    int dst_w;
+    int dst_h;
+    int channels;               // 每像素字节数，1~4；4通道有SIMD路径
+    scale_filter_e filter;
+    std::vector<int32_t> col0;  // 每个目标列左侧源像素的字节偏移（x * channels）
+    std::vector<int32_t> col1;  // 右侧源像素的字节偏移，最近邻时与col0相同
+    std::vector<int16_t> col_w; // 右侧像素的11位权重
+    int col_step;               // 最近邻且列间距恒定时为相邻列的源像素间距，否则为0
+    std::vector<int32_t> row0;  // 每个目标行上方的源行号
+    std::vector<int32_t> row1;
+    std::vector<uint8_t> row_w; // 下方源行的7位权重
+} image_scale_map_s;
+
+// 当前编译使用的SIMD指令集名称："neon" / "avx2" / "sse2" / "scalar"
+const char *image_kernels_simd_name();
+
+// 目标坐标d（0..dst-1）映射到源坐标：像素中心对齐，返回左侧整数坐标和右侧权重（coef_bits位定点）
+void scale_map_coord(int d, int src, int dst, int coef_bits, int &i0, int &i1, int &w);
+
+// 垂直插值：out[i] = s0[i] * (128 - w) + s1[i] * w（w为7位权重），结果不超过uint16
+void blend_rows_u16(const uint8_t *s0, const uint8_t *s1, int w, uint16_t *out, int n,
+                    image_kernel_impl_e impl = IMAGE_KERNEL_IMPL_AUTO);
+
+// 8位乘积除以255并四舍五入：(x + 128) * 257 >> 16，对0..255*255的x与round(x / 255.0)完全一致
+static inline uint8_t mul_div255(uint32_t x) {
+    return (uint8_t) (((x + 128) * 257) >> 16);
+}
+
+// 计算映射表；尺寸、通道数和滤波方式与现有映射表相同时直接返回
+void image_scale_map_init(image_scale_map_s &map, int src_w, int src_h, int dst_w, int dst_h, int channels,
+                          scale_filter_e filter);
+
+// 按映射表缩放，只写目标行[row_begin, row_end)，不同行段可在不同线程并行处理
+// src、dst按各自stride（每行字节数）寻址，dst指向目标区域左上角
+void image_scale_rows(const image_scale_map_s &map, const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride,
+                      int row_begin, int row_end, image_kernel_impl_e impl = IMAGE_KERNEL_IMPL_AUTO);
+
+// 整幅缩放：映射表按线程缓存，尺寸不变的连续调用不再重新计算
+void image_scale(const uint8_t *src, int src_w, int src_h, int src_stride, uint8_t *dst, int dst_w, int dst_h,
+                 int dst_stride, int channels, scale_filter_e filter, image_kernel_impl_e impl = IMAGE_KERNEL_IMPL_AUTO);
+
+// 交叉淡化：dst = (a * alpha + b * (255 - alpha)) / 255，逐字节（含alpha通道）计算，
+// 输入为预乘或不透明像素时结果仍是合法的预乘像素；dst可以与a或b相同
+void rgba_mix(const uint8_t *a, int a_stride, const uint8_t *b, int b_stride, uint8_t *dst, int dst_stride, int width,
+              int height, uint8_t alpha, image_kernel_impl_e impl = IMAGE_KERNEL_IMPL_AUTO);
+
+// 预乘alpha的source-over：s = src * opacity / 255，dst = s + dst * (255 - s.a) / 255（饱和到255）
+// src不透明时等同于rgba_mix(src, dst, dst, opacity)
+void rgba_blend_over(const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int width, int height,
+                     uint8_t opacity, image_kernel_impl_e impl = IMAGE_KERNEL_IMPL_AUTO);
+
+// 用预乘颜色color（按uint32写入内存的字节序，同rgba_fill_rect）做source-over覆盖width x height区域，
+// 例如0x80000000把区域调暗一半
+void rgba_blend_rect(uint8_t *dst, int dst_stride, int width, int height, uint32_t color,
+                     image_kernel_impl_e impl = IMAGE_KERNEL_IMPL_AUTO);
+
+// 用pixel（channels字节，1/2/4通道）填充width x height区域，按16字节整块存储；
+// 叠加绘制的横向span、NV12的Y/UV平面填充都走这里
+void image_fill_rect(uint8_t *dst, int dst_stride, int width, int height, const uint8_t *pixel, int channels,
+                     image_kernel_impl_e impl = IMAGE_KERNEL_IMPL_AUTO);
+
+// 用color填充width x height区域；color按uint32直接写入内存（小端下0xAABBGGRR即RGBA字节序）
+void rgba_fill_rect(uint8_t *dst, int dst_stride, int width, int height, uint32_t color,
+                    image_kernel_impl_e impl = IMAGE_KERNEL_IMPL_AUTO);
+
+#endif // RK3588_DEMO_IMAGE_KERNELS_H
@@ -0,0 +1,282 @@
+// 单次遍历的letterbox预处理
+//
+// 每个输出行分三步，全部在行缓冲里完成，不产生中间图像：
+//  1. 垂直插值：两条源行按wy混合成16位行（SIMD，连续内存）
+//  2. 水平插值：按预先算好的列表取两点混合，得到RGB（或NV12的Y/U/V行）
+//  3. NV12时把Y/U/V行转换为RGB（SIMD）
+// 垂直权重7位（8位乘法即可完成SIMD混合）、水平权重11位定点，SIMD与标量实现逐位一致；
+// 采样点落在整数或半像素上时（如1/2、1/3缩放）与OpenCV INTER_LINEAR结果相同
+
+#include "letterbox.h"
+#include "image_kernels.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "logging.h"
+#include "rga.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define LETTERBOX_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define LETTERBOX_SSE2 1
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LETTERBOX_AVX2 1
+#endif
+#endif
+
+static const int g_vcoef_one = 1 << IMAGE_VCOEF_BITS;
+static const int g_hcoef_one = 1 << IMAGE_HCOEF_BITS;
+// 两次插值后的舍入与移位
+static const int g_round_shift = IMAGE_VCOEF_BITS + IMAGE_HCOEF_BITS;
+static const int g_round_bias = 1 << (g_round_shift - 1);
+
+static inline uint8_t clip_u8(int v) {
+    return (uint8_t) (v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// ---------------------------------------------------------------------------
+// 1. 垂直插值与坐标映射见image_kernels（blend_rows_u16 / scale_map_coord），与合成器共用
+//    垂直混合结果最大 255 * 128，用uint16保存；水平插值再乘以11位权重，最大 255 * 128 * 2048，int32不会溢出
+
+// ---------------------------------------------------------------------------
+// 3. NV12颜色转换：BT.601 limited range，与RGA的YCbCr_420_SP -> RGB转换一致
+
+static inline void yuv_to_rgb(int y, int u, int v, uint8_t *rgb) {
+    int c = 298 * (y - 16);
+    int d = u - 128;
+    int e = v - 128;
+    rgb[0] = clip_u8((c + 409 * e + 128) >> 8);
+    rgb[1] = clip_u8((c - 100 * d - 208 * e + 128) >> 8);
+    rgb[2] = clip_u8((c + 516 * d + 128) >> 8);
+}
+
+static void yuv_row_to_rgb(const uint8_t *ys, const uint8_t *us, const uint8_t *vs, uint8_t *rgb, int n, bool simd) {
+    int i = 0;
+    if (simd) {
+#if defined(LETTERBOX_NEON)
+        const int16x8_t k16 = vdupq_n_s16(16);
+        const int16x8_t k128 = vdupq_n_s16(128);
+        for (; i + 8 <= n; i += 8) {
+            int16x8_t c = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(ys + i))), k16);
+            int16x8_t d = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(us + i))), k128);
+            int16x8_t e = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(vs + i))), k128);
+            int32x4_t c_lo = vmull_n_s16(vget_low_s16(c), 298);
+            int32x4_t c_hi = vmull_n_s16(vget_high_s16(c), 298);
+            c_lo = vaddq_s32(c_lo, vdupq_n_s32(128));
+            c_hi = vaddq_s32(c_hi, vdupq_n_s32(128));
+            int32x4_t r_lo = vmlal_n_s16(c_lo, vget_low_s16(e), 409);
+            int32x4_t r_hi = vmlal_n_s16(c_hi, vget_high_s16(e), 409);
+            int32x4_t g_lo = vmlal_n_s16(vmlal_n_s16(c_lo, vget_low_s16(d), -100), vget_low_s16(e), -208);
+            int32x4_t g_hi = vmlal_n_s16(vmlal_n_s16(c_hi, vget_high_s16(d), -100), vget_high_s16(e), -208);
+            int32x4_t b_lo = vmlal_n_s16(c_lo, vget_low_s16(d), 516);
+            int32x4_t b_hi = vmlal_n_s16(c_hi, vget_high_s16(d), 516);
+            uint8x8x3_t out;
+            out.val[0] = vqmovun_s16(vcombine_s16(vshrn_n_s32(r_lo, 8), vshrn_n_s32(r_hi, 8)));
+            out.val[1] = vqmovun_s16(vcombine_s16(vshrn_n_s32(g_lo, 8), vshrn_n_s32(g_hi, 8)));
+            out.val[2] = vqmovun_s16(vcombine_s16(vshrn_n_s32(b_lo, 8), vshrn_n_s32(b_hi, 8)));
+            vst3_u8(rgb + i * 3, out);
+        }
+#elif defined(LETTERBOX_SSE2)
+        // madd按(a,b)对计算 a*ka + b*kb，常数1配合系数128用于加上舍入项
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i k16 = _mm_set1_epi16(16);
+        const __m128i k128 = _mm_set1_epi16(128);
+        const __m128i one = _mm_set1_epi16(1);
+        const __m128i kr = _mm_setr_epi16(298, 409, 298, 409, 298, 409, 298, 409);
+        const __m128i kg0 = _mm_setr_epi16(298, -100, 298, -100, 298, -100, 298, -100);
+        const __m128i kg1 = _mm_setr_epi16(-208, 128, -208, 128, -208, 128, -208, 128);
+        const __m128i kb = _mm_setr_epi16(298, 516, 298, 516, 298, 516, 298, 516);
+        const __m128i bias = _mm_set1_epi32(128);
+        uint8_t r[8], g[8], b[8];
+        for (; i + 8 <= n; i += 8) {
+            __m128i c = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (ys + i)), zero), k16);
+            __m128i d = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (us + i)), zero), k128);
+            __m128i e = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (vs + i)), zero), k128);
+            __m128i ce_lo = _mm_unpacklo_epi16(c, e), ce_hi = _mm_unpackhi_epi16(c, e);
+            __m128i cd_lo = _mm_unpacklo_epi16(c, d), cd_hi = _mm_unpackhi_epi16(c, d);
+            __m128i e1_lo = _mm_unpacklo_epi16(e, one), e1_hi = _mm_unpackhi_epi16(e, one);
+            __m128i r32_lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ce_lo, kr), bias), 8);
+            __m128i r32_hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ce_hi, kr), bias), 8);
+            __m128i g32_lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cd_lo, kg0), _mm_madd_epi16(e1_lo, kg1)), 8);
+            __m128i g32_hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cd_hi, kg0), _mm_madd_epi16(e1_hi, kg1)), 8);
+            __m128i b32_lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cd_lo, kb), bias), 8);
+            __m128i b32_hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cd_hi, kb), bias), 8);
+            __m128i r8 = _mm_packus_epi16(_mm_packs_epi32(r32_lo, r32_hi), zero);
+            __m128i g8 = _mm_packus_epi16(_mm_packs_epi32(g32_lo, g32_hi), zero);
+            __m128i b8 = _mm_packus_epi16(_mm_packs_epi32(b32_lo, b32_hi), zero);
+            _mm_storel_epi64((__m128i *) r, r8);
+            _mm_storel_epi64((__m128i *) g, g8);
+            _mm_storel_epi64((__m128i *) b, b8);
+            uint8_t *dst = rgb + i * 3;
+            for (int k = 0; k < 8; k++, dst += 3) {
+                dst[0] = r[k];
+                dst[1] = g[k];
+                dst[2] = b[k];
+            }
+        }
+#endif
+    }
+    for (; i < n; i++) {
+        yuv_to_rgb(ys[i], us[i], vs[i], rgb + i * 3);
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+const char *letterbox_simd_name() {
+#if defined(LETTERBOX_NEON)
+    return "neon";
+#elif defined(LETTERBOX_AVX2)
+    return "avx2";
+#elif defined(LETTERBOX_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+letterbox_geometry_s compute_letterbox_geometry(int src_w, int src_h, int dst_w, int dst_h) {
+    letterbox_geometry_s geometry;
+    memset(&geometry, 0, sizeof(geometry));
+    geometry.src_w = src_w;
+    geometry.src_h = src_h;
+    geometry.dst_w = dst_w;
+    geometry.dst_h = dst_h;
+    if (src_w <= 0 || src_h <= 0 || dst_w <= 0 || dst_h <= 0) {
+        return geometry;
+    }
+    geometry.scale = std::min((float) dst_w / src_w, (float) dst_h / src_h);
+    geometry.resized_w = std::min(dst_w, std::max(1, (int) (src_w * geometry.scale + 0.5f)));
+    geometry.resized_h = std::min(dst_h, std::max(1, (int) (src_h * geometry.scale + 0.5f)));
+    geometry.pad_left = (dst_w - geometry.resized_w) / 2;
+    geometry.pad_top = (dst_h - geometry.resized_h) / 2;
+    return geometry;
+}
+
+nn_error_e letterbox_into_tensor(const image_frame_s &src, const letterbox_geometry_s &geometry,
+                                 uint8_t pad_value, tensor_data_s &tensor, letterbox_impl_e impl) {
+    const int dst_w = geometry.dst_w;
+    const int dst_h = geometry.dst_h;
+    if (tensor.data == nullptr || tensor.attr.type != NN_TENSOR_UINT8 || tensor.attr.dims[3] != 3 ||
+        (int) tensor.attr.dims[1] != dst_h || (int) tensor.attr.dims[2] != dst_w ||
+        tensor.attr.size < (uint32_t) (dst_w * dst_h * 3)) {
+        NN_LOG_ERROR("letterbox: tensor does not match %dx%d RGB", dst_w, dst_h);
+        return NN_RKNN_INPUT_ATTR_ERROR;
+    }
+    if (src.data == nullptr || src.width != geometry.src_w || src.height != geometry.src_h ||
+        geometry.resized_w <= 0 || geometry.resized_h <= 0) {
+        NN_LOG_ERROR("letterbox: source %dx%d does not match geometry", src.width, src.height);
+        return NN_RKNN_INPUT_ATTR_ERROR;
+    }
+
+    // 源像素的字节数以及R、G、B在像素内的偏移
+    int bpp = 1;
+    int r_off = 0, g_off = 1, b_off = 2;
+    bool nv12 = false;
+    switch (src.format) {
+        case RK_FORMAT_YCbCr_420_SP:
+            nv12 = true;
+            break;
+        case RK_FORMAT_RGBA_8888:
+            bpp = 4;
+            break;
+        case RK_FORMAT_BGRA_8888:
+            bpp = 4;
+            r_off = 2;
+            b_off = 0;
+            break;
+        case RK_FORMAT_RGB_888:
+            bpp = 3;
+            break;
+        case RK_FORMAT_BGR_888:
+            bpp = 3;
+            r_off = 2;
+            b_off = 0;
+            break;
+        default:
+            NN_LOG_ERROR("letterbox: unsupported source format 0x%x", src.format);
+            return NN_IMAGE_FORMAT_UNSUPPORTED;
+    }
+
+    const bool simd = impl != LETTERBOX_IMPL_SCALAR;
+    const int resized_w = geometry.resized_w;
+    const int resized_h = geometry.resized_h;
+    const int pad_left = geometry.pad_left;
+    const int pad_top = geometry.pad_top;
+    const int row_bytes = dst_w * 3;
+    const int src_row_elems = src.width * bpp;
+    uint8_t *out = (uint8_t *) tensor.data;
+
+    // 上下填充行
+    memset(out, pad_value, (size_t) pad_top * row_bytes);
+    memset(out + (size_t) (pad_top + resized_h) * row_bytes, pad_value,
+           (size_t) (dst_h - pad_top - resized_h) * row_bytes);
+
+    // 每列的源偏移和权重只算一次
+    std::vector<int> x0(resized_w), x1(resized_w), wx(resized_w), cx(resized_w);
+    for (int dx = 0; dx < resized_w; dx++) {
+        int i0, i1;
+        scale_map_coord(dx, src.width, resized_w, IMAGE_HCOEF_BITS, i0, i1, wx[dx]);
+        x0[dx] = i0 * bpp;
+        x1[dx] = i1 * bpp;
+        // 色度取离采样点最近的2x2块
+        cx[dx] = ((wx[dx] >= g_hcoef_one / 2 ? i1 : i0) >> 1) * 2;
+    }
+    std::vector<uint16_t> vrow(src_row_elems);
+    std::vector<uint8_t> yuv(nv12 ? resized_w * 3 : 0);
+
+    const uint8_t *uv_plane = src.data + (size_t) src.stride * src.height_stride;
+    for (int dy = 0; dy < resized_h; dy++) {
+        int y0, y1, wy;
+        scale_map_coord(dy, src.height, resized_h, IMAGE_VCOEF_BITS, y0, y1, wy);
+        uint8_t *row = out + (size_t) (pad_top + dy) * row_bytes;
+        memset(row, pad_value, (size_t) pad_left * 3);
+        memset(row + (size_t) (pad_left + resized_w) * 3, pad_value, (size_t) (dst_w - pad_left - resized_w) * 3);
+        uint8_t *dst = row + (size_t) pad_left * 3;
+
+        blend_rows_u16(src.data + (size_t) y0 * src.stride, src.data + (size_t) y1 * src.stride, wy, vrow.data(),
+                       src_row_elems, simd ? IMAGE_KERNEL_IMPL_AUTO : IMAGE_KERNEL_IMPL_SCALAR);
+        const uint16_t *v = vrow.data();
+
+        if (nv12) {
+            uint8_t *ys = yuv.data();
+            uint8_t *us = ys + resized_w;
+            uint8_t *vs = us + resized_w;
+            const uint8_t *uv = uv_plane + (size_t) ((wy >= g_vcoef_one / 2 ? y1 : y0) >> 1) * src.stride;
+            for (int dx = 0; dx < resized_w; dx++) {
+                ys[dx] = (uint8_t) ((v[x0[dx]] * (g_hcoef_one - wx[dx]) + v[x1[dx]] * wx[dx] + g_round_bias)
+                        >> g_round_shift);
+                us[dx] = uv[cx[dx]];
+                vs[dx] = uv[cx[dx] + 1];
+            }
+            yuv_row_to_rgb(ys, us, vs, dst, resized_w, simd);
+        } else {
+            for (int dx = 0; dx < resized_w; dx++, dst += 3) {
+                const uint16_t *a = v + x0[dx];
+                const uint16_t *b = v + x1[dx];
+                const int w1 = wx[dx];
+                const int w0 = g_hcoef_one - w1;
+                dst[0] = (uint8_t) ((a[r_off] * w0 + b[r_off] * w1 + g_round_bias) >> g_round_shift);
+                dst[1] = (uint8_t) ((a[g_off] * w0 + b[g_off] * w1 + g_round_bias) >> g_round_shift);
+                dst[2] = (uint8_t) ((a[b_off] * w0 + b[b_off] * w1 + g_round_bias) >> g_round_shift);
+            }
+        }
+    }
+    return NN_SUCCESS;
+}
+
+void letterbox_unmap_box(const letterbox_geometry_s &geometry, float &left, float &top, float &right, float &bottom) {
+    if (geometry.scale <= 0.f) {
+        return;
+    }
+    left = std::min(std::max((left - geometry.pad_left) / geometry.scale, 0.f), (float) geometry.src_w);
+    right = std::min(std::max((right - geometry.pad_left) / geometry.scale, 0.f), (float) geometry.src_w);
+    top = std::min(std::max((top - geometry.pad_top) / geometry.scale, 0.f), (float) geometry.src_h);
+    bottom = std::min(std::max((bottom - geometry.pad_top) / geometry.scale, 0.f), (float) geometry.src_h);
+}
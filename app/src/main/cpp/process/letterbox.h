@@ -0,0 +1,39 @@
+// 单次遍历的letterbox预处理：缩放+填充+颜色转换直接写入模型输入张量
+
+#ifndef RK3588_DEMO_LETTERBOX_H
+#define RK3588_DEMO_LETTERBOX_H
+
+#include <stdint.h>
+#include "datatype.h"
+
+// 源图像描述，只引用数据不拷贝
+typedef struct {
+    const uint8_t *data; // NV12时为Y平面，UV平面位于 data + stride * height_stride
+    int width;           // 有效宽高
+    int height;
+    int stride;          // 每行字节数（NV12为Y平面每行字节数）
+    int height_stride;   // NV12的Y平面行数，打包RGB格式可填height
+    int format;          // RK_FORMAT_YCbCr_420_SP / RGBA_8888 / BGRA_8888 / RGB_888 / BGR_888
+} image_frame_s;
+
+typedef enum _letterbox_impl {
+    LETTERBOX_IMPL_AUTO = 0,   // 编译目标支持时使用SIMD（NEON / AVX2 / SSE2）
+    LETTERBOX_IMPL_SCALAR = 1, // 标量参考实现，与SIMD结果逐位一致
+} letterbox_impl_e;
+
+// 当前编译使用的SIMD指令集名称："neon" / "avx2" / "sse2" / "scalar"
+const char *letterbox_simd_name();
+
+// 计算src_w x src_h等比缩放到dst_w x dst_h并居中填充的几何参数
+letterbox_geometry_s compute_letterbox_geometry(int src_w, int src_h, int dst_w, int dst_h);
+
+// 按geometry将src双线性缩放、颜色转换为RGB并写入tensor（NHWC uint8，dims[1]=H，dims[2]=W）
+// 填充区域写pad_value，整个张量只写一遍，不产生中间图像；垂直7位、水平11位定点权重
+nn_error_e letterbox_into_tensor(const image_frame_s &src, const letterbox_geometry_s &geometry,
+                                 uint8_t pad_value, tensor_data_s &tensor,
+                                 letterbox_impl_e impl = LETTERBOX_IMPL_AUTO);
+
+// 模型坐标系下的框（左上、右下）映射回原图坐标，并裁剪到原图范围内
+void letterbox_unmap_box(const letterbox_geometry_s &geometry, float &left, float &top, float &right, float &bottom);
+
+#endif // RK3588_DEMO_LETTERBOX_H
@@ -0,0 +1,260 @@
+// 检测框非极大值抑制（NMS）
+
+#include "nms.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+nms_config_s nms_default_config() {
+    nms_config_s config;
+    config.enabled = true;
+    config.mode = NMS_MODE_HARD;
+    config.iou_threshold = 0.45f;
+    config.score_threshold = 0.05f;
+    config.sigma = 0.5f;
+    config.top_k = 1000;
+    config.max_output = 64;
+    config.class_agnostic = false;
+    return config;
+}
+
+// 与原后处理相同的像素坐标约定：宽高按 x2 - x1 + 1 计算
+// 计算桶内第i个框与[begin, end)各框的IoU，连续内存上的无分支循环，编译器可自动向量化
+static inline void iou_row(const nms_workspace_t *ws, int i, int begin, int end, float *out) {
+    const float ax1 = ws->x1[i], ay1 = ws->y1[i], ax2 = ws->x2[i], ay2 = ws->y2[i], aarea = ws->area[i];
+    const float *x1 = ws->x1.data(), *y1 = ws->y1.data(), *x2 = ws->x2.data(), *y2 = ws->y2.data();
+    const float *area = ws->area.data();
+    for (int j = begin; j < end; j++) {
+        float w = std::max(0.f, std::min(ax2, x2[j]) - std::max(ax1, x1[j]) + 1.f);
+        float h = std::max(0.f, std::min(ay2, y2[j]) - std::max(ay1, y1[j]) + 1.f);
+        float inter = w * h;
+        float uni = aarea + area[j] - inter;
+        out[j - begin] = uni <= 0.f ? 0.f : inter / uni;
+    }
+}
+
+static void keep_box(nms_workspace_t *ws, int pos, float score) {
+    ws->keep.push_back(ws->bucketed[pos]);
+    ws->keep_score.push_back(score);
+}
+
+// 贪心NMS：保留当前最高分框，抑制同桶内IoU超过阈值的后续框
+static void nms_hard(nms_workspace_t *ws, int begin, int end, float threshold, int max_keep, float *iou) {
+    uint8_t *removed = ws->removed.data();
+    int kept = 0;
+    for (int i = begin; i < end && kept < max_keep; i++) {
+        if (removed[i]) {
+            continue;
+        }
+        keep_box(ws, i, ws->score[i]);
+        kept++;
+        iou_row(ws, i, i + 1, end, iou);
+        for (int j = i + 1; j < end; j++) {
+            removed[j] |= (uint8_t) (iou[j - i - 1] > threshold);
+        }
+    }
+}
+
+// Fast-NMS：每个框与所有更高分框（不论是否已被抑制）的最大IoU，超过阈值即丢弃
+// 没有逐框的先后依赖，可能比贪心NMS多抑制一些框
+static void nms_fast(nms_workspace_t *ws, int begin, int end, float threshold, int max_keep, float *iou) {
+    float *iou_max = ws->iou_max.data();
+    std::fill(iou_max + begin, iou_max + end, 0.f);
+    for (int i = begin; i < end; i++) {
+        iou_row(ws, i, i + 1, end, iou);
+        for (int j = i + 1; j < end; j++) {
+            iou_max[j] = std::max(iou_max[j], iou[j - i - 1]);
+        }
+    }
+    int kept = 0;
+    for (int i = begin; i < end && kept < max_keep; i++) {
+        if (iou_max[i] <= threshold) {
+            keep_box(ws, i, ws->score[i]);
+            kept++;
+        }
+    }
+}
+
+// Matrix-NMS（SOLOv2，高斯核）：decay_j = min_i exp(-(IoU_ij^2 - comp_i^2) / sigma)，
+// comp_i为框i与更高分框的最大IoU；按分数顺序逐行处理时comp_i在处理第i行前已确定
+static void nms_matrix(nms_workspace_t *ws, int begin, int end, float sigma, float score_threshold, int max_keep,
+                       float *iou) {
+    float *iou_max = ws->iou_max.data();
+    float *decay = ws->decay.data();
+    std::fill(iou_max + begin, iou_max + end, 0.f);
+    std::fill(decay + begin, decay + end, 0.f);
+    for (int i = begin; i < end; i++) {
+        const float comp = iou_max[i] * iou_max[i];
+        iou_row(ws, i, i + 1, end, iou);
+        for (int j = i + 1; j < end; j++) {
+            float v = iou[j - i - 1];
+            iou_max[j] = std::max(iou_max[j], v);
+            decay[j] = std::max(decay[j], v * v - comp);
+        }
+    }
+    int kept = 0;
+    for (int i = begin; i < end && kept < max_keep; i++) {
+        float score = ws->score[i] * expf(-decay[i] / sigma);
+        if (score >= score_threshold) {
+            keep_box(ws, i, score);
+            kept++;
+        }
+    }
+}
+
+// Soft-NMS（高斯）：每次取剩余最高分框，其余框分数乘以exp(-IoU^2 / sigma)
+static void nms_soft(nms_workspace_t *ws, int begin, int end, float sigma, float score_threshold, int max_keep,
+                     float *iou) {
+    uint8_t *removed = ws->removed.data();
+    float *score = ws->decay.data(); // 借用decay保存衰减中的分数
+    for (int i = begin; i < end; i++) {
+        score[i] = ws->score[i];
+        removed[i] = score[i] < score_threshold;
+    }
+    for (int kept = 0; kept < max_keep; kept++) {
+        int best = -1;
+        for (int i = begin; i < end; i++) {
+            if (!removed[i] && (best < 0 || score[i] > score[best])) {
+                best = i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        keep_box(ws, best, score[best]);
+        removed[best] = 1;
+        iou_row(ws, best, begin, end, iou);
+        for (int j = begin; j < end; j++) {
+            if (!removed[j]) {
+                float v = iou[j - begin];
+                score[j] *= expf(-(v * v) / sigma);
+                removed[j] = score[j] < score_threshold;
+            }
+        }
+    }
+}
+
+int nms_run(const nms_config_s &config, const float *boxes, const float *scores, const int *class_ids, int count,
+            nms_workspace_t *ws) {
+    ws->keep.clear();
+    ws->keep_score.clear();
+    if (count <= 0) {
+        return 0;
+    }
+
+    // 1. 按分数降序排序（分数相同按下标），只保留前top_k个
+    std::vector<int> &order = ws->order;
+    order.resize(count);
+    for (int i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    auto higher = [scores](int a, int b) { return scores[a] > scores[b] || (scores[a] == scores[b] && a < b); };
+    int n = count;
+    if (config.top_k > 0 && count > config.top_k) {
+        n = config.top_k;
+        std::partial_sort(order.begin(), order.begin() + n, order.end(), higher);
+    } else {
+        std::sort(order.begin(), order.end(), higher);
+    }
+    const int max_keep = config.max_output > 0 ? config.max_output : n;
+
+    if (!config.enabled) {
+        for (int i = 0; i < n && i < max_keep; i++) {
+            ws->keep.push_back(order[i]);
+            ws->keep_score.push_back(scores[order[i]]);
+        }
+        return (int) ws->keep.size();
+    }
+
+    // 2. 按类别计数排序分桶，桶内保持分数降序
+    int num_buckets = 1;
+    if (!config.class_agnostic) {
+        for (int i = 0; i < n; i++) {
+            num_buckets = std::max(num_buckets, class_ids[order[i]] + 1);
+        }
+    }
+    ws->bucket_start.assign(num_buckets + 1, 0);
+    for (int i = 0; i < n; i++) {
+        ws->bucket_start[config.class_agnostic ? 1 : class_ids[order[i]] + 1]++;
+    }
+    for (int c = 0; c < num_buckets; c++) {
+        ws->bucket_start[c + 1] += ws->bucket_start[c];
+    }
+    ws->bucket_fill.assign(ws->bucket_start.begin(), ws->bucket_start.end() - 1);
+
+    ws->bucketed.resize(n);
+    ws->x1.resize(n);
+    ws->y1.resize(n);
+    ws->x2.resize(n);
+    ws->y2.resize(n);
+    ws->area.resize(n);
+    ws->score.resize(n);
+    ws->iou_max.resize(n);
+    ws->decay.resize(n);
+    ws->removed.assign(n, 0);
+    for (int i = 0; i < n; i++) {
+        int k = order[i];
+        int pos = ws->bucket_fill[config.class_agnostic ? 0 : class_ids[k]]++;
+        const float *b = boxes + k * 4;
+        ws->bucketed[pos] = k;
+        ws->x1[pos] = b[0];
+        ws->y1[pos] = b[1];
+        ws->x2[pos] = b[0] + b[2];
+        ws->y2[pos] = b[1] + b[3];
+        ws->area[pos] = (ws->x2[pos] - ws->x1[pos] + 1.f) * (ws->y2[pos] - ws->y1[pos] + 1.f);
+        ws->score[pos] = scores[k];
+    }
+
+    // 3. 各桶独立抑制
+    ws->iou.resize(n);
+    float *iou = ws->iou.data();
+    for (int c = 0; c < num_buckets; c++) {
+        int begin = ws->bucket_start[c], end = ws->bucket_start[c + 1];
+        if (begin == end) {
+            continue;
+        }
+        switch (config.mode) {
+            case NMS_MODE_SOFT:
+                nms_soft(ws, begin, end, config.sigma, config.score_threshold, max_keep, iou);
+                break;
+            case NMS_MODE_FAST:
+                nms_fast(ws, begin, end, config.iou_threshold, max_keep, iou);
+                break;
+            case NMS_MODE_MATRIX:
+                nms_matrix(ws, begin, end, config.sigma, config.score_threshold, max_keep, iou);
+                break;
+            case NMS_MODE_HARD:
+            default:
+                nms_hard(ws, begin, end, config.iou_threshold, max_keep, iou);
+                break;
+        }
+    }
+
+    // 4. 合并各桶结果，按最终分数降序，截取max_output
+    int kept = (int) ws->keep.size();
+    bool sorted = true;
+    for (int i = 1; i < kept && sorted; i++) {
+        sorted = ws->keep_score[i] < ws->keep_score[i - 1] ||
+                 (ws->keep_score[i] == ws->keep_score[i - 1] && ws->keep[i] > ws->keep[i - 1]);
+    }
+    if (!sorted) {
+        ws->merged.resize(kept);
+        for (int i = 0; i < kept; i++) {
+            ws->merged[i] = std::make_pair(ws->keep_score[i], ws->keep[i]);
+        }
+        std::sort(ws->merged.begin(), ws->merged.end(),
+                  [](const std::pair<float, int> &a, const std::pair<float, int> &b) {
+                      return a.first > b.first || (a.first == b.first && a.second < b.second);
+                  });
+        for (int i = 0; i < kept; i++) {
+            ws->keep_score[i] = ws->merged[i].first;
+            ws->keep[i] = ws->merged[i].second;
+        }
+    }
+    if (kept > max_keep) {
+        ws->keep.resize(max_keep);
+        ws->keep_score.resize(max_keep);
+    }
+    return (int) ws->keep.size();
+}
@@ -0,0 +1,57 @@
+// 检测框非极大值抑制（NMS）
+//
+// 候选框先按分数排序并截取前top_k个，再按类别分桶（同类框在桶内仍按分数降序），
+// 每个桶内的坐标以SoA形式连续存放，IoU计算为连续内存上的简单循环；
+// 各类别互不比较，总开销为各类别框数平方之和，而不是全部框数的平方
+
+#ifndef RK3588_DEMO_NMS_H
+#define RK3588_DEMO_NMS_H
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+typedef enum _nms_mode {
+    NMS_MODE_HARD = 0,   // 贪心NMS：与已保留框IoU超过阈值即丢弃
+    NMS_MODE_SOFT = 1,   // Soft-NMS：按exp(-IoU^2/sigma)衰减分数，低于score_threshold丢弃
+    NMS_MODE_FAST = 2,   // Fast-NMS：与任一更高分框IoU超过阈值即丢弃（被抑制的框仍参与抑制）
+    NMS_MODE_MATRIX = 3, // Matrix-NMS：按IoU矩阵一次性衰减全部分数（高斯核）
+} nms_mode_e;
+
+typedef struct _nms_config_s {
+    bool enabled;          // false时只排序、截取，不做抑制
+    nms_mode_e mode;
+    float iou_threshold;   // HARD / FAST 的抑制阈值
+    float score_threshold; // SOFT / MATRIX 衰减后的最低分数
+    float sigma;           // SOFT / MATRIX 的高斯核参数
+    int top_k;             // 参与NMS的最高分候选数，<=0表示不限制
+    int max_output;        // 最多输出框数，<=0表示不限制
+    bool class_agnostic;   // true时不同类别之间也互相抑制
+} nms_config_s;
+
+// 默认配置：HARD，IoU阈值0.45，top_k 1000，最多输出64个框
+nms_config_s nms_default_config();
+
+// 可复用缓冲区，由调用方（Yolov5实例）持有，容量只增不减
+typedef struct _nms_workspace_t {
+    std::vector<int> order;        // 排序后的候选下标
+    std::vector<int> bucket_start; // 每个类别桶在order中的起点
+    std::vector<int> bucket_fill;
+    std::vector<int> bucketed;     // 按类别分桶后的候选下标
+    // 按bucketed顺序排列的SoA坐标
+    std::vector<float> x1, y1, x2, y2, area, score;
+    std::vector<float> iou_max;    // FAST / MATRIX：与更高分框的最大IoU
+    std::vector<float> decay;      // MATRIX：max(IoU^2 - 补偿项^2)
+    std::vector<uint8_t> removed;
+    std::vector<float> iou;        // 一行IoU
+    std::vector<std::pair<float, int> > merged; // 合并各桶结果时排序用
+    std::vector<int> keep;         // 输出：保留的候选下标，按分数降序
+    std::vector<float> keep_score; // 输出：保留框的最终分数（SOFT / MATRIX 为衰减后分数）
+} nms_workspace_t;
+
+// boxes为count个 x, y, w, h（AoS，与解码输出相同），class_ids为非负类别号
+// 结果写入ws->keep / ws->keep_score，返回保留的框数
+int nms_run(const nms_config_s &config, const float *boxes, const float *scores, const int *class_ids, int count,
+            nms_workspace_t *ws);
+
+#endif // RK3588_DEMO_NMS_H
@@ -8,13 +8,13 @@
 
 
 // opencv 版本的 letterbox
-LetterBoxInfo letterbox(const cv::Mat &img, cv::Mat &img_letterbox, float wh_ratio)
+nn_error_e letterbox(const cv::Mat &img, cv::Mat &img_letterbox, float wh_ratio, LetterBoxInfo &info)
 {
     // img has to be 3 channels
     if (img.channels() != 3)
     {
         NN_LOG_ERROR("img has to be 3 channels");
-        exit(-1);
+        return NN_IMAGE_FORMAT_UNSUPPORTED;
     }
     float img_width = img.cols;
     float img_height = img.rows;
@@ -22,7 +22,6 @@ LetterBoxInfo letterbox(const cv::Mat &img, cv::Mat &img_letterbox, float wh_rat
     int letterbox_width = 0;
     int letterbox_height = 0;
 
-    LetterBoxInfo info;
     int padding_hor = 0;
     int padding_ver = 0;
 
@@ -47,17 +46,17 @@ LetterBoxInfo letterbox(const cv::Mat &img, cv::Mat &img_letterbox, float wh_rat
     }
     // 使用cv::copyMakeBorder函数进行填充边界
     cv::copyMakeBorder(img, img_letterbox, padding_ver, padding_ver, padding_hor, padding_hor, cv::BORDER_CONSTANT, cv::Scalar(0, 0, 0));
-    return info;
+    return NN_SUCCESS;
 }
 
 // opencv resize
-void cvimg2tensor(const cv::Mat &img, uint32_t width, uint32_t height, tensor_data_s &tensor)
+nn_error_e cvimg2tensor(const cv::Mat &img, uint32_t width, uint32_t height, tensor_data_s &tensor)
 {
     // img has to be 3 channels
     if (img.channels() != 3)
     {
         NN_LOG_ERROR("img has to be 3 channels");
-        exit(-1);
+        return NN_IMAGE_FORMAT_UNSUPPORTED;
     }
     // BGR to RGB
     cv::Mat img_rgb;
@@ -68,16 +67,17 @@ void cvimg2tensor(const cv::Mat &img, uint32_t width, uint32_t height, tensor_da
     cv::resize(img_rgb, img_resized, cv::Size(width, height), 0, 0, cv::INTER_LINEAR);
     // BGR to RGB
     memcpy(tensor.data, img_resized.data, tensor.attr.size);
+    return NN_SUCCESS;
 }
 
 // rga 版本的 resize
-void cvimg2tensor_rga(const cv::Mat &img, uint32_t width, uint32_t height, tensor_data_s &tensor)
+nn_error_e cvimg2tensor_rga(const cv::Mat &img, uint32_t width, uint32_t height, tensor_data_s &tensor)
 {
     // img has to be 3 channels
     if (img.channels() != 3)
     {
         NN_LOG_ERROR("img has to be 3 channels");
-        exit(-1);
+        return NN_IMAGE_FORMAT_UNSUPPORTED;
     }
 
     cv::Mat img_rgb;
@@ -93,19 +93,20 @@ void cvimg2tensor_rga(const cv::Mat &img, uint32_t width, uint32_t height, tenso
     if (IM_STATUS_NOERROR != ret)
     {
         NN_LOG_ERROR("%d, check error! %s", __LINE__, imStrError((IM_STATUS)ret));
-        exit(-1);
+        return NN_RKNN_INPUT_ATTR_ERROR;
     }
     imresize(src, dst);
+    return NN_SUCCESS;
 }
 
 // rga 版本的 letterbox
-LetterBoxInfo letterbox_rga(const cv::Mat &img, cv::Mat &img_letterbox, float wh_ratio)
+nn_error_e letterbox_rga(const cv::Mat &img, cv::Mat &img_letterbox, float wh_ratio, LetterBoxInfo &info)
 {
     // img has to be 3 channels
     if (img.channels() != 3)
     {
         NN_LOG_ERROR("img has to be 3 channels");
-        exit(-1);
+        return NN_IMAGE_FORMAT_UNSUPPORTED;
     }
     float img_width = img.cols;
     float img_height = img.rows;
@@ -113,7 +114,6 @@ LetterBoxInfo letterbox_rga(const cv::Mat &img, cv::Mat &img_letterbox, float wh
     int letterbox_width = 0;
     int letterbox_height = 0;
 
-    LetterBoxInfo info;
     int padding_hor = 0;
     int padding_ver = 0;
 
@@ -151,10 +151,10 @@ LetterBoxInfo letterbox_rga(const cv::Mat &img, cv::Mat &img_letterbox, float wh
     if (IM_STATUS_NOERROR != ret)
     {
         NN_LOG_ERROR("%d, check error! %s", __LINE__, imStrError((IM_STATUS)ret));
-        exit(-1);
+        return NN_RKNN_INPUT_ATTR_ERROR;
     }
 
     immakeBorder(src, dst, padding_ver, padding_ver, padding_hor, padding_hor, 0, 0, 0);
 
-    return info;
+    return NN_SUCCESS;
 }
\ No newline at end of file
@@ -13,9 +13,10 @@
 //    int pad;
 //};
 
-LetterBoxInfo letterbox(const cv::Mat &img, cv::Mat &img_letterbox, float wh_ratio);
-LetterBoxInfo letterbox_rga(const cv::Mat& img, cv::Mat& img_letterbox, float wh_ratio);
-void cvimg2tensor(const cv::Mat &img, uint32_t width, uint32_t height, tensor_data_s &tensor);
-void cvimg2tensor_rga(const cv::Mat &img, uint32_t width, uint32_t height, tensor_data_s &tensor);
+// OpenCV / RGA 多步实现，作为letterbox_into_tensor的对照，输入须为3通道BGR
+nn_error_e letterbox(const cv::Mat &img, cv::Mat &img_letterbox, float wh_ratio, LetterBoxInfo &info);
+nn_error_e letterbox_rga(const cv::Mat &img, cv::Mat &img_letterbox, float wh_ratio, LetterBoxInfo &info);
+nn_error_e cvimg2tensor(const cv::Mat &img, uint32_t width, uint32_t height, tensor_data_s &tensor);
+nn_error_e cvimg2tensor_rga(const cv::Mat &img, uint32_t width, uint32_t height, tensor_data_s &tensor);
 
 #endif // RK3588_DEMO_PREPROCESS_H
@@ -21,14 +21,22 @@
 #include <string.h>
 #include <sys/time.h>
 
-#include <set>
 #include <vector>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define YOLOV5_DECODE_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define YOLOV5_DECODE_SSE2 1
+#endif
+
 namespace yolov5
 {
 
 #define LABEL_NALE_TXT_PATH "./model/coco_80_labels_list.txt"
 
-    static const char *labels[OBJ_CLASS_NUM] = {
+    static const char *coco_labels[OBJ_CLASS_NUM] = {
         "person", "bicycle", "car", "motorbike ", "aeroplane ", "bus ", "train", "truck ", "boat", "traffic light",
         "fire hydrant", "stop sign ", "parking meter", "bench", "bird", "cat", "dog ", "horse ", "sheep", "cow", "elephant",
         "bear", "zebra ", "giraffe", "backpack", "umbrella", "handbag", "tie", "suitcase", "frisbee", "skis", "snowboard", "sports ball", "kite",
@@ -37,6 +45,11 @@ namespace yolov5
         "pottedplant", "bed", "diningtable", "toilet ", "tvmonitor", "laptop	", "mouse	", "remote ", "keyboard ", "cell phone", "microwave ",
         "oven ", "toaster", "sink", "refrigerator ", "book", "clock", "vase", "scissors ", "teddy bear ", "hair drier", "toothbrush "};
 
+    const char *coco_label(int id)
+    {
+        return id >= 0 && id < OBJ_CLASS_NUM ? coco_labels[id] : "";
+    }
+
     const int anchor0[6] = {10, 13, 16, 30, 33, 23};
     const int anchor1[6] = {30, 61, 62, 45, 59, 119};
     const int anchor2[6] = {116, 90, 156, 198, 373, 326};
@@ -110,161 +123,203 @@ namespace yolov5
         return 0;
     }
 
-    static float
-    CalculateOverlap(float xmin0, float ymin0, float xmax0, float ymax0, float xmin1, float ymin1, float xmax1,
-                     float ymax1)
+    static float sigmoid(float x) { return 1.0 / (1.0 + expf(-x)); }
+
+    static float unsigmoid(float y) { return -1.0 * logf((1.0 / y) - 1.0); }
+
+    inline static int32_t __clip(float val, float min, float max)
     {
-        float w = fmax(0.f, fmin(xmax0, xmax1) - fmax(xmin0, xmin1) + 1.0);
-        float h = fmax(0.f, fmin(ymax0, ymax1) - fmax(ymin0, ymin1) + 1.0);
-        float i = w * h;
-        float u = (xmax0 - xmin0 + 1.0) * (ymax0 - ymin0 + 1.0) + (xmax1 - xmin1 + 1.0) * (ymax1 - ymin1 + 1.0) - i;
-        return u <= 0.f ? 0.f : (i / u);
+        float f = val <= min ? min : (val >= max ? max : val);
+        return f;
     }
 
-    static int
-    nms(int validCount, std::vector<float> &outputLocations, std::vector<int> classIds, std::vector<int> &order,
-        int filterId, float threshold)
+    static int8_t qnt_f32_to_affine(float f32, int32_t zp, float scale)
     {
-        for (int i = 0; i < validCount; ++i)
-        {
-            if (order[i] == -1 || classIds[i] != filterId)
-            {
-                continue;
-            }
-            int n = order[i];
-            for (int j = i + 1; j < validCount; ++j)
-            {
-                int m = order[j];
-                if (m == -1 || classIds[i] != filterId)
-                {
-                    continue;
-                }
-                float xmin0 = outputLocations[n * 4 + 0];
-                float ymin0 = outputLocations[n * 4 + 1];
-                float xmax0 = outputLocations[n * 4 + 0] + outputLocations[n * 4 + 2];
-                float ymax0 = outputLocations[n * 4 + 1] + outputLocations[n * 4 + 3];
-
-                float xmin1 = outputLocations[m * 4 + 0];
-                float ymin1 = outputLocations[m * 4 + 1];
-                float xmax1 = outputLocations[m * 4 + 0] + outputLocations[m * 4 + 2];
-                float ymax1 = outputLocations[m * 4 + 1] + outputLocations[m * 4 + 3];
+        float dst_val = (f32 / scale) + zp;
+        int8_t res = (int8_t)__clip(dst_val, -128, 127);
+        return res;
+    }
 
-                float iou = CalculateOverlap(xmin0, ymin0, xmax0, ymax0, xmin1, ymin1, xmax1, ymax1);
+    static float deqnt_affine_to_f32(int8_t qnt, int32_t zp, float scale) { return ((float)qnt - (float)zp) * scale; }
 
-                if (iou > threshold)
-                {
-                    order[j] = -1;
-                }
+    // 一张查找表覆盖全部256个int8取值，每项与逐个调用sigmoid(deqnt_affine_to_f32())结果相同
+    static const float *sigmoid_lut(decode_workspace_t *ws, int branch, int32_t zp, float scale)
+    {
+        if (!ws->lut_valid[branch] || ws->lut_zp[branch] != zp || ws->lut_scale[branch] != scale)
+        {
+            for (int q = -128; q <= 127; q++)
+            {
+                ws->sigmoid_lut[branch][(uint8_t)q] = sigmoid(deqnt_affine_to_f32((int8_t)q, zp, scale));
             }
+            ws->lut_zp[branch] = zp;
+            ws->lut_scale[branch] = scale;
+            ws->lut_valid[branch] = true;
         }
-        return 0;
+        return ws->sigmoid_lut[branch];
     }
 
-    static int quick_sort_indice_inverse(std::vector<float> &input, int left, int right, std::vector<int> &indices)
+    // conf[0..15]中 >= thres 的位置，按位返回
+    static inline uint32_t threshold_mask16(const int8_t *conf, int8_t thres)
     {
-        float key;
-        int key_index;
-        int low = left;
-        int high = right;
-        if (left < right)
+#if defined(YOLOV5_DECODE_NEON)
+        static const uint8_t bits[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+        uint8x16_t ge = vcgeq_s8(vld1q_s8(conf), vdupq_n_s8(thres));
+        if (vmaxvq_u8(ge) == 0)
         {
-            key_index = indices[left];
-            key = input[left];
-            while (low < high)
-            {
-                while (low < high && input[high] <= key)
-                {
-                    high--;
-                }
-                input[low] = input[high];
-                indices[low] = indices[high];
-                while (low < high && input[low] >= key)
-                {
-                    low++;
-                }
-                input[high] = input[low];
-                indices[high] = indices[low];
-            }
-            input[low] = key;
-            indices[low] = key_index;
-            quick_sort_indice_inverse(input, left, low - 1, indices);
-            quick_sort_indice_inverse(input, low + 1, right, indices);
+            return 0;
         }
-        return low;
+        uint8x16_t b = vandq_u8(ge, vld1q_u8(bits));
+        return (uint32_t)vaddv_u8(vget_low_u8(b)) | ((uint32_t)vaddv_u8(vget_high_u8(b)) << 8);
+#elif defined(YOLOV5_DECODE_SSE2)
+        __m128i lt = _mm_cmpgt_epi8(_mm_set1_epi8(thres), _mm_loadu_si128((const __m128i *)conf));
+        return ~(uint32_t)_mm_movemask_epi8(lt) & 0xFFFFu;
+#else
+        uint32_t mask = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            mask |= (uint32_t)(conf[i] >= thres) << i;
+        }
+        return mask;
+#endif
     }
 
-    static float sigmoid(float x) { return 1.0 / (1.0 + expf(-x)); }
-
-    static float unsigmoid(float y) { return -1.0 * logf((1.0 / y) - 1.0); }
-
-    inline static int32_t __clip(float val, float min, float max)
+    // 连续16个网格的类别argmax：各类别平面在网格维上连续，逐平面取最大值
+    // 与逐网格比较相同，取值相等时保留较小的类别号
+    static inline void class_argmax16(const int8_t *cls, int grid_len, int num_classes, int8_t *best, uint8_t *best_id)
     {
-        float f = val <= min ? min : (val >= max ? max : val);
-        return f;
+#if defined(YOLOV5_DECODE_NEON)
+        int8x16_t vbest = vld1q_s8(cls);
+        uint8x16_t vid = vdupq_n_u8(0);
+        for (int k = 1; k < num_classes; k++)
+        {
+            int8x16_t p = vld1q_s8(cls + k * grid_len);
+            uint8x16_t gt = vcgtq_s8(p, vbest);
+            vbest = vmaxq_s8(vbest, p);
+            vid = vbslq_u8(gt, vdupq_n_u8((uint8_t)k), vid);
+        }
+        vst1q_s8(best, vbest);
+        vst1q_u8(best_id, vid);
+#elif defined(YOLOV5_DECODE_SSE2)
+        __m128i vbest = _mm_loadu_si128((const __m128i *)cls);
+        __m128i vid = _mm_setzero_si128();
+        for (int k = 1; k < num_classes; k++)
+        {
+            __m128i p = _mm_loadu_si128((const __m128i *)(cls + k * grid_len));
+            __m128i gt = _mm_cmpgt_epi8(p, vbest);
+            vbest = _mm_or_si128(_mm_and_si128(gt, p), _mm_andnot_si128(gt, vbest));
+            vid = _mm_or_si128(_mm_and_si128(gt, _mm_set1_epi8((char)k)), _mm_andnot_si128(gt, vid));
+        }
+        _mm_storeu_si128((__m128i *)best, vbest);
+        _mm_storeu_si128((__m128i *)best_id, vid);
+#else
+        (void)cls;
+        (void)grid_len;
+        (void)num_classes;
+        (void)best;
+        (void)best_id;
+#endif
     }
 
-    static int8_t qnt_f32_to_affine(float f32, int32_t zp, float scale)
+    // 单个网格的类别argmax（标量，按grid_len步长访问）
+    static inline int8_t class_argmax(const int8_t *cls, int grid_len, int num_classes, int *best_id)
     {
-        float dst_val = (f32 / scale) + zp;
-        int8_t res = (int8_t)__clip(dst_val, -128, 127);
-        return res;
+        int8_t maxClassProbs = cls[0];
+        int maxClassId = 0;
+        for (int k = 1; k < num_classes; ++k)
+        {
+            int8_t prob = cls[k * grid_len];
+            if (prob > maxClassProbs)
+            {
+                maxClassId = k;
+                maxClassProbs = prob;
+            }
+        }
+        *best_id = maxClassId;
+        return maxClassProbs;
     }
 
-    static float deqnt_affine_to_f32(int8_t qnt, int32_t zp, float scale) { return ((float)qnt - (float)zp) * scale; }
+    // 通过阈值的网格解码为框，写入ws的第ws->count项
+    static inline void emit_box(decode_workspace_t *ws, const int8_t *in_ptr, const float *lut, int grid_len,
+                                int i, int j, int stride, const int *anchor, int a, int8_t box_confidence,
+                                int8_t maxClassProbs, int maxClassId)
+    {
+        float box_x = lut[(uint8_t)in_ptr[0]] * 2.0 - 0.5;
+        float box_y = lut[(uint8_t)in_ptr[grid_len]] * 2.0 - 0.5;
+        float box_w = lut[(uint8_t)in_ptr[2 * grid_len]] * 2.0;
+        float box_h = lut[(uint8_t)in_ptr[3 * grid_len]] * 2.0;
+        box_x = (box_x + j) * (float)stride;
+        box_y = (box_y + i) * (float)stride;
+        box_w = box_w * box_w * (float)anchor[a * 2];
+        box_h = box_h * box_h * (float)anchor[a * 2 + 1];
+        box_x -= (box_w / 2.0);
+        box_y -= (box_h / 2.0);
+
+        int n = ws->count++;
+        ws->obj_probs[n] = lut[(uint8_t)maxClassProbs] * lut[(uint8_t)box_confidence];
+        ws->class_ids[n] = maxClassId;
+        ws->boxes[n * 4 + 0] = box_x;
+        ws->boxes[n * 4 + 1] = box_y;
+        ws->boxes[n * 4 + 2] = box_w;
+        ws->boxes[n * 4 + 3] = box_h;
+    }
 
-    static int process(int8_t *input, int *anchor, int grid_h, int grid_w, int height, int width, int stride,
-                       std::vector<float> &boxes, std::vector<float> &objProbs, std::vector<int> &classId,
-                       float threshold,
-                       int32_t zp, float scale)
+    static int process(int8_t *input, const int *anchor, int grid_h, int grid_w, int stride, int branch,
+                       int num_classes, float threshold, int32_t zp, float scale, bool simd, decode_workspace_t *ws)
     {
         int validCount = 0;
         int grid_len = grid_h * grid_w;
+        const int prop_box_size = 5 + num_classes;
         float thres = unsigmoid(threshold);
         int8_t thres_i8 = qnt_f32_to_affine(thres, zp, scale);
+        const float *lut = sigmoid_lut(ws, branch, zp, scale);
+#if !defined(YOLOV5_DECODE_NEON) && !defined(YOLOV5_DECODE_SSE2)
+        simd = false;
+#endif
+        // SIMD argmax以uint8保存类别号
+        simd = simd && num_classes <= 256;
+        int8_t best[16];
+        uint8_t best_id[16];
         for (int a = 0; a < 3; a++)
         {
-            for (int i = 0; i < grid_h; i++)
+            const int8_t *conf = input + (prop_box_size * a + 4) * grid_len;
+            const int8_t *cls = input + (prop_box_size * a + 5) * grid_len;
+            int8_t *box = input + (prop_box_size * a) * grid_len;
+            int cell = 0;
+            // 每次16个网格：先整块比较objectness，没有命中的块直接跳过；
+            // 命中时16个网格一起做类别argmax，连续读取各类别平面
+            for (; simd && cell + 16 <= grid_len; cell += 16)
+            {
+                uint32_t mask = threshold_mask16(conf + cell, thres_i8);
+                if (mask == 0)
+                {
+                    continue;
+                }
+                class_argmax16(cls + cell, grid_len, num_classes, best, best_id);
+                while (mask)
+                {
+                    int bit = __builtin_ctz(mask);
+                    mask &= mask - 1;
+                    if (best[bit] > thres_i8)
+                    {
+                        int c = cell + bit;
+                        emit_box(ws, box + c, lut, grid_len, c / grid_w, c % grid_w, stride, anchor, a, conf[c],
+                                 best[bit], best_id[bit]);
+                        validCount++;
+                    }
+                }
+            }
+            for (; cell < grid_len; cell++)
             {
-                for (int j = 0; j < grid_w; j++)
+                int8_t box_confidence = conf[cell];
+                if (box_confidence >= thres_i8)
                 {
-                    int8_t box_confidence = input[(PROP_BOX_SIZE * a + 4) * grid_len + i * grid_w + j];
-                    if (box_confidence >= thres_i8)
+                    int maxClassId;
+                    int8_t maxClassProbs = class_argmax(cls + cell, grid_len, num_classes, &maxClassId);
+                    if (maxClassProbs > thres_i8)
                     {
-                        int offset = (PROP_BOX_SIZE * a) * grid_len + i * grid_w + j;
-                        int8_t *in_ptr = input + offset;
-                        float box_x = sigmoid(deqnt_affine_to_f32(*in_ptr, zp, scale)) * 2.0 - 0.5;
-                        float box_y = sigmoid(deqnt_affine_to_f32(in_ptr[grid_len], zp, scale)) * 2.0 - 0.5;
-                        float box_w = sigmoid(deqnt_affine_to_f32(in_ptr[2 * grid_len], zp, scale)) * 2.0;
-                        float box_h = sigmoid(deqnt_affine_to_f32(in_ptr[3 * grid_len], zp, scale)) * 2.0;
-                        box_x = (box_x + j) * (float)stride;
-                        box_y = (box_y + i) * (float)stride;
-                        box_w = box_w * box_w * (float)anchor[a * 2];
-                        box_h = box_h * box_h * (float)anchor[a * 2 + 1];
-                        box_x -= (box_w / 2.0);
-                        box_y -= (box_h / 2.0);
-
-                        int8_t maxClassProbs = in_ptr[5 * grid_len];
-                        int maxClassId = 0;
-                        for (int k = 1; k < OBJ_CLASS_NUM; ++k)
-                        {
-                            int8_t prob = in_ptr[(5 + k) * grid_len];
-                            if (prob > maxClassProbs)
-                            {
-                                maxClassId = k;
-                                maxClassProbs = prob;
-                            }
-                        }
-                        if (maxClassProbs > thres_i8)
-                        {
-                            objProbs.push_back(sigmoid(deqnt_affine_to_f32(maxClassProbs, zp, scale)) *
-                                               sigmoid(deqnt_affine_to_f32(box_confidence, zp, scale)));
-                            classId.push_back(maxClassId);
-                            validCount++;
-                            boxes.push_back(box_x);
-                            boxes.push_back(box_y);
-                            boxes.push_back(box_w);
-                            boxes.push_back(box_h);
-                        }
+                        emit_box(ws, box + cell, lut, grid_len, cell / grid_w, cell % grid_w, stride, anchor, a,
+                                 box_confidence, maxClassProbs, maxClassId);
+                        validCount++;
                     }
                 }
             }
@@ -272,10 +327,51 @@ namespace yolov5
         return validCount;
     }
 
+    void prepare_decode_workspace(decode_workspace_t *ws, int model_in_h, int model_in_w)
+    {
+        size_t cells = 0;
+        for (int stride = 8; stride <= 32; stride *= 2)
+        {
+            cells += (size_t)(model_in_h / stride) * (model_in_w / stride);
+        }
+        reserve_decode_workspace(ws, (int)cells * 3);
+    }
+
+    void reserve_decode_workspace(decode_workspace_t *ws, int capacity)
+    {
+        if ((int)ws->obj_probs.size() < capacity)
+        {
+            ws->boxes.resize(capacity * 4);
+            ws->obj_probs.resize(capacity);
+            ws->class_ids.resize(capacity);
+            ws->nms.order.reserve(capacity);
+        }
+    }
+
+    int decode_outputs(int8_t *input0, int8_t *input1, int8_t *input2, int model_in_h, int model_in_w,
+                       float conf_threshold, const std::vector<int32_t> &qnt_zps,
+                       const std::vector<float> &qnt_scales, decode_workspace_t *ws, decode_impl_e impl,
+                       int num_classes)
+    {
+        prepare_decode_workspace(ws, model_in_h, model_in_w);
+        ws->count = 0;
+        bool simd = impl != DECODE_IMPL_SCALAR;
+
+        int8_t *inputs[3] = {input0, input1, input2};
+        const int *anchors[3] = {anchor0, anchor1, anchor2};
+        for (int b = 0; b < 3; b++)
+        {
+            int stride = 8 << b;
+            process(inputs[b], anchors[b], model_in_h / stride, model_in_w / stride, stride, b, num_classes,
+                    conf_threshold, qnt_zps[b], qnt_scales[b], simd, ws);
+        }
+        return ws->count;
+    }
+
     int
     post_process(int8_t *input0, int8_t *input1, int8_t *input2, int model_in_h, int model_in_w, float conf_threshold,
-                 float nms_threshold, float scale_w, float scale_h, std::vector<int32_t> &qnt_zps,
-                 std::vector<float> &qnt_scales, detect_result_group_t *group)
+                 const nms_config_s &nms, float scale_w, float scale_h, std::vector<int32_t> &qnt_zps,
+                 std::vector<float> &qnt_scales, decode_workspace_t *ws, detect_result_group_t *group)
     {
         static int init = -1;
         if (init == -1)
@@ -289,86 +385,64 @@ namespace yolov5
 
             init = 0;
         }
-        memset(group, 0, sizeof(detect_result_group_t));
 
-        std::vector<float> filterBoxes;
-        std::vector<float> objProbs;
-        std::vector<int> classId;
-
-        // stride 8
-        int stride0 = 8;
-        int grid_h0 = model_in_h / stride0;
-        int grid_w0 = model_in_w / stride0;
-        int validCount0 = 0;
-        validCount0 = process(input0, (int *)anchor0, grid_h0, grid_w0, model_in_h, model_in_w, stride0, filterBoxes,
-                              objProbs,
-                              classId, conf_threshold, qnt_zps[0], qnt_scales[0]);
-
-        // stride 16
-        int stride1 = 16;
-        int grid_h1 = model_in_h / stride1;
-        int grid_w1 = model_in_w / stride1;
-        int validCount1 = 0;
-        validCount1 = process(input1, (int *)anchor1, grid_h1, grid_w1, model_in_h, model_in_w, stride1, filterBoxes,
-                              objProbs,
-                              classId, conf_threshold, qnt_zps[1], qnt_scales[1]);
-
-        // stride 32
-        int stride2 = 32;
-        int grid_h2 = model_in_h / stride2;
-        int grid_w2 = model_in_w / stride2;
-        int validCount2 = 0;
-        validCount2 = process(input2, (int *)anchor2, grid_h2, grid_w2, model_in_h, model_in_w, stride2, filterBoxes,
-                              objProbs,
-                              classId, conf_threshold, qnt_zps[2], qnt_scales[2]);
-
-        int validCount = validCount0 + validCount1 + validCount2;
+        decode_outputs(input0, input1, input2, model_in_h, model_in_w, conf_threshold, qnt_zps, qnt_scales, ws);
+        return collect_detections(ws, nms, model_in_h, model_in_w, scale_w, scale_h, nullptr, group);
+    }
+
+    int collect_detections(decode_workspace_t *ws, const nms_config_s &nms, int model_in_h, int model_in_w,
+                           float scale_w, float scale_h, const std::vector<std::string> *labels,
+                           detect_result_group_t *group)
+    {
+        memset(group, 0, sizeof(detect_result_group_t));
+        int validCount = ws->count;
         // no object detect
         if (validCount <= 0)
         {
             return 0;
         }
 
-        std::vector<int> indexArray;
-        for (int i = 0; i < validCount; ++i)
-        {
-            indexArray.push_back(i);
-        }
-
-        quick_sort_indice_inverse(objProbs, 0, validCount - 1, indexArray);
-
-        std::set<int> class_set(std::begin(classId), std::end(classId));
-
-        for (auto c : class_set)
+        // 排序、top_k截取、按类别分桶NMS，keep按分数降序且不超过max_output
+        nms_config_s nms_config = nms;
+        if (nms_config.max_output <= 0 || nms_config.max_output > OBJ_NUMB_MAX_SIZE)
         {
-            nms(validCount, filterBoxes, classId, indexArray, c, nms_threshold);
+            nms_config.max_output = OBJ_NUMB_MAX_SIZE;
         }
+        int keepCount = nms_run(nms_config, ws->boxes.data(), ws->obj_probs.data(), ws->class_ids.data(), validCount,
+                                &ws->nms);
 
+        const std::vector<float> &filterBoxes = ws->boxes;
+        const std::vector<int> &classId = ws->class_ids;
         int last_count = 0;
         group->count = 0;
         /* box valid detect target */
-        for (int i = 0; i < validCount; ++i)
+        for (int i = 0; i < keepCount; ++i)
         {
-            if (indexArray[i] == -1 || last_count >= OBJ_NUMB_MAX_SIZE)
-            {
-                continue;
-            }
-            int n = indexArray[i];
+            int n = ws->nms.keep[i];
 
             float x1 = filterBoxes[n * 4 + 0];
             float y1 = filterBoxes[n * 4 + 1];
             float x2 = x1 + filterBoxes[n * 4 + 2];
             float y2 = y1 + filterBoxes[n * 4 + 3];
             int id = classId[n];
-            float obj_conf = objProbs[i];
+            float obj_conf = ws->nms.keep_score[i];
 
             group->results[last_count].box.left = (int)(clamp(x1, 0, model_in_w) / scale_w);
             group->results[last_count].box.top = (int)(clamp(y1, 0, model_in_h) / scale_h);
             group->results[last_count].box.right = (int)(clamp(x2, 0, model_in_w) / scale_w);
             group->results[last_count].box.bottom = (int)(clamp(y2, 0, model_in_h) / scale_h);
             group->results[last_count].prop = obj_conf;
-            const char *label = labels[id];
-            strncpy(group->results[last_count].name, label, OBJ_NAME_MAX_SIZE);
+            group->results[last_count].id = id;
+            const char *label;
+            if (labels != nullptr)
+            {
+                label = id < (int)labels->size() ? (*labels)[id].c_str() : "";
+            }
+            else
+            {
+                label = coco_label(id);
+            }
+            strncpy(group->results[last_count].name, label, OBJ_NAME_MAX_SIZE - 1);
 
             // printf("result %2d: (%4d, %4d, %4d, %4d), %s\n", i, group->results[last_count].box.left,
             // group->results[last_count].box.top,
@@ -2,8 +2,11 @@
 #define _RKNN_ZERO_COPY_DEMO_POSTPROCESS_H_
 
 #include <stdint.h>
+#include <string>
 #include <vector>
 
+#include "nms.h"
+
 #define OBJ_NAME_MAX_SIZE 16
 #define OBJ_NUMB_MAX_SIZE 64
 #define OBJ_CLASS_NUM     80
@@ -33,10 +36,56 @@ namespace yolov5 {
         detect_result_t results[OBJ_NUMB_MAX_SIZE];
     } detect_result_group_t;
 
+    typedef enum _decode_impl {
+        DECODE_IMPL_AUTO = 0,   // 编译目标支持时使用SIMD（NEON / SSE2）
+        DECODE_IMPL_SCALAR = 1, // 标量参考实现，与SIMD结果逐位一致
+    } decode_impl_e;
+
+    // 解码与NMS的可复用缓冲区，由Yolov5实例持有，每帧只写不分配
+    // 容量按3个anchor x 全部网格预留，count为本帧候选框数
+    typedef struct _decode_workspace_t {
+        std::vector<float> boxes;     // 每个候选框 x, y, w, h（模型输入坐标）
+        std::vector<float> obj_probs; // 目标置信度 x 类别置信度
+        std::vector<int> class_ids;
+        int count;
+        nms_workspace_t nms;
+
+        // 每个输出分支一张 int8 -> sigmoid(反量化值) 查找表，按(uint8_t)q索引，zp/scale变化时重建
+        float sigmoid_lut[3][256];
+        int32_t lut_zp[3];
+        float lut_scale[3];
+        bool lut_valid[3];
+
+        _decode_workspace_t() : count(0), lut_zp(), lut_scale(), lut_valid() {}
+    } decode_workspace_t;
+
+    // 按模型输入尺寸预留缓冲区（YOLOv5三分支x3个anchor），容量足够时不做任何事
+    void prepare_decode_workspace(decode_workspace_t *ws, int model_in_h, int model_in_w);
+
+    // 预留capacity个候选框，容量足够时不做任何事
+    void reserve_decode_workspace(decode_workspace_t *ws, int capacity);
+
+    // int8 YOLOv5三个输出分支（stride 8/16/32）的解码：objectness阈值扫描、类别argmax、框解码
+    // 每个分支 3 x (5 + num_classes) 个通道；结果写入ws，返回候选框数（未做NMS）
+    int decode_outputs(int8_t *input0, int8_t *input1, int8_t *input2, int model_in_h, int model_in_w,
+                       float conf_threshold, const std::vector<int32_t> &qnt_zps,
+                       const std::vector<float> &qnt_scales, decode_workspace_t *ws,
+                       decode_impl_e impl = DECODE_IMPL_AUTO, int num_classes = OBJ_CLASS_NUM);
+
+    // 对ws中的ws->count个候选做NMS，按分数降序写入group（最多OBJ_NUMB_MAX_SIZE个）
+    // labels为nullptr时使用内置COCO标签
+    int collect_detections(decode_workspace_t *ws, const nms_config_s &nms, int model_in_h, int model_in_w,
+                           float scale_w, float scale_h, const std::vector<std::string> *labels,
+                           detect_result_group_t *group);
+
+    // int8 YOLOv5（COCO 80类）解码 + NMS，nms.max_output超过OBJ_NUMB_MAX_SIZE时按OBJ_NUMB_MAX_SIZE截取
     int post_process(int8_t *input0, int8_t *input1, int8_t *input2, int model_in_h, int model_in_w,
-                     float conf_threshold, float nms_threshold, float scale_w, float scale_h,
+                     float conf_threshold, const nms_config_s &nms, float scale_w, float scale_h,
                      std::vector<int32_t> &qnt_zps, std::vector<float> &qnt_scales,
-                     detect_result_group_t *group);
+                     decode_workspace_t *ws, detect_result_group_t *group);
+
+    // 内置COCO标签，id越界时返回空串
+    const char *coco_label(int id);
 
     void deinitPostProcess();
 }
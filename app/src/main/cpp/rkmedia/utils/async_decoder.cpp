@@ -0,0 +1,92 @@
+#include "async_decoder.h"
+
+#include <chrono>
+#include "log4c.h"
+
+AsyncDecoder::AsyncDecoder(DecoderBackend *backend, size_t ring_capacity)
+        : backend_(backend), ring_(ring_capacity), running_(false), packets_decoded_(0), put_busy_(0),
+          put_errors_(0), frames_(0), get_errors_(0) {
+}
+
+AsyncDecoder::~AsyncDecoder() {
+    Stop();
+}
+
+int AsyncDecoder::Start() {
+    if (backend_ == nullptr || running_) {
+        return -1;
+    }
+    running_ = true;
+    put_thread_ = std::thread(&AsyncDecoder::PutLoop, this);
+    get_thread_ = std::thread(&AsyncDecoder::GetLoop, this);
+    return 0;
+}
+
+void AsyncDecoder::Stop() {
+    running_ = false;
+    ring_.Close();
+    if (put_thread_.joinable()) {
+        put_thread_.join();
+    }
+    if (get_thread_.joinable()) {
+        get_thread_.join();
+    }
+}
+
+bool AsyncDecoder::Submit(const uint8_t *data, size_t size, int64_t pts, bool keyframe, bool config) {
+    if (data == nullptr || size == 0) {
+        return false;
+    }
+    return ring_.Push(data, size, pts, keyframe, config);
+}
+
+AsyncDecoder::stats_s AsyncDecoder::GetStats() const {
+    stats_s stats;
+    stats.ring = ring_.GetStats();
+    stats.packets_decoded = packets_decoded_;
+    stats.put_busy = put_busy_;
+    stats.put_errors = put_errors_;
+    stats.frames = frames_;
+    stats.get_errors = get_errors_;
+    return stats;
+}
+
+void AsyncDecoder::PutLoop() {
+    encoded_packet_s packet;
+    while (running_) {
+        if (!ring_.Pop(packet, -1)) {
+            break;
+        }
+        // 解码器输入队列满时PutPacket在后端的超时内返回BUSY，重试期间网络线程照常入队，
+        // 包队列满了就按丢包策略丢到下一个IDR
+        int ret = DECODER_BUSY;
+        while (running_) {
+            ret = backend_->PutPacket(packet);
+            if (ret != DECODER_BUSY) {
+                break;
+            }
+            put_busy_++;
+        }
+        if (ret == DECODER_OK) {
+            packets_decoded_++;
+        } else if (ret == DECODER_ERROR) {
+            // 少送了一个包，后面的P帧缺参考帧，丢到下一个IDR
+            put_errors_++;
+            LOGE("decoder rejected packet %llu, dropping until next keyframe", (unsigned long long) packet.seq);
+            ring_.DropUntilKeyframe();
+        }
+    }
+}
+
+void AsyncDecoder::GetLoop() {
+    while (running_) {
+        int ret = backend_->GetFrame();
+        if (ret == DECODER_OK) {
+            frames_++;
+        } else if (ret == DECODER_ERROR) {
+            get_errors_++;
+            // 避免后端持续出错时空转
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+}
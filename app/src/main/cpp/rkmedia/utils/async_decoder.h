@@ -0,0 +1,72 @@
+#ifndef __ASYNC_DECODER_H__
+#define __ASYNC_DECODER_H__
+
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include "packet_ring.h"
+
+// DecoderBackend返回值
+#define DECODER_OK       0
+#define DECODER_BUSY     1   // 输入队列满，超时内没送进去
+#define DECODER_TIMEOUT  2   // 超时内没有输出帧
+#define DECODER_ERROR   -1
+
+// 解码器后端：送包和取帧分别在两个线程里调用，两个调用都应在各自的超时内返回
+class DecoderBackend {
+public:
+    virtual ~DecoderBackend() {}
+
+    // 送一个包，返回DECODER_OK / DECODER_BUSY / DECODER_ERROR
+    virtual int PutPacket(const encoded_packet_s &packet) = 0;
+
+    // 取一帧并交给帧回调，返回DECODER_OK / DECODER_TIMEOUT / DECODER_ERROR
+    virtual int GetFrame() = 0;
+};
+
+/**
+ * 异步解码：网络线程只往包队列里拷贝（Submit不阻塞），送包线程把包送进解码器，
+ * 取帧线程阻塞等待输出并交给帧回调。按帧率控制显示节奏不在这里做，由显示端负责。
+ */
+class AsyncDecoder {
+public:
+    typedef struct {
+        PacketRing::stats_s ring;
+        uint64_t packets_decoded;  // 送进解码器的包
+        uint64_t put_busy;         // 送包时解码器输入队列满的次数
+        uint64_t put_errors;
+        uint64_t frames;           // 取到的帧
+        uint64_t get_errors;
+    } stats_s;
+
+    // backend由调用方持有，生命周期要长于AsyncDecoder
+    AsyncDecoder(DecoderBackend *backend, size_t ring_capacity);
+    ~AsyncDecoder();
+
+    int Start();
+    // 停止并等待两个线程退出；队列中未送出的包被丢弃
+    void Stop();
+    bool Running() const { return running_; }
+
+    // 网络线程调用：拷贝入队，不阻塞；返回false表示该包按丢包策略被丢弃
+    bool Submit(const uint8_t *data, size_t size, int64_t pts, bool keyframe, bool config);
+
+    stats_s GetStats() const;
+
+private:
+    void PutLoop();
+    void GetLoop();
+
+    DecoderBackend *backend_;
+    PacketRing ring_;
+    std::thread put_thread_;
+    std::thread get_thread_;
+    std::atomic<bool> running_;
+    std::atomic<uint64_t> packets_decoded_;
+    std::atomic<uint64_t> put_busy_;
+    std::atomic<uint64_t> put_errors_;
+    std::atomic<uint64_t> frames_;
+    std::atomic<uint64_t> get_errors_;
+};
+
+#endif //__ASYNC_DECODER_H__
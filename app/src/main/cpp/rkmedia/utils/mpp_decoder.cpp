@@ -10,19 +10,18 @@
 // Use Android logging system
 // #define LOGD printf
 
-static unsigned long GetCurrentTimeMS()
-{
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return tv.tv_sec * 1000 + tv.tv_usec / 1000;
-}
-
 MppDecoder::MppDecoder()
 {
 }
 
 MppDecoder::~MppDecoder()
 {
+    StopAsync();
+    // 借出的帧还在推理/显示队列里时先等它们归还，再释放buffer group
+    if (lease_limiter && !lease_limiter->WaitIdle(1000))
+    {
+        LOGE("%d leased frames not returned before decoder destruction", lease_limiter->Outstanding());
+    }
     if (loop_data.packet)
     {
         mpp_packet_deinit(&loop_data.packet);
@@ -33,6 +32,11 @@ MppDecoder::~MppDecoder()
         mpp_frame_deinit(&frame);
         frame = NULL;
     }
+    if (async_packet)
+    {
+        mpp_packet_deinit(&async_packet);
+        async_packet = NULL;
+    }
     if (mpp_ctx)
     {
         mpp_destroy(mpp_ctx);
@@ -52,7 +56,6 @@ int MppDecoder::Init(int video_type, int fps, void *userdata)
     MPP_RET ret = MPP_OK;
     this->userdata = userdata;
     this->fps = fps;
-    this->last_frame_time_ms = 0;
     if (video_type == 264)
     {
         mpp_type = MPP_VIDEO_CodingAVC;
@@ -141,11 +144,149 @@ int MppDecoder::Reset()
     return 0;
 }
 
+int MppDecoder::HandleFrame(MppFrame frame)
+{
+    MpiDecLoopData *data = &loop_data;
+    MppCtx ctx = data->ctx;
+    MppApi *mpi = data->mpi;
+    MPP_RET ret = MPP_OK;
+    RK_U32 err_info = 0;
+
+    RK_U32 hor_stride = mpp_frame_get_hor_stride(frame);
+    RK_U32 ver_stride = mpp_frame_get_ver_stride(frame);
+    RK_U32 hor_width = mpp_frame_get_width(frame);
+    RK_U32 ver_height = mpp_frame_get_height(frame);
+    RK_U32 buf_size = mpp_frame_get_buf_size(frame);
+    RK_S64 pts = mpp_frame_get_pts(frame);
+    RK_S64 dts = mpp_frame_get_dts(frame);
+
+    LOGD("decoder require buffer w:h [%d:%d] stride [%d:%d] buf_size %d pts=%lld dts=%lld ",
+         hor_width, ver_height, hor_stride, ver_stride, buf_size, pts, dts);
+
+    if (mpp_frame_get_info_change(frame))
+    {
+
+        LOGD("decode_get_frame get info changed found ");
+        // ret = mpp_buffer_group_get_internal(&data->frm_grp, MPP_BUFFER_TYPE_DRM);
+        // if (ret) {
+        //     LOGD("get mpp buffer group  failed ret %d ", ret);
+        //     break;
+        // }
+        // mpi->control(ctx, MPP_DEC_SET_EXT_BUF_GROUP, data->frm_grp);
+        // mpi->control(ctx, MPP_DEC_SET_INFO_CHANGE_READY, NULL);
+        if (NULL == data->frm_grp)
+        {
+            /* If buffer group is not set create one and limit it */
+            ret = mpp_buffer_group_get_internal(&data->frm_grp, MPP_BUFFER_TYPE_DRM);
+            if (ret)
+            {
+                LOGD("%p get mpp buffer group failed ret %d ", ctx, ret);
+                return -1;
+            }
+
+            /* Set buffer to mpp decoder */
+            ret = mpi->control(ctx, MPP_DEC_SET_EXT_BUF_GROUP, data->frm_grp);
+            if (ret)
+            {
+                LOGD("%p set buffer group failed ret %d ", ctx, ret);
+                return -1;
+            }
+        }
+        else
+        {
+            /* If old buffer group exist clear it */
+            ret = mpp_buffer_group_clear(data->frm_grp);
+            if (ret)
+            {
+                LOGD("%p clear buffer group failed ret %d ", ctx, ret);
+                return -1;
+            }
+        }
+
+        /* Use limit config to limit buffer count to 24 with buf_size */
+        ret = mpp_buffer_group_limit_config(data->frm_grp, buf_size, 24);
+        if (ret)
+        {
+            LOGD("%p limit buffer group failed ret %d ", ctx, ret);
+            return -1;
+        }
+
+        /*
+         * All buffer group config done. Set info change ready to let
+         * decoder continue decoding
+         */
+        ret = mpi->control(ctx, MPP_DEC_SET_INFO_CHANGE_READY, NULL);
+        if (ret)
+        {
+            LOGD("%p info change ready failed ret %d ", ctx, ret);
+            return -1;
+        }
+        return 0;
+    }
+    else
+    {
+        err_info = mpp_frame_get_errinfo(frame) | mpp_frame_get_discard(frame);
+        if (err_info)
+        {
+            LOGD("decoder_get_frame get err info:%d discard:%d. ",
+                 mpp_frame_get_errinfo(frame), mpp_frame_get_discard(frame));
+        }
+        data->frame_count++;
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        LOGD("get one frame %ld ", (tv.tv_sec * 1000 + tv.tv_usec / 1000));
+        // mpp_frame_get_width(frame);
+        // char *input_data =(char *) mpp_buffer_get_ptr(mpp_frame_get_buffer(frame));
+        int delivered = 0;
+        MppFrameHandoff handoff = MPP_FRAME_COPIED;
+        if (lease_callback != nullptr)
+        {
+            // 名额用完时有拷贝回调就退回拷贝，不让解码线程等下游释放
+            handoff = lease_limiter->Handoff(callback != nullptr, lease_wait_ms);
+        }
+        if (lease_callback != nullptr && handoff == MPP_FRAME_LEASED)
+        {
+            // 不拷贝：增加MppBuffer引用交给租约，mpp_frame_deinit后缓冲仍保留到租约释放
+            MppBuffer buffer = mpp_frame_get_buffer(frame);
+            mpp_frame_info_s info;
+            info.width_stride = hor_stride;
+            info.height_stride = ver_stride;
+            info.width = hor_width;
+            info.height = ver_height;
+            info.format = mpp_frame_get_fmt(frame);
+            info.fd = mpp_buffer_get_fd(buffer);
+            info.data = mpp_buffer_get_ptr(buffer);
+            info.pts = pts;
+            mpp_buffer_inc_ref(buffer);
+            std::shared_ptr<MppFrameLease> lease =
+                    std::make_shared<MppFrameLease>(buffer, info, lease_limiter);
+            lease_callback(this->userdata, lease);
+            delivered = 1;
+        }
+        else if (handoff == MPP_FRAME_DROPPED)
+        {
+            LOGD("all %d leased frames still in use, frame dropped (total %llu)",
+                 lease_limiter->MaxLeases(), (unsigned long long)lease_limiter->Dropped());
+        }
+        else if (callback != nullptr)
+        {
+            MppFrameFormat format = mpp_frame_get_fmt(frame);
+            char *data_vir = (char *)mpp_buffer_get_ptr(mpp_frame_get_buffer(frame));
+            int fd = mpp_buffer_get_fd(mpp_frame_get_buffer(frame));
+            LOGD("data_vir=%p fd=%d ", data_vir, fd);
+            callback_frame_pts = pts;
+            callback(this->userdata, hor_stride, ver_stride, hor_width, ver_height, format, fd, data_vir);
+            delivered = 1;
+        }
+        // 不再按fps在解码线程里sleep限速，显示节奏由显示端控制
+        return delivered;
+    }
+}
+
 int MppDecoder::Decode(uint8_t *pkt_data, int pkt_size, int pkt_eos)
 {
     MpiDecLoopData *data = &loop_data;
     RK_U32 pkt_done = 0;
-    RK_U32 err_info = 0;
     MPP_RET ret = MPP_OK;
     MppCtx ctx = data->ctx;
     MppApi *mpi = data->mpi;
@@ -207,113 +348,15 @@ int MppDecoder::Decode(uint8_t *pkt_data, int pkt_size, int pkt_eos)
 
             if (frame)
             {
-                RK_U32 hor_stride = mpp_frame_get_hor_stride(frame);
-                RK_U32 ver_stride = mpp_frame_get_ver_stride(frame);
-                RK_U32 hor_width = mpp_frame_get_width(frame);
-                RK_U32 ver_height = mpp_frame_get_height(frame);
-                RK_U32 buf_size = mpp_frame_get_buf_size(frame);
-                RK_S64 pts = mpp_frame_get_pts(frame);
-                RK_S64 dts = mpp_frame_get_dts(frame);
-
-                LOGD("decoder require buffer w:h [%d:%d] stride [%d:%d] buf_size %d pts=%lld dts=%lld ",
-                     hor_width, ver_height, hor_stride, ver_stride, buf_size, pts, dts);
-
-                if (mpp_frame_get_info_change(frame))
-                {
-
-                    LOGD("decode_get_frame get info changed found ");
-                    // ret = mpp_buffer_group_get_internal(&data->frm_grp, MPP_BUFFER_TYPE_DRM);
-                    // if (ret) {
-                    //     LOGD("get mpp buffer group  failed ret %d ", ret);
-                    //     break;
-                    // }
-                    // mpi->control(ctx, MPP_DEC_SET_EXT_BUF_GROUP, data->frm_grp);
-                    // mpi->control(ctx, MPP_DEC_SET_INFO_CHANGE_READY, NULL);
-                    if (NULL == data->frm_grp)
-                    {
-                        /* If buffer group is not set create one and limit it */
-                        ret = mpp_buffer_group_get_internal(&data->frm_grp, MPP_BUFFER_TYPE_DRM);
-                        if (ret)
-                        {
-                            LOGD("%p get mpp buffer group failed ret %d ", ctx, ret);
-                            break;
-                        }
-
-                        /* Set buffer to mpp decoder */
-                        ret = mpi->control(ctx, MPP_DEC_SET_EXT_BUF_GROUP, data->frm_grp);
-                        if (ret)
-                        {
-                            LOGD("%p set buffer group failed ret %d ", ctx, ret);
-                            break;
-                        }
-                    }
-                    else
-                    {
-                        /* If old buffer group exist clear it */
-                        ret = mpp_buffer_group_clear(data->frm_grp);
-                        if (ret)
-                        {
-                            LOGD("%p clear buffer group failed ret %d ", ctx, ret);
-                            break;
-                        }
-                    }
-
-                    /* Use limit config to limit buffer count to 24 with buf_size */
-                    ret = mpp_buffer_group_limit_config(data->frm_grp, buf_size, 24);
-                    if (ret)
-                    {
-                        LOGD("%p limit buffer group failed ret %d ", ctx, ret);
-                        break;
-                    }
-
-                    /*
-                     * All buffer group config done. Set info change ready to let
-                     * decoder continue decoding
-                     */
-                    ret = mpi->control(ctx, MPP_DEC_SET_INFO_CHANGE_READY, NULL);
-                    if (ret)
-                    {
-                        LOGD("%p info change ready failed ret %d ", ctx, ret);
-                        break;
-                    }
-
-                    this->last_frame_time_ms = GetCurrentTimeMS();
-                }
-                else
-                {
-                    err_info = mpp_frame_get_errinfo(frame) | mpp_frame_get_discard(frame);
-                    if (err_info)
-                    {
-                        LOGD("decoder_get_frame get err info:%d discard:%d. ",
-                             mpp_frame_get_errinfo(frame), mpp_frame_get_discard(frame));
-                    }
-                    data->frame_count++;
-                    struct timeval tv;
-                    gettimeofday(&tv, NULL);
-                    LOGD("get one frame %ld ", (tv.tv_sec * 1000 + tv.tv_usec / 1000));
-                    // mpp_frame_get_width(frame);
-                    // char *input_data =(char *) mpp_buffer_get_ptr(mpp_frame_get_buffer(frame));
-                    if (callback != nullptr)
-                    {
-                        MppFrameFormat format = mpp_frame_get_fmt(frame);
-                        char *data_vir = (char *)mpp_buffer_get_ptr(mpp_frame_get_buffer(frame));
-                        int fd = mpp_buffer_get_fd(mpp_frame_get_buffer(frame));
-                        LOGD("data_vir=%p fd=%d ", data_vir, fd);
-                        callback(this->userdata, hor_stride, ver_stride, hor_width, ver_height, format, fd, data_vir);
-                    }
-                    unsigned long cur_time_ms = GetCurrentTimeMS();
-                    long time_gap = 1000 / this->fps - (cur_time_ms - this->last_frame_time_ms);
-                    LOGD("time_gap=%ld", time_gap);
-                    if (time_gap > 0)
-                    {
-                        usleep(time_gap * 1000);
-                    }
-                    this->last_frame_time_ms = GetCurrentTimeMS();
-                }
+                int handled = HandleFrame(frame);
                 frm_eos = mpp_frame_get_eos(frame);
 
                 ret = mpp_frame_deinit(&frame);
                 frame = NULL;
+                if (handled < 0)
+                {
+                    break;
+                }
 
                 // if(frame_pre!=NULL)
                 // {
@@ -384,4 +427,101 @@ int MppDecoder::SetCallback(MppDecoderFrameCallback callback)
 {
     this->callback = callback;
     return 0;
-}
\ No newline at end of file
+}
+
+int MppDecoder::SetLeaseCallback(MppDecoderLeaseCallback callback, int max_leases, int wait_ms)
+{
+    this->lease_callback = callback;
+    if (callback != nullptr)
+    {
+        this->lease_limiter = std::make_shared<MppFrameLeaseLimiter>(max_leases);
+        this->lease_wait_ms = wait_ms;
+    }
+    return 0;
+}
+
+int MppDecoder::StartAsync(size_t ring_capacity, int timeout_ms)
+{
+    if (loop_data.mpi == NULL || async_decoder)
+    {
+        return -1;
+    }
+    // 送包和取帧改成带超时的阻塞调用，不再sleep轮询
+    RK_S64 timeout = timeout_ms;
+    if (loop_data.mpi->control(loop_data.ctx, MPP_SET_INPUT_TIMEOUT, &timeout) ||
+        loop_data.mpi->control(loop_data.ctx, MPP_SET_OUTPUT_TIMEOUT, &timeout))
+    {
+        LOGE("%p failed to set decoder timeouts", loop_data.ctx);
+        return -1;
+    }
+    async_decoder.reset(new AsyncDecoder(this, ring_capacity));
+    return async_decoder->Start();
+}
+
+void MppDecoder::StopAsync()
+{
+    // 只停线程不释放：网络线程可能还在SubmitPacket，关闭后的包队列直接丢包
+    if (async_decoder)
+    {
+        async_decoder->Stop();
+    }
+}
+
+bool MppDecoder::SubmitPacket(const uint8_t *pkt_data, size_t pkt_size, int64_t pts, bool keyframe, bool config)
+{
+    if (!async_decoder)
+    {
+        return false;
+    }
+    return async_decoder->Submit(pkt_data, pkt_size, pts, keyframe, config);
+}
+
+int MppDecoder::PutPacket(const encoded_packet_s &pkt)
+{
+    if (async_packet == NULL && mpp_packet_init(&async_packet, NULL, 0) != MPP_OK)
+    {
+        return DECODER_ERROR;
+    }
+    void *pkt_data = (void *)pkt.data.data();
+    mpp_packet_set_data(async_packet, pkt_data);
+    mpp_packet_set_size(async_packet, pkt.data.size());
+    mpp_packet_set_pos(async_packet, pkt_data);
+    mpp_packet_set_length(async_packet, pkt.data.size());
+    mpp_packet_set_pts(async_packet, pkt.pts);
+
+    // MPP在decode_put_packet里拷贝码流，返回后pkt的缓冲即可复用
+    MPP_RET ret = loop_data.mpi->decode_put_packet(loop_data.ctx, async_packet);
+    if (ret == MPP_OK)
+    {
+        return DECODER_OK;
+    }
+    if (ret == MPP_ERR_BUFFER_FULL || ret == MPP_ERR_TIMEOUT || ret == MPP_NOK)
+    {
+        return DECODER_BUSY;
+    }
+    LOGD("decode_put_packet failed ret %d ", ret);
+    return DECODER_ERROR;
+}
+
+int MppDecoder::GetFrame()
+{
+    MppFrame out = NULL;
+    MPP_RET ret = loop_data.mpi->decode_get_frame(loop_data.ctx, &out);
+    if (ret == MPP_ERR_TIMEOUT || (ret == MPP_OK && out == NULL))
+    {
+        return DECODER_TIMEOUT;
+    }
+    if (ret != MPP_OK)
+    {
+        LOGD("decode_get_frame failed ret %d ", ret);
+        return DECODER_ERROR;
+    }
+
+    int handled = HandleFrame(out);
+    mpp_frame_deinit(&out);
+    if (handled < 0)
+    {
+        return DECODER_ERROR;
+    }
+    return handled > 0 ? DECODER_OK : DECODER_TIMEOUT;
+}
@@ -6,6 +6,9 @@
 #include "mpp_frame.h"
 #include <string.h>
 #include <pthread.h>
+#include <memory>
+#include "mpp_frame_lease.h"
+#include "async_decoder.h"
 
 #define MPI_DEC_STREAM_SIZE         (SZ_4K)
 #define MPI_DEC_LOOP_COUNT          4
@@ -31,7 +34,9 @@ typedef struct
     size_t          max_usage;
 } MpiDecLoopData;
 
-class MppDecoder
+// 同步用法：在调用线程里Decode()。异步用法：StartAsync()后由网络线程SubmitPacket()，
+// 送包/取帧在AsyncDecoder的两个线程里进行（MppDecoder作为它的后端）
+class MppDecoder : public DecoderBackend
 {
 public:
     MppCtx mpp_ctx          = NULL;
@@ -40,8 +45,26 @@ public:
     ~MppDecoder();
     int Init(int video_type, int fps, void* userdata);
     int SetCallback(MppDecoderFrameCallback callback);
+    // 以租约形式交出解码帧（不拷贝）。最多max_leases帧同时在外，达到上限时若设置了拷贝回调
+    // 则改用SetCallback的回调拷贝交出，否则等待wait_ms，超时丢帧
+    int SetLeaseCallback(MppDecoderLeaseCallback callback, int max_leases = 8, int wait_ms = 40);
+    std::shared_ptr<MppFrameLeaseLimiter> GetLeaseLimiter() const { return lease_limiter; }
+    // 拷贝回调正在交出的帧的PTS（送包时设置，由MPP带到输出帧），只在回调内有效
+    int64_t GetCallbackFramePts() const { return callback_frame_pts; }
     int Decode(uint8_t* pkt_data, int pkt_size, int pkt_eos);
     int Reset();
+
+    // 启动送包/取帧线程；MPP输入输出调用最多阻塞timeout_ms。回调须在此之前设置好
+    int StartAsync(size_t ring_capacity = 32, int timeout_ms = 20);
+    // 停止送包/取帧线程，之后不会再有帧回调；不能再次StartAsync
+    void StopAsync();
+    // 网络线程调用，拷贝入队后立即返回；队列满时丢到下一个IDR，被丢弃返回false
+    bool SubmitPacket(const uint8_t* pkt_data, size_t pkt_size, int64_t pts, bool keyframe, bool config);
+    AsyncDecoder* GetAsyncDecoder() const { return async_decoder.get(); }
+
+    // DecoderBackend
+    int PutPacket(const encoded_packet_s &packet) override;
+    int GetFrame() override;
 private:
     // base flow context
     MpiCmd mpi_cmd      = MPP_CMD_BASE;
@@ -56,11 +79,19 @@ private:
     MppPacket packet = NULL;
     MppFrame  frame  = NULL;
     pthread_t th=NULL;
-    MppDecoderFrameCallback callback;
+    MppDecoderFrameCallback callback = nullptr;
+    MppDecoderLeaseCallback lease_callback = nullptr;
+    std::shared_ptr<MppFrameLeaseLimiter> lease_limiter;
+    int lease_wait_ms = 0;
+    int64_t callback_frame_pts = -1;
     int fps = -1;
-    unsigned long last_frame_time_ms = 0;
+    std::unique_ptr<AsyncDecoder> async_decoder;
+    MppPacket async_packet = NULL;
 
     void* userdata = NULL;
+
+    // 处理一个解码输出：info change时配置buffer group，否则交给回调。交出一帧返回1，否则0，出错返回-1
+    int HandleFrame(MppFrame frame);
 };
 
 size_t mpp_frame_get_buf_size(const MppFrame s);
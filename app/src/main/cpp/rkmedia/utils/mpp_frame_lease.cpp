@@ -0,0 +1,85 @@
+#include "mpp_frame_lease.h"
+
+#include <chrono>
+#include "log4c.h"
+
+MppFrameLeaseLimiter::MppFrameLeaseLimiter(int max_leases)
+        : max_leases_(max_leases > 0 ? max_leases : 1), outstanding_(0), leased_(0), waited_(0), copied_(0), dropped_(0) {
+}
+
+MppFrameHandoff MppFrameLeaseLimiter::Handoff(bool can_copy, int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (outstanding_ >= max_leases_) {
+        if (can_copy) {
+            copied_++;
+            return MPP_FRAME_COPIED;
+        }
+        bool ok = released_.wait_for(lock, std::chrono::milliseconds(timeout_ms > 0 ? timeout_ms : 0),
+                                     [this] { return outstanding_ < max_leases_; });
+        if (!ok) {
+            dropped_++;
+            return MPP_FRAME_DROPPED;
+        }
+        waited_++;
+    }
+    outstanding_++;
+    leased_++;
+    return MPP_FRAME_LEASED;
+}
+
+bool MppFrameLeaseLimiter::Acquire(int timeout_ms) {
+    return Handoff(false, timeout_ms) == MPP_FRAME_LEASED;
+}
+
+void MppFrameLeaseLimiter::Release() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        outstanding_--;
+    }
+    released_.notify_all();
+}
+
+bool MppFrameLeaseLimiter::WaitIdle(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return released_.wait_for(lock, std::chrono::milliseconds(timeout_ms > 0 ? timeout_ms : 0),
+                              [this] { return outstanding_ == 0; });
+}
+
+int MppFrameLeaseLimiter::Outstanding() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return outstanding_;
+}
+
+uint64_t MppFrameLeaseLimiter::Leased() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return leased_;
+}
+
+uint64_t MppFrameLeaseLimiter::Waited() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return waited_;
+}
+
+uint64_t MppFrameLeaseLimiter::Copied() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return copied_;
+}
+
+uint64_t MppFrameLeaseLimiter::Dropped() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+MppFrameLease::MppFrameLease(MppBuffer buffer, const mpp_frame_info_s &info,
+                             std::shared_ptr<MppFrameLeaseLimiter> limiter)
+        : buffer_(buffer), info_(info), limiter_(std::move(limiter)) {
+}
+
+MppFrameLease::~MppFrameLease() {
+    if (buffer_) {
+        mpp_buffer_put(buffer_);
+    }
+    if (limiter_) {
+        limiter_->Release();
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef __MPP_FRAME_LEASE_H__
+#define __MPP_FRAME_LEASE_H__
+
+#include <stdint.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include "rk_mpi.h"
+
+// 解码帧描述，data/fd指向解码器buffer group中的MppBuffer
+typedef struct {
+    int width_stride;
+    int height_stride;
+    int width;
+    int height;
+    int format;
+    int fd;
+    void *data;
+    int64_t pts;
+} mpp_frame_info_s;
+
+// 解码帧交出方式
+enum MppFrameHandoff {
+    MPP_FRAME_LEASED = 0,   // 借出解码缓冲，不拷贝
+    MPP_FRAME_COPIED,       // 名额用完，拷贝后缓冲立即归还解码器
+    MPP_FRAME_DROPPED,      // 名额用完且不能拷贝，等待超时丢帧
+};
+
+// 限制同时借出的解码缓冲数量。buffer group只有24块，其中一部分是解码器的参考帧，
+// 借出太多解码器会拿不到空闲缓冲。名额用完时能拷贝就拷贝（下游队列比名额深，
+// 不能让解码线程等下游），否则解码线程等待归还（反压），超时丢帧
+class MppFrameLeaseLimiter {
+public:
+    explicit MppFrameLeaseLimiter(int max_leases);
+
+    // 决定一帧怎么交出：有名额时取得名额返回LEASED；否则can_copy时不等待返回COPIED，
+    // 不能拷贝时最多等待timeout_ms，超时返回DROPPED
+    MppFrameHandoff Handoff(bool can_copy, int timeout_ms);
+    // 最多等待timeout_ms取得一个名额，失败返回false
+    bool Acquire(int timeout_ms);
+    void Release();
+
+    // 等待所有租约归还（解码器销毁前），超时返回false
+    bool WaitIdle(int timeout_ms);
+
+    int MaxLeases() const { return max_leases_; }
+    int Outstanding() const;
+    uint64_t Leased() const;   // 成功借出的次数
+    uint64_t Waited() const;   // 需要等待归还才借出的次数
+    uint64_t Copied() const;   // 名额用完退回拷贝的帧数
+    uint64_t Dropped() const;  // 等待超时而丢弃的帧数
+
+private:
+    const int max_leases_;
+    mutable std::mutex mutex_;
+    std::condition_variable released_;
+    int outstanding_;
+    uint64_t leased_;
+    uint64_t waited_;
+    uint64_t copied_;
+    uint64_t dropped_;
+};
+
+// 解码帧租约：持有MppBuffer的一个引用，最后一个持有者（推理、显示）释放时归还给buffer group，
+// 回调里不再需要把整帧拷贝出来。借出的缓冲可能仍是解码器的参考帧，只能读不能写
+class MppFrameLease {
+public:
+    // buffer已由调用方mpp_buffer_inc_ref，且已从limiter取得名额；两者在析构时归还。buffer可为NULL（测试）
+    MppFrameLease(MppBuffer buffer, const mpp_frame_info_s &info, std::shared_ptr<MppFrameLeaseLimiter> limiter);
+    ~MppFrameLease();
+
+    const mpp_frame_info_s &Info() const { return info_; }
+    char *Data() const { return static_cast<char *>(info_.data); }
+    size_t Size() const { return (size_t) info_.width_stride * info_.height_stride * 3 / 2; }
+
+private:
+    MppFrameLease(const MppFrameLease &) = delete;
+    MppFrameLease &operator=(const MppFrameLease &) = delete;
+
+    MppBuffer buffer_;
+    mpp_frame_info_s info_;
+    std::shared_ptr<MppFrameLeaseLimiter> limiter_;
+};
+
+typedef void (*MppDecoderLeaseCallback)(void *userdata, const std::shared_ptr<MppFrameLease> &lease);
+
+#endif //__MPP_FRAME_LEASE_H__
@@ -0,0 +1,123 @@
+#include "packet_ring.h"
+
+#include <string.h>
+#include <chrono>
+
+PacketRing::PacketRing(size_t capacity)
+        : slots_(capacity > 0 ? capacity : 1), head_(0), count_(0), next_seq_(0), waiting_keyframe_(false),
+          closed_(false) {
+    memset(&stats_, 0, sizeof(stats_));
+}
+
+bool PacketRing::Push(const uint8_t *data, size_t size, int64_t pts, bool keyframe, bool config) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t seq = next_seq_++;
+        stats_.pushed++;
+        if (closed_) {
+            stats_.dropped++;
+            return false;
+        }
+
+        if (!keyframe && !config && waiting_keyframe_) {
+            stats_.dropped++;
+            return false;
+        }
+        if (count_ == slots_.size()) {
+            if (!keyframe && !config) {
+                // 解码跟不上：丢掉新来的P帧并等下一个IDR。已排队的包是从上一个IDR开始的连续序列，仍可解码
+                EnterResyncLocked();
+                stats_.dropped++;
+                return false;
+            }
+            // IDR/配置包不丢：排队的旧包已经过时，清空给它腾位置；配置包之后仍要等IDR
+            ClearLocked();
+            if (!keyframe) {
+                EnterResyncLocked();
+            }
+        }
+        if (keyframe) {
+            waiting_keyframe_ = false;
+        }
+
+        encoded_packet_s &slot = slots_[(head_ + count_) % slots_.size()];
+        slot.data.assign(data, data + size);
+        slot.pts = pts;
+        slot.keyframe = keyframe;
+        slot.config = config;
+        slot.seq = seq;
+        count_++;
+        stats_.queued++;
+        if (count_ > stats_.high_water) {
+            stats_.high_water = count_;
+        }
+    }
+    not_empty_.notify_one();
+    return true;
+}
+
+bool PacketRing::Pop(encoded_packet_s &out, int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto ready = [this] { return count_ > 0 || closed_; };
+    if (timeout_ms < 0) {
+        not_empty_.wait(lock, ready);
+    } else if (!not_empty_.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready)) {
+        return false;
+    }
+    if (closed_ || count_ == 0) {
+        return false;
+    }
+
+    encoded_packet_s &slot = slots_[head_];
+    out.data.swap(slot.data);
+    out.pts = slot.pts;
+    out.keyframe = slot.keyframe;
+    out.config = slot.config;
+    out.seq = slot.seq;
+    head_ = (head_ + 1) % slots_.size();
+    count_--;
+    return true;
+}
+
+void PacketRing::DropUntilKeyframe() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ClearLocked();
+    EnterResyncLocked();
+}
+
+void PacketRing::Close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    not_empty_.notify_all();
+}
+
+size_t PacketRing::Size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_;
+}
+
+bool PacketRing::WaitingForKeyframe() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return waiting_keyframe_;
+}
+
+PacketRing::stats_s PacketRing::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void PacketRing::ClearLocked() {
+    // 只移动下标，槽位缓冲保留复用
+    stats_.dropped += count_;
+    head_ = 0;
+    count_ = 0;
+}
+
+void PacketRing::EnterResyncLocked() {
+    if (!waiting_keyframe_) {
+        waiting_keyframe_ = true;
+        stats_.resyncs++;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef __PACKET_RING_H__
+#define __PACKET_RING_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+// 一个待解码的码流包（H.264/H.265 access unit）
+typedef struct {
+    std::vector<uint8_t> data;
+    int64_t pts;
+    bool keyframe;  // IDR
+    bool config;    // SPS/PPS/VPS
+    uint64_t seq;   // 入队序号，从0开始连续编号（含被丢弃的包）
+} encoded_packet_s;
+
+/**
+ * 网络线程与解码送包线程之间的有界包队列。
+ *
+ * Push由网络线程调用，从不阻塞：队列满说明解码跟不上，此时丢弃后续所有非IDR包，直到
+ * 下一个IDR到来（P帧缺了参考帧解出来也是花屏）；IDR或配置包（SPS/PPS）到来时若队列仍满，
+ * 清空已排队的旧包给它腾位置。槽位的缓冲循环使用，稳定后入队不再分配内存。
+ */
+class PacketRing {
+public:
+    typedef struct {
+        uint64_t pushed;          // Push调用次数
+        uint64_t queued;          // 实际入队的包数
+        uint64_t dropped;         // 丢弃的包数（清空的 + 等待IDR期间到来的）
+        uint64_t resyncs;         // 进入等待IDR状态的次数
+        size_t high_water;        // 队列最大深度
+    } stats_s;
+
+    explicit PacketRing(size_t capacity);
+
+    // 拷贝data入队；返回false表示该包被丢弃
+    bool Push(const uint8_t *data, size_t size, int64_t pts, bool keyframe, bool config);
+
+    // 取一个包，最多等待timeout_ms（<0一直等）；out原有的缓冲换回队列复用。超时或关闭后返回false
+    bool Pop(encoded_packet_s &out, int timeout_ms);
+
+    // 解码端要求丢到下一个IDR（例如解码器报错），已排队的包一并清空
+    void DropUntilKeyframe();
+
+    // 关闭：唤醒等待者，之后Push全部丢弃，Pop立即返回false
+    void Close();
+
+    size_t Size() const;
+    size_t Capacity() const { return slots_.size(); }
+    bool WaitingForKeyframe() const;
+    stats_s GetStats() const;
+
+private:
+    void ClearLocked();
+    void EnterResyncLocked();
+
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::vector<encoded_packet_s> slots_;
+    size_t head_;
+    size_t count_;
+    uint64_t next_seq_;
+    bool waiting_keyframe_;
+    bool closed_;
+    stats_s stats_;
+};
+
+#endif //__PACKET_RING_H__
@@ -127,9 +127,17 @@ bool NativeChannelManager::startChannel(int channelIndex, const char* rtspUrl) {
             channelIndex,
             sharedResources.modelData,
             sharedResources.modelSize,
-            this
+            this,
+            sharedResources.inferenceScheduler.get(),
+            sharedResources.surfaceRenderer.get()
         );
 
+        // Apply scheduling weight before the first frame arrives
+        if (sharedResources.inferenceScheduler) {
+            sharedResources.inferenceScheduler->setChannelPriority(channelIndex, channelInfo->priority);
+            sharedResources.inferenceScheduler->setChannelVisible(channelIndex, channelInfo->surface != nullptr);
+        }
+
         // Configure RTSP URL
         channelInfo->rtspUrl = rtspUrl;
         channelInfo->player->setChannelRTSPUrl(rtspUrl);
@@ -141,6 +149,7 @@ bool NativeChannelManager::startChannel(int channelIndex, const char* rtspUrl) {
 
         // Configure detection
         channelInfo->player->setDetectionEnabled(channelInfo->detectionEnabled);
+        channelInfo->player->setDetectionCadence(channelInfo->cadence);
         
         // Update state to active
         updateChannelState(channelIndex, ACTIVE);
@@ -200,6 +209,11 @@ bool NativeChannelManager::setChannelSurface(int channelIndex, ANativeWindow* su
         if (channelInfo->player) {
             channelInfo->player->setChannelSurface(surface);
         }
+
+        // Channels without a surface are off-screen and get a reduced share of the NPU
+        if (sharedResources.inferenceScheduler) {
+            sharedResources.inferenceScheduler->setChannelVisible(channelIndex, surface != nullptr);
+        }
         
         return true;
     }
@@ -249,6 +263,75 @@ bool NativeChannelManager::setChannelDetectionEnabled(int channelIndex, bool ena
     return false;
 }
 
+bool NativeChannelManager::setChannelDetectionCadence(int channelIndex,
+                                                      const PerChannelDetection::DetectionConfig& config) {
+    if (!isValidChannelIndex(channelIndex)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(channelsMutex);
+    ChannelInfo* channelInfo = getChannelInfo(channelIndex);
+
+    if (channelInfo) {
+        channelInfo->cadence = PerChannelDetection::cadenceConfig(config);
+
+        if (channelInfo->player) {
+            channelInfo->player->setDetectionCadence(channelInfo->cadence);
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+bool NativeChannelManager::setChannelPriority(int channelIndex, int priority) {
+    if (!isValidChannelIndex(channelIndex) || priority < 1) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(channelsMutex);
+    ChannelInfo* channelInfo = getChannelInfo(channelIndex);
+
+    if (channelInfo) {
+        channelInfo->priority = priority;
+
+        if (sharedResources.inferenceScheduler) {
+            sharedResources.inferenceScheduler->setChannelPriority(channelIndex, priority);
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+bool NativeChannelManager::setActiveChannel(int channelIndex, bool active) {
+    if (!isValidChannelIndex(channelIndex)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(channelsMutex);
+    ChannelInfo* channelInfo = getChannelInfo(channelIndex);
+
+    if (channelInfo && channelInfo->player) {
+        // The player forwards the focus state to the inference scheduler
+        channelInfo->player->setActiveChannel(active);
+        return true;
+    }
+
+    return false;
+}
+
+bool NativeChannelManager::setDetectionNmsConfig(const PerChannelDetection::DetectionConfig& config) {
+    if (!sharedResources.inferenceScheduler) {
+        return false;
+    }
+
+    sharedResources.inferenceScheduler->setNmsConfig(PerChannelDetection::nmsConfig(config));
+    return true;
+}
+
 // Callback implementations
 void NativeChannelManager::onChannelFrameReceived(int channelIndex) {
     if (!isValidChannelIndex(channelIndex)) {
@@ -349,6 +432,22 @@ float NativeChannelManager::getChannelFps(int channelIndex) {
     return channelInfo ? channelInfo->fps : 0.0f;
 }
 
+bool NativeChannelManager::getChannelInferenceStats(int channelIndex, InferenceScheduler::ChannelStats& stats) {
+    if (!isValidChannelIndex(channelIndex) || !sharedResources.inferenceScheduler) {
+        return false;
+    }
+
+    return sharedResources.inferenceScheduler->getChannelStats(channelIndex, stats);
+}
+
+bool NativeChannelManager::getChannelPresentStats(int channelIndex, MultiSurfaceRenderer::PresentStats& stats) {
+    if (!isValidChannelIndex(channelIndex) || !sharedResources.surfaceRenderer) {
+        return false;
+    }
+
+    return sharedResources.surfaceRenderer->getPresentStats(channelIndex, stats);
+}
+
 int NativeChannelManager::getActiveChannelCount() {
     return performanceMetrics.activeChannelCount.load();
 }
@@ -497,14 +596,23 @@ bool NativeChannelManager::initializeSharedResources(char* modelData, int modelS
     memcpy(sharedResources.modelData, modelData, modelSize);
     sharedResources.modelSize = modelSize;
     
-    // Create shared thread pool
-    sharedResources.sharedThreadPool = std::make_shared<Yolov5ThreadPool>();
-    if (sharedResources.sharedThreadPool->setUpWithModelData(SHARED_THREAD_POOL_SIZE, 
-                                                           sharedResources.modelData, 
-                                                           sharedResources.modelSize) != NN_SUCCESS) {
-        LOGE("Failed to initialize shared YOLOv5 thread pool");
+    // Create the process-wide inference scheduler shared by all channels
+    InferenceScheduler::Config schedulerConfig;
+    schedulerConfig.numWorkers = SHARED_INFERENCE_WORKERS;
+    schedulerConfig.policy = InferenceScheduler::WEIGHTED_FAIR;
+    sharedResources.inferenceScheduler = std::make_shared<InferenceScheduler>();
+    if (sharedResources.inferenceScheduler->setUp(schedulerConfig,
+                                                  sharedResources.modelData,
+                                                  sharedResources.modelSize) != NN_SUCCESS) {
+        LOGE("Failed to initialize shared inference scheduler");
+        sharedResources.inferenceScheduler.reset();
         return false;
     }
+    // Same NMS defaults as a PerChannelDetection channel until setDetectionNmsConfig() changes them
+    sharedResources.inferenceScheduler->setNmsConfig(PerChannelDetection::nmsConfig(PerChannelDetection::DetectionConfig(0)));
+
+    // One render pool presents every channel at its frames' deadlines instead of a display thread per channel
+    sharedResources.surfaceRenderer = std::make_shared<MultiSurfaceRenderer>(MAX_CHANNELS, SHARED_RENDER_THREADS);
     
     LOGD("Shared resources initialized successfully");
     return true;
@@ -539,10 +647,12 @@ void NativeChannelManager::cleanup() {
 void NativeChannelManager::cleanupSharedResources() {
     std::lock_guard<std::mutex> lock(sharedResources.resourceMutex);
     
-    if (sharedResources.sharedThreadPool) {
-        sharedResources.sharedThreadPool->stopAll();
-        sharedResources.sharedThreadPool.reset();
+    if (sharedResources.inferenceScheduler) {
+        sharedResources.inferenceScheduler->stopAll();
+        sharedResources.inferenceScheduler.reset();
     }
+    // Channels were destroyed first, so no source is registered any more
+    sharedResources.surfaceRenderer.reset();
     
     // Destructor will handle modelData cleanup
 }
@@ -592,6 +702,22 @@ void NativeChannelManager::updatePerformanceMetrics() {
                 channelInfo->fps = (channelFrameCount * 1000.0f) / deltaTime;
                 channelInfo->renderFps = (channelRenderCount * 1000.0f) / deltaTime;
 
+                InferenceScheduler::ChannelStats inferenceStats;
+                if (sharedResources.inferenceScheduler &&
+                    sharedResources.inferenceScheduler->getChannelStats(pair.first, inferenceStats)) {
+                    LOGD("Channel %d inference: weight=%.2f, queue=%d, avgService=%.1fms, maxService=%.1fms, dropped=%ld",
+                         pair.first, inferenceStats.weight, inferenceStats.queueDepth,
+                         inferenceStats.avgServiceMs, inferenceStats.maxServiceMs, inferenceStats.dropped);
+                }
+
+                MultiSurfaceRenderer::PresentStats presentStats;
+                if (sharedResources.surfaceRenderer &&
+                    sharedResources.surfaceRenderer->getPresentStats(pair.first, presentStats)) {
+                    LOGD("Channel %d presentation: on time %llu, late %llu, dropped %llu, failed %llu",
+                         pair.first, (unsigned long long) presentStats.onTime, (unsigned long long) presentStats.late,
+                         (unsigned long long) presentStats.dropped, (unsigned long long) presentStats.failed);
+                }
+
                 // Adaptive performance optimization
                 if (channelInfo->fps < PerformanceMetrics::MIN_FPS_THRESHOLD) {
                     // Reduce detection frequency for this channel
@@ -0,0 +1,282 @@
+#include "CompositorEngine.h"
+#include "FrameConverter.h"
+#include "log4c.h"
+
+#include <algorithm>
+
+CompositorEngine::CompositorEngine(const Config& config)
+        : m_config(config), m_ring(std::make_shared<CanvasRing>()), m_composeCount(0), m_stats(),
+          m_task(nullptr), m_taskCount(0), m_nextTask(0), m_activeWorkers(0), m_batch(0), m_stopping(false) {
+    startWorkers(config.workerThreads);
+}
+
+CompositorEngine::~CompositorEngine() {
+    stopWorkers();
+}
+
+void CompositorEngine::configure(const Config& config) {
+    std::lock_guard<std::mutex> lock(m_composeMutex);
+    stopWorkers();
+    m_config = config;
+    m_ring = std::make_shared<CanvasRing>();
+    m_maps.clear();
+    startWorkers(config.workerThreads);
+    LOGD("CompositorEngine configured: %dx%d, %d workers, %d-row tiles, filter %d (%s)", config.width,
+         config.height, config.workerThreads, config.tileRows, config.filter, image_kernels_simd_name());
+}
+
+CompositorEngine::Config CompositorEngine::getConfig() const {
+    std::lock_guard<std::mutex> lock(m_composeMutex);
+    return m_config;
+}
+
+int CompositorEngine::stride() const {
+    std::lock_guard<std::mutex> lock(m_composeMutex);
+    return m_config.width * 4;
+}
+
+CompositorEngine::Stats CompositorEngine::getStats() const {
+    std::lock_guard<std::mutex> lock(m_composeMutex);
+    return m_stats;
+}
+
+std::shared_ptr<uint8_t> CompositorEngine::compose(const std::vector<Layer>& layers) {
+    std::lock_guard<std::mutex> lock(m_composeMutex);
+    std::shared_ptr<uint8_t> handle;
+    Canvas* canvas = acquireCanvas(handle);
+    if (!canvas) {
+        m_stats.noCanvas++;
+        return nullptr;
+    }
+    const int stride = m_config.width * 4;
+    uint8_t* pixels = canvas->pixels.get();
+
+    m_layers.clear();
+    m_placed.clear();
+    for (const Layer& layer : layers) {
+        if (fitsCanvas(layer)) {
+            m_layers.push_back(layer);
+            m_placed.push_back({layer.id, layer.x, layer.y, layer.width, layer.height, layer.sequence});
+        }
+    }
+    const int count = (int) m_layers.size();
+
+    // The layout is the ordered list of layer ids and viewports
+    bool sameLayout = canvas->valid && (int) canvas->drawn.size() == count;
+    bool overlap = false;
+    for (int i = 0; i < count; i++) {
+        const DrawnLayer& placed = m_placed[i];
+        if (sameLayout) {
+            const DrawnLayer& drawn = canvas->drawn[i];
+            sameLayout = drawn.id == placed.id && drawn.x == placed.x && drawn.y == placed.y &&
+                         drawn.width == placed.width && drawn.height == placed.height;
+        }
+        for (int j = 0; j < i && !overlap; j++) {
+            const DrawnLayer& other = m_placed[j];
+            overlap = placed.x < other.x + other.width && other.x < placed.x + placed.width &&
+                      placed.y < other.y + other.height && other.y < placed.y + placed.height;
+        }
+    }
+
+    // Redrawing one of several overlapping layers would paint over the ones above it
+    m_dirty.clear();
+    for (int i = 0; i < count; i++) {
+        if (!sameLayout || canvas->drawn[i].sequence != m_placed[i].sequence) {
+            m_dirty.push_back(i);
+        }
+    }
+    if (overlap && !m_dirty.empty() && (int) m_dirty.size() < count) {
+        m_dirty.clear();
+        for (int i = 0; i < count; i++) {
+            m_dirty.push_back(i);
+        }
+    }
+    m_stats.layersReused += count - m_dirty.size();
+    m_stats.layersDrawn += m_dirty.size();
+
+    // RGBA views of the dirty frames (NV12 conversion runs on the workers), then their scale maps
+    m_sources.assign(count, nullptr);
+    m_converted.assign(count, nullptr);
+    std::function<void(int)> convert = [this](int k) {
+        const Layer& layer = m_layers[m_dirty[k]];
+        if (layer.frame && layer.frame->data && layer.frame->screenW > 0 && layer.frame->screenH > 0) {
+            m_sources[m_dirty[k]] = FrameConverter::rgbaView(layer.frame.get(), m_converted[m_dirty[k]]);
+        }
+    };
+    parallelFor((int) m_dirty.size(), convert);
+    m_maps.resize(count);
+    for (int i : m_dirty) {
+        if (m_sources[i]) {
+            image_scale_map_init(m_maps[i], m_sources[i]->screenW, m_sources[i]->screenH, m_layers[i].width,
+                                 m_layers[i].height, 4, m_config.filter);
+        }
+    }
+
+    const int tileRows = std::max(m_config.tileRows, 1);
+    if (!sameLayout) {
+        m_stats.fullRedraws++;
+        std::function<void(int)> fill = [this, pixels, stride, tileRows](int band) {
+            int row = band * tileRows;
+            rgba_fill_rect(pixels + (size_t) row * stride, stride, m_config.width,
+                           std::min(tileRows, m_config.height - row), m_config.backgroundColor);
+        };
+        parallelFor((m_config.height + tileRows - 1) / tileRows, fill);
+    }
+
+    std::function<void(int)> draw = [this, pixels](int t) { drawTile(m_tiles[t], pixels); };
+    m_tiles.clear();
+    for (size_t k = 0; k < m_dirty.size(); k++) {
+        int i = m_dirty[k];
+        for (int row = 0; row < m_layers[i].height; row += tileRows) {
+            m_tiles.push_back({i, row, std::min(row + tileRows, m_layers[i].height)});
+        }
+        // Overlapping layers go one at a time, in order
+        if (overlap || k + 1 == m_dirty.size()) {
+            m_stats.tiles += m_tiles.size();
+            parallelFor((int) m_tiles.size(), draw);
+            m_tiles.clear();
+        }
+    }
+
+    canvas->drawn = m_placed;
+    canvas->valid = true;
+    canvas->composedAt = ++m_composeCount;
+    m_stats.frames++;
+
+    // Do not keep frames alive until the next compose
+    m_layers.clear();
+    m_sources.clear();
+    m_converted.clear();
+    return handle;
+}
+
+CompositorEngine::Canvas* CompositorEngine::acquireCanvas(std::shared_ptr<uint8_t>& handle) {
+    std::shared_ptr<CanvasRing> ring = m_ring;
+    std::lock_guard<std::mutex> lock(ring->mutex);
+
+    // The most recently composed free canvas needs the fewest layers redrawn
+    Canvas* canvas = nullptr;
+    for (const std::unique_ptr<Canvas>& candidate : ring->canvases) {
+        if (!candidate->inUse && (!canvas || candidate->composedAt > canvas->composedAt)) {
+            canvas = candidate.get();
+        }
+    }
+    if (!canvas) {
+        if ((int) ring->canvases.size() >= m_config.maxCanvases || m_config.width <= 0 || m_config.height <= 0) {
+            return nullptr;
+        }
+        std::unique_ptr<Canvas> created(new Canvas());
+        created->pixels.reset(new uint8_t[(size_t) m_config.width * m_config.height * 4]);
+        created->valid = false;
+        created->inUse = false;
+        created->composedAt = 0;
+        canvas = created.get();
+        ring->canvases.push_back(std::move(created));
+    }
+
+    canvas->inUse = true;
+    handle = std::shared_ptr<uint8_t>(canvas->pixels.get(), [ring, canvas](uint8_t*) {
+        std::lock_guard<std::mutex> lock(ring->mutex);
+        canvas->inUse = false;
+    });
+    return canvas;
+}
+
+bool CompositorEngine::fitsCanvas(const Layer& layer) const {
+    return layer.width > 0 && layer.height > 0 && layer.x >= 0 && layer.y >= 0 &&
+           layer.x + layer.width <= m_config.width && layer.y + layer.height <= m_config.height;
+}
+
+void CompositorEngine::drawTile(const Tile& tile, uint8_t* canvas) {
+    const Layer& layer = m_layers[tile.layer];
+    const int stride = m_config.width * 4;
+    uint8_t* dst = canvas + (size_t) layer.y * stride + (size_t) layer.x * 4;
+    const frame_data_t* src = m_sources[tile.layer];
+    if (!src) {
+        rgba_fill_rect(dst + (size_t) tile.rowBegin * stride, stride, layer.width, tile.rowEnd - tile.rowBegin,
+                       m_config.backgroundColor);
+        return;
+    }
+    image_scale_rows(m_maps[tile.layer], reinterpret_cast<const uint8_t*>(src->data.get()),
+                     FrameConverter::rowStride(*src), dst, stride, tile.rowBegin, tile.rowEnd);
+}
+
+// ---------------------------------------------------------------------------
+// Worker pool: one batch at a time, tasks claimed through an atomic counter
+
+void CompositorEngine::startWorkers(int count) {
+    m_stopping = false;
+    for (int i = 0; i < count; i++) {
+        m_workers.emplace_back(&CompositorEngine::workerLoop, this);
+    }
+}
+
+void CompositorEngine::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(m_poolMutex);
+        m_stopping = true;
+    }
+    m_poolCv.notify_all();
+    for (std::thread& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    m_workers.clear();
+}
+
+void CompositorEngine::workerLoop() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(m_poolMutex);
+    while (true) {
+        m_poolCv.wait(lock, [this, &seen] { return m_stopping || m_batch != seen; });
+        if (m_stopping) {
+            return;
+        }
+        seen = m_batch;
+        if (!m_task) {
+            continue;
+        }
+        const std::function<void(int)>* task = m_task;
+        int count = m_taskCount;
+        m_activeWorkers++;
+        lock.unlock();
+        runTasks(task, count);
+        lock.lock();
+        if (--m_activeWorkers == 0) {
+            m_doneCv.notify_all();
+        }
+    }
+}
+
+void CompositorEngine::runTasks(const std::function<void(int)>* task, int count) {
+    for (int i = m_nextTask.fetch_add(1); i < count; i = m_nextTask.fetch_add(1)) {
+        (*task)(i);
+    }
+}
+
+void CompositorEngine::parallelFor(int count, const std::function<void(int)>& task) {
+    if (count <= 0) {
+        return;
+    }
+    if (m_workers.empty() || count == 1) {
+        for (int i = 0; i < count; i++) {
+            task(i);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_poolMutex);
+        m_task = &task;
+        m_taskCount = count;
+        m_nextTask = 0;
+        m_batch++;
+    }
+    m_poolCv.notify_all();
+    runTasks(&task, count);
+
+    // Every task is claimed; wait for the workers still running one
+    std::unique_lock<std::mutex> lock(m_poolMutex);
+    m_doneCv.wait(lock, [this] { return m_activeWorkers == 0; });
+    m_task = nullptr;
+}
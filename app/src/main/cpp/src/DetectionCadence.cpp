@@ -0,0 +1,52 @@
+#include "DetectionCadence.h"
+
+#include <algorithm>
+
+DetectionCadence::DetectionCadence(const Config& config)
+        : m_config(config), m_motion(0.0f), m_sinceDetect(-1), m_stats() {
+    m_stats.interval = std::max(config.interval, 1);
+}
+
+void DetectionCadence::setConfig(const Config& config) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = config;
+}
+
+bool DetectionCadence::shouldDetect(float load) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int interval = m_config.adaptive ? adaptiveIntervalLocked(load) : std::max(m_config.interval, 1);
+    m_stats.frames++;
+    m_stats.interval = interval;
+
+    // A shorter interval (faster motion) takes effect at once; the first frame is always detected
+    if (m_sinceDetect < 0 || m_sinceDetect + 1 >= interval) {
+        m_sinceDetect = 0;
+        m_stats.detected++;
+        return true;
+    }
+    m_sinceDetect++;
+    m_stats.skipped++;
+    return false;
+}
+
+void DetectionCadence::reportMotion(float motion) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_motion = motion;
+}
+
+DetectionCadence::Stats DetectionCadence::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+int DetectionCadence::adaptiveIntervalLocked(float load) const {
+    int maxInterval = std::max(m_config.maxInterval, 1);
+    int interval = maxInterval;
+    if (m_motion > 0.0f && m_config.maxDriftRatio / m_motion < maxInterval) {
+        interval = std::max((int) (m_config.maxDriftRatio / m_motion), 1);
+    }
+    if (load >= m_config.highLoad) {
+        interval = std::min(interval * 2, maxInterval);
+    }
+    return interval;
+}
@@ -111,6 +111,18 @@ bool EnhancedDetectionRenderer::setChannelRenderingMode(int channelIndex, Render
 bool EnhancedDetectionRenderer::renderDetections(int channelIndex, uint8_t* frameData, 
                                                 int width, int height, int stride,
                                                 const std::vector<Detection>& detections) {
+    return renderDetectionsInternal(channelIndex, frameData, width, height, stride, 0, false, detections);
+}
+
+bool EnhancedDetectionRenderer::renderDetectionsNV12(int channelIndex, uint8_t* frameData,
+                                                    int width, int height, int stride, int heightStride,
+                                                    const std::vector<Detection>& detections) {
+    return renderDetectionsInternal(channelIndex, frameData, width, height, stride, heightStride, true, detections);
+}
+
+bool EnhancedDetectionRenderer::renderDetectionsInternal(int channelIndex, uint8_t* frameData,
+                                                        int width, int height, int stride, int heightStride,
+                                                        bool nv12, const std::vector<Detection>& detections) {
     if (!frameData || detections.empty()) {
         return false;
     }
@@ -133,24 +145,23 @@ bool EnhancedDetectionRenderer::renderDetections(int channelIndex, uint8_t* fram
     // Filter detections based on channel configuration and system load
     auto filteredDetections = filterDetectionsForChannel(channelIndex, detections);
     
-    // Choose rendering method based on mode and system state
+    // Choose rendering configuration based on mode and system state
+    ViewportRenderConfig renderConfig = state->config;
     if (adaptiveRenderingEnabled.load() && state->mode == ADAPTIVE) {
-        DrawDetectionsAdaptive(frameData, width, height, stride, filteredDetections,
-                              channelIndex, state->isActive, currentSystemLoad.load());
+        renderConfig = calculateAdaptiveConfig(width, height, state->isActive, currentSystemLoad.load());
     } else if (state->mode == MINIMAL || state->mode == PERFORMANCE_FIRST) {
         // Use minimal rendering configuration
-        ViewportRenderConfig minimalConfig = state->config;
-        minimalConfig.showConfidenceInSmallViewport = false;
-        minimalConfig.showClassNamesInSmallViewport = state->isActive;
-        minimalConfig.minBoxThickness = 1;
-        minimalConfig.maxBoxThickness = 2;
-        
-        DrawDetectionsOnRGBAViewportOptimized(frameData, width, height, stride, 
-                                            filteredDetections, minimalConfig);
+        renderConfig.showConfidenceInSmallViewport = false;
+        renderConfig.showClassNamesInSmallViewport = state->isActive;
+        renderConfig.minBoxThickness = 1;
+        renderConfig.maxBoxThickness = 2;
+    }
+
+    // NV12 frames are drawn in place, before the display-time RGBA conversion
+    if (nv12) {
+        DrawDetectionsOnNV12(frameData, width, height, stride, heightStride, filteredDetections, renderConfig);
     } else {
-        // Full detail rendering
-        DrawDetectionsOnRGBAViewportOptimized(frameData, width, height, stride, 
-                                            filteredDetections, state->config);
+        DrawDetectionsOnRGBAViewportOptimized(frameData, width, height, stride, filteredDetections, renderConfig);
     }
 
     // Update metrics
@@ -0,0 +1,216 @@
+#include "FrameBufferPool.h"
+#include "user_comm.h"
+#include <algorithm>
+
+void FrameBufferDeleter::operator()(char* ptr) const {
+    if (!ptr || owner) return;  // Borrowed: the owner is released with this deleter
+    if (pool) {
+        pool->release(key, ptr, capacity);
+    } else {
+        delete[] ptr;
+    }
+}
+
+std::shared_ptr<FrameBufferPool> FrameBufferPool::create(size_t maxCachedBytes, size_t maxCachedPerKey,
+                                                         size_t maxCachedFrames) {
+    return std::shared_ptr<FrameBufferPool>(new FrameBufferPool(maxCachedBytes, maxCachedPerKey, maxCachedFrames));
+}
+
+std::shared_ptr<FrameBufferPool> FrameBufferPool::shared() {
+    static std::shared_ptr<FrameBufferPool> instance = create();
+    return instance;
+}
+
+FrameBufferPool::FrameBufferPool(size_t maxBytes, size_t maxPerKey, size_t maxFrames)
+    : maxCachedBytes(maxBytes), maxCachedPerKey(maxPerKey), maxCachedFrames(maxFrames),
+      hits(0), misses(0), buffersInUse(0), buffersCached(0), highWaterBuffers(0),
+      bytesInUse(0), bytesCached(0), highWaterBytes(0) {
+}
+
+FrameBufferPool::~FrameBufferPool() {
+    // Outstanding buffers and frames hold a reference, so only idle ones remain here
+    trim();
+}
+
+FrameBuffer FrameBufferPool::acquire(const FrameBufferKey& key, size_t size) {
+    FrameBufferDeleter deleter;
+    deleter.pool = shared_from_this();
+    deleter.key = key;
+
+    char* data = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        auto it = freeBuffers.find(key);
+        if (it != freeBuffers.end()) {
+            auto& cached = it->second;
+            for (size_t i = cached.size(); i-- > 0;) {
+                if (cached[i].capacity >= size) {
+                    data = cached[i].data;
+                    deleter.capacity = cached[i].capacity;
+                    cached.erase(cached.begin() + i);
+                    break;
+                }
+            }
+            if (cached.empty()) {
+                freeBuffers.erase(it);
+            }
+        }
+        if (data) {
+            hits++;
+            buffersCached--;
+            bytesCached -= deleter.capacity;
+        } else {
+            misses++;
+            deleter.capacity = size;
+        }
+        buffersInUse++;
+        bytesInUse += deleter.capacity;
+        highWaterBuffers = std::max(highWaterBuffers, buffersInUse);
+        highWaterBytes = std::max(highWaterBytes, bytesInUse + bytesCached);
+    }
+
+    if (!data) {
+        // Default-initialised: no zero fill, the decoder overwrites the whole frame
+        data = new char[size];
+    }
+    return FrameBuffer(data, deleter);
+}
+
+void FrameBufferPool::release(const FrameBufferKey& key, char* data, size_t capacity) {
+    std::vector<char*> evicted;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        buffersInUse--;
+        bytesInUse -= capacity;
+
+        // Over the byte budget: drop idle buffers of other keys first (e.g. a stream changed resolution)
+        for (auto it = freeBuffers.begin(); it != freeBuffers.end() && bytesCached + capacity > maxCachedBytes;) {
+            if (it->first < key || key < it->first) {
+                for (auto& cached : it->second) {
+                    evicted.push_back(cached.data);
+                    buffersCached--;
+                    bytesCached -= cached.capacity;
+                }
+                it = freeBuffers.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        auto& cached = freeBuffers[key];
+        if (cached.size() < maxCachedPerKey && bytesCached + capacity <= maxCachedBytes) {
+            cached.push_back({data, capacity});
+            buffersCached++;
+            bytesCached += capacity;
+            data = nullptr;
+        } else if (cached.empty()) {
+            freeBuffers.erase(key);
+        }
+    }
+    for (char* buffer : evicted) {
+        delete[] buffer;
+    }
+    delete[] data;
+}
+
+std::shared_ptr<g_frame_data_t> FrameBufferPool::acquireFrame() {
+    g_frame_data_t* frame = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (!freeFrames.empty()) {
+            frame = freeFrames.back();
+            freeFrames.pop_back();
+        }
+    }
+    if (!frame) {
+        frame = new g_frame_data_t();
+    }
+
+    std::shared_ptr<FrameBufferPool> self = shared_from_this();
+    return std::shared_ptr<g_frame_data_t>(frame, [self](g_frame_data_t* f) { self->recycleFrame(f); });
+}
+
+void FrameBufferPool::recycleFrame(g_frame_data_t* frame) {
+    // Releasing the buffer re-enters the pool, so do it before taking the lock.
+    // Assigning (not reset()) also drops the deleter's reference to its pool.
+    frame->data = FrameBuffer();
+    frame->dataSize = 0;
+    frame->screenStride = 0;
+    frame->screenW = 0;
+    frame->screenH = 0;
+    frame->widthStride = 0;
+    frame->heightStride = 0;
+    frame->frameId = 0;
+    frame->frameFormat = 0;
+    frame->pts = -1;
+    frame->readyTimeUs = 0;
+    frame->letterbox = letterbox_geometry_s();
+    frame->detections.clear();
+    frame->hasDetections = false;
+    frame->detectionSkipped = false;
+
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (freeFrames.size() < maxCachedFrames) {
+            freeFrames.push_back(frame);
+            return;
+        }
+    }
+    delete frame;
+}
+
+void FrameBufferPool::trim() {
+    std::map<FrameBufferKey, std::vector<CachedBuffer>> buffers;
+    std::vector<g_frame_data_t*> frames;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        buffers.swap(freeBuffers);
+        frames.swap(freeFrames);
+        buffersCached = 0;
+        bytesCached = 0;
+    }
+    for (auto& pair : buffers) {
+        for (auto& cached : pair.second) {
+            delete[] cached.data;
+        }
+    }
+    for (auto* frame : frames) {
+        delete frame;
+    }
+}
+
+FrameBufferPool::Stats FrameBufferPool::getStats() const {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    Stats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.hitRate = hits + misses > 0 ? static_cast<float>(hits) / (hits + misses) : 0.0f;
+    stats.buffersInUse = buffersInUse;
+    stats.buffersCached = buffersCached;
+    stats.highWaterBuffers = highWaterBuffers;
+    stats.bytesInUse = bytesInUse;
+    stats.bytesResident = bytesInUse + bytesCached;
+    stats.highWaterBytes = highWaterBytes;
+    stats.framesCached = freeFrames.size();
+    return stats;
+}
+
+bool FrameBufferPool::attachTo(ThreadSafeResourceManager& manager, ThreadSafeResourceManager::ResourceType type) {
+    std::weak_ptr<FrameBufferPool> weak = shared_from_this();
+    return manager.attachMemoryPool(type, [weak]() {
+        ThreadSafeResourceManager::MemoryPoolStats result;
+        auto pool = weak.lock();
+        if (!pool) {
+            return result;
+        }
+        Stats stats = pool->getStats();
+        result.totalBlocks = stats.buffersInUse + stats.buffersCached;
+        result.usedBlocks = stats.buffersInUse;
+        result.highWaterMark = stats.highWaterBuffers;
+        result.bytesResident = stats.bytesResident;
+        result.hits = stats.hits;
+        result.misses = stats.misses;
+        result.hitRate = stats.hitRate;
+        return result;
+    });
+}
@@ -0,0 +1,131 @@
+#include "FrameConverter.h"
+#include "FrameBufferPool.h"
+#include "log4c.h"
+#include "rga.h"
+#include "im2d.hpp"
+#include <cstring>
+
+namespace {
+
+inline uint8_t clipU8(int v) {
+    return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// Same fixed-point coefficients as the letterbox NV12 path (process/letterbox.cpp)
+inline void yuvToRGBA(int y, int d, int e, uint8_t* rgba) {
+    int c = 298 * (y - 16);
+    rgba[0] = clipU8((c + 409 * e + 128) >> 8);
+    rgba[1] = clipU8((c - 100 * d - 208 * e + 128) >> 8);
+    rgba[2] = clipU8((c + 516 * d + 128) >> 8);
+    rgba[3] = 255;
+}
+
+bool rgaNV12ToRGBA(const frame_data_t& frame, uint8_t* dst, int dstStride) {
+    if (dstStride % 4 != 0) {
+        return false;
+    }
+    rga_buffer_t src = wrapbuffer_virtualaddr_t(frame.data.get(), frame.screenW, frame.screenH,
+                                                FrameConverter::rowStride(frame), frame.heightStride,
+                                                RK_FORMAT_YCbCr_420_SP);
+    rga_buffer_t dstImg = wrapbuffer_virtualaddr_t(dst, frame.screenW, frame.screenH, dstStride / 4,
+                                                   frame.screenH, RK_FORMAT_RGBA_8888);
+    IM_STATUS status = imcvtcolor(src, dstImg, RK_FORMAT_YCbCr_420_SP, RK_FORMAT_RGBA_8888);
+    if (status != IM_STATUS_SUCCESS) {
+        LOGW("RGA NV12->RGBA failed for frame %d: %s", frame.frameId, imStrError(status));
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+bool FrameConverter::isNV12(const frame_data_t& frame) {
+    return frame.frameFormat == RK_FORMAT_YCbCr_420_SP;
+}
+
+bool FrameConverter::isWritable(const frame_data_t& frame) {
+    return frame.data && !frame.data.get_deleter().borrowed();
+}
+
+int FrameConverter::rowStride(const frame_data_t& frame) {
+    if (isNV12(frame)) {
+        return frame.widthStride > 0 ? frame.widthStride : frame.screenStride;
+    }
+    if (frame.screenStride > 0) {
+        return frame.screenStride;
+    }
+    return frame.screenW * 4;
+}
+
+bool FrameConverter::toRGBA(const frame_data_t& frame, uint8_t* dst, int dstStride, bool useRga) {
+    if (!frame.data || !dst || frame.screenW <= 0 || frame.screenH <= 0 || dstStride < frame.screenW * 4) {
+        return false;
+    }
+
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(frame.data.get());
+    int srcStride = rowStride(frame);
+    if (!isNV12(frame)) {
+        for (int row = 0; row < frame.screenH; row++) {
+            memcpy(dst + row * dstStride, src + row * srcStride, frame.screenW * 4);
+        }
+        return true;
+    }
+
+    if (frame.heightStride < frame.screenH) {
+        LOGE("NV12 frame %d has height stride %d < height %d", frame.frameId, frame.heightStride, frame.screenH);
+        return false;
+    }
+    if (useRga && rgaNV12ToRGBA(frame, dst, dstStride)) {
+        return true;
+    }
+    nv12ToRGBA(src, src + srcStride * frame.heightStride, srcStride, frame.screenW, frame.screenH, dst, dstStride);
+    return true;
+}
+
+void FrameConverter::nv12ToRGBA(const uint8_t* y, const uint8_t* uv, int srcStride, int width, int height,
+                                uint8_t* dst, int dstStride) {
+    for (int row = 0; row < height; row++) {
+        const uint8_t* ys = y + row * srcStride;
+        const uint8_t* uvs = uv + (row / 2) * srcStride;
+        uint8_t* out = dst + row * dstStride;
+        for (int col = 0; col < width; col++) {
+            int pair = col & ~1;
+            yuvToRGBA(ys[col], uvs[pair] - 128, uvs[pair + 1] - 128, out + col * 4);
+        }
+    }
+}
+
+const frame_data_t* FrameConverter::rgbaView(const frame_data_t* frame, std::shared_ptr<frame_data_t>& converted,
+                                             bool useRga) {
+    if (!frame || !isNV12(*frame)) {
+        return frame;
+    }
+
+    // 只有仍需要RGBA像素的消费者才走这里，缓冲取自帧缓冲池
+    std::shared_ptr<FrameBufferPool> pool = FrameBufferPool::shared();
+    int stride = frame->screenW * 4;
+    size_t size = static_cast<size_t>(stride) * frame->screenH;
+    FrameBuffer buffer = pool->acquire(FrameBufferKey(frame->screenW, frame->screenH, RK_FORMAT_RGBA_8888, stride),
+                                       size);
+    if (!toRGBA(*frame, reinterpret_cast<uint8_t*>(buffer.get()), stride, useRga)) {
+        return nullptr;
+    }
+
+    converted = pool->acquireFrame();
+    converted->data = std::move(buffer);
+    converted->dataSize = size;
+    converted->screenStride = stride;
+    converted->screenW = frame->screenW;
+    converted->screenH = frame->screenH;
+    converted->widthStride = frame->screenW;
+    converted->heightStride = frame->screenH;
+    converted->frameId = frame->frameId;
+    converted->frameFormat = RK_FORMAT_RGBA_8888;
+    converted->pts = frame->pts;
+    converted->readyTimeUs = frame->readyTimeUs;
+    converted->letterbox = frame->letterbox;
+    converted->detections = frame->detections;
+    converted->hasDetections = frame->hasDetections;
+    converted->detectionSkipped = frame->detectionSkipped;
+    return converted.get();
+}
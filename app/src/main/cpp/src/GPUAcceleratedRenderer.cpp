@@ -1,5 +1,6 @@
 #define DISABLE_CUDA_SUPPORT 1
 #include "GPUAcceleratedRenderer.h"
+#include "image_kernels.h"
 #include "logging.h"
 #include <algorithm>
 
@@ -201,12 +202,14 @@ bool GPUAcceleratedRenderer::scaleFrame(const uint8_t* srcData, int srcWidth, in
             
         } else {
             // CPU fallback
-            success = fallbackToCPU(SCALING, "GPU acceleration not available or not optimal");
+            success = fallbackToCPU(SCALING, "GPU acceleration not available or not optimal") &&
+                      scaleFrameCPU(srcData, srcWidth, srcHeight, srcStride, dstData, dstWidth, dstHeight, dstStride);
         }
         
     } catch (const std::exception& e) {
         LOGE("GPU scaling failed: %s", e.what());
-        success = fallbackToCPU(SCALING, e.what());
+        success = fallbackToCPU(SCALING, e.what()) &&
+                  scaleFrameCPU(srcData, srcWidth, srcHeight, srcStride, dstData, dstWidth, dstHeight, dstStride);
     }
     
     activeOperations.fetch_sub(1);
@@ -343,12 +346,14 @@ bool GPUAcceleratedRenderer::blendFrames(const uint8_t* src1Data, const uint8_t*
             
         } else {
             // CPU fallback
-            success = fallbackToCPU(BLENDING, "GPU acceleration not available or not optimal");
+            success = fallbackToCPU(BLENDING, "GPU acceleration not available or not optimal") &&
+                      blendFramesCPU(src1Data, src2Data, width, height, stride, dstData, alpha);
         }
         
     } catch (const std::exception& e) {
         LOGE("GPU blending failed: %s", e.what());
-        success = fallbackToCPU(BLENDING, e.what());
+        success = fallbackToCPU(BLENDING, e.what()) &&
+                  blendFramesCPU(src1Data, src2Data, width, height, stride, dstData, alpha);
     }
     
     activeOperations.fetch_sub(1);
@@ -453,8 +458,8 @@ bool GPUAcceleratedRenderer::fallbackToCPU(OperationType operation, const std::s
     // Implement CPU fallback for each operation type
     switch (operation) {
         case SCALING:
-            // TODO: Implement CPU scaling
-            return false;
+            // scaleFrameCPU
+            return config.fallbackToCPU;
         case ROTATION:
             // TODO: Implement CPU rotation
             return false;
@@ -462,8 +467,8 @@ bool GPUAcceleratedRenderer::fallbackToCPU(OperationType operation, const std::s
             // TODO: Implement CPU color conversion
             return false;
         case BLENDING:
-            // TODO: Implement CPU blending
-            return false;
+            // blendFramesCPU
+            return config.fallbackToCPU;
         case COMPOSITION:
             // TODO: Implement CPU composition
             return false;
@@ -472,6 +477,29 @@ bool GPUAcceleratedRenderer::fallbackToCPU(OperationType operation, const std::s
     }
 }
 
+bool GPUAcceleratedRenderer::scaleFrameCPU(const uint8_t* srcData, int srcWidth, int srcHeight, int srcStride,
+                                          uint8_t* dstData, int dstWidth, int dstHeight, int dstStride) {
+    if (srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0 ||
+        srcStride < srcWidth * 4 || dstStride < dstWidth * 4) {
+        return false;
+    }
+    image_scale(srcData, srcWidth, srcHeight, srcStride, dstData, dstWidth, dstHeight, dstStride, 4,
+                SCALE_FILTER_BILINEAR);
+    return true;
+}
+
+bool GPUAcceleratedRenderer::blendFramesCPU(const uint8_t* src1Data, const uint8_t* src2Data,
+                                           int width, int height, int stride, uint8_t* dstData, float alpha) {
+    if (width <= 0 || height <= 0 || stride < width * 4) {
+        return false;
+    }
+    // Same weights as the CUDA path: src1 * alpha + src2 * (1 - alpha)
+    float weight = std::max(0.0f, std::min(alpha, 1.0f));
+    rgba_mix(src1Data, stride, src2Data, stride, dstData, stride, width, height,
+             static_cast<uint8_t>(weight * 255.0f + 0.5f));
+    return true;
+}
+
 // Performance monitoring methods
 float GPUAcceleratedRenderer::getGpuUtilization() const {
     // Simplified GPU utilization calculation
@@ -1,10 +1,11 @@
 #include "MultiChannelFrameCompositor.h"
+#include "FrameConverter.h"
 #include <algorithm>
 #include <cstring>
 #include <cmath>
 
 MultiChannelFrameCompositor::MultiChannelFrameCompositor()
-    : compositionRunning(false), eventListener(nullptr), 
+    : compositionRunning(false), engine(engineConfig(CompositionConfig())), eventListener(nullptr), 
       gpuAccelerationEnabled(false), gpuContext(nullptr) {
     
     // Initialize default configuration
@@ -32,8 +33,8 @@ bool MultiChannelFrameCompositor::initialize(const CompositionConfig& newConfig)
     
     config = newConfig;
     
-    // Initialize buffer pool
-    initializeBufferPool();
+    // Canvas ring and tile workers for unified composition
+    engine.configure(engineConfig(config));
     
     // Initialize GPU acceleration if enabled
     if (config.mode == UNIFIED_COMPOSITION || config.mode == HYBRID_COMPOSITION) {
@@ -59,9 +60,6 @@ void MultiChannelFrameCompositor::cleanup() {
         cleanupGpuAcceleration();
     }
     
-    // Cleanup buffer pool
-    cleanupBufferPool();
-    
     // Clear queues
     {
         std::lock_guard<std::mutex> lock(inputQueueMutex);
@@ -138,6 +136,7 @@ bool MultiChannelFrameCompositor::removeChannel(int channelIndex) {
     
     channelViewports.erase(it);
     latestChannelFrames.erase(channelIndex);
+    channelFrameSequence.erase(channelIndex);
     
     LOGD("Removed channel %d from compositor", channelIndex);
     return true;
@@ -153,6 +152,7 @@ bool MultiChannelFrameCompositor::submitChannelFrame(int channelIndex, std::shar
     {
         std::lock_guard<std::mutex> lock(channelsMutex);
         latestChannelFrames[channelIndex] = frameData;
+        channelFrameSequence[channelIndex]++;
     }
     
     // Add to input queue for processing
@@ -259,55 +259,53 @@ bool MultiChannelFrameCompositor::composeIndividualSurfaces() {
 }
 
 bool MultiChannelFrameCompositor::composeUnifiedFrame() {
-    // Create a single composite frame containing all visible channels
-    
-    auto compositeBuffer = acquireBuffer();
-    if (!compositeBuffer) {
-        LOGE("Failed to acquire composite buffer");
+    // Create a single composite frame containing all visible channels. The engine reuses a canvas
+    // and redraws only the viewports whose channel submitted a frame since that canvas was drawn.
+    CompositeFrame compositeFrame;
+    std::vector<CompositorEngine::Layer> layers;
+    {
+        // The latest frame of each channel is already in latestChannelFrames; drain the queue so the
+        // composition loop sleeps until the next submit instead of recomposing unchanged frames
+        std::lock_guard<std::mutex> inputLock(inputQueueMutex);
+        std::queue<std::pair<int, std::shared_ptr<frame_data_t>>>().swap(inputQueue);
+    }
+    {
+        std::lock_guard<std::mutex> lock(channelsMutex);
+        layers.reserve(channelViewports.size());
+        for (const auto& pair : channelViewports) {
+            int channelIndex = pair.first;
+            const ChannelViewport& viewport = pair.second;
+            if (!viewport.visible) continue;
+
+            CompositorEngine::Layer layer;
+            layer.id = channelIndex;
+            layer.x = viewport.x;
+            layer.y = viewport.y;
+            layer.width = viewport.width;
+            layer.height = viewport.height;
+
+            // Viewports without a frame yet show the background
+            auto it = latestChannelFrames.find(channelIndex);
+            if (it != latestChannelFrames.end() && it->second && it->second->data) {
+                layer.frame = it->second;
+                layer.sequence = channelFrameSequence[channelIndex];
+                compositeFrame.includedChannels.push_back(channelIndex);
+            }
+            layers.push_back(layer);
+        }
+    }
+
+    compositeFrame.data = engine.compose(layers);
+    if (!compositeFrame.data) {
+        // Every canvas is still held by consumers of earlier composite frames
+        metrics.framesDropped++;
         return false;
     }
-    
-    // Clear background
-    int bufferSize = calculateBufferSize(config.outputWidth, config.outputHeight, config.outputFormat);
-    clearBuffer(compositeBuffer.get(), bufferSize, config.backgroundColor);
-    
-    CompositeFrame compositeFrame;
-    compositeFrame.data = compositeBuffer;
     compositeFrame.width = config.outputWidth;
     compositeFrame.height = config.outputHeight;
-    compositeFrame.stride = config.outputWidth * 4; // Assuming RGBA
+    compositeFrame.stride = config.outputWidth * 4; // RGBA
     compositeFrame.format = config.outputFormat;
     
-    // Compose all visible channels
-    std::lock_guard<std::mutex> lock(channelsMutex);
-    
-    for (const auto& pair : channelViewports) {
-        int channelIndex = pair.first;
-        const ChannelViewport& viewport = pair.second;
-        
-        if (!viewport.visible) continue;
-        
-        auto it = latestChannelFrames.find(channelIndex);
-        if (it == latestChannelFrames.end()) continue;
-        
-        auto frameData = it->second;
-        if (!frameData || !frameData->data) continue;
-        
-        // Scale and blend channel frame into composite
-        if (config.enableScaling) {
-            if (gpuAccelerationEnabled) {
-                gpuScaleFrame(frameData.get(), compositeBuffer.get(), viewport);
-            } else {
-                scaleFrame(frameData.get(), compositeBuffer.get(), viewport);
-            }
-        } else {
-            // Direct copy without scaling
-            copyFrameData(frameData.get(), compositeBuffer.get(), compositeFrame.stride);
-        }
-        
-        compositeFrame.includedChannels.push_back(channelIndex);
-    }
-    
     // Add to output queue
     {
         std::lock_guard<std::mutex> outputLock(outputQueueMutex);
@@ -408,69 +406,23 @@ void MultiChannelFrameCompositor::calculateViewportsForLayout(LayoutMode layout)
          layout, rows, cols, cellWidth, cellHeight);
 }
 
-std::shared_ptr<uint8_t> MultiChannelFrameCompositor::acquireBuffer() {
-    std::lock_guard<std::mutex> lock(bufferPoolMutex);
-    
-    if (!bufferPool.empty()) {
-        auto buffer = bufferPool.back();
-        bufferPool.pop_back();
-        return buffer;
-    }
-    
-    // Create new buffer if pool is empty
-    int bufferSize = calculateBufferSize(config.outputWidth, config.outputHeight, config.outputFormat);
-    auto buffer = std::shared_ptr<uint8_t>(new uint8_t[bufferSize], std::default_delete<uint8_t[]>());
-    
-    return buffer;
-}
-
-void MultiChannelFrameCompositor::releaseBuffer(std::shared_ptr<uint8_t> buffer) {
-    if (!buffer) return;
-    
-    std::lock_guard<std::mutex> lock(bufferPoolMutex);
-    
-    if (bufferPool.size() < BUFFER_POOL_SIZE) {
-        bufferPool.push_back(buffer);
-    }
-    // If pool is full, buffer will be automatically deleted when shared_ptr goes out of scope
-}
-
-void MultiChannelFrameCompositor::initializeBufferPool() {
-    std::lock_guard<std::mutex> lock(bufferPoolMutex);
-    
-    bufferPool.clear();
-    bufferPool.reserve(BUFFER_POOL_SIZE);
-    
-    int bufferSize = calculateBufferSize(config.outputWidth, config.outputHeight, config.outputFormat);
-    
-    for (int i = 0; i < BUFFER_POOL_SIZE; i++) {
-        auto buffer = std::shared_ptr<uint8_t>(new uint8_t[bufferSize], std::default_delete<uint8_t[]>());
-        bufferPool.push_back(buffer);
-    }
-    
-    LOGD("Initialized buffer pool with %d buffers of %d bytes each", BUFFER_POOL_SIZE, bufferSize);
-}
-
-void MultiChannelFrameCompositor::cleanupBufferPool() {
-    std::lock_guard<std::mutex> lock(bufferPoolMutex);
-    bufferPool.clear();
-    LOGD("Buffer pool cleaned up");
-}
-
 int MultiChannelFrameCompositor::calculateBufferSize(int width, int height, int format) const {
     int bytesPerPixel = 4; // Assuming RGBA format
     return width * height * bytesPerPixel;
 }
 
-void MultiChannelFrameCompositor::clearBuffer(uint8_t* buffer, int size, uint32_t color) {
-    if (!buffer) return;
-    
-    uint32_t* pixels = reinterpret_cast<uint32_t*>(buffer);
-    int pixelCount = size / 4;
-    
-    for (int i = 0; i < pixelCount; i++) {
-        pixels[i] = color;
+CompositorEngine::Config MultiChannelFrameCompositor::engineConfig(const CompositionConfig& config) {
+    CompositorEngine::Config engineConfig;
+    engineConfig.width = config.outputWidth;
+    engineConfig.height = config.outputHeight;
+    engineConfig.backgroundColor = config.backgroundColor;
+    // Nearest copies rows as is when a viewport matches its source size
+    engineConfig.filter = config.enableScaling ? SCALE_FILTER_BILINEAR : SCALE_FILTER_NEAREST;
+    // Tile workers are only needed when frames are composed into one buffer
+    if (config.mode == INDIVIDUAL_SURFACES) {
+        engineConfig.workerThreads = 0;
     }
+    return engineConfig;
 }
 
 bool MultiChannelFrameCompositor::validateViewport(const ChannelViewport& viewport) const {
@@ -506,39 +458,20 @@ bool MultiChannelFrameCompositor::scaleFrame(const frame_data_t* src, uint8_t* d
         return false;
     }
 
-    // Simple bilinear scaling implementation
-    uint8_t* srcData = reinterpret_cast<uint8_t*>(src->data.get());
-    int srcWidth = src->screenW;
-    int srcHeight = src->screenH;
-    int dstWidth = viewport.width;
-    int dstHeight = viewport.height;
-
-    float xRatio = static_cast<float>(srcWidth) / dstWidth;
-    float yRatio = static_cast<float>(srcHeight) / dstHeight;
-
-    // Calculate destination offset
-    uint8_t* dstPtr = dst + (viewport.y * config.outputWidth + viewport.x) * 4;
-
-    for (int y = 0; y < dstHeight; y++) {
-        for (int x = 0; x < dstWidth; x++) {
-            int srcX = static_cast<int>(x * xRatio);
-            int srcY = static_cast<int>(y * yRatio);
-
-            // Clamp to source bounds
-            srcX = std::min(srcX, srcWidth - 1);
-            srcY = std::min(srcY, srcHeight - 1);
-
-            // Copy pixel (assuming RGBA format)
-            uint8_t* srcPixel = srcData + (srcY * srcWidth + srcX) * 4;
-            uint8_t* dstPixel = dstPtr + (y * config.outputWidth + x) * 4;
-
-            dstPixel[0] = srcPixel[0]; // R
-            dstPixel[1] = srcPixel[1]; // G
-            dstPixel[2] = srcPixel[2]; // B
-            dstPixel[3] = srcPixel[3]; // A
-        }
+    // Composition reads RGBA pixels; NV12 frames are converted here
+    std::shared_ptr<frame_data_t> rgbaFrame;
+    src = FrameConverter::rgbaView(src, rgbaFrame);
+    if (!src) {
+        return false;
     }
 
+    // Nearest-neighbour scale of the whole viewport; unified frames go through the engine instead
+    int dstStride = config.outputWidth * 4;
+    uint8_t* dstPtr = dst + viewport.y * dstStride + viewport.x * 4;
+    image_scale(reinterpret_cast<const uint8_t*>(src->data.get()), src->screenW, src->screenH,
+                FrameConverter::rowStride(*src), dstPtr, viewport.width, viewport.height, dstStride, 4,
+                SCALE_FILTER_NEAREST);
+
     return true;
 }
 
@@ -547,34 +480,29 @@ bool MultiChannelFrameCompositor::blendFrame(const frame_data_t* src, uint8_t* d
         return false;
     }
 
-    uint8_t* srcData = reinterpret_cast<uint8_t*>(src->data.get());
-    int srcWidth = src->screenW;
-    int srcHeight = src->screenH;
-
-    // Calculate scaling factors
-    float xScale = static_cast<float>(srcWidth) / viewport.width;
-    float yScale = static_cast<float>(srcHeight) / viewport.height;
-
-    uint8_t alphaValue = static_cast<uint8_t>(alpha * 255);
-    uint8_t invAlpha = 255 - alphaValue;
+    std::shared_ptr<frame_data_t> rgbaFrame;
+    src = FrameConverter::rgbaView(src, rgbaFrame);
+    if (!src) {
+        return false;
+    }
 
-    for (int y = 0; y < viewport.height; y++) {
-        for (int x = 0; x < viewport.width; x++) {
-            int srcX = static_cast<int>(x * xScale);
-            int srcY = static_cast<int>(y * yScale);
+    if (viewport.width <= 0 || viewport.height <= 0 || viewport.x < 0 || viewport.y < 0 ||
+        viewport.x + viewport.width > config.outputWidth || viewport.y + viewport.height > config.outputHeight) {
+        return false;
+    }
 
-            if (srcX >= srcWidth || srcY >= srcHeight) continue;
+    // Scale into a per-thread scratch viewport, then premultiplied source-over onto the output
+    static thread_local std::vector<uint8_t> scaled;
+    int scaledStride = viewport.width * 4;
+    scaled.resize(static_cast<size_t>(scaledStride) * viewport.height);
+    image_scale(reinterpret_cast<const uint8_t*>(src->data.get()), src->screenW, src->screenH,
+                FrameConverter::rowStride(*src), scaled.data(), viewport.width, viewport.height, scaledStride, 4,
+                config.enableScaling ? SCALE_FILTER_BILINEAR : SCALE_FILTER_NEAREST);
 
-            uint8_t* srcPixel = srcData + (srcY * srcWidth + srcX) * 4;
-            uint8_t* dstPixel = dst + ((viewport.y + y) * config.outputWidth + (viewport.x + x)) * 4;
-
-            // Alpha blending
-            dstPixel[0] = (srcPixel[0] * alphaValue + dstPixel[0] * invAlpha) / 255;
-            dstPixel[1] = (srcPixel[1] * alphaValue + dstPixel[1] * invAlpha) / 255;
-            dstPixel[2] = (srcPixel[2] * alphaValue + dstPixel[2] * invAlpha) / 255;
-            dstPixel[3] = std::max(srcPixel[3], dstPixel[3]); // Max alpha
-        }
-    }
+    int dstStride = config.outputWidth * 4;
+    uint8_t opacity = static_cast<uint8_t>(std::min(alpha, 1.0f) * 255.0f + 0.5f);
+    rgba_blend_over(scaled.data(), scaledStride, dst + viewport.y * dstStride + viewport.x * 4, dstStride,
+                    viewport.width, viewport.height, opacity);
 
     return true;
 }
@@ -584,10 +512,16 @@ bool MultiChannelFrameCompositor::copyFrameData(const frame_data_t* src, uint8_t
         return false;
     }
 
+    std::shared_ptr<frame_data_t> rgbaFrame;
+    src = FrameConverter::rgbaView(src, rgbaFrame);
+    if (!src) {
+        return false;
+    }
+
     uint8_t* srcData = reinterpret_cast<uint8_t*>(src->data.get());
     int srcWidth = src->screenW;
     int srcHeight = src->screenH;
-    int srcStride = srcWidth * 4; // Assuming RGBA
+    int srcStride = FrameConverter::rowStride(*src);
 
     int copyWidth = std::min(srcWidth * 4, dstStride);
     int copyHeight = std::min(srcHeight, config.outputHeight);
@@ -632,6 +566,7 @@ void MultiChannelFrameCompositor::setCompositionMode(CompositionMode mode) {
 
     if (config.mode != mode) {
         config.mode = mode;
+        engine.configure(engineConfig(config));
         LOGD("Composition mode changed to %d", mode);
     }
 }
@@ -713,59 +648,32 @@ bool MultiChannelFrameCompositor::gpuBlendFrame(const frame_data_t* src, uint8_t
 // FrameCompositionUtils implementation
 bool FrameCompositionUtils::bilinearScale(const uint8_t* src, uint8_t* dst,
                                          int srcW, int srcH, int dstW, int dstH, int channels) {
-    if (!src || !dst || srcW <= 0 || srcH <= 0 || dstW <= 0 || dstH <= 0) {
-        return false;
-    }
-
-    float xRatio = static_cast<float>(srcW) / dstW;
-    float yRatio = static_cast<float>(srcH) / dstH;
-
-    for (int y = 0; y < dstH; y++) {
-        for (int x = 0; x < dstW; x++) {
-            float srcX = x * xRatio;
-            float srcY = y * yRatio;
-
-            int x1 = static_cast<int>(srcX);
-            int y1 = static_cast<int>(srcY);
-            int x2 = std::min(x1 + 1, srcW - 1);
-            int y2 = std::min(y1 + 1, srcH - 1);
-
-            float dx = srcX - x1;
-            float dy = srcY - y1;
-
-            for (int c = 0; c < channels; c++) {
-                float p1 = src[(y1 * srcW + x1) * channels + c];
-                float p2 = src[(y1 * srcW + x2) * channels + c];
-                float p3 = src[(y2 * srcW + x1) * channels + c];
-                float p4 = src[(y2 * srcW + x2) * channels + c];
-
-                float interpolated = p1 * (1 - dx) * (1 - dy) +
-                                   p2 * dx * (1 - dy) +
-                                   p3 * (1 - dx) * dy +
-                                   p4 * dx * dy;
+    return bilinearScale(src, srcW * channels, dst, dstW * channels, srcW, srcH, dstW, dstH, channels);
+}
 
-                dst[(y * dstW + x) * channels + c] = static_cast<uint8_t>(interpolated);
-            }
-        }
+bool FrameCompositionUtils::bilinearScale(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride,
+                                         int srcW, int srcH, int dstW, int dstH, int channels) {
+    if (!src || !dst || srcW <= 0 || srcH <= 0 || dstW <= 0 || dstH <= 0 || channels < 1 || channels > 4 ||
+        srcStride < srcW * channels || dstStride < dstW * channels) {
+        return false;
     }
 
+    image_scale(src, srcW, srcH, srcStride, dst, dstW, dstH, dstStride, channels, SCALE_FILTER_BILINEAR);
     return true;
 }
 
 bool FrameCompositionUtils::alphaBlend(const uint8_t* src, uint8_t* dst, int width, int height, float alpha) {
-    if (!src || !dst || alpha < 0.0f || alpha > 1.0f) {
-        return false;
-    }
-
-    uint8_t alphaValue = static_cast<uint8_t>(alpha * 255);
-    uint8_t invAlpha = 255 - alphaValue;
+    return alphaBlend(src, width * 4, dst, width * 4, width, height, alpha);
+}
 
-    for (int i = 0; i < width * height * 4; i += 4) {
-        dst[i] = (src[i] * alphaValue + dst[i] * invAlpha) / 255;         // R
-        dst[i + 1] = (src[i + 1] * alphaValue + dst[i + 1] * invAlpha) / 255; // G
-        dst[i + 2] = (src[i + 2] * alphaValue + dst[i + 2] * invAlpha) / 255; // B
-        dst[i + 3] = std::max(src[i + 3], dst[i + 3]);                   // A
+bool FrameCompositionUtils::alphaBlend(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride,
+                                      int width, int height, float alpha) {
+    if (!src || !dst || alpha < 0.0f || alpha > 1.0f || width <= 0 || height <= 0 ||
+        srcStride < width * 4 || dstStride < width * 4) {
+        return false;
     }
 
+    // Premultiplied source-over; for opaque sources this is the plain src * alpha + dst * (1 - alpha)
+    rgba_blend_over(src, srcStride, dst, dstStride, width, height, static_cast<uint8_t>(alpha * 255.0f + 0.5f));
     return true;
 }
@@ -7,17 +7,13 @@ extern pthread_mutex_t windowMutex;
 
 // MultiChannelZLPlayer implementation
 MultiChannelZLPlayer::MultiChannelZLPlayer(int channelIndex, char* modelFileData, int modelDataLen,
-                                         NativeChannelManager* manager)
-    : ZLPlayer(modelFileData, modelDataLen),
+                                         NativeChannelManager* manager, InferenceScheduler* scheduler,
+                                         MultiSurfaceRenderer* renderer)
+    : ZLPlayer(modelFileData, modelDataLen, scheduler, channelIndex, renderer),
       channelIndex(channelIndex),
       channelManager(manager),
-      channelSurface(nullptr),
       detectionEnabled(true),
-      modelDataSize(0),
-      lastFrameTime(std::chrono::steady_clock::now()),
-      lastRenderTime(std::chrono::steady_clock::now()),
-      frameSkipCounter(0),
-      currentFps(0.0f) {
+      modelDataSize(0) {
 
     // Copy model data for this channel
     if (modelFileData && modelDataLen > 0) {
@@ -37,6 +33,9 @@ MultiChannelZLPlayer::MultiChannelZLPlayer(int channelIndex, char* modelFileData
 MultiChannelZLPlayer::~MultiChannelZLPlayer() {
     LOGD("MultiChannelZLPlayer destroying channel %d", channelIndex);
 
+    // No render thread may present this channel while it is being torn down
+    stopPresenting();
+
     // Cleanup channel resources
     cleanupChannel();
 
@@ -84,28 +83,13 @@ void MultiChannelZLPlayer::setChannelRTSPUrl(const char* url) {
 }
 
 void MultiChannelZLPlayer::setChannelSurface(ANativeWindow* surface) {
-    std::lock_guard<std::mutex> lock(channelMutex);
-
-    // Release previous surface
-    if (channelSurface) {
-        ANativeWindow_release(channelSurface);
-        channelSurface = nullptr;
-    }
-
-    // Set new surface
-    channelSurface = surface;
-    if (surface) {
-        ANativeWindow_acquire(surface);
-        LOGD("Channel %d surface set and acquired", channelIndex);
-    } else {
-        LOGD("Channel %d surface cleared", channelIndex);
-    }
+    ZLPlayer::setChannelSurface(surface);
 }
 
 void MultiChannelZLPlayer::setDetectionEnabled(bool enabled) {
     detectionEnabled.store(enabled); // Atomic store, no lock needed
 
-    if (channelContext && channelContext->yolov5ThreadPool) {
+    if (app_ctx.inferenceScheduler || (channelContext && channelContext->yolov5ThreadPool)) {
         // Channel-specific detection control
         LOGD("Channel %d detection %s", channelIndex, enabled ? "enabled" : "disabled");
 
@@ -116,61 +100,6 @@ void MultiChannelZLPlayer::setDetectionEnabled(bool enabled) {
     }
 }
 
-// Override display method to provide channel-specific rendering
-void MultiChannelZLPlayer::display() {
-    if (!channelContext || !channelContext->renderFrameQueue) {
-        return;
-    }
-
-    // Check if we should process this frame for performance control
-    if (!shouldProcessFrame()) {
-        return;
-    }
-
-    std::unique_lock<std::mutex> lock(channelMutex);
-
-    // Use channel-specific render queue
-    int queueSize = channelContext->renderFrameQueue->size();
-    if (queueSize > 5) {
-        LOGD("Channel %d render queue size: %d", channelIndex, queueSize);
-
-        // If queue is too large, skip some frames to maintain performance
-        adaptiveFrameSkipping();
-    }
-
-    auto frameDataPtr = channelContext->renderFrameQueue->pop();
-    if (frameDataPtr == nullptr) {
-        lock.unlock(); // Unlock before sleeping
-        std::this_thread::sleep_for(std::chrono::milliseconds(5)); // Reduced sleep time
-        return;
-    }
-
-    // Validate frame data before rendering
-    if (!frameDataPtr->data || frameDataPtr->screenW <= 0 || frameDataPtr->screenH <= 0) {
-        LOGE("Channel %d: Invalid frame data: data=%p, w=%d, h=%d",
-             channelIndex, frameDataPtr->data.get(), frameDataPtr->screenW, frameDataPtr->screenH);
-        return;
-    }
-
-    // Check if we should render this frame
-    if (shouldRenderFrame()) {
-        // Render to channel-specific surface
-        if (channelSurface) {
-            renderToChannelSurface(frameDataPtr.get());
-        }
-    }
-
-    lock.unlock(); // Unlock before calling external methods
-
-    // Update frame rate statistics
-    updateFrameRateStats();
-
-    // Notify the channel manager about frame processing
-    if (channelManager) {
-        channelManager->onChannelFrameReceived(channelIndex);
-    }
-}
-
 // Override get_detect_result to provide channel-specific detection handling
 void MultiChannelZLPlayer::get_detect_result() {
     if (!channelContext || !channelContext->yolov5ThreadPool) {
@@ -290,70 +219,6 @@ extern "C" void multi_channel_frame_callback(void* userdata, int width_stride, i
     }
 }
 
-// Helper function to create a channel-specific context
-rknn_app_context_t* createChannelContext(int channelIndex, char* modelData, int modelSize) {
-    rknn_app_context_t* ctx = new rknn_app_context_t();
-    memset(ctx, 0, sizeof(rknn_app_context_t));
-    
-    // TODO: Add channel index to context
-    // ctx->channelIndex = channelIndex;
-    
-    // Initialize YOLOv5 thread pool for this channel
-    ctx->yolov5ThreadPool = new Yolov5ThreadPool();
-    if (ctx->yolov5ThreadPool->setUpWithModelData(10, modelData, modelSize) != NN_SUCCESS) {
-        LOGE("Failed to initialize YOLOv5 thread pool for channel %d", channelIndex);
-        delete ctx->yolov5ThreadPool;
-        delete ctx;
-        return nullptr;
-    }
-    
-    // Initialize render frame queue
-    ctx->renderFrameQueue = new RenderFrameQueue();
-    
-    // Initialize MPP decoder
-    if (!ctx->decoder) {
-        MppDecoder* decoder = new MppDecoder();
-        if (decoder->Init(264, 25, ctx) == 0) {
-            // Set channel-specific callback
-            decoder->SetCallback(multi_channel_frame_callback);
-            ctx->decoder = decoder;
-        } else {
-            LOGE("Failed to initialize MPP decoder for channel %d", channelIndex);
-            delete decoder;
-            delete ctx->renderFrameQueue;
-            delete ctx->yolov5ThreadPool;
-            delete ctx;
-            return nullptr;
-        }
-    }
-    
-    LOGD("Channel context created successfully for channel %d", channelIndex);
-    return ctx;
-}
-
-// Helper function to destroy a channel-specific context
-void destroyChannelContext(rknn_app_context_t* ctx) {
-    if (!ctx) return;
-    
-    if (ctx->yolov5ThreadPool) {
-        ctx->yolov5ThreadPool->stopAll();
-        delete ctx->yolov5ThreadPool;
-        ctx->yolov5ThreadPool = nullptr;
-    }
-    
-    if (ctx->renderFrameQueue) {
-        delete ctx->renderFrameQueue;
-        ctx->renderFrameQueue = nullptr;
-    }
-    
-    if (ctx->decoder) {
-        delete ctx->decoder;
-        ctx->decoder = nullptr;
-    }
-    
-    delete ctx;
-}
-
 // New implementation methods for MultiChannelZLPlayer
 bool MultiChannelZLPlayer::initializeChannel() {
     std::lock_guard<std::mutex> lock(channelMutex);
@@ -364,31 +229,22 @@ bool MultiChannelZLPlayer::initializeChannel() {
         return false;
     }
 
-    // Initialize YOLOv5 thread pool for this channel
-    channelContext->yolov5ThreadPool = new Yolov5ThreadPool();
+    // Inference goes through the shared scheduler registered by the base player;
+    // only build a private pool when running without one
+    channelContext->channelIndex = channelIndex;
+    if (!app_ctx.inferenceScheduler) {
+        channelContext->yolov5ThreadPool = new Yolov5ThreadPool();
 
-    // Use channel-specific model data with smaller thread pool for multi-channel efficiency
-    if (channelContext->yolov5ThreadPool->setUpWithModelData(3, modelData.get(), modelDataSize) != NN_SUCCESS) {
-        LOGE("Failed to initialize YOLOv5 thread pool for channel %d", channelIndex);
-        channelContext.cleanup(); // RAII cleanup
-        return false;
+        // Use channel-specific model data with smaller thread pool for multi-channel efficiency
+        if (channelContext->yolov5ThreadPool->setUpWithModelData(3, modelData.get(), modelDataSize) != NN_SUCCESS) {
+            LOGE("Failed to initialize YOLOv5 thread pool for channel %d", channelIndex);
+            channelContext.cleanup(); // RAII cleanup
+            return false;
+        }
     }
 
-    // Initialize render frame queue
-    channelContext->renderFrameQueue = new RenderFrameQueue();
-
-    // Initialize MPP decoder
-    MppDecoder* decoder = new MppDecoder();
-    if (decoder->Init(264, 25, channelContext.get()) == 0) {
-        // Set channel-specific callback
-        decoder->SetCallback(multi_channel_frame_callback);
-        channelContext->decoder = decoder;
-    } else {
-        LOGE("Failed to initialize MPP decoder for channel %d", channelIndex);
-        delete decoder;
-        channelContext.cleanup(); // RAII cleanup
-        return false;
-    }
+    // Decoding, inference submission and the render queue live on the base player's context (app_ctx);
+    // this context carries no decoder or render queue, so no frame ever passes through it
 
     LOGD("Channel %d initialized successfully", channelIndex);
     return true;
@@ -400,11 +256,7 @@ void MultiChannelZLPlayer::cleanupChannel() {
     // Stop RTSP stream if running
     stopRTSPStream();
 
-    // Release surface
-    if (channelSurface) {
-        ANativeWindow_release(channelSurface);
-        channelSurface = nullptr;
-    }
+    // The surface is released by ~ZLPlayer, after the render pool has let go of this channel
 
     // RAII cleanup handles all context resources automatically
     channelContext.cleanup();
@@ -451,146 +303,3 @@ bool MultiChannelZLPlayer::isChannelActive() const {
     std::lock_guard<std::mutex> lock(channelMutex);
     return channelContext && !channelRtspUrl.empty();
 }
-
-void MultiChannelZLPlayer::renderToChannelSurface(frame_data_t* frameData) {
-    if (!channelSurface || !frameData || !frameData->data) {
-        LOGE("Channel %d: Invalid surface or frame data for rendering", channelIndex);
-        return;
-    }
-
-    // Get frame dimensions
-    int width = frameData->screenW;
-    int height = frameData->screenH;
-
-    if (width <= 0 || height <= 0) {
-        LOGE("Channel %d: Invalid frame dimensions: %dx%d", channelIndex, width, height);
-        return;
-    }
-
-    // Set buffer geometry for this channel's surface
-    if (ANativeWindow_setBuffersGeometry(channelSurface, width, height, WINDOW_FORMAT_RGBA_8888) != 0) {
-        LOGE("Channel %d: Failed to set buffer geometry", channelIndex);
-        return;
-    }
-
-    // Lock the surface buffer
-    ANativeWindow_Buffer windowBuffer;
-    if (ANativeWindow_lock(channelSurface, &windowBuffer, 0) != 0) {
-        LOGE("Channel %d: Failed to lock surface buffer", channelIndex);
-        return;
-    }
-
-    // Copy frame data to surface buffer
-    uint8_t* dstData = (uint8_t*)windowBuffer.bits;
-    uint8_t* srcData = (uint8_t*)frameData->data.get();
-
-    int dstLinesize = windowBuffer.stride * 4; // RGBA_8888 = 4 bytes per pixel
-    int srcLinesize = width * 4; // Assuming RGBA format
-
-    // Copy line by line to handle different strides
-    for (int i = 0; i < height; i++) {
-        memcpy(dstData + i * dstLinesize, srcData + i * srcLinesize, srcLinesize);
-    }
-
-    // Unlock and post the buffer to display
-    if (ANativeWindow_unlockAndPost(channelSurface) != 0) {
-        LOGE("Channel %d: Failed to unlock and post surface buffer", channelIndex);
-        return;
-    }
-
-    // Update channel statistics
-    if (channelManager) {
-        channelManager->onChannelFrameRendered(channelIndex);
-    }
-
-    LOGD("Channel %d: Frame rendered successfully (%dx%d)", channelIndex, width, height);
-}
-
-// Frame rate control implementation
-bool MultiChannelZLPlayer::shouldProcessFrame() {
-    auto currentTime = std::chrono::steady_clock::now();
-    auto timeSinceLastFrame = std::chrono::duration_cast<std::chrono::microseconds>(
-        currentTime - lastFrameTime);
-
-    // Target frame interval for 30 FPS (33.33ms)
-    constexpr auto targetInterval = std::chrono::microseconds(33333);
-
-    // Check if enough time has passed since last frame
-    if (timeSinceLastFrame >= targetInterval) {
-        lastFrameTime = currentTime;
-        return true;
-    }
-
-    // Adaptive frame skipping based on system load
-    int skipCount = frameSkipCounter.load();
-    if (skipCount > 0) {
-        frameSkipCounter.store(skipCount - 1);
-        return false;
-    }
-
-    return timeSinceLastFrame >= targetInterval;
-}
-
-bool MultiChannelZLPlayer::shouldRenderFrame() {
-    auto currentTime = std::chrono::steady_clock::now();
-    auto timeSinceLastRender = std::chrono::duration_cast<std::chrono::microseconds>(
-        currentTime - lastRenderTime);
-
-    // Target render interval for 30 FPS
-    constexpr auto targetRenderInterval = std::chrono::microseconds(33333);
-
-    if (timeSinceLastRender >= targetRenderInterval) {
-        lastRenderTime = currentTime;
-        return true;
-    }
-
-    return false;
-}
-
-void MultiChannelZLPlayer::updateFrameRateStats() {
-    static auto lastStatsUpdate = std::chrono::steady_clock::now();
-    static int frameCountSinceLastUpdate = 0;
-
-    frameCountSinceLastUpdate++;
-
-    auto currentTime = std::chrono::steady_clock::now();
-    auto timeSinceLastStats = std::chrono::duration_cast<std::chrono::milliseconds>(
-        currentTime - lastStatsUpdate);
-
-    // Update stats every second
-    if (timeSinceLastStats >= std::chrono::milliseconds(1000)) {
-        float fps = (frameCountSinceLastUpdate * 1000.0f) / timeSinceLastStats.count();
-        currentFps.store(fps);
-
-        LOGD("Channel %d: Current FPS: %.2f", channelIndex, fps);
-
-        frameCountSinceLastUpdate = 0;
-        lastStatsUpdate = currentTime;
-    }
-}
-
-void MultiChannelZLPlayer::adaptiveFrameSkipping() {
-    float fps = currentFps.load();
-
-    // If FPS is below threshold, increase frame skipping
-    constexpr float MIN_FPS_THRESHOLD = 25.0f;
-    constexpr float TARGET_FPS = 30.0f;
-
-    if (fps < MIN_FPS_THRESHOLD) {
-        // Increase frame skipping
-        int currentSkip = frameSkipCounter.load();
-        if (currentSkip < 3) { // Max skip 3 frames
-            frameSkipCounter.store(currentSkip + 1);
-            LOGD("Channel %d: Increasing frame skip to %d (FPS: %.2f)",
-                 channelIndex, currentSkip + 1, fps);
-        }
-    } else if (fps > TARGET_FPS * 0.95f) {
-        // Reduce frame skipping if performance is good
-        int currentSkip = frameSkipCounter.load();
-        if (currentSkip > 0) {
-            frameSkipCounter.store(currentSkip - 1);
-            LOGD("Channel %d: Reducing frame skip to %d (FPS: %.2f)",
-                 channelIndex, currentSkip - 1, fps);
-        }
-    }
-}
@@ -1,4 +1,6 @@
 #include "MultiStreamDetectionIntegration.h"
+#include "FrameConverter.h"
+#include "cv_draw.h"
 #include <algorithm>
 #include <sstream>
 
@@ -95,6 +97,7 @@ bool MultiStreamDetectionIntegration::addDetectionChannel(int channelIndex,
     detectionConfig.maxDetections = config.maxDetections;
     detectionConfig.enableNMS = config.enableNMS;
     detectionConfig.nmsThreshold = config.nmsThreshold;
+    detectionConfig.nmsMode = config.nmsMode;
     detectionConfig.enabledClasses = config.enabledClasses;
     
     if (!perChannelDetection->addChannel(channelIndex, detectionConfig)) {
@@ -383,6 +386,7 @@ void MultiStreamDetectionIntegration::applyChannelConfig(int channelIndex,
     detectionConfig.maxDetections = config.maxDetections;
     detectionConfig.enableNMS = config.enableNMS;
     detectionConfig.nmsThreshold = config.nmsThreshold;
+    detectionConfig.nmsMode = config.nmsMode;
     detectionConfig.enabledClasses = config.enabledClasses;
     
     perChannelDetection->setChannelConfig(channelIndex, detectionConfig);
@@ -635,8 +639,27 @@ bool DetectionVisualizationManager::visualizeDetections(int channelIndex,
         return false;
     }
 
+    if (!FrameConverter::isWritable(*frameData)) {
+        // Leased decoder buffers may still be reference frames; overlays go on the display buffer instead
+        LOGW("Channel %d: frame %d borrows a decoder buffer, not drawing in place", channelIndex, frameData->frameId);
+        return false;
+    }
+
     auto config = getChannelVisualizationConfig(channelIndex);
 
+    // NV12 frames are drawn in place with the YUV drawer
+    if (FrameConverter::isNV12(*frameData)) {
+        ViewportRenderConfig nv12Config = calculateViewportConfig(frameData->screenW, frameData->screenH, true);
+        nv12Config.showConfidenceInSmallViewport = config.showConfidence;
+        nv12Config.showClassNamesInSmallViewport = config.showClassNames;
+        nv12Config.adaptiveBoxThickness = false;
+        nv12Config.minBoxThickness = static_cast<int>(config.boxThickness);
+        DrawDetectionsOnNV12(reinterpret_cast<uint8_t*>(frameData->data.get()), frameData->screenW,
+                             frameData->screenH, FrameConverter::rowStride(*frameData), frameData->heightStride,
+                             detections, nv12Config);
+        return !detections.empty();
+    }
+
     return drawDetectionsOnFrame(reinterpret_cast<uint8_t*>(frameData->data.get()),
                                frameData->screenW, frameData->screenH,
                                frameData->screenStride, detections, config);
@@ -1,12 +1,52 @@
 #include "MultiSurfaceRenderer.h"
 #include <algorithm>
+#include <limits>
+
+namespace {
+
+// Frames queued with queueFrame() for a window the renderer owns: the newest one is shown at each slot
+class QueuedSurfaceSource : public PresentSource {
+public:
+    explicit QueuedSurfaceSource(MultiSurfaceRenderer::SurfaceInfo& surfaceInfo) : m_surfaceInfo(surfaceInfo) {}
+
+    bool nextFrame(int64_t nowUs, int64_t& timeUs, int& /*droppedFrames*/) override {
+        m_frame = m_surfaceInfo.renderQueue->pop();
+        timeUs = m_frame ? nowUs : nowUs + RENDER_IDLE_POLL_US;
+        return m_frame != nullptr;
+    }
+
+    bool presentFrame() override {
+        std::shared_ptr<frame_data_t> frame = std::move(m_frame);
+        m_frame.reset();
+        if (!frame || !m_surfaceInfo.surface) {
+            return false;
+        }
+        // Copy (RGBA) or convert (NV12) the frame into the locked buffer; the geometry is set on size change
+        if (!m_surfaceInfo.presenter.present(*frame)) {
+            LOGE("Failed to present frame %d on channel %d", frame->frameId, m_surfaceInfo.channelIndex);
+            return false;
+        }
+        return true;
+    }
+
+    void dropFrame() override {
+        m_frame.reset();
+    }
+
+private:
+    MultiSurfaceRenderer::SurfaceInfo& m_surfaceInfo;
+    std::shared_ptr<frame_data_t> m_frame;
+};
+
+} // namespace
 
 MultiSurfaceRenderer::MultiSurfaceRenderer(int maxSurfaces, int threadCount)
-    : maxSurfaces(maxSurfaces), renderThreadCount(threadCount),
-      maxRenderLoad(80.0f), shouldStop(false), eventListener(nullptr),
-      systemRenderLoad(0.0f), activeSurfaceCount(0) {
+    : stolenCount(0), shouldStop(false), systemRenderLoad(0.0f), activeSurfaceCount(0),
+      eventListener(nullptr), maxSurfaces(maxSurfaces), renderThreadCount(std::max(1, threadCount)),
+      maxRenderLoad(80.0f) {
     
-    // Start render threads
+    // Start render threads, each with its own deadline heap
+    renderHeaps.resize(renderThreadCount);
     for (int i = 0; i < renderThreadCount; ++i) {
         renderThreads.emplace_back(&MultiSurfaceRenderer::renderThreadLoop, this, i);
     }
@@ -15,7 +55,7 @@ MultiSurfaceRenderer::MultiSurfaceRenderer(int maxSurfaces, int threadCount)
     performanceMonitorThread = std::thread(&MultiSurfaceRenderer::performanceMonitorLoop, this);
     
     LOGD("MultiSurfaceRenderer initialized with %d max surfaces, %d threads", 
-         maxSurfaces, threadCount);
+         maxSurfaces, renderThreadCount);
 }
 
 MultiSurfaceRenderer::~MultiSurfaceRenderer() {
@@ -28,62 +68,148 @@ bool MultiSurfaceRenderer::addSurface(int channelIndex, ANativeWindow* surface)
         return false;
     }
     
-    auto lock = lockSurfaces();
+    // Create new surface info
+    auto surfaceInfo = std::make_shared<SurfaceInfo>(channelIndex, surface);
+    surfaceInfo->ownSource.reset(new QueuedSurfaceSource(*surfaceInfo));
+    surfaceInfo->source = surfaceInfo->ownSource.get();
     
-    if (surfaces.size() >= static_cast<size_t>(maxSurfaces)) {
-        LOGE("Cannot add surface: maximum surfaces (%d) reached", maxSurfaces);
+    // Get surface properties
+    surfaceInfo->width = ANativeWindow_getWidth(surface);
+    surfaceInfo->height = ANativeWindow_getHeight(surface);
+    surfaceInfo->format = ANativeWindow_getFormat(surface);
+    
+    if (!insertSurface(surfaceInfo)) {
         return false;
     }
     
-    // Remove existing surface if present
-    auto it = surfaces.find(channelIndex);
-    if (it != surfaces.end()) {
-        LOGW("Replacing existing surface for channel %d", channelIndex);
-        removeSurface(channelIndex);
+    LOGD("Added surface for channel %d (%dx%d, format: %d)", channelIndex, surfaceInfo->width,
+         surfaceInfo->height, surfaceInfo->format);
+    return true;
+}
+
+bool MultiSurfaceRenderer::addSource(int channelIndex, PresentSource* source, float targetFps) {
+    if (!source) {
+        LOGE("Cannot add null present source for channel %d", channelIndex);
+        return false;
     }
     
-    // Create new surface info
-    auto surfaceInfo = std::make_unique<SurfaceInfo>(channelIndex, surface);
+    auto surfaceInfo = std::make_shared<SurfaceInfo>(channelIndex, nullptr);
+    surfaceInfo->source = source;
+    surfaceInfo->targetFps = targetFps;
     
-    // Get surface properties
-    int width = ANativeWindow_getWidth(surface);
-    int height = ANativeWindow_getHeight(surface);
-    int format = ANativeWindow_getFormat(surface);
+    if (!insertSurface(surfaceInfo)) {
+        return false;
+    }
     
-    surfaceInfo->width = width;
-    surfaceInfo->height = height;
-    surfaceInfo->format = format;
+    LOGD("Added present source for channel %d (target %.1f fps)", channelIndex, targetFps);
+    return true;
+}
+
+bool MultiSurfaceRenderer::insertSurface(std::shared_ptr<SurfaceInfo> surfaceInfo) {
+    int channelIndex = surfaceInfo->channelIndex;
+    std::shared_ptr<SurfaceInfo> replaced;
+    {
+        auto lock = lockSurfaces();
+        
+        if (surfaces.find(channelIndex) == surfaces.end() && surfaces.size() >= static_cast<size_t>(maxSurfaces)) {
+            LOGE("Cannot add surface: maximum surfaces (%d) reached", maxSurfaces);
+            return false;
+        }
+        
+        // Replace an existing surface for this channel
+        replaced = detachSurface(channelIndex);
+        if (replaced) {
+            LOGW("Replacing existing surface for channel %d", channelIndex);
+        }
+        
+        surfaceInfo->state = ACTIVE;
+        surfaces[channelIndex] = surfaceInfo;
+        activeSurfaceCount++;
+    }
     
-    surfaces[channelIndex] = std::move(surfaceInfo);
-    updateSurfaceState(channelIndex, ACTIVE);
-    activeSurfaceCount++;
+    if (replaced) {
+        retireSurface(replaced);
+    }
+    scheduleSurface(surfaceInfo, PresentationClock::nowUs());
     
     if (eventListener) {
         eventListener->onSurfaceReady(channelIndex);
     }
-    
-    LOGD("Added surface for channel %d (%dx%d, format: %d)", channelIndex, width, height, format);
     return true;
 }
 
 bool MultiSurfaceRenderer::removeSurface(int channelIndex) {
-    auto lock = lockSurfaces();
+    std::shared_ptr<SurfaceInfo> surfaceInfo;
+    {
+        auto lock = lockSurfaces();
+        surfaceInfo = detachSurface(channelIndex);
+    }
+    if (!surfaceInfo) {
+        return false;
+    }
     
+    retireSurface(surfaceInfo);
+    LOGD("Removed surface for channel %d", channelIndex);
+    return true;
+}
+
+std::shared_ptr<MultiSurfaceRenderer::SurfaceInfo> MultiSurfaceRenderer::detachSurface(int channelIndex) {
     auto it = surfaces.find(channelIndex);
     if (it == surfaces.end()) {
-        return false;
+        return nullptr;
     }
     
-    updateSurfaceState(channelIndex, INACTIVE);
+    std::shared_ptr<SurfaceInfo> surfaceInfo = it->second;
     surfaces.erase(it);
+    surfaceInfo->state = INACTIVE;
+    surfaceInfo->removed = true;
     activeSurfaceCount--;
+    return surfaceInfo;
+}
+
+void MultiSurfaceRenderer::retireSurface(const std::shared_ptr<SurfaceInfo>& surfaceInfo) {
+    {
+        std::lock_guard<std::mutex> lock(scheduleMutex);
+        for (auto& heap : renderHeaps) {
+            auto it = std::find_if(heap.begin(), heap.end(), [&surfaceInfo](const ScheduledSurface& entry) {
+                return entry.surface == surfaceInfo;
+            });
+            if (it != heap.end()) {
+                heap.erase(it);
+                std::make_heap(heap.begin(), heap.end(), laterDeadline);
+                break;
+            }
+        }
+    }
+    
+    // A render thread servicing it right now holds surfaceMutex; it will not push the surface back
+    {
+        std::lock_guard<std::mutex> lock(surfaceInfo->surfaceMutex);
+        if (surfaceInfo->hasPending) {
+            surfaceInfo->source->dropFrame();
+            surfaceInfo->hasPending = false;
+        }
+    }
     
     if (eventListener) {
-        eventListener->onSurfaceDestroyed(channelIndex);
+        eventListener->onSurfaceDestroyed(surfaceInfo->channelIndex);
     }
+}
+
+void MultiSurfaceRenderer::scheduleSurface(const std::shared_ptr<SurfaceInfo>& surfaceInfo, int64_t dueUs) {
+    std::lock_guard<std::mutex> lock(scheduleMutex);
     
-    LOGD("Removed surface for channel %d", channelIndex);
-    return true;
+    // New surfaces go to the thread with the fewest; stealing evens out the load from there
+    size_t target = 0;
+    for (size_t i = 1; i < renderHeaps.size(); i++) {
+        if (renderHeaps[i].size() < renderHeaps[target].size()) {
+            target = i;
+        }
+    }
+    std::vector<ScheduledSurface>& heap = renderHeaps[target];
+    heap.push_back(ScheduledSurface{dueUs, surfaceInfo});
+    std::push_heap(heap.begin(), heap.end(), laterDeadline);
+    scheduleCv.notify_all();
 }
 
 bool MultiSurfaceRenderer::queueFrame(int channelIndex, std::shared_ptr<frame_data_t> frameData) {
@@ -94,140 +220,197 @@ bool MultiSurfaceRenderer::queueFrame(int channelIndex, std::shared_ptr<frame_da
     auto lock = lockSurfaces();
     
     SurfaceInfo* surfaceInfo = getSurfaceInfo(channelIndex);
-    if (!surfaceInfo || surfaceInfo->state != ACTIVE) {
+    if (!surfaceInfo || surfaceInfo->state != ACTIVE || !surfaceInfo->ownSource) {
         return false;
     }
     
-    // Check if we should render this frame based on FPS control
-    if (!shouldRenderFrame(surfaceInfo)) {
+    // The render thread picks up the newest frame at the surface's next slot; a frame it never
+    // took is replaced and counted by the queue
+    if (!surfaceInfo->renderQueue->push(frameData)) {
         surfaceInfo->droppedFrames++;
-        return true; // Frame dropped but operation successful
+        return true;
     }
-    
-    // Queue frame for rendering
-    if (surfaceInfo->renderQueue->size() > 5) {
-        // Queue is full, drop oldest frame
-        surfaceInfo->renderQueue->pop();
-        surfaceInfo->droppedFrames++;
-    }
-    
-    surfaceInfo->renderQueue->push(frameData);
     surfaceInfo->frameCount++;
-    
-    // Add to render queue
-    lock.unlock();
-    auto queueLock = lockRenderQueue();
-    renderQueue.push(channelIndex);
-    renderQueueCv.notify_one();
-    
     return true;
 }
 
 bool MultiSurfaceRenderer::renderFrame(int channelIndex) {
-    auto lock = lockSurfaces();
-    
-    SurfaceInfo* surfaceInfo = getSurfaceInfo(channelIndex);
+    std::shared_ptr<SurfaceInfo> surfaceInfo = findSurface(channelIndex);
     if (!surfaceInfo || surfaceInfo->state != ACTIVE) {
         return false;
     }
     
-    auto frameData = surfaceInfo->renderQueue->pop();
-    if (!frameData) {
-        return false;
-    }
-    
-    lock.unlock();
-    
-    // Render frame to surface
-    bool success = renderFrameToSurface(surfaceInfo, frameData.get());
-    
-    if (success) {
-        surfaceInfo->renderCount++;
-        surfaceInfo->lastRenderTime = std::chrono::steady_clock::now();
-        
-        if (eventListener) {
-            eventListener->onFrameRendered(channelIndex, surfaceInfo->width, surfaceInfo->height);
+    std::lock_guard<std::mutex> lock(surfaceInfo->surfaceMutex);
+    if (!surfaceInfo->hasPending) {
+        int64_t timeUs = 0;
+        int dropped = 0;
+        bool ready = surfaceInfo->source->nextFrame(PresentationClock::nowUs(), timeUs, dropped);
+        surfaceInfo->skippedCount += dropped;
+        surfaceInfo->droppedFrames += dropped;
+        if (!ready) {
+            return false;
         }
-    } else {
-        handleRenderError(channelIndex, "Frame rendering failed");
     }
-    
-    return success;
+    surfaceInfo->hasPending = false;
+    return presentPendingFrame(surfaceInfo.get(), false);
 }
 
-bool MultiSurfaceRenderer::renderFrameToSurface(SurfaceInfo* surfaceInfo, frame_data_t* frameData) {
-    if (!surfaceInfo || !frameData || !surfaceInfo->surface) {
+bool MultiSurfaceRenderer::presentPendingFrame(SurfaceInfo* surfaceInfo, bool late) {
+    if (!surfaceInfo->source->presentFrame()) {
+        surfaceInfo->failedCount++;
+        // Sources recover their own windows; a window surface waits for updateSurface()
+        if (surfaceInfo->ownSource) {
+            handleRenderError(surfaceInfo, "Frame rendering failed");
+        }
         return false;
     }
     
-    std::lock_guard<std::mutex> lock(surfaceInfo->surfaceMutex);
-    
-    ANativeWindow* window = surfaceInfo->surface;
-    
-    // Set buffer geometry
-    int ret = ANativeWindow_setBuffersGeometry(window, frameData->screenW, frameData->screenH, 
-                                              WINDOW_FORMAT_RGBA_8888);
-    if (ret != 0) {
-        LOGE("Failed to set buffer geometry for channel %d: %d", surfaceInfo->channelIndex, ret);
-        return false;
-    }
+    (late ? surfaceInfo->lateCount : surfaceInfo->onTimeCount)++;
+    surfaceInfo->renderCount++;
+    surfaceInfo->lastRenderTime = std::chrono::steady_clock::now();
     
-    // Lock buffer
-    ANativeWindow_Buffer buffer;
-    ret = ANativeWindow_lock(window, &buffer, nullptr);
-    if (ret != 0) {
-        LOGE("Failed to lock window buffer for channel %d: %d", surfaceInfo->channelIndex, ret);
-        return false;
+    if (eventListener) {
+        eventListener->onFrameRendered(surfaceInfo->channelIndex, surfaceInfo->width, surfaceInfo->height);
     }
+    return true;
+}
+
+void MultiSurfaceRenderer::renderThreadLoop(int threadId) {
+    LOGD("Render thread %d started", threadId);
     
-    // Copy frame data to buffer
-    if (buffer.bits && frameData->data) {
-        int copyWidth = std::min(buffer.width, frameData->screenW);
-        int copyHeight = std::min(buffer.height, frameData->screenH);
+    std::unique_lock<std::mutex> lock(scheduleMutex);
+    while (!shouldStop) {
+        int64_t nowUs = PresentationClock::nowUs();
+        int64_t wakeUs = std::numeric_limits<int64_t>::max();
+        int heapIndex = pickDueHeap(threadId, nowUs, wakeUs);
+        if (heapIndex < 0) {
+            if (wakeUs == std::numeric_limits<int64_t>::max()) {
+                scheduleCv.wait(lock);
+            } else {
+                scheduleCv.wait_for(lock, std::chrono::microseconds(wakeUs - nowUs));
+            }
+            continue;
+        }
         
-        uint8_t* src = reinterpret_cast<uint8_t*>(frameData->data.get());
-        uint8_t* dst = static_cast<uint8_t*>(buffer.bits);
+        std::vector<ScheduledSurface>& heap = renderHeaps[heapIndex];
+        std::pop_heap(heap.begin(), heap.end(), laterDeadline);
+        ScheduledSurface entry = std::move(heap.back());
+        heap.pop_back();
+        if (heapIndex != threadId) {
+            stolenCount++;
+        }
+        lock.unlock();
+        
+        entry.dueUs = serviceSurface(entry.surface.get());
         
-        for (int y = 0; y < copyHeight; y++) {
-            memcpy(dst + y * buffer.stride * 4, 
-                   src + y * frameData->screenW * 4, 
-                   copyWidth * 4);
+        lock.lock();
+        if (!entry.surface->removed) {
+            // A stolen surface stays with the thread that had time for it
+            std::vector<ScheduledSurface>& own = renderHeaps[threadId];
+            own.push_back(std::move(entry));
+            std::push_heap(own.begin(), own.end(), laterDeadline);
+            scheduleCv.notify_all();
         }
     }
     
-    // Unlock and post buffer
-    ret = ANativeWindow_unlockAndPost(window);
-    if (ret != 0) {
-        LOGE("Failed to unlock and post buffer for channel %d: %d", surfaceInfo->channelIndex, ret);
-        return false;
+    LOGD("Render thread %d stopped", threadId);
+}
+
+bool MultiSurfaceRenderer::laterDeadline(const ScheduledSurface& a, const ScheduledSurface& b) {
+    return a.dueUs > b.dueUs;
+}
+
+int MultiSurfaceRenderer::pickDueHeap(int threadId, int64_t nowUs, int64_t& wakeUs) const {
+    const std::vector<ScheduledSurface>& own = renderHeaps[threadId];
+    if (!own.empty()) {
+        if (own.front().dueUs <= nowUs) {
+            return threadId;
+        }
+        wakeUs = std::min(wakeUs, own.front().dueUs);
     }
     
-    return true;
+    // Nothing of our own is due: take the most overdue surface another thread has not got to
+    int victim = -1;
+    int64_t oldestUs = std::numeric_limits<int64_t>::max();
+    for (int i = 0; i < static_cast<int>(renderHeaps.size()); i++) {
+        if (i == threadId || renderHeaps[i].empty()) {
+            continue;
+        }
+        int64_t dueUs = renderHeaps[i].front().dueUs;
+        if (dueUs + RENDER_STEAL_SLACK_US <= nowUs) {
+            if (dueUs < oldestUs) {
+                oldestUs = dueUs;
+                victim = i;
+            }
+        } else {
+            wakeUs = std::min(wakeUs, dueUs + RENDER_STEAL_SLACK_US);
+        }
+    }
+    return victim;
 }
 
-void MultiSurfaceRenderer::renderThreadLoop(int threadId) {
-    LOGD("Render thread %d started", threadId);
-    
-    while (!shouldStop) {
-        std::unique_lock<std::mutex> lock(renderQueueMutex);
-        renderQueueCv.wait(lock, [this] { return !renderQueue.empty() || shouldStop; });
-        
-        if (shouldStop) break;
+int64_t MultiSurfaceRenderer::serviceSurface(SurfaceInfo* surfaceInfo) {
+    std::lock_guard<std::mutex> lock(surfaceInfo->surfaceMutex);
+    int64_t nowUs = PresentationClock::nowUs();
+    if (surfaceInfo->removed || surfaceInfo->state != ACTIVE) {
+        return nowUs + RENDER_IDLE_POLL_US;
+    }
+    
+    if (!surfaceInfo->hasPending) {
+        int64_t timeUs = nowUs;
+        int dropped = 0;
+        bool ready = surfaceInfo->source->nextFrame(nowUs, timeUs, dropped);
+        if (dropped > 0) {
+            surfaceInfo->frameCount += dropped;
+            surfaceInfo->skippedCount += dropped;
+            surfaceInfo->droppedFrames += dropped;
+        }
+        if (!ready) {
+            return std::max(timeUs, nowUs + RENDER_MIN_POLL_US);
+        }
+        if (!surfaceInfo->ownSource) {
+            surfaceInfo->frameCount++;
+        }
         
-        if (!renderQueue.empty()) {
-            int channelIndex = renderQueue.front();
-            renderQueue.pop();
-            lock.unlock();
-            
-            processSurfaceRender(channelIndex);
+        // Not before the surface's next slot
+        surfaceInfo->hasPending = true;
+        surfaceInfo->pendingDueUs = std::max(timeUs, surfaceInfo->nextSlotUs);
+        if (surfaceInfo->pendingDueUs > nowUs) {
+            return surfaceInfo->pendingDueUs;
         }
     }
     
-    LOGD("Render thread %d stopped", threadId);
+    int64_t dueUs = surfaceInfo->pendingDueUs;
+    bool late = nowUs - dueUs > lateToleranceUs(surfaceInfo);
+    surfaceInfo->hasPending = false;
+    if (late && surfaceInfo->skipIfLate) {
+        // Skip it rather than fall further behind; the next frame may still make its deadline
+        surfaceInfo->source->dropFrame();
+        surfaceInfo->skippedCount++;
+        surfaceInfo->droppedFrames++;
+        LOGD("Channel %d: frame %lld us past its deadline, skipped", surfaceInfo->channelIndex,
+             (long long) (nowUs - dueUs));
+        return nowUs;
+    }
+    
+    presentPendingFrame(surfaceInfo, late);
+    
+    int64_t intervalUs = frameIntervalUs(surfaceInfo);
+    if (intervalUs > 0) {
+        // Keep the grid unless we have fallen a whole slot behind it
+        surfaceInfo->nextSlotUs = std::max(dueUs + intervalUs, nowUs);
+    }
+    return nowUs;
+}
+
+int64_t MultiSurfaceRenderer::frameIntervalUs(const SurfaceInfo* surfaceInfo) {
+    float fps = surfaceInfo->targetFps;
+    return fps > 0.0f ? static_cast<int64_t>(1000000.0f / fps) : 0;
 }
 
-void MultiSurfaceRenderer::processSurfaceRender(int channelIndex) {
-    renderFrame(channelIndex);
+int64_t MultiSurfaceRenderer::lateToleranceUs(const SurfaceInfo* surfaceInfo) {
+    int64_t intervalUs = frameIntervalUs(surfaceInfo);
+    return intervalUs > 0 ? intervalUs / 2 : RENDER_LATE_TOLERANCE_US;
 }
 
 void MultiSurfaceRenderer::performanceMonitorLoop() {
@@ -267,7 +450,8 @@ void MultiSurfaceRenderer::updateSystemLoad() {
     
     auto lock = lockSurfaces();
     for (const auto& pair : surfaces) {
-        if (pair.second->state == ACTIVE) {
+        // Sources without a target rate are paced by their streams
+        if (pair.second->state == ACTIVE && pair.second->targetFps > 0.0f) {
             activeSurfaces++;
             // Estimate load based on FPS and dropped frames
             float surfaceLoad = (pair.second->currentFps / pair.second->targetFps) * 100.0f;
@@ -281,21 +465,8 @@ void MultiSurfaceRenderer::updateSystemLoad() {
     systemRenderLoad.store(activeSurfaces > 0 ? totalLoad / activeSurfaces : 0.0f);
 }
 
-bool MultiSurfaceRenderer::shouldRenderFrame(SurfaceInfo* surfaceInfo) const {
-    if (!surfaceInfo) return false;
-    
-    auto now = std::chrono::steady_clock::now();
-    auto timeSinceLastRender = std::chrono::duration_cast<std::chrono::microseconds>(
-        now - surfaceInfo->lastRenderTime);
-    
-    // Calculate target frame interval
-    float targetInterval = 1000000.0f / surfaceInfo->targetFps; // microseconds
-    
-    return timeSinceLastRender.count() >= targetInterval;
-}
-
 void MultiSurfaceRenderer::adaptiveFrameSkipping(SurfaceInfo* surfaceInfo) {
-    if (!surfaceInfo) return;
+    if (!surfaceInfo || surfaceInfo->targetFps <= 0.0f) return;
     
     // Implement adaptive frame skipping based on performance
     if (systemRenderLoad.load() > maxRenderLoad) {
@@ -309,7 +480,7 @@ void MultiSurfaceRenderer::adaptiveFrameSkipping(SurfaceInfo* surfaceInfo) {
 
 // Public interface implementations
 bool MultiSurfaceRenderer::isSurfaceReady(int channelIndex) const {
-    auto lock = const_cast<MultiSurfaceRenderer*>(this)->lockSurfaces();
+    auto lock = lockSurfaces();
     
     const SurfaceInfo* surfaceInfo = getSurfaceInfo(channelIndex);
     return surfaceInfo && surfaceInfo->state == ACTIVE;
@@ -333,11 +504,21 @@ void MultiSurfaceRenderer::setTargetFps(int channelIndex, float fps) {
     
     SurfaceInfo* surfaceInfo = getSurfaceInfo(channelIndex);
     if (surfaceInfo) {
-        surfaceInfo->targetFps = fps;
+        surfaceInfo->targetFps = std::max(0.0f, fps);
         LOGD("Set target FPS for channel %d: %.1f", channelIndex, fps);
     }
 }
 
+void MultiSurfaceRenderer::setSkipIfLate(int channelIndex, bool skip) {
+    auto lock = lockSurfaces();
+    
+    SurfaceInfo* surfaceInfo = getSurfaceInfo(channelIndex);
+    if (surfaceInfo) {
+        surfaceInfo->skipIfLate = skip;
+        LOGD("Channel %d: late frames %s", channelIndex, skip ? "skipped" : "presented");
+    }
+}
+
 void MultiSurfaceRenderer::pauseSurface(int channelIndex) {
     updateSurfaceState(channelIndex, PAUSED);
 }
@@ -347,20 +528,26 @@ void MultiSurfaceRenderer::resumeSurface(int channelIndex) {
 }
 
 MultiSurfaceRenderer::RenderState MultiSurfaceRenderer::getSurfaceState(int channelIndex) const {
-    auto lock = const_cast<MultiSurfaceRenderer*>(this)->lockSurfaces();
+    auto lock = lockSurfaces();
     
     const SurfaceInfo* surfaceInfo = getSurfaceInfo(channelIndex);
-    return surfaceInfo ? surfaceInfo->state : INACTIVE;
+    return surfaceInfo ? surfaceInfo->state.load() : INACTIVE;
 }
 
 float MultiSurfaceRenderer::getSurfaceFps(int channelIndex) const {
-    auto lock = const_cast<MultiSurfaceRenderer*>(this)->lockSurfaces();
+    auto lock = lockSurfaces();
     
     const SurfaceInfo* surfaceInfo = getSurfaceInfo(channelIndex);
     return surfaceInfo ? surfaceInfo->currentFps : 0.0f;
 }
 
 // Utility methods
+std::shared_ptr<MultiSurfaceRenderer::SurfaceInfo> MultiSurfaceRenderer::findSurface(int channelIndex) const {
+    auto lock = lockSurfaces();
+    auto it = surfaces.find(channelIndex);
+    return (it != surfaces.end()) ? it->second : nullptr;
+}
+
 MultiSurfaceRenderer::SurfaceInfo* MultiSurfaceRenderer::getSurfaceInfo(int channelIndex) {
     auto it = surfaces.find(channelIndex);
     return (it != surfaces.end()) ? it->second.get() : nullptr;
@@ -380,20 +567,15 @@ void MultiSurfaceRenderer::updateSurfaceState(int channelIndex, RenderState newS
     }
 }
 
-void MultiSurfaceRenderer::handleRenderError(int channelIndex, const std::string& error) {
-    auto lock = lockSurfaces();
-    
-    SurfaceInfo* surfaceInfo = getSurfaceInfo(channelIndex);
-    if (surfaceInfo) {
-        surfaceInfo->lastError = error;
-        updateSurfaceState(channelIndex, ERROR);
-    }
+void MultiSurfaceRenderer::handleRenderError(SurfaceInfo* surfaceInfo, const std::string& error) {
+    surfaceInfo->lastError = error;
+    surfaceInfo->state = ERROR;
     
     if (eventListener) {
-        eventListener->onRenderError(channelIndex, error);
+        eventListener->onRenderError(surfaceInfo->channelIndex, error);
     }
     
-    LOGE("Render error for channel %d: %s", channelIndex, error.c_str());
+    LOGE("Render error for channel %d: %s", surfaceInfo->channelIndex, error.c_str());
 }
 
 void MultiSurfaceRenderer::setEventListener(RenderEventListener* listener) {
@@ -404,8 +586,11 @@ void MultiSurfaceRenderer::cleanup() {
     LOGD("Cleaning up MultiSurfaceRenderer");
     
     // Stop all threads
-    shouldStop = true;
-    renderQueueCv.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(scheduleMutex);
+        shouldStop = true;
+    }
+    scheduleCv.notify_all();
     
     // Wait for render threads
     for (auto& thread : renderThreads) {
@@ -420,6 +605,12 @@ void MultiSurfaceRenderer::cleanup() {
     }
     
     // Clear all surfaces
+    {
+        std::lock_guard<std::mutex> lock(scheduleMutex);
+        for (auto& heap : renderHeaps) {
+            heap.clear();
+        }
+    }
     auto lock = lockSurfaces();
     surfaces.clear();
     activeSurfaceCount = 0;
@@ -429,28 +620,42 @@ void MultiSurfaceRenderer::cleanup() {
 
 // Additional public interface implementations
 int MultiSurfaceRenderer::getFrameCount(int channelIndex) const {
-    auto lock = const_cast<MultiSurfaceRenderer*>(this)->lockSurfaces();
+    auto lock = lockSurfaces();
 
     const SurfaceInfo* surfaceInfo = getSurfaceInfo(channelIndex);
     return surfaceInfo ? surfaceInfo->frameCount.load() : 0;
 }
 
 int MultiSurfaceRenderer::getRenderCount(int channelIndex) const {
-    auto lock = const_cast<MultiSurfaceRenderer*>(this)->lockSurfaces();
+    auto lock = lockSurfaces();
 
     const SurfaceInfo* surfaceInfo = getSurfaceInfo(channelIndex);
     return surfaceInfo ? surfaceInfo->renderCount.load() : 0;
 }
 
 int MultiSurfaceRenderer::getDroppedFrames(int channelIndex) const {
-    auto lock = const_cast<MultiSurfaceRenderer*>(this)->lockSurfaces();
+    auto lock = lockSurfaces();
 
     const SurfaceInfo* surfaceInfo = getSurfaceInfo(channelIndex);
     return surfaceInfo ? surfaceInfo->droppedFrames.load() : 0;
 }
 
+bool MultiSurfaceRenderer::getPresentStats(int channelIndex, PresentStats& stats) const {
+    auto lock = lockSurfaces();
+
+    const SurfaceInfo* surfaceInfo = getSurfaceInfo(channelIndex);
+    if (!surfaceInfo) {
+        return false;
+    }
+    stats.onTime = surfaceInfo->onTimeCount.load();
+    stats.late = surfaceInfo->lateCount.load();
+    stats.dropped = surfaceInfo->skippedCount.load() + surfaceInfo->renderQueue->getStats().dropped;
+    stats.failed = surfaceInfo->failedCount.load();
+    return true;
+}
+
 std::vector<int> MultiSurfaceRenderer::getActiveSurfaces() const {
-    auto lock = const_cast<MultiSurfaceRenderer*>(this)->lockSurfaces();
+    auto lock = lockSurfaces();
 
     std::vector<int> activeSurfaces;
     for (const auto& pair : surfaces) {
@@ -478,11 +683,13 @@ bool MultiSurfaceRenderer::updateSurface(int channelIndex, ANativeWindow* surfac
     auto lock = lockSurfaces();
 
     SurfaceInfo* surfaceInfo = getSurfaceInfo(channelIndex);
-    if (!surfaceInfo) {
+    if (!surfaceInfo || !surfaceInfo->ownSource) {
         return false;
     }
 
-    // Release old surface
+    // Release old surface; a render in progress finishes with it first
+    std::lock_guard<std::mutex> surfaceLock(surfaceInfo->surfaceMutex);
+    surfaceInfo->presenter.setWindow(nullptr);
     if (surfaceInfo->surface) {
         ANativeWindow_release(surfaceInfo->surface);
     }
@@ -491,15 +698,16 @@ bool MultiSurfaceRenderer::updateSurface(int channelIndex, ANativeWindow* surfac
     surfaceInfo->surface = surface;
     if (surface) {
         ANativeWindow_acquire(surface);
+        surfaceInfo->presenter.setWindow(NativePresentWindow::wrap(surface));
 
         // Update surface properties
         surfaceInfo->width = ANativeWindow_getWidth(surface);
         surfaceInfo->height = ANativeWindow_getHeight(surface);
         surfaceInfo->format = ANativeWindow_getFormat(surface);
 
-        updateSurfaceState(channelIndex, ACTIVE);
+        surfaceInfo->state = ACTIVE;
     } else {
-        updateSurfaceState(channelIndex, INACTIVE);
+        surfaceInfo->state = INACTIVE;
     }
 
     LOGD("Updated surface for channel %d", channelIndex);
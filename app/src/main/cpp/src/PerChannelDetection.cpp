@@ -1,10 +1,28 @@
 #include "PerChannelDetection.h"
+#include "SystemPerformanceMonitor.h"
 #include <algorithm>
 #include <sstream>
 
+// 通道的NPU核心配置：未指定核心时在各核心间轮询，各通道错开起点
+static npu_affinity_config_s toNpuAffinity(const PerChannelDetection::DetectionConfig& config,
+                                           const std::shared_ptr<NpuUsageTracker>& usage) {
+    npu_affinity_config_s npu = npu_affinity_default_config();
+    if (config.npuCore >= 0) {
+        npu.policy = NPU_POLICY_PINNED;
+        npu.pinned_mask = 1u << (config.npuCore % npu.num_cores);
+    } else {
+        npu.policy = NPU_POLICY_ROUND_ROBIN;
+        npu.first_core = config.channelIndex % npu.num_cores;
+    }
+    npu.share_weights = config.shareModelWeights;
+    npu.usage_tracker = usage;
+    return npu;
+}
+
 PerChannelDetection::PerChannelDetection() 
     : eventListener(nullptr), modelData(nullptr), modelDataSize(0),
-      activeChannelCount(0), globalEnabled(true), statsThreadRunning(false) {
+      activeChannelCount(0), globalEnabled(true), npuUsage(std::make_shared<NpuUsageTracker>()),
+      statsThreadRunning(false) {
     LOGD("PerChannelDetection created");
 }
 
@@ -79,11 +97,13 @@ bool PerChannelDetection::addChannel(int channelIndex, const DetectionConfig& co
     
     // Initialize thread pool for this channel
     channelInfo->threadPool = std::make_unique<Yolov5ThreadPool>();
-    if (channelInfo->threadPool->setUpWithModelData(config.threadPoolSize, 
-                                                   modelData, modelDataSize) != NN_SUCCESS) {
+    if (channelInfo->threadPool->setUpWithModelData(config.threadPoolSize, modelData, modelDataSize,
+                                                   toNpuAffinity(channelInfo->config, npuUsage)) != NN_SUCCESS) {
         LOGE("Failed to initialize thread pool for channel %d", channelIndex);
         return false;
     }
+    channelInfo->threadPool->setNmsConfig(nmsConfig(config));
+    channelInfo->cadence.setConfig(cadenceConfig(config));
     
     // Start processing thread
     channelInfo->processingThread = std::thread(&PerChannelDetection::channelProcessingLoop, 
@@ -94,6 +114,24 @@ bool PerChannelDetection::addChannel(int channelIndex, const DetectionConfig& co
     return true;
 }
 
+void PerChannelDetection::reportNpuMetrics(SystemPerformanceMonitor& monitor) {
+    long weightSaved = 0;
+    int sharedContexts = 0;
+    {
+        std::lock_guard<std::mutex> lock(channelsMutex);
+        for (auto& pair : channels) {
+            if (pair.second->threadPool) {
+                Yolov5ThreadPool::NpuStats stats = pair.second->threadPool->getNpuStats();
+                weightSaved += (long) stats.weightBytesSaved;
+                sharedContexts += stats.sharedContexts;
+            }
+        }
+    }
+    auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    monitor.updateNpuMetrics(npuUsage->Sample(now), weightSaved, sharedContexts);
+}
+
 bool PerChannelDetection::removeChannel(int channelIndex) {
     std::lock_guard<std::mutex> lock(channelsMutex);
     
@@ -269,6 +307,16 @@ void PerChannelDetection::processFrame(ChannelDetectionInfo* channelInfo,
     auto startTime = std::chrono::steady_clock::now();
     
     try {
+        // Frames skipped by the detection cadence take the tracker's predicted boxes instead of inference
+        float load = (float) channelInfo->threadPool->get_task_size() / MAX_TASK;
+        if (!channelInfo->cadence.shouldDetect(load)) {
+            DetectionResult result(channelInfo->channelIndex, frameData->frameId);
+            result.detections = channelInfo->tracker.predict();
+            channelInfo->stats.trackedFrames++;
+            publishResult(channelInfo, result);
+            return;
+        }
+
         // Submit frame to thread pool
         if (channelInfo->threadPool->submitTask(frameData) != NN_SUCCESS) {
             LOGE("Failed to submit frame to thread pool for channel %d", channelInfo->channelIndex);
@@ -303,25 +351,13 @@ void PerChannelDetection::processFrame(ChannelDetectionInfo* channelInfo,
             if (result.detections.size() > channelInfo->config.maxDetections) {
                 result.detections.resize(channelInfo->config.maxDetections);
             }
-            
-            // Store result
-            {
-                std::lock_guard<std::mutex> lock(channelInfo->resultMutex);
-                channelInfo->resultQueue.push(result);
-                
-                // Limit result queue size
-                while (channelInfo->resultQueue.size() > 50) {
-                    channelInfo->resultQueue.pop();
-                }
-            }
+
+            channelInfo->tracker.update(result.detections);
+            channelInfo->cadence.reportMotion(channelInfo->tracker.motion());
             
             // Update statistics
             updateChannelStats(channelInfo, result);
-            
-            // Notify listener
-            if (eventListener) {
-                eventListener->onDetectionCompleted(channelInfo->channelIndex, result);
-            }
+            publishResult(channelInfo, result);
             
             LOGD("Detection completed for channel %d, frame %d: %zu detections in %.2fms",
                  channelInfo->channelIndex, frameData->frameId, result.detections.size(), processingTime);
@@ -335,6 +371,24 @@ void PerChannelDetection::processFrame(ChannelDetectionInfo* channelInfo,
     }
 }
 
+void PerChannelDetection::publishResult(ChannelDetectionInfo* channelInfo, const DetectionResult& result) {
+    // Store result
+    {
+        std::lock_guard<std::mutex> lock(channelInfo->resultMutex);
+        channelInfo->resultQueue.push(result);
+        
+        // Limit result queue size
+        while (channelInfo->resultQueue.size() > 50) {
+            channelInfo->resultQueue.pop();
+        }
+    }
+    
+    // Notify listener
+    if (eventListener) {
+        eventListener->onDetectionCompleted(channelInfo->channelIndex, result);
+    }
+}
+
 void PerChannelDetection::updateChannelStats(ChannelDetectionInfo* channelInfo, 
                                             const DetectionResult& result) {
     if (!channelInfo) return;
@@ -561,10 +615,31 @@ void PerChannelDetection::setChannelConfig(int channelIndex, const DetectionConf
     if (channelInfo) {
         channelInfo->config = config;
         channelInfo->config.channelIndex = channelIndex; // Ensure consistency
+        if (channelInfo->threadPool) {
+            channelInfo->threadPool->setNmsConfig(nmsConfig(config));
+        }
+        channelInfo->cadence.setConfig(cadenceConfig(config));
         LOGD("Updated config for channel %d", channelIndex);
     }
 }
 
+nms_config_s PerChannelDetection::nmsConfig(const DetectionConfig& config) {
+    nms_config_s nms = nms_default_config();
+    nms.enabled = config.enableNMS;
+    nms.mode = config.nmsMode;
+    nms.iou_threshold = config.nmsThreshold;
+    nms.top_k = config.nmsTopK;
+    return nms;
+}
+
+DetectionCadence::Config PerChannelDetection::cadenceConfig(const DetectionConfig& config) {
+    DetectionCadence::Config cadence;
+    cadence.interval = config.detectInterval;
+    cadence.adaptive = config.adaptiveCadence;
+    cadence.maxInterval = config.maxDetectInterval;
+    return cadence;
+}
+
 PerChannelDetection::DetectionConfig PerChannelDetection::getChannelConfig(int channelIndex) const {
     auto channelInfo = getChannelInfo(channelIndex);
     if (channelInfo) {
@@ -0,0 +1,100 @@
+#include "PresentationClock.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+const int64_t kDefaultFrameIntervalUs = 40000;  // 25 fps until PTS deltas say otherwise
+const int kIntervalSmoothing = 8;
+const int kLatenessSmoothing = 16;
+const int kDriftSmoothing = 512;  // Upward envelope drift per frame: 1/512 of the excess
+const int kDelayPerLateness = 3;
+}
+
+PresentationClock::PresentationClock(const Config& config)
+        : m_config(config), m_anchored(false), m_lastPts(-1), m_offsetUs(0), m_latenessUs(0),
+          m_frameIntervalUs(kDefaultFrameIntervalUs), m_consecutiveLate(0), m_scheduled(0),
+          m_droppedLate(0), m_resets(0) {
+}
+
+PresentationClock::Decision PresentationClock::schedule(int64_t pts, int64_t readyTimeUs, int64_t nowUs) {
+    m_scheduled++;
+    Decision decision;
+    decision.action = PRESENT;
+    decision.presentTimeUs = nowUs;
+    if (pts < 0) {
+        return decision;
+    }
+
+    if (!m_anchored) {
+        anchor(pts, readyTimeUs);
+    } else if (pts < m_lastPts || pts - m_lastPts > m_config.discontinuityMs ||
+               m_consecutiveLate >= m_config.maxConsecutiveLate) {
+        m_resets++;
+        anchor(pts, readyTimeUs);
+    } else {
+        int64_t deltaUs = (pts - m_lastPts) * 1000;
+        if (deltaUs > 0) {
+            m_frameIntervalUs += (deltaUs - m_frameIntervalUs) / kIntervalSmoothing;
+        }
+        m_lastPts = pts;
+
+        int64_t excessUs = readyTimeUs - pts * 1000 - m_offsetUs;
+        if (excessUs < 0) {
+            // Earlier than any frame so far: the envelope drops immediately
+            m_offsetUs += excessUs;
+            excessUs = 0;
+        } else {
+            m_offsetUs += excessUs / kDriftSmoothing;
+        }
+        m_latenessUs += (excessUs - m_latenessUs) / kLatenessSmoothing;
+    }
+
+    int64_t presentTimeUs = pts * 1000 + m_offsetUs + currentDelayUs();
+    if (nowUs > presentTimeUs + m_frameIntervalUs / 2) {
+        m_consecutiveLate++;
+        m_droppedLate++;
+        decision.action = DROP_LATE;
+        decision.presentTimeUs = presentTimeUs;
+        return decision;
+    }
+
+    m_consecutiveLate = 0;
+    decision.presentTimeUs = std::max(presentTimeUs, nowUs);
+    return decision;
+}
+
+void PresentationClock::reset() {
+    m_anchored = false;
+    m_lastPts = -1;
+    m_latenessUs = 0;
+    m_consecutiveLate = 0;
+}
+
+PresentationClock::Stats PresentationClock::getStats() const {
+    Stats stats;
+    stats.scheduled = m_scheduled;
+    stats.droppedLate = m_droppedLate;
+    stats.resets = m_resets;
+    stats.frameIntervalUs = m_frameIntervalUs;
+    stats.delayUs = currentDelayUs();
+    return stats;
+}
+
+int64_t PresentationClock::nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void PresentationClock::anchor(int64_t pts, int64_t readyTimeUs) {
+    m_anchored = true;
+    m_lastPts = pts;
+    m_offsetUs = readyTimeUs - pts * 1000;
+    m_latenessUs = 0;
+    m_consecutiveLate = 0;
+}
+
+int64_t PresentationClock::currentDelayUs() const {
+    int64_t delayUs = m_latenessUs * kDelayPerLateness;
+    return std::min(std::max(delayUs, (int64_t) m_config.minDelayMs * 1000), (int64_t) m_config.maxDelayMs * 1000);
+}
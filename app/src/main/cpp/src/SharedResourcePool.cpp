@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
+#include "rga.h"
 
 SharedResourcePool::SharedResourcePool()
     : sharedModelData(nullptr), sharedModelSize(0), eventListener(nullptr), threadsRunning(false) {
@@ -369,9 +370,11 @@ std::shared_ptr<void> SharedResourcePool::createMemoryBuffer(size_t size) {
 }
 
 std::shared_ptr<frame_data_t> SharedResourcePool::createFrameBuffer() {
-    auto frameBuffer = std::make_shared<frame_data_t>();
+    auto framePool = FrameBufferPool::shared();
+    auto frameBuffer = framePool->acquireFrame();
     frameBuffer->dataSize = 1920 * 1080 * 4; // Default RGBA buffer
-    frameBuffer->data = std::make_unique<char[]>(frameBuffer->dataSize);
+    frameBuffer->data = framePool->acquire(FrameBufferKey(1920, 1080, RK_FORMAT_RGBA_8888, 1920 * 4),
+                                           frameBuffer->dataSize);
     LOGD("Created frame buffer");
     return frameBuffer;
 }
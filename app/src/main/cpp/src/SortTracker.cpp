@@ -0,0 +1,263 @@
+#include "SortTracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Noise parameters from the SORT reference filter (pixel units)
+const float kPositionNoise = 1.0f;          // Process noise: centre, area and aspect
+const float kVelocityNoise = 0.01f;         // Process noise: centre velocity
+const float kAreaVelocityNoise = 0.0001f;   // Process noise: area velocity
+const float kCentreMeasurementVar = 1.0f;
+const float kShapeMeasurementVar = 10.0f;   // Area and aspect measurements
+const float kInitialPositionVar = 10.0f;
+const float kInitialVelocityVar = 10000.0f; // Velocity is unknown until the second detection
+
+// Constant-velocity Kalman filter for one coordinate: state (x, v), covariance (p00, p01, p11)
+inline void predictAxis(float& x, float& v, float& p00, float& p01, float& p11, float positionNoise,
+                        float velocityNoise) {
+    x += v;
+    p00 += 2.0f * p01 + p11 + positionNoise;
+    p01 += p11;
+    p11 += velocityNoise;
+}
+
+inline void correctAxis(float& x, float& v, float& p00, float& p01, float& p11, float measurement,
+                        float measurementVar) {
+    float s = p00 + measurementVar;
+    float k0 = p00 / s;
+    float k1 = p01 / s;
+    float innovation = measurement - x;
+    x += k0 * innovation;
+    v += k1 * innovation;
+    p11 -= k1 * p01;
+    p00 *= 1.0f - k0;
+    p01 *= 1.0f - k0;
+}
+}
+
+SortTracker::SortTracker(const Config& config) : m_config(config), m_nextId(0) {
+}
+
+void SortTracker::update(std::vector<Detection>& detections) {
+    predictAll();
+
+    size_t count = m_id.size();
+    m_left.resize(count);
+    m_top.resize(count);
+    m_right.resize(count);
+    m_bottom.resize(count);
+    for (size_t t = 0; t < count; t++) {
+        boxOf((int) t, m_left[t], m_top[t], m_right[t], m_bottom[t]);
+    }
+    m_matched.assign(count, 0);
+    m_detectionMatched.assign(detections.size(), 0);
+    for (Detection& detection : detections) {
+        detection.track_id = -1;
+        detection.velocity = cv::Point2f();
+    }
+
+    // ByteTrack: confident detections first, then the weak ones against the tracks they left over
+    associate(detections, true, m_config.iouThreshold);
+    associate(detections, false, m_config.lowIouThreshold);
+
+    for (int t = (int) count - 1; t >= 0; t--) {
+        if (!m_matched[t] && ++m_missed[t] > m_config.maxAge) {
+            removeTrack(t, (int) m_id.size() - 1);
+        }
+    }
+
+    for (size_t d = 0; d < detections.size(); d++) {
+        if (!m_detectionMatched[d] && detections[d].confidence >= m_config.highThreshold &&
+            detections[d].box.width > 0 && detections[d].box.height > 0) {
+            addTrack(detections[d]);
+        }
+    }
+}
+
+std::vector<Detection> SortTracker::predict() {
+    predictAll();
+    std::vector<Detection> predicted;
+    for (size_t t = 0; t < m_id.size(); t++) {
+        if (m_missed[t] == 0) {
+            predicted.push_back(m_label[t]);
+            predicted.back().box = rectOf((int) t);
+            predicted.back().velocity = cv::Point2f(m_vx[t], m_vy[t]);
+        }
+    }
+    return predicted;
+}
+
+void SortTracker::reset() {
+    for (std::vector<float>* column : {&m_cx, &m_vx, &m_cxP00, &m_cxP01, &m_cxP11,
+                                       &m_cy, &m_vy, &m_cyP00, &m_cyP01, &m_cyP11,
+                                       &m_area, &m_va, &m_areaP00, &m_areaP01, &m_areaP11,
+                                       &m_aspect, &m_aspectVar}) {
+        column->clear();
+    }
+    m_classId.clear();
+    m_missed.clear();
+    m_id.clear();
+    m_matched.clear();
+    m_label.clear();
+}
+
+float SortTracker::motion() const {
+    float fastest = 0.0f;
+    for (size_t t = 0; t < m_id.size(); t++) {
+        if (m_missed[t] != 0 || m_area[t] <= 0.0f) {
+            continue;
+        }
+        float speed = std::sqrt(m_vx[t] * m_vx[t] + m_vy[t] * m_vy[t]);
+        fastest = std::max(fastest, speed / std::sqrt(m_area[t]));
+    }
+    return fastest;
+}
+
+void SortTracker::predictAll() {
+    size_t count = m_id.size();
+    for (size_t t = 0; t < count; t++) {
+        predictAxis(m_cx[t], m_vx[t], m_cxP00[t], m_cxP01[t], m_cxP11[t], kPositionNoise, kVelocityNoise);
+    }
+    for (size_t t = 0; t < count; t++) {
+        predictAxis(m_cy[t], m_vy[t], m_cyP00[t], m_cyP01[t], m_cyP11[t], kPositionNoise, kVelocityNoise);
+    }
+    for (size_t t = 0; t < count; t++) {
+        if (m_area[t] + m_va[t] <= 0.0f) {
+            m_va[t] = 0.0f;
+        }
+        predictAxis(m_area[t], m_va[t], m_areaP00[t], m_areaP01[t], m_areaP11[t], kPositionNoise,
+                    kAreaVelocityNoise);
+        m_aspectVar[t] += kPositionNoise;
+    }
+}
+
+void SortTracker::associate(std::vector<Detection>& detections, bool highScore, float iouThreshold) {
+    m_candidates.clear();
+    size_t count = m_matched.size();  // Tracks started in this update are not candidates
+    for (size_t d = 0; d < detections.size(); d++) {
+        const Detection& detection = detections[d];
+        if (m_detectionMatched[d] || (detection.confidence >= m_config.highThreshold) != highScore) {
+            continue;
+        }
+        float left = (float) detection.box.x;
+        float top = (float) detection.box.y;
+        float right = left + detection.box.width;
+        float bottom = top + detection.box.height;
+        float area = (float) detection.box.width * detection.box.height;
+        for (size_t t = 0; t < count; t++) {
+            if (m_matched[t] || m_classId[t] != detection.class_id) {
+                continue;
+            }
+            float width = std::min(right, m_right[t]) - std::max(left, m_left[t]);
+            float height = std::min(bottom, m_bottom[t]) - std::max(top, m_top[t]);
+            if (width <= 0.0f || height <= 0.0f) {
+                continue;
+            }
+            float intersection = width * height;
+            float trackArea = (m_right[t] - m_left[t]) * (m_bottom[t] - m_top[t]);
+            float iou = intersection / (area + trackArea - intersection);
+            if (iou >= iouThreshold) {
+                m_candidates.push_back({iou, (int) t, (int) d});
+            }
+        }
+    }
+    std::sort(m_candidates.begin(), m_candidates.end(),
+              [](const Candidate& a, const Candidate& b) { return a.iou > b.iou; });
+
+    for (const Candidate& candidate : m_candidates) {
+        if (m_matched[candidate.track] || m_detectionMatched[candidate.detection]) {
+            continue;
+        }
+        m_matched[candidate.track] = 1;
+        m_detectionMatched[candidate.detection] = 1;
+        correct(candidate.track, detections[candidate.detection]);
+    }
+}
+
+void SortTracker::correct(int track, Detection& detection) {
+    const cv::Rect& box = detection.box;
+    correctAxis(m_cx[track], m_vx[track], m_cxP00[track], m_cxP01[track], m_cxP11[track],
+                box.x + box.width * 0.5f, kCentreMeasurementVar);
+    correctAxis(m_cy[track], m_vy[track], m_cyP00[track], m_cyP01[track], m_cyP11[track],
+                box.y + box.height * 0.5f, kCentreMeasurementVar);
+    correctAxis(m_area[track], m_va[track], m_areaP00[track], m_areaP01[track], m_areaP11[track],
+                (float) box.area(), kShapeMeasurementVar);
+    if (box.height > 0) {
+        float gain = m_aspectVar[track] / (m_aspectVar[track] + kShapeMeasurementVar);
+        m_aspect[track] += gain * ((float) box.width / box.height - m_aspect[track]);
+        m_aspectVar[track] *= 1.0f - gain;
+    }
+    m_missed[track] = 0;
+
+    detection.track_id = m_id[track];
+    detection.velocity = cv::Point2f(m_vx[track], m_vy[track]);
+    m_label[track] = detection;
+}
+
+void SortTracker::addTrack(Detection& detection) {
+    const cv::Rect& box = detection.box;
+    m_cx.push_back(box.x + box.width * 0.5f);
+    m_cy.push_back(box.y + box.height * 0.5f);
+    m_area.push_back((float) box.area());
+    for (std::vector<float>* velocity : {&m_vx, &m_vy, &m_va}) {
+        velocity->push_back(0.0f);
+    }
+    for (std::vector<float>* p00 : {&m_cxP00, &m_cyP00, &m_areaP00}) {
+        p00->push_back(kInitialPositionVar);
+    }
+    for (std::vector<float>* p01 : {&m_cxP01, &m_cyP01, &m_areaP01}) {
+        p01->push_back(0.0f);
+    }
+    for (std::vector<float>* p11 : {&m_cxP11, &m_cyP11, &m_areaP11}) {
+        p11->push_back(kInitialVelocityVar);
+    }
+    m_aspect.push_back((float) box.width / box.height);
+    m_aspectVar.push_back(kInitialPositionVar);
+    m_classId.push_back(detection.class_id);
+    m_missed.push_back(0);
+    m_id.push_back(m_nextId++);
+
+    detection.track_id = m_id.back();
+    detection.velocity = cv::Point2f();
+    m_label.push_back(detection);
+}
+
+// Moves the last track into slot `track` and drops the last slot
+void SortTracker::removeTrack(int track, int last) {
+    for (std::vector<float>* column : {&m_cx, &m_vx, &m_cxP00, &m_cxP01, &m_cxP11,
+                                       &m_cy, &m_vy, &m_cyP00, &m_cyP01, &m_cyP11,
+                                       &m_area, &m_va, &m_areaP00, &m_areaP01, &m_areaP11,
+                                       &m_aspect, &m_aspectVar}) {
+        (*column)[track] = (*column)[last];
+        column->pop_back();
+    }
+    for (std::vector<int>* column : {&m_classId, &m_missed, &m_id}) {
+        (*column)[track] = (*column)[last];
+        column->pop_back();
+    }
+    if (track != last) {
+        m_label[track] = std::move(m_label[last]);
+    }
+    m_label.pop_back();
+    if (last < (int) m_matched.size()) {
+        m_matched[track] = m_matched[last];
+        m_matched.pop_back();
+    }
+}
+
+void SortTracker::boxOf(int track, float& left, float& top, float& right, float& bottom) const {
+    float area = std::max(m_area[track], 0.0f);
+    float width = std::sqrt(area * m_aspect[track]);
+    float height = width > 0.0f ? area / width : 0.0f;
+    left = m_cx[track] - width * 0.5f;
+    top = m_cy[track] - height * 0.5f;
+    right = left + width;
+    bottom = top + height;
+}
+
+cv::Rect SortTracker::rectOf(int track) const {
+    float left, top, right, bottom;
+    boxOf(track, left, top, right, bottom);
+    return cv::Rect(cvRound(left), cvRound(top), cvRound(right - left), cvRound(bottom - top));
+}
@@ -9,7 +9,7 @@ SystemPerformanceMonitor::SystemPerformanceMonitor()
     : eventListener(nullptr), monitorRunning(false), monitorIntervalMs(1000),
       optimizationIntervalMs(5000), historySize(300), enableAutoOptimization(true),
       enableDetailedLogging(false), systemCpuUsage(0.0f), systemMemoryUsage(0),
-      systemGpuUsage(0.0f) {
+      systemGpuUsage(0.0f), npuWeightMemorySaved(0), npuSharedContexts(0) {
     LOGD("SystemPerformanceMonitor created");
 }
 
@@ -225,6 +225,20 @@ void SystemPerformanceMonitor::updateSystemMetrics(const SystemMetrics& metrics)
          metrics.systemFps, metrics.cpuUsage, metrics.memoryUsage / (1024 * 1024));
 }
 
+void SystemPerformanceMonitor::updateNpuMetrics(const std::vector<float>& coreUsage, long weightMemorySaved,
+                                                int sharedContexts) {
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    npuCoreUsage.clear();
+    for (float usage : coreUsage) {
+        npuCoreUsage.push_back(usage * 100.0f);
+    }
+    npuWeightMemorySaved = weightMemorySaved;
+    npuSharedContexts = sharedContexts;
+    currentMetrics.npuCoreUsage = npuCoreUsage;
+    currentMetrics.npuWeightMemorySaved = weightMemorySaved;
+    currentMetrics.npuSharedContexts = sharedContexts;
+}
+
 void SystemPerformanceMonitor::monitoringLoop() {
     while (monitorRunning) {
         std::unique_lock<std::mutex> lock(threadMutex);
@@ -306,6 +320,9 @@ void SystemPerformanceMonitor::collectSystemMetrics() {
         }
         
         metrics.totalChannels = channelMetrics.size();
+        metrics.npuCoreUsage = npuCoreUsage;
+        metrics.npuWeightMemorySaved = npuWeightMemorySaved;
+        metrics.npuSharedContexts = npuSharedContexts;
     }
     
     metrics.activeChannels = activeChannels;
@@ -777,6 +794,15 @@ std::string SystemPerformanceMonitor::generatePerformanceReport() const {
     report << "  Active Channels: " << systemMetrics.activeChannels << "/" << systemMetrics.totalChannels << "\n";
     report << "  Performance Level: " << performanceLevelToString(assessSystemPerformance()) << "\n\n";
 
+    if (!systemMetrics.npuCoreUsage.empty() || systemMetrics.npuSharedContexts > 0) {
+        report << "NPU:\n";
+        for (size_t core = 0; core < systemMetrics.npuCoreUsage.size(); core++) {
+            report << "  Core " << core << " Usage: " << systemMetrics.npuCoreUsage[core] << "%\n";
+        }
+        report << "  Shared Contexts: " << systemMetrics.npuSharedContexts << "\n";
+        report << "  Weight Memory Saved: " << systemMetrics.npuWeightMemorySaved / 1024 << "KB\n\n";
+    }
+
     auto allChannelMetrics = getAllChannelMetrics();
     report << "Channel Performance:\n";
 
@@ -276,18 +276,33 @@ void* ThreadSafeResourceManager::allocateFromPool(ResourceType type, int channel
         void* ptr = block->resourcePtr;
         pool->usedBlocks.push_back(std::move(block));
         pool->totalUsed.fetch_add(1);
+        pool->hits.fetch_add(1);
+        updatePoolPeak(pool.get());
         
         return ptr;
     }
     
+    pool->misses.fetch_add(1);
+    
     // Create new block if under limit
     if (pool->totalAllocated.load() < pool->maxBlocks) {
         int resourceId = allocateResource(type, pool->blockSize, channelIndex);
         if (resourceId > 0) {
             auto resource = getResource(resourceId);
             if (resource) {
+                // Track the block so returnToPool can recycle it; the memory stays owned by the resource
+                auto block = std::make_unique<ResourceInfo>();
+                block->resourceId = resourceId;
+                block->type = type;
+                block->state = IN_USE;
+                block->resourcePtr = resource->resourcePtr;
+                block->resourceSize = pool->blockSize;
+                block->ownerChannelIndex = channelIndex;
+                pool->usedBlocks.push_back(std::move(block));
+                
                 pool->totalAllocated.fetch_add(1);
                 pool->totalUsed.fetch_add(1);
+                updatePoolPeak(pool.get());
                 return resource->resourcePtr;
             }
         }
@@ -296,6 +311,67 @@ void* ThreadSafeResourceManager::allocateFromPool(ResourceType type, int channel
     return nullptr; // Pool exhausted
 }
 
+void ThreadSafeResourceManager::updatePoolPeak(MemoryPool* pool) {
+    size_t used = pool->totalUsed.load();
+    size_t peak = pool->peakUsed.load();
+    while (used > peak && !pool->peakUsed.compare_exchange_weak(peak, used)) {
+    }
+}
+
+bool ThreadSafeResourceManager::attachMemoryPool(ResourceType type, const MemoryPoolStatsProvider& provider) {
+    if (!provider) return false;
+
+    std::lock_guard<std::mutex> lock(poolsMutex);
+    if (externalPools.find(type) != externalPools.end()) {
+        LOGW("External memory pool for type %d already attached", type);
+        return false;
+    }
+    externalPools[type] = provider;
+    LOGD("Attached external memory pool for type %d", type);
+    return true;
+}
+
+bool ThreadSafeResourceManager::detachMemoryPool(ResourceType type) {
+    std::lock_guard<std::mutex> lock(poolsMutex);
+    return externalPools.erase(type) > 0;
+}
+
+ThreadSafeResourceManager::MemoryPoolStats ThreadSafeResourceManager::getMemoryPoolStats(ResourceType type) const {
+    MemoryPoolStats stats;
+    MemoryPoolStatsProvider provider;
+    {
+        std::lock_guard<std::mutex> lock(poolsMutex);
+        auto it = memoryPools.find(type);
+        if (it != memoryPools.end()) {
+            const auto& pool = it->second;
+            stats.totalBlocks = pool->totalAllocated.load();
+            stats.usedBlocks = pool->totalUsed.load();
+            stats.highWaterMark = pool->peakUsed.load();
+            stats.bytesResident = stats.totalBlocks * pool->blockSize;
+            stats.hits = pool->hits.load();
+            stats.misses = pool->misses.load();
+        }
+        auto ext = externalPools.find(type);
+        if (ext != externalPools.end()) {
+            provider = ext->second;
+        }
+    }
+    
+    // Query outside the lock: the provider takes the external pool's own lock
+    if (provider) {
+        MemoryPoolStats external = provider();
+        stats.totalBlocks += external.totalBlocks;
+        stats.usedBlocks += external.usedBlocks;
+        stats.highWaterMark += external.highWaterMark;
+        stats.bytesResident += external.bytesResident;
+        stats.hits += external.hits;
+        stats.misses += external.misses;
+    }
+    uint64_t requests = stats.hits + stats.misses;
+    stats.hitRate = requests > 0 ? static_cast<float>(stats.hits) / requests : 0.0f;
+    return stats;
+}
+
 bool ThreadSafeResourceManager::returnToPool(ResourceType type, void* ptr) {
     if (!ptr) return false;
 
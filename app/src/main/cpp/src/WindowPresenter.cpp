@@ -0,0 +1,128 @@
+#include "WindowPresenter.h"
+#include "FrameConverter.h"
+#include "log4c.h"
+
+#include <cstring>
+
+std::unique_ptr<PresentWindow> NativePresentWindow::wrap(ANativeWindow* window) {
+    return std::unique_ptr<PresentWindow>(window ? new NativePresentWindow(window) : nullptr);
+}
+
+int32_t NativePresentWindow::setBuffersGeometry(int32_t width, int32_t height) {
+    return ANativeWindow_setBuffersGeometry(m_window, width, height, WINDOW_FORMAT_RGBA_8888);
+}
+
+int32_t NativePresentWindow::lock(ANativeWindow_Buffer& buffer) {
+    return ANativeWindow_lock(m_window, &buffer, nullptr);
+}
+
+int32_t NativePresentWindow::unlockAndPost() {
+    return ANativeWindow_unlockAndPost(m_window);
+}
+
+WindowPresenter::WindowPresenter() : m_width(0), m_height(0), m_stats() {}
+
+void WindowPresenter::setWindow(std::unique_ptr<PresentWindow> window) {
+    m_window = std::move(window);
+    m_width = 0;
+    m_height = 0;
+}
+
+bool WindowPresenter::hasWindow() const {
+    return m_window != nullptr;
+}
+
+int32_t WindowPresenter::lock(int width, int height, ANativeWindow_Buffer& buffer) {
+    if (!m_window || width <= 0 || height <= 0) {
+        m_stats.lockFailures++;
+        return -1;
+    }
+    if (width != m_width || height != m_height) {
+        int32_t result = m_window->setBuffersGeometry(width, height);
+        if (result != 0) {
+            m_width = 0;
+            m_height = 0;
+            m_stats.lockFailures++;
+            return result;
+        }
+        m_width = width;
+        m_height = height;
+        m_stats.geometryChanges++;
+    }
+    int32_t result = m_window->lock(buffer);
+    if (result != 0) {
+        // The window may have been resized or recreated underneath; set the geometry again next time
+        m_width = 0;
+        m_height = 0;
+        m_stats.lockFailures++;
+    }
+    return result;
+}
+
+int32_t WindowPresenter::post() {
+    if (!m_window) {
+        return -1;
+    }
+    int32_t result = m_window->unlockAndPost();
+    if (result == 0) {
+        m_stats.presented++;
+    }
+    return result;
+}
+
+bool WindowPresenter::writeFrame(const frame_data_t& frame, const ANativeWindow_Buffer& buffer, bool useRga) {
+    if (!buffer.bits || buffer.width < frame.screenW || buffer.height < frame.screenH) {
+        LOGW("Frame %d (%dx%d) does not fit the %dx%d window buffer", frame.frameId, frame.screenW, frame.screenH,
+             buffer.width, buffer.height);
+        return false;
+    }
+    return FrameConverter::toRGBA(frame, static_cast<uint8_t*>(buffer.bits), buffer.stride * 4, useRga);
+}
+
+bool WindowPresenter::writeRGBA(const uint8_t* src, int width, int height, int srcStride,
+                                const ANativeWindow_Buffer& buffer) {
+    if (!src || !buffer.bits || width <= 0 || height <= 0 || srcStride < width * 4 || buffer.width < width ||
+        buffer.height < height) {
+        LOGW("RGBA frame %dx%d (stride %d) does not fit the %dx%d window buffer", width, height, srcStride,
+             buffer.width, buffer.height);
+        return false;
+    }
+    // Only the frame's own bytes: the window stride is often wider than the frame
+    uint8_t* dst = static_cast<uint8_t*>(buffer.bits);
+    int dstStride = buffer.stride * 4;
+    if (srcStride == dstStride) {
+        memcpy(dst, src, static_cast<size_t>(dstStride) * (height - 1) + width * 4);
+        return true;
+    }
+    for (int row = 0; row < height; row++) {
+        memcpy(dst + static_cast<size_t>(row) * dstStride, src + static_cast<size_t>(row) * srcStride, width * 4);
+    }
+    return true;
+}
+
+bool WindowPresenter::present(const frame_data_t& frame, bool useRga) {
+    ANativeWindow_Buffer buffer;
+    if (lock(frame.screenW, frame.screenH, buffer) != 0) {
+        return false;
+    }
+    return finish(writeFrame(frame, buffer, useRga));
+}
+
+bool WindowPresenter::presentRGBA(const uint8_t* src, int width, int height, int srcStride) {
+    ANativeWindow_Buffer buffer;
+    if (lock(width, height, buffer) != 0) {
+        return false;
+    }
+    return finish(writeRGBA(src, width, height, srcStride, buffer));
+}
+
+bool WindowPresenter::finish(bool written) {
+    if (!written) {
+        m_stats.writeFailures++;
+    }
+    return post() == 0 && written;
+}
+
+WindowPresenter::Stats WindowPresenter::getStats() const {
+    return m_stats;
+}
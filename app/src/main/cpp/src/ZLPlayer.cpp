@@ -6,6 +6,7 @@
 #include "ZLPlayer.h"
 #include "mpp_err.h"
 #include "cv_draw.h"
+#include "FrameConverter.h"
 // Yolov8ThreadPool *yolov8_thread_pool;   // 线程池
 
 extern pthread_mutex_t windowMutex;     // 静态初始化 所
@@ -26,9 +27,8 @@ void *desplay_process(void *arg) {
     if (player) {
         while (player->isStreaming) {
             try {
+                // display() paces itself to the stream frame rate and sleeps when idle
                 player->display();
-                // Add small delay to prevent excessive CPU usage
-                std::this_thread::sleep_for(std::chrono::milliseconds(16)); // ~60 FPS
             } catch (...) {
                 LOGE("Exception in display process for channel %d", player->channelIndex);
                 break;
@@ -49,7 +49,8 @@ void ZLPlayer::setModelFile(char *data, int dataLen) {
     this->modelFileSize = dataLen;
 }
 
-ZLPlayer::ZLPlayer(char *modelFileData, int modelDataLen) {
+ZLPlayer::ZLPlayer(char *modelFileData, int modelDataLen, InferenceScheduler *scheduler, int channelIndex,
+                   MultiSurfaceRenderer *renderer) {
 
     // this->data_source = new char[strlen(data_source) + 1];
     // strcpy(this->data_source, data_source); // 把源 Copy给成员
@@ -75,23 +76,36 @@ ZLPlayer::ZLPlayer(char *modelFileData, int modelDataLen) {
     LOGD("create mpp for model size: %d bytes", modelDataLen);
     // 创建上下文
     memset(&app_ctx, 0, sizeof(rknn_app_context_t)); // 初始化上下文
+    this->channelIndex = channelIndex;
+    app_ctx.channelIndex = channelIndex;
+    app_ctx.detectionCadence = &detectionCadence;
 
     try {
-        // 创建YOLOv5线程池
-        app_ctx.yolov5ThreadPool = new Yolov5ThreadPool(); // 创建线程池
-        if (!app_ctx.yolov5ThreadPool) {
-            throw std::runtime_error("Failed to create YOLOv5 thread pool");
-        }
+        if (scheduler) {
+            // 共享调度器：所有通道复用同一组推理实例，本通道只占一个调度队列
+            int result = scheduler->registerChannel(channelIndex);
+            if (result != NN_SUCCESS) {
+                LOGE("Failed to register channel %d with inference scheduler, error: %d", channelIndex, result);
+                throw std::runtime_error("Failed to register with inference scheduler");
+            }
+            app_ctx.inferenceScheduler = scheduler;
+        } else {
+            // 创建YOLOv5线程池
+            app_ctx.yolov5ThreadPool = new Yolov5ThreadPool(); // 创建线程池
+            if (!app_ctx.yolov5ThreadPool) {
+                throw std::runtime_error("Failed to create YOLOv5 thread pool");
+            }
 
-        // 设置模型数据，减少线程池大小以节省内存（多通道模式下使用更小的线程池）
-        int result = app_ctx.yolov5ThreadPool->setUpWithModelData(5, this->modelFileContent, this->modelFileSize);
-        if (result != NN_SUCCESS) {
-            LOGE("Failed to setup YOLOv5 thread pool with model data, error: %d", result);
-            throw std::runtime_error("Failed to setup YOLOv5 thread pool");
+            // 设置模型数据，减少线程池大小以节省内存（多通道模式下使用更小的线程池）
+            int result = app_ctx.yolov5ThreadPool->setUpWithModelData(5, this->modelFileContent, this->modelFileSize);
+            if (result != NN_SUCCESS) {
+                LOGE("Failed to setup YOLOv5 thread pool with model data, error: %d", result);
+                throw std::runtime_error("Failed to setup YOLOv5 thread pool");
+            }
         }
 
-        // Initialize render frame queue
-        app_ctx.renderFrameQueue = new RenderFrameQueue();
+        // Initialize render frame queue (in-order jitter buffer for PTS-scheduled display)
+        app_ctx.renderFrameQueue = new RenderFrameQueue(RENDER_QUEUE_PTS_DEPTH, channelIndex);
         if (!app_ctx.renderFrameQueue) {
             throw std::runtime_error("Failed to create render frame queue");
         }
@@ -104,31 +118,51 @@ ZLPlayer::ZLPlayer(char *modelFileData, int modelDataLen) {
                 throw std::runtime_error("Failed to create MPP decoder");
             }
 
-            int initResult = decoder->Init(264, 25, &app_ctx);  // 初始化解码器
+            int initResult = decoder->Init(264, DISPLAY_FPS, &app_ctx);  // 初始化解码器
             if (initResult != 0) {
                 LOGE("Failed to initialize MPP decoder, error: %d", initResult);
                 delete decoder;
                 throw std::runtime_error("Failed to initialize MPP decoder");
             }
 
-            decoder->SetCallback(mpp_decoder_frame_callback); // 设置回调函数，用来处理解码后的数据
+            // 设置回调函数，用来处理解码后的数据；帧以租约形式直接引用解码缓冲，不拷贝。
+            // 下游（调度队列、推理、重排、渲染队列）能压住的帧比租约名额多，名额用完时改为拷贝交出
+            decoder->SetCallback(mpp_decoder_frame_callback);
+            decoder->SetLeaseCallback(mpp_decoder_frame_lease_callback);
+            // 网络线程只入队，送包/取帧在解码器自己的线程里进行
+            if (decoder->StartAsync() != 0) {
+                LOGE("Failed to start decoder threads");
+                delete decoder;
+                throw std::runtime_error("Failed to start MPP decoder threads");
+            }
             app_ctx.decoder = decoder;                        // 将解码器赋值给上下文
         } else {
             LOGD("decoder is not null");
         }
 
         // 启动rtsp线程
+        isStreaming = true;
         int rtspResult = pthread_create(&pid_rtsp, nullptr, rtps_process, this);
         if (rtspResult != 0) {
             LOGE("Failed to create RTSP thread, error: %d", rtspResult);
             throw std::runtime_error("Failed to create RTSP thread");
         }
 
-        // 启动显示线程
-        int renderResult = pthread_create(&pid_render, nullptr, desplay_process, this);
-        if (renderResult != 0) {
-            LOGE("Failed to create render thread, error: %d", renderResult);
-            throw std::runtime_error("Failed to create render thread");
+        if (renderer) {
+            // 共享渲染线程池按本通道帧的送显时间调度，不再单独起显示线程
+            if (!renderer->addSource(channelIndex, this)) {
+                LOGE("Failed to register channel %d with the surface renderer", channelIndex);
+                throw std::runtime_error("Failed to register with surface renderer");
+            }
+            presentRenderer = renderer;
+            presentChannel = channelIndex;
+        } else {
+            // 启动显示线程
+            int renderResult = pthread_create(&pid_render, nullptr, desplay_process, this);
+            if (renderResult != 0) {
+                LOGE("Failed to create render thread, error: %d", renderResult);
+                throw std::runtime_error("Failed to create render thread");
+            }
         }
 
         LOGD("ZLPlayer initialized successfully");
@@ -136,6 +170,12 @@ ZLPlayer::ZLPlayer(char *modelFileData, int modelDataLen) {
     } catch (const std::exception& e) {
         LOGE("Exception during ZLPlayer initialization: %s", e.what());
         // Cleanup on failure
+        isStreaming = false;
+        stopPresenting();
+        if (app_ctx.inferenceScheduler) {
+            app_ctx.inferenceScheduler->unregisterChannel(app_ctx.channelIndex);
+            app_ctx.inferenceScheduler = nullptr;
+        }
         if (app_ctx.yolov5ThreadPool) {
             delete app_ctx.yolov5ThreadPool;
             app_ctx.yolov5ThreadPool = nullptr;
@@ -165,13 +205,14 @@ on_track_frame_out(void *user_data, mk_frame frame) {
     ctx->dts = mk_frame_get_dts(frame);
     ctx->pts = mk_frame_get_pts(frame);
     size_t size = mk_frame_get_data_size(frame);
-    if (mk_frame_get_flags(frame) & MK_FRAME_FLAG_IS_KEY) {
+    int flags = mk_frame_get_flags(frame);
+    if (flags & MK_FRAME_FLAG_IS_KEY) {
         LOGD("Key frame size: %zu", size);
-    } else if (MK_FRAME_FLAG_DROP_ABLE & mk_frame_get_flags(frame)) {
+    } else if (MK_FRAME_FLAG_DROP_ABLE & flags) {
         LOGD("Drop able: %zu", size);
-    } else if (MK_FRAME_FLAG_IS_CONFIG & mk_frame_get_flags(frame)) {
+    } else if (MK_FRAME_FLAG_IS_CONFIG & flags) {
         LOGD("Config frame: %zu", size);
-    } else if (MK_FRAME_FLAG_NOT_DECODE_ABLE & mk_frame_get_flags(frame)) {
+    } else if (MK_FRAME_FLAG_NOT_DECODE_ABLE & flags) {
         LOGD("Not decode able: %zu", size);
     } else {
         // LOGD("P-frame: %zu", size);
@@ -179,7 +220,11 @@ on_track_frame_out(void *user_data, mk_frame frame) {
 
     // LOGD("ctx->dts :%ld, ctx->pts :%ld", ctx->dts, ctx->pts);
     // LOGD("decoder=%p\n", ctx->decoder);
-    ctx->decoder->Decode((uint8_t *) data, size, 0);
+    // 只拷贝入队，不在ZLMediaKit的回调线程里解码；解码跟不上时丢到下一个IDR
+    if (!ctx->decoder->SubmitPacket((const uint8_t *) data, size, ctx->pts, (flags & MK_FRAME_FLAG_IS_KEY) != 0,
+                                    (flags & MK_FRAME_FLAG_IS_CONFIG) != 0)) {
+        LOGD("channel %d: packet dropped, waiting for next key frame", ctx->channelIndex);
+    }
 }
 
 void API_CALL
@@ -213,13 +258,61 @@ on_mk_shutdown_func(void *user_data, int err_code, const char *err_msg, mk_track
 
 // Channel-specific frame rendering using channel's own surface
 void ZLPlayer::renderFrame(uint8_t *src_data, int width, int height, int src_line_size) {
+    ANativeWindow_Buffer window_buffer;
+    if (!lockChannelSurface(width, height, window_buffer)) {
+        return;
+    }
+
+    // 按源、窗口各自的行跨度逐行拷贝width * 4字节（窗口stride常大于图像宽度）
+    if (!WindowPresenter::writeRGBA(src_data, width, height, src_line_size, window_buffer)) {
+        LOGE("Channel %d: Failed to copy %dx%d frame into the window buffer", channelIndex, width, height);
+    }
+
+    postChannelSurface(width, height);
+}
+
+// NV12帧在这里才转换成RGBA，直接写进窗口缓冲区，不经过中间RGBA帧
+bool ZLPlayer::renderFrame(const frame_data_t &frame, bool drawDetections) {
+    ANativeWindow_Buffer window_buffer;
+    if (!lockChannelSurface(frame.screenW, frame.screenH, window_buffer)) {
+        return false;
+    }
+
+    uint8_t *dst_data = static_cast<uint8_t *>(window_buffer.bits);
+    int dst_linesize = window_buffer.stride * 4;
+    bool written = WindowPresenter::writeFrame(frame, window_buffer);
+    if (!written) {
+        LOGE("Channel %d: Failed to convert frame %d (format %d) for display", channelIndex, frame.frameId,
+             frame.frameFormat);
+    } else if (drawDetections) {
+        drawDetectionsRGBA(dst_data, frame.screenW, frame.screenH, dst_linesize, frame.detections);
+    }
+
+    postChannelSurface(frame.screenW, frame.screenH);
+    return written;
+}
+
+void ZLPlayer::drawDetectionsRGBA(uint8_t *rgba, int width, int height, int stride,
+                                  const std::vector<Detection> &detections) {
+    if (enhancedDetectionRenderer) {
+        // Use enhanced detection rendering for better multi-channel performance
+        enhancedDetectionRenderer->renderDetections(channelIndex, rgba, width, height, stride, detections);
+    } else {
+        // Fallback to adaptive rendering
+        DrawDetectionsAdaptive(rgba, width, height, stride, detections, channelIndex, isActiveChannel,
+                               getCurrentSystemLoad());
+    }
+}
+
+// 成功时返回true并持有surfaceMutex，由postChannelSurface送显并释放
+bool ZLPlayer::lockChannelSurface(int width, int height, ANativeWindow_Buffer &window_buffer) {
 
     pthread_mutex_lock(&surfaceMutex);
     if (!channelSurface) {
         LOGW("Channel %d: ANativeWindow is null, cannot render frame. Surface was not set properly.", channelIndex);
-        LOGW("Channel %d: Frame data - width: %d, height: %d, src_line_size: %d", channelIndex, width, height, src_line_size);
+        LOGW("Channel %d: Frame data - width: %d, height: %d", channelIndex, width, height);
         pthread_mutex_unlock(&surfaceMutex);
-        return;
+        return false;
     }
 
     // Enhanced Surface validity check
@@ -237,6 +330,7 @@ void ZLPlayer::renderFrame(uint8_t *src_data, int width, int height, int src_lin
         if (surfaceInvalidCount > MAX_SURFACE_INVALID_COUNT) {
             LOGE("Channel %d: Surface invalid count exceeded limit (%d), clearing surface",
                  channelIndex, MAX_SURFACE_INVALID_COUNT);
+            surfacePresenter.setWindow(nullptr);
             ANativeWindow_release(channelSurface);
             channelSurface = nullptr;
             surfaceInvalidCount = 0;
@@ -252,7 +346,7 @@ void ZLPlayer::renderFrame(uint8_t *src_data, int width, int height, int src_lin
         }
 
         pthread_mutex_unlock(&surfaceMutex);
-        return;
+        return false;
     } else {
         // Reset invalid count on successful validation
         surfaceInvalidCount = 0;
@@ -261,21 +355,11 @@ void ZLPlayer::renderFrame(uint8_t *src_data, int width, int height, int src_lin
     LOGD("Channel %d: Rendering frame to surface %p, size: %dx%d (surface: %dx%d)",
          channelIndex, channelSurface, width, height, surfaceWidth, surfaceHeight);
 
-    // 设置窗口的大小，各个属性
-    int setBuffersResult = ANativeWindow_setBuffersGeometry(channelSurface, width, height, WINDOW_FORMAT_RGBA_8888);
-    if (setBuffersResult != 0) {
-        LOGE("Channel %d: Failed to set buffer geometry, result: %d", channelIndex, setBuffersResult);
-        pthread_mutex_unlock(&surfaceMutex);
-        return;
-    }
-
-    // 他自己有个缓冲区 buffer
-    ANativeWindow_Buffer window_buffer;
-
+    // 窗口缓冲区的尺寸只在帧尺寸变化时重新设置，然后锁定缓冲区
     // 如果我在渲染的时候，是被锁住的，那我就无法渲染，我需要释放 ，防止出现死锁
-    int lockResult = ANativeWindow_lock(channelSurface, &window_buffer, 0);
+    int lockResult = surfacePresenter.lock(width, height, window_buffer);
     if (lockResult != 0) {
-        LOGE("Channel %d: Failed to lock surface buffer, result: %d", channelIndex, lockResult);
+        LOGE("Channel %d: Failed to set geometry or lock surface buffer, result: %d", channelIndex, lockResult);
 
         // Track consecutive lock failures
         surfaceLockFailCount++;
@@ -296,24 +380,18 @@ void ZLPlayer::renderFrame(uint8_t *src_data, int width, int height, int src_lin
         }
 
         pthread_mutex_unlock(&surfaceMutex);
-        return;
+        return false;
     } else {
         // Reset lock fail count on successful lock
         surfaceLockFailCount = 0;
     }
 
-    // 填充[window_buffer]  画面就出来了  ==== 【目标 window_buffer】
-    uint8_t *dst_data = static_cast<uint8_t *>(window_buffer.bits);
-    int dst_linesize = window_buffer.stride * 4;
-
-    for (int i = 0; i < window_buffer.height; ++i) {
-        // 图：一行一行显示 [高度不用管，用循环了，遍历高度]
-        // 通用的
-        memcpy(dst_data + i * dst_linesize, src_data + i * src_line_size, dst_linesize); // OK的
-    }
+    return true;
+}
 
+void ZLPlayer::postChannelSurface(int width, int height) {
     // 数据刷新
-    int unlockResult = ANativeWindow_unlockAndPost(channelSurface);
+    int unlockResult = surfacePresenter.post();
     if (unlockResult != 0) {
         LOGE("Channel %d: Failed to unlock and post surface buffer, result: %d", channelIndex, unlockResult);
     } else {
@@ -327,6 +405,16 @@ void ZLPlayer::renderFrame(uint8_t *src_data, int width, int height, int src_lin
 
             LOGD("Channel %d: Successfully rendered frame #%d at timestamp: %ld (surface: %p, size: %dx%d)",
                  channelIndex, frameCounter, timestamp, channelSurface, width, height);
+            RenderFrameQueue::Stats queueStats = app_ctx.renderFrameQueue->getStats();
+            PresentationClock::Stats clockStats = presentationClock.getStats();
+            WindowPresenter::Stats presentStats = surfacePresenter.getStats();
+            LOGD("Channel %d: render queue pushed %llu, shown %llu, dropped %llu; late %llu, clock resets %llu, "
+                 "interval %lld us, jitter delay %lld us; geometry changes %llu, write failures %llu", channelIndex,
+                 (unsigned long long) queueStats.pushed, (unsigned long long) queueStats.popped,
+                 (unsigned long long) queueStats.dropped, (unsigned long long) clockStats.droppedLate,
+                 (unsigned long long) clockStats.resets, (long long) clockStats.frameIntervalUs,
+                 (long long) clockStats.delayUs, (unsigned long long) presentStats.geometryChanges,
+                 (unsigned long long) presentStats.writeFailures);
         }
     }
 
@@ -334,105 +422,175 @@ void ZLPlayer::renderFrame(uint8_t *src_data, int width, int height, int src_lin
 }
 
 void ZLPlayer::display() {
+    int64_t nowUs = PresentationClock::nowUs();
+    int64_t timeUs = nowUs;
+    int dropped = 0;
+    bool ready = nextFrame(nowUs, timeUs, dropped);
+
+    // Wait for the frame's presentation time, or until it is worth looking at the queue again
+    if (timeUs > nowUs) {
+        std::this_thread::sleep_for(std::chrono::microseconds(timeUs - nowUs));
+    }
+    if (ready) {
+        presentFrame();
+    }
+}
+
+bool ZLPlayer::surfaceRecoveryPending(int &retryMs) {
     // Check if surface recovery is needed with timeout mechanism
-    if (surfaceRecoveryRequested) {
-        struct timeval currentTime;
-        gettimeofday(&currentTime, NULL);
-        long currentTimeMs = currentTime.tv_sec * 1000 + currentTime.tv_usec / 1000;
-
-        // Check if recovery has timed out
-        if (surfaceRecoveryRequestTime > 0 &&
-            (currentTimeMs - surfaceRecoveryRequestTime) > SURFACE_RECOVERY_TIMEOUT_MS) {
-
-            LOGE("Channel %d: Surface recovery timed out after %ld ms, attempt %d/%d",
-                 channelIndex, (currentTimeMs - surfaceRecoveryRequestTime),
-                 surfaceRecoveryAttempts, MAX_SURFACE_RECOVERY_ATTEMPTS);
-
-            surfaceRecoveryAttempts++;
-
-            if (surfaceRecoveryAttempts >= MAX_SURFACE_RECOVERY_ATTEMPTS) {
-                LOGE("Channel %d: Maximum surface recovery attempts reached, forcing reset", channelIndex);
-                // Force reset the recovery state to prevent permanent blocking
-                surfaceRecoveryRequested = false;
-                surfaceRecoveryRequestTime = 0;
-                surfaceRecoveryAttempts = 0;
-                surfaceInvalidCount = 0;
-                surfaceLockFailCount = 0;
-
-                // Continue with normal rendering attempt
-            } else {
-                // Reset recovery request time for next attempt
-                surfaceRecoveryRequestTime = currentTimeMs;
-                LOGW("Channel %d: Surface recovery timeout, retrying (attempt %d/%d)",
-                     channelIndex, surfaceRecoveryAttempts, MAX_SURFACE_RECOVERY_ATTEMPTS);
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                return;
-            }
-        } else {
-            LOGW("Channel %d: Surface recovery requested, skipping frame rendering (elapsed: %ld ms)",
-                 channelIndex, surfaceRecoveryRequestTime > 0 ? (currentTimeMs - surfaceRecoveryRequestTime) : 0);
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
-            return;
+    if (!surfaceRecoveryRequested) {
+        return false;
+    }
+
+    struct timeval currentTime;
+    gettimeofday(&currentTime, NULL);
+    long currentTimeMs = currentTime.tv_sec * 1000 + currentTime.tv_usec / 1000;
+
+    // Check if recovery has timed out
+    if (surfaceRecoveryRequestTime > 0 &&
+        (currentTimeMs - surfaceRecoveryRequestTime) > SURFACE_RECOVERY_TIMEOUT_MS) {
+
+        LOGE("Channel %d: Surface recovery timed out after %ld ms, attempt %d/%d",
+             channelIndex, (currentTimeMs - surfaceRecoveryRequestTime),
+             surfaceRecoveryAttempts, MAX_SURFACE_RECOVERY_ATTEMPTS);
+
+        surfaceRecoveryAttempts++;
+
+        if (surfaceRecoveryAttempts >= MAX_SURFACE_RECOVERY_ATTEMPTS) {
+            LOGE("Channel %d: Maximum surface recovery attempts reached, forcing reset", channelIndex);
+            // Force reset the recovery state to prevent permanent blocking
+            surfaceRecoveryRequested = false;
+            surfaceRecoveryRequestTime = 0;
+            surfaceRecoveryAttempts = 0;
+            surfaceInvalidCount = 0;
+            surfaceLockFailCount = 0;
+
+            // Continue with normal rendering attempt
+            return false;
         }
+
+        // Reset recovery request time for next attempt
+        surfaceRecoveryRequestTime = currentTimeMs;
+        LOGW("Channel %d: Surface recovery timeout, retrying (attempt %d/%d)",
+             channelIndex, surfaceRecoveryAttempts, MAX_SURFACE_RECOVERY_ATTEMPTS);
+        retryMs = 100;
+        return true;
     }
 
-    int queueSize = app_ctx.renderFrameQueue->size();
-    if (queueSize > 5) {  // Only log when queue is getting full
-        LOGD("app_ctx.renderFrameQueue.size() :%d", queueSize);
+    LOGW("Channel %d: Surface recovery requested, skipping frame rendering (elapsed: %ld ms)",
+         channelIndex, surfaceRecoveryRequestTime > 0 ? (currentTimeMs - surfaceRecoveryRequestTime) : 0);
+    retryMs = 50;
+    return true;
+}
+
+bool ZLPlayer::nextFrame(int64_t nowUs, int64_t &timeUs, int &droppedFrames) {
+    if (pendingFrame) {
+        timeUs = pendingPresentUs;
+        return true;
     }
 
-    auto frameDataPtr = app_ctx.renderFrameQueue->pop();
-    if (frameDataPtr == nullptr) {
-        // No frame available, this is normal with timeout-based pop
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        return;
+    int retryMs = 0;
+    if (surfaceRecoveryPending(retryMs)) {
+        timeUs = nowUs + retryMs * 1000;
+        return false;
     }
 
-    // Validate frame data before rendering
-    if (!frameDataPtr->data || frameDataPtr->screenW <= 0 || frameDataPtr->screenH <= 0) {
-        LOGE("Invalid frame data: data=%p, w=%d, h=%d",
-             frameDataPtr->data.get(), frameDataPtr->screenW, frameDataPtr->screenH);
-        return;
+    while (std::shared_ptr<frame_data_t> frameDataPtr = app_ctx.renderFrameQueue->pop()) {
+        // Schedule on the frame's PTS: present at its presentation time, or drop it if that has already passed
+        int64_t readyTimeUs = frameDataPtr->readyTimeUs > 0 ? frameDataPtr->readyTimeUs : nowUs;
+        PresentationClock::Decision decision = presentationClock.schedule(frameDataPtr->pts, readyTimeUs, nowUs);
+        if (decision.action == PresentationClock::DROP_LATE) {
+            LOGD("Channel %d: frame %d (pts %lld) is %lld us late, dropped", channelIndex, frameDataPtr->frameId,
+                 (long long) frameDataPtr->pts, (long long) (nowUs - decision.presentTimeUs));
+            droppedFrames++;
+            continue;
+        }
+
+        // Validate frame data before rendering
+        if (!frameDataPtr->data || frameDataPtr->screenW <= 0 || frameDataPtr->screenH <= 0) {
+            LOGE("Invalid frame data: data=%p, w=%d, h=%d",
+                 frameDataPtr->data.get(), frameDataPtr->screenW, frameDataPtr->screenH);
+            droppedFrames++;
+            continue;
+        }
+
+        pendingFrame = frameDataPtr;
+        pendingPresentUs = decision.presentTimeUs;
+        timeUs = pendingPresentUs;
+        return true;
+    }
+
+    // Nothing queued; keep the previous picture on screen and look again within a fraction of a frame
+    timeUs = nowUs + presentationClock.getStats().frameIntervalUs / 8;
+    return false;
+}
+
+bool ZLPlayer::presentFrame() {
+    std::shared_ptr<frame_data_t> frameDataPtr = std::move(pendingFrame);
+    pendingFrame.reset();
+    if (!frameDataPtr) {
+        return false;
     }
 
     // Draw detection results on the frame if available
+    bool overlayOnWindow = false;
     if (frameDataPtr->hasDetections && !frameDataPtr->detections.empty()) {
         LOGD("Drawing %zu detections on frame %d", frameDataPtr->detections.size(), frameDataPtr->frameId);
 
-        // Use enhanced detection rendering for better multi-channel performance
-        if (enhancedDetectionRenderer) {
-            enhancedDetectionRenderer->renderDetections(
-                channelIndex,
-                (uint8_t*)frameDataPtr->data.get(),
-                frameDataPtr->screenW,
-                frameDataPtr->screenH,
-                frameDataPtr->screenStride,
-                frameDataPtr->detections
-            );
+        if (!FrameConverter::isWritable(*frameDataPtr)) {
+            // 借用的MPP解码缓冲可能仍被解码器当作参考帧，不能在上面画：转换成RGBA后画在窗口缓冲区
+            overlayOnWindow = true;
+        } else if (FrameConverter::isNV12(*frameDataPtr)) {
+            // NV12帧直接在YUV上画框，显示时才转RGBA
+            if (enhancedDetectionRenderer) {
+                enhancedDetectionRenderer->renderDetectionsNV12(
+                    channelIndex,
+                    (uint8_t*)frameDataPtr->data.get(),
+                    frameDataPtr->screenW,
+                    frameDataPtr->screenH,
+                    FrameConverter::rowStride(*frameDataPtr),
+                    frameDataPtr->heightStride,
+                    frameDataPtr->detections
+                );
+            } else {
+                DrawDetectionsAdaptiveNV12((uint8_t*)frameDataPtr->data.get(),
+                                           frameDataPtr->screenW,
+                                           frameDataPtr->screenH,
+                                           FrameConverter::rowStride(*frameDataPtr),
+                                           frameDataPtr->heightStride,
+                                           frameDataPtr->detections,
+                                           channelIndex,
+                                           isActiveChannel,
+                                           getCurrentSystemLoad());
+            }
         } else {
-            // Fallback to adaptive rendering
-            DrawDetectionsAdaptive((uint8_t*)frameDataPtr->data.get(),
-                                 frameDataPtr->screenW,
-                                 frameDataPtr->screenH,
-                                 frameDataPtr->screenStride,
-                                 frameDataPtr->detections,
-                                 channelIndex,
-                                 isActiveChannel,
-                                 getCurrentSystemLoad());
+            drawDetectionsRGBA((uint8_t*)frameDataPtr->data.get(), frameDataPtr->screenW, frameDataPtr->screenH,
+                               frameDataPtr->screenStride, frameDataPtr->detections);
         }
     }
 
-    // Render the frame using the smart pointer's get() method
-    renderFrame((uint8_t *) frameDataPtr->data.get(), frameDataPtr->screenW,
-                frameDataPtr->screenH, frameDataPtr->screenStride);
+    // Render the frame (converted to RGBA straight into the window buffer)
+    bool rendered = renderFrame(*frameDataPtr, overlayOnWindow);
 
     // Frame data is managed by shared_ptr, no manual deletion needed
     LOGD("Rendered frame %d: %dx%d with %zu detections", frameDataPtr->frameId,
          frameDataPtr->screenW, frameDataPtr->screenH,
          frameDataPtr->hasDetections ? frameDataPtr->detections.size() : 0);
+    return rendered;
+}
 
-    // Control frame rate - limit to ~30 FPS
-    std::this_thread::sleep_for(std::chrono::milliseconds(33));
+void ZLPlayer::dropFrame() {
+    if (pendingFrame) {
+        LOGD("Channel %d: frame %d missed its presentation time, dropped", channelIndex, pendingFrame->frameId);
+        pendingFrame.reset();
+    }
+}
+
+void ZLPlayer::stopPresenting() {
+    if (presentRenderer) {
+        presentRenderer->removeSurface(presentChannel);
+        presentRenderer = nullptr;
+    }
 }
 
 // Enhanced detection rendering methods implementation
@@ -446,13 +604,39 @@ void ZLPlayer::setRenderingMonitor(std::shared_ptr<DetectionRenderingMonitor> mo
     LOGD("Rendering monitor set for ZLPlayer");
 }
 
+void ZLPlayer::setDetectionCadence(const DetectionCadence::Config &config) {
+    detectionCadence.setConfig(config);
+    LOGD("Channel %d: detection cadence interval %d, adaptive %d (max %d)", channelIndex, config.interval,
+         config.adaptive, config.maxInterval);
+}
+
 void ZLPlayer::setChannelIndex(int index) {
+    if (app_ctx.inferenceScheduler && app_ctx.channelIndex != index) {
+        // 调度队列按通道号索引，改号时迁移到新队列
+        app_ctx.inferenceScheduler->unregisterChannel(app_ctx.channelIndex);
+        app_ctx.inferenceScheduler->registerChannel(index);
+        app_ctx.inferenceScheduler->setChannelActive(index, isActiveChannel);
+    }
+    if (presentRenderer && presentChannel != index) {
+        // 渲染器按通道号索引，改号时重新登记
+        presentRenderer->removeSurface(presentChannel);
+        if (presentRenderer->addSource(index, this)) {
+            presentChannel = index;
+        } else {
+            LOGE("Failed to move channel %d to %d in the surface renderer", presentChannel, index);
+            presentRenderer = nullptr;
+        }
+    }
     channelIndex = index;
+    app_ctx.channelIndex = index;
     LOGD("Channel index set to %d", index);
 }
 
 void ZLPlayer::setActiveChannel(bool active) {
     isActiveChannel = active;
+    if (app_ctx.inferenceScheduler) {
+        app_ctx.inferenceScheduler->setChannelActive(app_ctx.channelIndex, active);
+    }
     if (enhancedDetectionRenderer) {
         enhancedDetectionRenderer->setChannelActive(channelIndex, active);
     }
@@ -490,6 +674,7 @@ void ZLPlayer::setChannelSurface(ANativeWindow* surface) {
         LOGD("Channel %d: Releasing previous surface: %p (size: %dx%d, format: %d) at timestamp: %ld",
              channelIndex, channelSurface, oldWidth, oldHeight, oldFormat, timestamp);
 
+        surfacePresenter.setWindow(nullptr);
         ANativeWindow_release(channelSurface);
         channelSurface = nullptr;
 
@@ -505,6 +690,7 @@ void ZLPlayer::setChannelSurface(ANativeWindow* surface) {
     channelSurface = surface;
     if (surface) {
         ANativeWindow_acquire(surface);
+        surfacePresenter.setWindow(NativePresentWindow::wrap(surface));
 
         // Log detailed new surface information
         int32_t newWidth = ANativeWindow_getWidth(surface);
@@ -591,6 +777,7 @@ void ZLPlayer::forceSurfaceReset() {
     // If we have a surface, release it
     if (channelSurface) {
         LOGW("Channel %d: Releasing surface during force reset: %p", channelIndex, channelSurface);
+        surfacePresenter.setWindow(nullptr);
         ANativeWindow_release(channelSurface);
         channelSurface = nullptr;
     }
@@ -600,63 +787,91 @@ void ZLPlayer::forceSurfaceReset() {
     LOGW("Channel %d: Surface force reset completed", channelIndex);
 }
 
+nn_error_e ZLPlayer::waitForInferenceResult(uint64_t &seen, int timeout_ms) {
+    if (app_ctx.inferenceScheduler) {
+        return app_ctx.inferenceScheduler->waitForResult(app_ctx.channelIndex, seen, timeout_ms);
+    }
+    if (app_ctx.yolov5ThreadPool) {
+        return app_ctx.yolov5ThreadPool->waitForResult(seen, timeout_ms);
+    }
+    return NN_STOPED;
+}
+
+bool ZLPlayer::fetchInferenceResult(int frameId, ResultReorderBuffer::Result &out) {
+    auto ret_code = app_ctx.inferenceScheduler
+                    ? app_ctx.inferenceScheduler->getTargetResultNonBlock(app_ctx.channelIndex, out.detections, frameId)
+                    : app_ctx.yolov5ThreadPool->getTargetResultNonBlock(out.detections, frameId);
+    if (ret_code != NN_SUCCESS) {
+        if (ret_code != NN_RESULT_NOT_READY) {
+            LOGW("getTargetResultNonBlock returned error code: %d", ret_code);
+        }
+        return false;
+    }
+    out.frame = app_ctx.inferenceScheduler
+                ? app_ctx.inferenceScheduler->getTargetImgResult(app_ctx.channelIndex, frameId)
+                : app_ctx.yolov5ThreadPool->getTargetImgResult(frameId);
+    return true;
+}
+
 void ZLPlayer::get_detect_result() {
     // 添加空指针检查和线程池初始化检查
-    if (!app_ctx.yolov5ThreadPool) {
+    if (!app_ctx.yolov5ThreadPool && !app_ctx.inferenceScheduler) {
         LOGE("yolov5ThreadPool is null, skipping result retrieval");
         return;
     }
 
-    // 检查渲染队列大小，防止内存积累
-    int queueSize = app_ctx.renderFrameQueue->size();
-    if (queueSize > DISPLAY_QUEUE_MAX_SIZE / 2) {
-        LOGW("Render queue getting full (%d), clearing old frames", queueSize);
-        app_ctx.renderFrameQueue->clear();
-    }
-
-    // 检查线程池是否已正确初始化
     try {
-        std::vector<Detection> objects;
-
-        // 安全地调用getTargetResultNonBlock
-        auto ret_code = app_ctx.yolov5ThreadPool->getTargetResultNonBlock(objects, app_ctx.result_cnt);
-
-        if (ret_code == NN_SUCCESS) {
-            LOGD("Successfully got detection results, count: %zu", objects.size());
+        // 推理线程乱序完成：按frameId顺序取出所有可输出的结果，迟迟未完成的帧超时或窗口满时跳过，不再阻塞后续帧
+        ResultReorderBuffer::Fetch fetch = [this](int frameId, ResultReorderBuffer::Result &out) {
+            return fetchInferenceResult(frameId, out);
+        };
+        ResultReorderBuffer::Result result;
+        while (resultReorder.next(fetch, result)) {
+            app_ctx.result_cnt = resultReorder.nextFrameId();
+            LOGD("Successfully got detection results for frame %d, count: %zu", result.frameId, result.detections.size());
 
             // Only log detection details in debug builds to reduce log spam
             #ifdef DEBUG
-            for (size_t idx = 0; idx < objects.size() && idx < 5; idx++) {  // Limit to first 5 objects
-                LOGD("objects[%zu].classId: %d, prop: %f, class: %s",
-                     idx, objects[idx].class_id, objects[idx].confidence, objects[idx].className.c_str());
+            for (size_t idx = 0; idx < result.detections.size() && idx < 5; idx++) {  // Limit to first 5 objects
+                LOGD("objects[%zu].classId: %d, prop: %f, class: %s", idx, result.detections[idx].class_id,
+                     result.detections[idx].confidence, result.detections[idx].className.c_str());
             }
             #endif
 
-            // 安全地获取图像结果
-            auto frameData = app_ctx.yolov5ThreadPool->getTargetImgResult(app_ctx.result_cnt);
+            ResultReorderBuffer::Stats reorderStats = resultReorder.getStats();
+            if (reorderStats.emitted % 300 == 0) {
+                DetectionCadence::Stats cadenceStats = detectionCadence.getStats();
+                LOGD("Channel %d: results in order %llu, skipped %llu, late %llu, reorder depth %d (max %d); "
+                     "detected %llu, tracked %llu, interval %d", channelIndex,
+                     (unsigned long long) reorderStats.emitted, (unsigned long long) reorderStats.skipped,
+                     (unsigned long long) reorderStats.late, reorderStats.depth, reorderStats.maxDepth,
+                     (unsigned long long) cadenceStats.detected, (unsigned long long) cadenceStats.skipped,
+                     cadenceStats.interval);
+            }
+
+            std::shared_ptr<frame_data_t> frameData = result.frame;
             if (frameData && frameData->data) {
-                app_ctx.result_cnt++;
                 LOGD("Get detect result counter:%d start display", app_ctx.result_cnt);
 
-                // 将检测结果存储到frame数据中
-                frameData->detections = objects;
+                // 将检测结果存储到frame数据中；检测节拍跳过的帧用跟踪器外推的检测框
+                if (frameData->detectionSkipped) {
+                    frameData->detections = boxTracker.predict();
+                } else {
+                    boxTracker.update(result.detections);
+                    frameData->detections = std::move(result.detections);
+                }
+                detectionCadence.reportMotion(boxTracker.motion());
                 frameData->hasDetections = true;
 
-                LOGD("Stored %zu detections in frame %d", objects.size(), frameData->frameId);
+                LOGD("Stored %zu detections in frame %d", frameData->detections.size(), frameData->frameId);
 
-                // 加入渲染队列
+                // 加入渲染队列，记录就绪时刻供显示端的呈现时钟估计抖动；队列满时丢弃本帧
+                frameData->readyTimeUs = PresentationClock::nowUs();
                 app_ctx.renderFrameQueue->push(frameData);
-                LOGD("Frame %d pushed to render queue, queue size: %d",
-                     frameData->frameId, app_ctx.renderFrameQueue->size());
-
+                LOGD("Frame %d pushed to render queue", frameData->frameId);
             } else {
-                LOGW("frameData is null or frameData->data is null for result %d", app_ctx.result_cnt);
+                LOGW("frameData is null or frameData->data is null for result %d", result.frameId);
             }
-
-        } else if (NN_RESULT_NOT_READY == ret_code) {
-            // Normal case - no result ready yet
-        } else {
-            LOGW("getTargetResultNonBlock returned error code: %d", ret_code);
         }
     } catch (const std::exception& e) {
         LOGE("Exception in get_detect_result: %s", e.what());
@@ -676,13 +891,18 @@ int ZLPlayer::process_video_rtsp() {
     mk_player_set_on_shutdown(player, on_mk_shutdown_func, &app_ctx);
     mk_player_play(player, rtsp_url);
 
-    while (1) {
-        // sleep(1);
-        // LOGD("Running");
-        // display();
-        // display();
+    // 推理完成时才唤醒，不再空转轮询；重组缓冲里有帧在等缺失的队头时，最多等到该队头的时限
+    uint64_t seenResults = 0;
+    while (isStreaming) {
+        int timeoutMs = resultReorder.msUntilDeadline(ResultReorderBuffer::Clock::now());
+        nn_error_e ret = waitForInferenceResult(seenResults, timeoutMs < 0 ? RESULT_IDLE_WAIT_MS : timeoutMs);
+        if (ret == NN_STOPED || ret == NN_CHANNEL_NOT_FOUND) {
+            // 线程池已停止或通道已从调度器注销
+            break;
+        }
         get_detect_result();
     }
+    LOGD("Channel %d: result loop exiting", channelIndex);
 
 #if 0
     std::vector<Detection> objects;
@@ -731,10 +951,19 @@ int ZLPlayer::process_video_rtsp() {
 ZLPlayer::~ZLPlayer() {
     LOGD("ZLPlayer destructor called");
 
-    // Stop threads gracefully
+    // Stop threads gracefully; decoder threads first so no frame reaches the pool being torn down.
+    // Stopping the pool (or unregistering from the scheduler) wakes the result loop.
+    isStreaming = false;
+    if (app_ctx.decoder) {
+        app_ctx.decoder->StopAsync();
+    }
     if (app_ctx.yolov5ThreadPool) {
         app_ctx.yolov5ThreadPool->stopAll();
     }
+    if (app_ctx.inferenceScheduler) {
+        // 调度器由通道管理器持有，这里只注销本通道
+        app_ctx.inferenceScheduler->unregisterChannel(app_ctx.channelIndex);
+    }
 
     // Wait for threads to finish
     // Note: pthread_cancel is not available on Android, threads should be stopped gracefully
@@ -743,10 +972,13 @@ ZLPlayer::~ZLPlayer() {
         pid_rtsp = 0;
     }
 
+    // Own display thread, or the shared render pool: nothing is presented after this
     if (pid_render != 0) {
         pthread_join(pid_render, nullptr);
         pid_render = 0;
     }
+    stopPresenting();
+    app_ctx.inferenceScheduler = nullptr;
 
     // Clean up resources
     if (app_ctx.renderFrameQueue) {
@@ -771,6 +1003,7 @@ ZLPlayer::~ZLPlayer() {
 
     // Release channel surface
     if (channelSurface) {
+        surfacePresenter.setWindow(nullptr);
         ANativeWindow_release(channelSurface);
         channelSurface = nullptr;
     }
@@ -780,6 +1013,83 @@ ZLPlayer::~ZLPlayer() {
 
 static struct timeval lastRenderTime;
 
+// getChannelStats持有调度器全局锁，解码线程每隔这么多帧才采样一次排队负载
+static const int INFERENCE_LOAD_SAMPLE_FRAMES = 8;
+
+// 解码帧提交推理（拷贝回调与租约回调共用）
+static void submit_decoded_frame(rknn_app_context_t *ctx, const std::shared_ptr<frame_data_t> &frameData) {
+    frameData->frameId = ctx->job_cnt;
+
+    ctx->frame_cnt++;
+
+    // 检测节拍：跳过的帧不推理，直接以空结果完成，仍按frameId顺序到达结果线程，由跟踪器补上检测框
+    float load;
+    if (ctx->inferenceScheduler) {
+        if ((ctx->frame_cnt - 1) % INFERENCE_LOAD_SAMPLE_FRAMES == 0) {
+            InferenceScheduler::ChannelStats stats;
+            ctx->inferenceScheduler->getChannelStats(ctx->channelIndex, stats);
+            ctx->inferenceLoad = (float) stats.queueDepth / ctx->inferenceScheduler->getConfig().maxQueueDepth;
+        }
+        load = ctx->inferenceLoad;
+    } else {
+        load = (float) ctx->yolov5ThreadPool->get_task_size() / MAX_TASK;
+    }
+    if (!ctx->detectionCadence->shouldDetect(load)) {
+        frameData->detectionSkipped = true;
+        nn_error_e ret = ctx->inferenceScheduler
+                         ? ctx->inferenceScheduler->completeWithoutInference(ctx->channelIndex, frameData)
+                         : ctx->yolov5ThreadPool->completeWithoutInference(frameData);
+        if (ret == NN_SUCCESS) {
+            ctx->job_cnt++;
+        }
+        return;
+    }
+
+    if (ctx->inferenceScheduler) {
+        // 共享调度器队列满时丢弃本帧，不占用frameId，结果侧按序取帧不会卡住
+        nn_error_e ret = ctx->inferenceScheduler->submitFrame(ctx->channelIndex, frameData);
+        if (ret == NN_SUCCESS) {
+            ctx->job_cnt++;
+        } else {
+            LOGD("channel %d frame dropped by inference scheduler, error: %d", ctx->channelIndex, ret);
+        }
+    } else {
+        int detectPoolSize = ctx->yolov5ThreadPool->get_task_size();
+        LOGD("detectPoolSize :%d", detectPoolSize);
+        // 线程池已停止或入队超时时丢弃本帧，同样不占用frameId
+        nn_error_e ret = ctx->yolov5ThreadPool->submitTask(frameData);
+        if (ret == NN_SUCCESS) {
+            ctx->job_cnt++;
+        } else {
+            LOGD("channel %d frame dropped by thread pool, error: %d", ctx->channelIndex, ret);
+        }
+    }
+}
+
+// 租约回调：帧直接引用MPP解码缓冲，不拷贝。推理和显示都释放后缓冲才归还解码器，
+// 被丢弃的帧（调度器队列满、显示跳帧）也就不再付出整帧拷贝
+void ZLPlayer::mpp_decoder_frame_lease_callback(void *userdata, const std::shared_ptr<MppFrameLease> &lease) {
+    rknn_app_context_t *ctx = (rknn_app_context_t *) userdata;
+    const mpp_frame_info_s &info = lease->Info();
+    if ((info.format & MPP_FRAME_FMT_MASK) != MPP_FMT_YUV420SP) {
+        LOGE("channel %d: unsupported decoder output format 0x%x", ctx->channelIndex, info.format);
+        return;
+    }
+
+    auto frameData = FrameBufferPool::shared()->acquireFrame();
+    frameData->dataSize = lease->Size();
+    frameData->screenStride = info.width_stride;
+    frameData->data = FrameBuffer(lease->Data(), FrameBufferDeleter(lease));
+    frameData->screenW = info.width;
+    frameData->screenH = info.height;
+    frameData->heightStride = info.height_stride;
+    frameData->widthStride = info.width_stride;
+    frameData->frameFormat = RK_FORMAT_YCbCr_420_SP;
+    frameData->pts = info.pts;  // 送包时设置的ZLMediaKit PTS，由MPP带到输出帧
+
+    submit_decoded_frame(ctx, frameData);
+}
+
 void ZLPlayer::mpp_decoder_frame_callback(void *userdata, int width_stride, int height_stride, int width, int height, int format, int fd, void *data) {
     rknn_app_context_t *ctx = (rknn_app_context_t *) userdata;
     struct timeval start;
@@ -830,25 +1140,27 @@ void ZLPlayer::mpp_decoder_frame_callback(void *userdata, int width_stride, int
     return;
 #endif
 
-    int dstImgSize = width_stride * height_stride * get_bpp_from_format(RK_FORMAT_RGBA_8888);
+    // 解码帧保持NV12：只拷贝一次，不做颜色转换；推理直接读NV12，检测框画在YUV上，
+    // 只有真正送显的帧才在显示线程转换成RGBA（FrameConverter）
+    int dstImgSize = width_stride * height_stride * 3 / 2;
     LOGD("img size is %d", dstImgSize);
-    // img size is 33177600 1080p: 8355840
-
-    // Use smart pointer for automatic memory management (C++11 compatible)
-    std::unique_ptr<char[]> dstBuf(new char[dstImgSize]());
 
-    rga_change_color(width_stride, height_stride, RK_FORMAT_YCbCr_420_SP, (char *) data,
-                     width_stride, height_stride, RK_FORMAT_RGBA_8888, dstBuf.get());
+    // 帧缓冲与frame_data_t均取自对象池，不再每帧分配并清零整帧；最后一个引用释放时回收
+    std::shared_ptr<FrameBufferPool> framePool = FrameBufferPool::shared();
+    FrameBufferKey key(width_stride, height_stride, RK_FORMAT_YCbCr_420_SP, width_stride);
+    FrameBuffer dstBuf = framePool->acquire(key, dstImgSize);
+    memcpy(dstBuf.get(), data, dstImgSize);
 
-    auto frameData = std::make_shared<frame_data_t>();
+    auto frameData = framePool->acquireFrame();
     frameData->dataSize = dstImgSize;
-    frameData->screenStride = width * get_bpp_from_format(RK_FORMAT_RGBA_8888);
+    frameData->screenStride = width_stride;  // NV12: Y平面每行字节数，UV平面位于 screenStride * heightStride
     frameData->data = std::move(dstBuf);  // Transfer ownership to frameData
     frameData->screenW = width;
     frameData->screenH = height;
     frameData->heightStride = height_stride;
     frameData->widthStride = width_stride;
-    frameData->frameFormat = RK_FORMAT_RGBA_8888;
+    frameData->frameFormat = RK_FORMAT_YCbCr_420_SP;
+    frameData->pts = ctx->decoder ? ctx->decoder->GetCallbackFramePts() : -1;  // 与租约回调一样带上ZLMediaKit PTS
 
     // LOGD(">>>>>  frame id:%d", frameData->frameId);
     // LOGD("mpp_decoder_frame_callback task list size :%d", ctx->mppDataThreadPool->get_task_size());
@@ -856,16 +1168,10 @@ void ZLPlayer::mpp_decoder_frame_callback(void *userdata, int width_stride, int
     // 放入显示队列
     // ctx->renderFrameQueue->push(frameData);
 
-    frameData->frameId = ctx->job_cnt;
-    int detectPoolSize = ctx->yolov5ThreadPool->get_task_size();
-    LOGD("detectPoolSize :%d", detectPoolSize);
-
     // ctx->mppDataThreadPool->submitTask(frameData);
     // ctx->job_cnt++;
     // 如果frameData->frameId为奇数
-    ctx->frame_cnt++;
-    ctx->yolov5ThreadPool->submitTask(frameData);
-    ctx->job_cnt++;
+    submit_decoded_frame(ctx, frameData);
 
     //    if (ctx->frame_cnt % 2 == 1) {
     //        // if (detectPoolSize < MAX_TASK) {
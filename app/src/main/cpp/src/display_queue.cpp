@@ -1,65 +1,106 @@
 #include "display_queue.h"
 
-void RenderFrameQueue::push(std::shared_ptr<frame_data_t> &frameDataPtr) {
-    // Check queue size before acquiring lock for better performance
-    if (m_queue.size() > DISPLAY_QUEUE_MAX_SIZE) {
-        LOGW("RenderFrameQueue::push queue size > %d, dropping frame %d",
-             DISPLAY_QUEUE_MAX_SIZE, frameDataPtr->frameId);
-        // No need to manually delete - smart pointer will handle cleanup automatically
-        return;
+RenderFrameQueue::RenderFrameQueue(size_t depth, int channelIndex)
+        : m_depth(depth > 0 ? depth : 1), m_channelIndex(channelIndex), m_back(0), m_front(1), m_middle(2),
+          m_tail(0), m_head(0), m_pushed(0), m_popped(0), m_dropped(0), m_invalid(0) {
+    if (m_depth > 1) {
+        m_slots.reset(new std::shared_ptr<frame_data_t>[m_depth]);
     }
+}
 
+bool RenderFrameQueue::push(std::shared_ptr<frame_data_t>& frameDataPtr) {
     // Validate frame data before adding to queue
     if (!frameDataPtr || !frameDataPtr->data) {
         LOGE("RenderFrameQueue::push received invalid frame data");
-        return;
+        m_invalid.fetch_add(1, std::memory_order_relaxed);
+        return false;
     }
 
-    std::unique_lock<std::mutex> lock(m_mutex);
-    m_queue.push(frameDataPtr);
-    lock.unlock();
-    m_cond.notify_one();
-
-    LOGD("RenderFrameQueue::push added frame %d, queue size: %d",
-         frameDataPtr->frameId, static_cast<int>(m_queue.size()));
+    m_pushed.fetch_add(1, std::memory_order_relaxed);
+    return m_depth == 1 ? pushMailbox(frameDataPtr) : pushFifo(frameDataPtr);
 }
 
 std::shared_ptr<frame_data_t> RenderFrameQueue::pop() {
-    std::unique_lock<std::mutex> lock(m_mutex);
-
-    // Wait with timeout to prevent indefinite blocking
-    if (!m_cond.wait_for(lock, std::chrono::milliseconds(100), [this] { return !m_queue.empty(); })) {
-        // Timeout occurred, return nullptr
-        return nullptr;
+    std::shared_ptr<frame_data_t> data = m_depth == 1 ? popMailbox() : popFifo();
+    if (data) {
+        m_popped.fetch_add(1, std::memory_order_relaxed);
     }
+    return data;
+}
 
-    if (m_queue.empty()) {
-        return nullptr;
+void RenderFrameQueue::clear() {
+    int clearedCount = 0;
+    while (std::shared_ptr<frame_data_t> data = m_depth == 1 ? popMailbox() : popFifo()) {
+        countDrop(data->frameId);
+        clearedCount++;
     }
 
-    auto data = m_queue.front();
-    m_queue.pop();
+    LOGD("RenderFrameQueue::clear() removed %d frames", clearedCount);
+}
 
-    LOGD("RenderFrameQueue::pop retrieved frame %d, remaining queue size: %d",
-         data ? data->frameId : -1, static_cast<int>(m_queue.size()));
+int RenderFrameQueue::size() const {
+    if (m_depth == 1) {
+        return (m_middle.load(std::memory_order_acquire) & kFresh) ? 1 : 0;
+    }
+    size_t tail = m_tail.load(std::memory_order_acquire);
+    size_t head = m_head.load(std::memory_order_acquire);
+    return tail > head ? static_cast<int>(tail - head) : 0;
+}
 
-    return data;
+RenderFrameQueue::Stats RenderFrameQueue::getStats() const {
+    Stats stats;
+    stats.pushed = m_pushed.load(std::memory_order_relaxed);
+    stats.popped = m_popped.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.invalid = m_invalid.load(std::memory_order_relaxed);
+    return stats;
 }
 
-int RenderFrameQueue::size() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_queue.size();
+bool RenderFrameQueue::pushMailbox(std::shared_ptr<frame_data_t>& frameDataPtr) {
+    m_mailbox[m_back] = frameDataPtr;
+    uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_back | kFresh), std::memory_order_acq_rel);
+    m_back = previous & 0x3;
+    if (previous & kFresh) {
+        // The display never took the previous frame: it is replaced (released here, on the producer)
+        countDrop(m_mailbox[m_back] ? m_mailbox[m_back]->frameId : -1);
+    }
+    m_mailbox[m_back].reset();
+    return true;
 }
 
-void RenderFrameQueue::clear() {
-    std::lock_guard<std::mutex> lock(m_mutex);
+std::shared_ptr<frame_data_t> RenderFrameQueue::popMailbox() {
+    if (!(m_middle.load(std::memory_order_acquire) & kFresh)) {
+        return nullptr;
+    }
+    // m_mailbox[m_front] was emptied by the previous pop, so the producer gets an empty slot back
+    uint8_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+    m_front = previous & 0x3;
+    return std::move(m_mailbox[m_front]);
+}
 
-    int clearedCount = m_queue.size();
-    // Clear the queue - shared_ptr will automatically handle memory cleanup
-    while (!m_queue.empty()) {
-        m_queue.pop();
+bool RenderFrameQueue::pushFifo(std::shared_ptr<frame_data_t>& frameDataPtr) {
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_head.load(std::memory_order_acquire) >= m_depth) {
+        countDrop(frameDataPtr->frameId);
+        return false;
     }
+    m_slots[tail % m_depth] = frameDataPtr;
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
 
-    LOGD("RenderFrameQueue::clear() removed %d frames", clearedCount);
+std::shared_ptr<frame_data_t> RenderFrameQueue::popFifo() {
+    size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tail.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    std::shared_ptr<frame_data_t> data = std::move(m_slots[head % m_depth]);
+    m_head.store(head + 1, std::memory_order_release);
+    return data;
 }
 
+void RenderFrameQueue::countDrop(int frameId) {
+    uint64_t dropped = m_dropped.fetch_add(1, std::memory_order_relaxed) + 1;
+    LOGD("RenderFrameQueue: channel %d dropped frame %d (total %llu)", m_channelIndex, frameId,
+         (unsigned long long) dropped);
+}
@@ -0,0 +1,219 @@
+// 有界多生产者/多消费者任务环形队列
+
+#ifndef RK3588_DEMO_BOUNDED_TASK_RING_H
+#define RK3588_DEMO_BOUNDED_TASK_RING_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+/**
+ * Bounded lock-free MPMC ring (Vyukov sequence-per-cell design).
+ *
+ * tryPush/tryPop never take a lock. The blocking push/pop variants only fall
+ * back to a mutex + condition variable when the ring is full/empty, and the
+ * opposite side only touches that mutex when somebody is actually parked, so
+ * the steady state is lock-free and wakeups are exact (no sleep polling).
+ *
+ * Capacity is rounded up to the next power of two.
+ */
+template<typename T>
+class BoundedTaskRing {
+public:
+    explicit BoundedTaskRing(size_t capacity)
+            : enqueue_pos_(0), dequeue_pos_(0), push_waiters_(0), pop_waiters_(0), closed_(false) {
+        size_t cap = 2;
+        while (cap < capacity) {
+            cap <<= 1;
+        }
+        capacity_ = cap;
+        mask_ = cap - 1;
+        cells_.reset(new Cell[cap]);
+        for (size_t i = 0; i < cap; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedTaskRing(const BoundedTaskRing &) = delete;
+    BoundedTaskRing &operator=(const BoundedTaskRing &) = delete;
+
+    // 非阻塞入队，队列满时返回false（item保持不变）
+    bool tryPush(T &item) {
+        if (!rawPush(item)) {
+            return false;
+        }
+        wakeWaiters(pop_waiters_, not_empty_);
+        return true;
+    }
+
+    // 非阻塞出队，队列空时返回false
+    bool tryPop(T &item) {
+        if (!rawPop(item)) {
+            return false;
+        }
+        wakeWaiters(push_waiters_, not_full_);
+        return true;
+    }
+
+    /**
+     * 阻塞入队
+     * @param timeout_ms <0 表示一直等待直到有空位或队列关闭
+     * @return false 表示超时或队列已关闭
+     */
+    bool push(T &item, int timeout_ms = -1) {
+        if (tryPush(item)) {
+            return true;
+        }
+        return blockingOp(push_waiters_, not_full_, not_empty_, timeout_ms, [&] { return rawPush(item); });
+    }
+
+    /**
+     * 阻塞出队
+     * @param timeout_ms <0 表示一直等待直到有数据或队列关闭
+     * @return false 表示超时，或队列已关闭且为空
+     */
+    bool pop(T &item, int timeout_ms = -1) {
+        if (tryPop(item)) {
+            return true;
+        }
+        return blockingOp(pop_waiters_, not_empty_, not_full_, timeout_ms, [&] { return rawPop(item); });
+    }
+
+    // 关闭队列：唤醒所有等待者，之后push全部失败，pop取完剩余数据后失败
+    void close() {
+        closed_.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(wait_mtx_);
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    // 近似大小（并发时仅供统计使用）
+    size_t size() const {
+        size_t enq = enqueue_pos_.load(std::memory_order_acquire);
+        size_t deq = dequeue_pos_.load(std::memory_order_acquire);
+        return enq > deq ? enq - deq : 0;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    bool rawPush(T &item) {
+        if (closed_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        Cell *cell;
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t dif = (intptr_t) seq - (intptr_t) pos;
+            if (dif == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(item);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool rawPop(T &item) {
+        Cell *cell;
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t dif = (intptr_t) seq - (intptr_t) (pos + 1);
+            if (dif == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(cell->data);
+        cell->data = T(); // 尽早释放cell中持有的引用
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 只有确实有线程挂起时才去碰互斥锁；fence与等待方的fence配对，避免丢失唤醒
+    void wakeWaiters(std::atomic<int> &waiters, std::condition_variable &cond) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(wait_mtx_);
+            cond.notify_one();
+        }
+    }
+
+    // 慢路径：在wait_mtx_下重试，成功后直接唤醒对端（已持有锁，不能再走wakeWaiters）
+    template<typename Op>
+    bool blockingOp(std::atomic<int> &waiters, std::condition_variable &cond, std::condition_variable &other,
+                    int timeout_ms, Op op) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms < 0 ? 0 : timeout_ms);
+        std::unique_lock<std::mutex> lock(wait_mtx_);
+        waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool done = false;
+        for (;;) {
+            if (op()) {
+                done = true;
+                break;
+            }
+            if (closed_.load(std::memory_order_acquire)) {
+                break;
+            }
+            if (timeout_ms < 0) {
+                cond.wait(lock);
+            } else if (cond.wait_until(lock, deadline) == std::cv_status::timeout) {
+                done = op();
+                break;
+            }
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        if (done) {
+            other.notify_one();
+        }
+        return done;
+    }
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t capacity_;
+    size_t mask_;
+
+    // 生产者/消费者位置分开放在不同的cache line，避免伪共享
+    char pad0_[64];
+    std::atomic<size_t> enqueue_pos_;
+    char pad1_[64];
+    std::atomic<size_t> dequeue_pos_;
+    char pad2_[64];
+
+    std::mutex wait_mtx_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::atomic<int> push_waiters_;
+    std::atomic<int> pop_waiters_;
+    std::atomic<bool> closed_;
+};
+
+#endif // RK3588_DEMO_BOUNDED_TASK_RING_H
@@ -0,0 +1,215 @@
+// 按frameId索引的推理结果完成槽
+
+#ifndef RK3588_DEMO_FRAME_RESULT_SLOTS_H
+#define RK3588_DEMO_FRAME_RESULT_SLOTS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "error.h"
+#include "logging.h"
+#include "user_comm.h"
+
+/**
+ * Fixed-size table of completion slots, one per in-flight frameId
+ * (slot = frameId & mask). Each slot has its own mutex and condition variable,
+ * so a worker publishing frame N only wakes the consumer waiting on frame N and
+ * never contends with producers/consumers of other frames.
+ *
+ * The detections and the frame image are consumed independently, mirroring
+ * getTargetResultNonBlock()/getTargetImgResult(). A slot is recycled once both
+ * halves have been taken, or overwritten when frameId + capacity completes
+ * before the consumer got to it (counted in overwrittenCount()).
+ *
+ * A consumer that does not know which frameId finishes next (out-of-order
+ * completion) blocks in waitForCompletion() on a completion counter instead
+ * of polling the slots.
+ */
+class FrameResultSlots {
+public:
+    explicit FrameResultSlots(size_t capacity) : stopped_(false), overwritten_(0), completions_(0) {
+        size_t cap = 2;
+        while (cap < capacity) {
+            cap <<= 1;
+        }
+        mask_ = cap - 1;
+        slots_.reset(new Slot[cap]);
+    }
+
+    FrameResultSlots(const FrameResultSlots &) = delete;
+    FrameResultSlots &operator=(const FrameResultSlots &) = delete;
+
+    // 工作线程发布一帧的推理结果
+    void complete(int frameId, std::vector<Detection> &&detections, std::shared_ptr<frame_data_t> frame) {
+        Slot &slot = slotFor(frameId);
+        {
+            std::lock_guard<std::mutex> lock(slot.mtx);
+            if (slot.frameId != -1 && slot.frameId != frameId && (slot.hasResult || slot.hasImage)) {
+                overwritten_.fetch_add(1, std::memory_order_relaxed);
+                NN_LOG_WARNING("FrameResultSlots: frame %d overwritten by frame %d before being consumed",
+                               slot.frameId, frameId);
+            }
+            slot.frameId = frameId;
+            slot.detections = std::move(detections);
+            slot.frame = std::move(frame);
+            slot.hasResult = true;
+            slot.hasImage = slot.frame != nullptr;
+        }
+        slot.cond.notify_all();
+        {
+            std::lock_guard<std::mutex> lock(completionMtx_);
+            completions_++;
+        }
+        completionCond_.notify_all();
+    }
+
+    /**
+     * 等待任一帧完成：completions()超过seen时返回
+     * @param seen 调用方上次看到的完成计数，返回时更新为当前计数
+     * @param timeout_ms <0 表示一直等待
+     * @return NN_SUCCESS（有新完成）/ NN_TIMEOUT / NN_STOPED
+     */
+    nn_error_e waitForCompletion(uint64_t &seen, int timeout_ms) {
+        std::unique_lock<std::mutex> lock(completionMtx_);
+        auto ready = [&] { return stopped_.load(std::memory_order_acquire) || completions_ != seen; };
+        if (timeout_ms < 0) {
+            completionCond_.wait(lock, ready);
+        } else {
+            completionCond_.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+        }
+        bool advanced = completions_ != seen;
+        seen = completions_;
+        if (advanced) {
+            return NN_SUCCESS;
+        }
+        return stopped_.load(std::memory_order_acquire) ? NN_STOPED : NN_TIMEOUT;
+    }
+
+    /**
+     * 取出检测结果（不取图像）
+     * @param timeout_ms 0 表示不等待，<0 表示一直等待直到结果就绪或停止
+     * @return NN_SUCCESS / NN_RESULT_NOT_READY / NN_TIMEOUT / NN_STOPED
+     */
+    nn_error_e takeResult(int frameId, std::vector<Detection> &objects, int timeout_ms) {
+        Slot &slot = slotFor(frameId);
+        std::unique_lock<std::mutex> lock(slot.mtx);
+        nn_error_e ret = waitReady(slot, lock, frameId, timeout_ms);
+        if (ret != NN_SUCCESS) {
+            return ret;
+        }
+        objects = std::move(slot.detections);
+        slot.detections.clear();
+        slot.hasResult = false;
+        recycleIfConsumed(slot);
+        return NN_SUCCESS;
+    }
+
+    // 取出检测结果和图像（等价于旧版getTargetResult同时擦除两张map）
+    nn_error_e takeResultAndImage(int frameId, std::vector<Detection> &objects, int timeout_ms) {
+        Slot &slot = slotFor(frameId);
+        std::unique_lock<std::mutex> lock(slot.mtx);
+        nn_error_e ret = waitReady(slot, lock, frameId, timeout_ms);
+        if (ret != NN_SUCCESS) {
+            return ret;
+        }
+        objects = std::move(slot.detections);
+        slot.detections.clear();
+        slot.frame.reset();
+        slot.hasResult = false;
+        slot.hasImage = false;
+        recycleIfConsumed(slot);
+        return NN_SUCCESS;
+    }
+
+    // 取出图像，不存在时返回nullptr
+    std::shared_ptr<frame_data_t> takeImage(int frameId) {
+        Slot &slot = slotFor(frameId);
+        std::lock_guard<std::mutex> lock(slot.mtx);
+        if (slot.frameId != frameId || !slot.hasImage) {
+            return nullptr;
+        }
+        std::shared_ptr<frame_data_t> frame = std::move(slot.frame);
+        slot.hasImage = false;
+        recycleIfConsumed(slot);
+        return frame;
+    }
+
+    // 唤醒所有等待者，之后的等待立即返回NN_STOPED
+    void stop() {
+        stopped_.store(true, std::memory_order_release);
+        for (size_t i = 0; i <= mask_; ++i) {
+            std::lock_guard<std::mutex> lock(slots_[i].mtx);
+            slots_[i].cond.notify_all();
+        }
+        // 持锁通知：等待者检查stopped_之后、进入等待之前不会错过唤醒
+        std::lock_guard<std::mutex> lock(completionMtx_);
+        completionCond_.notify_all();
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+    int overwrittenCount() const { return overwritten_.load(std::memory_order_relaxed); }
+
+    uint64_t completions() {
+        std::lock_guard<std::mutex> lock(completionMtx_);
+        return completions_;
+    }
+
+private:
+    struct Slot {
+        std::mutex mtx;
+        std::condition_variable cond;
+        int frameId = -1;
+        bool hasResult = false;
+        bool hasImage = false;
+        std::vector<Detection> detections;
+        std::shared_ptr<frame_data_t> frame;
+    };
+
+    Slot &slotFor(int frameId) { return slots_[(size_t) frameId & mask_]; }
+
+    nn_error_e waitReady(Slot &slot, std::unique_lock<std::mutex> &lock, int frameId, int timeout_ms) {
+        auto ready = [&] {
+            return stopped_.load(std::memory_order_acquire) ||
+                   (slot.frameId == frameId && slot.hasResult) ||
+                   slot.frameId - frameId > 0; // 槽已被更新的帧占用，本帧永远不会再出现
+        };
+        if (timeout_ms < 0) {
+            slot.cond.wait(lock, ready);
+        } else if (timeout_ms > 0) {
+            slot.cond.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+        }
+        if (slot.frameId == frameId && slot.hasResult) {
+            return NN_SUCCESS;
+        }
+        if (stopped_.load(std::memory_order_acquire)) {
+            return NN_STOPED;
+        }
+        if (slot.frameId - frameId > 0) {
+            return NN_RESULT_NOT_READY;
+        }
+        return timeout_ms == 0 ? NN_RESULT_NOT_READY : NN_TIMEOUT;
+    }
+
+    void recycleIfConsumed(Slot &slot) {
+        if (!slot.hasResult && !slot.hasImage) {
+            slot.frame.reset();
+            slot.frameId = -1;
+        }
+    }
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    std::atomic<bool> stopped_;
+    std::atomic<int> overwritten_;
+
+    std::mutex completionMtx_;
+    std::condition_variable completionCond_;
+    uint64_t completions_;
+};
+
+#endif // RK3588_DEMO_FRAME_RESULT_SLOTS_H
@@ -0,0 +1,408 @@
+#include "inference_scheduler.h"
+#include "engine_registry.h"
+#include <algorithm>
+#include <unistd.h>
+
+static double elapsedMs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count() / 1000.0;
+}
+
+InferenceScheduler::InferenceScheduler()
+        : virtualTime_(0.0), queuedTotal_(0), stop_(false), batchCount_(0), batchedFrames_(0),
+          nmsConfig_(nms_default_config()), nmsVersion_(0) {}
+
+InferenceScheduler::~InferenceScheduler() {
+    stopAll();
+    for (auto &thread: workers_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+nn_error_e InferenceScheduler::setUp(const Config &config, char *modelData, int modelSize) {
+    return setUpWithEngineFactory(config, CreateDefaultNNEngine, modelData, modelSize);
+}
+
+nn_error_e InferenceScheduler::setUpWithEngineFactory(const Config &config,
+                                                      const std::function<std::shared_ptr<NNEngine>()> &engineFactory,
+                                                      char *modelData, int modelSize) {
+    if (!workers_.empty()) {
+        NN_LOG_ERROR("InferenceScheduler already set up");
+        return NN_LOAD_MODEL_FAIL;
+    }
+    config_ = config;
+    config_.numWorkers = std::max(1, config_.numWorkers);
+    config_.maxQueueDepth = std::max(1, config_.maxQueueDepth);
+    config_.deadlineMs = std::max(1, config_.deadlineMs);
+    config_.maxBatchSize = std::max(1, config_.maxBatchSize);
+    config_.maxBatchWaitUs = std::max(0, config_.maxBatchWaitUs);
+
+    // 所有工作实例加载同一个模型，实例数即NPU并发度，与通道数无关
+    for (int i = 0; i < config_.numWorkers; ++i) {
+        std::shared_ptr<Yolov5> yolov5 = std::make_shared<Yolov5>(engineFactory());
+        nn_error_e ret = yolov5->LoadModelWithData(modelData, modelSize);
+        if (ret != NN_SUCCESS) {
+            NN_LOG_ERROR("InferenceScheduler: worker %d failed to load model, error: %d", i, ret);
+            instances_.clear();
+            return ret;
+        }
+        instances_.push_back(yolov5);
+        usleep(1000);
+    }
+
+    for (int i = 0; i < config_.numWorkers; ++i) {
+        workers_.emplace_back(&InferenceScheduler::worker, this, i);
+    }
+    NN_LOG_INFO("InferenceScheduler started: %d workers, policy %s, queue depth %d, batch %d (model %d) / %dus",
+                config_.numWorkers, config_.policy == WEIGHTED_FAIR ? "weighted-fair" : "earliest-deadline",
+                config_.maxQueueDepth, config_.maxBatchSize, instances_[0]->GetMaxBatchSize(), config_.maxBatchWaitUs);
+    return NN_SUCCESS;
+}
+
+void InferenceScheduler::setNmsConfig(const nms_config_s &config) {
+    std::lock_guard<std::mutex> lock(nmsMutex_);
+    nmsConfig_ = config;
+    nmsVersion_++;
+}
+
+nms_config_s InferenceScheduler::getNmsConfig() {
+    std::lock_guard<std::mutex> lock(nmsMutex_);
+    return nmsConfig_;
+}
+
+void InferenceScheduler::stopAll() {
+    std::vector<std::shared_ptr<ChannelQueue>> toStop;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_ = true;
+        for (auto &entry: channels_) {
+            toStop.push_back(entry.second);
+        }
+    }
+    cond_.notify_all();
+    for (auto &channel: toStop) {
+        channel->results.stop();
+    }
+}
+
+nn_error_e InferenceScheduler::registerChannel(int channelIndex, int priority) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (stop_) {
+        return NN_STOPED;
+    }
+    auto it = channels_.find(channelIndex);
+    if (it != channels_.end()) {
+        it->second->priority = std::max(1, priority);
+        return NN_SUCCESS;
+    }
+    std::shared_ptr<ChannelQueue> channel =
+            std::make_shared<ChannelQueue>(channelIndex, std::max(1, priority), config_.resultSlots);
+    // 新通道从当前虚拟时间开始，不补偿注册前的空闲时间
+    channel->virtualFinish = virtualTime_;
+    channels_[channelIndex] = channel;
+    NN_LOG_INFO("InferenceScheduler: channel %d registered, priority %d", channelIndex, channel->priority);
+    return NN_SUCCESS;
+}
+
+void InferenceScheduler::unregisterChannel(int channelIndex) {
+    std::shared_ptr<ChannelQueue> channel;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        auto it = channels_.find(channelIndex);
+        if (it == channels_.end()) {
+            return;
+        }
+        channel = it->second;
+        queuedTotal_ -= (int) channel->pending.size();
+        channel->pending.clear();
+        channels_.erase(it);
+    }
+    // 正在推理的帧由工作线程持有通道引用，完成后写入已停止的结果槽即被丢弃
+    channel->results.stop();
+    NN_LOG_INFO("InferenceScheduler: channel %d unregistered", channelIndex);
+}
+
+void InferenceScheduler::setChannelPriority(int channelIndex, int priority) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = channels_.find(channelIndex);
+    if (it != channels_.end()) {
+        it->second->priority = std::max(1, priority);
+    }
+}
+
+void InferenceScheduler::setChannelActive(int channelIndex, bool active) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = channels_.find(channelIndex);
+    if (it != channels_.end()) {
+        it->second->active = active;
+    }
+}
+
+void InferenceScheduler::setChannelVisible(int channelIndex, bool visible) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = channels_.find(channelIndex);
+    if (it != channels_.end()) {
+        it->second->visible = visible;
+    }
+}
+
+nn_error_e InferenceScheduler::submitFrame(int channelIndex, const std::shared_ptr<frame_data_t> &frameData) {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (stop_) {
+            return NN_STOPED;
+        }
+        auto it = channels_.find(channelIndex);
+        if (it == channels_.end()) {
+            return NN_CHANNEL_NOT_FOUND;
+        }
+        ChannelQueue &channel = *it->second;
+        if ((int) channel.pending.size() >= config_.maxQueueDepth) {
+            channel.dropped++;
+            return NN_QUEUE_FULL;
+        }
+        PendingFrame pending;
+        pending.frame = frameData;
+        pending.submitTime = Clock::now();
+        pending.deadline = pending.submitTime +
+                           std::chrono::microseconds((long) (config_.deadlineMs * 1000.0 / weightOf(channel)));
+        channel.pending.push_back(std::move(pending));
+        channel.submitted++;
+        queuedTotal_++;
+    }
+    cond_.notify_one();
+    return NN_SUCCESS;
+}
+
+nn_error_e InferenceScheduler::completeWithoutInference(int channelIndex,
+                                                        const std::shared_ptr<frame_data_t> &frameData) {
+    std::shared_ptr<ChannelQueue> channel = findChannel(channelIndex);
+    if (!channel) {
+        return NN_CHANNEL_NOT_FOUND;
+    }
+    channel->results.complete(frameData->frameId, std::vector<Detection>(), frameData);
+    return NN_SUCCESS;
+}
+
+nn_error_e InferenceScheduler::getTargetResult(int channelIndex, std::vector<Detection> &objects, int id) {
+    std::shared_ptr<ChannelQueue> channel = findChannel(channelIndex);
+    if (!channel) {
+        return NN_CHANNEL_NOT_FOUND;
+    }
+    return channel->results.takeResultAndImage(id, objects, -1);
+}
+
+nn_error_e InferenceScheduler::getTargetResultNonBlock(int channelIndex, std::vector<Detection> &objects, int id) {
+    std::shared_ptr<ChannelQueue> channel = findChannel(channelIndex);
+    if (!channel) {
+        return NN_CHANNEL_NOT_FOUND;
+    }
+    return channel->results.takeResult(id, objects, 0);
+}
+
+std::shared_ptr<frame_data_t> InferenceScheduler::getTargetImgResult(int channelIndex, int id) {
+    std::shared_ptr<ChannelQueue> channel = findChannel(channelIndex);
+    if (!channel) {
+        return nullptr;
+    }
+    return channel->results.takeImage(id);
+}
+
+nn_error_e InferenceScheduler::waitForResult(int channelIndex, uint64_t &seen, int timeout_ms) {
+    // 持有通道引用，等待期间注销也不会释放结果槽；注销时results.stop()唤醒本次等待
+    std::shared_ptr<ChannelQueue> channel = findChannel(channelIndex);
+    if (!channel) {
+        return NN_CHANNEL_NOT_FOUND;
+    }
+    return channel->results.waitForCompletion(seen, timeout_ms);
+}
+
+bool InferenceScheduler::getChannelStats(int channelIndex, ChannelStats &stats) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = channels_.find(channelIndex);
+    if (it == channels_.end()) {
+        return false;
+    }
+    fillStatsLocked(*it->second, stats);
+    return true;
+}
+
+std::vector<InferenceScheduler::ChannelStats> InferenceScheduler::getAllChannelStats() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    std::vector<ChannelStats> all;
+    for (auto &entry: channels_) {
+        ChannelStats stats;
+        fillStatsLocked(*entry.second, stats);
+        all.push_back(stats);
+    }
+    return all;
+}
+
+float InferenceScheduler::getAverageBatchSize() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return batchCount_ > 0 ? (float) batchedFrames_ / batchCount_ : 0.0f;
+}
+
+double InferenceScheduler::weightOf(const ChannelQueue &channel) const {
+    double weight = channel.priority;
+    if (channel.active) {
+        weight *= config_.activeBoost;
+    }
+    if (!channel.visible) {
+        weight *= config_.hiddenScale;
+    }
+    return std::max(weight, 0.01);
+}
+
+std::shared_ptr<InferenceScheduler::ChannelQueue> InferenceScheduler::findChannel(int channelIndex) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = channels_.find(channelIndex);
+    return it == channels_.end() ? nullptr : it->second;
+}
+
+std::shared_ptr<InferenceScheduler::ChannelQueue> InferenceScheduler::pickNextLocked() {
+    std::shared_ptr<ChannelQueue> best;
+    double bestKey = 0.0;
+    for (auto &entry: channels_) {
+        ChannelQueue &channel = *entry.second;
+        if (channel.pending.empty()) {
+            continue;
+        }
+        double key;
+        if (config_.policy == EARLIEST_DEADLINE) {
+            key = std::chrono::duration<double, std::milli>(channel.pending.front().deadline.time_since_epoch()).count();
+        } else {
+            key = std::max(channel.virtualFinish, virtualTime_);
+        }
+        if (!best || key < bestKey) {
+            best = entry.second;
+            bestKey = key;
+        }
+    }
+    if (best && config_.policy == WEIGHTED_FAIR) {
+        // 虚拟时间推进到被服务帧的开始标签，通道完成标签前移 1/weight
+        virtualTime_ = bestKey;
+        best->virtualFinish = bestKey + 1.0 / weightOf(*best);
+    }
+    return best;
+}
+
+void InferenceScheduler::fillStatsLocked(const ChannelQueue &channel, ChannelStats &stats) const {
+    stats.channelIndex = channel.index;
+    stats.priority = channel.priority;
+    stats.active = channel.active;
+    stats.visible = channel.visible;
+    stats.weight = (float) weightOf(channel);
+    stats.queueDepth = (int) channel.pending.size();
+    stats.inFlight = channel.inFlight;
+    stats.submitted = channel.submitted;
+    stats.completed = channel.completed;
+    stats.dropped = channel.dropped;
+    stats.deadlineMisses = channel.deadlineMisses;
+    long started = channel.completed + channel.inFlight;
+    stats.avgQueueWaitMs = started > 0 ? (float) (channel.totalQueueWaitMs / started) : 0.0f;
+    stats.avgInferenceMs = channel.completed > 0 ? (float) (channel.totalInferenceMs / channel.completed) : 0.0f;
+    stats.avgServiceMs = channel.completed > 0 ? (float) (channel.totalServiceMs / channel.completed) : 0.0f;
+    stats.maxServiceMs = (float) channel.maxServiceMs;
+}
+
+bool InferenceScheduler::takeNextLocked(std::vector<PendingFrame> &batch,
+                                        std::vector<std::shared_ptr<ChannelQueue>> &owners) {
+    std::shared_ptr<ChannelQueue> channel = pickNextLocked();
+    if (!channel) {
+        return false;
+    }
+    batch.push_back(std::move(channel->pending.front()));
+    channel->pending.pop_front();
+    queuedTotal_--;
+    channel->inFlight++;
+    owners.push_back(channel);
+    return true;
+}
+
+void InferenceScheduler::worker(int id) {
+    std::shared_ptr<Yolov5> instance = instances_[id];
+    // 模型不支持batch时退化为逐帧推理
+    const size_t batchLimit = (size_t) std::max(1, std::min(config_.maxBatchSize, instance->GetMaxBatchSize()));
+    int appliedNmsVersion = -1;
+    while (true) {
+        std::vector<PendingFrame> batch;
+        std::vector<std::shared_ptr<ChannelQueue>> owners;
+        Clock::time_point dispatchTime;
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            cond_.wait(lock, [this] { return stop_ || queuedTotal_ > 0; });
+            if (stop_) {
+                return;
+            }
+            if (!takeNextLocked(batch, owners)) {
+                continue;
+            }
+            // 攒批：从第一帧起最多等待maxBatchWaitUs，期间各通道新到的帧按调度策略继续加入
+            Clock::time_point batchDeadline = Clock::now() + std::chrono::microseconds(config_.maxBatchWaitUs);
+            while (batch.size() < batchLimit && !stop_) {
+                if (queuedTotal_ > 0) {
+                    takeNextLocked(batch, owners);
+                    continue;
+                }
+                if (config_.maxBatchWaitUs <= 0 ||
+                    cond_.wait_until(lock, batchDeadline) == std::cv_status::timeout) {
+                    if (queuedTotal_ > 0) {
+                        continue;
+                    }
+                    break;
+                }
+            }
+            dispatchTime = Clock::now();
+            for (size_t k = 0; k < batch.size(); k++) {
+                owners[k]->totalQueueWaitMs += elapsedMs(batch[k].submitTime, dispatchTime);
+            }
+            batchCount_++;
+            batchedFrames_ += (long) batch.size();
+        }
+
+        int version = nmsVersion_.load();
+        if (version != appliedNmsVersion) {
+            std::lock_guard<std::mutex> lock(nmsMutex_);
+            instance->SetNmsConfig(nmsConfig_);
+            appliedNmsVersion = nmsVersion_.load();
+        }
+
+        std::vector<std::vector<Detection>> detections(batch.size());
+        if (batch.size() == 1) {
+            instance->RunWithFrameData(batch[0].frame, detections[0]);
+        } else {
+            std::vector<std::shared_ptr<frame_data_t>> frames;
+            for (auto &task: batch) {
+                frames.push_back(task.frame);
+            }
+            instance->RunBatchWithFrameData(frames, detections);
+        }
+        Clock::time_point doneTime = Clock::now();
+
+        // 先记账再发布，取到结果的一方看到的统计已包含本帧
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            for (size_t k = 0; k < batch.size(); k++) {
+                ChannelQueue &channel = *owners[k];
+                double serviceMs = elapsedMs(batch[k].submitTime, doneTime);
+                channel.inFlight--;
+                channel.completed++;
+                channel.totalInferenceMs += elapsedMs(dispatchTime, doneTime);
+                channel.totalServiceMs += serviceMs;
+                channel.maxServiceMs = std::max(channel.maxServiceMs, serviceMs);
+                if (doneTime > batch[k].deadline) {
+                    channel.deadlineMisses++;
+                }
+            }
+        }
+        // 按frameId分发回各自通道的结果槽
+        for (size_t k = 0; k < batch.size(); k++) {
+            int frameId = batch[k].frame->frameId;
+            owners[k]->results.complete(frameId, std::move(detections[k]), std::move(batch[k].frame));
+            LOGD("scheduler worker %d, channel %d frame %d done (batch %zu)", id, owners[k]->index, frameId,
+                 batch.size());
+        }
+    }
+}
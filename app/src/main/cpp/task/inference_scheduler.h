@@ -0,0 +1,204 @@
+// 跨通道共享推理调度器
+
+#ifndef RK3588_DEMO_INFERENCE_SCHEDULER_H
+#define RK3588_DEMO_INFERENCE_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "user_comm.h"
+#include "yolov5.h"
+#include "frame_result_slots.h"
+
+/**
+ * Process-wide inference service shared by every channel.
+ *
+ * Owns a fixed set of engine workers (one Yolov5 instance / RKNN context each)
+ * and feeds them from bounded per-channel queues. Which channel's head frame a
+ * free worker takes next is decided by the configured policy:
+ *
+ *  - WEIGHTED_FAIR: start-time fair queueing. Each dispatch advances the
+ *    channel's virtual clock by 1/weight, so under saturation channels get NPU
+ *    time in proportion to their weights, and an idle channel cannot bank
+ *    credit while it has nothing queued.
+ *  - EARLIEST_DEADLINE: each frame gets deadline = submit + deadlineMs/weight
+ *    and the earliest head deadline across channels runs first.
+ *
+ * weight = priority x (activeBoost if the channel is the selected one)
+ *                   x (hiddenScale if it is not visible).
+ *
+ * When the model has a batch dimension > 1, a worker that picks a frame keeps
+ * taking frames (from any channel, in policy order) until it has maxBatchSize
+ * or maxBatchWaitUs has passed since the first one, runs them as one
+ * RunBatch call and scatters the detections back by channel and frameId.
+ *
+ * Results are published per channel in FrameResultSlots, so frame ids only
+ * need to be unique within a channel and the consumer side mirrors
+ * Yolov5ThreadPool (getTargetResultNonBlock / getTargetImgResult).
+ */
+class InferenceScheduler {
+public:
+    enum Policy {
+        WEIGHTED_FAIR = 0,
+        EARLIEST_DEADLINE = 1
+    };
+
+    struct Config {
+        int numWorkers = 3;          // 推理实例数（RK3588 NPU 为3核）
+        Policy policy = WEIGHTED_FAIR;
+        int maxQueueDepth = 4;       // 每路最多排队帧数，满时拒绝新帧
+        int deadlineMs = 200;        // 权重为1的通道的时限
+        float activeBoost = 2.0f;    // 选中通道的权重倍数
+        float hiddenScale = 0.25f;   // 不可见通道的权重倍数
+        int resultSlots = 64;        // 每路结果槽数量
+        int maxBatchSize = 1;        // 每次推理最多合并的帧数（不超过模型batch维）
+        int maxBatchWaitUs = 0;      // 凑批的最长等待，0表示只合并已在排队的帧
+    };
+
+    struct ChannelStats {
+        int channelIndex = -1;
+        int priority = 1;
+        bool active = false;
+        bool visible = true;
+        float weight = 1.0f;
+        int queueDepth = 0;          // 当前排队帧数
+        int inFlight = 0;            // 正在推理的帧数
+        long submitted = 0;
+        long completed = 0;
+        long dropped = 0;            // 队列满被拒绝的帧
+        long deadlineMisses = 0;     // 完成时已超过时限的帧
+        float avgQueueWaitMs = 0.0f; // 提交到开始推理
+        float avgInferenceMs = 0.0f; // 推理本身
+        float avgServiceMs = 0.0f;   // 提交到结果可取
+        float maxServiceMs = 0.0f;
+    };
+
+    InferenceScheduler();
+
+    ~InferenceScheduler();
+
+    // 使用默认引擎（engine_registry.h，默认为rknn）
+    nn_error_e setUp(const Config &config, char *modelData, int modelSize);
+
+    // 使用自定义引擎创建工作实例（例如测试/基准中的桩引擎）
+    nn_error_e setUpWithEngineFactory(const Config &config,
+                                      const std::function<std::shared_ptr<NNEngine>()> &engineFactory,
+                                      char *modelData, int modelSize);
+
+    void stopAll();
+
+    // 通道注册，重复注册只更新优先级
+    nn_error_e registerChannel(int channelIndex, int priority = 1);
+
+    // 注销通道：丢弃排队帧并唤醒等待该通道结果的线程
+    void unregisterChannel(int channelIndex);
+
+    void setChannelPriority(int channelIndex, int priority);
+
+    void setChannelActive(int channelIndex, bool active);
+
+    void setChannelVisible(int channelIndex, bool visible);
+
+    // 非阻塞提交：通道队列满时返回NN_QUEUE_FULL，帧不占用frameId
+    nn_error_e submitFrame(int channelIndex, const std::shared_ptr<frame_data_t> &frameData);
+
+    // 不经过队列和推理，直接以空检测结果完成该帧（检测节拍跳过的帧），frameId与submitFrame共用
+    nn_error_e completeWithoutInference(int channelIndex, const std::shared_ptr<frame_data_t> &frameData);
+
+    nn_error_e getTargetResult(int channelIndex, std::vector<Detection> &objects, int id);
+
+    nn_error_e getTargetResultNonBlock(int channelIndex, std::vector<Detection> &objects, int id);
+
+    std::shared_ptr<frame_data_t> getTargetImgResult(int channelIndex, int id);
+
+    // 阻塞等待该通道任一帧推理完成；通道注销后返回NN_STOPED
+    nn_error_e waitForResult(int channelIndex, uint64_t &seen, int timeout_ms);
+
+    bool getChannelStats(int channelIndex, ChannelStats &stats);
+
+    std::vector<ChannelStats> getAllChannelStats();
+
+    int getWorkerCount() const { return (int) workers_.size(); }
+
+    // 每次推理调用的平均帧数
+    float getAverageBatchSize();
+
+    const Config &getConfig() const { return config_; }
+
+    // 修改后处理NMS配置；工作实例由所有通道共用，配置对全部通道生效，工作线程在下一次推理前同步
+    void setNmsConfig(const nms_config_s &config);
+
+    nms_config_s getNmsConfig();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct PendingFrame {
+        std::shared_ptr<frame_data_t> frame;
+        Clock::time_point submitTime;
+        Clock::time_point deadline;
+    };
+
+    struct ChannelQueue {
+        explicit ChannelQueue(int index, int priority, int resultSlots)
+                : index(index), priority(priority), results(resultSlots) {}
+
+        int index;
+        int priority;
+        bool active = false;
+        bool visible = true;
+        std::deque<PendingFrame> pending;
+        double virtualFinish = 0.0;
+        FrameResultSlots results;
+
+        int inFlight = 0;
+        long submitted = 0;
+        long completed = 0;
+        long dropped = 0;
+        long deadlineMisses = 0;
+        double totalQueueWaitMs = 0.0;
+        double totalInferenceMs = 0.0;
+        double totalServiceMs = 0.0;
+        double maxServiceMs = 0.0;
+    };
+
+    double weightOf(const ChannelQueue &channel) const;
+
+    std::shared_ptr<ChannelQueue> findChannel(int channelIndex);
+
+    // 按调度策略挑选下一个要服务的通道，需持有mtx_
+    std::shared_ptr<ChannelQueue> pickNextLocked();
+
+    // 取出下一帧加入batch，需持有mtx_
+    bool takeNextLocked(std::vector<PendingFrame> &batch, std::vector<std::shared_ptr<ChannelQueue>> &owners);
+
+    void fillStatsLocked(const ChannelQueue &channel, ChannelStats &stats) const;
+
+    void worker(int id);
+
+    Config config_;
+    std::vector<std::shared_ptr<Yolov5>> instances_;
+    std::vector<std::thread> workers_;
+
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    std::map<int, std::shared_ptr<ChannelQueue>> channels_;
+    double virtualTime_;
+    int queuedTotal_;
+    bool stop_;
+    long batchCount_;
+    long batchedFrames_;
+
+    std::mutex nmsMutex_;
+    nms_config_s nmsConfig_;
+    std::atomic<int> nmsVersion_; // 每次setNmsConfig加1，工作线程据此同步到各自的实例
+};
+
+#endif // RK3588_DEMO_INFERENCE_SCHEDULER_H
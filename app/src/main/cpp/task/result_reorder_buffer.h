@@ -0,0 +1,183 @@
+// 推理结果按序重组（乱序完成 -> 按frameId顺序输出）
+
+#ifndef RK3588_DEMO_RESULT_REORDER_BUFFER_H
+#define RK3588_DEMO_RESULT_REORDER_BUFFER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "logging.h"
+#include "user_comm.h"
+
+/**
+ * Consumer-side reorder buffer between the inference workers (which finish
+ * out of order) and the render path (which wants frames in frameId order).
+ *
+ * Completions inside the window [next, next + window) are pulled from the
+ * result source as they finish and held here; the head is emitted as soon
+ * as it is available. A missing head is skipped (skip-ahead) when
+ *  - a later frame is already complete and the head has been holding it back
+ *    for deadlineMs (each head gets its own deadline), or
+ *  - every other frame in the window is complete (the window is full).
+ * A missing head with nothing complete behind it is waited for: it blocks
+ * nothing. Results that arrive for skipped frames are fetched and dropped
+ * (late) so they do not keep their frame buffers alive in the result slots.
+ *
+ * Single consumer: next() is called from the result thread only.
+ */
+class ResultReorderBuffer {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Config {
+        int window;      // 最多跟踪的帧数（含队头）
+        int deadlineMs;  // 缺失的队头最多阻塞已完成后续帧的时间
+
+        Config() : window(8), deadlineMs(100) {}
+    };
+
+    struct Result {
+        int frameId = -1;
+        std::vector<Detection> detections;
+        std::shared_ptr<frame_data_t> frame;
+    };
+
+    struct Stats {
+        uint64_t emitted = 0;  // 按序输出的帧
+        uint64_t skipped = 0;  // 跳过的队头（超时或窗口满）
+        uint64_t late = 0;     // 跳过之后才完成、被丢弃的帧
+        int depth = 0;         // 当前缓存的已完成帧数
+        int maxDepth = 0;
+    };
+
+    // 非阻塞地从结果源取出frameId的结果，尚未完成时返回false
+    typedef std::function<bool(int frameId, Result &out)> Fetch;
+
+    explicit ResultReorderBuffer(const Config &config = Config(), int firstFrameId = 0)
+            : config_(config), next_(firstFrameId), held_(0), blocked_(false) {
+        config_.window = std::max(config_.window, 2);
+        slots_.resize(config_.window);
+    }
+
+    bool next(const Fetch &fetch, Result &out) { return next(fetch, out, Clock::now()); }
+
+    // 取下一帧按序结果；没有可输出的帧时返回false
+    bool next(const Fetch &fetch, Result &out, Clock::time_point now) {
+        drainLate(fetch);
+        fillWindow(fetch);
+
+        for (;;) {
+            Slot &head = slotFor(next_);
+            if (head.ready) {
+                out = std::move(head.result);
+                head.ready = false;
+                head.result = Result();
+                held_--;
+                next_++;
+                blocked_ = false;
+                stats_.emitted++;
+                stats_.depth = held_;
+                return true;
+            }
+
+            if (held_ == 0) {
+                // 后面没有已完成的帧，等队头不影响任何帧
+                blocked_ = false;
+                return false;
+            }
+            if (!blocked_) {
+                blocked_ = true;
+                blockedSince_ = now;
+            }
+            bool windowFull = held_ >= config_.window - 1;
+            bool expired = now - blockedSince_ >= std::chrono::milliseconds(config_.deadlineMs);
+            if (!windowFull && !expired) {
+                return false;
+            }
+            skipHead();
+            blocked_ = true;
+            blockedSince_ = now;
+            // 窗口后移一格，新进入窗口的帧也可能已经完成
+            fillWindow(fetch);
+        }
+    }
+
+    // 有已完成帧在等缺失的队头时，返回距该队头时限的毫秒数（向上取整），否则返回-1
+    int msUntilDeadline(Clock::time_point now) const {
+        if (!blocked_) {
+            return -1;
+        }
+        int64_t remainingUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                blockedSince_ + std::chrono::milliseconds(config_.deadlineMs) - now).count();
+        return remainingUs > 0 ? (int) ((remainingUs + 999) / 1000) : 0;
+    }
+
+    // 下一个待输出的frameId
+    int nextFrameId() const { return next_; }
+
+    Stats getStats() const { return stats_; }
+
+private:
+    struct Slot {
+        bool ready = false;
+        Result result;
+    };
+
+    Slot &slotFor(int frameId) { return slots_[(size_t) frameId % slots_.size()]; }
+
+    void fillWindow(const Fetch &fetch) {
+        for (int id = next_; id < next_ + config_.window; id++) {
+            Slot &slot = slotFor(id);
+            if (slot.ready) {
+                continue;
+            }
+            if (fetch(id, slot.result)) {
+                slot.result.frameId = id;
+                slot.ready = true;
+                held_++;
+            } else {
+                slot.result = Result();
+            }
+        }
+        stats_.depth = held_;
+        stats_.maxDepth = std::max(stats_.maxDepth, held_);
+    }
+
+    void skipHead() {
+        NN_LOG_WARNING("ResultReorderBuffer: frame %d not ready, skipped (%d later frames waiting)", next_, held_);
+        skippedIds_.push_back(next_);
+        if ((int) skippedIds_.size() > config_.window) {
+            // 过旧的跳过帧不再追踪，其结果槽会被之后的帧覆盖
+            skippedIds_.pop_front();
+        }
+        stats_.skipped++;
+        next_++;
+    }
+
+    void drainLate(const Fetch &fetch) {
+        for (auto it = skippedIds_.begin(); it != skippedIds_.end();) {
+            Result late;
+            if (fetch(*it, late)) {
+                stats_.late++;
+                it = skippedIds_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    Config config_;
+    std::vector<Slot> slots_;
+    std::deque<int> skippedIds_;
+    int next_;
+    int held_;
+    bool blocked_;
+    Clock::time_point blockedSince_;
+    Stats stats_;
+};
+
+#endif // RK3588_DEMO_RESULT_REORDER_BUFFER_H
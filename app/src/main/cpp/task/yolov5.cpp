@@ -1,18 +1,15 @@
 
 #include "yolov5.h"
 
+#include <chrono>
 #include <memory>
 
+#include "engine_registry.h"
 #include "logging.h"
-#include "preprocess.h"
-#include "yolov5_postprocess.h"
-
-#include <ctime>
+#include "rga.h"
+#include "RgaUtils.h"
 
 void DetectionGrp2DetectionArray(yolov5::detect_result_group_t &det_grp, std::vector <Detection> &objects) {
-    // 根据当前系统时间生成随机数种子
-    std::srand(static_cast<unsigned int>(std::time(nullptr)));
-
     for (int i = 0; i < det_grp.count; i++) {
         Detection det;
         det.className = det_grp.results[i].name;
@@ -23,9 +20,7 @@ void DetectionGrp2DetectionArray(yolov5::detect_result_group_t &det_grp, std::ve
                            det_grp.results[i].box.bottom - det_grp.results[i].box.top);
 
         det.confidence = det_grp.results[i].prop;
-        det.class_id = 0;
-        // generate random cv::Scalar color
-        // det.color = cv::Scalar(rand() % 255, rand() % 255, rand() % 255);
+        det.class_id = det_grp.results[i].id;
         // green
         det.color = cv::Scalar(0, 255, 0);
         objects.push_back(det);
@@ -33,20 +28,23 @@ void DetectionGrp2DetectionArray(yolov5::detect_result_group_t &det_grp, std::ve
 }
 
 // 构造函数
-Yolov5::Yolov5() {
-    engine_ = CreateRKNNEngine();
-    input_tensor_.data = nullptr;
+Yolov5::Yolov5() : nms_config_(nms_default_config()), core_mask_(NPU_CORE_AUTO) {
+    engine_ = CreateDefaultNNEngine();
+}
+
+Yolov5::Yolov5(std::shared_ptr <NNEngine> engine)
+        : nms_config_(nms_default_config()), engine_(std::move(engine)), core_mask_(NPU_CORE_AUTO) {
 }
 
 // 析构函数
 Yolov5::~Yolov5() {
-    if (input_tensor_.data != nullptr) {
-        free(input_tensor_.data);
-        input_tensor_.data = nullptr;
-    }
-    for (auto &tensor: output_tensors_) {
-        free(tensor.data);
-        tensor.data = nullptr;
+    for (auto &slot: slots_) {
+        free(slot.input_tensor.data);
+        slot.input_tensor.data = nullptr;
+        for (auto &tensor: slot.output_tensors) {
+            free(tensor.data);
+            tensor.data = nullptr;
+        }
     }
 }
 
@@ -57,40 +55,7 @@ nn_error_e Yolov5::LoadModel(const char *model_path) {
         NN_LOG_ERROR("yolo load model file failed");
         return ret;
     }
-    // get input tensor
-    auto input_shapes = engine_->GetInputShapes();
-
-    // check number of input and n_dims
-    if (input_shapes.size() != 1) {
-        NN_LOG_ERROR("yolo input tensor number is not 1, but %ld", input_shapes.size());
-        return NN_RKNN_INPUT_ATTR_ERROR;
-    }
-    nn_tensor_attr_to_cvimg_input_data(input_shapes[0], input_tensor_);
-    input_tensor_.data = malloc(input_tensor_.attr.size);
-
-    auto output_shapes = engine_->GetOutputShapes();
-
-    for (int i = 0; i < output_shapes.size(); i++) {
-        tensor_data_s tensor;
-        tensor.attr.n_elems = output_shapes[i].n_elems;
-        tensor.attr.n_dims = output_shapes[i].n_dims;
-        for (int j = 0; j < output_shapes[i].n_dims; j++) {
-            tensor.attr.dims[j] = output_shapes[i].dims[j];
-        }
-        // output tensor needs to be float32
-        if (output_shapes[i].type != NN_TENSOR_INT8) {
-            NN_LOG_ERROR("yolo output tensor type is not int8, but %d", output_shapes[i].type);
-            return NN_RKNN_OUTPUT_ATTR_ERROR;
-        }
-        tensor.attr.type = output_shapes[i].type;
-        tensor.attr.index = i;
-        tensor.attr.size = output_shapes[i].n_elems * nn_tensor_type_to_size(tensor.attr.type);
-        tensor.data = malloc(tensor.attr.size);
-        output_tensors_.push_back(tensor);
-        out_zps_.push_back(output_shapes[i].zp);
-        out_scales_.push_back(output_shapes[i].scale);
-    }
-    return NN_SUCCESS;
+    return SetupTensors();
 }
 
 
@@ -102,6 +67,32 @@ nn_error_e Yolov5::LoadModelWithData(char *modelData, int modelSize) {
         NN_LOG_ERROR("yolo load model file failed");
         return ret;
     }
+    return SetupTensors();
+}
+
+// 复制已加载实例的引擎context，共享模型权重
+nn_error_e Yolov5::LoadModelShared(const Yolov5 &base) {
+    auto ret = engine_->LoadModelShared(base.engine_);
+    if (ret != NN_SUCCESS) {
+        return ret;
+    }
+    return SetupTensors();
+}
+
+nn_error_e Yolov5::SetNpuAffinity(uint32_t core_mask, std::shared_ptr <NpuUsageTracker> usage) {
+    npu_usage_ = std::move(usage);
+    nn_error_e ret = engine_->SetCoreMask(core_mask);
+    if (ret != NN_SUCCESS) {
+        NN_LOG_WARNING("set npu core mask %u failed, error: %d", core_mask, ret);
+        return ret;
+    }
+    core_mask_ = core_mask;
+    return NN_SUCCESS;
+}
+
+// 按模型的输入输出属性为每一帧分配缓冲区
+// 模型batch维大于1时，张量按单帧形状分配（dims[0]=1），由引擎在RunBatch中拼接/拆分
+nn_error_e Yolov5::SetupTensors() {
     // get input tensor
     auto input_shapes = engine_->GetInputShapes();
 
@@ -110,163 +101,259 @@ nn_error_e Yolov5::LoadModelWithData(char *modelData, int modelSize) {
         NN_LOG_ERROR("yolo input tensor number is not 1, but %ld", input_shapes.size());
         return NN_RKNN_INPUT_ATTR_ERROR;
     }
-    nn_tensor_attr_to_cvimg_input_data(input_shapes[0], input_tensor_);
-    input_tensor_.data = malloc(input_tensor_.attr.size);
+    int batch = engine_->GetMaxBatchSize();
+    if (batch < 1 || input_shapes[0].dims[0] != (uint32_t) batch) {
+        NN_LOG_ERROR("yolo input batch %d does not match dims[0] %d", batch, input_shapes[0].dims[0]);
+        return NN_RKNN_INPUT_ATTR_ERROR;
+    }
+    tensor_data_s input_tensor;
+    nn_tensor_attr_to_cvimg_input_data(input_shapes[0], input_tensor);
+    input_tensor.attr.dims[0] = 1;
+    input_tensor.attr.n_elems /= batch;
+    input_tensor.attr.size /= batch;
 
     auto output_shapes = engine_->GetOutputShapes();
+    std::vector <tensor_data_s> output_tensors;
+    std::vector <tensor_attr_s> output_attrs;
 
     for (int i = 0; i < output_shapes.size(); i++) {
         tensor_data_s tensor;
-        tensor.attr.n_elems = output_shapes[i].n_elems;
+        tensor.attr.n_elems = output_shapes[i].n_elems / batch;
         tensor.attr.n_dims = output_shapes[i].n_dims;
         for (int j = 0; j < output_shapes[i].n_dims; j++) {
             tensor.attr.dims[j] = output_shapes[i].dims[j];
         }
-        // output tensor needs to be float32
-        if (output_shapes[i].type != NN_TENSOR_INT8) {
-            NN_LOG_ERROR("yolo output tensor type is not int8, but %d", output_shapes[i].type);
-            return NN_RKNN_OUTPUT_ATTR_ERROR;
-        }
+        tensor.attr.dims[0] = 1;
         tensor.attr.type = output_shapes[i].type;
+        tensor.attr.layout = output_shapes[i].layout;
+        tensor.attr.zp = output_shapes[i].zp;
+        tensor.attr.scale = output_shapes[i].scale;
         tensor.attr.index = i;
-        tensor.attr.size = output_shapes[i].n_elems * nn_tensor_type_to_size(tensor.attr.type);
-        tensor.data = malloc(tensor.attr.size);
-        output_tensors_.push_back(tensor);
-        out_zps_.push_back(output_shapes[i].zp);
-        out_scales_.push_back(output_shapes[i].scale);
+        tensor.attr.size = tensor.attr.n_elems * nn_tensor_type_to_size(tensor.attr.type);
+        tensor.data = nullptr;
+        output_tensors.push_back(tensor);
+        output_attrs.push_back(tensor.attr);
+    }
+
+    // 按输出张量的形状与类型选择检测头（YOLOv5 / YOLOv8，int8 / float16 / float32）
+    int model_in_h = input_tensor.attr.dims[1];
+    int model_in_w = input_tensor.attr.dims[2];
+    nn_error_e ret = create_detect_head(output_attrs, model_in_h, model_in_w, head_);
+    if (ret != NN_SUCCESS) {
+        return ret;
+    }
+    SetupLabels();
+
+    yolov5::reserve_decode_workspace(&decode_ws_, head_->Info().max_candidates);
+
+    slots_.resize(batch);
+    for (auto &slot: slots_) {
+        slot.input_tensor = input_tensor;
+        slot.input_tensor.data = malloc(input_tensor.attr.size);
+        slot.output_tensors = output_tensors;
+        for (auto &tensor: slot.output_tensors) {
+            tensor.data = malloc(tensor.attr.size);
+        }
+    }
+    if (batch > 1) {
+        NN_LOG_INFO("yolo model batch size: %d", batch);
     }
     return NN_SUCCESS;
 }
 
 
+// 标签优先级：模型自定义字符串中的labels > LoadLabels加载的标签文件 > 默认标签
+void Yolov5::SetupLabels() {
+    int num_classes = head_->Info().num_classes;
+    std::vector <std::string> labels;
+    if (parse_labels_from_custom_string(engine_->GetCustomString(), labels)) {
+        if ((int) labels.size() != num_classes) {
+            NN_LOG_WARNING("model labels count %d does not match %d classes", (int) labels.size(), num_classes);
+        }
+        labels_ = labels;
+        return;
+    }
+    if ((int) labels_.size() == num_classes) {
+        return;
+    }
+    labels_ = default_labels(num_classes);
+}
+
+// 加载标签文件，每行一个类别名
+nn_error_e Yolov5::LoadLabels(const char *path) {
+    std::vector <std::string> labels;
+    if (!load_labels_file(path, labels)) {
+        return NN_LABELS_LOAD_FAIL;
+    }
+    if (head_ && (int) labels.size() != head_->Info().num_classes) {
+        NN_LOG_WARNING("labels file has %d entries, model has %d classes", (int) labels.size(),
+                       head_->Info().num_classes);
+    }
+    labels_ = labels;
+    return NN_SUCCESS;
+}
+
 // 图像预处理
-nn_error_e Yolov5::Preprocess(const cv::Mat &img, const std::string process_type, cv::Mat &image_letterbox) {
+nn_error_e Yolov5::Preprocess(const image_frame_s &img, FrameSlot &slot) {
 
     // 预处理包含：letterbox、归一化、BGR2RGB、NCWH
-    // 其中RKNN会做：归一化、NCWH转换（详见课程文档），所以这里只需要做letterbox、BGR2RGB
-
-    // 比例
-    float wh_ratio = (float) input_tensor_.attr.dims[2] / (float) input_tensor_.attr.dims[1];
-
-    // lettorbox
-
-    if (process_type == "opencv") {
-        // BGR2RGB，resize，再放入input_tensor_中
-        letterbox_info_ = letterbox(img, image_letterbox, wh_ratio);
-        cvimg2tensor(image_letterbox, input_tensor_.attr.dims[2], input_tensor_.attr.dims[1], input_tensor_);
-    } else if (process_type == "rga") {
-        // rga resize
-        letterbox_info_ = letterbox_rga(img, image_letterbox, wh_ratio);
-        // save img
-        // cv::imwrite("rga.jpg", image_letterbox);
-        cvimg2tensor_rga(image_letterbox, input_tensor_.attr.dims[2], input_tensor_.attr.dims[1], input_tensor_);
-    }
+    // 其中RKNN会做：归一化、NCWH转换（详见课程文档），所以这里只需要做letterbox、转RGB
+    // 缩放、填充和颜色转换一次完成，直接写入input_tensor，不产生中间图像
+    tensor_data_s &input_tensor = slot.input_tensor;
+    slot.letterbox = compute_letterbox_geometry(img.width, img.height,
+                                                input_tensor.attr.dims[2], input_tensor.attr.dims[1]);
+    return letterbox_into_tensor(img, slot.letterbox, 0, input_tensor);
+}
 
-    return NN_SUCCESS;
+// 推理，count为本次使用的slots_数量
+nn_error_e Yolov5::Inference(size_t count) {
+    if (npu_usage_ == nullptr) {
+        return RunEngine(count);
+    }
+    auto start = std::chrono::steady_clock::now();
+    nn_error_e ret = RunEngine(count);
+    auto busy = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    npu_usage_->AddBusy(core_mask_, busy.count());
+    return ret;
 }
 
-// 推理
-nn_error_e Yolov5::Inference() {
-    std::vector <tensor_data_s> inputs;
-    // 将input_tensor_放入inputs中
-    inputs.push_back(input_tensor_);
-    // 运行模型
-    engine_->Run(inputs, output_tensors_, false);
-    return NN_SUCCESS;
+nn_error_e Yolov5::RunEngine(size_t count) {
+    if (slots_.size() == 1) {
+        std::vector <tensor_data_s> inputs;
+        // 将input_tensor放入inputs中
+        inputs.push_back(slots_[0].input_tensor);
+        // 运行模型
+        return engine_->Run(inputs, slots_[0].output_tensors, false);
+    }
+
+    // batch模型：即使只有一帧也走RunBatch，由引擎拼成完整的batch输入
+    std::vector <std::vector<tensor_data_s>> batch_inputs(count);
+    std::vector <std::vector<tensor_data_s>> batch_outputs(count);
+    for (size_t k = 0; k < count; k++) {
+        batch_inputs[k].push_back(slots_[k].input_tensor);
+        batch_outputs[k] = slots_[k].output_tensors;
+    }
+    return engine_->RunBatch(batch_inputs, batch_outputs, false);
 }
 
 // 运行模型
 nn_error_e Yolov5::Run(const cv::Mat &img, std::vector <Detection> &objects) {
-    // letterbox后的图像
-    cv::Mat image_letterbox;
-    // 预处理，支持opencv或rga
-    Preprocess(img, "opencv", image_letterbox);
-    // Preprocess(img, "rga", image_letterbox);
+    if (img.type() != CV_8UC3) {
+        NN_LOG_ERROR("img has to be 3 channels");
+        return NN_IMAGE_FORMAT_UNSUPPORTED;
+    }
+    image_frame_s frame;
+    frame.data = img.data;
+    frame.width = img.cols;
+    frame.height = img.rows;
+    frame.stride = (int) img.step;
+    frame.height_stride = img.rows;
+    frame.format = RK_FORMAT_BGR_888;
+    // 预处理
+    nn_error_e ret = Preprocess(frame, slots_[0]);
+    if (ret != NN_SUCCESS) {
+        return ret;
+    }
     // 推理
-    Inference();
+    ret = Inference(1);
+    if (ret != NN_SUCCESS) {
+        return ret;
+    }
     // 后处理
-    Postprocess(image_letterbox, objects);
-    return NN_SUCCESS;
+    return Postprocess(slots_[0], objects);
+}
 
+// 直接从解码帧（RGBA或NV12，带stride）做letterbox，几何参数记录到帧上供显示侧使用
+nn_error_e Yolov5::PrepareFrameData(const std::shared_ptr <frame_data_t> &frameData, FrameSlot &slot) {
+    image_frame_s frame;
+    frame.data = (const uint8_t *) frameData->data.get();
+    frame.width = frameData->screenW;
+    frame.height = frameData->screenH;
+    frame.height_stride = frameData->heightStride;
+    frame.format = frameData->frameFormat;
+    if (frame.format == RK_FORMAT_YCbCr_420_SP) {
+        frame.stride = frameData->widthStride;
+    } else {
+        frame.stride = frameData->widthStride * get_bpp_from_format(frame.format);
+    }
+
+    // 不可以用rga, 不然直接硬件嗝屁了.
+    nn_error_e ret = Preprocess(frame, slot);
+    frameData->letterbox = slot.letterbox;
+    return ret;
 }
 
 nn_error_e Yolov5::RunWithFrameData(const std::shared_ptr <frame_data_t> frameData, std::vector <Detection> &objects) {
-    // letterbox后的图像
-    cv::Mat image_letterbox;
-    rga_buffer_t origin;
-    struct timeval start, end;
-    gettimeofday(&start, NULL);
-
-    int inputWidth = frameData->widthStride;
-    int inputHeight = frameData->heightStride;
-
-    // LOGD("RunWithFrameData inputWidth :%d inputHeight:%d", inputWidth, inputHeight);
-    // im_rect src_rect;
-    // memset(&src_rect, 0, sizeof(src_rect));
-    // rga_letter_box(&origin, frameData->data, inputWidth, inputHeight, frameData->frameFormat, &letterbox_info_.hor, &letterbox_info_.pad);
-
-    origin = wrapbuffer_virtualaddr((void *) frameData->data.get(), inputWidth, inputHeight, frameData->frameFormat);
-    cv::Mat origin_mat = cv::Mat::zeros(inputHeight, inputWidth, CV_8UC3);
-    // 先转成cv matrix
-    rga_buffer_t rgb_img = wrapbuffer_virtualaddr((void *) origin_mat.data, inputWidth, inputHeight, RK_FORMAT_RGB_888);
-    imcopy(origin, rgb_img);
-
-    // destroy frameData;
-    // LOGD("RunWithFrameData Start preprocess");
-    // 预处理，支持opencv或rga
-    Preprocess(origin_mat, "opencv", image_letterbox);
-
-    // LOGD("RunWithFrameData Start inference");
-    // 不可以用rga, 不然直接硬件嗝屁了.
-    // Preprocess(origin_mat, "rga", image_letterbox);
+    // 预处理
+    nn_error_e ret = PrepareFrameData(frameData, slots_[0]);
+    if (ret != NN_SUCCESS) {
+        NN_LOG_ERROR("yolo preprocess frame %d failed, error: %d", frameData->frameId, ret);
+        return ret;
+    }
     // 推理
-    Inference();
-    // LOGD("RunWithFrameData Start post-process");
+    ret = Inference(1);
+    if (ret != NN_SUCCESS) {
+        return ret;
+    }
     // 后处理
-    Postprocess(image_letterbox, objects);
-
-    // LOGD("RunWithFrameData letterbox_decode");
-    // letterbox_decode(objects, letterbox_info_.hor, letterbox_info_.pad);
-
-    // LOGD("RunWithFrameData End post-process");
-    gettimeofday(&end, NULL);
-    // LOGD("RunWithFrameData time cost: %ld ms", (end.tv_sec - start.tv_sec) * 1000 + (end.tv_usec - start.tv_usec) / 1000);
-
-    return NN_SUCCESS;
-
+    return Postprocess(slots_[0], objects);
 }
 
+nn_error_e Yolov5::RunBatchWithFrameData(const std::vector <std::shared_ptr<frame_data_t>> &frames,
+                                         std::vector <std::vector<Detection>> &objects) {
+    if (frames.size() > slots_.size()) {
+        NN_LOG_ERROR("yolo batch of %zu frames exceeds model batch %zu", frames.size(), slots_.size());
+        return NN_IO_NUM_NOT_MATCH;
+    }
+    objects.resize(frames.size());
+    if (frames.empty()) {
+        return NN_SUCCESS;
+    }
 
-void letterbox_decode(std::vector <Detection> &objects, bool hor, int pad) {
-    for (auto &obj: objects) {
-        if (hor) {
-            obj.box.x -= pad;
-        } else {
-            obj.box.y -= pad;
+    // 每帧预处理到各自的输入缓冲区，一次推理，再按帧拆分后处理
+    for (size_t k = 0; k < frames.size(); k++) {
+        nn_error_e ret = PrepareFrameData(frames[k], slots_[k]);
+        if (ret != NN_SUCCESS) {
+            NN_LOG_ERROR("yolo preprocess frame %d failed, error: %d", frames[k]->frameId, ret);
+            return ret;
         }
     }
+
+    nn_error_e ret = Inference(frames.size());
+    if (ret != NN_SUCCESS) {
+        NN_LOG_ERROR("yolo batch inference failed, error: %d", ret);
+        return ret;
+    }
+
+    for (size_t k = 0; k < frames.size(); k++) {
+        objects[k].clear();
+        Postprocess(slots_[k], objects[k]);
+    }
+    return NN_SUCCESS;
 }
 
+
 // 后处理
-nn_error_e Yolov5::Postprocess(const cv::Mat &img, std::vector <Detection> &objects) {
-    int height = input_tensor_.attr.dims[1];
-    int width = input_tensor_.attr.dims[2];
-    float scale_w = height * 1.f / img.cols; // 保证为浮点类型
-    float scale_h = width * 1.f / img.rows;
+nn_error_e Yolov5::Postprocess(FrameSlot &slot, std::vector <Detection> &objects) {
+    int height = slot.input_tensor.attr.dims[1];
+    int width = slot.input_tensor.attr.dims[2];
 
     yolov5::detect_result_group_t detections;
 
-    yolov5::post_process((int8_t *) output_tensors_[0].data,
-                         (int8_t *) output_tensors_[1].data,
-                         (int8_t *) output_tensors_[2].data,
-                         height, width,
-                         BOX_THRESH, NMS_THRESH,
-                         scale_w, scale_h,
-                         out_zps_, out_scales_,
-                         &detections);
-
+    // 先得到模型坐标系下的框，再按letterbox几何参数映射回原图
+    head_->Decode(slot.output_tensors, BOX_THRESH, &decode_ws_);
+    yolov5::collect_detections(&decode_ws_, nms_config_, height, width, 1.f, 1.f, &labels_, &detections);
+
+    for (int i = 0; i < detections.count; i++) {
+        yolov5::BOX_RECT &box = detections.results[i].box;
+        float left = box.left, top = box.top, right = box.right, bottom = box.bottom;
+        letterbox_unmap_box(slot.letterbox, left, top, right, bottom);
+        box.left = (int) left;
+        box.top = (int) top;
+        box.right = (int) right;
+        box.bottom = (int) bottom;
+    }
     DetectionGrp2DetectionArray(detections, objects);
-    letterbox_decode(objects, letterbox_info_.hor, letterbox_info_.pad);
 
     return NN_SUCCESS;
 }
@@ -5,30 +5,73 @@
 
 #include "yolo_datatype.h"
 #include "engine.h"
-#include "preprocess.h"
+#include "letterbox.h"
+#include "detect_head.h"
+#include "npu_affinity.h"
+#include "yolov5_postprocess.h"
 #include "user_comm.h"
 
 class Yolov5 {
 public:
-    Yolov5();
+    Yolov5(); // 使用默认引擎（engine_registry.h）
+
+    explicit Yolov5(std::shared_ptr <NNEngine> engine); // 使用指定引擎（如桩引擎）
 
     ~Yolov5();
     nn_error_e LoadModelWithData(char *modelData, int modelSize);
     nn_error_e LoadModel(const char *model_path);                        // 加载模型
+    // 复制base（已加载同一模型）的引擎context以共享权重；引擎不支持时返回错误，调用方应退回LoadModel*
+    nn_error_e LoadModelShared(const Yolov5 &base);
     nn_error_e Run(const cv::Mat &img, std::vector <Detection> &objects); // 运行模型
     nn_error_e RunWithFrameData(const std::shared_ptr <frame_data_t> frameData, std::vector <Detection> &objects);
 
+    // 批量推理：frames数量不超过GetMaxBatchSize()，objects[k]对应frames[k]
+    nn_error_e RunBatchWithFrameData(const std::vector <std::shared_ptr<frame_data_t>> &frames,
+                                     std::vector <std::vector<Detection>> &objects);
+
+    // 模型输入的batch维，即一次推理最多可处理的帧数
+    int GetMaxBatchSize() const { return (int) slots_.size(); }
+
+    // 后处理NMS配置，只能在调用推理的线程上修改
+    void SetNmsConfig(const nms_config_s &config) { nms_config_ = config; }
+    const nms_config_s &GetNmsConfig() const { return nms_config_; }
+
+    // 指定NPU核心（npu_core_mask_e），usage非空时每次推理的耗时计入该核心的统计
+    nn_error_e SetNpuAffinity(uint32_t core_mask, std::shared_ptr <NpuUsageTracker> usage);
+    uint32_t GetCoreMask() const { return core_mask_; }
+
+    // 引擎报告的模型权重内存（字节），未知时为0
+    size_t GetWeightMemorySize() const { return engine_->GetWeightMemorySize(); }
+
+    // 加载标签文件（每行一个类别名）；模型自定义字符串中带labels时以模型为准
+    nn_error_e LoadLabels(const char *path);
+    const std::vector <std::string> &GetLabels() const { return labels_; }
+
 private:
-    nn_error_e Preprocess(const cv::Mat &img, const std::string process_type, cv::Mat &image_letterbox);   // 图像预处理
-    nn_error_e Inference();                                                      // 推理
-    nn_error_e Postprocess(const cv::Mat &img, std::vector <Detection> &objects); // 后处理
-
-    LetterBoxInfo letterbox_info_;
-    tensor_data_s input_tensor_;
-    std::vector <tensor_data_s> output_tensors_;
-    std::vector <int32_t> out_zps_;
-    std::vector<float> out_scales_;
+    // 一帧推理所用的输入/输出缓冲区（单帧形状），批量推理时每帧占用一个
+    // input_tensor即引擎输入内存，每个工作实例预先分配，预处理直接写入
+    struct FrameSlot {
+        letterbox_geometry_s letterbox;
+        tensor_data_s input_tensor;
+        std::vector <tensor_data_s> output_tensors;
+    };
+
+    nn_error_e SetupTensors();                                                   // 按模型输入输出分配各帧缓冲区
+    nn_error_e PrepareFrameData(const std::shared_ptr <frame_data_t> &frameData, FrameSlot &slot); // 帧数据预处理
+    nn_error_e Preprocess(const image_frame_s &img, FrameSlot &slot);            // letterbox+颜色转换写入input_tensor
+    nn_error_e Inference(size_t count);                                          // 推理（count帧），计入NPU耗时统计
+    nn_error_e RunEngine(size_t count);
+    nn_error_e Postprocess(FrameSlot &slot, std::vector <Detection> &objects);   // 后处理
+    void SetupLabels();                                                          // 选择类别标签
+
+    std::vector <FrameSlot> slots_; // slots_[0]供单帧路径使用
+    std::unique_ptr <DetectHead> head_;      // 按模型输出选定的解码器
+    std::vector <std::string> labels_;
+    yolov5::decode_workspace_t decode_ws_; // 解码/NMS缓冲区与sigmoid查找表，各帧复用
+    nms_config_s nms_config_;
     std::shared_ptr <NNEngine> engine_;
+    uint32_t core_mask_;
+    std::shared_ptr <NpuUsageTracker> npu_usage_;
 };
 
 #endif // RK3588_DEMO_YOLOV5_H
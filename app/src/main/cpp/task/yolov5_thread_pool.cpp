@@ -1,80 +1,140 @@
-
 #include "yolov5_thread_pool.h"
 #include "cv_draw.h"
+#include "engine_registry.h"
 #include "sys/time.h"
+#include <unistd.h>
 
 void Yolov5ThreadPool::worker(int id) {
+    std::shared_ptr<Yolov5> instance = yolov5_instances[id];
+    int applied_nms_version = -1;
     while (!stop) {
-        // std::pair<int, cv::Mat> task;
         std::shared_ptr<frame_data_t> taskFrameData;
-        std::shared_ptr<Yolov5> instance = yolov5_instances[id];
-        {
-            std::unique_lock<std::mutex> lock(mtx1);
-            cv_task.wait(lock, [&] { return !tasks.empty() || stop; });
-
-            if (stop) {
-                return;
-            }
+        // 队列为空时挂起，stopAll()关闭队列后返回false
+        if (!tasks.pop(taskFrameData)) {
+            return;
+        }
 
-            taskFrameData = tasks.front();
-            tasks.pop();
+        int version = nms_version.load();
+        if (version != applied_nms_version) {
+            std::lock_guard<std::mutex> lock(nms_mutex);
+            instance->SetNmsConfig(nms_config);
+            applied_nms_version = nms_version.load();
         }
 
         std::vector<Detection> detections;
         struct timeval start, end;
         gettimeofday(&start, NULL);
         instance->RunWithFrameData(taskFrameData, detections);
-        // instance->Run(task.second, detections);
         gettimeofday(&end, NULL);
         float time_use = (end.tv_sec - start.tv_sec) * 1000 + (end.tv_usec - start.tv_usec) / 1000;
         LOGD("thread %d, time_use: %f ms\n", id, time_use);
-        {
-            std::lock_guard<std::mutex> lock(mtx2);
-            results.insert({taskFrameData->frameId, detections});
-            // DrawDetections(task.second, detections);
-            // img_results.insert({task.first, task.second});
-            img_results.insert({taskFrameData->frameId, taskFrameData});
-            // cv_result.notify_one();
-        }
+
+        int frameId = taskFrameData->frameId;
+        results.complete(frameId, std::move(detections), std::move(taskFrameData));
     }
 }
 
 
-nn_error_e Yolov5ThreadPool::setUpWithModelData(int num_threads, char *modelData, int modelSize) {
-    // 遍历线程数量，创建模型实例，放入vector
+nn_error_e Yolov5ThreadPool::setUpWithModelData(int num_threads, char *modelData, int modelSize,
+                                                const npu_affinity_config_s &npu) {
+    return setUpWithEngineFactory(num_threads, CreateDefaultNNEngine, modelData, modelSize, npu);
+}
+
+nn_error_e Yolov5ThreadPool::setUpWithEngineFactory(int num_threads,
+                                                    const std::function<std::shared_ptr<NNEngine>()> &engineFactory,
+                                                    char *modelData, int modelSize,
+                                                    const npu_affinity_config_s &npu) {
+    npu_config = npu;
     // 这些线程加载的模型是同一个
-    for (size_t i = 0; i < num_threads; ++i) {
-        std::shared_ptr<Yolov5> yolov5 = std::make_shared<Yolov5>();
-        yolov5->LoadModelWithData(modelData, modelSize);
-        yolov5_instances.push_back(yolov5);
-        usleep(1000);
-    }
+    nn_error_e ret = createInstances(num_threads, [&] { return std::make_shared<Yolov5>(engineFactory()); },
+                                     [&](Yolov5 &yolov5) { return yolov5.LoadModelWithData(modelData, modelSize); });
 
     // 遍历线程数量，创建线程
     for (size_t i = 0; i < num_threads; ++i) {
         threads.emplace_back(&Yolov5ThreadPool::worker, this, i);
     }
-    return NN_SUCCESS;
+    return ret;
 }
 
 
-nn_error_e Yolov5ThreadPool::setUp(std::string &model_path, int num_threads) {
+nn_error_e Yolov5ThreadPool::setUp(std::string &model_path, int num_threads, const npu_affinity_config_s &npu) {
+    npu_config = npu;
+    nn_error_e ret = createInstances(num_threads, [] { return std::make_shared<Yolov5>(); },
+                                     [&](Yolov5 &yolov5) { return yolov5.LoadModel(model_path.c_str()); });
     for (size_t i = 0; i < num_threads; ++i) {
-        std::shared_ptr<Yolov5> yolov5 = std::make_shared<Yolov5>();
-        yolov5->LoadModel(model_path.c_str());
+        threads.emplace_back(&Yolov5ThreadPool::worker, this, i);
+    }
+    return ret;
+}
+
+nn_error_e Yolov5ThreadPool::createInstances(int num_threads, const std::function<std::shared_ptr<Yolov5>()> &create,
+                                             const std::function<nn_error_e(Yolov5 &)> &load) {
+    nn_error_e first_ret = NN_SUCCESS;
+    bool can_share = npu_config.share_weights;
+    for (int i = 0; i < num_threads; ++i) {
+        std::shared_ptr<Yolov5> yolov5 = create();
+        nn_error_e ret = NN_LOAD_MODEL_FAIL;
+        if (i > 0 && can_share && first_ret == NN_SUCCESS) {
+            ret = yolov5->LoadModelShared(*yolov5_instances[0]);
+            if (ret == NN_SUCCESS) {
+                shared_contexts++;
+            } else {
+                // 引擎不支持或复制失败，之后的实例都完整加载
+                LOGD("thread pool: engine context sharing unavailable (%d), loading the model per instance", ret);
+                can_share = false;
+            }
+        }
+        if (ret != NN_SUCCESS) {
+            ret = load(*yolov5);
+            if (ret != NN_SUCCESS) {
+                LOGE("thread pool: instance %d failed to load model, error: %d", i, ret);
+            }
+        }
+        if (i == 0) {
+            first_ret = ret;
+        }
+        uint32_t mask = npu_core_mask_for_worker(npu_config, i);
+        if (mask != NPU_CORE_AUTO || npu_config.usage_tracker != nullptr) {
+            yolov5->SetNpuAffinity(mask, npu_config.usage_tracker);
+        }
         yolov5_instances.push_back(yolov5);
+        usleep(1000);
     }
-    for (size_t i = 0; i < num_threads; ++i) {
-        threads.emplace_back(&Yolov5ThreadPool::worker, this, i);
+    NpuStats stats = getNpuStats();
+    LOGD("thread pool: %d instances, %d shared contexts, %zu weight bytes saved", stats.instances,
+                stats.sharedContexts, stats.weightBytesSaved);
+    return first_ret;
+}
+
+Yolov5ThreadPool::NpuStats Yolov5ThreadPool::getNpuStats() {
+    NpuStats stats;
+    stats.instances = (int) yolov5_instances.size();
+    stats.sharedContexts = shared_contexts;
+    stats.weightBytesPerContext = yolov5_instances.empty() ? 0 : yolov5_instances[0]->GetWeightMemorySize();
+    stats.weightBytesSaved = stats.weightBytesPerContext * shared_contexts;
+    for (const auto &instance: yolov5_instances) {
+        stats.coreMasks.push_back(instance->GetCoreMask());
     }
-    return NN_SUCCESS;
+    return stats;
 }
 
-Yolov5ThreadPool::Yolov5ThreadPool() { stop = false; }
+Yolov5ThreadPool::Yolov5ThreadPool() : tasks(MAX_TASK), results(MAX_RESULT_SLOTS), stop(false),
+                                       nms_config(nms_default_config()), nms_version(0),
+                                       npu_config(npu_affinity_default_config()), shared_contexts(0) {}
+
+void Yolov5ThreadPool::setNmsConfig(const nms_config_s &config) {
+    std::lock_guard<std::mutex> lock(nms_mutex);
+    nms_config = config;
+    nms_version++;
+}
+
+nms_config_s Yolov5ThreadPool::getNmsConfig() {
+    std::lock_guard<std::mutex> lock(nms_mutex);
+    return nms_config;
+}
 
 Yolov5ThreadPool::~Yolov5ThreadPool() {
-    stop = true;
-    cv_task.notify_all();
+    stopAll();
     for (auto &thread: threads) {
         if (thread.joinable()) {
             thread.join();
@@ -82,76 +142,66 @@ Yolov5ThreadPool::~Yolov5ThreadPool() {
     }
 }
 
-nn_error_e Yolov5ThreadPool::submitTask(const std::shared_ptr<frame_data_t> frameData) {
-    while (tasks.size() > MAX_TASK) {
-        // sleep 1ms
-        LOGD("mpp_decoder_frame_callback waiting");
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+nn_error_e Yolov5ThreadPool::submitTask(const std::shared_ptr<frame_data_t> frameData, int timeout_ms) {
+    if (stop) {
+        return NN_STOPED;
     }
-    {
-        std::lock_guard<std::mutex> lock(mtx1);
-        LOGD("Submit task %d", frameData->frameId);
-        tasks.push(frameData);
-        // tasks.push({id, img});
+    std::shared_ptr<frame_data_t> task = frameData;
+    LOGD("Submit task %d", frameData->frameId);
+    if (!tasks.push(task, timeout_ms)) {
+        if (stop) {
+            return NN_STOPED;
+        }
+        LOGW("submitTask: frame %d timed out waiting for queue space", frameData->frameId);
+        return NN_TIMEOUT;
     }
-    cv_task.notify_one();
     return NN_SUCCESS;
 }
 
-nn_error_e Yolov5ThreadPool::getTargetResult(std::vector<Detection> &objects, int id) {
-    while (results.find(id) == results.end()) {
-        // sleep 1ms
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+nn_error_e Yolov5ThreadPool::trySubmitTask(const std::shared_ptr<frame_data_t> frameData) {
+    if (stop) {
+        return NN_STOPED;
     }
-    std::lock_guard<std::mutex> lock(mtx2);
-    objects = results[id];
-    // remove from map
-    results.erase(id);
-    img_results.erase(id);
-
+    std::shared_ptr<frame_data_t> task = frameData;
+    if (!tasks.tryPush(task)) {
+        return NN_QUEUE_FULL;
+    }
+    LOGD("Submit task %d", frameData->frameId);
     return NN_SUCCESS;
 }
 
-nn_error_e Yolov5ThreadPool::getTargetResultNonBlock(std::vector<Detection> &objects, int id) {
-    std::lock_guard<std::mutex> lock(mtx2);
-
-    // 在锁保护下检查结果是否存在
-    auto it = results.find(id);
-    if (it == results.end()) {
-        return NN_RESULT_NOT_READY;
+nn_error_e Yolov5ThreadPool::completeWithoutInference(const std::shared_ptr<frame_data_t> frameData) {
+    if (stop) {
+        return NN_STOPED;
     }
+    results.complete(frameData->frameId, std::vector<Detection>(), frameData);
+    return NN_SUCCESS;
+}
 
-    // 安全地获取结果
-    objects = it->second;
-
-    // 从map中移除结果
-    results.erase(it);
-    // img_results.erase(id);
+nn_error_e Yolov5ThreadPool::getTargetResult(std::vector<Detection> &objects, int id) {
+    // 在结果槽上挂起等待，直到该帧完成或线程池停止
+    return results.takeResultAndImage(id, objects, -1);
+}
 
-    return NN_SUCCESS;
+nn_error_e Yolov5ThreadPool::getTargetResultNonBlock(std::vector<Detection> &objects, int id) {
+    return results.takeResult(id, objects, 0);
 }
 
 std::shared_ptr<frame_data_t> Yolov5ThreadPool::getTargetImgResult(int id) {
-    std::lock_guard<std::mutex> lock(mtx2);
-
-    // 在锁保护下检查图像结果是否存在
-    auto it = img_results.find(id);
-    if (it == img_results.end()) {
+    auto frameData = results.takeImage(id);
+    if (!frameData) {
         LOGW("getTargetImgResult: frame %d not found", id);
-        return nullptr;
     }
-
-    // 安全地获取图像结果
-    auto frameData = it->second;
-
-    // 从map中移除图像结果
-    img_results.erase(it);
-
     return frameData;
 }
 
+nn_error_e Yolov5ThreadPool::waitForResult(uint64_t &seen, int timeout_ms) {
+    return results.waitForCompletion(seen, timeout_ms);
+}
+
 // 停止所有线程
 void Yolov5ThreadPool::stopAll() {
     stop = true;
-    cv_task.notify_all();
+    tasks.close();
+    results.stop();
 }
@@ -4,54 +4,96 @@
 
 #include <iostream>
 #include <vector>
-#include <queue>
-#include <map>
 #include <thread>
+#include <atomic>
+#include <functional>
 #include <mutex>
-#include <condition_variable>
 #include "user_comm.h"
 #include "yolov5.h"
+#include "bounded_task_ring.h"
+#include "frame_result_slots.h"
 
-#define MAX_TASK 22
+// 提交队列容量（环形队列，需为2的幂）
+#define MAX_TASK 32
+// 结果槽数量：需覆盖 队列中 + 推理中 + 尚未被取走 的帧
+#define MAX_RESULT_SLOTS 128
 
 class Yolov5ThreadPool {
 
 private:
 
-    // std::queue <std::pair<int, cv::Mat>> tasks;
     std::vector <std::shared_ptr<Yolov5>> yolov5_instances;
-    std::queue<std::shared_ptr<frame_data_t>> tasks;
-    std::map<int, std::vector<Detection>> results;
-    // std::map<int, cv::Mat> img_results;
-    std::map<int, std::shared_ptr<frame_data_t>> img_results;
+    BoundedTaskRing<std::shared_ptr<frame_data_t>> tasks;
+    FrameResultSlots results;
     std::vector <std::thread> threads;
-    std::mutex mtx1;
-    std::mutex mtx2;
-    std::condition_variable cv_task, cv_result;
-    bool stop;
+    std::atomic<bool> stop;
+
+    std::mutex nms_mutex;
+    nms_config_s nms_config;
+    std::atomic<int> nms_version; // 每次setNmsConfig加1，工作线程据此同步到各自的实例
+
+    npu_affinity_config_s npu_config;
+    int shared_contexts; // 通过LoadModelShared复制context的实例数
 
     void worker(int id);
+    // 创建num_threads个实例：首个实例完整加载，其余按npu_config共享其context（失败时退回完整加载），并设置core mask
+    nn_error_e createInstances(int num_threads, const std::function<std::shared_ptr<Yolov5>()> &create,
+                               const std::function<nn_error_e(Yolov5 &)> &load);
 
 public:
+    // NPU核心分配与权重共享情况
+    struct NpuStats {
+        int instances;
+        int sharedContexts;
+        size_t weightBytesPerContext; // 引擎报告的模型权重大小，未知时为0
+        size_t weightBytesSaved;      // 共享context省下的权重内存
+        std::vector<uint32_t> coreMasks; // 各实例的core mask
+    };
+
     Yolov5ThreadPool();
 
     ~Yolov5ThreadPool();
 
     void stopAll(); // 停止所有线程
-    nn_error_e setUpWithModelData(int num_threads, char *modelData, int modelSize);
-    nn_error_e setUp(std::string &model_path, int num_threads = 12);
+    // 使用默认引擎（engine_registry.h，默认为rknn）
+    // npu：各实例的NPU核心分配与权重共享策略（npu_affinity.h）
+    nn_error_e setUpWithModelData(int num_threads, char *modelData, int modelSize,
+                                  const npu_affinity_config_s &npu = npu_affinity_default_config());
+    nn_error_e setUp(std::string &model_path, int num_threads = 12,
+                     const npu_affinity_config_s &npu = npu_affinity_default_config());
+    // 使用自定义引擎创建工作实例（例如测试/基准中的桩引擎）
+    nn_error_e setUpWithEngineFactory(int num_threads, const std::function<std::shared_ptr<NNEngine>()> &engineFactory,
+                                      char *modelData, int modelSize,
+                                      const npu_affinity_config_s &npu = npu_affinity_default_config());
+
+    NpuStats getNpuStats();
+
+    // 阻塞提交：队列满时挂起等待空位，timeout_ms<0表示一直等待；超时返回NN_TIMEOUT
+    nn_error_e submitTask(const std::shared_ptr<frame_data_t> frameData, int timeout_ms = -1);
 
-    nn_error_e submitTask(const std::shared_ptr<frame_data_t> frameData);
+    // 非阻塞提交：队列满时立即返回NN_QUEUE_FULL，由调用方决定丢帧
+    nn_error_e trySubmitTask(const std::shared_ptr<frame_data_t> frameData);
+
+    // 不推理直接完成该帧（检测框为空），与推理帧一起按frameId取出；用于检测节拍跳过的帧
+    nn_error_e completeWithoutInference(const std::shared_ptr<frame_data_t> frameData);
 
     nn_error_e getTargetResult(std::vector <Detection> &objects, int id);
 
     nn_error_e getTargetResultNonBlock(std::vector <Detection> &objects, int id);
 
     std::shared_ptr<frame_data_t>  getTargetImgResult(int id);
-    
+
+    // 阻塞等待任一帧推理完成（见FrameResultSlots::waitForCompletion），代替轮询getTargetResultNonBlock
+    nn_error_e waitForResult(uint64_t &seen, int timeout_ms);
+
+    // 修改后处理NMS配置，工作线程在处理下一帧前生效
+    void setNmsConfig(const nms_config_s &config);
+
+    nms_config_s getNmsConfig();
+
     int get_task_size() {
-        return tasks.size();
+        return (int) tasks.size();
     }
 };
 
-#endif // RK3588_DEMO_YOLOV5_THREAD_POOL_H
\ No newline at end of file
+#endif // RK3588_DEMO_YOLOV5_THREAD_POOL_H
@@ -0,0 +1,352 @@
+#include "async_decoder.h"
+#include "packet_ring.h"
+#include "log4c.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int kGopSize = 25;
+
+/**
+ * Stands in for the MPP decoder: a bounded input queue, a fixed decode time
+ * per frame, and blocking calls with timeouts. It checks that every P frame
+ * it decodes directly follows the previous decoded picture, i.e. that the
+ * drop policy never leaves the decoder with a missing reference.
+ */
+class FakeDecoderBackend : public DecoderBackend {
+public:
+    FakeDecoderBackend(size_t inputCapacity, int decodeMs, int timeoutMs)
+            : inputCapacity_(inputCapacity), decodeMs_(decodeMs), timeoutMs_(timeoutMs), rejectAll_(false),
+              lastPictureSeq_(-1), pictures_(0), brokenPictures_(0) {}
+
+    int PutPacket(const encoded_packet_s& packet) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!spaceAvailable_.wait_for(lock, std::chrono::milliseconds(timeoutMs_),
+                                      [this] { return !rejectAll_ && input_.size() < inputCapacity_; })) {
+            return DECODER_BUSY;
+        }
+        input_.push_back(packet);
+        input_.back().data.clear();  // 只保留元数据
+        frameReady_.notify_one();
+        return DECODER_OK;
+    }
+
+    int GetFrame() override {
+        encoded_packet_s packet;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (!frameReady_.wait_for(lock, std::chrono::milliseconds(timeoutMs_), [this] { return !input_.empty(); })) {
+                return DECODER_TIMEOUT;
+            }
+            packet = input_.front();
+            input_.pop_front();
+        }
+        spaceAvailable_.notify_one();
+        if (packet.config) {
+            return DECODER_TIMEOUT;  // 参数集不出图
+        }
+        if (decodeMs_ > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(decodeMs_));
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!packet.keyframe && (int64_t) packet.seq != lastPictureSeq_ + 1) {
+            brokenPictures_++;
+        }
+        lastPictureSeq_ = (int64_t) packet.seq;
+        decodedSeqs_.push_back(packet.seq);
+        pictures_++;
+        return DECODER_OK;
+    }
+
+    void setRejectAll(bool reject) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rejectAll_ = reject;
+    }
+
+    int pictures() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pictures_;
+    }
+
+    int brokenPictures() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return brokenPictures_;
+    }
+
+    std::vector<uint64_t> decodedSeqs() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return decodedSeqs_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable spaceAvailable_;
+    std::condition_variable frameReady_;
+    std::deque<encoded_packet_s> input_;
+    size_t inputCapacity_;
+    int decodeMs_;
+    int timeoutMs_;
+    bool rejectAll_;
+    int64_t lastPictureSeq_;
+    int pictures_;
+    int brokenPictures_;
+    std::vector<uint64_t> decodedSeqs_;
+};
+
+// 一个GOP内的第i个包：每个GOP第一个是IDR，其余是P帧
+bool isKeyframe(int i) {
+    return i % kGopSize == 0;
+}
+
+bool waitFor(FakeDecoderBackend& backend, int pictures, int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (backend.pictures() < pictures && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    return backend.pictures() >= pictures;
+}
+
+}  // namespace
+
+/**
+ * Tests for the asynchronous decode path: the packet ring's drop-to-IDR
+ * policy, in-order decoding through the put/get threads, non-blocking
+ * submission under overload, and shutdown while the decoder is stalled.
+ * The decoder is a fake backend, so no MPP hardware is needed.
+ */
+class AsyncDecoderTest {
+public:
+    bool testDropUntilKeyframe() {
+        LOGD("=== Testing packet ring drop-to-IDR policy ===");
+
+        PacketRing ring(4);
+        uint8_t payload[16] = {0};
+        ring.Push(payload, sizeof(payload), 0, true, false);
+        for (int i = 1; i < 4; i++) {
+            ring.Push(payload, sizeof(payload), i, false, false);
+        }
+        // 队列满时来的P帧被丢弃，已排队的4个包保留，之后P帧一律丢弃直到IDR
+        if (ring.Push(payload, sizeof(payload), 4, false, false) || ring.Size() != 4 || !ring.WaitingForKeyframe()) {
+            LOGE("Full ring did not keep its queue and wait for a keyframe");
+            return false;
+        }
+        bool droppedP = !ring.Push(payload, sizeof(payload), 5, false, false);
+        // 配置包在队列满时清空旧包给自己腾位置
+        bool keptConfig = ring.Push(payload, 4, 6, false, true) && ring.Size() == 1;
+        bool keptIdr = ring.Push(payload, sizeof(payload), 7, true, false);
+        bool keptP = ring.Push(payload, sizeof(payload), 8, false, false);
+        if (!droppedP || !keptConfig || !keptIdr || !keptP || ring.WaitingForKeyframe()) {
+            LOGE("Resync: P dropped %d, config kept %d, IDR kept %d, next P kept %d", droppedP, keptConfig,
+                 keptIdr, keptP);
+            return false;
+        }
+
+        encoded_packet_s packet;
+        ring.Pop(packet, 0);
+        if (!packet.config || packet.seq != 6 || packet.data.size() != 4) {
+            LOGE("Expected the config packet first, got seq %llu", (unsigned long long) packet.seq);
+            return false;
+        }
+        ring.Pop(packet, 0);
+        if (!packet.keyframe || packet.seq != 7 || packet.pts != 7) {
+            LOGE("Expected the IDR after the config packet, got seq %llu", (unsigned long long) packet.seq);
+            return false;
+        }
+
+        PacketRing::stats_s stats = ring.GetStats();
+        if (stats.pushed != 9 || stats.dropped != 6 || stats.resyncs != 1 || stats.high_water != 4) {
+            LOGE("Unexpected stats: pushed %llu dropped %llu resyncs %llu", (unsigned long long) stats.pushed,
+                 (unsigned long long) stats.dropped, (unsigned long long) stats.resyncs);
+            return false;
+        }
+
+        ring.Close();
+        if (ring.Push(payload, sizeof(payload), 9, true, false) || ring.Pop(packet, 100)) {
+            LOGE("Closed ring still accepted or returned packets");
+            return false;
+        }
+
+        LOGD("Drop-to-IDR test PASSED");
+        return true;
+    }
+
+    bool testDecodeInOrder() {
+        LOGD("=== Testing in-order decoding through the decode threads ===");
+
+        FakeDecoderBackend backend(4, 0, 20);
+        AsyncDecoder decoder(&backend, 16);
+        decoder.Start();
+
+        std::vector<uint8_t> payload(1024, 0x42);
+        const int packets = 100;
+        for (int i = 0; i < packets; i++) {
+            decoder.Submit(payload.data(), payload.size(), i * 40, isKeyframe(i), false);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        bool done = waitFor(backend, packets, 5000);
+        decoder.Stop();
+
+        std::vector<uint64_t> seqs = backend.decodedSeqs();
+        for (size_t i = 0; i < seqs.size(); i++) {
+            if (seqs[i] != i) {
+                LOGE("Picture %zu has seq %llu", i, (unsigned long long) seqs[i]);
+                return false;
+            }
+        }
+        AsyncDecoder::stats_s stats = decoder.GetStats();
+        if (!done || backend.brokenPictures() != 0 || stats.frames != (uint64_t) packets ||
+            stats.ring.dropped != 0) {
+            LOGE("Decoded %d/%d pictures, frames %llu, dropped %llu", backend.pictures(), packets,
+                 (unsigned long long) stats.frames, (unsigned long long) stats.ring.dropped);
+            return false;
+        }
+
+        LOGD("In-order decode test PASSED");
+        return true;
+    }
+
+    bool testOverloadResync() {
+        LOGD("=== Testing overload: non-blocking submit and resync at IDR ===");
+
+        // 解码一帧10ms，网络线程一口气送200个包
+        FakeDecoderBackend backend(2, 10, 20);
+        AsyncDecoder decoder(&backend, 8);
+        decoder.Start();
+
+        std::vector<uint8_t> payload(4096, 0x17);
+        const int packets = 200;
+        long maxSubmitUs = 0;
+        for (int i = 0; i < packets; i++) {
+            if (isKeyframe(i) && i > 0) {
+                decoder.Submit(payload.data(), 32, i * 40, false, true);  // SPS/PPS
+            }
+            auto start = std::chrono::steady_clock::now();
+            decoder.Submit(payload.data(), payload.size(), i * 40, isKeyframe(i), false);
+            long us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+            if (us > maxSubmitUs) {
+                maxSubmitUs = us;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        decoder.Stop();
+
+        AsyncDecoder::stats_s stats = decoder.GetStats();
+        LOGD("Overload: %d pictures, %llu packets dropped, %llu resyncs, max submit %ld us", backend.pictures(),
+             (unsigned long long) stats.ring.dropped, (unsigned long long) stats.ring.resyncs, maxSubmitUs);
+        if (backend.brokenPictures() != 0) {
+            LOGE("%d P frames were decoded without their reference", backend.brokenPictures());
+            return false;
+        }
+        if (stats.ring.resyncs == 0 || backend.pictures() == 0 || backend.pictures() >= packets) {
+            LOGE("Expected drops with resync under overload");
+            return false;
+        }
+        // 送包线程卡在解码器上时，网络线程只是拷贝入队（宽松上限，避免调度抖动误报）
+        if (maxSubmitUs > 20000) {
+            LOGE("Submit blocked the network thread for %ld us", maxSubmitUs);
+            return false;
+        }
+
+        LOGD("Overload resync test PASSED");
+        return true;
+    }
+
+    bool testStopWhileStalled() {
+        LOGD("=== Testing stop while the decoder input is stalled ===");
+
+        FakeDecoderBackend backend(1, 0, 20);
+        backend.setRejectAll(true);
+        AsyncDecoder decoder(&backend, 4);
+        decoder.Start();
+
+        uint8_t payload[64] = {0};
+        for (int i = 0; i < 10; i++) {
+            decoder.Submit(payload, sizeof(payload), i, isKeyframe(i), false);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        auto start = std::chrono::steady_clock::now();
+        decoder.Stop();
+        long ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        AsyncDecoder::stats_s stats = decoder.GetStats();
+        if (ms > 500 || stats.put_busy == 0 || decoder.Submit(payload, sizeof(payload), 11, true, false)) {
+            LOGE("Stop took %ld ms (busy retries %llu)", ms, (unsigned long long) stats.put_busy);
+            return false;
+        }
+
+        LOGD("Stop while stalled test PASSED");
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting Async Decoder Tests");
+
+        int passedTests = 0;
+        int totalTests = 4;
+
+        if (testDropUntilKeyframe()) passedTests++;
+        if (testDecodeInOrder()) passedTests++;
+        if (testOverloadResync()) passedTests++;
+        if (testStopWhileStalled()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+extern "C" void runAsyncDecoderTests() {
+    AsyncDecoderTest test;
+    test.runAllTests();
+}
+
+/**
+ * Benchmark: time the network thread spends per packet when it decodes
+ * inline (put + get on the calling thread, as Decode() did) versus only
+ * submitting to the async decoder, with a fake decode cost of decodeMs.
+ */
+extern "C" void runAsyncDecoderBenchmark(int numPackets, int decodeMs) {
+    std::vector<uint8_t> payload(16 * 1024, 0x33);
+
+    FakeDecoderBackend inlineBackend(4, decodeMs, 20);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < numPackets; i++) {
+        encoded_packet_s packet;
+        packet.data.assign(payload.begin(), payload.end());
+        packet.pts = i;
+        packet.keyframe = isKeyframe(i);
+        packet.config = false;
+        packet.seq = i;
+        inlineBackend.PutPacket(packet);
+        inlineBackend.GetFrame();
+    }
+    auto inlineEnd = std::chrono::steady_clock::now();
+
+    FakeDecoderBackend asyncBackend(4, decodeMs, 20);
+    AsyncDecoder decoder(&asyncBackend, 64);
+    decoder.Start();
+    auto asyncStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < numPackets; i++) {
+        decoder.Submit(payload.data(), payload.size(), i, isKeyframe(i), false);
+    }
+    auto asyncEnd = std::chrono::steady_clock::now();
+    decoder.Stop();
+
+    double inlineUs = std::chrono::duration_cast<std::chrono::microseconds>(inlineEnd - start).count();
+    double asyncUs = std::chrono::duration_cast<std::chrono::microseconds>(asyncEnd - asyncStart).count();
+    LOGD("AsyncDecoder benchmark: %d packets, decode %d ms: inline %.1f us/packet, submit %.1f us/packet",
+         numPackets, decodeMs, inlineUs / numPackets, asyncUs / numPackets);
+}
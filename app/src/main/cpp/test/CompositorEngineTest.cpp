@@ -0,0 +1,480 @@
+#include "CompositorEngine.h"
+#include "image_kernels.h"
+#include "log4c.h"
+#include "rga.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+const uint32_t kBackground = 0xFF102030;
+
+// RGBA frame with random pixels; the bytes past each row (stride padding) are 0xEE
+std::shared_ptr<frame_data_t> makeFrame(int width, int height, unsigned seed, int padding = 16) {
+    auto frameData = std::make_shared<frame_data_t>();
+    frameData->screenW = width;
+    frameData->screenH = height;
+    frameData->widthStride = width;
+    frameData->heightStride = height;
+    frameData->screenStride = width * 4 + padding;
+    frameData->frameFormat = RK_FORMAT_RGBA_8888;
+    frameData->dataSize = (long) frameData->screenStride * height;
+    frameData->data.reset(new char[frameData->dataSize]);
+    memset(frameData->data.get(), 0xEE, frameData->dataSize);
+    srand(seed);
+    for (int y = 0; y < height; y++) {
+        uint8_t* row = reinterpret_cast<uint8_t*>(frameData->data.get()) + y * frameData->screenStride;
+        for (int x = 0; x < width * 4; x++) {
+            row[x] = (uint8_t) (rand() & 0xFF);
+        }
+    }
+    return frameData;
+}
+
+const uint8_t* pixelOf(const frame_data_t& frame, int x, int y) {
+    return reinterpret_cast<const uint8_t*>(frame.data.get()) + y * frame.screenStride + x * 4;
+}
+
+// Float bilinear reference with the kernel's pixel-centre alignment
+float referenceSample(const frame_data_t& frame, int dstW, int dstH, int dx, int dy, int channel) {
+    float fx = std::max((dx + 0.5f) * frame.screenW / dstW - 0.5f, 0.0f);
+    float fy = std::max((dy + 0.5f) * frame.screenH / dstH - 0.5f, 0.0f);
+    int x0 = std::min((int) fx, frame.screenW - 1);
+    int y0 = std::min((int) fy, frame.screenH - 1);
+    int x1 = std::min(x0 + 1, frame.screenW - 1);
+    int y1 = std::min(y0 + 1, frame.screenH - 1);
+    float ax = fx - x0, ay = fy - y0;
+    float top = pixelOf(frame, x0, y0)[channel] * (1 - ax) + pixelOf(frame, x1, y0)[channel] * ax;
+    float bottom = pixelOf(frame, x0, y1)[channel] * (1 - ax) + pixelOf(frame, x1, y1)[channel] * ax;
+    return top * (1 - ay) + bottom * ay;
+}
+
+std::vector<uint8_t> scaleImage(const frame_data_t& frame, int dstW, int dstH, scale_filter_e filter,
+                                image_kernel_impl_e impl, int band = 0) {
+    image_scale_map_s map = image_scale_map_s();
+    image_scale_map_init(map, frame.screenW, frame.screenH, dstW, dstH, 4, filter);
+    std::vector<uint8_t> out(dstW * dstH * 4, 0xAB);
+    band = band > 0 ? band : dstH;
+    for (int row = 0; row < dstH; row += band) {
+        image_scale_rows(map, reinterpret_cast<const uint8_t*>(frame.data.get()), frame.screenStride, out.data(),
+                         dstW * 4, row, std::min(row + band, dstH), impl);
+    }
+    return out;
+}
+
+CompositorEngine::Layer makeLayer(int id, int x, int y, int width, int height,
+                                  const std::shared_ptr<frame_data_t>& frame, uint64_t sequence) {
+    CompositorEngine::Layer layer;
+    layer.id = id;
+    layer.x = x;
+    layer.y = y;
+    layer.width = width;
+    layer.height = height;
+    layer.frame = frame;
+    layer.sequence = sequence;
+    return layer;
+}
+
+// Grid of cols x cols viewports over width x height, one frame per viewport
+std::vector<CompositorEngine::Layer> gridLayers(int cols, int width, int height,
+                                                const std::vector<std::shared_ptr<frame_data_t>>& frames,
+                                                const std::vector<uint64_t>& sequences) {
+    std::vector<CompositorEngine::Layer> layers;
+    int cellW = width / cols, cellH = height / cols;
+    for (int i = 0; i < cols * cols; i++) {
+        layers.push_back(makeLayer(i, (i % cols) * cellW, (i / cols) * cellH, cellW, cellH,
+                                   frames[i % frames.size()], sequences[i]));
+    }
+    return layers;
+}
+
+CompositorEngine::Config smallConfig(int workers) {
+    CompositorEngine::Config config;
+    config.width = 96;
+    config.height = 64;
+    config.backgroundColor = kBackground;
+    config.workerThreads = workers;
+    config.tileRows = 8;
+    config.maxCanvases = 3;
+    return config;
+}
+
+bool sameBytes(const uint8_t* a, const uint8_t* b, size_t size) {
+    return memcmp(a, b, size) == 0;
+}
+
+}  // namespace
+
+/**
+ * Test class for the RGBA scale kernels and the unified-frame compositor engine
+ */
+class CompositorEngineTest {
+public:
+    bool testNearestScale() {
+        LOGD("=== Testing nearest scale ===");
+
+        // Integer downscales take the strided paths, the others the table gather
+        const int sizes[][4] = {{64, 36, 32, 18}, {63, 35, 21, 12}, {64, 36, 16, 9}, {50, 30, 37, 41},
+                                {17, 9, 17, 9}, {40, 20, 13, 7}};
+        for (const auto& size : sizes) {
+            auto frame = makeFrame(size[0], size[1], 7);
+            int dstW = size[2], dstH = size[3];
+            std::vector<uint8_t> simd = scaleImage(*frame, dstW, dstH, SCALE_FILTER_NEAREST, IMAGE_KERNEL_IMPL_AUTO);
+            std::vector<uint8_t> scalar =
+                    scaleImage(*frame, dstW, dstH, SCALE_FILTER_NEAREST, IMAGE_KERNEL_IMPL_SCALAR, 5);
+            for (int y = 0; y < dstH; y++) {
+                for (int x = 0; x < dstW; x++) {
+                    int sx = std::min((2 * x + 1) * size[0] / (2 * dstW), size[0] - 1);
+                    int sy = std::min((2 * y + 1) * size[1] / (2 * dstH), size[1] - 1);
+                    if (!sameBytes(&simd[(y * dstW + x) * 4], pixelOf(*frame, sx, sy), 4) ||
+                        !sameBytes(&scalar[(y * dstW + x) * 4], pixelOf(*frame, sx, sy), 4)) {
+                        LOGE("Nearest %dx%d -> %dx%d: pixel (%d,%d) is not source (%d,%d)", size[0], size[1], dstW,
+                             dstH, x, y, sx, sy);
+                        return false;
+                    }
+                }
+            }
+        }
+
+        LOGD("Nearest scale test passed (%s)", image_kernels_simd_name());
+        return true;
+    }
+
+    bool testBilinearScale() {
+        LOGD("=== Testing bilinear scale ===");
+
+        const int sizes[][4] = {{64, 36, 32, 18}, {63, 35, 21, 12}, {30, 20, 71, 45}, {97, 51, 40, 33}, {8, 8, 8, 8}};
+        for (const auto& size : sizes) {
+            auto frame = makeFrame(size[0], size[1], 11);
+            int dstW = size[2], dstH = size[3];
+            std::vector<uint8_t> simd = scaleImage(*frame, dstW, dstH, SCALE_FILTER_BILINEAR, IMAGE_KERNEL_IMPL_AUTO);
+            std::vector<uint8_t> scalar =
+                    scaleImage(*frame, dstW, dstH, SCALE_FILTER_BILINEAR, IMAGE_KERNEL_IMPL_SCALAR);
+            std::vector<uint8_t> banded =
+                    scaleImage(*frame, dstW, dstH, SCALE_FILTER_BILINEAR, IMAGE_KERNEL_IMPL_AUTO, 3);
+            if (simd != scalar || simd != banded) {
+                LOGE("Bilinear %dx%d -> %dx%d: SIMD, scalar and banded outputs differ", size[0], size[1], dstW, dstH);
+                return false;
+            }
+            float maxError = 0.0f;
+            for (int y = 0; y < dstH; y++) {
+                for (int x = 0; x < dstW; x++) {
+                    for (int c = 0; c < 4; c++) {
+                        float expected = referenceSample(*frame, dstW, dstH, x, y, c);
+                        float error = std::fabs(simd[(y * dstW + x) * 4 + c] - expected);
+                        maxError = std::max(maxError, error);
+                    }
+                }
+            }
+            if (maxError > 1.5f) {
+                LOGE("Bilinear %dx%d -> %dx%d: max error %.2f vs float reference", size[0], size[1], dstW, dstH,
+                     maxError);
+                return false;
+            }
+        }
+
+        LOGD("Bilinear scale test passed (%s)", image_kernels_simd_name());
+        return true;
+    }
+
+    bool testDirtyRegions() {
+        LOGD("=== Testing dirty-region redraw ===");
+
+        CompositorEngine engine(smallConfig(2));
+        CompositorEngine reference(smallConfig(0));
+        std::vector<std::shared_ptr<frame_data_t>> frames = {makeFrame(64, 48, 1), makeFrame(40, 30, 2),
+                                                             makeFrame(48, 32, 3), makeFrame(33, 17, 4)};
+        std::vector<uint64_t> sequences = {1, 1, 1, 1};
+        size_t size = 96 * 64 * 4;
+
+        engine.compose(gridLayers(2, 96, 64, frames, sequences));
+        CompositorEngine::Stats stats = engine.getStats();
+        if (stats.fullRedraws != 1 || stats.layersDrawn != 4) {
+            LOGE("First compose: %llu full redraws, %llu layers drawn", (unsigned long long) stats.fullRedraws,
+                 (unsigned long long) stats.layersDrawn);
+            return false;
+        }
+
+        // Channel 2 gets a new frame: only its viewport is redrawn into the reused canvas
+        frames[2] = makeFrame(48, 32, 5);
+        sequences[2]++;
+        std::shared_ptr<uint8_t> canvas = engine.compose(gridLayers(2, 96, 64, frames, sequences));
+        stats = engine.getStats();
+        if (!canvas || stats.fullRedraws != 1 || stats.layersDrawn != 5 || stats.layersReused != 3) {
+            LOGE("Second compose: %llu full redraws, %llu drawn, %llu reused", (unsigned long long) stats.fullRedraws,
+                 (unsigned long long) stats.layersDrawn, (unsigned long long) stats.layersReused);
+            return false;
+        }
+        std::shared_ptr<uint8_t> expected = reference.compose(gridLayers(2, 96, 64, frames, sequences));
+        if (!sameBytes(canvas.get(), expected.get(), size)) {
+            LOGE("Partially redrawn canvas differs from a full redraw");
+            return false;
+        }
+
+        // While the consumer holds that canvas the next compose uses another one and brings it up to date
+        frames[0] = makeFrame(64, 48, 6);
+        sequences[0]++;
+        std::vector<uint8_t> held(canvas.get(), canvas.get() + size);
+        std::shared_ptr<uint8_t> next = engine.compose(gridLayers(2, 96, 64, frames, sequences));
+        expected = reference.compose(gridLayers(2, 96, 64, frames, sequences));
+        if (!next || next.get() == canvas.get() || !sameBytes(next.get(), expected.get(), size) ||
+            !sameBytes(canvas.get(), held.data(), size)) {
+            LOGE("Compose into a second canvas is wrong or touched the held canvas");
+            return false;
+        }
+
+        LOGD("Dirty-region test passed");
+        return true;
+    }
+
+    bool testLayoutChange() {
+        LOGD("=== Testing layout change ===");
+
+        CompositorEngine engine(smallConfig(2));
+        std::vector<std::shared_ptr<frame_data_t>> frames = {makeFrame(64, 48, 1)};
+        std::vector<uint64_t> sequences(9, 1);
+        engine.compose(gridLayers(3, 96, 64, frames, sequences));
+
+        // QUAD over the NINE canvas: background refilled, then every viewport redrawn
+        std::shared_ptr<uint8_t> canvas = engine.compose(gridLayers(2, 96, 64, frames, sequences));
+        CompositorEngine reference(smallConfig(0));
+        std::shared_ptr<uint8_t> expected = reference.compose(gridLayers(2, 96, 64, frames, sequences));
+        CompositorEngine::Stats stats = engine.getStats();
+        if (stats.fullRedraws != 2 || !sameBytes(canvas.get(), expected.get(), 96 * 64 * 4)) {
+            LOGE("Layout change: %llu full redraws, canvas matches full redraw: %d",
+                 (unsigned long long) stats.fullRedraws, sameBytes(canvas.get(), expected.get(), 96 * 64 * 4));
+            return false;
+        }
+
+        // A viewport without a frame and an odd layout leave background around the layers
+        std::vector<CompositorEngine::Layer> layers = {makeLayer(0, 10, 5, 30, 20, frames[0], 1),
+                                                       makeLayer(1, 50, 30, 20, 20, nullptr, 0)};
+        canvas = engine.compose(layers);
+        const uint32_t* pixels = reinterpret_cast<const uint32_t*>(canvas.get());
+        if (pixels[0] != kBackground || pixels[40 * 96 + 60] != kBackground || pixels[63 * 96 + 95] != kBackground) {
+            LOGE("Background not restored after layout change");
+            return false;
+        }
+
+        LOGD("Layout change test passed");
+        return true;
+    }
+
+    bool testCanvasRing() {
+        LOGD("=== Testing canvas ring ===");
+
+        CompositorEngine engine(smallConfig(1));
+        std::vector<std::shared_ptr<frame_data_t>> frames = {makeFrame(32, 32, 1)};
+        std::vector<uint64_t> sequences(4, 1);
+        std::vector<std::shared_ptr<uint8_t>> held;
+        for (int i = 0; i < 3; i++) {
+            held.push_back(engine.compose(gridLayers(2, 96, 64, frames, sequences)));
+        }
+        if (!held[0] || !held[1] || !held[2] || engine.compose(gridLayers(2, 96, 64, frames, sequences))) {
+            LOGE("Ring of 3 should hand out 3 canvases and then refuse");
+            return false;
+        }
+        held[1].reset();
+        std::shared_ptr<uint8_t> reused = engine.compose(gridLayers(2, 96, 64, frames, sequences));
+        if (!reused || engine.getStats().noCanvas != 1) {
+            LOGE("Released canvas was not reused");
+            return false;
+        }
+
+        // Canvases handed out stay valid after the engine is reconfigured or destroyed
+        engine.configure(smallConfig(0));
+        held.push_back(engine.compose(gridLayers(2, 96, 64, frames, sequences)));
+        {
+            CompositorEngine shortLived(smallConfig(1));
+            held.push_back(shortLived.compose(gridLayers(2, 96, 64, frames, sequences)));
+        }
+        held.clear();
+        reused.reset();
+
+        LOGD("Canvas ring test passed");
+        return true;
+    }
+
+    bool testOverlappingLayers() {
+        LOGD("=== Testing overlapping layers ===");
+
+        CompositorEngine engine(smallConfig(2));
+        CompositorEngine reference(smallConfig(0));
+        auto below = makeFrame(40, 40, 1);
+        auto above = makeFrame(20, 20, 2);
+        std::vector<CompositorEngine::Layer> layers = {makeLayer(0, 0, 0, 80, 60, below, 1),
+                                                       makeLayer(1, 30, 20, 40, 30, above, 1)};
+        engine.compose(layers);
+
+        // New frame for the lower layer only: the upper one must still be on top
+        layers[0].frame = makeFrame(40, 40, 3);
+        layers[0].sequence = 2;
+        std::shared_ptr<uint8_t> canvas = engine.compose(layers);
+        std::shared_ptr<uint8_t> expected = reference.compose(layers);
+        if (!sameBytes(canvas.get(), expected.get(), 96 * 64 * 4)) {
+            LOGE("Overlapping layers drawn out of order");
+            return false;
+        }
+
+        LOGD("Overlapping layers test passed");
+        return true;
+    }
+
+    bool testParallelMatchesSerial() {
+        LOGD("=== Testing parallel tiles ===");
+
+        CompositorEngine::Config config = smallConfig(3);
+        config.width = 320;
+        config.height = 180;
+        config.tileRows = 7;
+        CompositorEngine parallel(config);
+        config.workerThreads = 0;
+        CompositorEngine serial(config);
+        std::vector<std::shared_ptr<frame_data_t>> frames;
+        for (unsigned i = 0; i < 16; i++) {
+            frames.push_back(makeFrame(160 + (int) i * 7, 90 + (int) i * 3, i));
+        }
+        std::vector<uint64_t> sequences(16, 1);
+        for (int round = 0; round < 20; round++) {
+            sequences[round % 16]++;
+            frames[round % 16] = makeFrame(160, 90, 100 + round);
+            std::shared_ptr<uint8_t> a = parallel.compose(gridLayers(4, 320, 180, frames, sequences));
+            std::shared_ptr<uint8_t> b = serial.compose(gridLayers(4, 320, 180, frames, sequences));
+            if (!a || !b || !sameBytes(a.get(), b.get(), 320 * 180 * 4)) {
+                LOGE("Round %d: parallel and serial composition differ", round);
+                return false;
+            }
+        }
+
+        LOGD("Parallel tiles test passed");
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting Compositor Engine Tests");
+
+        int passedTests = 0;
+        int totalTests = 0;
+
+        totalTests++; if (testNearestScale()) passedTests++;
+        totalTests++; if (testBilinearScale()) passedTests++;
+        totalTests++; if (testDirtyRegions()) passedTests++;
+        totalTests++; if (testLayoutChange()) passedTests++;
+        totalTests++; if (testCanvasRing()) passedTests++;
+        totalTests++; if (testOverlappingLayers()) passedTests++;
+        totalTests++; if (testParallelMatchesSerial()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+extern "C" void runCompositorEngineTests() {
+    CompositorEngineTest test;
+    test.runAllTests();
+}
+
+// Previous composeUnifiedFrame: clear the whole buffer, then a float per-pixel nearest loop per viewport
+static void legacyCompose(const std::vector<CompositorEngine::Layer>& layers, uint8_t* buffer, int width,
+                          int height) {
+    uint32_t* pixels = reinterpret_cast<uint32_t*>(buffer);
+    for (int i = 0; i < width * height; i++) {
+        pixels[i] = kBackground;
+    }
+    for (const CompositorEngine::Layer& layer : layers) {
+        const frame_data_t* src = layer.frame.get();
+        uint8_t* srcData = reinterpret_cast<uint8_t*>(src->data.get());
+        float xRatio = static_cast<float>(src->screenW) / layer.width;
+        float yRatio = static_cast<float>(src->screenH) / layer.height;
+        uint8_t* dstPtr = buffer + (layer.y * width + layer.x) * 4;
+        for (int y = 0; y < layer.height; y++) {
+            for (int x = 0; x < layer.width; x++) {
+                int srcX = std::min(static_cast<int>(x * xRatio), src->screenW - 1);
+                int srcY = std::min(static_cast<int>(y * yRatio), src->screenH - 1);
+                uint8_t* srcPixel = srcData + (srcY * src->screenW + srcX) * 4;
+                uint8_t* dstPixel = dstPtr + (y * width + x) * 4;
+                dstPixel[0] = srcPixel[0];
+                dstPixel[1] = srcPixel[1];
+                dstPixel[2] = srcPixel[2];
+                dstPixel[3] = srcPixel[3];
+            }
+        }
+    }
+}
+
+// Average ms per compose; newPerCompose channels get a new frame before each compose (0 = all of them)
+static double timeEngine(CompositorEngine& engine, int cols, const std::vector<std::shared_ptr<frame_data_t>>& frames,
+                         int newPerCompose, int iterations) {
+    std::vector<uint64_t> sequences(cols * cols, 0);
+    engine.compose(gridLayers(cols, 1920, 1080, frames, sequences));
+    int next = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        int updates = newPerCompose > 0 ? newPerCompose : cols * cols;
+        for (int k = 0; k < updates; k++) {
+            sequences[next]++;
+            next = (next + 1) % (cols * cols);
+        }
+        engine.compose(gridLayers(cols, 1920, 1080, frames, sequences));
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+/**
+ * Benchmark: 1080p unified frame from 1080p RGBA channel frames at QUAD, NINE
+ * and SIXTEEN. Legacy is the previous composeUnifiedFrame (full clear plus a
+ * float per-pixel nearest loop). The engine is measured single-threaded with
+ * both filters, with workers, and in steady state where one channel delivers a
+ * new frame per compose (the other viewports are reused from the canvas).
+ */
+extern "C" void runCompositorBenchmark(int workerThreads) {
+    LOGD("=== Compositor Benchmark (%s, %d workers) ===", image_kernels_simd_name(), workerThreads);
+
+    const int iterations = 20;
+    std::vector<std::shared_ptr<frame_data_t>> frames;
+    for (unsigned i = 0; i < 4; i++) {
+        frames.push_back(makeFrame(1920, 1080, i, 0));
+    }
+    std::vector<uint8_t> legacyBuffer(1920 * 1080 * 4);
+
+    const int layouts[] = {2, 3, 4};
+    for (int cols : layouts) {
+        std::vector<uint64_t> sequences(cols * cols, 0);
+        std::vector<CompositorEngine::Layer> layers = gridLayers(cols, 1920, 1080, frames, sequences);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            legacyCompose(layers, legacyBuffer.data(), 1920, 1080);
+        }
+        double legacy = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() /
+                        iterations;
+
+        CompositorEngine::Config config;
+        config.backgroundColor = kBackground;
+        config.workerThreads = 0;
+        config.filter = SCALE_FILTER_NEAREST;
+        CompositorEngine nearest(config);
+        double nearestMs = timeEngine(nearest, cols, frames, 0, iterations);
+        config.filter = SCALE_FILTER_BILINEAR;
+        CompositorEngine bilinear(config);
+        double bilinearMs = timeEngine(bilinear, cols, frames, 0, iterations);
+        config.workerThreads = workerThreads;
+        CompositorEngine parallel(config);
+        double parallelMs = timeEngine(parallel, cols, frames, 0, iterations);
+        double steadyMs = timeEngine(parallel, cols, frames, 1, iterations);
+
+        LOGD("%2d channels: legacy %.2f ms | nearest %.2f ms | bilinear %.2f ms | bilinear x%d %.2f ms | "
+             "1 new frame/compose %.2f ms",
+             cols * cols, legacy, nearestMs, bilinearMs, workerThreads + 1, parallelMs, steadyMs);
+    }
+}
@@ -0,0 +1,374 @@
+#include "cpu_engine.h"
+#include "engine_registry.h"
+#include "detect_head.h"
+#include "yolov5_thread_pool.h"
+#include "rga.h"
+#include "log4c.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 按引擎报告的形状分配单帧输入/输出
+struct EngineBuffers {
+    std::vector<std::vector<uint8_t> > storage;
+    std::vector<tensor_data_s> inputs;
+    std::vector<tensor_data_s> outputs;
+
+    explicit EngineBuffers(NNEngine &engine) {
+        const std::vector<tensor_attr_s> &in = engine.GetInputShapes();
+        const std::vector<tensor_attr_s> &out = engine.GetOutputShapes();
+        int batch = engine.GetMaxBatchSize();
+        storage.resize(in.size() + out.size());
+        for (size_t i = 0; i < in.size() + out.size(); i++) {
+            tensor_data_s tensor;
+            tensor.attr = i < in.size() ? in[i] : out[i - in.size()];
+            tensor.attr.dims[0] = 1;
+            tensor.attr.n_elems /= batch;
+            tensor.attr.size /= batch;
+            storage[i].assign(tensor.attr.size, 0);
+            tensor.data = storage[i].data();
+            (i < in.size() ? inputs : outputs).push_back(tensor);
+        }
+    }
+};
+
+cpu_engine_object_s makeObject(int classId, float cx, float cy, float w, float h, float score, float vx = 0.f,
+                               float vy = 0.f) {
+    cpu_engine_object_s obj;
+    obj.class_id = classId;
+    obj.cx = cx;
+    obj.cy = cy;
+    obj.w = w;
+    obj.h = h;
+    obj.score = score;
+    obj.vx = vx;
+    obj.vy = vy;
+    return obj;
+}
+
+// 运行一帧并按YOLOv5后处理解码（模型输入坐标）
+bool runAndDecode(CPUEngine &engine, EngineBuffers &buffers, yolov5::detect_result_group_t &group) {
+    if (engine.Run(buffers.inputs, buffers.outputs, false) != NN_SUCCESS) {
+        LOGE("CPUEngine::Run failed");
+        return false;
+    }
+    std::vector<tensor_attr_s> attrs;
+    for (const tensor_data_s &tensor : buffers.outputs) {
+        attrs.push_back(tensor.attr);
+    }
+    int size = engine.GetConfig().input_size;
+    std::unique_ptr<DetectHead> head;
+    if (create_detect_head(attrs, size, size, head) != NN_SUCCESS) {
+        LOGE("CPUEngine outputs are not a YOLOv5 head");
+        return false;
+    }
+    yolov5::decode_workspace_t ws;
+    head->Decode(buffers.outputs, BOX_THRESH, &ws);
+    yolov5::collect_detections(&ws, nms_default_config(), size, size, 1.f, 1.f, nullptr, &group);
+    return true;
+}
+
+// int8输出的框宽高量化误差约为2.5%，float输出只有取整误差
+float boxTolerance(const CPUEngine &engine, float extent) {
+    return engine.GetConfig().output_type == NN_TENSOR_INT8 ? 2.f + 0.03f * extent : 1.f;
+}
+
+// 在group中找与obj类别相同、框误差在容差内的结果
+bool findObject(const CPUEngine &engine, const yolov5::detect_result_group_t &group, const cpu_engine_object_s &obj,
+                float cx, float cy) {
+    const float tw = boxTolerance(engine, obj.w), th = boxTolerance(engine, obj.h);
+    for (int i = 0; i < group.count; i++) {
+        const yolov5::BOX_RECT &box = group.results[i].box;
+        if (group.results[i].id == obj.class_id && std::fabs(box.left - (cx - obj.w / 2)) <= tw &&
+            std::fabs(box.right - (cx + obj.w / 2)) <= tw && std::fabs(box.top - (cy - obj.h / 2)) <= th &&
+            std::fabs(box.bottom - (cy + obj.h / 2)) <= th &&
+            std::fabs(group.results[i].prop - obj.score) <= 0.02f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<frame_data_t> makeFrame(int frameId, int width, int height) {
+    auto frameData = std::make_shared<frame_data_t>();
+    frameData->frameId = frameId;
+    frameData->screenW = width;
+    frameData->screenH = height;
+    frameData->widthStride = width;
+    frameData->heightStride = height;
+    frameData->screenStride = width * 4;
+    frameData->frameFormat = RK_FORMAT_RGBA_8888;
+    frameData->dataSize = width * height * 4;
+    frameData->data.reset(new char[frameData->dataSize]());
+    return frameData;
+}
+
+const char kPipelineConfig[] =
+        "cpu-engine\n"
+        "# 640输入，每次推理3ms\n"
+        "input_size=640\n"
+        "latency_us=3000\n"
+        "object=0,320,240,100,200,0.9\n"
+        "object=2,100,500,60,40,0.7\n";
+
+}  // namespace
+
+/**
+ * Tests for the engine registry and the CPU reference engine: registry
+ * lookup and default switching, text config parsing, synthetic objects
+ * decoded back by the YOLOv5 post-processing, per-frame motion, and the
+ * whole Yolov5ThreadPool pipeline running on the CPU engine.
+ */
+class CpuEngineTest {
+public:
+    bool testRegistry() {
+        LOGD("=== Testing engine registry ===");
+
+        std::vector<std::string> names = ListNNEngines();
+        bool hasCpu = false, hasRknn = false;
+        for (const std::string &name : names) {
+            hasCpu |= name == "cpu";
+            hasRknn |= name == "rknn";
+        }
+        if (!hasCpu || !hasRknn) {
+            LOGE("Built-in engines are not registered");
+            return false;
+        }
+        if (CreateNNEngine("no-such-engine") != nullptr || SetDefaultNNEngine("no-such-engine")) {
+            LOGE("Unknown engine name was accepted");
+            return false;
+        }
+
+        int created = 0;
+        RegisterNNEngine("test-engine", [&created] {
+            created++;
+            return CreateCPUEngine();
+        });
+        std::string previous = GetDefaultNNEngine();
+        bool ok = SetDefaultNNEngine("test-engine") && CreateDefaultNNEngine() != nullptr && created == 1 &&
+                  GetDefaultNNEngine() == "test-engine";
+        SetDefaultNNEngine("cpu");
+        ok = ok && dynamic_cast<CPUEngine *>(CreateDefaultNNEngine().get()) != nullptr;
+        SetDefaultNNEngine(previous);
+        if (!ok) {
+            LOGE("Default engine switching failed");
+            return false;
+        }
+
+        LOGD("Engine registry test passed");
+        return true;
+    }
+
+    bool testConfigParsing() {
+        LOGD("=== Testing CPU engine config parsing ===");
+
+        cpu_engine_config_s config = cpu_engine_default_config();
+        const char text[] = "cpu-engine\r\ninput_size=320\nbatch=4\nclasses=3\nlatency_us=100\n"
+                            "per_item_us=20\nobject=1,10,20,30,40,0.5,2,-1\nobject=2,1,2,3,4,0.6\n";
+        if (!parse_cpu_engine_config(text, (int) strlen(text), config) || config.input_size != 320 ||
+            config.max_batch != 4 || config.num_classes != 3 || config.latency_us != 100 ||
+            config.per_item_us != 20 || config.objects.size() != 2 || config.objects[0].vy != -1.f ||
+            config.objects[1].vx != 0.f) {
+            LOGE("Failed to parse config");
+            return false;
+        }
+
+        // 不是cpu-engine配置（例如.rknn模型数据）时保留构造时的配置
+        char model[] = "RKNN\x01\x02 not a config";
+        CPUEngine engine(config);
+        engine.LoadModelData(model, (int) sizeof(model));
+        if (engine.GetConfig().input_size != 320 || engine.GetMaxBatchSize() != 4 ||
+            engine.GetOutputShapes().size() != 3 || engine.GetOutputShapes()[0].dims[1] != 3 * (5 + 3)) {
+            LOGE("Engine did not keep its config for non-config model data");
+            return false;
+        }
+
+        LOGD("Config parsing test passed");
+        return true;
+    }
+
+    bool testSyntheticDetections() {
+        LOGD("=== Testing synthetic objects through YOLOv5 post-processing ===");
+
+        cpu_engine_config_s config = cpu_engine_default_config();
+        config.objects.push_back(makeObject(0, 320, 240, 100, 200, 0.9f));
+        config.objects.push_back(makeObject(2, 100, 500, 60, 40, 0.7f));
+        config.objects.push_back(makeObject(16, 500, 100, 24, 20, 0.6f));
+        config.objects.push_back(makeObject(5, 400, 400, 400, 300, 0.8f));
+        const tensor_datatype_e types[2] = {NN_TENSOR_INT8, NN_TENSOR_FLOAT};
+        for (tensor_datatype_e type : types) {
+            config.output_type = type;
+            CPUEngine engine(config);
+            engine.LoadModelData(nullptr, 0);
+            EngineBuffers buffers(engine);
+
+            yolov5::detect_result_group_t group;
+            if (!runAndDecode(engine, buffers, group)) {
+                return false;
+            }
+            if (group.count != (int) config.objects.size()) {
+                LOGE("type %d: expected %zu detections, got %d", type, config.objects.size(), group.count);
+                return false;
+            }
+            for (const cpu_engine_object_s &obj : config.objects) {
+                if (!findObject(engine, group, obj, obj.cx, obj.cy)) {
+                    LOGE("type %d: object class %d at (%.0f, %.0f) not decoded", type, obj.class_id, obj.cx, obj.cy);
+                    return false;
+                }
+            }
+        }
+
+        LOGD("Synthetic detection test passed");
+        return true;
+    }
+
+    bool testMovingObject() {
+        LOGD("=== Testing per-frame object motion ===");
+
+        cpu_engine_config_s config = cpu_engine_default_config();
+        config.objects.push_back(makeObject(0, 500, 320, 80, 160, 0.9f, 200.f, -4.f));
+        CPUEngine engine(config);
+        engine.LoadModelData(nullptr, 0);
+        EngineBuffers buffers(engine);
+
+        for (int frame = 0; frame < 4; frame++) {
+            yolov5::detect_result_group_t group;
+            if (!runAndDecode(engine, buffers, group)) {
+                return false;
+            }
+            // 第2帧起中心超出640，回绕到左侧
+            float cx = std::fmod(500.f + 200.f * frame, 640.f), cy = 320.f - 4.f * frame;
+            if (group.count != 1 || !findObject(engine, group, config.objects[0], cx, cy)) {
+                LOGE("Frame %d: object not at (%.0f, %.0f)", frame, cx, cy);
+                return false;
+            }
+        }
+        if (engine.getRunCount() != 4 || engine.getItemCount() != 4) {
+            LOGE("Unexpected call counters %d/%d", engine.getRunCount(), engine.getItemCount());
+            return false;
+        }
+
+        LOGD("Moving object test passed");
+        return true;
+    }
+
+    bool testThreadPoolPipeline() {
+        LOGD("=== Testing Yolov5ThreadPool on the CPU engine ===");
+
+        // 通过注册表选择引擎，模型数据为cpu-engine文本配置
+        std::string previous = GetDefaultNNEngine();
+        SetDefaultNNEngine("cpu");
+        std::vector<char> model(kPipelineConfig, kPipelineConfig + sizeof(kPipelineConfig) - 1);
+        Yolov5ThreadPool pool;
+        nn_error_e ret = pool.setUpWithModelData(2, model.data(), (int) model.size());
+        SetDefaultNNEngine(previous);
+        if (ret != NN_SUCCESS) {
+            LOGE("setUpWithModelData failed: %d", ret);
+            return false;
+        }
+
+        // 640x640帧：letterbox为恒等映射，检测框即配置的框
+        const int numFrames = 20;
+        std::thread producer([&] {
+            for (int i = 0; i < numFrames; i++) {
+                pool.submitTask(makeFrame(i, 640, 640));
+            }
+        });
+        bool ok = true;
+        for (int i = 0; i < numFrames && ok; i++) {
+            std::vector<Detection> objects;
+            if (pool.getTargetResult(objects, i) != NN_SUCCESS) {
+                LOGE("Missing result for frame %d", i);
+                ok = false;
+                break;
+            }
+            bool person = false;
+            for (const Detection &det : objects) {
+                person |= det.className == "person" && std::abs(det.box.x - 270) <= 5 &&
+                          std::abs(det.box.y - 140) <= 8 && std::abs(det.box.width - 100) <= 10 &&
+                          std::abs(det.box.height - 200) <= 16;
+            }
+            if (objects.size() != 2 || !person) {
+                LOGE("Frame %d: expected person + car, got %zu detections", i, objects.size());
+                ok = false;
+            }
+        }
+        if (!ok) {
+            pool.stopAll();
+            producer.join();
+            return false;
+        }
+        producer.join();
+
+        LOGD("Thread pool pipeline test passed");
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting CPU Engine Tests");
+
+        int passedTests = 0;
+        int totalTests = 5;
+
+        if (testRegistry()) passedTests++;
+        if (testConfigParsing()) passedTests++;
+        if (testSyntheticDetections()) passedTests++;
+        if (testMovingObject()) passedTests++;
+        if (testThreadPoolPipeline()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+extern "C" void runCpuEngineTests() {
+    CpuEngineTest test;
+    test.runAllTests();
+}
+
+/**
+ * Benchmark: the full detect pipeline (letterbox, engine, decode, NMS) on
+ * the CPU engine. inferenceUs stands in for the NPU time; the remaining
+ * per-frame cost is the host-side work that a real device also pays.
+ */
+extern "C" void runCpuEngineBenchmark(int numThreads, int inferenceUs) {
+    cpu_engine_config_s config = cpu_engine_default_config();
+    config.latency_us = inferenceUs;
+    for (int i = 0; i < 8; i++) {
+        config.objects.push_back(makeObject(i % 3, 60.f + 70 * i, 100.f + 50 * i, 40.f + 10 * i, 80.f, 0.8f, 3.f));
+    }
+
+    Yolov5ThreadPool pool;
+    pool.setUpWithEngineFactory(numThreads, [&config] { return CreateCPUEngine(config); }, nullptr, 0);
+
+    const int numFrames = 300;
+    auto start = std::chrono::steady_clock::now();
+    std::thread producer([&] {
+        for (int i = 0; i < numFrames; i++) {
+            pool.submitTask(makeFrame(i, 1280, 720));
+        }
+    });
+    size_t detections = 0;
+    for (int i = 0; i < numFrames; i++) {
+        std::vector<Detection> objects;
+        pool.getTargetResult(objects, i);
+        detections += objects.size();
+    }
+    producer.join();
+    double elapsedMs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count() / 1000.0;
+
+    LOGD("=== CPU engine pipeline Benchmark (%d threads, %d us inference) ===", numThreads, inferenceUs);
+    LOGD("  %d frames in %.1f ms: %.1f fps, %.1f detections/frame", numFrames, elapsedMs,
+         numFrames * 1000.0 / elapsedMs, (double) detections / numFrames);
+}
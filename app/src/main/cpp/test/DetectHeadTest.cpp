@@ -0,0 +1,430 @@
+#include "detect_head.h"
+#include "log4c.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+const int kModelSize = 320;
+
+tensor_attr_s makeAttr(int index, int n_dims, const int *dims, tensor_datatype_e type,
+                       tensor_layout_e layout = NN_TENSOR_NCHW, int32_t zp = 0, float scale = 1.f) {
+    tensor_attr_s attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.index = index;
+    attr.n_dims = n_dims;
+    attr.n_elems = 1;
+    for (int i = 0; i < n_dims; i++) {
+        attr.dims[i] = dims[i];
+        attr.n_elems *= dims[i];
+    }
+    attr.type = type;
+    attr.layout = layout;
+    attr.zp = zp;
+    attr.scale = scale;
+    attr.size = attr.n_elems * (type == NN_TENSOR_FLOAT ? 4 : (type == NN_TENSOR_FLOAT16 ? 2 : 1));
+    return attr;
+}
+
+tensor_attr_s gridAttr(int index, int channels, int stride, tensor_datatype_e type, int32_t zp = 0,
+                       float scale = 1.f) {
+    const int dims[4] = {1, channels, kModelSize / stride, kModelSize / stride};
+    return makeAttr(index, 4, dims, type, NN_TENSOR_NCHW, zp, scale);
+}
+
+// YOLOv5: 3个分支 [1, 3*(5+C), H, W]
+std::vector<tensor_attr_s> yolov5Attrs(int numClasses, tensor_datatype_e type) {
+    std::vector<tensor_attr_s> attrs;
+    for (int b = 0; b < 3; b++) {
+        attrs.push_back(gridAttr(b, 3 * (5 + numClasses), 8 << b, type));
+    }
+    return attrs;
+}
+
+// YOLOv8 DFL：每个分支 box / cls / (score_sum)
+std::vector<tensor_attr_s> yolov8Attrs(int numClasses, int regMax, bool scoreSum, tensor_datatype_e type) {
+    std::vector<tensor_attr_s> attrs;
+    for (int b = 0; b < 3; b++) {
+        attrs.push_back(gridAttr((int) attrs.size(), 4 * regMax, 8 << b, type));
+        attrs.push_back(gridAttr((int) attrs.size(), numClasses, 8 << b, type));
+        if (scoreSum) {
+            attrs.push_back(gridAttr((int) attrs.size(), 1, 8 << b, type));
+        }
+    }
+    return attrs;
+}
+
+int totalCells() {
+    int cells = 0;
+    for (int stride = 8; stride <= 32; stride *= 2) {
+        cells += (kModelSize / stride) * (kModelSize / stride);
+    }
+    return cells;
+}
+
+// 测试数据里的数值都能被half精确表示（或只需就近舍入），只处理0与规格化数
+uint16_t floatToHalf(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    uint16_t sign = (uint16_t) ((bits >> 16) & 0x8000);
+    if ((bits & 0x7FFFFFFF) == 0) {
+        return sign;
+    }
+    int exp = (int) ((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mant = bits & 0x7FFFFF;
+    uint16_t h = (uint16_t) (sign | (exp << 10) | (mant >> 13));
+    if (mant & 0x1000) {
+        h++;
+    }
+    return h;
+}
+
+// 各输出张量的存储；tensors[i].data指向data[i]
+struct Outputs {
+    std::vector<std::vector<uint8_t> > data;
+    std::vector<tensor_data_s> tensors;
+
+    explicit Outputs(const std::vector<tensor_attr_s> &attrs) : data(attrs.size()) {
+        for (size_t i = 0; i < attrs.size(); i++) {
+            data[i].assign(attrs[i].size, 0);
+            tensor_data_s tensor;
+            tensor.attr = attrs[i];
+            tensor.data = data[i].data();
+            tensors.push_back(tensor);
+        }
+    }
+
+    template <typename T>
+    T *at(int i) { return (T *) data[i].data(); }
+};
+
+bool sameCandidates(const yolov5::decode_workspace_t &a, const yolov5::decode_workspace_t &b, const char *name) {
+    if (a.count != b.count) {
+        LOGE("%s: candidate count %d vs %d", name, a.count, b.count);
+        return false;
+    }
+    if (memcmp(a.boxes.data(), b.boxes.data(), a.count * 4 * sizeof(float)) != 0 ||
+        memcmp(a.obj_probs.data(), b.obj_probs.data(), a.count * sizeof(float)) != 0 ||
+        memcmp(a.class_ids.data(), b.class_ids.data(), a.count * sizeof(int)) != 0) {
+        LOGE("%s: candidates differ from the int8 decode", name);
+        return false;
+    }
+    return true;
+}
+
+bool decodeWith(const std::vector<tensor_attr_s> &attrs, Outputs &out, float threshold,
+                yolov5::decode_workspace_t &ws) {
+    std::unique_ptr<DetectHead> head;
+    if (create_detect_head(attrs, kModelSize, kModelSize, head) != NN_SUCCESS) {
+        LOGE("create_detect_head failed");
+        return false;
+    }
+    head->Decode(out.tensors, threshold, &ws);
+    return true;
+}
+
+}  // namespace
+
+/**
+ * Tests for detect_head: picking the decoder from the output tensor
+ * attributes, the float16/float32 YOLOv5 decoders against the int8 one,
+ * the YOLOv8 DFL and single-output decoders on hand-placed objects, and
+ * label resolution.
+ */
+class DetectHeadTest {
+public:
+    bool testHeadDetection() {
+        LOGD("=== Testing detection head selection ===");
+
+        struct Case {
+            const char *name;
+            std::vector<tensor_attr_s> attrs;
+            bool supported;
+            detect_head_type_e type;
+            int numClasses;
+        };
+        const int fused[3] = {1, 84, totalCells()};
+        const int fusedT[3] = {1, totalCells(), 84};
+        std::vector<tensor_attr_s> nhwc = yolov5Attrs(80, NN_TENSOR_INT8);
+        nhwc[1].layout = NN_TENSOR_NHWC;
+        std::vector<tensor_attr_s> mixed = yolov5Attrs(80, NN_TENSOR_INT8);
+        mixed[2].type = NN_TENSOR_FLOAT;
+        std::vector<tensor_attr_s> badGrid = yolov5Attrs(80, NN_TENSOR_INT8);
+        badGrid[0].dims[2] = 20;
+
+        std::vector<Case> cases = {
+                {"v5 int8",     yolov5Attrs(80, NN_TENSOR_INT8),                 true,  DETECT_HEAD_YOLOV5,       80},
+                {"v5 fp16",     yolov5Attrs(20, NN_TENSOR_FLOAT16),              true,  DETECT_HEAD_YOLOV5,       20},
+                {"v8 9 out",    yolov8Attrs(80, 16, true, NN_TENSOR_INT8),       true,  DETECT_HEAD_YOLOV8_DFL,   80},
+                {"v8 6 out",    yolov8Attrs(3, 16, false, NN_TENSOR_FLOAT),      true,  DETECT_HEAD_YOLOV8_DFL,   3},
+                {"fused",       {makeAttr(0, 3, fused, NN_TENSOR_FLOAT16, NN_TENSOR_OTHER)},
+                                                                                 true,  DETECT_HEAD_YOLOV8_FUSED, 80},
+                {"fused T",     {makeAttr(0, 3, fusedT, NN_TENSOR_FLOAT, NN_TENSOR_OTHER)},
+                                                                                 true,  DETECT_HEAD_YOLOV8_FUSED, 80},
+                {"uint8",       yolov5Attrs(80, NN_TENSOR_UINT8),                false, DETECT_HEAD_YOLOV5,       0},
+                {"nhwc",        nhwc,                                            false, DETECT_HEAD_YOLOV5,       0},
+                {"mixed types", mixed,                                           false, DETECT_HEAD_YOLOV5,       0},
+                {"bad grid",    badGrid,                                         false, DETECT_HEAD_YOLOV5,       0},
+                {"two outputs", {gridAttr(0, 64, 8, NN_TENSOR_INT8), gridAttr(1, 80, 8, NN_TENSOR_INT8)},
+                                                                                 false, DETECT_HEAD_YOLOV5,       0},
+        };
+        for (const Case &c : cases) {
+            std::unique_ptr<DetectHead> head;
+            nn_error_e ret = create_detect_head(c.attrs, kModelSize, kModelSize, head);
+            if (!c.supported) {
+                if (ret != NN_RKNN_OUTPUT_ATTR_ERROR || head) {
+                    LOGE("%s: expected NN_RKNN_OUTPUT_ATTR_ERROR, got %d", c.name, ret);
+                    return false;
+                }
+                continue;
+            }
+            if (ret != NN_SUCCESS || !head || head->Info().type != c.type ||
+                head->Info().num_classes != c.numClasses) {
+                LOGE("%s: detected %s with %d classes (ret %d)", c.name,
+                     head ? detect_head_name(head->Info().type) : "-", head ? head->Info().num_classes : 0, ret);
+                return false;
+            }
+        }
+
+        LOGD("Detection head selection test passed");
+        return true;
+    }
+
+    bool testYolov5FloatMatchesInt8() {
+        LOGD("=== Testing YOLOv5 float16/float32 decode against int8 ===");
+
+        const int numClasses = 80, channels = 3 * (5 + numClasses);
+        const float threshold = BOX_THRESH;
+        std::vector<tensor_attr_s> attrs8 = yolov5Attrs(numClasses, NN_TENSOR_INT8);
+        std::vector<tensor_attr_s> attrs16 = yolov5Attrs(numClasses, NN_TENSOR_FLOAT16);
+        std::vector<tensor_attr_s> attrs32 = yolov5Attrs(numClasses, NN_TENSOR_FLOAT);
+        // scale为2的负幂，反量化值在float16中精确表示
+        const int32_t zps[3] = {-17, -12, -9};
+        for (int b = 0; b < 3; b++) {
+            attrs8[b].zp = zps[b];
+            attrs8[b].scale = 0.0625f;
+        }
+        Outputs out8(attrs8), out16(attrs16), out32(attrs32);
+
+        srand(11);
+        for (int b = 0; b < 3; b++) {
+            const int32_t zp = attrs8[b].zp;
+            const float scale = attrs8[b].scale;
+            // int8路径按截断后的量化阈值比较，浮点路径按原值比较；两者只在阈值附近的量化值上不同，避开这些值
+            const float thres = -logf(1.f / threshold - 1.f) / scale + zp;
+            int8_t *q = out8.at<int8_t>(b);
+            const int gridLen = (kModelSize / (8 << b)) * (kModelSize / (8 << b));
+            for (int k = 0; k < channels * gridLen; k++) {
+                int v = -128 + rand() % 256;
+                int ch = (k / gridLen) % (5 + numClasses);
+                if (ch >= 4 && fabsf(v - thres) < 1.5f) {
+                    v = (int) thres - 3;
+                }
+                q[k] = (int8_t) v;
+                float f = ((float) q[k] - (float) zp) * scale;
+                out16.at<uint16_t>(b)[k] = floatToHalf(f);
+                out32.at<float>(b)[k] = f;
+            }
+        }
+
+        yolov5::decode_workspace_t ws8, ws16, ws32;
+        if (!decodeWith(attrs8, out8, threshold, ws8) || !decodeWith(attrs16, out16, threshold, ws16) ||
+            !decodeWith(attrs32, out32, threshold, ws32)) {
+            return false;
+        }
+        if (ws8.count == 0) {
+            LOGE("Test data produced no candidates");
+            return false;
+        }
+        if (!sameCandidates(ws8, ws32, "float32") || !sameCandidates(ws8, ws16, "float16")) {
+            return false;
+        }
+
+        LOGD("YOLOv5 float decode test passed (%d candidates)", ws8.count);
+        return true;
+    }
+
+    bool testYolov8DflSingleObject() {
+        LOGD("=== Testing YOLOv8 DFL decode ===");
+
+        const int numClasses = 80, regMax = 16;
+        // stride 16分支网格(5, 7)：类别3，到四边的距离 l=2, t=3, r=4, b=1（网格单位）
+        const int row = 5, col = 7, cls = 3;
+        const int dist[4] = {2, 3, 4, 1};
+        const float expect[4] = {(col + 0.5f - 2) * 16, (row + 0.5f - 3) * 16, (col + 0.5f + 4) * 16,
+                                 (row + 0.5f + 1) * 16};
+
+        for (int variant = 0; variant < 2; variant++) {
+            // variant 0: float32，9个输出；variant 1: int8，6个输出
+            bool scoreSum = variant == 0;
+            tensor_datatype_e type = variant == 0 ? NN_TENSOR_FLOAT : NN_TENSOR_INT8;
+            std::vector<tensor_attr_s> attrs = yolov8Attrs(numClasses, regMax, scoreSum, type);
+            int group = scoreSum ? 3 : 2;
+            for (int b = 0; b < 3 && type == NN_TENSOR_INT8; b++) {
+                attrs[b * group].scale = 0.1f;        // box logits
+                attrs[b * group + 1].zp = -128;        // 概率 [0, 1]
+                attrs[b * group + 1].scale = 1.f / 255;
+            }
+            Outputs out(attrs);
+            for (int b = 0; b < 3; b++) {
+                if (type == NN_TENSOR_INT8) {
+                    memset(out.data[b * group + 1].data(), 0x80, out.data[b * group + 1].size());
+                }
+            }
+
+            const int b = 1, gridW = kModelSize / 16, gridLen = gridW * gridW, cell = row * gridW + col;
+            for (int side = 0; side < 4; side++) {
+                int k = (side * regMax + dist[side]) * gridLen + cell;
+                if (type == NN_TENSOR_INT8) {
+                    out.at<int8_t>(b * group)[k] = 127;
+                } else {
+                    out.at<float>(b * group)[k] = 20.f;
+                }
+            }
+            if (type == NN_TENSOR_INT8) {
+                out.at<int8_t>(b * group + 1)[cls * gridLen + cell] = 102; // (102 + 128) / 255 = 0.9
+            } else {
+                out.at<float>(b * group + 1)[cls * gridLen + cell] = 0.9f;
+                out.at<float>(b * group + 2)[cell] = 0.9f;
+                // score_sum低于阈值的网格直接跳过，即使类别分数较高
+                out.at<float>(b * group + 1)[cls * gridLen + cell + 1] = 0.9f;
+                out.at<float>(b * group + 2)[cell + 1] = 0.1f;
+            }
+
+            yolov5::decode_workspace_t ws;
+            if (!decodeWith(attrs, out, BOX_THRESH, ws)) {
+                return false;
+            }
+            yolov5::detect_result_group_t group_out;
+            yolov5::collect_detections(&ws, nms_default_config(), kModelSize, kModelSize, 1.f, 1.f, nullptr,
+                                       &group_out);
+            if (group_out.count != 1 || group_out.results[0].id != cls ||
+                std::fabs(group_out.results[0].prop - 0.9f) > 0.01f) {
+                LOGE("variant %d: expected one class %d object, got %d", variant, cls, group_out.count);
+                return false;
+            }
+            const yolov5::BOX_RECT &box = group_out.results[0].box;
+            if (std::abs(box.left - (int) expect[0]) > 1 || std::abs(box.top - (int) expect[1]) > 1 ||
+                std::abs(box.right - (int) expect[2]) > 1 || std::abs(box.bottom - (int) expect[3]) > 1) {
+                LOGE("variant %d: unexpected box %d,%d,%d,%d", variant, box.left, box.top, box.right, box.bottom);
+                return false;
+            }
+        }
+
+        LOGD("YOLOv8 DFL decode test passed");
+        return true;
+    }
+
+    bool testYolov8FusedSingleObject() {
+        LOGD("=== Testing YOLOv8 single-output decode ===");
+
+        const int numClasses = 80, props = 4 + numClasses, n = totalCells();
+        const int anchor = 1234, cls = 5;
+        const float values[4] = {100.f, 120.f, 40.f, 60.f}; // cx, cy, w, h
+
+        for (int transposed = 0; transposed < 2; transposed++) {
+            // [1, 84, N] float32 与 [1, N, 84] float16
+            const int dims[3] = {1, transposed ? n : props, transposed ? props : n};
+            tensor_datatype_e type = transposed ? NN_TENSOR_FLOAT16 : NN_TENSOR_FLOAT;
+            std::vector<tensor_attr_s> attrs = {makeAttr(0, 3, dims, type, NN_TENSOR_OTHER)};
+            Outputs out(attrs);
+            for (int k = 0; k < props; k++) {
+                float v = k < 4 ? values[k] : (k == 4 + cls ? 0.8f : 0.f);
+                int idx = transposed ? anchor * props + k : k * n + anchor;
+                if (transposed) {
+                    out.at<uint16_t>(0)[idx] = floatToHalf(v);
+                } else {
+                    out.at<float>(0)[idx] = v;
+                }
+            }
+
+            yolov5::decode_workspace_t ws;
+            if (!decodeWith(attrs, out, BOX_THRESH, ws)) {
+                return false;
+            }
+            if (ws.count != 1 || ws.class_ids[0] != cls || std::fabs(ws.obj_probs[0] - 0.8f) > 0.001f ||
+                ws.boxes[0] != 80.f || ws.boxes[1] != 90.f || ws.boxes[2] != 40.f || ws.boxes[3] != 60.f) {
+                LOGE("transposed %d: unexpected candidates (%d)", transposed, ws.count);
+                return false;
+            }
+        }
+
+        LOGD("YOLOv8 single-output decode test passed");
+        return true;
+    }
+
+    bool testLabels() {
+        LOGD("=== Testing label resolution ===");
+
+        std::vector<std::string> labels;
+        if (!parse_labels_from_custom_string("version=2; labels=cat,dog,bird;input=rgb", labels) ||
+            labels.size() != 3 || labels[0] != "cat" || labels[2] != "bird") {
+            LOGE("Failed to parse labels from custom string");
+            return false;
+        }
+        if (parse_labels_from_custom_string("", labels) || parse_labels_from_custom_string("labels=", labels) ||
+            parse_labels_from_custom_string("mylabels=a,b", labels)) {
+            LOGE("Custom string without labels was accepted");
+            return false;
+        }
+
+        const char *path = "detect_head_test_labels.txt";
+        FILE *fp = fopen(path, "w");
+        if (fp == nullptr) {
+            LOGE("Cannot write %s", path);
+            return false;
+        }
+        fputs("helmet\r\nno helmet\nvest\n\n", fp);
+        fclose(fp);
+        bool loaded = load_labels_file(path, labels);
+        remove(path);
+        if (!loaded || labels.size() != 3 || labels[1] != "no helmet" || labels[2] != "vest") {
+            LOGE("Failed to load labels file");
+            return false;
+        }
+        if (load_labels_file("detect_head_test_missing.txt", labels)) {
+            LOGE("Missing labels file was accepted");
+            return false;
+        }
+
+        std::vector<std::string> coco = default_labels(80);
+        std::vector<std::string> other = default_labels(3);
+        if (coco.size() != 80 || coco[0] != "person" || other.size() != 3 || other[2] != "class_2") {
+            LOGE("Unexpected default labels");
+            return false;
+        }
+
+        LOGD("Label resolution test passed");
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting Detect Head Tests");
+
+        int passedTests = 0;
+        int totalTests = 5;
+
+        if (testHeadDetection()) passedTests++;
+        if (testYolov5FloatMatchesInt8()) passedTests++;
+        if (testYolov8DflSingleObject()) passedTests++;
+        if (testYolov8FusedSingleObject()) passedTests++;
+        if (testLabels()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+extern "C" void runDetectHeadTests() {
+    DetectHeadTest test;
+    test.runAllTests();
+}
@@ -0,0 +1,275 @@
+#include "FrameBufferPool.h"
+#include "ThreadSafeResourceManager.h"
+#include "user_comm.h"
+#include "log4c.h"
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int kWidth = 1920;
+const int kHeight = 1088;
+const size_t kFrameBytes = (size_t) kWidth * kHeight * 4;
+
+FrameBufferKey rgbaKey(int width, int height) {
+    return FrameBufferKey(width, height, 0 /* RGBA_8888 */, width * 4);
+}
+
+}  // namespace
+
+/**
+ * Tests for FrameBufferPool: buffer recycling per key, the byte and per-key
+ * caps, recycled frame_data_t objects, release from other threads, and the
+ * stats reported through ThreadSafeResourceManager's memory-pool API.
+ */
+class FrameBufferPoolTest {
+public:
+    bool testBufferRecycling() {
+        LOGD("=== Testing buffer recycling ===");
+
+        auto pool = FrameBufferPool::create();
+        char* first;
+        {
+            FrameBuffer buffer = pool->acquire(rgbaKey(kWidth, kHeight), kFrameBytes);
+            first = buffer.get();
+            memset(buffer.get(), 0x5a, kFrameBytes);
+        }
+        FrameBuffer again = pool->acquire(rgbaKey(kWidth, kHeight), kFrameBytes);
+        FrameBuffer other = pool->acquire(rgbaKey(1280, 720), 1280 * 720 * 4);
+
+        FrameBufferPool::Stats stats = pool->getStats();
+        if (again.get() != first || other.get() == first) {
+            LOGE("Released buffer was not reused for the same key only");
+            return false;
+        }
+        if (stats.hits != 1 || stats.misses != 2 || stats.buffersInUse != 2 || stats.buffersCached != 0 ||
+            stats.bytesResident != kFrameBytes + 1280 * 720 * 4) {
+            LOGE("Unexpected stats: hits %llu misses %llu in use %zu resident %zu", (unsigned long long) stats.hits,
+                 (unsigned long long) stats.misses, stats.buffersInUse, stats.bytesResident);
+            return false;
+        }
+
+        LOGD("Buffer recycling test PASSED");
+        return true;
+    }
+
+    bool testCacheLimits() {
+        LOGD("=== Testing cache limits and high-water mark ===");
+
+        // 每个key最多缓存2个，总共最多3帧
+        auto pool = FrameBufferPool::create(3 * kFrameBytes, 2);
+        {
+            std::vector<FrameBuffer> buffers;
+            for (int i = 0; i < 4; i++) {
+                buffers.push_back(pool->acquire(rgbaKey(kWidth, kHeight), kFrameBytes));
+            }
+        }
+        FrameBufferPool::Stats stats = pool->getStats();
+        if (stats.highWaterBuffers != 4 || stats.highWaterBytes != 4 * kFrameBytes || stats.buffersCached != 2 ||
+            stats.bytesResident != 2 * kFrameBytes) {
+            LOGE("Per-key cap: high water %zu, cached %zu", stats.highWaterBuffers, stats.buffersCached);
+            return false;
+        }
+
+        // 换分辨率后，旧key的空闲缓冲在超出字节上限时先被淘汰
+        {
+            std::vector<FrameBuffer> buffers;
+            for (int i = 0; i < 2; i++) {
+                buffers.push_back(pool->acquire(rgbaKey(kWidth * 2, kHeight), 2 * kFrameBytes));
+            }
+        }
+        stats = pool->getStats();
+        if (stats.buffersCached != 1 || stats.bytesResident != 2 * kFrameBytes) {
+            LOGE("Byte cap: cached %zu buffers, %zu bytes", stats.buffersCached, stats.bytesResident);
+            return false;
+        }
+
+        pool->trim();
+        if (pool->getStats().bytesResident != 0) {
+            LOGE("trim() left buffers cached");
+            return false;
+        }
+
+        LOGD("Cache limits test PASSED");
+        return true;
+    }
+
+    bool testFrameObjects() {
+        LOGD("=== Testing pooled frame_data_t ===");
+
+        auto pool = FrameBufferPool::create();
+        frame_data_t* first;
+        {
+            std::shared_ptr<frame_data_t> frame = pool->acquireFrame();
+            first = frame.get();
+            frame->frameId = 42;
+            frame->dataSize = kFrameBytes;
+            frame->data = pool->acquire(rgbaKey(kWidth, kHeight), kFrameBytes);
+            frame->detections.resize(3);
+            frame->hasDetections = true;
+            if (pool->getStats().buffersInUse != 1) {
+                LOGE("Frame buffer not counted in use");
+                return false;
+            }
+        }
+
+        FrameBufferPool::Stats stats = pool->getStats();
+        if (stats.buffersInUse != 0 || stats.buffersCached != 1 || stats.framesCached != 1) {
+            LOGE("Dropping the frame did not return its buffer and object");
+            return false;
+        }
+
+        std::shared_ptr<frame_data_t> frame = pool->acquireFrame();
+        if (frame.get() != first || frame->frameId != 0 || frame->dataSize != 0 || frame->data ||
+            !frame->detections.empty() || frame->hasDetections) {
+            LOGE("Recycled frame was not reset");
+            return false;
+        }
+
+        // 非池化缓冲仍可直接赋值，释放时delete[]
+        frame->data.reset(new char[16]);
+        frame.reset();
+        if (pool->getStats().buffersCached != 1) {
+            LOGE("Plain buffer was put into the pool");
+            return false;
+        }
+
+        LOGD("Pooled frame test PASSED");
+        return true;
+    }
+
+    bool testCrossThreadRelease() {
+        LOGD("=== Testing release from worker threads ===");
+
+        auto pool = FrameBufferPool::create();
+        const int numFrames = 200;
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; t++) {
+            workers.emplace_back([pool, t] {
+                for (int i = 0; i < numFrames; i++) {
+                    std::shared_ptr<frame_data_t> frame = pool->acquireFrame();
+                    frame->frameId = t * numFrames + i;
+                    frame->data = pool->acquire(rgbaKey(640, 480), 640 * 480 * 4);
+                    // 交给另一线程释放，模拟推理线程持有最后一个引用
+                    std::thread([](std::shared_ptr<frame_data_t> last) { last->data.get()[0] = 1; },
+                                std::move(frame)).join();
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        FrameBufferPool::Stats stats = pool->getStats();
+        if (stats.buffersInUse != 0 || stats.hits + stats.misses != 4 * numFrames || stats.highWaterBuffers > 4 ||
+            stats.hitRate < 0.9f) {
+            LOGE("After %d frames: in use %zu, high water %zu, hit rate %.2f", 4 * numFrames, stats.buffersInUse,
+                 stats.highWaterBuffers, stats.hitRate);
+            return false;
+        }
+
+        LOGD("Cross-thread release test PASSED (hit rate %.3f)", stats.hitRate);
+        return true;
+    }
+
+    bool testResourceManagerStats() {
+        LOGD("=== Testing stats through ThreadSafeResourceManager ===");
+
+        ThreadSafeResourceManager manager;
+        auto pool = FrameBufferPool::create();
+        if (!pool->attachTo(manager) || pool->attachTo(manager)) {
+            LOGE("attachTo should succeed once per resource type");
+            return false;
+        }
+        {
+            FrameBuffer a = pool->acquire(rgbaKey(kWidth, kHeight), kFrameBytes);
+            FrameBuffer b = pool->acquire(rgbaKey(kWidth, kHeight), kFrameBytes);
+        }
+        FrameBuffer c = pool->acquire(rgbaKey(kWidth, kHeight), kFrameBytes);
+
+        ThreadSafeResourceManager::MemoryPoolStats stats =
+                manager.getMemoryPoolStats(ThreadSafeResourceManager::MEMORY_BUFFER);
+        if (stats.hits != 1 || stats.misses != 2 || stats.highWaterMark != 2 || stats.usedBlocks != 1 ||
+            stats.totalBlocks != 2 || stats.bytesResident != 2 * kFrameBytes || stats.hitRate < 0.33f ||
+            stats.hitRate > 0.34f) {
+            LOGE("Manager stats: hits %llu misses %llu high water %zu resident %zu",
+                 (unsigned long long) stats.hits, (unsigned long long) stats.misses, stats.highWaterMark,
+                 stats.bytesResident);
+            return false;
+        }
+
+        // 内部内存池的回收也计入命中
+        manager.createMemoryPool(ThreadSafeResourceManager::MEMORY_BUFFER, 4096, 4);
+        void* block = manager.allocateFromPool(ThreadSafeResourceManager::MEMORY_BUFFER);
+        if (!block || !manager.returnToPool(ThreadSafeResourceManager::MEMORY_BUFFER, block) ||
+            manager.allocateFromPool(ThreadSafeResourceManager::MEMORY_BUFFER) != block) {
+            LOGE("Internal pool block was not recycled");
+            return false;
+        }
+        stats = manager.getMemoryPoolStats(ThreadSafeResourceManager::MEMORY_BUFFER);
+        if (stats.hits != 2 || stats.misses != 3 || stats.bytesResident != 2 * kFrameBytes + 4096) {
+            LOGE("Combined stats: hits %llu misses %llu", (unsigned long long) stats.hits,
+                 (unsigned long long) stats.misses);
+            return false;
+        }
+
+        manager.detachMemoryPool(ThreadSafeResourceManager::MEMORY_BUFFER);
+        LOGD("Resource manager stats test PASSED");
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting Frame Buffer Pool Tests");
+
+        int passedTests = 0;
+        int totalTests = 5;
+
+        if (testBufferRecycling()) passedTests++;
+        if (testCacheLimits()) passedTests++;
+        if (testFrameObjects()) passedTests++;
+        if (testCrossThreadRelease()) passedTests++;
+        if (testResourceManagerStats()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+extern "C" void runFrameBufferPoolTests() {
+    FrameBufferPoolTest test;
+    test.runAllTests();
+}
+
+/**
+ * Benchmark: acquire/fill/release of 1080p RGBA frames from the pool versus
+ * a zero-filled new[] per frame, as the decoder callback used to do.
+ */
+extern "C" void runFrameBufferPoolBenchmark(int numFrames) {
+    auto pool = FrameBufferPool::create();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < numFrames; i++) {
+        std::shared_ptr<frame_data_t> frame = pool->acquireFrame();
+        frame->data = pool->acquire(rgbaKey(kWidth, kHeight), kFrameBytes);
+        frame->data.get()[i % kFrameBytes] = (char) i;
+    }
+    auto pooled = std::chrono::steady_clock::now();
+    for (int i = 0; i < numFrames; i++) {
+        std::shared_ptr<frame_data_t> frame = std::make_shared<frame_data_t>();
+        frame->data.reset(new char[kFrameBytes]());
+        frame->data.get()[i % kFrameBytes] = (char) i;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double pooledMs = std::chrono::duration_cast<std::chrono::microseconds>(pooled - start).count() / 1000.0;
+    double allocMs = std::chrono::duration_cast<std::chrono::microseconds>(end - pooled).count() / 1000.0;
+    LOGD("FrameBufferPool benchmark: %d frames, pooled %.3f ms/frame, new[]() %.3f ms/frame, hit rate %.3f",
+         numFrames, pooledMs / numFrames, allocMs / numFrames, pool->getStats().hitRate);
+}
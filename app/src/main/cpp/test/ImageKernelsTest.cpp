@@ -0,0 +1,440 @@
+#include "image_kernels.h"
+#include "log4c.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+const uint8_t kPadding = 0xEE;
+
+// width x height image with `channels` bytes per pixel and `padding` bytes of kPadding after each row
+struct Image {
+    int width;
+    int height;
+    int channels;
+    int stride;
+    std::vector<uint8_t> pixels;
+
+    Image(int w, int h, int c, int padding = 0)
+            : width(w), height(h), channels(c), stride(w * c + padding), pixels((size_t) stride * h, kPadding) {}
+
+    uint8_t* row(int y) { return pixels.data() + (size_t) y * stride; }
+    const uint8_t* row(int y) const { return pixels.data() + (size_t) y * stride; }
+};
+
+Image randomImage(int width, int height, int channels, unsigned seed, int padding = 12) {
+    Image image(width, height, channels, padding);
+    srand(seed);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width * channels; x++) {
+            image.row(y)[x] = (uint8_t) (rand() & 0xFF);
+        }
+    }
+    return image;
+}
+
+// Golden images are written one value per pixel; channel c holds value + 16 * c
+Image goldenImage(const int* values, int width, int height, int channels, int padding) {
+    Image image(width, height, channels, padding);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            for (int c = 0; c < channels; c++) {
+                image.row(y)[x * channels + c] = (uint8_t) (values[y * width + x] + 16 * c);
+            }
+        }
+    }
+    return image;
+}
+
+// Pixels equal and the row padding untouched
+bool sameImage(const Image& a, const Image& b) {
+    return a.width == b.width && a.height == b.height && a.stride == b.stride && a.pixels == b.pixels;
+}
+
+Image scaled(const Image& src, int dstW, int dstH, int padding, image_kernel_impl_e impl) {
+    Image dst(dstW, dstH, src.channels, padding);
+    image_scale(src.pixels.data(), src.width, src.height, src.stride, dst.pixels.data(), dstW, dstH, dst.stride,
+                src.channels, SCALE_FILTER_BILINEAR, impl);
+    return dst;
+}
+
+}  // namespace
+
+/**
+ * Test class for the fixed-point scale, blend and fill kernels in process/image_kernels
+ */
+class ImageKernelsTest {
+public:
+    bool testDiv255() {
+        LOGD("=== Testing divide by 255 ===");
+
+        for (uint32_t x = 0; x <= 255 * 255; x++) {
+            if (mul_div255(x) != (uint8_t) std::lround(x / 255.0)) {
+                LOGE("mul_div255(%u) = %d, expected %ld", x, mul_div255(x), std::lround(x / 255.0));
+                return false;
+            }
+        }
+
+        LOGD("Divide by 255 test passed");
+        return true;
+    }
+
+    bool testBilinearGolden() {
+        LOGD("=== Testing bilinear scale against golden images ===");
+
+        // 2x1 -> 4x1: taps at -0.25 (clamped), 0.25, 0.75, 1.25 (clamped)
+        const int ramp[] = {0, 200};
+        const int rampGolden[] = {0, 50, 150, 200};
+        // 2x2 -> 3x3: taps at 0, 0.5, 1 in both directions
+        const int square[] = {0, 100,
+                              200, 40};
+        const int squareGolden[] = {0, 50, 100,
+                                    100, 85, 70,
+                                    200, 120, 40};
+
+        for (int channels = 1; channels <= 4; channels++) {
+            for (int impl = IMAGE_KERNEL_IMPL_AUTO; impl <= IMAGE_KERNEL_IMPL_SCALAR; impl++) {
+                Image src = goldenImage(ramp, 2, 1, channels, 3);
+                Image out = scaled(src, 4, 1, 5, (image_kernel_impl_e) impl);
+                if (!sameImage(out, goldenImage(rampGolden, 4, 1, channels, 5))) {
+                    LOGE("Ramp 2x1 -> 4x1 with %d channels (impl %d) differs from the golden image", channels, impl);
+                    return false;
+                }
+
+                src = goldenImage(square, 2, 2, channels, 7);
+                out = scaled(src, 3, 3, 1, (image_kernel_impl_e) impl);
+                if (!sameImage(out, goldenImage(squareGolden, 3, 3, channels, 1))) {
+                    LOGE("Square 2x2 -> 3x3 with %d channels (impl %d) differs from the golden image", channels, impl);
+                    return false;
+                }
+            }
+        }
+
+        LOGD("Bilinear golden test passed");
+        return true;
+    }
+
+    bool testBilinearChannels() {
+        LOGD("=== Testing bilinear scale across channel counts ===");
+
+        // Every channel count against the scalar path, and against the 4-channel SIMD result of the same data
+        const int sizes[][4] = {{64, 36, 32, 18}, {63, 35, 21, 12}, {30, 20, 71, 45}, {97, 51, 40, 33}};
+        for (const auto& size : sizes) {
+            Image rgba = randomImage(size[0], size[1], 4, 5);
+            Image rgbaOut = scaled(rgba, size[2], size[3], 0, IMAGE_KERNEL_IMPL_AUTO);
+            for (int channels = 1; channels <= 4; channels++) {
+                Image src(size[0], size[1], channels, 9);
+                for (int y = 0; y < src.height; y++) {
+                    for (int x = 0; x < src.width; x++) {
+                        memcpy(src.row(y) + x * channels, rgba.row(y) + x * 4, channels);
+                    }
+                }
+                Image simd = scaled(src, size[2], size[3], 6, IMAGE_KERNEL_IMPL_AUTO);
+                Image scalar = scaled(src, size[2], size[3], 6, IMAGE_KERNEL_IMPL_SCALAR);
+                if (!sameImage(simd, scalar)) {
+                    LOGE("%dx%d -> %dx%d with %d channels: SIMD and scalar differ", size[0], size[1], size[2],
+                         size[3], channels);
+                    return false;
+                }
+                for (int y = 0; y < simd.height; y++) {
+                    for (int x = 0; x < simd.width; x++) {
+                        if (memcmp(simd.row(y) + x * channels, rgbaOut.row(y) + x * 4, channels) != 0) {
+                            LOGE("%dx%d -> %dx%d with %d channels: pixel (%d,%d) differs from the RGBA result",
+                                 size[0], size[1], size[2], size[3], channels, x, y);
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+
+        LOGD("Bilinear channel test passed (%s)", image_kernels_simd_name());
+        return true;
+    }
+
+    bool testBlendGolden() {
+        LOGD("=== Testing blends against golden pixels ===");
+
+        for (int impl = IMAGE_KERNEL_IMPL_AUTO; impl <= IMAGE_KERNEL_IMPL_SCALAR; impl++) {
+            image_kernel_impl_e kernel = (image_kernel_impl_e) impl;
+            // 20 pixels so the SIMD loops and the scalar tail both run
+            const int n = 20;
+            std::vector<uint8_t> a(n * 4, 200), b(n * 4, 100), out(n * 4);
+
+            const uint8_t alphas[] = {0, 128, 255};
+            const uint8_t mixGolden[] = {100, 150, 200};
+            for (int i = 0; i < 3; i++) {
+                rgba_mix(a.data(), 0, b.data(), 0, out.data(), 0, n, 1, alphas[i], kernel);
+                if (std::count(out.begin(), out.end(), mixGolden[i]) != n * 4) {
+                    LOGE("rgba_mix alpha %d (impl %d): expected %d", alphas[i], impl, mixGolden[i]);
+                    return false;
+                }
+            }
+
+            // Premultiplied half-transparent source over an opaque grey
+            const uint8_t src[4] = {100, 50, 0, 128};
+            const uint8_t opacities[] = {255, 128};
+            const uint8_t overGolden[][4] = {{200, 150, 100, 255}, {200, 175, 150, 255}};
+            const uint8_t grey[4] = {200, 200, 200, 255};
+            for (int i = 0; i < 2; i++) {
+                for (int p = 0; p < n; p++) {
+                    memcpy(&a[p * 4], src, 4);
+                    memcpy(&out[p * 4], grey, 4);
+                }
+                rgba_blend_over(a.data(), 0, out.data(), 0, n, 1, opacities[i], kernel);
+                for (int p = 0; p < n; p++) {
+                    if (memcmp(&out[p * 4], overGolden[i], 4) != 0) {
+                        LOGE("rgba_blend_over opacity %d (impl %d): pixel %d is %d,%d,%d,%d", opacities[i], impl, p,
+                             out[p * 4], out[p * 4 + 1], out[p * 4 + 2], out[p * 4 + 3]);
+                        return false;
+                    }
+                }
+            }
+
+            // Half-transparent black halves the colour and keeps an opaque pixel opaque
+            const uint8_t base[4] = {200, 100, 0, 255};
+            const uint8_t dimGolden[4] = {100, 50, 0, 255};
+            for (int p = 0; p < n; p++) {
+                memcpy(&out[p * 4], base, 4);
+            }
+            rgba_blend_rect(out.data(), 0, n, 1, 0x80000000, kernel);
+            for (int p = 0; p < n; p++) {
+                if (memcmp(&out[p * 4], dimGolden, 4) != 0) {
+                    LOGE("rgba_blend_rect (impl %d): pixel %d is %d,%d,%d,%d", impl, p, out[p * 4], out[p * 4 + 1],
+                         out[p * 4 + 2], out[p * 4 + 3]);
+                    return false;
+                }
+            }
+        }
+
+        LOGD("Blend golden test passed");
+        return true;
+    }
+
+    bool testBlendStrides() {
+        LOGD("=== Testing blends with strides and in place ===");
+
+        const int sizes[][2] = {{37, 5}, {64, 3}, {3, 4}, {129, 2}};
+        const uint8_t alphas[] = {0, 1, 77, 128, 254, 255};
+        for (const auto& size : sizes) {
+            int width = size[0], height = size[1];
+            Image a = randomImage(width, height, 4, 21, 8);
+            Image b = randomImage(width, height, 4, 22, 20);
+            // Non-premultiplied pixels push s + dst past 255 and exercise the saturation
+            for (uint8_t alpha : alphas) {
+                Image simd = randomImage(width, height, 4, 23, 4), scalar = simd;
+                rgba_mix(a.pixels.data(), a.stride, b.pixels.data(), b.stride, simd.pixels.data(), simd.stride, width,
+                         height, alpha, IMAGE_KERNEL_IMPL_AUTO);
+                rgba_mix(a.pixels.data(), a.stride, b.pixels.data(), b.stride, scalar.pixels.data(), scalar.stride,
+                         width, height, alpha, IMAGE_KERNEL_IMPL_SCALAR);
+                Image inPlace = b;
+                rgba_mix(a.pixels.data(), a.stride, inPlace.pixels.data(), inPlace.stride, inPlace.pixels.data(),
+                         inPlace.stride, width, height, alpha);
+                bool inPlaceMatches = true;
+                for (int y = 0; y < height; y++) {
+                    inPlaceMatches = inPlaceMatches && memcmp(inPlace.row(y), simd.row(y), width * 4) == 0;
+                }
+                if (!sameImage(simd, scalar) || !inPlaceMatches) {
+                    LOGE("rgba_mix %dx%d alpha %d: SIMD, scalar and in-place results differ", width, height, alpha);
+                    return false;
+                }
+
+                simd = b;
+                scalar = b;
+                rgba_blend_over(a.pixels.data(), a.stride, simd.pixels.data(), simd.stride, width, height, alpha,
+                                IMAGE_KERNEL_IMPL_AUTO);
+                rgba_blend_over(a.pixels.data(), a.stride, scalar.pixels.data(), scalar.stride, width, height, alpha,
+                                IMAGE_KERNEL_IMPL_SCALAR);
+                if (!sameImage(simd, scalar)) {
+                    LOGE("rgba_blend_over %dx%d opacity %d: SIMD and scalar differ", width, height, alpha);
+                    return false;
+                }
+
+                uint32_t color = 0x01010101u * (alpha / 2) | ((uint32_t) alpha << 24);
+                simd = b;
+                scalar = b;
+                rgba_blend_rect(simd.pixels.data(), simd.stride, width, height, color, IMAGE_KERNEL_IMPL_AUTO);
+                rgba_blend_rect(scalar.pixels.data(), scalar.stride, width, height, color, IMAGE_KERNEL_IMPL_SCALAR);
+                if (!sameImage(simd, scalar)) {
+                    LOGE("rgba_blend_rect %dx%d color %08x: SIMD and scalar differ", width, height, color);
+                    return false;
+                }
+            }
+
+            // An opaque source drawn over is the cross-fade, up to the extra rounding of the two products
+            Image opaque = a;
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    opaque.row(y)[x * 4 + 3] = 255;
+                }
+            }
+            Image over = b, mix = b;
+            rgba_blend_over(opaque.pixels.data(), opaque.stride, over.pixels.data(), over.stride, width, height, 90);
+            rgba_mix(opaque.pixels.data(), opaque.stride, mix.pixels.data(), mix.stride, mix.pixels.data(), mix.stride,
+                     width, height, 90);
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width * 4; x++) {
+                    // The mix also fades the destination alpha towards 255; colours must agree
+                    if (x % 4 != 3 && std::abs(over.row(y)[x] - mix.row(y)[x]) > 1) {
+                        LOGE("Opaque over %dx%d differs from mix at byte (%d,%d)", width, height, x, y);
+                        return false;
+                    }
+                }
+            }
+        }
+
+        LOGD("Blend stride test passed (%s)", image_kernels_simd_name());
+        return true;
+    }
+
+    bool testFillRect() {
+        LOGD("=== Testing rectangle fills ===");
+
+        const uint8_t pixel[4] = {0x12, 0x34, 0x56, 0x78};
+        const int channelCounts[] = {1, 2, 4};
+        for (int channels : channelCounts) {
+            for (int width = 1; width <= 37; width += 4) {
+                Image simd = randomImage(width + 6, 5, channels, 31, 7), scalar = simd;
+                // Inset by three pixels and one row so the untouched border is checked too
+                image_fill_rect(simd.row(1) + 3 * channels, simd.stride, width, 3, pixel, channels,
+                                IMAGE_KERNEL_IMPL_AUTO);
+                image_fill_rect(scalar.row(1) + 3 * channels, scalar.stride, width, 3, pixel, channels,
+                                IMAGE_KERNEL_IMPL_SCALAR);
+                if (!sameImage(simd, scalar)) {
+                    LOGE("image_fill_rect %d channels width %d: SIMD and scalar differ", channels, width);
+                    return false;
+                }
+                Image original = randomImage(width + 6, 5, channels, 31, 7);
+                for (int y = 0; y < 5; y++) {
+                    for (int x = 0; x < (width + 6) * channels; x++) {
+                        bool inside = y >= 1 && y < 4 && x >= 3 * channels && x < (width + 3) * channels;
+                        uint8_t expected = inside ? pixel[x % channels] : original.row(y)[x];
+                        if (simd.row(y)[x] != expected) {
+                            LOGE("image_fill_rect %d channels width %d: byte (%d,%d) is %d, expected %d", channels,
+                                 width, x, y, simd.row(y)[x], expected);
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+
+        LOGD("Fill test passed (%s)", image_kernels_simd_name());
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting Image Kernels Tests");
+
+        int passedTests = 0;
+        int totalTests = 0;
+
+        totalTests++; if (testDiv255()) passedTests++;
+        totalTests++; if (testBilinearGolden()) passedTests++;
+        totalTests++; if (testBilinearChannels()) passedTests++;
+        totalTests++; if (testBlendGolden()) passedTests++;
+        totalTests++; if (testBlendStrides()) passedTests++;
+        totalTests++; if (testFillRect()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+extern "C" void runImageKernelsTests() {
+    ImageKernelsTest test;
+    test.runAllTests();
+}
+
+// Previous FrameCompositionUtils::bilinearScale: four float taps per channel, packed rows
+static void legacyBilinearScale(const uint8_t* src, uint8_t* dst, int srcW, int srcH, int dstW, int dstH,
+                                int channels) {
+    float xRatio = static_cast<float>(srcW) / dstW;
+    float yRatio = static_cast<float>(srcH) / dstH;
+    for (int y = 0; y < dstH; y++) {
+        for (int x = 0; x < dstW; x++) {
+            float srcX = x * xRatio;
+            float srcY = y * yRatio;
+            int x1 = static_cast<int>(srcX);
+            int y1 = static_cast<int>(srcY);
+            int x2 = std::min(x1 + 1, srcW - 1);
+            int y2 = std::min(y1 + 1, srcH - 1);
+            float dx = srcX - x1;
+            float dy = srcY - y1;
+            for (int c = 0; c < channels; c++) {
+                float p1 = src[(y1 * srcW + x1) * channels + c];
+                float p2 = src[(y1 * srcW + x2) * channels + c];
+                float p3 = src[(y2 * srcW + x1) * channels + c];
+                float p4 = src[(y2 * srcW + x2) * channels + c];
+                float interpolated = p1 * (1 - dx) * (1 - dy) + p2 * dx * (1 - dy) + p3 * (1 - dx) * dy +
+                                     p4 * dx * dy;
+                dst[(y * dstW + x) * channels + c] = static_cast<uint8_t>(interpolated);
+            }
+        }
+    }
+}
+
+// Previous FrameCompositionUtils::alphaBlend: a divide by 255 per byte
+static void legacyAlphaBlend(const uint8_t* src, uint8_t* dst, int width, int height, float alpha) {
+    uint8_t alphaValue = static_cast<uint8_t>(alpha * 255);
+    uint8_t invAlpha = 255 - alphaValue;
+    for (int i = 0; i < width * height * 4; i += 4) {
+        dst[i] = (src[i] * alphaValue + dst[i] * invAlpha) / 255;
+        dst[i + 1] = (src[i + 1] * alphaValue + dst[i + 1] * invAlpha) / 255;
+        dst[i + 2] = (src[i + 2] * alphaValue + dst[i + 2] * invAlpha) / 255;
+        dst[i + 3] = std::max(src[i + 3], dst[i + 3]);
+    }
+}
+
+template <typename F>
+static double averageMs(int iterations, F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        body();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+extern "C" void runImageKernelsBenchmark() {
+    LOGD("=== Image Kernels Benchmark (%s) ===", image_kernels_simd_name());
+
+    const int iterations = 10;
+    Image src = randomImage(1920, 1080, 4, 1, 0);
+    const int targets[][2] = {{960, 540}, {640, 360}, {2560, 1440}};
+    for (const auto& target : targets) {
+        Image dst(target[0], target[1], 4);
+        double legacy = averageMs(iterations, [&] {
+            legacyBilinearScale(src.pixels.data(), dst.pixels.data(), src.width, src.height, dst.width, dst.height, 4);
+        });
+        double kernel = averageMs(iterations, [&] {
+            image_scale(src.pixels.data(), src.width, src.height, src.stride, dst.pixels.data(), dst.width, dst.height,
+                        dst.stride, 4, SCALE_FILTER_BILINEAR);
+        });
+        LOGD("Bilinear 1920x1080 -> %dx%d: legacy %.2f ms, fixed point %.2f ms (%.1fx)", target[0], target[1], legacy,
+             kernel, legacy / kernel);
+    }
+
+    Image dst = randomImage(1920, 1080, 4, 2, 0);
+    double legacy = averageMs(iterations, [&] {
+        legacyAlphaBlend(src.pixels.data(), dst.pixels.data(), src.width, src.height, 0.6f);
+    });
+    double over = averageMs(iterations, [&] {
+        rgba_blend_over(src.pixels.data(), src.stride, dst.pixels.data(), dst.stride, src.width, src.height, 153);
+    });
+    double mix = averageMs(iterations, [&] {
+        rgba_mix(src.pixels.data(), src.stride, dst.pixels.data(), dst.stride, dst.pixels.data(), dst.stride,
+                 src.width, src.height, 153);
+    });
+    LOGD("Blend 1920x1080: legacy %.2f ms, over %.2f ms (%.1fx), mix %.2f ms (%.1fx)", legacy, over, legacy / over,
+         mix, legacy / mix);
+}
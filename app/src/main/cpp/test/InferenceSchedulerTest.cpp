@@ -0,0 +1,694 @@
+#include "inference_scheduler.h"
+#include "yolov5_thread_pool.h"
+#include "StubNNEngine.h"
+#include "rga.h"
+#include "log4c.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+
+namespace {
+
+std::shared_ptr<frame_data_t> makeTestFrame(int frameId, int width = 320, int height = 240) {
+    auto frameData = std::make_shared<frame_data_t>();
+    frameData->frameId = frameId;
+    frameData->screenW = width;
+    frameData->screenH = height;
+    frameData->widthStride = width;
+    frameData->heightStride = height;
+    frameData->screenStride = width * 4;
+    frameData->frameFormat = RK_FORMAT_RGBA_8888;
+    frameData->dataSize = width * height * 4;
+    frameData->data.reset(new char[frameData->dataSize]());
+    return frameData;
+}
+
+int64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 阻塞直到该帧推理完成并取出检测结果，图像留在槽中供getTargetImgResult取（getTargetResult会一并释放图像）
+nn_error_e waitForTargetResult(InferenceScheduler &scheduler, int channelIndex, std::vector<Detection> &objects,
+                               int id) {
+    uint64_t seen = 0;
+    for (;;) {
+        nn_error_e ret = scheduler.getTargetResultNonBlock(channelIndex, objects, id);
+        if (ret != NN_RESULT_NOT_READY) {
+            return ret;
+        }
+        ret = scheduler.waitForResult(channelIndex, seen, 5000);
+        if (ret != NN_SUCCESS) {
+            return ret;
+        }
+    }
+}
+
+/**
+ * Models the NPU as a fixed number of cores shared by every engine instance:
+ * Run() waits for a free core, so any number of contexts can be created but
+ * only `cores` inferences make progress at once (as on the RK3588).
+ */
+class NpuCoreLimiter {
+public:
+    explicit NpuCoreLimiter(int cores) : freeCores(cores) {}
+
+    void acquire() {
+        std::unique_lock<std::mutex> lock(mtx);
+        cond.wait(lock, [this] { return freeCores > 0; });
+        freeCores--;
+    }
+
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            freeCores++;
+        }
+        cond.notify_one();
+    }
+
+private:
+    std::mutex mtx;
+    std::condition_variable cond;
+    int freeCores;
+};
+
+class CoreLimitedStubEngine : public StubNNEngine {
+public:
+    CoreLimitedStubEngine(NpuCoreLimiter *limiter, int inferenceUs) : StubNNEngine(inferenceUs), limiter(limiter) {}
+
+    nn_error_e Run(std::vector<tensor_data_s> &inputs, std::vector<tensor_data_s> &outputs, bool want_float) override {
+        limiter->acquire();
+        nn_error_e ret = StubNNEngine::Run(inputs, outputs, want_float);
+        limiter->release();
+        return ret;
+    }
+
+private:
+    NpuCoreLimiter *limiter;
+};
+
+struct ChannelLoadResult {
+    int submitted = 0;
+    int completed = 0;
+    double avgLatencyMs = 0.0;
+    double p99LatencyMs = 0.0;
+};
+
+/**
+ * Drives every channel at a fixed frame rate for durationMs. A frame only gets
+ * a frameId when submit() accepts it (drop-on-full, as the decoder callback
+ * does), and one consumer per channel takes results in frameId order and
+ * records submit -> result latency.
+ */
+std::vector<ChannelLoadResult> runChannelLoad(int numChannels, int fps, int durationMs,
+                                              const std::function<nn_error_e(int, const std::shared_ptr<frame_data_t> &)> &submit,
+                                              const std::function<nn_error_e(int, int)> &waitResult) {
+    const int maxFrames = fps * durationMs / 1000 + 16;
+    std::vector<std::vector<int64_t>> submitUs(numChannels, std::vector<int64_t>(maxFrames, 0));
+    std::vector<std::vector<double>> latencies(numChannels);
+    std::unique_ptr<std::atomic<int>[]> submitted(new std::atomic<int>[numChannels]);
+    for (int ch = 0; ch < numChannels; ch++) {
+        submitted[ch] = 0;
+    }
+    std::atomic<bool> producersDone(false);
+
+    std::vector<std::thread> threads;
+    for (int ch = 0; ch < numChannels; ch++) {
+        threads.emplace_back([&, ch] {
+            const int64_t intervalUs = 1000000 / fps;
+            // 各路相位错开，模拟独立摄像头
+            int64_t next = nowUs() + ch * intervalUs / numChannels;
+            const int64_t end = nowUs() + durationMs * 1000LL;
+            int id = 0;
+            while (next < end && id < maxFrames) {
+                int64_t wait = next - nowUs();
+                if (wait > 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(wait));
+                }
+                next += intervalUs;
+                submitUs[ch][id] = nowUs();
+                if (submit(ch, makeTestFrame(id)) == NN_SUCCESS) {
+                    id++;
+                    submitted[ch] = id;
+                }
+            }
+        });
+    }
+    for (int ch = 0; ch < numChannels; ch++) {
+        threads.emplace_back([&, ch] {
+            int id = 0;
+            while (true) {
+                if (id >= submitted[ch].load()) {
+                    if (producersDone.load() && id >= submitted[ch].load()) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::microseconds(500));
+                    continue;
+                }
+                if (waitResult(ch, id) != NN_SUCCESS) {
+                    break;
+                }
+                latencies[ch].push_back((nowUs() - submitUs[ch][id]) / 1000.0);
+                id++;
+            }
+        });
+    }
+    for (int ch = 0; ch < numChannels; ch++) {
+        threads[ch].join();
+    }
+    producersDone = true;
+    for (int ch = numChannels; ch < 2 * numChannels; ch++) {
+        threads[ch].join();
+    }
+
+    std::vector<ChannelLoadResult> results(numChannels);
+    for (int ch = 0; ch < numChannels; ch++) {
+        std::vector<double> &lat = latencies[ch];
+        results[ch].submitted = submitted[ch].load();
+        results[ch].completed = (int) lat.size();
+        if (!lat.empty()) {
+            double sum = 0.0;
+            for (double v : lat) {
+                sum += v;
+            }
+            std::sort(lat.begin(), lat.end());
+            results[ch].avgLatencyMs = sum / lat.size();
+            results[ch].p99LatencyMs = lat[std::min(lat.size() - 1, (size_t) (lat.size() * 0.99))];
+        }
+    }
+    return results;
+}
+
+/**
+ * Keeps every registered channel's queue saturated for durationMs with a
+ * single worker and returns each channel's scheduler stats.
+ */
+std::vector<InferenceScheduler::ChannelStats> measureSaturatedShares(InferenceScheduler &scheduler, int numChannels, int durationMs) {
+    std::atomic<bool> running(true);
+    std::vector<std::thread> threads;
+    for (int ch = 0; ch < numChannels; ch++) {
+        threads.emplace_back([&, ch] {
+            int id = 0;
+            while (running) {
+                if (scheduler.submitFrame(ch, makeTestFrame(id)) == NN_SUCCESS) {
+                    id++;
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+            }
+        });
+        threads.emplace_back([&, ch] {
+            for (int id = 0;; id++) {
+                std::vector<Detection> objects;
+                if (scheduler.getTargetResult(ch, objects, id) != NN_SUCCESS) {
+                    break;
+                }
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(durationMs));
+    running = false;
+
+    std::vector<InferenceScheduler::ChannelStats> stats(numChannels);
+    for (int ch = 0; ch < numChannels; ch++) {
+        scheduler.getChannelStats(ch, stats[ch]);
+    }
+    scheduler.stopAll();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    return stats;
+}
+
+bool shareNear(long part, long total, double expected, double tolerance) {
+    if (total <= 0) {
+        return false;
+    }
+    double share = (double) part / total;
+    return share > expected - tolerance && share < expected + tolerance;
+}
+
+} // namespace
+
+/**
+ * Test class for the cross-channel InferenceScheduler
+ */
+class InferenceSchedulerTest {
+public:
+    bool testWeightedFairShare() {
+        LOGD("=== Testing weighted-fair NPU share by priority ===");
+
+        InferenceScheduler scheduler;
+        InferenceScheduler::Config config;
+        config.numWorkers = 1;
+        config.policy = InferenceScheduler::WEIGHTED_FAIR;
+        scheduler.setUpWithEngineFactory(config, [] { return std::make_shared<StubNNEngine>(2000); }, nullptr, 0);
+        scheduler.registerChannel(0, 1);
+        scheduler.registerChannel(1, 2);
+        scheduler.registerChannel(2, 4);
+
+        std::vector<InferenceScheduler::ChannelStats> stats = measureSaturatedShares(scheduler, 3, 800);
+        long completed[3] = {stats[0].completed, stats[1].completed, stats[2].completed};
+        long total = completed[0] + completed[1] + completed[2];
+        LOGD("Completed per channel (priority 1/2/4): %ld / %ld / %ld", completed[0], completed[1], completed[2]);
+
+        if (!shareNear(completed[0], total, 1.0 / 7, 0.05) ||
+            !shareNear(completed[1], total, 2.0 / 7, 0.05) ||
+            !shareNear(completed[2], total, 4.0 / 7, 0.05)) {
+            LOGE("NPU share does not follow 1:2:4 priorities");
+            return false;
+        }
+
+        LOGD("Weighted-fair share test passed");
+        return true;
+    }
+
+    bool testVisibleAndActiveWeights() {
+        LOGD("=== Testing visible/active weighting ===");
+
+        InferenceScheduler scheduler;
+        InferenceScheduler::Config config;
+        config.numWorkers = 1;
+        config.activeBoost = 2.0f;
+        config.hiddenScale = 0.25f;
+        scheduler.setUpWithEngineFactory(config, [] { return std::make_shared<StubNNEngine>(2000); }, nullptr, 0);
+        scheduler.registerChannel(0);
+        scheduler.registerChannel(1);
+        scheduler.registerChannel(2);
+        scheduler.setChannelActive(0, true);    // weight 2
+        scheduler.setChannelVisible(2, false);  // weight 0.25
+
+        InferenceScheduler::ChannelStats stats;
+        if (!scheduler.getChannelStats(2, stats) || stats.visible || stats.weight > 0.26f) {
+            LOGE("Hidden channel weight not applied");
+            return false;
+        }
+
+        std::vector<InferenceScheduler::ChannelStats> all = measureSaturatedShares(scheduler, 3, 800);
+        long completed[3] = {all[0].completed, all[1].completed, all[2].completed};
+        long total = completed[0] + completed[1] + completed[2];
+        LOGD("Completed per channel (active/normal/hidden): %ld / %ld / %ld", completed[0], completed[1], completed[2]);
+
+        // 2 : 1 : 0.25
+        if (!shareNear(completed[0], total, 2.0 / 3.25, 0.06) ||
+            !shareNear(completed[2], total, 0.25 / 3.25, 0.04)) {
+            LOGE("Active/hidden channels did not get their weighted share");
+            return false;
+        }
+
+        LOGD("Visible/active weighting test passed");
+        return true;
+    }
+
+    bool testEarliestDeadline() {
+        LOGD("=== Testing earliest-deadline policy ===");
+
+        InferenceScheduler scheduler;
+        InferenceScheduler::Config config;
+        config.numWorkers = 1;
+        config.policy = InferenceScheduler::EARLIEST_DEADLINE;
+        config.deadlineMs = 40;
+        scheduler.setUpWithEngineFactory(config, [] { return std::make_shared<StubNNEngine>(2000); }, nullptr, 0);
+        scheduler.registerChannel(0, 1);
+        scheduler.registerChannel(1, 4);    // 10ms deadline vs 40ms
+
+        std::vector<InferenceScheduler::ChannelStats> stats = measureSaturatedShares(scheduler, 2, 500);
+        LOGD("Channel 40ms deadline: %ld done, %.1fms queue wait; 10ms deadline: %ld done, %.1fms queue wait",
+             stats[0].completed, stats[0].avgQueueWaitMs, stats[1].completed, stats[1].avgQueueWaitMs);
+
+        if (stats[1].completed < stats[0].completed || stats[1].avgQueueWaitMs >= stats[0].avgQueueWaitMs) {
+            LOGE("Tighter-deadline channel should be served first");
+            return false;
+        }
+
+        LOGD("Earliest-deadline test passed");
+        return true;
+    }
+
+    bool testQueueBoundAndStats() {
+        LOGD("=== Testing per-channel queue bound and stats ===");
+
+        InferenceScheduler scheduler;
+        InferenceScheduler::Config config;
+        config.numWorkers = 1;
+        config.maxQueueDepth = 4;
+        scheduler.setUpWithEngineFactory(config, [] { return std::make_shared<StubNNEngine>(200000); }, nullptr, 0);
+        scheduler.registerChannel(3);
+
+        if (scheduler.submitFrame(7, makeTestFrame(0)) != NN_CHANNEL_NOT_FOUND) {
+            LOGE("Submit to unregistered channel should return NN_CHANNEL_NOT_FOUND");
+            return false;
+        }
+
+        int accepted = 0;
+        int rejected = 0;
+        for (int i = 0; i < 10; i++) {
+            nn_error_e ret = scheduler.submitFrame(3, makeTestFrame(accepted));
+            if (ret == NN_SUCCESS) {
+                accepted++;
+            } else if (ret == NN_QUEUE_FULL) {
+                rejected++;
+            }
+        }
+
+        InferenceScheduler::ChannelStats stats;
+        scheduler.getChannelStats(3, stats);
+        LOGD("accepted %d, rejected %d, queueDepth %d, inFlight %d, dropped %ld",
+             accepted, rejected, stats.queueDepth, stats.inFlight, stats.dropped);
+        if (accepted < 4 || accepted > 5 || stats.dropped != rejected || stats.queueDepth > 4) {
+            LOGE("Queue bound not enforced");
+            return false;
+        }
+
+        // 第一帧完成后应能取到结果并有服务延迟统计
+        std::vector<Detection> objects;
+        if (scheduler.getTargetResult(3, objects, 0) != NN_SUCCESS) {
+            LOGE("Result for frame 0 missing");
+            return false;
+        }
+        scheduler.getChannelStats(3, stats);
+        if (stats.completed < 1 || stats.avgServiceMs < 150.0f || stats.avgInferenceMs < 150.0f) {
+            LOGE("Latency stats not recorded: completed %ld, service %.1fms, inference %.1fms",
+                 stats.completed, stats.avgServiceMs, stats.avgInferenceMs);
+            return false;
+        }
+
+        scheduler.unregisterChannel(3);
+        if (scheduler.getTargetResult(3, objects, 1) != NN_CHANNEL_NOT_FOUND) {
+            LOGE("Unregistered channel should not return results");
+            return false;
+        }
+        scheduler.stopAll();
+        if (scheduler.registerChannel(4) != NN_STOPED) {
+            LOGE("registerChannel after stopAll should return NN_STOPED");
+            return false;
+        }
+
+        LOGD("Queue bound and stats test passed");
+        return true;
+    }
+
+    bool testPerChannelResultRouting() {
+        LOGD("=== Testing per-channel result routing ===");
+
+        InferenceScheduler scheduler;
+        InferenceScheduler::Config config;
+        config.numWorkers = 3;
+        scheduler.setUpWithEngineFactory(config, [] { return std::make_shared<StubNNEngine>(1000); }, nullptr, 0);
+
+        const int numChannels = 4;
+        const int numFrames = 50;
+        for (int ch = 0; ch < numChannels; ch++) {
+            scheduler.registerChannel(ch);
+        }
+
+        // 各通道使用相同的frameId序列，用帧宽度区分来源通道
+        std::vector<std::thread> producers;
+        for (int ch = 0; ch < numChannels; ch++) {
+            producers.emplace_back([&, ch] {
+                for (int id = 0; id < numFrames;) {
+                    if (scheduler.submitFrame(ch, makeTestFrame(id, 320 + 16 * ch)) == NN_SUCCESS) {
+                        id++;
+                    } else {
+                        std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    }
+                }
+            });
+        }
+
+        bool ok = true;
+        for (int ch = 0; ch < numChannels && ok; ch++) {
+            for (int id = 0; id < numFrames; id++) {
+                std::vector<Detection> objects;
+                if (scheduler.getTargetResult(ch, objects, id) != NN_SUCCESS) {
+                    LOGE("Channel %d frame %d missing", ch, id);
+                    ok = false;
+                    break;
+                }
+            }
+        }
+        for (auto &producer : producers) {
+            producer.join();
+        }
+        if (!ok) {
+            return false;
+        }
+
+        // 结果和图像分开取时，图像也必须来自对应通道
+        scheduler.submitFrame(2, makeTestFrame(numFrames, 320 + 16 * 2));
+        std::vector<Detection> objects;
+        if (waitForTargetResult(scheduler, 2, objects, numFrames) != NN_SUCCESS) {
+            LOGE("Channel 2 frame %d missing", numFrames);
+            return false;
+        }
+        auto frame = scheduler.getTargetImgResult(2, numFrames);
+        if (!frame || frame->screenW != 320 + 16 * 2) {
+            LOGE("Image result routed to the wrong channel");
+            return false;
+        }
+
+        LOGD("Per-channel result routing test passed");
+        return true;
+    }
+
+    bool testBatchGathering() {
+        LOGD("=== Testing batched inference across channels ===");
+
+        const int numChannels = 4;
+        const int framesPerChannel = 12;
+        std::shared_ptr<StubNNEngine> engine;
+        {
+            InferenceScheduler scheduler;
+            InferenceScheduler::Config config;
+            config.numWorkers = 1;
+            config.maxBatchSize = 4;
+            config.maxBatchWaitUs = 20000;
+            scheduler.setUpWithEngineFactory(config, [&] {
+                engine = std::make_shared<StubNNEngine>(8000, 640, 4, 1000);
+                return engine;
+            }, nullptr, 0);
+            for (int ch = 0; ch < numChannels; ch++) {
+                scheduler.registerChannel(ch);
+            }
+
+            // 各通道同时提交同一frameId，应被合并为一个batch
+            bool ok = true;
+            for (int id = 0; id < framesPerChannel && ok; id++) {
+                for (int ch = 0; ch < numChannels; ch++) {
+                    scheduler.submitFrame(ch, makeTestFrame(id, 320 + 16 * ch));
+                }
+                for (int ch = 0; ch < numChannels; ch++) {
+                    std::vector<Detection> objects;
+                    if (waitForTargetResult(scheduler, ch, objects, id) != NN_SUCCESS) {
+                        LOGE("Channel %d frame %d missing", ch, id);
+                        ok = false;
+                        break;
+                    }
+                    auto frame = scheduler.getTargetImgResult(ch, id);
+                    if (!frame || frame->frameId != id || frame->screenW != 320 + 16 * ch) {
+                        LOGE("Batched result for channel %d frame %d scattered to the wrong slot", ch, id);
+                        ok = false;
+                        break;
+                    }
+                }
+            }
+            if (!ok) {
+                return false;
+            }
+
+            // 只有一帧时等满maxBatchWaitUs后单独推理，不会一直等待凑批
+            int64_t start = nowUs();
+            scheduler.submitFrame(0, makeTestFrame(framesPerChannel));
+            std::vector<Detection> objects;
+            if (scheduler.getTargetResult(0, objects, framesPerChannel) != NN_SUCCESS) {
+                LOGE("Lone frame never completed");
+                return false;
+            }
+            LOGD("Lone frame latency %.1fms, average batch %.2f", (nowUs() - start) / 1000.0,
+                 scheduler.getAverageBatchSize());
+        }
+
+        // 调度器析构后工作线程已退出，再读引擎计数
+        LOGD("Engine calls %d, frames %d, largest batch %d", engine->getRunCount(), engine->getItemCount(),
+             engine->getLargestBatch());
+        if (engine->getItemCount() != numChannels * framesPerChannel + 1 || engine->getLargestBatch() != 4 ||
+            engine->getRunCount() > engine->getItemCount() / 2) {
+            LOGE("Frames were not gathered into batches");
+            return false;
+        }
+
+        LOGD("Batch gathering test passed");
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting InferenceScheduler Tests");
+
+        int passedTests = 0;
+        int totalTests = 6;
+
+        if (testWeightedFairShare()) passedTests++;
+        if (testVisibleAndActiveWeights()) passedTests++;
+        if (testEarliestDeadline()) passedTests++;
+        if (testQueueBoundAndStats()) passedTests++;
+        if (testPerChannelResultRouting()) passedTests++;
+        if (testBatchGathering()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+// Test runner function
+extern "C" void runInferenceSchedulerTests() {
+    InferenceSchedulerTest test;
+    test.runAllTests();
+}
+
+static void logChannelLoad(const char *name, const std::vector<ChannelLoadResult> &results, int durationMs) {
+    int totalCompleted = 0;
+    int totalSubmitted = 0;
+    for (const auto &r : results) {
+        totalCompleted += r.completed;
+        totalSubmitted += r.submitted;
+    }
+    LOGD("%s: %.1f fps detected in total (%d accepted)", name, totalCompleted * 1000.0 / durationMs, totalSubmitted);
+    for (size_t ch = 0; ch < results.size(); ch++) {
+        LOGD("  ch%-2zu %5.1f fps  avg %6.1fms  p99 %6.1fms", ch, results[ch].completed * 1000.0 / durationMs,
+             results[ch].avgLatencyMs, results[ch].p99LatencyMs);
+    }
+}
+
+/**
+ * Benchmark: 16 channels x 25 fps against a 3-core NPU model (10ms per frame,
+ * 300 fps capacity for 400 fps offered). Baseline is the current layout of one
+ * Yolov5ThreadPool per channel (3 contexts each, 48 in total) contending for
+ * the cores; the shared scheduler uses 3 contexts, channel 0 is the selected
+ * view with priority 4 and channels 12-15 are off-screen.
+ */
+extern "C" void runInferenceSchedulerBenchmark() {
+    LOGD("=== InferenceScheduler vs per-channel pools Benchmark ===");
+
+    const int numChannels = 16;
+    const int fps = 25;
+    const int inferenceUs = 10000;
+    const int npuCores = 3;
+    const int durationMs = 3000;
+
+    std::vector<ChannelLoadResult> perChannel;
+    {
+        NpuCoreLimiter npu(npuCores);
+        std::vector<std::unique_ptr<Yolov5ThreadPool>> pools;
+        for (int ch = 0; ch < numChannels; ch++) {
+            pools.emplace_back(new Yolov5ThreadPool());
+            pools.back()->setUpWithEngineFactory(
+                    3, [&] { return std::make_shared<CoreLimitedStubEngine>(&npu, inferenceUs); }, nullptr, 0);
+        }
+        perChannel = runChannelLoad(
+                numChannels, fps, durationMs,
+                [&](int ch, const std::shared_ptr<frame_data_t> &f) { return pools[ch]->trySubmitTask(f); },
+                [&](int ch, int id) {
+                    std::vector<Detection> objects;
+                    return pools[ch]->getTargetResult(objects, id);
+                });
+    }
+
+    std::vector<ChannelLoadResult> shared;
+    std::vector<InferenceScheduler::ChannelStats> stats;
+    {
+        NpuCoreLimiter npu(npuCores);
+        InferenceScheduler scheduler;
+        InferenceScheduler::Config config;
+        config.numWorkers = npuCores;
+        config.policy = InferenceScheduler::WEIGHTED_FAIR;
+        scheduler.setUpWithEngineFactory(
+                config, [&] { return std::make_shared<CoreLimitedStubEngine>(&npu, inferenceUs); }, nullptr, 0);
+        for (int ch = 0; ch < numChannels; ch++) {
+            scheduler.registerChannel(ch, ch == 0 ? 4 : 1);
+            scheduler.setChannelVisible(ch, ch < 12);
+        }
+        scheduler.setChannelActive(0, true);
+        shared = runChannelLoad(
+                numChannels, fps, durationMs,
+                [&](int ch, const std::shared_ptr<frame_data_t> &f) { return scheduler.submitFrame(ch, f); },
+                [&](int ch, int id) {
+                    std::vector<Detection> objects;
+                    return scheduler.getTargetResult(ch, objects, id);
+                });
+        stats = scheduler.getAllChannelStats();
+    }
+
+    LOGD("Config: %d channels x %d fps, %dus per inference, %d NPU cores, %dms", numChannels, fps, inferenceUs,
+         npuCores, durationMs);
+    logChannelLoad("per-channel pools (48 contexts)", perChannel, durationMs);
+    logChannelLoad("shared scheduler (3 contexts)", shared, durationMs);
+    for (const auto &s : stats) {
+        LOGD("  scheduler ch%-2d weight %5.2f  queue wait %6.1fms  service avg %6.1fms max %6.1fms  dropped %ld",
+             s.channelIndex, s.weight, s.avgQueueWaitMs, s.avgServiceMs, s.maxServiceMs, s.dropped);
+    }
+}
+
+/**
+ * Benchmark: batch size x gather window on a batch-capable model. Each call
+ * costs 8ms fixed + 2ms per frame (so batch 4 = 16ms for 4 frames vs 40ms
+ * one by one), 3 workers, 16 channels x 25 fps. Reports detected fps, latency
+ * and the batch size actually achieved.
+ */
+extern "C" void runInferenceSchedulerBatchBenchmark() {
+    LOGD("=== InferenceScheduler batch policy Benchmark ===");
+
+    const int numChannels = 16;
+    const int fps = 25;
+    const int fixedUs = 8000;
+    const int perItemUs = 2000;
+    const int durationMs = 3000;
+    const int batchSizes[] = {1, 2, 4};
+    const int waitsUs[] = {0, 2000, 5000};
+
+    for (int batchSize : batchSizes) {
+        for (int waitUs : waitsUs) {
+            if (batchSize == 1 && waitUs > 0) {
+                continue;
+            }
+            InferenceScheduler scheduler;
+            InferenceScheduler::Config config;
+            config.numWorkers = 3;
+            config.maxBatchSize = batchSize;
+            config.maxBatchWaitUs = waitUs;
+            scheduler.setUpWithEngineFactory(
+                    config, [&] { return std::make_shared<StubNNEngine>(fixedUs, 640, 4, perItemUs); }, nullptr, 0);
+            for (int ch = 0; ch < numChannels; ch++) {
+                scheduler.registerChannel(ch);
+            }
+            std::vector<ChannelLoadResult> results = runChannelLoad(
+                    numChannels, fps, durationMs,
+                    [&](int ch, const std::shared_ptr<frame_data_t> &f) { return scheduler.submitFrame(ch, f); },
+                    [&](int ch, int id) {
+                        std::vector<Detection> objects;
+                        return scheduler.getTargetResult(ch, objects, id);
+                    });
+
+            int completed = 0;
+            double latencySum = 0.0;
+            double p99 = 0.0;
+            for (const auto &r : results) {
+                completed += r.completed;
+                latencySum += r.avgLatencyMs * r.completed;
+                p99 = std::max(p99, r.p99LatencyMs);
+            }
+            LOGD("batch %d wait %4dus: %6.1f fps  avg %6.1fms  worst-channel p99 %6.1fms  avg batch %.2f",
+                 batchSize, waitUs, completed * 1000.0 / durationMs, completed > 0 ? latencySum / completed : 0.0,
+                 p99, scheduler.getAverageBatchSize());
+        }
+    }
+}
@@ -0,0 +1,443 @@
+#include "letterbox.h"
+#include "preprocess.h"
+#include "log4c.h"
+#include "rga.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+struct TestTensor {
+    std::vector<uint8_t> buffer;
+    tensor_data_s tensor;
+
+    TestTensor(int width, int height) : buffer(width * height * 3, 0xAB) {
+        memset(&tensor, 0, sizeof(tensor));
+        tensor.attr.n_dims = 4;
+        tensor.attr.dims[0] = 1;
+        tensor.attr.dims[1] = height;
+        tensor.attr.dims[2] = width;
+        tensor.attr.dims[3] = 3;
+        tensor.attr.n_elems = width * height * 3;
+        tensor.attr.size = tensor.attr.n_elems;
+        tensor.attr.type = NN_TENSOR_UINT8;
+        tensor.attr.layout = NN_TENSOR_NHWC;
+        tensor.data = buffer.data();
+    }
+
+    const uint8_t *pixel(int x, int y) const { return &buffer[(y * tensor.attr.dims[2] + x) * 3]; }
+};
+
+image_frame_s makeFrame(const std::vector<uint8_t> &data, int width, int height, int stride, int heightStride,
+                        int format) {
+    image_frame_s frame;
+    frame.data = data.data();
+    frame.width = width;
+    frame.height = height;
+    frame.stride = stride;
+    frame.height_stride = heightStride;
+    frame.format = format;
+    return frame;
+}
+
+// 生成带随机内容的打包RGB/RGBA图像，stride之外的填充字节写成0xEE用于检查越界读取
+std::vector<uint8_t> makePackedImage(int width, int height, int bpp, int stride, unsigned seed) {
+    std::vector<uint8_t> image(stride * height, 0xEE);
+    srand(seed);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width * bpp; x++) {
+            image[y * stride + x] = (uint8_t) (rand() & 0xFF);
+        }
+    }
+    return image;
+}
+
+// 浮点双线性参考实现（与内核相同的像素中心对齐），用于误差检查
+float referenceSample(const std::vector<uint8_t> &image, int width, int height, int stride, int bpp, int channel,
+                      int dx, int dy, int resizedW, int resizedH) {
+    float fx = std::max(0.f, (dx + 0.5f) * width / resizedW - 0.5f);
+    float fy = std::max(0.f, (dy + 0.5f) * height / resizedH - 0.5f);
+    int x0 = std::min((int) fx, width - 1);
+    int y0 = std::min((int) fy, height - 1);
+    int x1 = std::min(x0 + 1, width - 1);
+    int y1 = std::min(y0 + 1, height - 1);
+    float ax = x0 == x1 ? 0.f : fx - x0;
+    float ay = y0 == y1 ? 0.f : fy - y0;
+    auto at = [&](int x, int y) { return (float) image[y * stride + x * bpp + channel]; };
+    float top = at(x0, y0) * (1 - ax) + at(x1, y0) * ax;
+    float bottom = at(x0, y1) * (1 - ax) + at(x1, y1) * ax;
+    return top * (1 - ay) + bottom * ay;
+}
+
+int64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+/**
+ * Test class for the single-pass letterbox preprocessing kernel
+ */
+class LetterboxTest {
+public:
+    bool testGeometry() {
+        LOGD("=== Testing letterbox geometry ===");
+
+        letterbox_geometry_s landscape = compute_letterbox_geometry(1920, 1080, 640, 640);
+        if (landscape.resized_w != 640 || landscape.resized_h != 360 || landscape.pad_left != 0 ||
+            landscape.pad_top != 140 || std::fabs(landscape.scale - 1.f / 3) > 1e-6f) {
+            LOGE("1920x1080 -> 640x640: resized %dx%d pad %d,%d", landscape.resized_w, landscape.resized_h,
+                 landscape.pad_left, landscape.pad_top);
+            return false;
+        }
+        letterbox_geometry_s portrait = compute_letterbox_geometry(720, 1280, 640, 640);
+        if (portrait.resized_w != 360 || portrait.resized_h != 640 || portrait.pad_left != 140 ||
+            portrait.pad_top != 0) {
+            LOGE("720x1280 -> 640x640: resized %dx%d pad %d,%d", portrait.resized_w, portrait.resized_h,
+                 portrait.pad_left, portrait.pad_top);
+            return false;
+        }
+
+        // 模型坐标映射回原图，超出画面的部分被裁剪
+        float left = 0, top = 140, right = 640, bottom = 500;
+        letterbox_unmap_box(landscape, left, top, right, bottom);
+        if (std::fabs(left) > 0.01f || std::fabs(top) > 0.01f || std::fabs(right - 1920) > 0.01f ||
+            std::fabs(bottom - 1080) > 0.01f) {
+            LOGE("Unmapped box %.1f,%.1f,%.1f,%.1f", left, top, right, bottom);
+            return false;
+        }
+        left = 320, top = 100, right = 330, bottom = 320;
+        letterbox_unmap_box(landscape, left, top, right, bottom);
+        if (std::fabs(left - 960) > 0.01f || top != 0.f || std::fabs(bottom - 540) > 0.01f) {
+            LOGE("Box in padding not clipped: %.1f,%.1f,%.1f,%.1f", left, top, right, bottom);
+            return false;
+        }
+
+        LOGD("Letterbox geometry test passed");
+        return true;
+    }
+
+    bool testIdentityAndPadding() {
+        LOGD("=== Testing identity scale and padding ===");
+
+        // 640x360 RGB源无需缩放：内容逐字节相同，上下140行为填充值
+        const int width = 640, height = 360, stride = 640 * 3 + 32;
+        std::vector<uint8_t> image = makePackedImage(width, height, 3, stride, 1);
+        letterbox_geometry_s geometry = compute_letterbox_geometry(width, height, 640, 640);
+        TestTensor out(640, 640);
+        if (letterbox_into_tensor(makeFrame(image, width, height, stride, height, RK_FORMAT_RGB_888), geometry, 114,
+                                  out.tensor) != NN_SUCCESS) {
+            LOGE("letterbox_into_tensor failed");
+            return false;
+        }
+        for (int y = 0; y < 640; y++) {
+            for (int x = 0; x < 640; x++) {
+                const uint8_t *p = out.pixel(x, y);
+                bool inImage = y >= 140 && y < 500;
+                for (int c = 0; c < 3; c++) {
+                    uint8_t expected = inImage ? image[(y - 140) * stride + x * 3 + c] : 114;
+                    if (p[c] != expected) {
+                        LOGE("Pixel (%d,%d,%d) = %d, expected %d", x, y, c, p[c], expected);
+                        return false;
+                    }
+                }
+            }
+        }
+
+        LOGD("Identity and padding test passed");
+        return true;
+    }
+
+    bool testDownscaleAccuracy() {
+        LOGD("=== Testing RGBA/BGR downscale against float reference ===");
+
+        // 非整数缩放比，7位定点权重相对浮点双线性的误差不超过1.5
+        const int width = 1001, height = 563;
+        const int rgbaStride = (width + 64) * 4;
+        std::vector<uint8_t> rgba = makePackedImage(width, height, 4, rgbaStride, 2);
+        letterbox_geometry_s geometry = compute_letterbox_geometry(width, height, 640, 640);
+        TestTensor out(640, 640);
+        letterbox_into_tensor(makeFrame(rgba, width, height, rgbaStride, height, RK_FORMAT_RGBA_8888), geometry, 0,
+                              out.tensor);
+
+        float maxError = 0.f;
+        for (int dy = 0; dy < geometry.resized_h; dy++) {
+            for (int dx = 0; dx < geometry.resized_w; dx++) {
+                const uint8_t *p = out.pixel(dx + geometry.pad_left, dy + geometry.pad_top);
+                for (int c = 0; c < 3; c++) {
+                    float ref = referenceSample(rgba, width, height, rgbaStride, 4, c, dx, dy, geometry.resized_w,
+                                                geometry.resized_h);
+                    maxError = std::max(maxError, std::fabs(p[c] - ref));
+                }
+            }
+        }
+        LOGD("Max error vs float bilinear: %.2f", maxError);
+        if (maxError > 1.5f) {
+            LOGE("Downscale deviates from bilinear reference");
+            return false;
+        }
+
+        // 同一图像以BGR打包输入，输出必须与RGBA输入完全相同（RGB顺序）
+        const int bgrStride = width * 3;
+        std::vector<uint8_t> bgr(bgrStride * height);
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                const uint8_t *s = &rgba[y * rgbaStride + x * 4];
+                uint8_t *d = &bgr[y * bgrStride + x * 3];
+                d[0] = s[2];
+                d[1] = s[1];
+                d[2] = s[0];
+            }
+        }
+        TestTensor outBgr(640, 640);
+        letterbox_into_tensor(makeFrame(bgr, width, height, bgrStride, height, RK_FORMAT_BGR_888), geometry, 0,
+                              outBgr.tensor);
+        if (out.buffer != outBgr.buffer) {
+            LOGE("BGR source does not produce the same RGB tensor as RGBA");
+            return false;
+        }
+
+        LOGD("Downscale accuracy test passed");
+        return true;
+    }
+
+    bool testNv12Conversion() {
+        LOGD("=== Testing NV12 source conversion ===");
+
+        // 左半红色、右半蓝色的NV12帧（BT.601 limited），Y平面和UV平面都带stride填充
+        const int width = 640, height = 360, stride = 704, heightStride = 368;
+        std::vector<uint8_t> nv12(stride * heightStride * 3 / 2, 0xEE);
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                nv12[y * stride + x] = x < width / 2 ? 81 : 41;
+            }
+        }
+        uint8_t *uv = &nv12[stride * heightStride];
+        for (int y = 0; y < height / 2; y++) {
+            for (int x = 0; x < width / 2; x++) {
+                uv[y * stride + x * 2] = x < width / 4 ? 90 : 240;
+                uv[y * stride + x * 2 + 1] = x < width / 4 ? 240 : 110;
+            }
+        }
+
+        letterbox_geometry_s geometry = compute_letterbox_geometry(width, height, 640, 640);
+        TestTensor out(640, 640);
+        nn_error_e ret = letterbox_into_tensor(
+                makeFrame(nv12, width, height, stride, heightStride, RK_FORMAT_YCbCr_420_SP), geometry, 0, out.tensor);
+        if (ret != NN_SUCCESS) {
+            LOGE("NV12 letterbox failed: %d", ret);
+            return false;
+        }
+        const uint8_t *red = out.pixel(100, 320);
+        const uint8_t *blue = out.pixel(540, 320);
+        LOGD("red -> %d,%d,%d  blue -> %d,%d,%d", red[0], red[1], red[2], blue[0], blue[1], blue[2]);
+        if (red[0] < 250 || red[1] > 5 || red[2] > 5 || blue[0] > 5 || blue[1] > 5 || blue[2] < 250) {
+            LOGE("NV12 colour conversion wrong");
+            return false;
+        }
+        if (out.pixel(100, 100)[0] != 0 || out.pixel(100, 560)[2] != 0) {
+            LOGE("NV12 padding not written");
+            return false;
+        }
+
+        LOGD("NV12 conversion test passed");
+        return true;
+    }
+
+    bool testSimdMatchesScalar() {
+        LOGD("=== Testing %s kernel against scalar reference ===", letterbox_simd_name());
+
+        struct Case {
+            int width, height, stride, heightStride, format;
+        };
+        const Case cases[] = {
+                {1920, 1080, 1920, 1088, RK_FORMAT_YCbCr_420_SP},
+                {3840, 2160, 3840, 2160, RK_FORMAT_YCbCr_420_SP},
+                {1001, 567, 1024, 576, RK_FORMAT_YCbCr_420_SP},
+                {1920, 1080, 1920 * 4, 1088, RK_FORMAT_RGBA_8888},
+                {3840, 2160, 3840 * 4, 2160, RK_FORMAT_RGBA_8888},
+                {1001, 567, 1008 * 4, 567, RK_FORMAT_BGRA_8888},
+                {1279, 719, 1279 * 3, 719, RK_FORMAT_BGR_888},
+                {320, 180, 320 * 3, 180, RK_FORMAT_RGB_888},   // 放大
+        };
+        for (const Case &c : cases) {
+            bool nv12 = c.format == RK_FORMAT_YCbCr_420_SP;
+            std::vector<uint8_t> image = nv12 ? makePackedImage(c.stride, c.heightStride * 3 / 2, 1, c.stride, 7)
+                                              : makePackedImage(c.stride, c.height, 1, c.stride, 7);
+            image_frame_s frame = makeFrame(image, c.width, c.height, c.stride, c.heightStride, c.format);
+            letterbox_geometry_s geometry = compute_letterbox_geometry(c.width, c.height, 640, 640);
+            TestTensor simd(640, 640);
+            TestTensor scalar(640, 640);
+            letterbox_into_tensor(frame, geometry, 114, simd.tensor, LETTERBOX_IMPL_AUTO);
+            letterbox_into_tensor(frame, geometry, 114, scalar.tensor, LETTERBOX_IMPL_SCALAR);
+            if (simd.buffer != scalar.buffer) {
+                LOGE("%dx%d format 0x%x: SIMD output differs from scalar", c.width, c.height, c.format);
+                return false;
+            }
+        }
+
+        LOGD("SIMD/scalar bit-exactness test passed");
+        return true;
+    }
+
+    bool testMatchesOpenCvPath() {
+        LOGD("=== Testing bit-exactness against the OpenCV letterbox path ===");
+
+        // 1080p(1/3)和720p(1/2)缩放时两条路径的采样点都落在整数或半像素上，结果应逐位相同
+        const int sizes[][2] = {{1920, 1080}, {1280, 720}};
+        for (const auto &size : sizes) {
+            const int width = size[0], height = size[1];
+            std::vector<uint8_t> bgr = makePackedImage(width, height, 3, width * 3, 11);
+            cv::Mat img(height, width, CV_8UC3, bgr.data());
+
+            TestTensor legacy(640, 640);
+            cv::Mat padded;
+            LetterBoxInfo info;
+            if (letterbox(img, padded, 1.0f, info) != NN_SUCCESS ||
+                cvimg2tensor(padded, 640, 640, legacy.tensor) != NN_SUCCESS) {
+                LOGE("OpenCV path failed");
+                return false;
+            }
+
+            TestTensor fused(640, 640);
+            letterbox_into_tensor(makeFrame(bgr, width, height, width * 3, height, RK_FORMAT_BGR_888),
+                                  compute_letterbox_geometry(width, height, 640, 640), 0, fused.tensor);
+            if (legacy.buffer != fused.buffer) {
+                size_t diff = 0;
+                for (size_t i = 0; i < legacy.buffer.size(); i++) {
+                    diff += legacy.buffer[i] != fused.buffer[i];
+                }
+                LOGE("%dx%d: %zu bytes differ from the OpenCV path", width, height, diff);
+                return false;
+            }
+        }
+
+        // 非3通道输入返回错误而不是退出进程
+        cv::Mat gray(64, 64, CV_8UC1);
+        cv::Mat padded;
+        LetterBoxInfo info;
+        if (letterbox(gray, padded, 1.0f, info) != NN_IMAGE_FORMAT_UNSUPPORTED) {
+            LOGE("letterbox should reject a 1-channel image");
+            return false;
+        }
+
+        LOGD("OpenCV path bit-exactness test passed");
+        return true;
+    }
+
+    bool testInvalidInput() {
+        LOGD("=== Testing invalid letterbox input ===");
+
+        std::vector<uint8_t> image = makePackedImage(64, 64, 4, 256, 3);
+        letterbox_geometry_s geometry = compute_letterbox_geometry(64, 64, 640, 640);
+        TestTensor out(640, 640);
+        if (letterbox_into_tensor(makeFrame(image, 64, 64, 256, 64, RK_FORMAT_RGB_565), geometry, 0, out.tensor) !=
+            NN_IMAGE_FORMAT_UNSUPPORTED) {
+            LOGE("Unsupported format not rejected");
+            return false;
+        }
+        TestTensor small(320, 320);
+        if (letterbox_into_tensor(makeFrame(image, 64, 64, 256, 64, RK_FORMAT_RGBA_8888), geometry, 0, small.tensor) !=
+            NN_RKNN_INPUT_ATTR_ERROR) {
+            LOGE("Tensor size mismatch not rejected");
+            return false;
+        }
+
+        LOGD("Invalid input test passed");
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting Letterbox Tests");
+
+        int passedTests = 0;
+        int totalTests = 7;
+
+        if (testGeometry()) passedTests++;
+        if (testIdentityAndPadding()) passedTests++;
+        if (testDownscaleAccuracy()) passedTests++;
+        if (testNv12Conversion()) passedTests++;
+        if (testSimdMatchesScalar()) passedTests++;
+        if (testMatchesOpenCvPath()) passedTests++;
+        if (testInvalidInput()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+// Test runner function
+extern "C" void runLetterboxTests() {
+    LetterboxTest test;
+    test.runAllTests();
+}
+
+static double timeLetterbox(const image_frame_s &frame, letterbox_impl_e impl, tensor_data_s &tensor,
+                            int iterations) {
+    letterbox_geometry_s geometry = compute_letterbox_geometry(frame.width, frame.height, 640, 640);
+    int64_t start = nowUs();
+    for (int i = 0; i < iterations; i++) {
+        letterbox_into_tensor(frame, geometry, 0, tensor, impl);
+    }
+    return (nowUs() - start) / 1000.0 / iterations;
+}
+
+/**
+ * Benchmark: decoded 1080p and 4K frames to a 640x640 model input.
+ * Legacy is the previous RunWithFrameData chain: RGBA -> RGB copy (imcopy),
+ * letterbox (copyMakeBorder), cvtColor, cv::resize, memcpy into the tensor.
+ * The fused kernel is measured as scalar reference and with SIMD, from the
+ * same RGBA buffer and from NV12.
+ */
+extern "C" void runLetterboxBenchmark() {
+    LOGD("=== Letterbox preprocessing Benchmark (%s) ===", letterbox_simd_name());
+
+    const int sizes[][3] = {{1920, 1080, 1088}, {3840, 2160, 2160}};
+    const int iterations = 30;
+    TestTensor out(640, 640);
+
+    for (const auto &size : sizes) {
+        const int width = size[0], height = size[1], heightStride = size[2];
+        std::vector<uint8_t> rgba = makePackedImage(width, heightStride, 4, width * 4, 4);
+        std::vector<uint8_t> nv12 = makePackedImage(width, heightStride * 3 / 2, 1, width, 5);
+        image_frame_s rgbaFrame = makeFrame(rgba, width, height, width * 4, heightStride, RK_FORMAT_RGBA_8888);
+        image_frame_s nv12Frame = makeFrame(nv12, width, height, width, heightStride, RK_FORMAT_YCbCr_420_SP);
+
+        int64_t start = nowUs();
+        for (int i = 0; i < iterations; i++) {
+            cv::Mat origin(heightStride, width, CV_8UC3);
+            for (int y = 0; y < heightStride; y++) {
+                const uint8_t *s = &rgba[y * width * 4];
+                uint8_t *d = origin.ptr<uint8_t>(y);
+                for (int x = 0; x < width; x++) {
+                    d[x * 3] = s[x * 4];
+                    d[x * 3 + 1] = s[x * 4 + 1];
+                    d[x * 3 + 2] = s[x * 4 + 2];
+                }
+            }
+            cv::Mat padded;
+            LetterBoxInfo info;
+            letterbox(origin, padded, 1.0f, info);
+            cvimg2tensor(padded, 640, 640, out.tensor);
+        }
+        double legacyMs = (nowUs() - start) / 1000.0 / iterations;
+
+        LOGD("%dx%d -> 640x640, %d iterations", width, height, iterations);
+        LOGD("  legacy 5-pass (RGBA) : %6.2f ms/frame", legacyMs);
+        LOGD("  fused scalar  (RGBA) : %6.2f ms/frame", timeLetterbox(rgbaFrame, LETTERBOX_IMPL_SCALAR, out.tensor, iterations));
+        LOGD("  fused SIMD    (RGBA) : %6.2f ms/frame", timeLetterbox(rgbaFrame, LETTERBOX_IMPL_AUTO, out.tensor, iterations));
+        LOGD("  fused scalar  (NV12) : %6.2f ms/frame", timeLetterbox(nv12Frame, LETTERBOX_IMPL_SCALAR, out.tensor, iterations));
+        LOGD("  fused SIMD    (NV12) : %6.2f ms/frame", timeLetterbox(nv12Frame, LETTERBOX_IMPL_AUTO, out.tensor, iterations));
+    }
+}
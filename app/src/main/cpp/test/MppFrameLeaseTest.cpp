@@ -0,0 +1,239 @@
+#include "mpp_frame_lease.h"
+#include "FrameBufferPool.h"
+#include "FrameConverter.h"
+#include "user_comm.h"
+#include "log4c.h"
+#include "rga.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+mpp_frame_info_s makeInfo(void* data, int width, int height) {
+    mpp_frame_info_s info;
+    info.width_stride = width;
+    info.height_stride = height;
+    info.width = width;
+    info.height = height;
+    info.format = MPP_FMT_YUV420SP;
+    info.fd = -1;
+    info.data = data;
+    info.pts = 0;
+    return info;
+}
+
+// 与解码回调一致：帧数据直接引用租约内存
+std::shared_ptr<frame_data_t> wrapLease(const std::shared_ptr<FrameBufferPool>& pool,
+                                        const std::shared_ptr<MppFrameLease>& lease) {
+    auto frame = pool->acquireFrame();
+    const mpp_frame_info_s& info = lease->Info();
+    frame->data = FrameBuffer(lease->Data(), FrameBufferDeleter(lease));
+    frame->dataSize = lease->Size();
+    frame->screenW = info.width;
+    frame->screenH = info.height;
+    frame->screenStride = info.width_stride;
+    frame->widthStride = info.width_stride;
+    frame->heightStride = info.height_stride;
+    frame->frameFormat = RK_FORMAT_YCbCr_420_SP;
+    return frame;
+}
+
+}  // namespace
+
+/**
+ * Tests for decoder buffer leases: the limiter's backpressure and drop
+ * accounting, release from consumer threads, leases wrapped in pooled
+ * frames being returned when the last frame reference goes away, and the
+ * copy fallback once the pipeline holds more frames than there are leases.
+ * Leases here carry a NULL MppBuffer, so no MPP buffer group is needed.
+ */
+class MppFrameLeaseTest {
+public:
+    bool testLimiterAccounting() {
+        LOGD("=== Testing lease limiter accounting ===");
+
+        MppFrameLeaseLimiter limiter(2);
+        if (!limiter.Acquire(0) || !limiter.Acquire(0)) {
+            LOGE("Could not take leases below the limit");
+            return false;
+        }
+        if (limiter.Acquire(5)) {
+            LOGE("Lease granted above the limit");
+            return false;
+        }
+        if (limiter.Outstanding() != 2 || limiter.Leased() != 2 || limiter.Dropped() != 1 || limiter.Waited() != 0) {
+            LOGE("Unexpected counts: outstanding %d leased %llu dropped %llu", limiter.Outstanding(),
+                 (unsigned long long) limiter.Leased(), (unsigned long long) limiter.Dropped());
+            return false;
+        }
+        limiter.Release();
+        if (!limiter.Acquire(0) || limiter.WaitIdle(5)) {
+            LOGE("Released slot was not reusable, or idle reported with leases outstanding");
+            return false;
+        }
+        limiter.Release();
+        limiter.Release();
+        if (!limiter.WaitIdle(0) || limiter.Outstanding() != 0) {
+            LOGE("Limiter not idle after all leases were released");
+            return false;
+        }
+
+        LOGD("Lease limiter accounting test PASSED");
+        return true;
+    }
+
+    bool testCrossThreadRelease() {
+        LOGD("=== Testing backpressure released from another thread ===");
+
+        auto limiter = std::make_shared<MppFrameLeaseLimiter>(1);
+        std::vector<char> pixels(64 * 64 * 3 / 2);
+        limiter->Acquire(0);
+        auto lease = std::make_shared<MppFrameLease>(nullptr, makeInfo(pixels.data(), 64, 64), limiter);
+
+        // 消费线程稍后释放租约，解码线程应等到名额而不是丢帧
+        std::thread consumer([&lease]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            lease.reset();
+        });
+        bool acquired = limiter->Acquire(2000);
+        consumer.join();
+
+        if (!acquired || limiter->Waited() != 1 || limiter->Dropped() != 0) {
+            LOGE("Decoder side did not wait for the release: acquired %d waited %llu", acquired,
+                 (unsigned long long) limiter->Waited());
+            return false;
+        }
+        limiter->Release();
+
+        LOGD("Cross-thread release test PASSED");
+        return true;
+    }
+
+    bool testLeaseInPooledFrame() {
+        LOGD("=== Testing lease lifetime inside pooled frames ===");
+
+        auto pool = FrameBufferPool::create();
+        auto limiter = std::make_shared<MppFrameLeaseLimiter>(4);
+        std::vector<char> pixels(64 * 64 * 3 / 2, 0x10);
+
+        limiter->Acquire(0);
+        std::shared_ptr<frame_data_t> frame =
+                wrapLease(pool, std::make_shared<MppFrameLease>(nullptr, makeInfo(pixels.data(), 64, 64), limiter));
+        if (frame->data.get() != pixels.data() || frame->dataSize != (long) pixels.size()) {
+            LOGE("Frame does not point at the leased memory");
+            return false;
+        }
+        if (!frame->data.get_deleter().borrowed() || FrameConverter::isWritable(*frame)) {
+            LOGE("Leased frame is not marked borrowed");
+            return false;
+        }
+
+        // 推理和显示各持有一个引用，最后一个释放时才归还
+        std::shared_ptr<frame_data_t> displayRef = frame;
+        frame.reset();
+        if (limiter->Outstanding() != 1) {
+            LOGE("Lease returned while the display still held the frame");
+            return false;
+        }
+        displayRef.reset();
+        if (limiter->Outstanding() != 0 || pixels[0] != 0x10) {
+            LOGE("Lease not returned (outstanding %d) or borrowed memory touched", limiter->Outstanding());
+            return false;
+        }
+
+        // 回收的frame_data_t重新使用时不能残留租约
+        auto recycled = pool->acquireFrame();
+        if (recycled->data || pool->getStats().buffersInUse != 0) {
+            LOGE("Recycled frame still references the lease");
+            return false;
+        }
+
+        LOGD("Lease in pooled frame test PASSED");
+        return true;
+    }
+
+    bool testPipelinePastLeaseLimit() {
+        LOGD("=== Testing a pipeline holding more frames than leases ===");
+
+        // 调度队列4帧 + 推理中1帧 + 渲染队列8帧 + 显示中1帧，都比默认的8个名额多
+        const int inFlight = 14;
+        auto pool = FrameBufferPool::create();
+        auto limiter = std::make_shared<MppFrameLeaseLimiter>(8);
+        std::vector<char> pixels(64 * 64 * 3 / 2, 0x20);
+        std::vector<std::shared_ptr<frame_data_t>> pipeline;
+
+        // 与解码器取帧一致：有名额借出，名额用完拷贝进池缓冲，不等待也不丢帧
+        for (int i = 0; i < inFlight; i++) {
+            MppFrameHandoff handoff = limiter->Handoff(true, 40);
+            if (handoff == MPP_FRAME_LEASED) {
+                pipeline.push_back(wrapLease(pool, std::make_shared<MppFrameLease>(
+                        nullptr, makeInfo(pixels.data(), 64, 64), limiter)));
+            } else if (handoff == MPP_FRAME_COPIED) {
+                auto frame = pool->acquireFrame();
+                frame->data = pool->acquire(FrameBufferKey(64, 64, RK_FORMAT_YCbCr_420_SP, 64), pixels.size());
+                memcpy(frame->data.get(), pixels.data(), pixels.size());
+                frame->dataSize = (long) pixels.size();
+                pipeline.push_back(frame);
+            } else {
+                LOGE("Frame %d dropped with %d leases outstanding", i, limiter->Outstanding());
+                return false;
+            }
+        }
+        if ((int) pipeline.size() != inFlight || limiter->Leased() != 8 || limiter->Copied() != inFlight - 8 ||
+            limiter->Waited() != 0 || limiter->Dropped() != 0) {
+            LOGE("Unexpected handoff: leased %llu copied %llu waited %llu dropped %llu",
+                 (unsigned long long) limiter->Leased(), (unsigned long long) limiter->Copied(),
+                 (unsigned long long) limiter->Waited(), (unsigned long long) limiter->Dropped());
+            return false;
+        }
+        if (pipeline.back()->data.get_deleter().borrowed() || pipeline.back()->data.get() == pixels.data()) {
+            LOGE("Copied frame still references decoder memory");
+            return false;
+        }
+
+        // 下游放掉最早的帧后，后续帧重新走租约
+        pipeline.erase(pipeline.begin());
+        if (limiter->Handoff(true, 40) != MPP_FRAME_LEASED) {
+            LOGE("Released lease was not reused");
+            return false;
+        }
+        limiter->Release();
+        pipeline.clear();
+        if (!limiter->WaitIdle(0)) {
+            LOGE("Leases outstanding after the pipeline drained: %d", limiter->Outstanding());
+            return false;
+        }
+
+        LOGD("Pipeline past lease limit test PASSED");
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting MPP Frame Lease Tests");
+
+        int passedTests = 0;
+        int totalTests = 4;
+
+        if (testLimiterAccounting()) passedTests++;
+        if (testCrossThreadRelease()) passedTests++;
+        if (testLeaseInPooledFrame()) passedTests++;
+        if (testPipelinePastLeaseLimit()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+extern "C" void runMppFrameLeaseTests() {
+    MppFrameLeaseTest test;
+    test.runAllTests();
+}
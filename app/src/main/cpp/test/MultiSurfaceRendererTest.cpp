@@ -0,0 +1,409 @@
+#include "MultiSurfaceRenderer.h"
+#include "log4c.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Busy for costUs, as a conversion into the window buffer would be
+void spinFor(int64_t costUs) {
+    int64_t endUs = PresentationClock::nowUs() + costUs;
+    while (PresentationClock::nowUs() < endUs) {
+    }
+}
+
+struct Presentation {
+    int source;
+    int64_t deadlineUs;
+    int64_t presentedUs;
+};
+
+/**
+ * A channel with count frames due every intervalUs from startUs. Presenting
+ * takes costUs (slept, or spun when spin is set). Records every presentation
+ * in a shared log and fails the test on overlapping calls or calls after
+ * the source was removed.
+ */
+class FakeSource : public PresentSource {
+public:
+    FakeSource(int id, int64_t startUs, int64_t intervalUs, int count, int64_t costUs,
+               std::vector<Presentation>* log, std::mutex* logMutex, bool spin = false)
+        : m_id(id), m_startUs(startUs), m_intervalUs(intervalUs), m_count(count), m_costUs(costUs), m_spin(spin),
+          m_next(0), m_pending(-1), m_log(log), m_logMutex(logMutex), m_inCall(0), m_presented(0), m_dropped(0),
+          m_overlap(false), m_retired(false), m_calledAfterRetire(false) {}
+
+    bool nextFrame(int64_t nowUs, int64_t& timeUs, int& /*droppedFrames*/) override {
+        Call call(*this);
+        if (m_next >= m_count) {
+            timeUs = nowUs + 5000;
+            return false;
+        }
+        m_pending = m_next++;
+        timeUs = deadline(m_pending);
+        return true;
+    }
+
+    bool presentFrame() override {
+        Call call(*this);
+        if (m_costUs > 0) {
+            if (m_spin) {
+                spinFor(m_costUs);
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(m_costUs));
+            }
+        }
+        std::lock_guard<std::mutex> lock(*m_logMutex);
+        m_log->push_back(Presentation{m_id, deadline(m_pending), PresentationClock::nowUs()});
+        m_presented++;
+        return true;
+    }
+
+    void dropFrame() override {
+        Call call(*this);
+        m_dropped++;
+    }
+
+    int64_t deadline(int frame) const { return m_startUs + frame * m_intervalUs; }
+    bool finished() const { return m_presented + m_dropped >= m_count; }
+    int presented() const { return m_presented; }
+    int dropped() const { return m_dropped; }
+    bool overlapped() const { return m_overlap; }
+    void retire() { m_retired = true; }
+    bool calledAfterRetire() const { return m_calledAfterRetire; }
+
+private:
+    // Flags calls that overlap, or that come after retire()
+    struct Call {
+        explicit Call(FakeSource& source) : m_source(source) {
+            if (m_source.m_inCall.fetch_add(1) != 0) {
+                m_source.m_overlap = true;
+            }
+            if (m_source.m_retired) {
+                m_source.m_calledAfterRetire = true;
+            }
+        }
+        ~Call() { m_source.m_inCall.fetch_sub(1); }
+        FakeSource& m_source;
+    };
+
+    int m_id;
+    int64_t m_startUs;
+    int64_t m_intervalUs;
+    int m_count;
+    int64_t m_costUs;
+    bool m_spin;
+    int m_next;
+    int m_pending;
+    std::vector<Presentation>* m_log;
+    std::mutex* m_logMutex;
+    std::atomic<int> m_inCall;
+    std::atomic<int> m_presented;
+    std::atomic<int> m_dropped;
+    std::atomic<bool> m_overlap;
+    std::atomic<bool> m_retired;
+    std::atomic<bool> m_calledAfterRetire;
+};
+
+typedef std::vector<std::unique_ptr<FakeSource>> Sources;
+
+// Wait until every source has presented or dropped all its frames
+bool waitFinished(const Sources& sources, int timeoutMs) {
+    int64_t endUs = PresentationClock::nowUs() + timeoutMs * 1000LL;
+    while (PresentationClock::nowUs() < endUs) {
+        bool done = true;
+        for (const auto& source : sources) {
+            done = done && source->finished();
+        }
+        if (done) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    return false;
+}
+
+bool anyOverlap(const Sources& sources) {
+    for (const auto& source : sources) {
+        if (source->overlapped()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+class MultiSurfaceRendererTest {
+public:
+    // One thread, three channels with interleaved deadlines: frames are shown in deadline order, never early
+    bool testDeadlineOrder() {
+        LOGD("Testing deadline order...");
+
+        std::vector<Presentation> log;
+        std::mutex logMutex;
+        Sources sources;
+        {
+            MultiSurfaceRenderer renderer(4, 1);
+            int64_t startUs = PresentationClock::nowUs() + 20000;
+            for (int i = 0; i < 3; i++) {
+                sources.emplace_back(new FakeSource(i, startUs + i * 3000, 10000, 20, 0, &log, &logMutex));
+                renderer.addSource(i, sources.back().get());
+            }
+            if (!waitFinished(sources, 2000)) {
+                LOGE("Sources did not finish");
+                return false;
+            }
+
+            uint64_t onTime = 0;
+            for (int i = 0; i < 3; i++) {
+                MultiSurfaceRenderer::PresentStats stats;
+                if (!renderer.getPresentStats(i, stats) || stats.onTime + stats.late + stats.dropped != 20 ||
+                    stats.failed != 0) {
+                    LOGE("Channel %d: stats do not add up to 20 frames", i);
+                    return false;
+                }
+                onTime += stats.onTime;
+            }
+            // Generous for a loaded host; the deadlines are 3 ms apart
+            if (onTime < 50) {
+                LOGE("Only %llu of 60 frames on time", (unsigned long long) onTime);
+                return false;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(logMutex);
+        for (size_t i = 0; i < log.size(); i++) {
+            if (log[i].presentedUs < log[i].deadlineUs) {
+                LOGE("Channel %d presented %lld us before its deadline", log[i].source,
+                     (long long) (log[i].deadlineUs - log[i].presentedUs));
+                return false;
+            }
+            if (i > 0 && log[i].deadlineUs < log[i - 1].deadlineUs) {
+                LOGE("Presentation %zu out of deadline order", i);
+                return false;
+            }
+        }
+
+        LOGD("Deadline order test passed (%zu presentations)", log.size());
+        return true;
+    }
+
+    // A channel whose presentation blocks the only thread makes the other miss deadlines: dropped with
+    // skip-if-late, shown late without it
+    bool testSkipIfLate() {
+        LOGD("Testing skip-if-late...");
+
+        for (int skip = 1; skip >= 0; skip--) {
+            std::vector<Presentation> log;
+            std::mutex logMutex;
+            Sources sources;
+            MultiSurfaceRenderer renderer(4, 1);
+            int64_t startUs = PresentationClock::nowUs() + 20000;
+            sources.emplace_back(new FakeSource(0, startUs, 40000, 5, 35000, &log, &logMutex));
+            sources.emplace_back(new FakeSource(1, startUs + 1000, 5000, 40, 0, &log, &logMutex));
+            renderer.addSource(0, sources[0].get());
+            renderer.addSource(1, sources[1].get());
+            renderer.setSkipIfLate(1, skip != 0);
+            if (!waitFinished(sources, 3000)) {
+                LOGE("Sources did not finish (skip %d)", skip);
+                return false;
+            }
+
+            MultiSurfaceRenderer::PresentStats stats;
+            renderer.getPresentStats(1, stats);
+            LOGD("skip-if-late %d: on time %llu, late %llu, dropped %llu", skip, (unsigned long long) stats.onTime,
+                 (unsigned long long) stats.late, (unsigned long long) stats.dropped);
+            if (stats.onTime + stats.late + stats.dropped != 40) {
+                LOGE("Stats do not add up to 40 frames");
+                return false;
+            }
+            if (skip && (stats.dropped == 0 || stats.late != 0 || sources[1]->dropped() == 0)) {
+                LOGE("Late frames were not skipped");
+                return false;
+            }
+            if (!skip && (stats.dropped != 0 || stats.late == 0)) {
+                LOGE("Late frames were skipped with skip-if-late off");
+                return false;
+            }
+        }
+
+        LOGD("Skip-if-late test passed");
+        return true;
+    }
+
+    // Two threads; a slow channel holds its thread, the other thread takes over the channels queued behind it
+    bool testWorkStealing() {
+        LOGD("Testing work stealing...");
+
+        std::vector<Presentation> log;
+        std::mutex logMutex;
+        Sources sources;
+        MultiSurfaceRenderer renderer(8, 2);
+        int64_t startUs = PresentationClock::nowUs() + 20000;
+        sources.emplace_back(new FakeSource(0, startUs, 20000, 15, 18000, &log, &logMutex));
+        for (int i = 1; i < 4; i++) {
+            sources.emplace_back(new FakeSource(i, startUs + i * 1000, 20000, 15, 500, &log, &logMutex));
+        }
+        for (int i = 0; i < 4; i++) {
+            renderer.addSource(i, sources[i].get());
+        }
+        if (!waitFinished(sources, 3000)) {
+            LOGE("Sources did not finish");
+            return false;
+        }
+        if (anyOverlap(sources)) {
+            LOGE("A source was serviced by two threads at once");
+            return false;
+        }
+
+        uint64_t onTime = 0;
+        for (int i = 1; i < 4; i++) {
+            MultiSurfaceRenderer::PresentStats stats;
+            renderer.getPresentStats(i, stats);
+            onTime += stats.onTime;
+        }
+        LOGD("Stolen %llu times, fast channels on time %llu/45", (unsigned long long) renderer.getStolenCount(),
+             (unsigned long long) onTime);
+        if (renderer.getStolenCount() == 0 || onTime < 35) {
+            LOGE("Channels stuck behind the slow one were not taken over");
+            return false;
+        }
+
+        LOGD("Work stealing test passed");
+        return true;
+    }
+
+    // After removeSurface returns the source is never called again, even if it was being presented
+    bool testRemoveSource() {
+        LOGD("Testing source removal...");
+
+        std::vector<Presentation> log;
+        std::mutex logMutex;
+        Sources sources;
+        MultiSurfaceRenderer renderer(4, 2);
+        int64_t startUs = PresentationClock::nowUs();
+        sources.emplace_back(new FakeSource(0, startUs, 2000, 1000, 3000, &log, &logMutex));
+        renderer.addSource(0, sources[0].get());
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+
+        if (!renderer.removeSurface(0)) {
+            LOGE("removeSurface failed");
+            return false;
+        }
+        sources[0]->retire();
+        int presented = sources[0]->presented();
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+
+        MultiSurfaceRenderer::PresentStats stats;
+        if (sources[0]->calledAfterRetire() || sources[0]->presented() != presented || presented == 0 ||
+            renderer.getPresentStats(0, stats) || renderer.removeSurface(0)) {
+            LOGE("Source still in use after removal (%d presented)", presented);
+            return false;
+        }
+
+        LOGD("Source removal test passed (%d presented)", presented);
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting Multi-Surface Renderer Tests");
+
+        int passedTests = 0;
+        int totalTests = 4;
+
+        if (testDeadlineOrder()) passedTests++;
+        if (testSkipIfLate()) passedTests++;
+        if (testWorkStealing()) passedTests++;
+        if (testRemoveSource()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+extern "C" void runMultiSurfaceRendererTests() {
+    MultiSurfaceRendererTest test;
+    test.runAllTests();
+}
+
+/**
+ * Benchmark: numChannels channels at 25 fps for numFrames frames, each
+ * presentation spinning renderUs of CPU. "Before" is one display thread per
+ * channel sleeping until each deadline, as ZLPlayer::display did; "after" is
+ * the shared pool of renderThreads threads. Lateness is presentation end
+ * minus deadline.
+ */
+extern "C" void runMultiSurfaceRendererBenchmark(int numChannels, int numFrames, int renderUs, int renderThreads) {
+    const int64_t intervalUs = 40000;
+    for (int pass = 0; pass < 2; pass++) {
+        std::vector<Presentation> log;
+        std::mutex logMutex;
+        Sources sources;
+        int64_t startUs = PresentationClock::nowUs() + 50000;
+        for (int i = 0; i < numChannels; i++) {
+            // Cameras are not in phase with each other
+            sources.emplace_back(new FakeSource(i, startUs + (intervalUs * i) / numChannels, intervalUs, numFrames,
+                                                renderUs, &log, &logMutex, true));
+        }
+
+        int threads = 0;
+        if (pass == 0) {
+            std::vector<std::thread> displayThreads;
+            for (int i = 0; i < numChannels; i++) {
+                FakeSource* source = sources[i].get();
+                displayThreads.emplace_back([source]() {
+                    while (!source->finished()) {
+                        int64_t nowUs = PresentationClock::nowUs();
+                        int64_t timeUs = nowUs;
+                        int dropped = 0;
+                        bool ready = source->nextFrame(nowUs, timeUs, dropped);
+                        if (timeUs > nowUs) {
+                            std::this_thread::sleep_for(std::chrono::microseconds(timeUs - nowUs));
+                        }
+                        if (ready) {
+                            source->presentFrame();
+                        }
+                    }
+                });
+            }
+            for (auto& thread : displayThreads) {
+                thread.join();
+            }
+            threads = numChannels;
+        } else {
+            MultiSurfaceRenderer renderer(numChannels, renderThreads);
+            for (int i = 0; i < numChannels; i++) {
+                renderer.addSource(i, sources[i].get());
+                renderer.setSkipIfLate(i, false);
+            }
+            waitFinished(sources, numFrames * 100 + 5000);
+            threads = renderThreads;
+        }
+
+        std::vector<double> latenessMs;
+        for (const Presentation& p : log) {
+            latenessMs.push_back((p.presentedUs - p.deadlineUs) / 1000.0);
+        }
+        std::sort(latenessMs.begin(), latenessMs.end());
+        double sum = 0.0;
+        for (double ms : latenessMs) {
+            sum += ms;
+        }
+        size_t n = latenessMs.size();
+        LOGD("MultiSurfaceRenderer benchmark %s: %d channels on %d threads, %zu presented, lateness mean %.2f ms, "
+             "p95 %.2f ms, max %.2f ms", pass == 0 ? "before (thread per channel)" : "after (render pool)",
+             numChannels, threads, n, n ? sum / n : 0.0, n ? latenessMs[n * 95 / 100] : 0.0,
+             n ? latenessMs[n - 1] : 0.0);
+    }
+}
@@ -0,0 +1,455 @@
+#include "nms.h"
+#include "log4c.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+namespace {
+
+struct BoxSet {
+    std::vector<float> boxes; // x, y, w, h
+    std::vector<float> scores;
+    std::vector<int> classes;
+
+    void add(float x, float y, float w, float h, float score, int cls) {
+        boxes.push_back(x);
+        boxes.push_back(y);
+        boxes.push_back(w);
+        boxes.push_back(h);
+        scores.push_back(score);
+        classes.push_back(cls);
+    }
+
+    int size() const { return (int) scores.size(); }
+};
+
+float uniform(float lo, float hi) {
+    return lo + (hi - lo) * (float) rand() / (float) RAND_MAX;
+}
+
+// 围绕若干目标中心抖动生成候选框，模拟检测头对同一目标输出的多个重叠框
+BoxSet makeClusteredBoxes(int count, int numClasses, unsigned seed) {
+    BoxSet set;
+    srand(seed);
+    int clusters = std::max(1, count / 20);
+    std::vector<float> cx(clusters), cy(clusters), cw(clusters), ch(clusters);
+    std::vector<int> cc(clusters);
+    for (int c = 0; c < clusters; c++) {
+        cw[c] = uniform(16, 200);
+        ch[c] = uniform(16, 200);
+        cx[c] = uniform(0, 640 - cw[c]);
+        cy[c] = uniform(0, 640 - ch[c]);
+        cc[c] = rand() % numClasses;
+    }
+    for (int i = 0; i < count; i++) {
+        int c = rand() % clusters;
+        float jitter = 0.15f;
+        float w = cw[c] * uniform(1 - jitter, 1 + jitter);
+        float h = ch[c] * uniform(1 - jitter, 1 + jitter);
+        float x = cx[c] + cw[c] * uniform(-jitter, jitter);
+        float y = cy[c] + ch[c] * uniform(-jitter, jitter);
+        int cls = rand() % 8 == 0 ? rand() % numClasses : cc[c];
+        set.add(x, y, w, h, uniform(0.3f, 1.f), cls);
+    }
+    return set;
+}
+
+float referenceIou(const float *a, const float *b) {
+    float ax2 = a[0] + a[2], ay2 = a[1] + a[3], bx2 = b[0] + b[2], by2 = b[1] + b[3];
+    float w = std::max(0.f, std::min(ax2, bx2) - std::max(a[0], b[0]) + 1.f);
+    float h = std::max(0.f, std::min(ay2, by2) - std::max(a[1], b[1]) + 1.f);
+    float inter = w * h;
+    float uni = (ax2 - a[0] + 1.f) * (ay2 - a[1] + 1.f) + (bx2 - b[0] + 1.f) * (by2 - b[1] + 1.f) - inter;
+    return uni <= 0.f ? 0.f : inter / uni;
+}
+
+// 教科书式贪心NMS：全部框按分数排序，逐个保留并抑制同类重叠框
+std::vector<int> referenceHardNms(const BoxSet &set, float threshold, bool agnostic) {
+    std::vector<int> order(set.size());
+    for (int i = 0; i < set.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&set](int a, int b) { return set.scores[a] > set.scores[b]; });
+    std::vector<bool> removed(set.size(), false);
+    std::vector<int> keep;
+    for (size_t i = 0; i < order.size(); i++) {
+        int n = order[i];
+        if (removed[n]) {
+            continue;
+        }
+        keep.push_back(n);
+        for (size_t j = i + 1; j < order.size(); j++) {
+            int m = order[j];
+            if (!removed[m] && (agnostic || set.classes[m] == set.classes[n]) &&
+                referenceIou(&set.boxes[n * 4], &set.boxes[m * 4]) > threshold) {
+                removed[m] = true;
+            }
+        }
+    }
+    return keep;
+}
+
+// 改写前post_process中的实现（递归快排 + std::set + 每类全量扫描，含classIds[i]错误），仅用于基准对比
+int legacyQuickSort(std::vector<float> &input, int left, int right, std::vector<int> &indices) {
+    float key;
+    int key_index;
+    int low = left;
+    int high = right;
+    if (left < right) {
+        key_index = indices[left];
+        key = input[left];
+        while (low < high) {
+            while (low < high && input[high] <= key) {
+                high--;
+            }
+            input[low] = input[high];
+            indices[low] = indices[high];
+            while (low < high && input[low] >= key) {
+                low++;
+            }
+            input[high] = input[low];
+            indices[high] = indices[low];
+        }
+        input[low] = key;
+        indices[low] = key_index;
+        legacyQuickSort(input, left, low - 1, indices);
+        legacyQuickSort(input, low + 1, right, indices);
+    }
+    return low;
+}
+
+int legacyNms(const BoxSet &set, float threshold) {
+    int validCount = set.size();
+    std::vector<float> probs = set.scores;
+    std::vector<int> order(validCount);
+    for (int i = 0; i < validCount; i++) {
+        order[i] = i;
+    }
+    legacyQuickSort(probs, 0, validCount - 1, order);
+    std::set<int> class_set(set.classes.begin(), set.classes.end());
+    for (int c : class_set) {
+        std::vector<int> classIds = set.classes; // 原实现按值传参
+        for (int i = 0; i < validCount; ++i) {
+            if (order[i] == -1 || classIds[i] != c) {
+                continue;
+            }
+            int n = order[i];
+            for (int j = i + 1; j < validCount; ++j) {
+                int m = order[j];
+                if (m == -1 || classIds[i] != c) {
+                    continue;
+                }
+                if (referenceIou(&set.boxes[n * 4], &set.boxes[m * 4]) > threshold) {
+                    order[j] = -1;
+                }
+            }
+        }
+    }
+    int kept = 0;
+    for (int i = 0; i < validCount; i++) {
+        kept += order[i] != -1;
+    }
+    return kept;
+}
+
+nms_config_s makeConfig(nms_mode_e mode, int topK, int maxOutput) {
+    nms_config_s config = nms_default_config();
+    config.mode = mode;
+    config.top_k = topK;
+    config.max_output = maxOutput;
+    return config;
+}
+
+int runNms(const nms_config_s &config, const BoxSet &set, nms_workspace_t &ws) {
+    return nms_run(config, set.boxes.data(), set.scores.data(), set.classes.data(), set.size(), &ws);
+}
+
+bool sortedByScore(const nms_workspace_t &ws) {
+    for (size_t i = 1; i < ws.keep_score.size(); i++) {
+        if (ws.keep_score[i] > ws.keep_score[i - 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+/**
+ * Test class for the NMS module (bucketed hard NMS, Soft/Fast/Matrix modes)
+ */
+class NmsTest {
+public:
+    bool testHardMatchesReference() {
+        LOGD("=== Testing hard NMS against reference greedy NMS ===");
+
+        nms_workspace_t ws;
+        const int counts[] = {1, 7, 50, 500, 2000};
+        const int classCounts[] = {1, 3, 80};
+        for (int count : counts) {
+            for (int classes : classCounts) {
+                for (int agnostic = 0; agnostic < 2; agnostic++) {
+                    BoxSet set = makeClusteredBoxes(count, classes, count * 31 + classes);
+                    nms_config_s config = makeConfig(NMS_MODE_HARD, 0, 0);
+                    config.class_agnostic = agnostic != 0;
+                    std::vector<int> expected = referenceHardNms(set, config.iou_threshold, config.class_agnostic);
+                    runNms(config, set, ws);
+                    if (ws.keep != expected) {
+                        LOGE("%d boxes, %d classes, agnostic %d: kept %zu, reference %zu", count, classes, agnostic,
+                             ws.keep.size(), expected.size());
+                        return false;
+                    }
+                }
+            }
+        }
+
+        LOGD("Hard NMS reference test passed");
+        return true;
+    }
+
+    bool testClassesAreIndependent() {
+        LOGD("=== Testing per-class suppression ===");
+
+        // 两个几乎重合的框属于不同类别：都应保留（原实现因classIds[i]错误会误删）
+        BoxSet set;
+        set.add(100, 100, 50, 80, 0.9f, 0);
+        set.add(102, 101, 50, 80, 0.8f, 1);
+        set.add(101, 100, 50, 80, 0.7f, 0);
+        nms_workspace_t ws;
+        runNms(makeConfig(NMS_MODE_HARD, 0, 0), set, ws);
+        if (ws.keep != std::vector<int>({0, 1})) {
+            LOGE("Per-class NMS kept %zu boxes, expected {0, 1}", ws.keep.size());
+            return false;
+        }
+
+        nms_config_s agnostic = makeConfig(NMS_MODE_HARD, 0, 0);
+        agnostic.class_agnostic = true;
+        runNms(agnostic, set, ws);
+        if (ws.keep != std::vector<int>({0})) {
+            LOGE("Class-agnostic NMS kept %zu boxes, expected {0}", ws.keep.size());
+            return false;
+        }
+
+        LOGD("Per-class suppression test passed");
+        return true;
+    }
+
+    bool testTopKAndMaxOutput() {
+        LOGD("=== Testing top-K pre-selection and max output ===");
+
+        // 互不重叠的框：NMS不删除任何框，结果只受top_k / max_output限制
+        BoxSet set;
+        for (int i = 0; i < 100; i++) {
+            set.add((float) (i % 10) * 64, (float) (i / 10) * 64, 40, 40, (float) ((i * 37) % 100) / 100.f, i % 3);
+        }
+        nms_workspace_t ws;
+        if (runNms(makeConfig(NMS_MODE_HARD, 30, 0), set, ws) != 30 || !sortedByScore(ws) ||
+            ws.keep_score.back() != 0.70f) {
+            LOGE("top_k 30: kept %zu, lowest score %f", ws.keep.size(), ws.keep_score.empty() ? 0 : ws.keep_score.back());
+            return false;
+        }
+        if (runNms(makeConfig(NMS_MODE_HARD, 0, 10), set, ws) != 10 || ws.keep_score[0] != 0.99f ||
+            ws.keep_score[9] != 0.90f) {
+            LOGE("max_output 10: kept %zu", ws.keep.size());
+            return false;
+        }
+
+        // 关闭NMS：重叠框全部保留，只排序截取
+        BoxSet overlapping;
+        for (int i = 0; i < 20; i++) {
+            overlapping.add(100 + i, 100, 50, 50, 0.5f + i * 0.01f, 0);
+        }
+        nms_config_s disabled = makeConfig(NMS_MODE_HARD, 0, 15);
+        disabled.enabled = false;
+        if (runNms(disabled, overlapping, ws) != 15 || ws.keep[0] != 19 || !sortedByScore(ws)) {
+            LOGE("Disabled NMS kept %zu, first %d", ws.keep.size(), ws.keep.empty() ? -1 : ws.keep[0]);
+            return false;
+        }
+
+        LOGD("Top-K / max output test passed");
+        return true;
+    }
+
+    bool testSoftNms() {
+        LOGD("=== Testing Soft-NMS ===");
+
+        BoxSet set;
+        set.add(100, 100, 100, 100, 0.9f, 0);
+        set.add(120, 100, 100, 100, 0.8f, 0);
+        set.add(400, 400, 50, 50, 0.6f, 0);
+        nms_config_s config = makeConfig(NMS_MODE_SOFT, 0, 0);
+        nms_workspace_t ws;
+        if (runNms(config, set, ws) != 3 || !sortedByScore(ws)) {
+            LOGE("Soft-NMS kept %zu boxes", ws.keep.size());
+            return false;
+        }
+        float iou = referenceIou(&set.boxes[0], &set.boxes[4]);
+        float decayed = 0.8f * expf(-(iou * iou) / config.sigma);
+        // 0.8衰减后低于0.6，排在不重叠的框之后
+        if (ws.keep != std::vector<int>({0, 2, 1}) || std::fabs(ws.keep_score[2] - decayed) > 1e-6f ||
+            ws.keep_score[1] != 0.6f) {
+            LOGE("Soft-NMS scores %f %f %f, expected decayed %f", ws.keep_score[0], ws.keep_score[1],
+                 ws.keep_score[2], decayed);
+            return false;
+        }
+
+        // 衰减后低于score_threshold的框被丢弃
+        config.score_threshold = 0.5f;
+        if (runNms(config, set, ws) != 2 || ws.keep != std::vector<int>({0, 2})) {
+            LOGE("Soft-NMS with score threshold kept %zu boxes", ws.keep.size());
+            return false;
+        }
+
+        LOGD("Soft-NMS test passed");
+        return true;
+    }
+
+    bool testFastAndMatrixNms() {
+        LOGD("=== Testing Fast-NMS and Matrix-NMS ===");
+
+        // A与B重叠、B与C重叠、A与C不重叠
+        BoxSet chain;
+        chain.add(100, 100, 100, 100, 0.9f, 0); // A
+        chain.add(160, 100, 100, 100, 0.8f, 0); // B
+        chain.add(220, 100, 100, 100, 0.7f, 0); // C
+        float iouAB = referenceIou(&chain.boxes[0], &chain.boxes[4]);
+        float iouBC = referenceIou(&chain.boxes[4], &chain.boxes[8]);
+        nms_workspace_t ws;
+
+        nms_config_s hard = makeConfig(NMS_MODE_HARD, 0, 0);
+        hard.iou_threshold = 0.2f;
+        nms_config_s fast = hard;
+        fast.mode = NMS_MODE_FAST;
+        // 贪心：B被A抑制后不再抑制C；Fast：C仍被B抑制
+        runNms(hard, chain, ws);
+        if (iouAB <= 0.2f || iouBC <= 0.2f || ws.keep != std::vector<int>({0, 2})) {
+            LOGE("Hard NMS chain kept %zu (IoU AB %f BC %f)", ws.keep.size(), iouAB, iouBC);
+            return false;
+        }
+        runNms(fast, chain, ws);
+        if (ws.keep != std::vector<int>({0})) {
+            LOGE("Fast NMS chain kept %zu, expected {A}", ws.keep.size());
+            return false;
+        }
+
+        // Matrix：B衰减exp(-IoU_AB^2/sigma)，C由B补偿后衰减exp(-(IoU_BC^2 - IoU_AB^2)/sigma)
+        nms_config_s matrix = makeConfig(NMS_MODE_MATRIX, 0, 0);
+        matrix.score_threshold = 0.f;
+        if (runNms(matrix, chain, ws) != 3) {
+            LOGE("Matrix NMS kept %zu boxes", ws.keep.size());
+            return false;
+        }
+        float expectB = 0.8f * expf(-(iouAB * iouAB) / matrix.sigma);
+        float expectC = 0.7f * expf(-std::max(0.f, iouBC * iouBC - iouAB * iouAB) / matrix.sigma);
+        float gotB = 0, gotC = 0;
+        for (size_t i = 0; i < ws.keep.size(); i++) {
+            if (ws.keep[i] == 1) gotB = ws.keep_score[i];
+            if (ws.keep[i] == 2) gotC = ws.keep_score[i];
+        }
+        if (std::fabs(gotB - expectB) > 1e-5f || std::fabs(gotC - expectC) > 1e-5f || !sortedByScore(ws)) {
+            LOGE("Matrix NMS B %f (expected %f) C %f (expected %f)", gotB, expectB, gotC, expectC);
+            return false;
+        }
+
+        // 随机数据上所有模式的结果都按分数降序且不重复
+        BoxSet set = makeClusteredBoxes(1000, 5, 77);
+        const nms_mode_e modes[] = {NMS_MODE_HARD, NMS_MODE_SOFT, NMS_MODE_FAST, NMS_MODE_MATRIX};
+        for (nms_mode_e mode : modes) {
+            runNms(makeConfig(mode, 0, 0), set, ws);
+            std::set<int> unique(ws.keep.begin(), ws.keep.end());
+            if (ws.keep.empty() || unique.size() != ws.keep.size() || !sortedByScore(ws)) {
+                LOGE("Mode %d: %zu boxes, %zu unique", mode, ws.keep.size(), unique.size());
+                return false;
+            }
+        }
+
+        LOGD("Fast/Matrix NMS test passed");
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting NMS Tests");
+
+        int passedTests = 0;
+        int totalTests = 5;
+
+        if (testHardMatchesReference()) passedTests++;
+        if (testClassesAreIndependent()) passedTests++;
+        if (testTopKAndMaxOutput()) passedTests++;
+        if (testSoftNms()) passedTests++;
+        if (testFastAndMatrixNms()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+extern "C" void runNmsTests() {
+    NmsTest test;
+    test.runAllTests();
+}
+
+static double timeNms(const nms_config_s &config, const BoxSet &set, nms_workspace_t &ws, int iterations,
+                      int &kept) {
+    int64_t start = nowUs();
+    for (int i = 0; i < iterations; i++) {
+        kept = runNms(config, set, ws);
+    }
+    return (double) (nowUs() - start) / iterations;
+}
+
+/**
+ * Benchmark: NMS cost versus candidate count (80 classes, clustered boxes).
+ * Legacy is the previous quicksort + per-class full scan; it is skipped above
+ * 2000 boxes where a single run takes seconds. The new modes run without a
+ * top-K limit unless noted, so the sweep shows their raw scaling.
+ */
+extern "C" void runNmsBenchmark() {
+    LOGD("=== NMS Benchmark ===");
+
+    const int counts[] = {100, 500, 1000, 2000, 5000, 20000};
+    nms_workspace_t ws;
+    for (int count : counts) {
+        BoxSet set = makeClusteredBoxes(count, 80, 1234 + count);
+        int iterations = count <= 1000 ? 50 : (count <= 5000 ? 10 : 3);
+        int kept = 0;
+
+        LOGD("%d boxes, %d iterations", count, iterations);
+        if (count <= 2000) {
+            int64_t start = nowUs();
+            for (int i = 0; i < iterations; i++) {
+                kept = legacyNms(set, 0.45f);
+            }
+            LOGD("  legacy          : %10.1f us (%d kept)", (double) (nowUs() - start) / iterations, kept);
+        } else {
+            LOGD("  legacy          :    skipped");
+        }
+        const struct {
+            const char *name;
+            nms_mode_e mode;
+            int topK;
+        } cases[] = {{"hard         ", NMS_MODE_HARD, 0},
+                     {"hard top-1000", NMS_MODE_HARD, 1000},
+                     {"fast         ", NMS_MODE_FAST, 0},
+                     {"matrix       ", NMS_MODE_MATRIX, 0},
+                     {"soft         ", NMS_MODE_SOFT, 0}};
+        for (const auto &c : cases) {
+            double us = timeNms(makeConfig(c.mode, c.topK, 0), set, ws, iterations, kept);
+            LOGD("  %s   : %10.1f us (%d kept)", c.name, us, kept);
+        }
+    }
+}
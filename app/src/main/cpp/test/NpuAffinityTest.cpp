@@ -0,0 +1,268 @@
+#include "npu_affinity.h"
+#include "cpu_engine.h"
+#include "yolov5_thread_pool.h"
+#include "SystemPerformanceMonitor.h"
+#include "log4c.h"
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 各MockNpuEngine实例的调用记录，按创建顺序
+struct EngineLog {
+    std::mutex mutex;
+    int fullLoads = 0;
+    int sharedLoads = 0;
+    std::vector<uint32_t> coreMasks;
+};
+
+const size_t kWeightBytes = 8 * 1024 * 1024;
+
+/**
+ * CPU engine standing in for RKEngine: records core masks, and "shares"
+ * a context only with another loaded MockNpuEngine when sharing is enabled,
+ * so the pool's policy can be checked without the rknn runtime.
+ */
+class MockNpuEngine : public CPUEngine {
+public:
+    MockNpuEngine(std::shared_ptr<EngineLog> log, bool canShare)
+            : CPUEngine(cpu_engine_default_config()), log_(std::move(log)), canShare_(canShare), loaded_(false) {}
+
+    nn_error_e LoadModelData(char *modelData, int dataSize) override {
+        nn_error_e ret = CPUEngine::LoadModelData(modelData, dataSize);
+        std::lock_guard<std::mutex> lock(log_->mutex);
+        log_->fullLoads++;
+        loaded_ = ret == NN_SUCCESS;
+        return ret;
+    }
+
+    nn_error_e LoadModelShared(const std::shared_ptr<NNEngine> &base) override {
+        auto src = std::dynamic_pointer_cast<MockNpuEngine>(base);
+        if (!canShare_ || src == nullptr || !src->loaded_) {
+            return NN_LOAD_MODEL_FAIL;
+        }
+        nn_error_e ret = CPUEngine::LoadModelData(nullptr, 0);
+        std::lock_guard<std::mutex> lock(log_->mutex);
+        log_->sharedLoads++;
+        loaded_ = ret == NN_SUCCESS;
+        return ret;
+    }
+
+    nn_error_e SetCoreMask(uint32_t core_mask) override {
+        std::lock_guard<std::mutex> lock(log_->mutex);
+        log_->coreMasks.push_back(core_mask);
+        return NN_SUCCESS;
+    }
+
+    size_t GetWeightMemorySize() override { return loaded_ ? kWeightBytes : 0; }
+
+private:
+    std::shared_ptr<EngineLog> log_;
+    bool canShare_;
+    bool loaded_;
+};
+
+npu_affinity_config_s makeConfig(npu_core_policy_e policy, int firstCore, uint32_t pinnedMask) {
+    npu_affinity_config_s config = npu_affinity_default_config();
+    config.policy = policy;
+    config.first_core = firstCore;
+    config.pinned_mask = pinnedMask;
+    return config;
+}
+
+bool near(float a, float b) {
+    return a - b < 0.01f && b - a < 0.01f;
+}
+
+}  // namespace
+
+/**
+ * Tests for the NPU affinity policy: per-worker core masks, shared model
+ * contexts and the fallback to separate loads in Yolov5ThreadPool (with a
+ * mocked engine), per-core utilisation accounting, and the NPU section of
+ * the SystemPerformanceMonitor report.
+ */
+class NpuAffinityTest {
+public:
+    bool testCoreMaskPolicy() {
+        LOGD("=== Testing core mask policy ===");
+
+        npu_affinity_config_s autoConfig = npu_affinity_default_config();
+        npu_affinity_config_s roundRobin = makeConfig(NPU_POLICY_ROUND_ROBIN, 1, 0);
+        npu_affinity_config_s pinned = makeConfig(NPU_POLICY_PINNED, 0, NPU_CORE_0_1);
+
+        const uint32_t expected[] = {NPU_CORE_1, NPU_CORE_2, NPU_CORE_0, NPU_CORE_1, NPU_CORE_2};
+        for (int i = 0; i < 5; i++) {
+            if (npu_core_mask_for_worker(autoConfig, i) != NPU_CORE_AUTO ||
+                npu_core_mask_for_worker(pinned, i) != NPU_CORE_0_1) {
+                LOGE("Worker %d: auto/pinned policy returned the wrong mask", i);
+                return false;
+            }
+            if (npu_core_mask_for_worker(roundRobin, i) != expected[i]) {
+                LOGE("Worker %d: round-robin mask %u, expected %u", i, npu_core_mask_for_worker(roundRobin, i),
+                     expected[i]);
+                return false;
+            }
+        }
+
+        LOGD("Core mask policy test PASSED");
+        return true;
+    }
+
+    bool testSharedContexts() {
+        LOGD("=== Testing shared contexts in the thread pool ===");
+
+        auto log = std::make_shared<EngineLog>();
+        npu_affinity_config_s npu = makeConfig(NPU_POLICY_ROUND_ROBIN, 2, 0);
+        Yolov5ThreadPool pool;
+        nn_error_e ret = pool.setUpWithEngineFactory(
+                4, [log] { return std::make_shared<MockNpuEngine>(log, true); }, nullptr, 0, npu);
+        if (ret != NN_SUCCESS) {
+            LOGE("Thread pool setup failed: %d", ret);
+            return false;
+        }
+
+        Yolov5ThreadPool::NpuStats stats = pool.getNpuStats();
+        if (log->fullLoads != 1 || log->sharedLoads != 3 || stats.instances != 4 || stats.sharedContexts != 3) {
+            LOGE("Expected 1 full load and 3 shared, got %d/%d (stats %d/%d)", log->fullLoads, log->sharedLoads,
+                 stats.instances, stats.sharedContexts);
+            return false;
+        }
+        if (stats.weightBytesPerContext != kWeightBytes || stats.weightBytesSaved != 3 * kWeightBytes) {
+            LOGE("Weight memory saved %zu, expected %zu", stats.weightBytesSaved, 3 * kWeightBytes);
+            return false;
+        }
+
+        const uint32_t expected[] = {NPU_CORE_2, NPU_CORE_0, NPU_CORE_1, NPU_CORE_2};
+        for (int i = 0; i < 4; i++) {
+            if (log->coreMasks.size() != 4 || log->coreMasks[i] != expected[i] || stats.coreMasks[i] != expected[i]) {
+                LOGE("Worker %d was not assigned core mask %u", i, expected[i]);
+                return false;
+            }
+        }
+
+        LOGD("Shared contexts test PASSED");
+        return true;
+    }
+
+    bool testSharingFallback() {
+        LOGD("=== Testing fallback when sharing is unavailable ===");
+
+        // 引擎不支持共享：每个实例完整加载，自动调度时不设置core mask
+        auto log = std::make_shared<EngineLog>();
+        {
+            Yolov5ThreadPool pool;
+            pool.setUpWithEngineFactory(3, [log] { return std::make_shared<MockNpuEngine>(log, false); }, nullptr, 0);
+            Yolov5ThreadPool::NpuStats stats = pool.getNpuStats();
+            if (log->fullLoads != 3 || log->sharedLoads != 0 || stats.sharedContexts != 0 ||
+                stats.weightBytesSaved != 0 || !log->coreMasks.empty()) {
+                LOGE("Unsupported sharing: %d full / %d shared loads, %zu masks", log->fullLoads, log->sharedLoads,
+                     log->coreMasks.size());
+                return false;
+            }
+        }
+
+        // 配置关闭共享
+        auto log2 = std::make_shared<EngineLog>();
+        npu_affinity_config_s npu = makeConfig(NPU_POLICY_PINNED, 0, NPU_CORE_1);
+        npu.share_weights = false;
+        Yolov5ThreadPool pool;
+        pool.setUpWithEngineFactory(2, [log2] { return std::make_shared<MockNpuEngine>(log2, true); }, nullptr, 0, npu);
+        if (log2->fullLoads != 2 || log2->sharedLoads != 0 || log2->coreMasks.size() != 2 ||
+            log2->coreMasks[0] != NPU_CORE_1 || log2->coreMasks[1] != NPU_CORE_1) {
+            LOGE("share_weights=false: %d full / %d shared loads", log2->fullLoads, log2->sharedLoads);
+            return false;
+        }
+
+        LOGD("Sharing fallback test PASSED");
+        return true;
+    }
+
+    bool testUsageTracker() {
+        LOGD("=== Testing NPU usage tracker ===");
+
+        NpuUsageTracker tracker(3);
+        std::vector<float> usage = tracker.Sample(1000000);
+        if (usage.size() != 3 || usage[0] != 0.f || usage[1] != 0.f || usage[2] != 0.f) {
+            LOGE("First sample should be all zeros");
+            return false;
+        }
+
+        // 100ms窗口：核心0忙50ms，核心0/1联合忙20ms，自动调度30ms均摊到3个核心
+        tracker.AddBusy(NPU_CORE_0, 50000);
+        tracker.AddBusy(NPU_CORE_0_1, 20000);
+        tracker.AddBusy(NPU_CORE_AUTO, 30000);
+        usage = tracker.Sample(1100000);
+        if (!near(usage[0], 0.8f) || !near(usage[1], 0.3f) || !near(usage[2], 0.1f)) {
+            LOGE("Usage %.3f/%.3f/%.3f, expected 0.8/0.3/0.1", usage[0], usage[1], usage[2]);
+            return false;
+        }
+
+        // 下一窗口只计新增的耗时，超过窗口的部分截断为1
+        tracker.AddBusy(NPU_CORE_2, 300000);
+        usage = tracker.Sample(1200000);
+        if (!near(usage[0], 0.f) || !near(usage[1], 0.f) || !near(usage[2], 1.f)) {
+            LOGE("Second window usage %.3f/%.3f/%.3f, expected 0/0/1", usage[0], usage[1], usage[2]);
+            return false;
+        }
+        if (tracker.GetBusyUs(0) != 80000 || tracker.GetBusyUs(2) != 310000) {
+            LOGE("Accumulated busy time is wrong");
+            return false;
+        }
+
+        LOGD("NPU usage tracker test PASSED");
+        return true;
+    }
+
+    bool testMonitorReport() {
+        LOGD("=== Testing NPU metrics in the performance monitor ===");
+
+        SystemPerformanceMonitor monitor;
+        monitor.updateNpuMetrics({0.5f, 0.25f, 0.f}, 3 * kWeightBytes, 3);
+        SystemPerformanceMonitor::SystemMetrics metrics = monitor.getSystemMetrics();
+        if (metrics.npuCoreUsage.size() != 3 || !near(metrics.npuCoreUsage[0], 50.f) ||
+            !near(metrics.npuCoreUsage[1], 25.f) || metrics.npuSharedContexts != 3 ||
+            metrics.npuWeightMemorySaved != (long) (3 * kWeightBytes)) {
+            LOGE("NPU metrics were not stored");
+            return false;
+        }
+
+        std::string report = monitor.generatePerformanceReport();
+        if (report.find("NPU:") == std::string::npos || report.find("Core 1 Usage: 25.00%") == std::string::npos ||
+            report.find("Weight Memory Saved: 24576KB") == std::string::npos) {
+            LOGE("Report is missing the NPU section:\n%s", report.c_str());
+            return false;
+        }
+
+        LOGD("Monitor report test PASSED");
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting NPU Affinity Tests");
+
+        int passedTests = 0;
+        int totalTests = 5;
+
+        if (testCoreMaskPolicy()) passedTests++;
+        if (testSharedContexts()) passedTests++;
+        if (testSharingFallback()) passedTests++;
+        if (testUsageTracker()) passedTests++;
+        if (testMonitorReport()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+extern "C" void runNpuAffinityTests() {
+    NpuAffinityTest test;
+    test.runAllTests();
+}
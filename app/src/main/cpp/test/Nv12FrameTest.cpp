@@ -0,0 +1,297 @@
+#include "FrameConverter.h"
+#include "cv_draw.h"
+#include "log4c.h"
+#include "rga.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// 1920x1080解码帧的典型对齐：宽按64、高按16对齐
+const int kWidth = 1920;
+const int kHeight = 1080;
+const int kWidthStride = 1984;
+const int kHeightStride = 1088;
+
+std::shared_ptr<frame_data_t> makeNV12Frame(int width, int height, int widthStride, int heightStride,
+                                            uint8_t y, uint8_t u, uint8_t v) {
+    auto frame = std::make_shared<frame_data_t>();
+    size_t size = (size_t) widthStride * heightStride * 3 / 2;
+    frame->data.reset(new char[size]);
+    uint8_t* data = reinterpret_cast<uint8_t*>(frame->data.get());
+    memset(data, y, (size_t) widthStride * heightStride);
+    uint8_t* uv = data + widthStride * heightStride;
+    for (size_t i = 0; i < (size_t) widthStride * heightStride / 2; i += 2) {
+        uv[i] = u;
+        uv[i + 1] = v;
+    }
+    frame->dataSize = size;
+    frame->screenW = width;
+    frame->screenH = height;
+    frame->screenStride = widthStride;
+    frame->widthStride = widthStride;
+    frame->heightStride = heightStride;
+    frame->frameFormat = RK_FORMAT_YCbCr_420_SP;
+    return frame;
+}
+
+Detection makeDetection(int classId, int x, int y, int w, int h) {
+    Detection detection;
+    detection.class_id = classId;
+    detection.className = "person";
+    detection.confidence = 0.95f;
+    detection.box = cv::Rect(x, y, w, h);
+    return detection;
+}
+
+bool nearPixel(const uint8_t* rgba, int r, int g, int b) {
+    return std::abs(rgba[0] - r) <= 1 && std::abs(rgba[1] - g) <= 1 && std::abs(rgba[2] - b) <= 1 && rgba[3] == 255;
+}
+
+}  // namespace
+
+/**
+ * Tests for keeping decoded frames in NV12 until display: the CPU NV12->RGBA
+ * conversion used when RGA is unavailable, stride handling when writing into a
+ * window-sized buffer, detection overlays drawn directly on NV12, and the pooled
+ * RGBA view for consumers that still read RGBA.
+ */
+class Nv12FrameTest {
+public:
+    bool testColorConversion() {
+        LOGD("=== Testing NV12 -> RGBA conversion ===");
+
+        // 黑、白和BT.601下的纯红/纯蓝
+        struct Sample { uint8_t y, u, v; int r, g, b; };
+        const Sample samples[] = {
+                {16, 128, 128, 0, 0, 0},
+                {235, 128, 128, 255, 255, 255},
+                {82, 90, 240, 255, 0, 0},
+                {41, 240, 110, 0, 0, 255},
+        };
+        for (const Sample& sample : samples) {
+            auto frame = makeNV12Frame(8, 4, 16, 4, sample.y, sample.u, sample.v);
+            std::vector<uint8_t> rgba(10 * 4 * 4, 0xcd);
+            if (!FrameConverter::toRGBA(*frame, rgba.data(), 10 * 4, false)) {
+                LOGE("Conversion failed");
+                return false;
+            }
+            if (!nearPixel(&rgba[0], sample.r, sample.g, sample.b) ||
+                !nearPixel(&rgba[3 * 40 + 7 * 4], sample.r, sample.g, sample.b)) {
+                LOGE("YUV(%d,%d,%d) -> RGB(%d,%d,%d), expected (%d,%d,%d)", sample.y, sample.u, sample.v, rgba[0],
+                     rgba[1], rgba[2], sample.r, sample.g, sample.b);
+                return false;
+            }
+            // 目标行尾的填充不写
+            if (rgba[8 * 4] != 0xcd || rgba[3 * 40 + 9 * 4 + 3] != 0xcd) {
+                LOGE("Conversion wrote past the visible width");
+                return false;
+            }
+        }
+
+        LOGD("Color conversion test PASSED");
+        return true;
+    }
+
+    bool testStridesAndFormats() {
+        LOGD("=== Testing strides and formats ===");
+
+        // 每个2x2块一组UV：左列色度与右列不同，验证UV按列对取值，并且用heightStride定位UV平面
+        auto frame = makeNV12Frame(4, 2, 8, 4, 128, 128, 128);
+        uint8_t* uv = reinterpret_cast<uint8_t*>(frame->data.get()) + 8 * 4;
+        uv[2] = 200;
+        std::vector<uint8_t> rgba(4 * 2 * 4);
+        FrameConverter::toRGBA(*frame, rgba.data(), 16, false);
+        if (rgba[0 * 4 + 2] != rgba[1 * 4 + 2] || rgba[2 * 4 + 2] == rgba[0 * 4 + 2] ||
+            rgba[16 + 2 * 4 + 2] != rgba[2 * 4 + 2]) {
+            LOGE("Chroma was not shared per 2x2 block");
+            return false;
+        }
+
+        // 高度stride不足、目标stride不足都应拒绝
+        frame->heightStride = 1;
+        if (FrameConverter::toRGBA(*frame, rgba.data(), 16, false) ||
+            FrameConverter::toRGBA(*makeNV12Frame(4, 2, 8, 4, 0, 0, 0), rgba.data(), 8, false)) {
+            LOGE("Invalid strides were accepted");
+            return false;
+        }
+
+        // RGBA帧按行拷贝
+        auto rgbaFrame = std::make_shared<frame_data_t>();
+        rgbaFrame->data.reset(new char[6 * 2 * 4]);
+        for (int i = 0; i < 6 * 2 * 4; i++) rgbaFrame->data.get()[i] = (char) i;
+        rgbaFrame->screenW = 4;
+        rgbaFrame->screenH = 2;
+        rgbaFrame->screenStride = 6 * 4;
+        rgbaFrame->frameFormat = RK_FORMAT_RGBA_8888;
+        std::vector<uint8_t> out(4 * 2 * 4);
+        if (!FrameConverter::toRGBA(*rgbaFrame, out.data(), 16) || out[15] != 15 || out[16] != 24 ||
+            FrameConverter::rowStride(*rgbaFrame) != 24 || FrameConverter::rowStride(*frame) != 8) {
+            LOGE("RGBA frame was not copied row by row");
+            return false;
+        }
+
+        LOGD("Strides and formats test PASSED");
+        return true;
+    }
+
+    bool testOverlayOnNV12() {
+        LOGD("=== Testing detection overlay on NV12 ===");
+
+        auto frame = makeNV12Frame(kWidth, kHeight, kWidthStride, kHeightStride, 16, 128, 128);
+        uint8_t* y = reinterpret_cast<uint8_t*>(frame->data.get());
+        uint8_t* uv = y + kWidthStride * kHeightStride;
+
+        ViewportRenderConfig config = calculateViewportConfig(kWidth, kHeight, true);
+        config.showClassNamesInSmallViewport = false;
+        config.showConfidenceInSmallViewport = false;
+        // 奇数坐标向下取偶；越界的框收进有效区域
+        std::vector<Detection> detections = {makeDetection(0, 101, 201, 300, 400),
+                                             makeDetection(1, kWidth - 50, kHeight - 50, 200, 200)};
+        DrawDetectionsOnNV12(y, kWidth, kHeight, kWidthStride, kHeightStride, detections, config);
+
+        // class 0为绿色：Y=144, U=54, V=34
+        int top = 200 * kWidthStride;
+        if (y[top + 100] != 144 || y[top + 300] != 144 || y[top + 89] != 16) {
+            LOGE("Top edge luma %d, expected 144", y[top + 300]);
+            return false;
+        }
+        int uvTop = 100 * kWidthStride;
+        if (uv[uvTop + 150 * 2] != 54 || uv[uvTop + 150 * 2 + 1] != 34) {
+            LOGE("Top edge chroma %d/%d, expected 54/34", uv[uvTop + 300], uv[uvTop + 301]);
+            return false;
+        }
+        // 框内部不变
+        if (y[400 * kWidthStride + 250] != 16 || uv[200 * kWidthStride + 250] != 128) {
+            LOGE("Box interior was modified");
+            return false;
+        }
+        // 裁剪后的框画到右下角
+        if (y[(kHeight - 50) * kWidthStride + kWidth - 20] == 16) {
+            LOGE("Clipped box was not drawn");
+            return false;
+        }
+        // 有效区域以外的填充行、列不写
+        for (int x = 0; x < kWidthStride; x++) {
+            if (y[kHeight * kWidthStride + x] != 16) {
+                LOGE("Overlay wrote into the height padding");
+                return false;
+            }
+        }
+        for (int row = 0; row < kHeight; row++) {
+            if (y[row * kWidthStride + kWidth] != 16) {
+                LOGE("Overlay wrote into the width padding");
+                return false;
+            }
+        }
+
+        // 标签：Y平面写白字，底色区域UV置灰
+        auto labelled = makeNV12Frame(640, 480, 640, 480, 100, 60, 60);
+        uint8_t* ly = reinterpret_cast<uint8_t*>(labelled->data.get());
+        DrawDetectionsOnNV12(ly, 640, 480, 640, 480, {makeDetection(2, 100, 100, 200, 200)},
+                             calculateViewportConfig(640, 480, true));
+        bool hasGlyph = false;
+        for (int row = 88; row < 96 && !hasGlyph; row++) {
+            for (int x = 100; x < 200; x++) {
+                if (ly[row * 640 + x] == 235) {
+                    hasGlyph = true;
+                    break;
+                }
+            }
+        }
+        if (!hasGlyph || ly[640 * 480 + 44 * 640 + 120] != 128) {
+            LOGE("Label was not drawn on the Y plane");
+            return false;
+        }
+
+        LOGD("NV12 overlay test PASSED");
+        return true;
+    }
+
+    bool testRGBAView() {
+        LOGD("=== Testing pooled RGBA view ===");
+
+        auto frame = makeNV12Frame(64, 32, 64, 32, 235, 128, 128);
+        frame->frameId = 7;
+        frame->detections.push_back(makeDetection(0, 0, 0, 8, 8));
+        frame->hasDetections = true;
+
+        std::shared_ptr<frame_data_t> holder;
+        const frame_data_t* view = FrameConverter::rgbaView(frame.get(), holder, false);
+        if (!view || view != holder.get() || view->frameFormat != RK_FORMAT_RGBA_8888 || view->frameId != 7 ||
+            view->screenStride != 64 * 4 || view->detections.size() != 1 || !view->hasDetections) {
+            LOGE("NV12 frame was not converted into a pooled RGBA frame");
+            return false;
+        }
+        if (!nearPixel(reinterpret_cast<const uint8_t*>(view->data.get()) + (31 * 64 + 63) * 4, 255, 255, 255)) {
+            LOGE("Converted pixels are wrong");
+            return false;
+        }
+
+        std::shared_ptr<frame_data_t> unused;
+        if (FrameConverter::rgbaView(view, unused) != view || unused) {
+            LOGE("RGBA frame should be returned as is");
+            return false;
+        }
+
+        LOGD("RGBA view test PASSED");
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting NV12 Frame Tests");
+
+        int passedTests = 0;
+        int totalTests = 4;
+
+        if (testColorConversion()) passedTests++;
+        if (testStridesAndFormats()) passedTests++;
+        if (testOverlayOnNV12()) passedTests++;
+        if (testRGBAView()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+extern "C" void runNv12FrameTests() {
+    Nv12FrameTest test;
+    test.runAllTests();
+}
+
+/**
+ * Benchmark: per decoded 1080p frame, the NV12 copy the decoder callback now
+ * makes versus the full-frame RGBA buffer it used to fill, plus the CPU
+ * fallback conversion cost paid only for displayed frames.
+ */
+extern "C" void runNv12FrameBenchmark(int numFrames) {
+    auto frame = makeNV12Frame(kWidth, kHeight, kWidthStride, kHeightStride, 128, 128, 128);
+    size_t nv12Bytes = (size_t) kWidthStride * kHeightStride * 3 / 2;
+    size_t rgbaBytes = (size_t) kWidthStride * kHeightStride * 4;
+    std::vector<char> nv12Copy(nv12Bytes);
+    std::vector<uint8_t> rgba((size_t) kWidth * kHeight * 4);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < numFrames; i++) {
+        memcpy(nv12Copy.data(), frame->data.get(), nv12Bytes);
+    }
+    auto copied = std::chrono::steady_clock::now();
+    for (int i = 0; i < numFrames; i++) {
+        FrameConverter::toRGBA(*frame, rgba.data(), kWidth * 4, false);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double copyMs = std::chrono::duration_cast<std::chrono::microseconds>(copied - start).count() / 1000.0;
+    double convertMs = std::chrono::duration_cast<std::chrono::microseconds>(end - copied).count() / 1000.0;
+    LOGD("NV12 benchmark: %d frames, decoder copy %zu bytes (was %zu RGBA) %.3f ms/frame, "
+         "CPU RGBA conversion %.3f ms/frame", numFrames, nv12Bytes, rgbaBytes, copyMs / numFrames,
+         convertMs / numFrames);
+}
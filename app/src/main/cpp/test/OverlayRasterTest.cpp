@@ -0,0 +1,435 @@
+#include "overlay_raster.h"
+#include "cv_draw.h"
+#include "drawing.h"
+#include "log4c.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+const uint8_t kPadding = 0xEE;
+
+// width x height buffer with `channels` bytes per pixel and `padding` bytes of kPadding after each row,
+// allocated exactly so writes past the last row are caught by ASan
+struct Canvas {
+    int width;
+    int height;
+    int channels;
+    int stride;
+    std::vector<uint8_t> pixels;
+
+    Canvas(int w, int h, int c, int padding = 0)
+            : width(w), height(h), channels(c), stride(w * c + padding), pixels((size_t) stride * h, kPadding) {
+        for (int y = 0; y < h; y++) {
+            memset(row(y), 0, (size_t) w * c);
+        }
+    }
+
+    uint8_t* row(int y) { return pixels.data() + (size_t) y * stride; }
+    const uint8_t* row(int y) const { return pixels.data() + (size_t) y * stride; }
+
+    bool paddingIntact() const {
+        for (int y = 0; y < height; y++) {
+            for (int x = width * channels; x < stride; x++) {
+                if (row(y)[x] != kPadding) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+struct Box {
+    int x, y, w, h;
+};
+
+// Same packing as draw_rectangle_yuv420sp reads: [Y, U, V] bytes, BT.601 limited range
+unsigned int nv12Color(uint32_t rgba) {
+    int r = rgba & 0xFF, g = (rgba >> 8) & 0xFF, b = (rgba >> 16) & 0xFF;
+    unsigned int y = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+    unsigned int u = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+    unsigned int v = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+    return y | (u << 8) | (v << 16);
+}
+
+// Outline as the set difference of two rectangles: t / 2 outside the edges, the rest inside
+bool onOutline(int px, int py, const Box& box, int thickness) {
+    int t0 = thickness / 2, t1 = thickness - t0;
+    bool outer = px >= box.x - t0 && px < box.x + box.w + t1 && py >= box.y - t0 && py < box.y + box.h + t1;
+    bool inner = px >= box.x + t1 && px < box.x + box.w - t0 && py >= box.y + t1 && py < box.y + box.h - t0;
+    return outer && !inner;
+}
+
+// Old cv_draw path: bounds check and four byte stores per pixel, 8x8 glyphs plotted bit by bit
+void legacySetPixel(uint8_t* rgba, int x, int y, int width, int stride, uint32_t color) {
+    if (x >= 0 && x < width && y >= 0) {
+        memcpy(rgba + y * stride + x * 4, &color, 4);
+    }
+}
+
+void legacyRectangle(uint8_t* rgba, int width, int height, int stride, const Box& box, int thickness,
+                     uint32_t color) {
+    int x = std::max(0, std::min(box.x, width - 1)), y = std::max(0, std::min(box.y, height - 1));
+    int w = std::max(1, std::min(box.w, width - x)), h = std::max(1, std::min(box.h, height - y));
+    for (int offset = -thickness / 2; offset <= thickness / 2; offset++) {
+        for (int px = x; px <= x + w; px++) {
+            legacySetPixel(rgba, px, y + offset, width, stride, color);
+            legacySetPixel(rgba, px, y + h + offset, width, stride, color);
+        }
+        for (int py = y; py <= y + h; py++) {
+            legacySetPixel(rgba, x + offset, py, width, stride, color);
+            legacySetPixel(rgba, x + w + offset, py, width, stride, color);
+        }
+    }
+}
+
+void legacyText(uint8_t* rgba, int width, int stride, int x, int y, const std::string& text, uint32_t color) {
+    static const uint8_t glyph[8] = {0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00};
+    for (size_t i = 0; i < text.length() && x + (int) i * 8 + 8 <= width; i++) {
+        for (int row = 0; row < 8; row++) {
+            for (int col = 0; col < 8; col++) {
+                if (glyph[row] & (0x80 >> col)) {
+                    legacySetPixel(rgba, x + (int) i * 8 + col, y + row, width, stride, color);
+                }
+            }
+        }
+    }
+}
+
+// Boxes spread over a 1080p frame the way a crowded scene produces them
+std::vector<Box> benchmarkBoxes(int count) {
+    std::vector<Box> boxes;
+    srand(7);
+    for (int i = 0; i < count; i++) {
+        int w = 40 + rand() % 200, h = 80 + rand() % 300;
+        boxes.push_back({(rand() % (1920 - w)) & ~1, (16 + rand() % (1080 - h - 16)) & ~1, w & ~1, h & ~1});
+    }
+    return boxes;
+}
+
+}  // namespace
+
+/**
+ * Tests for the batched overlay rasteriser in draw/overlay_raster: outlines
+ * against a per-pixel definition on RGBA and against draw_rectangle_yuv420sp
+ * on NV12, glyph atlas orientation and scaling, and clipping at the frame edges.
+ */
+class OverlayRasterTest {
+public:
+    bool testRGBAOutlines() {
+        LOGD("=== Testing RGBA outlines ===");
+
+        const Box boxes[] = {{10, 12, 40, 30}, {-6, -3, 20, 25}, {70, 40, 30, 40}, {5, 5, 1, 1}};
+        for (int thickness = 1; thickness <= 6; thickness++) {
+            Canvas canvas(90, 60, 4, 12);
+            OverlayDisplayList list;
+            list.reset(90, 60);
+            for (size_t i = 0; i < 4; i++) {
+                list.addRectangle(boxes[i].x, boxes[i].y, boxes[i].w, boxes[i].h, thickness, 0xFF000010u + i);
+            }
+            overlay_render_rgba(list, canvas.pixels.data(), canvas.stride);
+
+            for (int y = 0; y < 60; y++) {
+                for (int x = 0; x < 90; x++) {
+                    // Later boxes are drawn over earlier ones
+                    uint32_t expected = 0;
+                    for (size_t i = 0; i < 4; i++) {
+                        if (onOutline(x, y, boxes[i], thickness)) {
+                            expected = 0xFF000010u + i;
+                        }
+                    }
+                    uint32_t actual;
+                    memcpy(&actual, canvas.row(y) + x * 4, 4);
+                    if (actual != expected) {
+                        LOGE("Thickness %d: pixel (%d,%d) is %08x, expected %08x", thickness, x, y, actual, expected);
+                        return false;
+                    }
+                }
+            }
+            if (!canvas.paddingIntact()) {
+                LOGE("Thickness %d: outline written into the row padding", thickness);
+                return false;
+            }
+        }
+
+        LOGD("RGBA outline test passed");
+        return true;
+    }
+
+    bool testNV12MatchesYuvRectangle() {
+        LOGD("=== Testing NV12 outlines against draw_rectangle_yuv420sp ===");
+
+        // Even boxes and thicknesses, including boxes crossing every edge
+        const Box boxes[] = {{20, 18, 60, 40}, {-10, -6, 40, 30}, {140, 100, 40, 40}, {100, 50, 2, 2}};
+        const uint32_t colors[] = {0xFF00FF00u, 0xFF0000FFu, 0xFFFF8000u, 0xFFC0C0FFu};
+        for (int thickness = 2; thickness <= 8; thickness += 2) {
+            Canvas expected(160, 120 * 3 / 2, 1), actual(160, 120 * 3 / 2, 1);
+            for (auto* canvas : {&expected, &actual}) {
+                for (size_t i = 0; i < canvas->pixels.size(); i++) {
+                    canvas->pixels[i] = (uint8_t) (i * 7);
+                }
+            }
+            OverlayDisplayList list;
+            list.reset(160, 120);
+            for (int i = 0; i < 4; i++) {
+                draw_rectangle_yuv420sp(expected.pixels.data(), 160, 120, boxes[i].x, boxes[i].y, boxes[i].w,
+                                        boxes[i].h, nv12Color(colors[i]), thickness);
+                list.addRectangle(boxes[i].x, boxes[i].y, boxes[i].w, boxes[i].h, thickness, colors[i]);
+            }
+            overlay_render_nv12(list, actual.pixels.data(), 160, 120);
+            if (expected.pixels != actual.pixels) {
+                size_t at = std::mismatch(expected.pixels.begin(), expected.pixels.end(), actual.pixels.begin()).first -
+                            expected.pixels.begin();
+                LOGE("Thickness %d: byte %zu is %d, draw_rectangle_yuv420sp wrote %d", thickness, at,
+                     actual.pixels[at], expected.pixels[at]);
+                return false;
+            }
+        }
+
+        LOGD("NV12 outline test passed");
+        return true;
+    }
+
+    bool testGlyphAtlas() {
+        LOGD("=== Testing glyph atlas ===");
+
+        // '1' is {0x0C, 0x0E, ...}: the lowest bit is the leftmost column, so row 1 is set in columns 1..3
+        Canvas one(8, 8, 4);
+        OverlayDisplayList list;
+        list.reset(8, 8);
+        list.addText(0, 0, "1", 1, 0xFFFFFFFFu);
+        overlay_render_rgba(list, one.pixels.data(), one.stride);
+        for (int x = 0; x < 8; x++) {
+            bool set = one.row(1)[x * 4] == 0xFF;
+            if (set != (x >= 1 && x <= 3)) {
+                LOGE("Glyph '1' row 1 column %d is %s", x, set ? "set" : "clear");
+                return false;
+            }
+        }
+
+        // Every scale is the 1x glyph with each dot blown up; lowercase uses the uppercase glyphs
+        const std::string text = "Az0#";
+        Canvas base(32, 8 * 3 / 2, 1);
+        list.reset(32, 8);
+        list.addText(0, 0, text, 1, 0xFFFFFFFFu);
+        overlay_render_nv12(list, base.pixels.data(), 32, 8);
+        for (int scale = 1; scale <= OVERLAY_MAX_GLYPH_SCALE; scale++) {
+            int width = overlay_text_width(text.length(), scale), height = 8 * scale;
+            Canvas upper(width, height, 4, 8), lower(width, height, 4, 8);
+            list.reset(width, height);
+            list.addText(0, 0, text, scale, 0xFFFFFFFFu);
+            overlay_render_rgba(list, upper.pixels.data(), upper.stride);
+            list.reset(width, height);
+            list.addText(0, 0, "aZ0#", scale, 0xFFFFFFFFu);
+            overlay_render_rgba(list, lower.pixels.data(), lower.stride);
+            if (upper.pixels != lower.pixels) {
+                LOGE("Scale %d: lowercase glyphs differ from uppercase", scale);
+                return false;
+            }
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    bool set = upper.row(y)[x * 4] == 0xFF;
+                    bool expected = base.row(y / scale)[x / scale] != 0;
+                    if (set != expected) {
+                        LOGE("Scale %d: pixel (%d,%d) does not match the 1x glyph", scale, x, y);
+                        return false;
+                    }
+                }
+            }
+        }
+
+        LOGD("Glyph atlas test passed");
+        return true;
+    }
+
+    bool testClipping() {
+        LOGD("=== Testing clipping at the frame edges ===");
+
+        OverlayDisplayList list;
+        list.reset(50, 30);
+        list.addFill(-20, -20, -1, 10, 0xFFFFFFFFu);
+        list.addFill(50, 0, 60, 30, 0xFFFFFFFFu);
+        list.addDim(10, 30, 20, 40);
+        list.addText(-100, 0, "AB", 2, 0xFFFFFFFFu);
+        if (!list.ops().empty()) {
+            LOGE("%zu commands outside the frame were kept", list.ops().size());
+            return false;
+        }
+        list.addRectangle(40, 20, 20, 20, 4, 0xFF0000FFu);
+        list.addText(36, 22, "WWW", 2, 0xFFFFFFFFu);
+        list.addText(-9, -5, "HH", 1, 0xFFFFFFFFu);
+        for (const auto& op : list.ops()) {
+            if (op.x0 < 0 || op.y0 < 0 || op.x1 > 50 || op.y1 > 30 || op.x0 >= op.x1 || op.y0 >= op.y1) {
+                LOGE("Command %d clipped to [%d,%d)x[%d,%d)", op.type, op.x0, op.x1, op.y0, op.y1);
+                return false;
+            }
+        }
+
+        Canvas rgba(50, 30, 4, 16);
+        overlay_render_rgba(list, rgba.pixels.data(), rgba.stride);
+        if (!rgba.paddingIntact()) {
+            LOGE("RGBA overlay written into the row padding");
+            return false;
+        }
+        // The second 'H' starts at x = -1, so its column 1 is x = 0; its glyph rows 5 and 6 are rows 0 and 1
+        if (rgba.row(0)[0] == 0 || rgba.row(1)[0] == 0 || rgba.row(2)[0] != 0) {
+            LOGE("Partly visible glyph was not drawn");
+            return false;
+        }
+
+        // NV12 with padded strides: nothing may reach the padding columns or rows
+        const int stride = 64, heightStride = 32;
+        Canvas nv12(stride, heightStride * 3 / 2, 1);
+        std::fill(nv12.pixels.begin(), nv12.pixels.end(), kPadding);
+        for (int y = 0; y < 30; y++) {
+            memset(nv12.row(y), 16, 50);
+        }
+        for (int y = 0; y < 15; y++) {
+            memset(nv12.row(heightStride + y), 128, 50);
+        }
+        list.addDim(44, 26, 54, 34);
+        overlay_render_nv12(list, nv12.pixels.data(), stride, heightStride);
+        for (int y = 0; y < heightStride * 3 / 2; y++) {
+            // 30 luma rows, then 15 chroma rows from heightStride
+            int validRows = y < heightStride ? 30 : heightStride + 15;
+            for (int x = 0; x < stride; x++) {
+                if ((x >= 50 || y >= validRows) && nv12.row(y)[x] != kPadding) {
+                    LOGE("NV12 overlay written into the padding at (%d,%d)", x, y);
+                    return false;
+                }
+            }
+        }
+
+        LOGD("Clipping test passed");
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting Overlay Raster Tests");
+
+        int passedTests = 0;
+        int totalTests = 0;
+
+        totalTests++; if (testRGBAOutlines()) passedTests++;
+        totalTests++; if (testNV12MatchesYuvRectangle()) passedTests++;
+        totalTests++; if (testGlyphAtlas()) passedTests++;
+        totalTests++; if (testClipping()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+extern "C" void runOverlayRasterTests() {
+    OverlayRasterTest test;
+    test.runAllTests();
+}
+
+// Boxes per millisecond with a 16-character label each, 1080p RGBA and NV12, against the old per-pixel
+// RGBA path and draw_rectangle_yuv420sp with per-pixel glyphs on NV12
+extern "C" void runOverlayRasterBenchmark(int numFrames) {
+    const int boxCount = 64;
+    const std::string label = "#12 person 0.93";
+    std::vector<Box> boxes = benchmarkBoxes(boxCount);
+    LOGD("=== Overlay Raster Benchmark (%d frames x %d boxes, 1920x1080) ===", numFrames, boxCount);
+
+    auto boxesPerMs = [&](double ms) { return numFrames * boxCount / ms; };
+    auto elapsedMs = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    Canvas rgba(1920, 1080, 4);
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < numFrames; frame++) {
+        for (const Box& box : boxes) {
+            legacyRectangle(rgba.pixels.data(), 1920, 1080, rgba.stride, box, 4, 0xFF00FF00u);
+            legacyText(rgba.pixels.data(), 1920, rgba.stride, box.x, box.y - 12, label, 0xFFFFFFFFu);
+        }
+    }
+    double legacyRGBA = elapsedMs(start);
+
+    OverlayDisplayList list;
+    start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < numFrames; frame++) {
+        list.reset(1920, 1080);
+        for (const Box& box : boxes) {
+            list.addRectangle(box.x, box.y, box.w, box.h, 4, 0xFF00FF00u);
+            list.addText(box.x, box.y - 12, label, 1, 0xFFFFFFFFu);
+        }
+        overlay_render_rgba(list, rgba.pixels.data(), rgba.stride);
+    }
+    double rasterRGBA = elapsedMs(start);
+
+    Canvas nv12(1920, 1080 * 3 / 2, 1);
+    start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < numFrames; frame++) {
+        for (const Box& box : boxes) {
+            draw_rectangle_yuv420sp(nv12.pixels.data(), 1920, 1080, box.x, box.y, box.w, box.h,
+                                    nv12Color(0xFF00FF00u), 4);
+            // Glyph dots on luma only, as the old drawLabelNV12 did
+            for (size_t i = 0; i < label.length(); i++) {
+                for (int row = 0; row < 8; row++) {
+                    uint8_t* luma = nv12.row(box.y - 12 + row) + box.x + i * 8;
+                    for (int col = 0; col < 8; col++) {
+                        if (box.x + (int) i * 8 + col < 1920 && (0x3E & (0x80 >> col))) {
+                            luma[col] = 235;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    double legacyNV12 = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < numFrames; frame++) {
+        list.reset(1920, 1080);
+        for (const Box& box : boxes) {
+            list.addRectangle(box.x, box.y, box.w, box.h, 4, 0xFF00FF00u);
+            list.addText(box.x, box.y - 12, label, 1, 0xFFFFFFFFu);
+        }
+        overlay_render_nv12(list, nv12.pixels.data(), 1920, 1080);
+    }
+    double rasterNV12 = elapsedMs(start);
+
+    LOGD("RGBA: per-pixel %.1f boxes/ms, display list %.1f boxes/ms (%.1fx)", boxesPerMs(legacyRGBA),
+         boxesPerMs(rasterRGBA), legacyRGBA / rasterRGBA);
+    LOGD("NV12: draw_rectangle_yuv420sp %.1f boxes/ms, display list %.1f boxes/ms (%.1fx)", boxesPerMs(legacyNV12),
+         boxesPerMs(rasterNV12), legacyNV12 / rasterNV12);
+
+    // End to end through the detection drawing entry points, label formatting included
+    std::vector<Detection> detections;
+    for (const Box& box : boxes) {
+        Detection detection;
+        detection.class_id = (int) detections.size() % 10;
+        detection.className = "person";
+        detection.confidence = 0.93f;
+        detection.track_id = 12;
+        detection.box = cv::Rect(box.x, box.y, box.w, box.h);
+        detections.push_back(detection);
+    }
+    ViewportRenderConfig config = calculateViewportConfig(1920, 1080, true);
+    start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < numFrames; frame++) {
+        DrawDetectionsOnRGBAViewportOptimized(rgba.pixels.data(), 1920, 1080, rgba.stride, detections, config);
+    }
+    double drawRGBA = elapsedMs(start);
+    start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < numFrames; frame++) {
+        DrawDetectionsOnNV12(nv12.pixels.data(), 1920, 1080, 1920, 1080, detections, config);
+    }
+    double drawNV12 = elapsedMs(start);
+    LOGD("DrawDetections*: RGBA %.1f boxes/ms, NV12 %.1f boxes/ms (glyph scale %d)", boxesPerMs(drawRGBA),
+         boxesPerMs(drawNV12), overlay_glyph_scale(calculateAdaptiveTextScale(1920, 1080, config)));
+}
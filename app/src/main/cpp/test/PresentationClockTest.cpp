@@ -0,0 +1,336 @@
+#include "PresentationClock.h"
+#include "log4c.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+// Deterministic pseudo-random value in [lo, hi]
+int nextRandom(unsigned int& state, int lo, int hi) {
+    state = state * 1103515245u + 12345u;
+    return lo + static_cast<int>((state >> 16) % static_cast<unsigned int>(hi - lo + 1));
+}
+
+struct Frame {
+    int64_t pts;          // ms
+    int64_t readyTimeUs;  // when the frame reaches the display
+};
+
+// Stream with PTS steps in [minStepMs, maxStepMs], constant pipeline latency, arrival jitter up to jitterMs
+// and the local clock running (1 + drift) times as fast as the camera clock
+std::vector<Frame> makeStream(int count, int minStepMs, int maxStepMs, int jitterMs, double drift, unsigned int seed) {
+    std::vector<Frame> frames;
+    int64_t pts = 1000;
+    for (int i = 0; i < count; i++) {
+        Frame frame;
+        frame.pts = pts;
+        frame.readyTimeUs = 5000000 + static_cast<int64_t>((pts - 1000) * 1000 * (1.0 + drift)) + 50000 +
+                            nextRandom(seed, 0, jitterMs) * 1000;
+        frames.push_back(frame);
+        pts += nextRandom(seed, minStepMs, maxStepMs);
+    }
+    return frames;
+}
+
+struct PlaybackResult {
+    int shown;
+    int dropped;
+    double meanLatencyMs;     // Presentation time - ready time
+    double maxLatencyMs;
+    double meanJudderMs;      // |presentation step - PTS step| between consecutive shown frames
+    int shownAfterWarmup;
+    int droppedAfterWarmup;
+};
+
+/**
+ * Play frames through the clock on a display that is free whenever it is not waiting for a
+ * presentation time (render cost 0), as ZLPlayer::display does. Frames before warmup count
+ * towards the totals but not the *AfterWarmup fields.
+ */
+PlaybackResult playWithClock(const std::vector<Frame>& frames, int warmup = 0) {
+    PresentationClock clock;
+    PlaybackResult result = {0, 0, 0.0, 0.0, 0.0, 0, 0};
+    int64_t displayFreeUs = 0;
+    int64_t lastPresentUs = -1;
+    int64_t lastPts = -1;
+    double latencySum = 0.0;
+    double judderSum = 0.0;
+    int judderCount = 0;
+    for (size_t i = 0; i < frames.size(); i++) {
+        int64_t nowUs = std::max(frames[i].readyTimeUs, displayFreeUs);
+        PresentationClock::Decision decision = clock.schedule(frames[i].pts, frames[i].readyTimeUs, nowUs);
+        if (decision.action == PresentationClock::DROP_LATE) {
+            result.dropped++;
+            if ((int) i >= warmup) {
+                result.droppedAfterWarmup++;
+            }
+            continue;
+        }
+        displayFreeUs = decision.presentTimeUs;
+        double latencyMs = (decision.presentTimeUs - frames[i].readyTimeUs) / 1000.0;
+        latencySum += latencyMs;
+        result.maxLatencyMs = std::max(result.maxLatencyMs, latencyMs);
+        if (lastPresentUs >= 0 && (int) i >= warmup) {
+            judderSum += std::fabs((decision.presentTimeUs - lastPresentUs) / 1000.0 - (double) (frames[i].pts - lastPts));
+            judderCount++;
+        }
+        lastPresentUs = decision.presentTimeUs;
+        lastPts = frames[i].pts;
+        result.shown++;
+        if ((int) i >= warmup) {
+            result.shownAfterWarmup++;
+        }
+    }
+    result.meanLatencyMs = result.shown ? latencySum / result.shown : 0.0;
+    result.meanJudderMs = judderCount ? judderSum / judderCount : 0.0;
+    return result;
+}
+
+/**
+ * The display before the presentation clock: a depth-1 mailbox polled on fixed
+ * 1000 / fps deadlines, each deadline showing the newest frame ready by then.
+ */
+PlaybackResult playFixedRate(const std::vector<Frame>& frames, int fps) {
+    PlaybackResult result = {0, 0, 0.0, 0.0, 0.0, 0, 0};
+    const int64_t intervalUs = 1000000 / fps;
+    int64_t deadlineUs = frames.front().readyTimeUs + intervalUs / 2;
+    size_t next = 0;
+    int64_t lastPresentUs = -1;
+    int64_t lastPts = -1;
+    double latencySum = 0.0;
+    double judderSum = 0.0;
+    int judderCount = 0;
+    while (next < frames.size()) {
+        size_t newest = next;
+        bool any = false;
+        while (next < frames.size() && frames[next].readyTimeUs <= deadlineUs) {
+            if (any) {
+                result.dropped++;
+            }
+            newest = next++;
+            any = true;
+        }
+        if (any) {
+            double latencyMs = (deadlineUs - frames[newest].readyTimeUs) / 1000.0;
+            latencySum += latencyMs;
+            result.maxLatencyMs = std::max(result.maxLatencyMs, latencyMs);
+            if (lastPresentUs >= 0) {
+                judderSum += std::fabs((deadlineUs - lastPresentUs) / 1000.0 - (double) (frames[newest].pts - lastPts));
+                judderCount++;
+            }
+            lastPresentUs = deadlineUs;
+            lastPts = frames[newest].pts;
+            result.shown++;
+        }
+        deadlineUs += intervalUs;
+    }
+    result.shownAfterWarmup = result.shown;
+    result.meanLatencyMs = result.shown ? latencySum / result.shown : 0.0;
+    result.meanJudderMs = judderCount ? judderSum / judderCount : 0.0;
+    return result;
+}
+
+}  // namespace
+
+/**
+ * Tests for PresentationClock: PTS-spaced presentation under arrival jitter
+ * at 25 fps, 30 fps and variable rate, late-frame dropping and re-anchoring,
+ * PTS discontinuities, and clock drift between camera and display.
+ */
+class PresentationClockTest {
+public:
+    bool testFrameRates() {
+        LOGD("=== Testing 25 fps, 30 fps and variable-rate streams ===");
+
+        struct Case {
+            const char* name;
+            int minStepMs;
+            int maxStepMs;
+            int64_t expectedIntervalUs;
+        } cases[] = {
+                {"25 fps", 40, 40, 40000},
+                {"30 fps", 33, 34, 33500},
+                {"variable", 20, 80, 50000},
+        };
+        for (const Case& c : cases) {
+            std::vector<Frame> frames = makeStream(500, c.minStepMs, c.maxStepMs, 15, 0.0, 7);
+            PlaybackResult r = playWithClock(frames, 50);
+            if (r.droppedAfterWarmup > 0 || r.meanJudderMs > 3.0 || r.maxLatencyMs > 150.0) {
+                LOGE("%s: dropped %d, judder %.2f ms, max latency %.1f ms", c.name, r.droppedAfterWarmup,
+                     r.meanJudderMs, r.maxLatencyMs);
+                return false;
+            }
+
+            PresentationClock clock;
+            for (const Frame& frame : frames) {
+                clock.schedule(frame.pts, frame.readyTimeUs, frame.readyTimeUs);
+            }
+            int64_t intervalUs = clock.getStats().frameIntervalUs;
+            if (std::llabs(intervalUs - c.expectedIntervalUs) > 5000) {
+                LOGE("%s: estimated interval %lld us, expected about %lld us", c.name, (long long) intervalUs,
+                     (long long) c.expectedIntervalUs);
+                return false;
+            }
+            LOGD("%s: judder %.2f ms, mean latency %.1f ms, interval %lld us", c.name, r.meanJudderMs,
+                 r.meanLatencyMs, (long long) intervalUs);
+        }
+
+        LOGD("Frame rate test PASSED");
+        return true;
+    }
+
+    bool testLateFramesDropped() {
+        LOGD("=== Testing late frame drop and re-anchoring ===");
+
+        PresentationClock::Config config;
+        PresentationClock clock(config);
+        int64_t readyUs = 1000000;
+        for (int i = 0; i < 20; i++) {
+            clock.schedule(i * 40, readyUs + i * 40000, readyUs + i * 40000);
+        }
+
+        // The display stalls: the next frame is handled long after its presentation time
+        int64_t stalledNowUs = readyUs + 20 * 40000 + 500000;
+        PresentationClock::Decision late = clock.schedule(20 * 40, readyUs + 20 * 40000, stalledNowUs);
+        if (late.action != PresentationClock::DROP_LATE) {
+            LOGE("Frame 500 ms past its presentation time was not dropped");
+            return false;
+        }
+
+        // The pipeline latency steps up by 400 ms for good: late frames until the clock re-anchors
+        int dropped = 0;
+        bool recovered = false;
+        for (int i = 21; i < 40; i++) {
+            int64_t frameReadyUs = readyUs + i * 40000 + 400000;
+            PresentationClock::Decision d = clock.schedule(i * 40, frameReadyUs, frameReadyUs);
+            if (d.action == PresentationClock::DROP_LATE) {
+                dropped++;
+            } else if (dropped > 0) {
+                recovered = true;
+                break;
+            }
+        }
+        PresentationClock::Stats stats = clock.getStats();
+        if (!recovered || dropped > config.maxConsecutiveLate || stats.resets != 1) {
+            LOGE("Recovered %d after %d late frames, resets %llu", recovered, dropped,
+                 (unsigned long long) stats.resets);
+            return false;
+        }
+
+        LOGD("Late frame test PASSED (%d dropped before re-anchoring)", dropped);
+        return true;
+    }
+
+    bool testDiscontinuity() {
+        LOGD("=== Testing PTS discontinuities and unknown PTS ===");
+
+        PresentationClock::Config config;
+        PresentationClock clock(config);
+        for (int i = 0; i < 10; i++) {
+            clock.schedule(100000 + i * 40, 2000000 + i * 40000, 2000000 + i * 40000);
+        }
+
+        // Stream restart: PTS goes back to 0
+        int64_t restartUs = 2000000 + 10 * 40000;
+        PresentationClock::Decision d = clock.schedule(0, restartUs, restartUs);
+        if (d.action != PresentationClock::PRESENT || d.presentTimeUs != restartUs + config.minDelayMs * 1000) {
+            LOGE("Backwards PTS not re-anchored: present at %lld", (long long) d.presentTimeUs);
+            return false;
+        }
+
+        // Forward jump past discontinuityMs
+        int64_t jumpUs = restartUs + 40000;
+        d = clock.schedule(60000, jumpUs, jumpUs);
+        if (d.action != PresentationClock::PRESENT || d.presentTimeUs != jumpUs + config.minDelayMs * 1000 ||
+            clock.getStats().resets != 2) {
+            LOGE("Forward PTS jump not re-anchored: present at %lld", (long long) d.presentTimeUs);
+            return false;
+        }
+
+        // Frames without a PTS are shown immediately
+        d = clock.schedule(-1, jumpUs + 40000, jumpUs + 50000);
+        if (d.action != PresentationClock::PRESENT || d.presentTimeUs != jumpUs + 50000) {
+            LOGE("Frame without PTS not presented immediately");
+            return false;
+        }
+
+        LOGD("Discontinuity test PASSED");
+        return true;
+    }
+
+    bool testClockDrift() {
+        LOGD("=== Testing camera/display clock drift ===");
+
+        // 0.1% either way is well beyond the drift of real camera oscillators
+        double drifts[] = {0.001, -0.001};
+        for (double drift : drifts) {
+            std::vector<Frame> frames = makeStream(5000, 40, 40, 10, drift, 11);
+            PlaybackResult r = playWithClock(frames, 100);
+            if (r.droppedAfterWarmup > 0 || r.maxLatencyMs > 150.0 || r.meanJudderMs > 3.0) {
+                LOGE("Drift %+.3f: dropped %d, max latency %.1f ms, judder %.2f ms", drift, r.droppedAfterWarmup,
+                     r.maxLatencyMs, r.meanJudderMs);
+                return false;
+            }
+            LOGD("Drift %+.3f: mean latency %.1f ms, max %.1f ms, judder %.2f ms", drift, r.meanLatencyMs,
+                 r.maxLatencyMs, r.meanJudderMs);
+        }
+
+        LOGD("Clock drift test PASSED");
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting Presentation Clock Tests");
+
+        int passedTests = 0;
+        int totalTests = 4;
+
+        if (testFrameRates()) passedTests++;
+        if (testLateFramesDropped()) passedTests++;
+        if (testDiscontinuity()) passedTests++;
+        if (testClockDrift()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+extern "C" void runPresentationClockTests() {
+    PresentationClockTest test;
+    test.runAllTests();
+}
+
+/**
+ * Benchmark (simulated time): fixed 25 fps deadlines with a latest-frame
+ * mailbox (before) against PTS scheduling through PresentationClock (after),
+ * for 25 fps, 30 fps and variable-rate streams with jitterMs of arrival jitter.
+ * Judder is the mean difference between the on-screen step and the PTS step.
+ */
+extern "C" void runPresentationClockBenchmark(int numFrames, int jitterMs) {
+    struct Case {
+        const char* name;
+        int minStepMs;
+        int maxStepMs;
+    } cases[] = {
+            {"25 fps", 40, 40},
+            {"30 fps", 33, 34},
+            {"variable", 20, 80},
+    };
+    for (const Case& c : cases) {
+        std::vector<Frame> frames = makeStream(numFrames, c.minStepMs, c.maxStepMs, jitterMs, 0.0, 3);
+        PlaybackResult before = playFixedRate(frames, 25);
+        PlaybackResult after = playWithClock(frames);
+        LOGD("PresentationClock benchmark %s before: %d/%d shown, latency mean %.1f ms max %.1f ms, judder %.2f ms",
+             c.name, before.shown, numFrames, before.meanLatencyMs, before.maxLatencyMs, before.meanJudderMs);
+        LOGD("PresentationClock benchmark %s after: %d/%d shown, latency mean %.1f ms max %.1f ms, judder %.2f ms",
+             c.name, after.shown, numFrames, after.meanLatencyMs, after.maxLatencyMs, after.meanJudderMs);
+    }
+}
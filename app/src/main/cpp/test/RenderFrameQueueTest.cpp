@@ -0,0 +1,338 @@
+#include "display_queue.h"
+#include "log4c.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+std::shared_ptr<frame_data_t> makeFrame(int frameId) {
+    std::shared_ptr<frame_data_t> frame = std::make_shared<frame_data_t>();
+    frame->data.reset(new char[16]);
+    frame->frameId = frameId;
+    frame->screenW = 4;
+    frame->screenH = 1;
+    return frame;
+}
+
+/**
+ * The render queue as it was before the mailbox: std::queue + mutex +
+ * condition variable, a 100 ms wait in pop, an unlocked size check on push,
+ * and the result thread clearing the queue past half of the 60 frame cap.
+ */
+class LegacyRenderQueue {
+public:
+    void push(std::shared_ptr<frame_data_t>& frame) {
+        if (m_queue.size() > 60) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_queue.push(frame);
+        lock.unlock();
+        m_cond.notify_one();
+    }
+
+    std::shared_ptr<frame_data_t> pop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_cond.wait_for(lock, std::chrono::milliseconds(100), [this] { return !m_queue.empty(); })) {
+            return nullptr;
+        }
+        auto data = m_queue.front();
+        m_queue.pop();
+        return data;
+    }
+
+    int size() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_queue.size();
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        while (!m_queue.empty()) {
+            m_queue.pop();
+        }
+    }
+
+private:
+    std::queue<std::shared_ptr<frame_data_t>> m_queue;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+};
+
+struct LatencyResult {
+    int shown;
+    double meanMs;
+    double p95Ms;
+    double maxMs;
+};
+
+LatencyResult summarize(std::vector<double>& latencies) {
+    LatencyResult result = {static_cast<int>(latencies.size()), 0.0, 0.0, 0.0};
+    if (latencies.empty()) {
+        return result;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    double sum = 0.0;
+    for (double l : latencies) {
+        sum += l;
+    }
+    result.meanMs = sum / latencies.size();
+    result.p95Ms = latencies[latencies.size() * 95 / 100];
+    result.maxMs = latencies.back();
+    return result;
+}
+
+// Deterministic arrival jitter of up to +-intervalMs/4, the same sequence for both runs
+int arrivalJitterMs(unsigned int& state, int intervalMs) {
+    state = state * 1103515245u + 12345u;
+    int range = intervalMs / 2 + 1;
+    return static_cast<int>((state >> 16) % range) - intervalMs / 4;
+}
+
+double msSince(const Clock::time_point& start, const Clock::time_point& end) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+}
+
+}  // namespace
+
+/**
+ * Tests for RenderFrameQueue: latest-frame-wins at depth 1, FIFO with drop
+ * accounting at larger depths, release of replaced frames, and ordering
+ * under a concurrent producer and consumer.
+ */
+class RenderFrameQueueTest {
+public:
+    bool testLatestFrameWins() {
+        LOGD("=== Testing latest-frame-wins mailbox ===");
+
+        RenderFrameQueue queue(1, 0);
+        std::weak_ptr<frame_data_t> replaced;
+        for (int i = 0; i < 3; i++) {
+            std::shared_ptr<frame_data_t> frame = makeFrame(i);
+            if (i == 0) {
+                replaced = frame;
+            }
+            queue.push(frame);
+        }
+        if (!replaced.expired()) {
+            LOGE("Replaced frame is still referenced by the mailbox");
+            return false;
+        }
+        std::shared_ptr<frame_data_t> shown = queue.pop();
+        if (!shown || shown->frameId != 2 || queue.pop() || queue.size() != 0) {
+            LOGE("Expected only the newest frame (2), got %d", shown ? shown->frameId : -1);
+            return false;
+        }
+
+        std::shared_ptr<frame_data_t> invalid;
+        queue.push(invalid);
+        RenderFrameQueue::Stats stats = queue.getStats();
+        if (stats.pushed != 3 || stats.popped != 1 || stats.dropped != 2 || stats.invalid != 1) {
+            LOGE("Unexpected stats: pushed %llu popped %llu dropped %llu", (unsigned long long) stats.pushed,
+                 (unsigned long long) stats.popped, (unsigned long long) stats.dropped);
+            return false;
+        }
+
+        LOGD("Latest-frame-wins test PASSED");
+        return true;
+    }
+
+    bool testFifoDepth() {
+        LOGD("=== Testing FIFO depth and drop accounting ===");
+
+        RenderFrameQueue queue(4, 1);
+        int accepted = 0;
+        for (int i = 0; i < 6; i++) {
+            std::shared_ptr<frame_data_t> frame = makeFrame(i);
+            if (queue.push(frame)) {
+                accepted++;
+            }
+        }
+        if (accepted != 4 || queue.size() != 4) {
+            LOGE("Depth-4 queue accepted %d frames (size %d)", accepted, queue.size());
+            return false;
+        }
+        for (int i = 0; i < 2; i++) {
+            std::shared_ptr<frame_data_t> frame = queue.pop();
+            if (!frame || frame->frameId != i) {
+                LOGE("FIFO order broken at %d", i);
+                return false;
+            }
+        }
+        queue.clear();
+        RenderFrameQueue::Stats stats = queue.getStats();
+        if (queue.pop() || stats.popped != 2 || stats.dropped != 4) {
+            LOGE("Unexpected stats after clear: popped %llu dropped %llu", (unsigned long long) stats.popped,
+                 (unsigned long long) stats.dropped);
+            return false;
+        }
+
+        LOGD("FIFO depth test PASSED");
+        return true;
+    }
+
+    bool testConcurrentOrdering(size_t depth) {
+        LOGD("=== Testing concurrent producer/consumer at depth %zu ===", depth);
+
+        RenderFrameQueue queue(depth, 2);
+        const int frames = 50000;
+        std::atomic<bool> done(false);
+        std::thread producer([&]() {
+            for (int i = 0; i < frames; i++) {
+                std::shared_ptr<frame_data_t> frame = makeFrame(i);
+                queue.push(frame);
+            }
+            done = true;
+        });
+
+        int last = -1;
+        bool ordered = true;
+        uint64_t received = 0;
+        for (;;) {
+            bool finished = done.load();
+            std::shared_ptr<frame_data_t> frame = queue.pop();
+            if (frame) {
+                if (frame->frameId <= last) {
+                    ordered = false;
+                }
+                last = frame->frameId;
+                received++;
+            } else if (finished) {
+                break;
+            }
+        }
+        producer.join();
+
+        RenderFrameQueue::Stats stats = queue.getStats();
+        if (!ordered || stats.pushed != (uint64_t) frames || stats.popped != received ||
+            stats.popped + stats.dropped != stats.pushed || (depth == 1 && last != frames - 1)) {
+            LOGE("Ordered %d, pushed %llu popped %llu dropped %llu, last %d", ordered,
+                 (unsigned long long) stats.pushed, (unsigned long long) stats.popped,
+                 (unsigned long long) stats.dropped, last);
+            return false;
+        }
+
+        LOGD("Concurrent test PASSED (shown %llu, dropped %llu)", (unsigned long long) stats.popped,
+             (unsigned long long) stats.dropped);
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting Render Frame Queue Tests");
+
+        int passedTests = 0;
+        int totalTests = 4;
+
+        if (testLatestFrameWins()) passedTests++;
+        if (testFifoDepth()) passedTests++;
+        if (testConcurrentOrdering(1)) passedTests++;
+        if (testConcurrentOrdering(8)) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+extern "C" void runRenderFrameQueueTests() {
+    RenderFrameQueueTest test;
+    test.runAllTests();
+}
+
+/**
+ * Benchmark: queueing delay from push (result ready) to present, for a
+ * producer at intervalMs per frame. "Before" is the legacy queue with the
+ * display loop's fixed 33 ms + 16 ms sleeps and the result thread's clear
+ * at 30 frames; "after" is the depth-1 mailbox polled once per presentation
+ * deadline at the same interval. Frames arrive with up to +-intervalMs/4
+ * jitter; render cost is renderMs in both.
+ */
+extern "C" void runRenderFrameQueueBenchmark(int numFrames, int intervalMs, int renderMs) {
+    std::vector<Clock::time_point> pushedAt(numFrames);
+
+    // Before
+    {
+        LegacyRenderQueue queue;
+        std::vector<double> latencies;
+        std::atomic<bool> producing(true);
+        std::thread display([&]() {
+            while (producing || queue.size() > 0) {
+                std::shared_ptr<frame_data_t> frame = queue.pop();
+                if (!frame) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    continue;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(renderMs));
+                latencies.push_back(msSince(pushedAt[frame->frameId], Clock::now()));
+                std::this_thread::sleep_for(std::chrono::milliseconds(33));
+                std::this_thread::sleep_for(std::chrono::milliseconds(16));
+            }
+        });
+        unsigned int seed = 1;
+        Clock::time_point next = Clock::now();
+        for (int i = 0; i < numFrames; i++) {
+            std::this_thread::sleep_until(next);
+            next += std::chrono::milliseconds(intervalMs + arrivalJitterMs(seed, intervalMs));
+            if (queue.size() > 30) {
+                queue.clear();
+            }
+            std::shared_ptr<frame_data_t> frame = makeFrame(i);
+            pushedAt[i] = Clock::now();
+            queue.push(frame);
+        }
+        producing = false;
+        display.join();
+        LatencyResult r = summarize(latencies);
+        LOGD("RenderFrameQueue benchmark before: %d/%d shown, queueing delay mean %.1f ms, p95 %.1f ms, max %.1f ms",
+             r.shown, numFrames, r.meanMs, r.p95Ms, r.maxMs);
+    }
+
+    // After
+    {
+        RenderFrameQueue queue(1, 0);
+        std::vector<double> latencies;
+        std::atomic<bool> producing(true);
+        std::thread display([&]() {
+            // Deadlines are not aligned with frame arrival; start half an interval out of phase
+            Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(intervalMs / 2);
+            while (producing || queue.size() > 0) {
+                std::this_thread::sleep_until(deadline);
+                deadline += std::chrono::milliseconds(intervalMs);
+                std::shared_ptr<frame_data_t> frame = queue.pop();
+                if (!frame) {
+                    continue;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(renderMs));
+                latencies.push_back(msSince(pushedAt[frame->frameId], Clock::now()));
+            }
+        });
+        unsigned int seed = 1;
+        Clock::time_point next = Clock::now();
+        for (int i = 0; i < numFrames; i++) {
+            std::this_thread::sleep_until(next);
+            next += std::chrono::milliseconds(intervalMs + arrivalJitterMs(seed, intervalMs));
+            std::shared_ptr<frame_data_t> frame = makeFrame(i);
+            pushedAt[i] = Clock::now();
+            queue.push(frame);
+        }
+        producing = false;
+        display.join();
+        LatencyResult r = summarize(latencies);
+        LOGD("RenderFrameQueue benchmark after: %d/%d shown, %llu replaced, queueing delay mean %.1f ms, "
+             "p95 %.1f ms, max %.1f ms", r.shown, numFrames, (unsigned long long) queue.getStats().dropped,
+             r.meanMs, r.p95Ms, r.maxMs);
+    }
+}
@@ -0,0 +1,323 @@
+#include "result_reorder_buffer.h"
+#include "frame_result_slots.h"
+#include "log4c.h"
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace {
+
+typedef ResultReorderBuffer::Clock Clock;
+
+std::shared_ptr<frame_data_t> makeFrame(int frameId) {
+    std::shared_ptr<frame_data_t> frame = std::make_shared<frame_data_t>();
+    frame->data.reset(new char[16]);
+    frame->frameId = frameId;
+    return frame;
+}
+
+// Completed results by frameId; fetch() takes them out, like FrameResultSlots
+class FakeResultSource {
+public:
+    void complete(int frameId) {
+        ResultReorderBuffer::Result result;
+        result.frame = makeFrame(frameId);
+        result.detections.resize(frameId % 3);
+        completed[frameId] = result;
+    }
+
+    ResultReorderBuffer::Fetch fetcher() {
+        return [this](int frameId, ResultReorderBuffer::Result &out) {
+            auto it = completed.find(frameId);
+            if (it == completed.end()) {
+                return false;
+            }
+            out = std::move(it->second);
+            completed.erase(it);
+            return true;
+        };
+    }
+
+    size_t pending() const { return completed.size(); }
+
+private:
+    std::map<int, ResultReorderBuffer::Result> completed;
+};
+
+// Drain everything next() can emit at time now
+std::vector<int> drain(ResultReorderBuffer &buffer, FakeResultSource &source, Clock::time_point now) {
+    std::vector<int> ids;
+    ResultReorderBuffer::Result result;
+    while (buffer.next(source.fetcher(), result, now)) {
+        ids.push_back(result.frameId);
+    }
+    return ids;
+}
+
+std::string describe(const std::vector<int> &ids) {
+    std::string text;
+    for (int id : ids) {
+        text += std::to_string(id) + " ";
+    }
+    return text;
+}
+
+}  // namespace
+
+/**
+ * Tests for ResultReorderBuffer: in-order emission of out-of-order
+ * completions, deadline and window-full skip-ahead, late result draining,
+ * and no skipping when nothing is held back.
+ */
+class ResultReorderBufferTest {
+public:
+    bool testInOrderEmission() {
+        LOGD("=== Testing in-order emission ===");
+
+        ResultReorderBuffer buffer;
+        FakeResultSource source;
+        Clock::time_point t0 = Clock::now();
+
+        source.complete(2);
+        source.complete(1);
+        if (!drain(buffer, source, t0).empty()) {
+            LOGE("Emitted before frame 0 completed");
+            return false;
+        }
+        source.complete(0);
+        source.complete(3);
+        std::vector<int> ids = drain(buffer, source, t0);
+        ResultReorderBuffer::Stats stats = buffer.getStats();
+        if (ids != std::vector<int>({0, 1, 2, 3}) || stats.skipped != 0 || stats.maxDepth != 4 ||
+            buffer.nextFrameId() != 4) {
+            LOGE("Expected 0 1 2 3, got %s(max depth %d)", describe(ids).c_str(), stats.maxDepth);
+            return false;
+        }
+
+        LOGD("In-order emission test PASSED");
+        return true;
+    }
+
+    bool testDeadlineSkip() {
+        LOGD("=== Testing deadline skip and late results ===");
+
+        ResultReorderBuffer::Config config;
+        config.window = 8;
+        config.deadlineMs = 100;
+        ResultReorderBuffer buffer(config);
+        FakeResultSource source;
+        Clock::time_point t0 = Clock::now();
+
+        // Frame 0 is slow; 1 and 2 are done and held back
+        source.complete(1);
+        source.complete(2);
+        if (!drain(buffer, source, t0).empty() ||
+            !drain(buffer, source, t0 + std::chrono::milliseconds(99)).empty()) {
+            LOGE("Frame 0 skipped before its deadline");
+            return false;
+        }
+        std::vector<int> ids = drain(buffer, source, t0 + std::chrono::milliseconds(100));
+        if (ids != std::vector<int>({1, 2}) || buffer.getStats().skipped != 1) {
+            LOGE("Expected 1 2 after the deadline, got %s", describe(ids).c_str());
+            return false;
+        }
+
+        // Frame 0 finishes after all: fetched and dropped, not emitted
+        source.complete(0);
+        source.complete(3);
+        ids = drain(buffer, source, t0 + std::chrono::milliseconds(120));
+        ResultReorderBuffer::Stats stats = buffer.getStats();
+        if (ids != std::vector<int>({3}) || stats.late != 1 || source.pending() != 0) {
+            LOGE("Expected 3 with one late result, got %s(late %llu, pending %zu)", describe(ids).c_str(),
+                 (unsigned long long) stats.late, source.pending());
+            return false;
+        }
+
+        LOGD("Deadline skip test PASSED");
+        return true;
+    }
+
+    bool testWindowFullSkip() {
+        LOGD("=== Testing window-full skip-ahead ===");
+
+        ResultReorderBuffer::Config config;
+        config.window = 4;
+        config.deadlineMs = 10000;
+        ResultReorderBuffer buffer(config);
+        FakeResultSource source;
+        Clock::time_point t0 = Clock::now();
+
+        // Frames 0 and 4 never complete; 1-3 and 5-7 fill the window behind them
+        for (int id : {1, 2, 3, 5, 6, 7}) {
+            source.complete(id);
+        }
+        std::vector<int> ids = drain(buffer, source, t0);
+        ResultReorderBuffer::Stats stats = buffer.getStats();
+        if (ids != std::vector<int>({1, 2, 3, 5, 6, 7}) || stats.skipped != 2 || stats.maxDepth != 3) {
+            LOGE("Expected 1 2 3 5 6 7, got %s(skipped %llu)", describe(ids).c_str(),
+                 (unsigned long long) stats.skipped);
+            return false;
+        }
+
+        LOGD("Window-full skip test PASSED");
+        return true;
+    }
+
+    bool testNoSkipWithoutBacklog() {
+        LOGD("=== Testing a slow head with nothing behind it ===");
+
+        ResultReorderBuffer buffer;
+        FakeResultSource source;
+        Clock::time_point t0 = Clock::now();
+
+        // The whole pipeline is slow: waiting for frame 0 holds nothing back, so it is not skipped
+        if (!drain(buffer, source, t0 + std::chrono::seconds(5)).empty()) {
+            LOGE("Emitted with nothing completed");
+            return false;
+        }
+        source.complete(0);
+        std::vector<int> ids = drain(buffer, source, t0 + std::chrono::seconds(6));
+        if (ids != std::vector<int>({0}) || buffer.getStats().skipped != 0) {
+            LOGE("Expected 0 without skips, got %s", describe(ids).c_str());
+            return false;
+        }
+
+        LOGD("No-backlog test PASSED");
+        return true;
+    }
+
+    bool testWithResultSlots() {
+        LOGD("=== Testing against FrameResultSlots ===");
+
+        FrameResultSlots slots(16);
+        ResultReorderBuffer buffer;
+        ResultReorderBuffer::Fetch fetch = [&slots](int frameId, ResultReorderBuffer::Result &out) {
+            if (slots.takeResult(frameId, out.detections, 0) != NN_SUCCESS) {
+                return false;
+            }
+            out.frame = slots.takeImage(frameId);
+            return true;
+        };
+        Clock::time_point t0 = Clock::now();
+
+        std::weak_ptr<frame_data_t> lateFrame;
+        for (int id = 1; id < 4; id++) {
+            slots.complete(id, std::vector<Detection>(), makeFrame(id));
+        }
+        ResultReorderBuffer::Result result;
+        std::vector<int> ids;
+        buffer.next(fetch, result, t0);
+        while (buffer.next(fetch, result, t0 + std::chrono::milliseconds(200))) {
+            ids.push_back(result.frameId);
+        }
+        {
+            std::shared_ptr<frame_data_t> frame0 = makeFrame(0);
+            lateFrame = frame0;
+            slots.complete(0, std::vector<Detection>(), frame0);
+        }
+        buffer.next(fetch, result, t0 + std::chrono::milliseconds(250));
+        if (ids != std::vector<int>({1, 2, 3}) || !lateFrame.expired() || slots.overwrittenCount() != 0) {
+            LOGE("Expected 1 2 3 and the late frame released, got %s(late frame %s)", describe(ids).c_str(),
+                 lateFrame.expired() ? "released" : "still held");
+            return false;
+        }
+
+        LOGD("FrameResultSlots test PASSED");
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting Result Reorder Buffer Tests");
+
+        int passedTests = 0;
+        int totalTests = 5;
+
+        if (testInOrderEmission()) passedTests++;
+        if (testDeadlineSkip()) passedTests++;
+        if (testWindowFullSkip()) passedTests++;
+        if (testNoSkipWithoutBacklog()) passedTests++;
+        if (testWithResultSlots()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+extern "C" void runResultReorderBufferTests() {
+    ResultReorderBufferTest test;
+    test.runAllTests();
+}
+
+/**
+ * Benchmark (simulated time, 1 ms steps): frames submitted every intervalMs
+ * finish after 20-60 ms of inference; one in slowEvery takes 400 ms and one in
+ * lostEvery never completes. "Before" waits for the next frameId only, as
+ * get_detect_result did; "after" uses ResultReorderBuffer with the default
+ * window and deadline. Reports frames delivered and the mean hold time from
+ * completion to delivery.
+ */
+extern "C" void runResultReorderBufferBenchmark(int numFrames, int intervalMs, int slowEvery, int lostEvery) {
+    std::vector<int> doneAtMs(numFrames);
+    unsigned int seed = 5;
+    for (int i = 0; i < numFrames; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int inferenceMs = 20 + (int) ((seed >> 16) % 41);
+        if (lostEvery > 0 && i % lostEvery == lostEvery - 1) {
+            doneAtMs[i] = -1;
+        } else {
+            doneAtMs[i] = i * intervalMs + (slowEvery > 0 && i % slowEvery == slowEvery - 1 ? 400 : inferenceMs);
+        }
+    }
+    std::vector<std::pair<int, int>> completions;  // (doneAtMs, frameId)
+    for (int i = 0; i < numFrames; i++) {
+        if (doneAtMs[i] >= 0) {
+            completions.push_back(std::make_pair(doneAtMs[i], i));
+        }
+    }
+    std::sort(completions.begin(), completions.end());
+    const int endMs = numFrames * intervalMs + 1000;
+
+    for (int pass = 0; pass < 2; pass++) {
+        FakeResultSource source;
+        ResultReorderBuffer buffer;
+        Clock::time_point t0 = Clock::now();
+        int nextStrict = 0;
+        int delivered = 0;
+        double holdSum = 0.0;
+        size_t completed = 0;
+        for (int t = 0; t <= endMs; t++) {
+            while (completed < completions.size() && completions[completed].first == t) {
+                source.complete(completions[completed++].second);
+            }
+            ResultReorderBuffer::Result result;
+            ResultReorderBuffer::Fetch fetch = source.fetcher();
+            for (;;) {
+                int id;
+                if (pass == 0) {
+                    if (nextStrict >= numFrames || !fetch(nextStrict, result)) {
+                        break;
+                    }
+                    id = nextStrict++;
+                } else {
+                    if (!buffer.next(fetch, result, t0 + std::chrono::milliseconds(t))) {
+                        break;
+                    }
+                    id = result.frameId;
+                }
+                delivered++;
+                holdSum += t - doneAtMs[id];
+            }
+        }
+        ResultReorderBuffer::Stats stats = buffer.getStats();
+        LOGD("ResultReorderBuffer benchmark %s: %d/%d frames delivered, mean hold %.1f ms, skipped %llu, "
+             "late %llu, max reorder depth %d", pass == 0 ? "before" : "after", delivered, numFrames,
+             delivered ? holdSum / delivered : 0.0, (unsigned long long) stats.skipped,
+             (unsigned long long) stats.late, stats.maxDepth);
+    }
+}
@@ -0,0 +1,455 @@
+#include "SortTracker.h"
+#include "DetectionCadence.h"
+#include "log4c.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+Detection makeDetection(int classId, int x, int y, int width, int height, float confidence = 0.9f) {
+    Detection detection;
+    detection.class_id = classId;
+    detection.className = classId == 0 ? "person" : "car";
+    detection.confidence = confidence;
+    detection.box = cv::Rect(x, y, width, height);
+    return detection;
+}
+
+// One detected frame; returns the detections with track_id and velocity filled in
+std::vector<Detection> track(SortTracker& tracker, std::vector<Detection> detections) {
+    tracker.update(detections);
+    return detections;
+}
+
+int idOfClass(const std::vector<Detection>& detections, int classId) {
+    for (const Detection& detection : detections) {
+        if (detection.class_id == classId) {
+            return detection.track_id;
+        }
+    }
+    return -2;
+}
+
+float centreDistance(const cv::Rect& a, const cv::Rect& b) {
+    float dx = (a.x + a.width * 0.5f) - (b.x + b.width * 0.5f);
+    float dy = (a.y + a.height * 0.5f) - (b.y + b.height * 0.5f);
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+float boxIou(const cv::Rect& a, const cv::Rect& b) {
+    int intersection = (a & b).area();
+    int combined = a.area() + b.area() - intersection;
+    return combined > 0 ? (float) intersection / combined : 0.0f;
+}
+
+// Deterministic pseudo-random value in [lo, hi]
+int nextRandom(unsigned int& state, int lo, int hi) {
+    state = state * 1103515245u + 12345u;
+    return lo + static_cast<int>((state >> 16) % static_cast<unsigned int>(hi - lo + 1));
+}
+
+}  // namespace
+
+/**
+ * Tests for SortTracker and DetectionCadence: constant-velocity propagation,
+ * class-aware IoU association, stable ids through crossings and skipped
+ * frames, ByteTrack low-score association, track ageing, and fixed and
+ * adaptive cadences.
+ */
+class SortTrackerTest {
+public:
+    bool testConstantVelocityPropagation() {
+        LOGD("=== Testing constant-velocity propagation ===");
+
+        SortTracker tracker;
+        // 6 px/frame to the right, 2 px/frame down
+        for (int frame = 0; frame < 6; frame++) {
+            track(tracker, {makeDetection(0, 100 + 6 * frame, 50 + 2 * frame, 40, 80)});
+        }
+        for (int frame = 6; frame < 9; frame++) {
+            std::vector<Detection> predicted = tracker.predict();
+            cv::Rect truth(100 + 6 * frame, 50 + 2 * frame, 40, 80);
+            if (predicted.size() != 1 || centreDistance(predicted[0].box, truth) > 2.0f ||
+                std::abs(predicted[0].box.width - truth.width) > 2 || predicted[0].className != "person") {
+                LOGE("Frame %d: predicted %zu boxes, distance %.1f px", frame, predicted.size(),
+                     predicted.empty() ? -1.0f : centreDistance(predicted[0].box, truth));
+                return false;
+            }
+        }
+        if (tracker.motion() < 0.05f || tracker.motion() > 0.15f) {
+            LOGE("Expected about 0.11 box sizes per frame, got %.3f", tracker.motion());
+            return false;
+        }
+
+        LOGD("Constant-velocity propagation test PASSED");
+        return true;
+    }
+
+    bool testAssociation() {
+        LOGD("=== Testing class-aware IoU association ===");
+
+        SortTracker tracker;
+        // A person and a car overlapping each other; each keeps its own class and track
+        track(tracker, {makeDetection(0, 100, 100, 50, 100), makeDetection(1, 110, 120, 120, 60)});
+        track(tracker, {makeDetection(1, 114, 120, 120, 60), makeDetection(0, 96, 100, 50, 100)});
+        std::vector<Detection> predicted = tracker.predict();
+        if (predicted.size() != 2 || tracker.trackCount() != 2) {
+            LOGE("Expected 2 tracks, got %zu predicted, %d tracks", predicted.size(), tracker.trackCount());
+            return false;
+        }
+        for (const Detection& detection : predicted) {
+            int expectedX = detection.class_id == 0 ? 92 : 118;
+            if (std::abs(detection.box.x - expectedX) > 3) {
+                LOGE("Class %d predicted at x=%d, expected about %d", detection.class_id, detection.box.x, expectedX);
+                return false;
+            }
+        }
+
+        // A detection far from every track starts a new one
+        track(tracker, {makeDetection(0, 92, 100, 50, 100), makeDetection(1, 122, 120, 120, 60),
+                        makeDetection(0, 600, 300, 40, 40)});
+        if (tracker.trackCount() != 3) {
+            LOGE("Expected a new track for the far detection, got %d tracks", tracker.trackCount());
+            return false;
+        }
+
+        LOGD("Association test PASSED");
+        return true;
+    }
+
+    bool testStableIds() {
+        LOGD("=== Testing stable ids and velocities ===");
+
+        SortTracker tracker;
+        // Two people crossing each other, detected every other frame
+        int idA = -1;
+        int idB = -1;
+        for (int frame = 0; frame < 40; frame++) {
+            int xA = 100 + 5 * frame;
+            int xB = 300 - 5 * frame;
+            std::vector<Detection> shown;
+            if (frame % 2 == 0) {
+                shown = track(tracker, {makeDetection(0, xA, 100, 40, 90), makeDetection(0, xB, 130, 40, 90)});
+            } else {
+                shown = tracker.predict();
+            }
+            if (shown.size() != 2) {
+                LOGE("Frame %d: expected 2 boxes, got %zu", frame, shown.size());
+                return false;
+            }
+            for (const Detection& detection : shown) {
+                bool isA = detection.box.y < 115;
+                int& id = isA ? idA : idB;
+                if (id < 0) {
+                    id = detection.track_id;
+                } else if (id != detection.track_id) {
+                    LOGE("Frame %d: %s changed id %d -> %d", frame, isA ? "A" : "B", id, detection.track_id);
+                    return false;
+                }
+                float expectedVx = isA ? 5.0f : -5.0f;
+                if (frame >= 6 && std::abs(detection.velocity.x - expectedVx) > 1.0f) {
+                    LOGE("Frame %d: velocity %.2f, expected %.0f", frame, detection.velocity.x, expectedVx);
+                    return false;
+                }
+            }
+        }
+        if (idA == idB || idA < 0 || idB < 0) {
+            LOGE("Expected two distinct ids, got %d and %d", idA, idB);
+            return false;
+        }
+
+        LOGD("Stable ids test PASSED");
+        return true;
+    }
+
+    bool testLowScoreAssociation() {
+        LOGD("=== Testing ByteTrack low-score association ===");
+
+        SortTracker tracker;
+        int id = idOfClass(track(tracker, {makeDetection(1, 200, 200, 100, 60)}), 1);
+        // Partly occluded: the score drops below highThreshold but the box still continues the track
+        std::vector<Detection> weak = track(tracker, {makeDetection(1, 202, 200, 100, 60, 0.35f)});
+        if (idOfClass(weak, 1) != id || tracker.trackCount() != 1) {
+            LOGE("Low-score detection did not keep track %d (got %d)", id, idOfClass(weak, 1));
+            return false;
+        }
+        // A low-score detection with no track is left untracked and starts nothing
+        std::vector<Detection> stray = track(tracker, {makeDetection(1, 204, 200, 100, 60),
+                                                       makeDetection(0, 800, 400, 30, 60, 0.3f)});
+        if (idOfClass(stray, 0) != -1 || idOfClass(stray, 1) != id || tracker.trackCount() != 1) {
+            LOGE("Expected the stray low-score detection untracked (id %d, %d tracks)", idOfClass(stray, 0),
+                 tracker.trackCount());
+            return false;
+        }
+
+        LOGD("Low-score association test PASSED");
+        return true;
+    }
+
+    bool testTrackAgeing() {
+        LOGD("=== Testing track ageing ===");
+
+        SortTracker::Config config;
+        config.maxAge = 2;
+        SortTracker tracker(config);
+        track(tracker, {makeDetection(0, 100, 100, 50, 50)});
+
+        // Missed once: kept, but no longer reported on predicted frames
+        track(tracker, {});
+        if (tracker.trackCount() != 1 || !tracker.predict().empty()) {
+            LOGE("Missed track should be kept but not reported");
+            return false;
+        }
+        // Re-associated after the miss
+        track(tracker, {makeDetection(0, 102, 100, 50, 50)});
+        if (tracker.trackCount() != 1 || tracker.predict().size() != 1) {
+            LOGE("Track not re-associated after a miss (%d tracks)", tracker.trackCount());
+            return false;
+        }
+        // Deleted after more than maxAge misses in a row
+        for (int i = 0; i < 3; i++) {
+            track(tracker, {});
+        }
+        if (tracker.trackCount() != 0) {
+            LOGE("Expected the track deleted, %d left", tracker.trackCount());
+            return false;
+        }
+
+        LOGD("Track ageing test PASSED");
+        return true;
+    }
+
+    bool testFixedCadence() {
+        LOGD("=== Testing fixed cadence ===");
+
+        DetectionCadence::Config config;
+        config.interval = 3;
+        DetectionCadence cadence(config);
+        std::string pattern;
+        for (int i = 0; i < 9; i++) {
+            pattern += cadence.shouldDetect(0.0f) ? 'D' : '.';
+        }
+        DetectionCadence::Stats stats = cadence.getStats();
+        if (pattern != "D..D..D.." || stats.detected != 3 || stats.skipped != 6) {
+            LOGE("Expected D..D..D.., got %s", pattern.c_str());
+            return false;
+        }
+
+        LOGD("Fixed cadence test PASSED");
+        return true;
+    }
+
+    bool testAdaptiveCadence() {
+        LOGD("=== Testing adaptive cadence ===");
+
+        DetectionCadence::Config config;
+        config.adaptive = true;
+        config.maxInterval = 6;
+        config.maxDriftRatio = 0.25f;
+        config.highLoad = 0.5f;
+        DetectionCadence cadence(config);
+
+        // Static scene: every maxInterval-th frame
+        cadence.shouldDetect(0.0f);
+        for (int i = 0; i < 5; i++) {
+            cadence.shouldDetect(0.0f);
+        }
+        if (cadence.getStats().interval != 6 || cadence.getStats().detected != 1) {
+            LOGE("Static scene: expected interval 6, got %d", cadence.getStats().interval);
+            return false;
+        }
+
+        // 0.1 box sizes per frame: 0.25 / 0.1 -> every 2nd frame; the shorter interval applies at once
+        cadence.reportMotion(0.1f);
+        if (!cadence.shouldDetect(0.0f) || cadence.getStats().interval != 2) {
+            LOGE("Moving scene: expected interval 2 and an immediate detection, got %d", cadence.getStats().interval);
+            return false;
+        }
+        // Loaded inference queue doubles it
+        cadence.shouldDetect(0.8f);
+        if (cadence.getStats().interval != 4) {
+            LOGE("High load: expected interval 4, got %d", cadence.getStats().interval);
+            return false;
+        }
+        // Fast motion: every frame
+        cadence.reportMotion(1.0f);
+        if (!cadence.shouldDetect(0.0f) || !cadence.shouldDetect(0.0f)) {
+            LOGE("Fast motion: expected every frame detected");
+            return false;
+        }
+
+        LOGD("Adaptive cadence test PASSED");
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting Sort Tracker Tests");
+
+        int passedTests = 0;
+        int totalTests = 7;
+
+        if (testConstantVelocityPropagation()) passedTests++;
+        if (testAssociation()) passedTests++;
+        if (testStableIds()) passedTests++;
+        if (testLowScoreAssociation()) passedTests++;
+        if (testTrackAgeing()) passedTests++;
+        if (testFixedCadence()) passedTests++;
+        if (testAdaptiveCadence()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+extern "C" void runSortTrackerTests() {
+    SortTrackerTest test;
+    test.runAllTests();
+}
+
+/**
+ * Benchmark (synthetic scene, no NPU): numObjects boxes move at constant
+ * velocity; a "detection" is the true box with up to 3 px of noise. For each
+ * detect interval 1..maxInterval, reports NPU invocations per frame and the
+ * mean IoU of the displayed boxes against the true boxes: tracker predictions
+ * on skipped frames versus holding the last detections.
+ */
+extern "C" void runDetectionCadenceBenchmark(int numFrames, int numObjects, int maxInterval) {
+    struct Object {
+        float x, y, vx, vy;
+        int width, height;
+    };
+    for (int interval = 1; interval <= maxInterval; interval++) {
+        unsigned int seed = 11;
+        std::vector<Object> objects;
+        for (int i = 0; i < numObjects; i++) {
+            Object object;
+            object.x = (float) nextRandom(seed, 100, 1500);
+            object.y = (float) nextRandom(seed, 100, 800);
+            object.vx = nextRandom(seed, -60, 60) / 10.0f;
+            object.vy = nextRandom(seed, -30, 30) / 10.0f;
+            object.width = nextRandom(seed, 40, 160);
+            object.height = nextRandom(seed, 60, 200);
+            objects.push_back(object);
+        }
+
+        DetectionCadence::Config config;
+        config.interval = interval;
+        DetectionCadence cadence(config);
+        SortTracker tracker;
+        double iouSum = 0.0;
+        double heldIouSum = 0.0;
+        std::vector<Detection> lastDetections;
+        int boxes = 0;
+        int missing = 0;
+        for (int frame = 0; frame < numFrames; frame++) {
+            std::vector<cv::Rect> truth;
+            for (Object& object : objects) {
+                truth.push_back(cv::Rect(cvRound(object.x), cvRound(object.y), object.width, object.height));
+                object.x += object.vx;
+                object.y += object.vy;
+            }
+
+            std::vector<Detection> shown;
+            if (cadence.shouldDetect(0.0f)) {
+                for (size_t i = 0; i < truth.size(); i++) {
+                    const cv::Rect& box = truth[i];
+                    shown.push_back(makeDetection((int) i % 2, box.x + nextRandom(seed, -3, 3),
+                                                  box.y + nextRandom(seed, -3, 3), box.width, box.height));
+                }
+                tracker.update(shown);
+                lastDetections = shown;
+            } else {
+                shown = tracker.predict();
+            }
+
+            for (const cv::Rect& box : truth) {
+                float best = 0.0f;
+                for (const Detection& detection : shown) {
+                    best = std::max(best, boxIou(box, detection.box));
+                }
+                float held = 0.0f;
+                for (const Detection& detection : lastDetections) {
+                    held = std::max(held, boxIou(box, detection.box));
+                }
+                if (best == 0.0f) {
+                    missing++;
+                }
+                iouSum += best;
+                heldIouSum += held;
+                boxes++;
+            }
+        }
+        DetectionCadence::Stats stats = cadence.getStats();
+        LOGD("Detection cadence benchmark: interval %d, NPU frames %llu/%d (%.2f per frame), mean IoU %.3f "
+             "tracked vs %.3f held, boxes missing %d", interval, (unsigned long long) stats.detected, numFrames,
+             (double) stats.detected / numFrames, boxes ? iouSum / boxes : 0.0, boxes ? heldIouSum / boxes : 0.0,
+             missing);
+    }
+}
+
+/**
+ * Benchmark (host-side, synthetic): numObjects boxes of two classes move at
+ * constant velocity with up to 3 px of detection noise and are detected every
+ * frame. Reports the mean update() time and id switches (an object's track id
+ * changing after it was first assigned).
+ */
+extern "C" void runSortTrackerBenchmark(int numFrames, int numObjects) {
+    struct Object {
+        float x, y, vx, vy;
+        int width, height;
+    };
+    unsigned int seed = 23;
+    std::vector<Object> objects;
+    for (int i = 0; i < numObjects; i++) {
+        Object object;
+        object.x = (float) nextRandom(seed, 0, 3600);
+        object.y = (float) nextRandom(seed, 0, 2000);
+        object.vx = nextRandom(seed, -40, 40) / 10.0f;
+        object.vy = nextRandom(seed, -20, 20) / 10.0f;
+        object.width = nextRandom(seed, 30, 120);
+        object.height = nextRandom(seed, 40, 160);
+        objects.push_back(object);
+    }
+
+    SortTracker tracker;
+    std::vector<int> assigned(numObjects, -1);
+    int switches = 0;
+    double totalUs = 0.0;
+    std::vector<Detection> detections;
+    for (int frame = 0; frame < numFrames; frame++) {
+        detections.clear();
+        for (int i = 0; i < numObjects; i++) {
+            Object& object = objects[i];
+            detections.push_back(makeDetection(i % 2, cvRound(object.x) + nextRandom(seed, -3, 3),
+                                               cvRound(object.y) + nextRandom(seed, -3, 3), object.width, object.height));
+            object.x += object.vx;
+            object.y += object.vy;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        tracker.update(detections);
+        totalUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        // update() annotates in place, so detections[i] is still object i
+        for (int i = 0; i < numObjects; i++) {
+            int id = detections[i].track_id;
+            if (id < 0) {
+                continue;
+            }
+            if (assigned[i] >= 0 && assigned[i] != id) {
+                switches++;
+            }
+            assigned[i] = id;
+        }
+    }
+    LOGD("SortTracker benchmark: %d objects, %d frames, %.1f us per update, %d id switches, %d tracks",
+         numObjects, numFrames, totalUs / numFrames, switches, tracker.trackCount());
+}
@@ -0,0 +1,36 @@
+#ifndef STUB_NN_ENGINE_H
+#define STUB_NN_ENGINE_H
+
+#include "cpu_engine.h"
+
+/**
+ * CPU stub for NNEngine used by the off-NPU tests and benchmarks: a
+ * CPUEngine with no synthetic objects.
+ *
+ * Reports a YOLOv5 640x640 NHWC uint8 input and the three int8 heads
+ * (80x80, 40x40, 20x20, 255 channels). Run() sleeps for the configured
+ * inference time (an NPU call blocks the calling thread, it does not spin)
+ * and fills every output with the minimum int8 value, so post-processing
+ * finds no boxes and costs almost nothing.
+ *
+ * With maxBatch > 1 the model reports a batch dimension and RunBatch() costs
+ * inferenceUs + K * perItemUs for K frames, i.e. a fixed per-call overhead
+ * plus a per-frame cost, which is what the batching policy trades against.
+ */
+class StubNNEngine : public CPUEngine {
+public:
+    explicit StubNNEngine(int inferenceUs = 0, int inputSize = 640, int maxBatch = 1, int perItemUs = 0)
+            : CPUEngine(makeConfig(inferenceUs, inputSize, maxBatch, perItemUs)) {}
+
+private:
+    static cpu_engine_config_s makeConfig(int inferenceUs, int inputSize, int maxBatch, int perItemUs) {
+        cpu_engine_config_s config = cpu_engine_default_config();
+        config.input_size = inputSize;
+        config.max_batch = maxBatch;
+        config.latency_us = inferenceUs;
+        config.per_item_us = perItemUs;
+        return config;
+    }
+};
+
+#endif // STUB_NN_ENGINE_H
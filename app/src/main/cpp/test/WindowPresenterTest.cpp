@@ -0,0 +1,337 @@
+#include "WindowPresenter.h"
+#include "FrameConverter.h"
+#include "log4c.h"
+#include "rga.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+const uint8_t kWindowPadding = 0xEE;
+
+// Off-device stand-in for ANativeWindow: each geometry allocates exactly stride * height pixels
+// (stride = width rounded up to 64 like the gralloc buffers), padding filled with kWindowPadding
+class FakeWindow : public PresentWindow {
+public:
+    int geometryCalls = 0;
+    int locks = 0;
+    int posts = 0;
+    int32_t failGeometry = 0;  // Non-zero: returned by the next setBuffersGeometry
+    int32_t failLock = 0;      // Non-zero: returned by the next lock
+    bool locked = false;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+    std::vector<uint8_t> pixels;
+
+    int32_t setBuffersGeometry(int32_t w, int32_t h) override {
+        geometryCalls++;
+        if (failGeometry != 0) {
+            int32_t result = failGeometry;
+            failGeometry = 0;
+            return result;
+        }
+        width = w;
+        height = h;
+        stride = (w + 63) / 64 * 64;
+        pixels.assign((size_t) stride * h * 4, kWindowPadding);
+        return 0;
+    }
+
+    int32_t lock(ANativeWindow_Buffer& buffer) override {
+        if (failLock != 0) {
+            int32_t result = failLock;
+            failLock = 0;
+            return result;
+        }
+        locks++;
+        locked = true;
+        buffer.width = width;
+        buffer.height = height;
+        buffer.stride = stride;
+        buffer.format = WINDOW_FORMAT_RGBA_8888;
+        buffer.bits = pixels.data();
+        return 0;
+    }
+
+    int32_t unlockAndPost() override {
+        if (!locked) {
+            return -1;
+        }
+        locked = false;
+        posts++;
+        return 0;
+    }
+
+    const uint8_t* row(int y) const { return pixels.data() + (size_t) y * stride * 4; }
+
+    // Every byte right of the width x height image is still padding
+    bool paddingIntact(int w, int h) const {
+        for (int y = 0; y < height; y++) {
+            for (int x = (y < h ? w : 0) * 4; x < stride * 4; x++) {
+                if (row(y)[x] != kWindowPadding) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+// The presenter owns its window; tests keep a pointer to inspect it
+FakeWindow* attachFake(WindowPresenter& presenter) {
+    FakeWindow* fake = new FakeWindow();
+    presenter.setWindow(std::unique_ptr<PresentWindow>(fake));
+    return fake;
+}
+
+// RGBA image with exactly srcStride * height bytes, so reading past a row's last pixel on the
+// last row is caught by ASan
+std::vector<uint8_t> makeRGBA(int width, int height, int srcStride, unsigned seed) {
+    std::vector<uint8_t> image((size_t) srcStride * (height - 1) + width * 4);
+    srand(seed);
+    for (uint8_t& byte : image) {
+        byte = (uint8_t) (rand() & 0xFF);
+    }
+    return image;
+}
+
+std::shared_ptr<frame_data_t> makeNV12Frame(int width, int height, int widthStride, int heightStride, unsigned seed) {
+    auto frame = std::make_shared<frame_data_t>();
+    size_t size = (size_t) widthStride * heightStride * 3 / 2;
+    frame->data.reset(new char[size]);
+    uint8_t* data = reinterpret_cast<uint8_t*>(frame->data.get());
+    srand(seed);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (uint8_t) (rand() & 0xFF);
+    }
+    frame->dataSize = size;
+    frame->screenW = width;
+    frame->screenH = height;
+    frame->screenStride = widthStride;
+    frame->widthStride = widthStride;
+    frame->heightStride = heightStride;
+    frame->frameFormat = RK_FORMAT_YCbCr_420_SP;
+    return frame;
+}
+
+}  // namespace
+
+/**
+ * Tests for presenting straight into the window buffer through a fake window:
+ * geometry set only on size change, stride-correct RGBA copies and NV12
+ * conversion into a padded window buffer, and the failure paths.
+ */
+class WindowPresenterTest {
+public:
+    bool testGeometryOnSizeChange() {
+        LOGD("=== Testing geometry only on size change ===");
+
+        WindowPresenter presenter;
+        FakeWindow* fake = attachFake(presenter);
+        std::vector<uint8_t> small = makeRGBA(64, 36, 64 * 4, 1);
+        std::vector<uint8_t> large = makeRGBA(100, 50, 100 * 4, 2);
+
+        for (int i = 0; i < 5; i++) {
+            presenter.presentRGBA(small.data(), 64, 36, 64 * 4);
+        }
+        if (fake->geometryCalls != 1 || fake->posts != 5) {
+            LOGE("Same size: %d geometry calls, %d posts (expected 1, 5)", fake->geometryCalls, fake->posts);
+            return false;
+        }
+
+        presenter.presentRGBA(large.data(), 100, 50, 100 * 4);
+        presenter.presentRGBA(large.data(), 100, 50, 100 * 4);
+        presenter.presentRGBA(small.data(), 64, 36, 64 * 4);
+        if (fake->geometryCalls != 3) {
+            LOGE("Two size changes: %d geometry calls (expected 3)", fake->geometryCalls);
+            return false;
+        }
+
+        // A new window gets its geometry on the first frame even at the same size
+        fake = attachFake(presenter);
+        presenter.presentRGBA(small.data(), 64, 36, 64 * 4);
+        presenter.presentRGBA(small.data(), 64, 36, 64 * 4);
+        WindowPresenter::Stats stats = presenter.getStats();
+        if (fake->geometryCalls != 1 || stats.geometryChanges != 4 || stats.presented != 10) {
+            LOGE("New window: %d geometry calls, %llu changes, %llu presented", fake->geometryCalls,
+                 (unsigned long long) stats.geometryChanges, (unsigned long long) stats.presented);
+            return false;
+        }
+
+        LOGD("Geometry test passed");
+        return true;
+    }
+
+    bool testRGBAStrides() {
+        LOGD("=== Testing RGBA copy with source and window strides ===");
+
+        // Window stride wider than the frame (the old copy read dst_linesize bytes from every source row),
+        // padded source rows, and a width that is already 64-aligned (equal strides, single copy)
+        const int cases[][3] = {{100, 30, 100 * 4}, {100, 30, 112 * 4}, {128, 20, 128 * 4}, {37, 9, 40 * 4}};
+        for (const auto& c : cases) {
+            int width = c[0], height = c[1], srcStride = c[2];
+            std::vector<uint8_t> src = makeRGBA(width, height, srcStride, 3);
+            WindowPresenter presenter;
+            FakeWindow* fake = attachFake(presenter);
+            if (!presenter.presentRGBA(src.data(), width, height, srcStride)) {
+                LOGE("%dx%d (stride %d): present failed", width, height, srcStride);
+                return false;
+            }
+            for (int y = 0; y < height; y++) {
+                if (memcmp(fake->row(y), src.data() + (size_t) y * srcStride, width * 4) != 0) {
+                    LOGE("%dx%d (stride %d): row %d differs", width, height, srcStride, y);
+                    return false;
+                }
+            }
+            bool equalStrides = srcStride == fake->stride * 4;
+            if (!equalStrides && !fake->paddingIntact(width, height)) {
+                LOGE("%dx%d (stride %d): window padding overwritten", width, height, srcStride);
+                return false;
+            }
+        }
+
+        LOGD("RGBA stride test passed");
+        return true;
+    }
+
+    bool testNV12IntoWindow() {
+        LOGD("=== Testing NV12 conversion into the window buffer ===");
+
+        auto frame = makeNV12Frame(90, 50, 128, 64, 4);
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(frame->data.get());
+        std::vector<uint8_t> expected(90 * 50 * 4);
+        FrameConverter::nv12ToRGBA(data, data + 128 * 64, 128, 90, 50, expected.data(), 90 * 4);
+
+        WindowPresenter presenter;
+        FakeWindow* fake = attachFake(presenter);
+        if (!presenter.present(*frame, false)) {
+            LOGE("NV12 present failed");
+            return false;
+        }
+        for (int y = 0; y < 50; y++) {
+            if (memcmp(fake->row(y), &expected[y * 90 * 4], 90 * 4) != 0) {
+                LOGE("NV12 row %d differs from the CPU conversion", y);
+                return false;
+            }
+        }
+        if (!fake->paddingIntact(90, 50) || fake->stride != 128) {
+            LOGE("NV12: window padding overwritten or unexpected stride %d", fake->stride);
+            return false;
+        }
+
+        LOGD("NV12 window test passed");
+        return true;
+    }
+
+    bool testFailures() {
+        LOGD("=== Testing lock, geometry and size failures ===");
+
+        std::vector<uint8_t> src = makeRGBA(64, 36, 64 * 4, 5);
+        WindowPresenter presenter;
+        if (presenter.presentRGBA(src.data(), 64, 36, 64 * 4)) {
+            LOGE("Present without a window succeeded");
+            return false;
+        }
+
+        FakeWindow* fake = attachFake(presenter);
+        fake->failGeometry = -22;
+        if (presenter.presentRGBA(src.data(), 64, 36, 64 * 4) || fake->locks != 0) {
+            LOGE("Present after a geometry failure locked the window");
+            return false;
+        }
+        // A failed lock forgets the geometry, so the next frame sets it again
+        presenter.presentRGBA(src.data(), 64, 36, 64 * 4);
+        fake->failLock = -19;
+        presenter.presentRGBA(src.data(), 64, 36, 64 * 4);
+        presenter.presentRGBA(src.data(), 64, 36, 64 * 4);
+        if (fake->geometryCalls != 3 || fake->posts != 2) {
+            LOGE("After lock failure: %d geometry calls, %d posts (expected 3, 2)", fake->geometryCalls, fake->posts);
+            return false;
+        }
+
+        // A buffer smaller than the frame is posted untouched so the lock is released
+        ANativeWindow_Buffer buffer;
+        presenter.lock(64, 36, buffer);
+        buffer.height = 20;
+        std::fill(fake->pixels.begin(), fake->pixels.end(), kWindowPadding);
+        bool written = WindowPresenter::writeRGBA(src.data(), 64, 36, 64 * 4, buffer);
+        presenter.post();
+        if (written || fake->locked || !fake->paddingIntact(0, 0)) {
+            LOGE("Oversized frame: written %d, still locked %d", written, fake->locked);
+            return false;
+        }
+
+        WindowPresenter::Stats stats = presenter.getStats();
+        if (stats.lockFailures != 3 || stats.presented != 3) {
+            LOGE("Stats: %llu lock failures, %llu presented (expected 3, 3)",
+                 (unsigned long long) stats.lockFailures, (unsigned long long) stats.presented);
+            return false;
+        }
+
+        LOGD("Failure test passed");
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting Window Presenter Tests");
+
+        int passedTests = 0;
+        int totalTests = 0;
+
+        totalTests++; if (testGeometryOnSizeChange()) passedTests++;
+        totalTests++; if (testRGBAStrides()) passedTests++;
+        totalTests++; if (testNV12IntoWindow()) passedTests++;
+        totalTests++; if (testFailures()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+extern "C" void runWindowPresenterTests() {
+    WindowPresenterTest test;
+    test.runAllTests();
+}
+
+// Previous display path: convert into a staging RGBA frame, set the geometry, then copy it into the window
+extern "C" void runWindowPresenterBenchmark(int numFrames) {
+    LOGD("=== Window Presenter Benchmark (%d frames, 1920x1080 NV12, CPU conversion) ===", numFrames);
+
+    auto frame = makeNV12Frame(1920, 1080, 1984, 1088, 6);
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(frame->data.get());
+
+    FakeWindow staged;
+    std::vector<uint8_t> staging(1920 * 1080 * 4);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < numFrames; i++) {
+        FrameConverter::nv12ToRGBA(data, data + 1984 * 1088, 1984, 1920, 1080, staging.data(), 1920 * 4);
+        staged.setBuffersGeometry(1920, 1080);
+        ANativeWindow_Buffer buffer;
+        staged.lock(buffer);
+        for (int y = 0; y < 1080; y++) {
+            memcpy(static_cast<uint8_t*>(buffer.bits) + y * buffer.stride * 4, &staging[y * 1920 * 4], 1920 * 4);
+        }
+        staged.unlockAndPost();
+    }
+    double stagedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    WindowPresenter presenter;
+    FakeWindow* direct = attachFake(presenter);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < numFrames; i++) {
+        presenter.present(*frame, false);
+    }
+    double directMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    LOGD("Staged: %.2f ms/frame, %d geometry calls", stagedMs / numFrames, staged.geometryCalls);
+    LOGD("Direct: %.2f ms/frame, %d geometry calls", directMs / numFrames, direct->geometryCalls);
+}
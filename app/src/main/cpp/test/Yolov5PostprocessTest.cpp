@@ -0,0 +1,421 @@
+#include "yolov5_postprocess.h"
+#include "log4c.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+const int kModelSize = 640;
+const int kBranchChannels = 3 * PROP_BOX_SIZE;
+
+// 一帧模型输出：三个分支的int8张量及其量化参数
+struct OutputSet {
+    int model_h;
+    int model_w;
+    std::vector<int8_t> data[3];
+    std::vector<int32_t> zps;
+    std::vector<float> scales;
+
+    OutputSet(int h, int w) : model_h(h), model_w(w), zps(3), scales(3) {
+        for (int b = 0; b < 3; b++) {
+            int stride = 8 << b;
+            data[b].assign(kBranchChannels * (h / stride) * (w / stride), 0);
+        }
+    }
+
+    int gridLen(int b) const { return (model_h / (8 << b)) * (model_w / (8 << b)); }
+};
+
+int8_t randomIn(int lo, int hi) {
+    return (int8_t) (lo + rand() % (hi - lo + 1));
+}
+
+// 模拟真实输出分布：objectness绝大多数很低，hitPercent%的网格为目标，类别分数有少量峰值
+OutputSet makeOutputs(int h, int w, int hitPercent, unsigned seed) {
+    OutputSet out(h, w);
+    srand(seed);
+    const int32_t zps[3] = {-17, -12, -9};
+    const float scales[3] = {0.092f, 0.085f, 0.079f};
+    for (int b = 0; b < 3; b++) {
+        out.zps[b] = zps[b];
+        out.scales[b] = scales[b];
+        int gridLen = out.gridLen(b);
+        for (int a = 0; a < 3; a++) {
+            int8_t *p = &out.data[b][PROP_BOX_SIZE * a * gridLen];
+            for (int c = 0; c < gridLen; c++) {
+                bool hit = rand() % 100 < hitPercent;
+                for (int k = 0; k < 4; k++) {
+                    p[k * gridLen + c] = randomIn(-60, 40);
+                }
+                p[4 * gridLen + c] = hit ? randomIn(0, 127) : randomIn(-128, -40);
+                for (int k = 0; k < OBJ_CLASS_NUM; k++) {
+                    p[(5 + k) * gridLen + c] = randomIn(-128, -50);
+                }
+                if (hit) {
+                    p[(5 + rand() % OBJ_CLASS_NUM) * gridLen + c] = randomIn(-20, 127);
+                    // 偶尔出现并列最大值，检查取较小类别号
+                    if (rand() % 4 == 0) {
+                        p[(5 + rand() % OBJ_CLASS_NUM) * gridLen + c] = 127;
+                        p[(5 + rand() % OBJ_CLASS_NUM) * gridLen + c] = 127;
+                    }
+                }
+            }
+        }
+    }
+    return out;
+}
+
+// 录制文件格式："Y5OT", model_h, model_w, 然后每个分支 zp, scale, 字节数, int8数据
+bool saveRecording(const char *path, const OutputSet &out) {
+    FILE *fp = fopen(path, "wb");
+    if (fp == nullptr) {
+        return false;
+    }
+    fwrite("Y5OT", 1, 4, fp);
+    fwrite(&out.model_h, sizeof(int), 1, fp);
+    fwrite(&out.model_w, sizeof(int), 1, fp);
+    for (int b = 0; b < 3; b++) {
+        int size = (int) out.data[b].size();
+        fwrite(&out.zps[b], sizeof(int32_t), 1, fp);
+        fwrite(&out.scales[b], sizeof(float), 1, fp);
+        fwrite(&size, sizeof(int), 1, fp);
+        fwrite(out.data[b].data(), 1, size, fp);
+    }
+    fclose(fp);
+    return true;
+}
+
+bool loadRecording(const char *path, OutputSet &out) {
+    FILE *fp = fopen(path, "rb");
+    if (fp == nullptr) {
+        return false;
+    }
+    char magic[4];
+    int h = 0, w = 0;
+    bool ok = fread(magic, 1, 4, fp) == 4 && memcmp(magic, "Y5OT", 4) == 0 &&
+              fread(&h, sizeof(int), 1, fp) == 1 && fread(&w, sizeof(int), 1, fp) == 1 && h > 0 && w > 0;
+    if (ok) {
+        out = OutputSet(h, w);
+        for (int b = 0; b < 3 && ok; b++) {
+            int size = 0;
+            ok = fread(&out.zps[b], sizeof(int32_t), 1, fp) == 1 && fread(&out.scales[b], sizeof(float), 1, fp) == 1 &&
+                 fread(&size, sizeof(int), 1, fp) == 1 && size == (int) out.data[b].size() &&
+                 fread(out.data[b].data(), 1, size, fp) == (size_t) size;
+        }
+    }
+    fclose(fp);
+    return ok;
+}
+
+// 改写前的逐网格解码（每个数调用expf、push_back到vector），作为逐位比较的参考
+float legacySigmoid(float x) { return 1.0 / (1.0 + expf(-x)); }
+
+float legacyDeqnt(int8_t qnt, int32_t zp, float scale) { return ((float) qnt - (float) zp) * scale; }
+
+int8_t legacyThreshold(float threshold, int32_t zp, float scale) {
+    float thres = -1.0 * logf((1.0 / threshold) - 1.0);
+    float f = (thres / scale) + zp;
+    f = f <= -128 ? -128 : (f >= 127 ? 127 : f);
+    return (int8_t) (int32_t) f;
+}
+
+void legacyDecode(const OutputSet &out, float threshold, std::vector<float> &boxes, std::vector<float> &objProbs,
+                  std::vector<int> &classId) {
+    static const int anchors[3][6] = {{10, 13, 16, 30, 33, 23}, {30, 61, 62, 45, 59, 119},
+                                      {116, 90, 156, 198, 373, 326}};
+    for (int b = 0; b < 3; b++) {
+        int stride = 8 << b;
+        int grid_h = out.model_h / stride, grid_w = out.model_w / stride, grid_len = grid_h * grid_w;
+        int32_t zp = out.zps[b];
+        float scale = out.scales[b];
+        const int *anchor = anchors[b];
+        const int8_t *input = out.data[b].data();
+        int8_t thres_i8 = legacyThreshold(threshold, zp, scale);
+        for (int a = 0; a < 3; a++) {
+            for (int i = 0; i < grid_h; i++) {
+                for (int j = 0; j < grid_w; j++) {
+                    int8_t box_confidence = input[(PROP_BOX_SIZE * a + 4) * grid_len + i * grid_w + j];
+                    if (box_confidence < thres_i8) {
+                        continue;
+                    }
+                    const int8_t *in_ptr = input + (PROP_BOX_SIZE * a) * grid_len + i * grid_w + j;
+                    float box_x = legacySigmoid(legacyDeqnt(*in_ptr, zp, scale)) * 2.0 - 0.5;
+                    float box_y = legacySigmoid(legacyDeqnt(in_ptr[grid_len], zp, scale)) * 2.0 - 0.5;
+                    float box_w = legacySigmoid(legacyDeqnt(in_ptr[2 * grid_len], zp, scale)) * 2.0;
+                    float box_h = legacySigmoid(legacyDeqnt(in_ptr[3 * grid_len], zp, scale)) * 2.0;
+                    box_x = (box_x + j) * (float) stride;
+                    box_y = (box_y + i) * (float) stride;
+                    box_w = box_w * box_w * (float) anchor[a * 2];
+                    box_h = box_h * box_h * (float) anchor[a * 2 + 1];
+                    box_x -= (box_w / 2.0);
+                    box_y -= (box_h / 2.0);
+
+                    int8_t maxClassProbs = in_ptr[5 * grid_len];
+                    int maxClassId = 0;
+                    for (int k = 1; k < OBJ_CLASS_NUM; ++k) {
+                        int8_t prob = in_ptr[(5 + k) * grid_len];
+                        if (prob > maxClassProbs) {
+                            maxClassId = k;
+                            maxClassProbs = prob;
+                        }
+                    }
+                    if (maxClassProbs > thres_i8) {
+                        objProbs.push_back(legacySigmoid(legacyDeqnt(maxClassProbs, zp, scale)) *
+                                           legacySigmoid(legacyDeqnt(box_confidence, zp, scale)));
+                        classId.push_back(maxClassId);
+                        boxes.push_back(box_x);
+                        boxes.push_back(box_y);
+                        boxes.push_back(box_w);
+                        boxes.push_back(box_h);
+                    }
+                }
+            }
+        }
+    }
+}
+
+int decode(OutputSet &out, float threshold, yolov5::decode_workspace_t &ws, yolov5::decode_impl_e impl) {
+    return yolov5::decode_outputs(out.data[0].data(), out.data[1].data(), out.data[2].data(), out.model_h,
+                                  out.model_w, threshold, out.zps, out.scales, &ws, impl);
+}
+
+// 解码结果与参考实现逐位比较
+bool sameAsLegacy(OutputSet &out, float threshold, yolov5::decode_impl_e impl, const char *what) {
+    std::vector<float> boxes, probs;
+    std::vector<int> classes;
+    legacyDecode(out, threshold, boxes, probs, classes);
+
+    yolov5::decode_workspace_t ws;
+    int count = decode(out, threshold, ws, impl);
+    if (count != (int) probs.size()) {
+        LOGE("%s: decoded %d boxes, legacy %zu", what, count, probs.size());
+        return false;
+    }
+    if (count == 0) {
+        return true;
+    }
+    if (memcmp(ws.boxes.data(), boxes.data(), count * 4 * sizeof(float)) != 0 ||
+        memcmp(ws.obj_probs.data(), probs.data(), count * sizeof(float)) != 0 ||
+        memcmp(ws.class_ids.data(), classes.data(), count * sizeof(int)) != 0) {
+        for (int i = 0; i < count; i++) {
+            if (ws.class_ids[i] != classes[i] || ws.obj_probs[i] != probs[i] || ws.boxes[i * 4] != boxes[i * 4]) {
+                LOGE("%s: box %d differs: class %d/%d prob %f/%f x %f/%f", what, i, ws.class_ids[i], classes[i],
+                     ws.obj_probs[i], probs[i], ws.boxes[i * 4], boxes[i * 4]);
+                break;
+            }
+        }
+        return false;
+    }
+    return true;
+}
+
+int64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+/**
+ * Test class for the int8 YOLOv5 decode stage (threshold scan, class argmax, LUT sigmoid)
+ */
+class Yolov5PostprocessTest {
+public:
+    bool testDecodeMatchesLegacy() {
+        LOGD("=== Testing decode against per-cell expf reference ===");
+
+        const int hitPercents[] = {0, 1, 5, 30, 100};
+        for (int hit : hitPercents) {
+            OutputSet out = makeOutputs(kModelSize, kModelSize, hit, 100 + hit);
+            if (!sameAsLegacy(out, BOX_THRESH, yolov5::DECODE_IMPL_AUTO, "SIMD") ||
+                !sameAsLegacy(out, BOX_THRESH, yolov5::DECODE_IMPL_SCALAR, "scalar")) {
+                LOGE("Mismatch at %d%% hit density", hit);
+                return false;
+            }
+        }
+
+        LOGD("Decode reference test passed");
+        return true;
+    }
+
+    bool testOddGridsAndThresholds() {
+        LOGD("=== Testing grids not multiple of 16 and threshold extremes ===");
+
+        // 200x328: 网格长度625/246/66，最后不足16个网格走标量尾部
+        OutputSet odd = makeOutputs(200, 328, 10, 7);
+        const float thresholds[] = {0.0001f, 0.25f, BOX_THRESH, 0.9f, 0.9999f};
+        for (float threshold : thresholds) {
+            if (!sameAsLegacy(odd, threshold, yolov5::DECODE_IMPL_AUTO, "odd grid")) {
+                LOGE("Mismatch at threshold %f", threshold);
+                return false;
+            }
+        }
+
+        // 阈值量化到-128时所有网格都通过objectness比较
+        OutputSet all = makeOutputs(kModelSize, kModelSize, 100, 8);
+        if (!sameAsLegacy(all, 0.0001f, yolov5::DECODE_IMPL_AUTO, "all pass")) {
+            return false;
+        }
+
+        LOGD("Odd grid / threshold test passed");
+        return true;
+    }
+
+    bool testWorkspaceReuse() {
+        LOGD("=== Testing workspace reuse ===");
+
+        yolov5::decode_workspace_t ws;
+        yolov5::prepare_decode_workspace(&ws, kModelSize, kModelSize);
+        const float *boxes = ws.boxes.data();
+        const float *probs = ws.obj_probs.data();
+
+        OutputSet out = makeOutputs(kModelSize, kModelSize, 100, 9);
+        for (int frame = 0; frame < 4; frame++) {
+            // 第3帧更换量化参数，查找表需要重建
+            if (frame == 2) {
+                out.zps[1] = 3;
+                out.scales[1] = 0.11f;
+            }
+            std::vector<float> refBoxes, refProbs;
+            std::vector<int> refClasses;
+            legacyDecode(out, 0.0001f, refBoxes, refProbs, refClasses);
+            int count = decode(out, 0.0001f, ws, yolov5::DECODE_IMPL_AUTO);
+            if (count != (int) refProbs.size() ||
+                memcmp(ws.obj_probs.data(), refProbs.data(), count * sizeof(float)) != 0) {
+                LOGE("Frame %d: decode differs from reference (%d vs %zu)", frame, count, refProbs.size());
+                return false;
+            }
+        }
+        if (ws.boxes.data() != boxes || ws.obj_probs.data() != probs) {
+            LOGE("Workspace buffers were reallocated while decoding");
+            return false;
+        }
+
+        LOGD("Workspace reuse test passed");
+        return true;
+    }
+
+    bool testPostProcessSingleObject() {
+        LOGD("=== Testing post_process with a single object ===");
+
+        OutputSet out = makeOutputs(kModelSize, kModelSize, 0, 10);
+        // stride 16分支、anchor 1、网格(12, 20)放一个类别为2（car）的目标
+        const int b = 1, a = 1, row = 12, col = 20;
+        int gridLen = out.gridLen(b), gridW = kModelSize / 16, cell = row * gridW + col;
+        int8_t *p = &out.data[b][PROP_BOX_SIZE * a * gridLen];
+        for (int k = 0; k < 4; k++) {
+            p[k * gridLen + cell] = (int8_t) out.zps[b]; // sigmoid(0) = 0.5
+        }
+        p[4 * gridLen + cell] = 127;
+        p[(5 + 2) * gridLen + cell] = 127;
+
+        yolov5::decode_workspace_t ws;
+        yolov5::detect_result_group_t group;
+        yolov5::post_process(out.data[0].data(), out.data[1].data(), out.data[2].data(), kModelSize, kModelSize,
+                             BOX_THRESH, nms_default_config(), 1.f, 1.f, out.zps, out.scales, &ws, &group);
+        if (group.count != 1 || strncmp(group.results[0].name, "car", 3) != 0) {
+            LOGE("Expected one car, got %d (%s)", group.count, group.count > 0 ? group.results[0].name : "-");
+            return false;
+        }
+        // 中心 (col + 0.5) * 16，宽高为anchor (62, 45)
+        const yolov5::BOX_RECT &box = group.results[0].box;
+        int cx = (int) ((col + 0.5f) * 16), cy = (int) ((row + 0.5f) * 16);
+        if (std::abs(box.left - (cx - 31)) > 1 || std::abs(box.right - (cx + 31)) > 1 ||
+            std::abs(box.top - (cy - 22)) > 1 || std::abs(box.bottom - (cy + 23)) > 1) {
+            LOGE("Unexpected box %d,%d,%d,%d", box.left, box.top, box.right, box.bottom);
+            return false;
+        }
+
+        LOGD("Single object post_process test passed");
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting Yolov5 Postprocess Tests");
+
+        int passedTests = 0;
+        int totalTests = 4;
+
+        if (testDecodeMatchesLegacy()) passedTests++;
+        if (testOddGridsAndThresholds()) passedTests++;
+        if (testWorkspaceReuse()) passedTests++;
+        if (testPostProcessSingleObject()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+extern "C" void runYolov5PostprocessTests() {
+    Yolov5PostprocessTest test;
+    test.runAllTests();
+}
+
+/**
+ * Benchmark: decode stage alone on recorded int8 output tensors.
+ * recordingPath points at a file written by a previous run (or dumped from a
+ * device in the same format); when it does not exist a synthetic recording
+ * with ~1% objectness hits is generated and saved there, so later runs decode
+ * identical data. Pass nullptr to use the synthetic tensors without saving.
+ */
+extern "C" void runYolov5PostprocessBenchmark(const char *recordingPath) {
+    OutputSet out(kModelSize, kModelSize);
+    if (recordingPath == nullptr || !loadRecording(recordingPath, out)) {
+        out = makeOutputs(kModelSize, kModelSize, 1, 42);
+        if (recordingPath != nullptr && saveRecording(recordingPath, out)) {
+            LOGD("Saved synthetic recording to %s", recordingPath);
+        }
+    } else {
+        LOGD("Loaded recording %s", recordingPath);
+    }
+
+    const int iterations = 200;
+    yolov5::decode_workspace_t ws;
+    yolov5::detect_result_group_t group;
+
+    int64_t start = nowUs();
+    size_t legacyCount = 0;
+    for (int i = 0; i < iterations; i++) {
+        std::vector<float> boxes, probs;
+        std::vector<int> classes;
+        legacyDecode(out, BOX_THRESH, boxes, probs, classes);
+        legacyCount = probs.size();
+    }
+    double legacyUs = (double) (nowUs() - start) / iterations;
+
+    int count = 0;
+    start = nowUs();
+    for (int i = 0; i < iterations; i++) {
+        count = decode(out, BOX_THRESH, ws, yolov5::DECODE_IMPL_SCALAR);
+    }
+    double scalarUs = (double) (nowUs() - start) / iterations;
+
+    start = nowUs();
+    for (int i = 0; i < iterations; i++) {
+        count = decode(out, BOX_THRESH, ws, yolov5::DECODE_IMPL_AUTO);
+    }
+    double simdUs = (double) (nowUs() - start) / iterations;
+
+    start = nowUs();
+    for (int i = 0; i < iterations; i++) {
+        yolov5::post_process(out.data[0].data(), out.data[1].data(), out.data[2].data(), out.model_h, out.model_w,
+                             BOX_THRESH, nms_default_config(), 1.f, 1.f, out.zps, out.scales, &ws, &group);
+    }
+    double fullUs = (double) (nowUs() - start) / iterations;
+
+    LOGD("=== Yolov5 int8 decode Benchmark (%dx%d, %d candidates) ===", out.model_w, out.model_h, count);
+    LOGD("  legacy expf decode : %8.1f us/frame (%zu candidates)", legacyUs, legacyCount);
+    LOGD("  LUT scalar decode  : %8.1f us/frame", scalarUs);
+    LOGD("  LUT SIMD decode    : %8.1f us/frame", simdUs);
+    LOGD("  full post_process  : %8.1f us/frame (%d detections)", fullUs, group.count);
+}
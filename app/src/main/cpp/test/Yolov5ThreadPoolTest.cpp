@@ -0,0 +1,598 @@
+#include "yolov5_thread_pool.h"
+#include "StubNNEngine.h"
+#include "rga.h"
+#include "log4c.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <queue>
+#include <thread>
+#include <cassert>
+#include <ctime>
+
+namespace {
+
+std::shared_ptr<frame_data_t> makeTestFrame(int frameId, int width = 320, int height = 240) {
+    auto frameData = std::make_shared<frame_data_t>();
+    frameData->frameId = frameId;
+    frameData->screenW = width;
+    frameData->screenH = height;
+    frameData->widthStride = width;
+    frameData->heightStride = height;
+    frameData->screenStride = width * 4;
+    frameData->frameFormat = RK_FORMAT_RGBA_8888;
+    frameData->dataSize = width * height * 4;
+    frameData->data.reset(new char[frameData->dataSize]());
+    return frameData;
+}
+
+int64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * The previous Yolov5ThreadPool hand-off, kept here only as the benchmark
+ * baseline: unbounded std::queue + sleep(1ms) back-pressure on submit, and
+ * std::map results polled every 1ms under a single mutex.
+ */
+class LegacyYolov5ThreadPool {
+public:
+    explicit LegacyYolov5ThreadPool(int numThreads, int inferenceUs) : stop(false) {
+        for (int i = 0; i < numThreads; ++i) {
+            auto yolov5 = std::make_shared<Yolov5>(std::make_shared<StubNNEngine>(inferenceUs));
+            yolov5->LoadModelWithData(nullptr, 0);
+            instances.push_back(yolov5);
+        }
+        for (int i = 0; i < numThreads; ++i) {
+            threads.emplace_back(&LegacyYolov5ThreadPool::worker, this, i);
+        }
+    }
+
+    ~LegacyYolov5ThreadPool() {
+        stop = true;
+        cv_task.notify_all();
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+
+    void submitTask(const std::shared_ptr<frame_data_t> &frameData) {
+        while (tasks.size() > 22) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        {
+            std::lock_guard<std::mutex> lock(mtx1);
+            tasks.push(frameData);
+        }
+        cv_task.notify_one();
+    }
+
+    void getTargetResult(std::vector<Detection> &objects, int id) {
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(mtx2);
+                auto it = results.find(id);
+                if (it != results.end()) {
+                    objects = it->second;
+                    results.erase(it);
+                    img_results.erase(id);
+                    return;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+private:
+    void worker(int id) {
+        while (!stop) {
+            std::shared_ptr<frame_data_t> task;
+            {
+                std::unique_lock<std::mutex> lock(mtx1);
+                cv_task.wait(lock, [&] { return !tasks.empty() || stop; });
+                if (stop) {
+                    return;
+                }
+                task = tasks.front();
+                tasks.pop();
+            }
+            std::vector<Detection> detections;
+            instances[id]->RunWithFrameData(task, detections);
+            std::lock_guard<std::mutex> lock(mtx2);
+            results.insert({task->frameId, detections});
+            img_results.insert({task->frameId, task});
+        }
+    }
+
+    std::vector<std::shared_ptr<Yolov5>> instances;
+    std::queue<std::shared_ptr<frame_data_t>> tasks;
+    std::map<int, std::vector<Detection>> results;
+    std::map<int, std::shared_ptr<frame_data_t>> img_results;
+    std::vector<std::thread> threads;
+    std::mutex mtx1;
+    std::mutex mtx2;
+    std::condition_variable cv_task;
+    std::atomic<bool> stop;
+};
+
+struct LatencyStats {
+    double p50Us = 0;
+    double p90Us = 0;
+    double p99Us = 0;
+    double maxUs = 0;
+    double framesPerSecond = 0;
+};
+
+LatencyStats summarize(std::vector<int64_t> &latencies, int64_t wallUs) {
+    LatencyStats stats;
+    if (latencies.empty()) {
+        return stats;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto pick = [&](double q) { return (double) latencies[std::min(latencies.size() - 1, (size_t) (q * latencies.size()))]; };
+    stats.p50Us = pick(0.50);
+    stats.p90Us = pick(0.90);
+    stats.p99Us = pick(0.99);
+    stats.maxUs = (double) latencies.back();
+    stats.framesPerSecond = wallUs > 0 ? latencies.size() * 1e6 / wallUs : 0;
+    return stats;
+}
+
+/**
+ * Drives a pool with one paced producer (numChannels x fps) and one in-order
+ * consumer, recording submit -> result-available latency per frame.
+ */
+template<typename SubmitFn, typename WaitFn>
+LatencyStats measureSubmitToComplete(int totalFrames, int intervalUs, SubmitFn submit, WaitFn wait) {
+    std::vector<int64_t> submitTime(totalFrames, 0);
+    std::vector<int64_t> latencies;
+    latencies.reserve(totalFrames);
+
+    int64_t startUs = nowUs();
+    std::thread consumer([&] {
+        for (int id = 0; id < totalFrames; ++id) {
+            std::vector<Detection> objects;
+            wait(objects, id);
+            latencies.push_back(nowUs() - submitTime[id]);
+        }
+    });
+
+    int64_t next = nowUs();
+    for (int id = 0; id < totalFrames; ++id) {
+        submitTime[id] = nowUs();
+        submit(makeTestFrame(id));
+        next += intervalUs;
+        int64_t sleepUs = next - nowUs();
+        if (sleepUs > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(sleepUs));
+        }
+    }
+    consumer.join();
+    return summarize(latencies, nowUs() - startUs);
+}
+
+} // namespace
+
+/**
+ * Test class for the Yolov5ThreadPool submission ring and result slots
+ */
+class Yolov5ThreadPoolTest {
+public:
+    bool testRingBasic() {
+        LOGD("=== Testing BoundedTaskRing Basic Operations ===");
+
+        BoundedTaskRing<int> ring(5);
+        if (ring.capacity() != 8) {
+            LOGE("Capacity should round up to 8, got %zu", ring.capacity());
+            return false;
+        }
+
+        for (int i = 0; i < 8; i++) {
+            int v = i;
+            if (!ring.tryPush(v)) {
+                LOGE("tryPush failed at %d before ring was full", i);
+                return false;
+            }
+        }
+        int extra = 100;
+        if (ring.tryPush(extra)) {
+            LOGE("tryPush should reject when ring is full");
+            return false;
+        }
+
+        for (int i = 0; i < 8; i++) {
+            int v = -1;
+            if (!ring.tryPop(v) || v != i) {
+                LOGE("FIFO order broken: expected %d, got %d", i, v);
+                return false;
+            }
+        }
+        int v = -1;
+        if (ring.tryPop(v)) {
+            LOGE("tryPop should fail on empty ring");
+            return false;
+        }
+
+        ring.close();
+        int afterClose = 1;
+        if (ring.push(afterClose) || ring.pop(v)) {
+            LOGE("push/pop should fail after close");
+            return false;
+        }
+
+        LOGD("BoundedTaskRing basic test passed");
+        return true;
+    }
+
+    bool testRingBlockingTimeout() {
+        LOGD("=== Testing BoundedTaskRing Blocking and Timeout ===");
+
+        BoundedTaskRing<int> ring(2);
+        int a = 1, b = 2, c = 3;
+        ring.push(a);
+        ring.push(b);
+
+        auto start = std::chrono::steady_clock::now();
+        bool pushed = ring.push(c, 20);
+        auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        if (pushed || waited.count() < 15) {
+            LOGE("push on full ring should time out after ~20ms (pushed=%d, waited=%lldms)",
+                 pushed, (long long) waited.count());
+            return false;
+        }
+
+        // A blocked producer must be released by a consumer without polling
+        std::thread producer([&] {
+            int d = 4;
+            ring.push(d);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        int out = 0;
+        ring.pop(out);
+        producer.join();
+        if (ring.size() != 2) {
+            LOGE("Blocked producer was not released, size=%zu", ring.size());
+            return false;
+        }
+
+        // A blocked consumer must be released by close()
+        BoundedTaskRing<int> empty(4);
+        std::thread consumer([&] {
+            int x;
+            empty.pop(x);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        empty.close();
+        consumer.join();
+
+        LOGD("BoundedTaskRing blocking test passed");
+        return true;
+    }
+
+    bool testRingConcurrent() {
+        LOGD("=== Testing BoundedTaskRing MPMC ===");
+
+        const int numProducers = 4;
+        const int numConsumers = 4;
+        const int itemsPerProducer = 50000;
+
+        BoundedTaskRing<int> ring(64);
+        std::atomic<long long> consumedSum(0);
+        std::atomic<int> consumedCount(0);
+
+        std::vector<std::thread> consumers;
+        for (int i = 0; i < numConsumers; i++) {
+            consumers.emplace_back([&] {
+                int v;
+                while (ring.pop(v)) {
+                    consumedSum += v;
+                    consumedCount++;
+                }
+            });
+        }
+
+        std::vector<std::thread> producers;
+        for (int p = 0; p < numProducers; p++) {
+            producers.emplace_back([&, p] {
+                for (int i = 1; i <= itemsPerProducer; i++) {
+                    int v = i;
+                    ring.push(v);
+                }
+            });
+        }
+        for (auto &t : producers) {
+            t.join();
+        }
+        while (ring.size() > 0) {
+            std::this_thread::yield();
+        }
+        ring.close();
+        for (auto &t : consumers) {
+            t.join();
+        }
+
+        long long expectedSum = (long long) numProducers * itemsPerProducer * (itemsPerProducer + 1) / 2;
+        if (consumedCount != numProducers * itemsPerProducer || consumedSum != expectedSum) {
+            LOGE("MPMC mismatch: count %d (expected %d), sum %lld (expected %lld)",
+                 consumedCount.load(), numProducers * itemsPerProducer, consumedSum.load(), expectedSum);
+            return false;
+        }
+
+        LOGD("BoundedTaskRing MPMC test passed");
+        return true;
+    }
+
+    bool testResultSlots() {
+        LOGD("=== Testing FrameResultSlots ===");
+
+        FrameResultSlots slots(8);
+        std::vector<Detection> objects;
+
+        if (slots.takeResult(0, objects, 0) != NN_RESULT_NOT_READY) {
+            LOGE("Empty slot should report NN_RESULT_NOT_READY");
+            return false;
+        }
+
+        // Out-of-order completion
+        std::vector<Detection> two(2), one(1);
+        slots.complete(1, std::move(two), makeTestFrame(1));
+        slots.complete(0, std::move(one), makeTestFrame(0));
+        if (slots.takeResult(0, objects, 0) != NN_SUCCESS || objects.size() != 1) {
+            LOGE("Frame 0 result missing");
+            return false;
+        }
+        if (!slots.takeImage(0) || slots.takeImage(0)) {
+            LOGE("Frame 0 image should be taken exactly once");
+            return false;
+        }
+        if (slots.takeResult(1, objects, 0) != NN_SUCCESS || objects.size() != 2) {
+            LOGE("Frame 1 result missing");
+            return false;
+        }
+
+        // Blocking wait is released by the completion, not by polling
+        std::thread worker([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            slots.complete(2, std::vector<Detection>(3), nullptr);
+        });
+        if (slots.takeResultAndImage(2, objects, 1000) != NN_SUCCESS || objects.size() != 3) {
+            LOGE("Blocking wait for frame 2 failed");
+            worker.join();
+            return false;
+        }
+        worker.join();
+
+        // Wait with timeout
+        if (slots.takeResult(3, objects, 5) != NN_TIMEOUT) {
+            LOGE("Wait on missing frame should time out");
+            return false;
+        }
+
+        // Wrap-around: frame 4 + capacity overwrites an unconsumed frame 4
+        slots.complete(4, std::vector<Detection>(), nullptr);
+        slots.complete(4 + (int) slots.capacity(), std::vector<Detection>(), nullptr);
+        if (slots.overwrittenCount() != 1 || slots.takeResult(4, objects, 0) != NN_RESULT_NOT_READY) {
+            LOGE("Overwritten frame not detected");
+            return false;
+        }
+
+        // stop() releases blocked consumers
+        std::thread stopper([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            slots.stop();
+        });
+        nn_error_e ret = slots.takeResult(5, objects, -1);
+        stopper.join();
+        if (ret != NN_STOPED) {
+            LOGE("stop() should release waiters with NN_STOPED, got %d", ret);
+            return false;
+        }
+
+        LOGD("FrameResultSlots test passed");
+        return true;
+    }
+
+    bool testThreadPoolWithStubEngine() {
+        LOGD("=== Testing Yolov5ThreadPool with stub engine ===");
+
+        Yolov5ThreadPool pool;
+        pool.setUpWithEngineFactory(4, [] { return std::make_shared<StubNNEngine>(2000); }, nullptr, 0);
+
+        const int numFrames = 200;
+        std::thread producer([&] {
+            for (int i = 0; i < numFrames; i++) {
+                pool.submitTask(makeTestFrame(i));
+            }
+        });
+
+        for (int i = 0; i < numFrames; i++) {
+            std::vector<Detection> objects;
+            if (pool.getTargetResultNonBlock(objects, i) != NN_SUCCESS &&
+                pool.getTargetResult(objects, i) != NN_SUCCESS) {
+                LOGE("Missing result for frame %d", i);
+                producer.join();
+                return false;
+            }
+        }
+        producer.join();
+
+        // With slow workers the non-blocking submit must reject instead of waiting
+        Yolov5ThreadPool slowPool;
+        slowPool.setUpWithEngineFactory(1, [] { return std::make_shared<StubNNEngine>(50000); }, nullptr, 0);
+        int rejected = 0;
+        for (int i = 0; i < MAX_TASK * 2; i++) {
+            if (slowPool.trySubmitTask(makeTestFrame(i)) == NN_QUEUE_FULL) {
+                rejected++;
+            }
+        }
+        if (rejected == 0) {
+            LOGE("trySubmitTask never reported NN_QUEUE_FULL");
+            return false;
+        }
+        slowPool.stopAll();
+        if (slowPool.submitTask(makeTestFrame(0)) != NN_STOPED) {
+            LOGE("submitTask after stopAll should return NN_STOPED");
+            return false;
+        }
+
+        LOGD("Yolov5ThreadPool stub engine test passed (%d rejected)", rejected);
+        return true;
+    }
+
+    bool testCompletionWait() {
+        LOGD("=== Testing completion wait ===");
+
+        Yolov5ThreadPool pool;
+        pool.setUpWithEngineFactory(2, [] { return std::make_shared<StubNNEngine>(5000); }, nullptr, 0);
+
+        uint64_t seen = 0;
+        if (pool.waitForResult(seen, 20) != NN_TIMEOUT || seen != 0) {
+            LOGE("Idle pool should time out without completions");
+            return false;
+        }
+
+        // The waiter is woken by the completion and can then take the result without polling
+        int64_t startUs = nowUs();
+        pool.submitTask(makeTestFrame(0));
+        if (pool.waitForResult(seen, 1000) != NN_SUCCESS || seen != 1) {
+            LOGE("Completion of frame 0 did not wake the waiter (seen %llu)", (unsigned long long) seen);
+            return false;
+        }
+        int64_t wokeUs = nowUs() - startUs;
+        std::vector<Detection> objects;
+        if (pool.getTargetResultNonBlock(objects, 0) != NN_SUCCESS) {
+            LOGE("Result not available after the completion wake-up");
+            return false;
+        }
+
+        // Completions that happen before the wait are not lost
+        pool.submitTask(makeTestFrame(1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        if (pool.waitForResult(seen, 0) != NN_SUCCESS || seen != 2) {
+            LOGE("Completion before the wait was missed");
+            return false;
+        }
+
+        // stopAll() releases a blocked waiter
+        std::thread stopper([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            pool.stopAll();
+        });
+        nn_error_e ret = pool.waitForResult(seen, -1);
+        stopper.join();
+        if (ret != NN_STOPED) {
+            LOGE("stopAll() should release the waiter with NN_STOPED, got %d", ret);
+            return false;
+        }
+
+        LOGD("Completion wait test passed (woken %lld us after submit)", (long long) wokeUs);
+        return true;
+    }
+
+    void runAllTests() {
+        LOGD("Starting Yolov5ThreadPool Tests");
+
+        int passedTests = 0;
+        int totalTests = 6;
+
+        if (testRingBasic()) passedTests++;
+        if (testRingBlockingTimeout()) passedTests++;
+        if (testRingConcurrent()) passedTests++;
+        if (testResultSlots()) passedTests++;
+        if (testThreadPoolWithStubEngine()) passedTests++;
+        if (testCompletionWait()) passedTests++;
+
+        LOGD("=== Test Results ===");
+        LOGD("Passed: %d/%d tests", passedTests, totalTests);
+
+        if (passedTests == totalTests) {
+            LOGD("All tests PASSED!");
+        } else {
+            LOGE("Some tests FAILED!");
+        }
+    }
+};
+
+// Test runner function
+extern "C" void runYolov5ThreadPoolTests() {
+    Yolov5ThreadPoolTest test;
+    test.runAllTests();
+}
+
+// Benchmark: submit -> complete latency, legacy map/sleep hand-off vs ring + result slots
+extern "C" void runYolov5ThreadPoolBenchmark() {
+    LOGD("=== Yolov5ThreadPool Submit->Complete Latency Benchmark ===");
+
+    const int numThreads = 5;
+    const int inferenceUs = 8000;    // stub NPU time per frame
+    const int numChannels = 16;
+    const int fps = 25;
+    const int intervalUs = 1000000 / (numChannels * fps);
+    const int totalFrames = 2000;
+
+    LOGD("Config: %d workers, %dus stub inference, %d channels x %d fps (one frame every %dus), %d frames",
+         numThreads, inferenceUs, numChannels, fps, intervalUs, totalFrames);
+
+    LatencyStats legacy;
+    {
+        LegacyYolov5ThreadPool pool(numThreads, inferenceUs);
+        legacy = measureSubmitToComplete(totalFrames, intervalUs,
+                                         [&](const std::shared_ptr<frame_data_t> &f) { pool.submitTask(f); },
+                                         [&](std::vector<Detection> &o, int id) { pool.getTargetResult(o, id); });
+    }
+
+    LatencyStats current;
+    {
+        Yolov5ThreadPool pool;
+        pool.setUpWithEngineFactory(numThreads, [&] { return std::make_shared<StubNNEngine>(inferenceUs); }, nullptr, 0);
+        current = measureSubmitToComplete(totalFrames, intervalUs,
+                                          [&](const std::shared_ptr<frame_data_t> &f) { pool.submitTask(f); },
+                                          [&](std::vector<Detection> &o, int id) { pool.getTargetResult(o, id); });
+    }
+
+    LOGD("legacy  (map + sleep poll): p50 %.0fus  p90 %.0fus  p99 %.0fus  max %.0fus  %.1f fps",
+         legacy.p50Us, legacy.p90Us, legacy.p99Us, legacy.maxUs, legacy.framesPerSecond);
+    LOGD("current (ring + slots)    : p50 %.0fus  p90 %.0fus  p99 %.0fus  max %.0fus  %.1f fps",
+         current.p50Us, current.p90Us, current.p99Us, current.maxUs, current.framesPerSecond);
+}
+
+/**
+ * Benchmark: CPU time of one channel's result thread while its pool is idle
+ * (stream connected, no frames), over durationMs. "Spin" is the previous
+ * process_video_rtsp loop calling getTargetResultNonBlock back to back;
+ * "wait" blocks in waitForResult with the 500 ms idle timeout ZLPlayer uses.
+ */
+extern "C" void runResultWaitBenchmark(int durationMs) {
+    LOGD("=== Idle result thread CPU benchmark (%d ms) ===", durationMs);
+
+    Yolov5ThreadPool pool;
+    pool.setUpWithEngineFactory(1, [] { return std::make_shared<StubNNEngine>(1000); }, nullptr, 0);
+
+    for (int mode = 0; mode < 2; mode++) {
+        std::atomic<bool> done(false);
+        double cpuMs = 0.0;
+        long iterations = 0;
+        std::thread consumer([&] {
+            struct timespec begin, end;
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &begin);
+            uint64_t seen = 0;
+            std::vector<Detection> objects;
+            while (!done) {
+                if (mode == 1) {
+                    pool.waitForResult(seen, 500);
+                }
+                pool.getTargetResultNonBlock(objects, 0);
+                iterations++;
+            }
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+            cpuMs = (end.tv_sec - begin.tv_sec) * 1000.0 + (end.tv_nsec - begin.tv_nsec) / 1e6;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(durationMs));
+        done = true;
+        consumer.join();
+        LOGD("%s: %.1f ms CPU in %d ms (%.1f%% of a core), %ld polls", mode == 0 ? "spin" : "wait", cpuMs,
+             durationMs, cpuMs * 100.0 / durationMs, iterations);
+    }
+}
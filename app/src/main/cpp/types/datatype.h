@@ -42,6 +42,19 @@ typedef struct {
     void *data;
 } tensor_data_s;
 
+// letterbox几何参数：原图等比缩放scale后放在dst中(pad_left, pad_top)处，其余部分填充
+typedef struct {
+    int src_w;
+    int src_h;
+    int dst_w;
+    int dst_h;
+    int resized_w;
+    int resized_h;
+    int pad_left;
+    int pad_top;
+    float scale;
+} letterbox_geometry_s;
+
 
 static size_t nn_tensor_type_to_size(tensor_datatype_e type) {
     switch (type) {
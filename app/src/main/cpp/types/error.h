@@ -18,7 +18,11 @@ typedef enum
     NN_RKNN_MODEL_NOT_LOAD = -10,   // rknn模型未加载
     NN_STOPED = -11,                // 程序已停止
     NN_TIMEOUT = -12,          // 超时
-    NN_RESULT_NOT_READY = -13
+    NN_RESULT_NOT_READY = -13,
+    NN_QUEUE_FULL = -14,            // 任务队列已满
+    NN_CHANNEL_NOT_FOUND = -15,     // 通道未注册
+    NN_IMAGE_FORMAT_UNSUPPORTED = -16, // 不支持的图像格式
+    NN_LABELS_LOAD_FAIL = -17       // 标签文件读取失败
 } nn_error_e;
 
 #endif // RK3588_DEMO_ERROR_H
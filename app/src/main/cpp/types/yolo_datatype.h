@@ -21,6 +21,8 @@ struct Detection
     float confidence{0.0};
     cv::Scalar color{};
     cv::Rect box{};
+    int track_id{-1};          // Stable per-channel id from SortTracker, -1 if untracked
+    cv::Point2f velocity{};    // Tracked box centre velocity in pixels per frame
 };
 
 #endif //RK3588_DEMO_NN_DATATYPE_H